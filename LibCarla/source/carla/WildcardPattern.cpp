@@ -0,0 +1,156 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/WildcardPattern.h"
+
+#include "carla/StringUtil.h"
+
+#include <algorithm>
+#include <cctype>
+#include <mutex>
+#include <unordered_map>
+
+namespace carla {
+
+  static constexpr size_t MAX_CACHED_PATTERNS = 1024u;
+
+  static bool IsSpecial(char c) {
+    return c == '*' || c == '?' || c == '[' || c == '\\';
+  }
+
+  static bool CharEquals(char lhs, char rhs) {
+    if (WildcardPattern::IsCaseSensitive()) {
+      return lhs == rhs;
+    }
+    return std::tolower(static_cast<unsigned char>(lhs)) == std::tolower(static_cast<unsigned char>(rhs));
+  }
+
+  static bool RangeEquals(const char *lhs, const char *rhs, size_t size) {
+    for (size_t i = 0u; i < size; ++i) {
+      if (!CharEquals(lhs[i], rhs[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  WildcardPattern::WildcardPattern(std::string pattern)
+    : _pattern(std::move(pattern)) {
+    const auto first_special = std::find_if(_pattern.begin(), _pattern.end(), IsSpecial);
+    _literal_prefix.assign(_pattern.begin(), first_special);
+
+    if (std::any_of(_pattern.begin(), _pattern.end(), [](char c) { return c == '[' || c == '\\'; })) {
+      _kind = Kind::Fallback;
+      return;
+    }
+
+    // 连续的 '*' 与单个 '*' 等价。
+    for (char c : _pattern) {
+      if (c != '*' || _literal.empty() || _literal.back() != '*') {
+        _literal.push_back(c);
+      }
+    }
+    const std::string &p = _literal;
+    const bool has_question_mark = p.find('?') != std::string::npos;
+    const auto stars = std::count(p.begin(), p.end(), '*');
+    if (has_question_mark) {
+      _kind = Kind::Glob;
+    } else if (stars == 0) {
+      _kind = Kind::Literal;
+    } else if (p == "*") {
+      _kind = Kind::Any;
+      _literal.clear();
+    } else if (stars == 1 && p.back() == '*') {
+      _kind = Kind::Prefix;
+      _literal.pop_back();
+    } else if (stars == 1 && p.front() == '*') {
+      _kind = Kind::Suffix;
+      _literal.erase(0u, 1u);
+    } else if (stars == 2 && p.front() == '*' && p.back() == '*') {
+      _kind = Kind::Contains;
+      _literal = p.substr(1u, p.size() - 2u);
+    } else {
+      _kind = Kind::Glob;
+    }
+  }
+
+  std::shared_ptr<const WildcardPattern> WildcardPattern::Compile(const std::string &pattern) {
+    static std::mutex mutex;
+    static std::unordered_map<std::string, std::shared_ptr<const WildcardPattern>> cache;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = cache.find(pattern);
+    if (it != cache.end()) {
+      return it->second;
+    }
+    // 模式通常只有少数几种，缓存满了说明在用生成的模式，直接清空即可。
+    if (cache.size() >= MAX_CACHED_PATTERNS) {
+      cache.clear();
+    }
+    auto compiled = std::make_shared<const WildcardPattern>(pattern);
+    cache.emplace(pattern, compiled);
+    return compiled;
+  }
+
+  bool WildcardPattern::Match(const char *str, const size_t size) const {
+    const size_t n = _literal.size();
+    switch (_kind) {
+      case Kind::Literal:
+        return size == n && RangeEquals(str, _literal.data(), n);
+      case Kind::Any:
+        return true;
+      case Kind::Prefix:
+        return size >= n && RangeEquals(str, _literal.data(), n);
+      case Kind::Suffix:
+        return size >= n && RangeEquals(str + size - n, _literal.data(), n);
+      case Kind::Contains:
+        if (size < n) {
+          return false;
+        }
+        for (size_t i = 0u; i + n <= size; ++i) {
+          if (RangeEquals(str + i, _literal.data(), n)) {
+            return true;
+          }
+        }
+        return false;
+      case Kind::Glob:
+        return MatchGlob(str, size);
+      case Kind::Fallback:
+      default:
+        // StringUtil::Match 需要以 '\0' 结尾的字符串。
+        return StringUtil::Match(std::string(str, size), _pattern);
+    }
+  }
+
+  bool WildcardPattern::MatchGlob(const char *str, const size_t size) const {
+    // 经典的双指针算法：遇到 '*' 时记录回溯点，失配时让上一个 '*' 多吞一个字符。
+    // 由于只回溯到最近的 '*'，最坏情况为 O(模式长度 * 字符串长度)。
+    const char *p = _literal.data();
+    const size_t p_size = _literal.size();
+    size_t s = 0u;
+    size_t i = 0u;
+    size_t star = std::string::npos;
+    size_t star_s = 0u;
+    while (s < size) {
+      if (i < p_size && (p[i] == '?' || (p[i] != '*' && CharEquals(p[i], str[s])))) {
+        ++i;
+        ++s;
+      } else if (i < p_size && p[i] == '*') {
+        star = i++;
+        star_s = s;
+      } else if (star != std::string::npos) {
+        i = star + 1u;
+        s = ++star_s;
+      } else {
+        return false;
+      }
+    }
+    while (i < p_size && p[i] == '*') {
+      ++i;
+    }
+    return i == p_size;
+  }
+
+} // namespace carla
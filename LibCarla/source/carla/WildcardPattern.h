@@ -0,0 +1,87 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace carla {
+
+  /// 预先编译的 Unix shell 风格通配符模式，匹配结果与 StringUtil::Match 相同。
+  ///
+  /// 常见的模式（纯字面量、"abc*"、"*abc"、"*abc*"、只含 '*' 与 '?' 的模式）
+  /// 编译为不需要回溯或只需线性回溯的匹配器；含字符集或转义的模式退回到
+  /// StringUtil::Match。编译结果通过 Compile 按模式字符串缓存，
+  /// 对成千上万个类型 ID 反复过滤时无需重复解析模式。
+  class WildcardPattern {
+  public:
+
+    explicit WildcardPattern(std::string pattern);
+
+    /// 返回 @a pattern 编译后的匹配器，相同的模式共享同一个实例。
+    static std::shared_ptr<const WildcardPattern> Compile(const std::string &pattern);
+
+    bool Match(const char *str, size_t size) const;
+
+    bool Match(const char *str) const {
+      return Match(str, std::strlen(str));
+    }
+
+    bool Match(const std::string &str) const {
+      return Match(str.data(), str.size());
+    }
+
+    const std::string &GetPattern() const {
+      return _pattern;
+    }
+
+    /// 第一个通配符之前的字面量前缀，所有匹配的字符串都以它开头。
+    const std::string &GetLiteralPrefix() const {
+      return _literal_prefix;
+    }
+
+    /// 模式中没有任何通配符，只匹配与之相同的字符串。
+    bool IsLiteral() const {
+      return _kind == Kind::Literal;
+    }
+
+    /// 比较字符时是否区分大小写（与各平台的 StringUtil::Match 一致）。
+    static constexpr bool IsCaseSensitive() {
+#ifdef _WIN32
+      return false;
+#else
+      return true;
+#endif // _WIN32
+    }
+
+  private:
+
+    enum class Kind {
+      Literal,   ///< "abc"
+      Any,       ///< "*"
+      Prefix,    ///< "abc*"
+      Suffix,    ///< "*abc"
+      Contains,  ///< "*abc*"
+      Glob,      ///< 只含 '*' 与 '?' 的其它模式
+      Fallback   ///< 含字符集或转义，交给 StringUtil::Match
+    };
+
+    bool MatchGlob(const char *str, size_t size) const;
+
+    Kind _kind;
+
+    std::string _pattern;
+
+    /// Prefix、Suffix、Contains 与 Literal 中需要比较的字面量；Glob 中为
+    /// 合并了连续 '*' 后的模式。
+    std::string _literal;
+
+    std::string _literal_prefix;
+  };
+
+} // namespace carla
@@ -8,6 +8,7 @@
 
 #include "carla/Debug.h"
 #include "carla/Iterator.h"
+#include "carla/WildcardPattern.h"
 #include "carla/client/ActorAttribute.h"
 #include "carla/rpc/ActorDefinition.h"
 #include "carla/rpc/ActorDescription.h"
@@ -59,6 +60,9 @@ namespace client {
     /// @a wildcard_pattern 遵循 Unix shell 风格的通配符。
     bool MatchTags(const std::string &wildcard_pattern) const;
 
+    /// 与上面相同，使用预先编译的模式。
+    bool MatchTags(const WildcardPattern &pattern) const;
+
     std::vector<std::string> GetTags() const {
       return {_tags.begin(), _tags.end()};
     }
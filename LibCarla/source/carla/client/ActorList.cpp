@@ -6,8 +6,9 @@
 
 #include "carla/client/ActorList.h" // 引入参与者列表类的头文件
 
-#include "carla/StringUtil.h" // 引入字符串工具类的头文件
+#include "carla/WildcardPattern.h" // 引入预编译通配符模式的头文件
 #include "carla/client/detail/ActorFactory.h" // 引入参与者工厂类的头文件
+#include "carla/client/detail/Simulator.h" // 引入模拟器类的头文件
 
 #include <iterator> // 引入迭代器相关的标准库
 
@@ -16,9 +17,11 @@ namespace client {
 
   ActorList::ActorList( // 参与者列表构造函数
       detail::EpisodeProxy episode, // 传入的场景代理对象
-      std::vector<rpc::Actor> actors) // 传入的参与者列表
+      std::vector<rpc::Actor> actors, // 传入的参与者列表
+      std::shared_ptr<const detail::EpisodeState> state) // 列表对应的剧集状态
     : _episode(std::move(episode)), // 移动语义传递场景代理
-      _actors(std::make_move_iterator(actors.begin()), std::make_move_iterator(actors.end())) {} // 使用移动迭代器初始化参与者列表
+      _actors(std::make_move_iterator(actors.begin()), std::make_move_iterator(actors.end())), // 使用移动迭代器初始化参与者列表
+      _state(std::move(state)) {}
 
   SharedPtr<Actor> ActorList::Find(const ActorId actor_id) const { // 查找指定ID的参与者
     for (auto &actor : _actors) { // 遍历所有参与者
@@ -30,9 +33,13 @@ namespace client {
   }
 
   SharedPtr<ActorList> ActorList::Filter(const std::string &wildcard_pattern) const { // 根据通配符模式过滤参与者
+    const auto pattern = WildcardPattern::Compile(wildcard_pattern); // 编译后的模式按模式字符串缓存
+    if (_state != nullptr) { // 列表包含整帧的参与者时借助剧集的类型 ID 索引
+      return SharedPtr<ActorList>{new ActorList(_episode, _episode.Lock()->GetActorsMatching(*_state, *pattern))};
+    }
     SharedPtr<ActorList> filtered (new ActorList(_episode, {})); // 创建一个新的参与者列表用于存放过滤后的参与者
     for (auto &&actor : _actors) { // 遍历所有参与者
-      if (StringUtil::Match(actor.GetTypeId(), wildcard_pattern)) { // 如果参与者类型与通配符匹配
+      if (pattern->Match(actor.GetTypeId())) { // 如果参与者类型与通配符匹配
         filtered->_actors.push_back(actor); // 将匹配的参与者加入到过滤后的列表中
       }
     }
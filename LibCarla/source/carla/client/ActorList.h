@@ -10,11 +10,16 @@
 
 #include <boost/iterator/transform_iterator.hpp> // 引入 Boost 库中的变换迭代器
 
+#include <memory> // 引入智能指针
 #include <vector> // 引入标准库中的 vector 容器
 
 namespace carla { // 开始 carla 命名空间
 namespace client { // 开始 client 命名空间
 
+namespace detail {
+  class EpisodeState; // 前向声明剧集状态类
+} // namespace detail
+
   class ActorList : public EnableSharedFromThis<ActorList> { // 定义 ActorList 类，支持 shared_from_this
   private:
 
@@ -62,11 +67,18 @@ namespace client { // 开始 client 命名空间
 
     friend class World; // 声明 World 类为友元类
 
-    ActorList(detail::EpisodeProxy episode, std::vector<rpc::Actor> actors); // 构造函数，接受 EpisodeProxy 和 Actor 向量
+    /// @param state 若列表包含 @a state 中的所有参与者，传入该状态，
+    ///        Filter 可以借助剧集的类型 ID 索引而无需遍历整个列表。
+    ActorList(
+        detail::EpisodeProxy episode,
+        std::vector<rpc::Actor> actors,
+        std::shared_ptr<const detail::EpisodeState> state = nullptr); // 构造函数，接受 EpisodeProxy 和 Actor 向量
 
     detail::EpisodeProxy _episode; // 存储 EpisodeProxy 对象
 
     std::vector<detail::ActorVariant> _actors; // 存储 ActorVariant 对象的向量
+
+    std::shared_ptr<const detail::EpisodeState> _state; // 列表是某一帧的全部参与者时为该帧的状态，否则为空
   };
 
 } // namespace client
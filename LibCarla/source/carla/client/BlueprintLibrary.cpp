@@ -7,6 +7,7 @@
 #include "carla/client/BlueprintLibrary.h"
 
 #include "carla/Exception.h"
+#include "carla/WildcardPattern.h"
 
 #include <algorithm>
 #include <iterator>
@@ -26,8 +27,9 @@ namespace client {
   SharedPtr<BlueprintLibrary> BlueprintLibrary::Filter(
       const std::string &wildcard_pattern) const {
     map_type result; //存储过滤结果的映射
+    const auto pattern = WildcardPattern::Compile(wildcard_pattern); //只编译一次模式
     for (auto &pair : _blueprints) {
-      if (pair.second.MatchTags(wildcard_pattern)) { //检查蓝图是否匹配通配符模式
+      if (pair.second.MatchTags(*pattern)) { //检查蓝图是否匹配通配符模式
         result.emplace(pair); //如果匹配，则将其添加到结果中
       }
     }
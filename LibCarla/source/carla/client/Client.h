@@ -27,10 +27,12 @@ namespace client {
     /// @param host 运行模拟器的主机IP地址。
     /// @param port 连接到模拟器的TCP端口。
     /// @param worker_threads 要使用的异步线程数，或 0 以使用所有可用的硬件并发。
+    /// @param callback_threads 执行传感器与 tick 回调的线程数，或 0 以在网络线程中直接执行回调。
     explicit Client(
         const std::string &host,
         uint16_t port,
-        size_t worker_threads = 0u);
+        size_t worker_threads = 0u,
+        size_t callback_threads = 1u);
 
     /// 设置网络操作的超时时间。如果设置，任何超过 @a 超时时间的网络操作都会抛出 rpc::timeout 异常。 
     void SetTimeout(time_duration timeout) {
@@ -42,6 +44,11 @@ namespace client {
       return _simulator->GetNetworkingTimeout();
     }
 
+    /// 返回回调执行器的积压与延迟统计。
+    detail::CallbackQueueStats GetCallbackStats() const {
+      return _simulator->GetCallbackStats();
+    }
+
     /// 返回此客户端 API 版本的字符串。
     std::string GetClientVersion() const {
       return _simulator->GetClientVersion();
@@ -182,6 +189,11 @@ namespace client {
       _simulator->SetReplayerIgnoreSpectator(ignore_spectator);
     }
 
+    // 之后的录制是否按块压缩帧数据（文件版本 2），回放和查询时自动解压。
+    void SetRecorderCompression(bool enabled) {
+      _simulator->SetRecorderCompression(enabled);
+    }
+
     // 在单个模拟步上执行命令列表，不检索任何信息。
     void ApplyBatch(
         std::vector<rpc::Command> commands,
@@ -209,9 +221,10 @@ namespace client {
   inline Client::Client(
       const std::string &host,
       uint16_t port,
-      size_t worker_threads)
+      size_t worker_threads,
+      size_t callback_threads)
     : _simulator(
-        new detail::Simulator(host, port, worker_threads),
+        new detail::Simulator(host, port, worker_threads, false, callback_threads),
         PythonUtil::ReleaseGILDeleter()) {}
 
 } // namespace client
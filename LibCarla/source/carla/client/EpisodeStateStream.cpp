@@ -0,0 +1,45 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/client/EpisodeStateStream.h"
+
+#include "carla/Logging.h"
+#include "carla/client/detail/Simulator.h"
+
+#include <exception>
+
+namespace carla {
+namespace client {
+
+  EpisodeStateStream::~EpisodeStateStream() {
+    if (IsListening() && _episode.IsValid()) {
+      try {
+        Stop();
+      } catch (const std::exception &e) {
+        log_error("exception trying to stop episode state stream:", e.what());
+      }
+    }
+  }
+
+  void EpisodeStateStream::Listen(CallbackFunctionType callback) {
+    if (IsListening()) {
+      Stop();
+    }
+    _token = _episode.Lock()->SubscribeToEpisodeState(_filter, std::move(callback));
+  }
+
+  void EpisodeStateStream::Stop() {
+    if (!IsListening()) {
+      log_warning("attempting to stop an episode state stream that wasn't listening");
+      return;
+    }
+    const auto token = *_token;
+    _token.reset();
+    _episode.Lock()->UnSubscribeFromEpisodeState(token);
+  }
+
+} // namespace client
+} // namespace carla
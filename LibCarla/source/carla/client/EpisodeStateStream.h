@@ -0,0 +1,66 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Memory.h"
+#include "carla/NonCopyable.h"
+#include "carla/client/WorldSnapshot.h"
+#include "carla/client/detail/EpisodeProxy.h"
+#include "carla/rpc/EpisodeStateFilter.h"
+#include "carla/streaming/Token.h"
+
+#include <boost/optional.hpp>
+
+#include <functional>
+
+namespace carla {
+namespace client {
+
+  /// 过滤后的仿真状态流：服务器每帧只发送满足过滤条件的参与者，带宽与
+  /// 客户端的解析开销只与这些参与者的数量相关。
+  ///
+  /// 收到的 WorldSnapshot 只包含过滤后的参与者，与 World::GetSnapshot()
+  /// 返回的完整状态相互独立。
+  class EpisodeStateStream
+    : public EnableSharedFromThis<EpisodeStateStream>,
+      private NonCopyable {
+  public:
+
+    using CallbackFunctionType = std::function<void(WorldSnapshot)>;
+
+    EpisodeStateStream(detail::EpisodeProxy episode, rpc::EpisodeStateFilter filter)
+      : _episode(std::move(episode)),
+        _filter(std::move(filter)) {}
+
+    ~EpisodeStateStream();
+
+    const rpc::EpisodeStateFilter &GetFilter() const {
+      return _filter;
+    }
+
+    /// 在服务器上创建过滤后的流并开始接收，每帧调用一次 @a callback。
+    /// 已经在接收时会先停止之前的订阅。
+    void Listen(CallbackFunctionType callback);
+
+    /// 停止接收并关闭服务器上的流。
+    void Stop();
+
+    bool IsListening() const {
+      return _token.has_value();
+    }
+
+  private:
+
+    detail::EpisodeProxy _episode;
+
+    const rpc::EpisodeStateFilter _filter;
+
+    boost::optional<streaming::Token> _token;
+  };
+
+} // namespace client
+} // namespace carla
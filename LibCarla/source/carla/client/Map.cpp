@@ -6,6 +6,8 @@
 
 #include "carla/client/Map.h"
 
+#include "carla/Logging.h"
+#include "carla/client/FileTransfer.h"
 #include "carla/client/Junction.h"
 #include "carla/client/Waypoint.h"
 #include "carla/opendrive/OpenDriveParser.h"
@@ -13,17 +15,43 @@
 #include "carla/road/RoadTypes.h"
 #include "carla/trafficmanager/InMemoryMap.h"
 
+#include <iomanip>
 #include <sstream>
 // 命名空间 carla
 namespace carla {
 // 命名空间 client
 namespace client {
+// R 树缓存在 FileTransfer 缓存目录中的文件名，以 OpenDRIVE 内容的指纹命名
+static std::string GetRtreeCacheFileName(const std::string &opendrive_contents) {
+    std::ostringstream name;
+    name << "RtreeCache/" << std::hex << std::setw(16) << std::setfill('0')
+         << road::Map::ComputeRtreeFingerprint(opendrive_contents) << ".rtree";
+    return name.str();
+  }
 // 静态函数 MakeMap，根据输入的 opendrive 内容生成地图  
+// 路段 R 树优先从缓存恢复；缓存不存在时生成后写入缓存，写入失败不影响地图本身
 static auto MakeMap(const std::string &opendrive_contents) {
-// 创建输入字符串流   
- auto stream = std::istringstream(opendrive_contents);
- // 调用 OpenDriveParser 类的 Load 函数加载地图，返回 boost::optional<carla::road::Map>
-    auto map = opendrive::OpenDriveParser::Load(stream.str());
+    const auto cache_file = GetRtreeCacheFileName(opendrive_contents);
+    boost::optional<carla::road::Map> map;
+    if (FileTransfer::FileExists(cache_file)) {
+      const auto content = FileTransfer::ReadFile(cache_file);
+      std::istringstream cache(std::string(content.begin(), content.end()));
+      map = opendrive::OpenDriveParser::Load(opendrive_contents, &cache);
+    } else {
+      map = opendrive::OpenDriveParser::Load(opendrive_contents);
+      if (map.has_value()) {
+        std::ostringstream cache;
+        map->SaveRtree(cache);
+        const auto data = cache.str();
+        try {
+          if (!FileTransfer::WriteFile(cache_file, std::vector<uint8_t>(data.begin(), data.end()))) {
+            log_warning("unable to write the road R-tree cache", cache_file);
+          }
+        } catch (const std::exception &e) {
+          log_warning("unable to write the road R-tree cache", cache_file, ':', e.what());
+        }
+      }
+    }
  // 如果 map 为空，抛出运行时异常    
     if (!map.has_value()) {
       throw_exception(std::runtime_error("failed to generate map"));
@@ -123,6 +151,73 @@ static auto MakeMap(const std::string &opendrive_contents) {
     }
     return result;
   }
+
+  // 为批量结果中的每个路点计算变换
+  static void ComputeTransforms(const road::Map &map, WaypointBatch &batch) {
+    batch.transforms.resize(batch.waypoints.size());
+    for (size_t i = 0u; i < batch.waypoints.size(); ++i) {
+      batch.transforms[i] = map.ComputeTransform(batch.waypoints[i]);
+    }
+  }
+
+  WaypointBatch Map::GenerateWaypointBatch(double distance) const {
+    WaypointBatch result;
+    result.waypoints = _map.GenerateWaypoints(distance);
+    ComputeTransforms(_map, result);
+    return result;
+  }
+
+  WaypointBatch Map::GetWaypointBatch(
+      const std::vector<geom::Location> &locations,
+      bool project_to_road,
+      int32_t lane_type) const {
+    WaypointBatch result;
+    result.reserve(locations.size());
+    result.source.reserve(locations.size());
+    for (size_t i = 0u; i < locations.size(); ++i) {
+      auto waypoint = project_to_road ?
+          _map.GetClosestWaypointOnRoad(locations[i], lane_type) :
+          _map.GetWaypoint(locations[i], lane_type);
+      if (waypoint.has_value()) {
+        result.waypoints.emplace_back(*waypoint);
+        result.source.emplace_back(static_cast<uint32_t>(i));
+      }
+    }
+    ComputeTransforms(_map, result);
+    return result;
+  }
+
+  WaypointBatch Map::GetNextBatch(const std::vector<WaypointHandle> &waypoints, double distance) const {
+    WaypointBatch result;
+    result.reserve(waypoints.size());
+    result.source.reserve(waypoints.size());
+    for (size_t i = 0u; i < waypoints.size(); ++i) {
+      for (auto &next : _map.GetNext(waypoints[i], distance)) {
+        result.waypoints.emplace_back(next);
+        result.source.emplace_back(static_cast<uint32_t>(i));
+      }
+    }
+    ComputeTransforms(_map, result);
+    return result;
+  }
+
+  WaypointBatch Map::GetPreviousBatch(const std::vector<WaypointHandle> &waypoints, double distance) const {
+    WaypointBatch result;
+    result.reserve(waypoints.size());
+    result.source.reserve(waypoints.size());
+    for (size_t i = 0u; i < waypoints.size(); ++i) {
+      for (auto &previous : _map.GetPrevious(waypoints[i], distance)) {
+        result.waypoints.emplace_back(previous);
+        result.source.emplace_back(static_cast<uint32_t>(i));
+      }
+    }
+    ComputeTransforms(_map, result);
+    return result;
+  }
+
+  SharedPtr<Waypoint> Map::MakeWaypoint(const WaypointHandle &waypoint) const {
+    return SharedPtr<Waypoint>(new Waypoint{shared_from_this(), waypoint});
+  }
 // 计算穿越车道的函数
   std::vector<road::element::LaneMarking> Map::CalculateCrossedLanes(
   const geom::Location &origin,
@@ -21,6 +21,8 @@
 #include "carla/road/RoadTypes.h"
 // 包含CARLA RPC地图信息（MapInfo）的头文件
 #include "carla/rpc/MapInfo.h"
+// 包含批量路点结果（WaypointBatch）的头文件
+#include "carla/client/WaypointBatch.h"
 // 包含地标（Landmark）的头文件
 #include "Landmark.h"
 
@@ -148,6 +150,52 @@ namespace client {
          * @return 返回生成的路点（智能指针的向量）。
          */
     std::vector<SharedPtr<Waypoint>> GenerateWaypoints(double distance) const;   
+    /**
+         * @brief 根据距离生成路点，以连续数组的形式返回句柄与变换。
+         *
+         * 结果与 GenerateWaypoints 相同，但不为每个路点分配 Waypoint 对象。
+         *
+         * @param distance 距离。
+         * @return 返回路点批量结果，其中 source 为空。
+         */
+    WaypointBatch GenerateWaypointBatch(double distance) const;
+    /**
+         * @brief 批量查找位置对应的路点。
+         *
+         * @param locations 地理位置列表。
+         * @param project_to_road 是否将位置投影到最近的道路上。
+         * @param lane_type 车道类型。
+         * @return 返回路点批量结果，source 为每个路点对应的位置下标。
+         */
+    WaypointBatch GetWaypointBatch(
+        const std::vector<geom::Location> &locations,
+        bool project_to_road = true,
+        int32_t lane_type = static_cast<uint32_t>(road::Lane::LaneType::Driving)) const;
+    /**
+         * @brief 批量获取每个路点之后 @a distance 处的路点。
+         *
+         * 对每个输入路点与 Waypoint::GetNext 的结果相同（一个路点可能有多个后继）。
+         *
+         * @param waypoints 输入路点句柄。
+         * @param distance 距离。
+         * @return 返回路点批量结果，source 为每个后继对应的输入下标。
+         */
+    WaypointBatch GetNextBatch(const std::vector<WaypointHandle> &waypoints, double distance) const;
+    /**
+         * @brief 批量获取每个路点之前 @a distance 处的路点。
+         *
+         * @param waypoints 输入路点句柄。
+         * @param distance 距离。
+         * @return 返回路点批量结果，source 为每个前驱对应的输入下标。
+         */
+    WaypointBatch GetPreviousBatch(const std::vector<WaypointHandle> &waypoints, double distance) const;
+    /**
+         * @brief 由路点句柄创建完整的路点对象。
+         *
+         * @param waypoint 路点句柄。
+         * @return 返回指向路点对象的智能指针。
+         */
+    SharedPtr<Waypoint> MakeWaypoint(const WaypointHandle &waypoint) const;
     /**
          * @brief 计算从起点到终点所跨越的车道。
          *
@@ -8,6 +8,7 @@
 
 #include "carla/Logging.h" // 导入日志记录相关的头文件
 #include "carla/client/detail/Simulator.h" // 导入Simulator类的头文件
+#include "carla/streaming/detail/Token.h" // 导入流令牌的头文件
 
 #include <exception> //导入异常处理的头文件
 
@@ -122,6 +123,11 @@ namespace client {
     return GetEpisode().Lock()->IsEnabledForROS(*this);
   }
 
+  streaming::StreamStatistics ServerSideSensor::GetStreamStatistics() const {
+    const streaming::detail::token_type token(GetActorDescription().GetStreamToken());
+    return streaming::StreamMetrics::GetStatistics(token.get_stream_id());
+  }
+
   bool ServerSideSensor::Destroy() {
     log_debug("calling sensor Destroy() ", GetDisplayId()); // 记录调试日志，表示调用了Destroy方法
     if (IsListening()) { // 如果传感器正在监听
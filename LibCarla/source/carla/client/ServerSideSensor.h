@@ -7,6 +7,7 @@
 #pragma once
 
 #include "carla/client/Sensor.h"
+#include "carla/streaming/StreamMetrics.h"
 #include <bitset>
 
 namespace carla {
@@ -55,6 +56,10 @@ namespace client {
     /// 通过该传感器发送数据
     void Send(std::string message);
 
+    /// 此传感器数据流在本进程中的统计数据（接收的消息与字节数、重连次数、
+    /// 端到端延迟等），见 streaming::StreamMetrics。
+    streaming::StreamStatistics GetStreamStatistics() const;
+
     /// @copydoc Actor::Destroy()
     ///
     /// 另外停止监听。
@@ -0,0 +1,62 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/geom/Transform.h"
+#include "carla/road/element/Waypoint.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace carla {
+namespace client {
+
+  /// 路点的值类型句柄：(road_id, section_id, lane_id, s)。
+  ///
+  /// 与 client::Waypoint 不同，它不在堆上分配，也不持有地图的引用计数；
+  /// 需要完整的路点对象时可以用 Map::MakeWaypoint 转换。
+  using WaypointHandle = road::element::Waypoint;
+
+  /// 批量路点查询的结果，各数组按下标一一对应、连续存放。
+  ///
+  /// 生成几十万个路点的路径规划器可以直接处理这些数组，
+  /// 避免为每个路点分配一个 SharedPtr<Waypoint>。
+  struct WaypointBatch {
+
+    /// 路点句柄。
+    std::vector<WaypointHandle> waypoints;
+
+    /// 每个路点的变换（位于车道中心，朝向车道方向）。
+    std::vector<geom::Transform> transforms;
+
+    /// 每个结果对应的输入下标：批量 GetNext/GetPrevious 中为输入路点的下标，
+    /// 批量 GetWaypoint 中为输入位置的下标（找不到路点的位置没有结果）。
+    /// GenerateWaypoints 的结果中为空。
+    std::vector<uint32_t> source;
+
+    size_t size() const {
+      return waypoints.size();
+    }
+
+    bool empty() const {
+      return waypoints.empty();
+    }
+
+    void reserve(size_t count) {
+      waypoints.reserve(count);
+      transforms.reserve(count);
+    }
+
+    void clear() {
+      waypoints.clear();
+      transforms.clear();
+      source.clear();
+    }
+  };
+
+} // namespace client
+} // namespace carla
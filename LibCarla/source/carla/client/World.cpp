@@ -103,6 +103,14 @@ namespace client {
     return _episode.Lock()->GetWorldSnapshot();  // 返回当前世界快照
   }
 
+  boost::optional<WorldSnapshot> World::GetSnapshot(uint64_t frame) const {
+    return _episode.Lock()->GetWorldSnapshot(frame);
+  }
+
+  boost::optional<geom::Transform> World::GetActorTransformAt(ActorId id, double elapsed_seconds) const {
+    return _episode.Lock()->GetActorTransformAt(id, elapsed_seconds);
+  }
+
   SharedPtr<Actor> World::GetActor(ActorId id) const {  // 根据ID获取参与者的方法
     auto simulator = _episode.Lock();  // 锁定当前剧集
     auto description = simulator->GetActorById(id);  // 获取指定ID的参与者描述
@@ -112,9 +120,13 @@ namespace client {
   }
 
   SharedPtr<ActorList> World::GetActors() const {  // 获取所有参与者的方法
+    auto simulator = _episode.Lock();
+    auto state = simulator->GetEpisodeState();  // 列表与之后的过滤都基于同一帧
+    auto actors = simulator->GetAllTheActorsInTheEpisode(*state);  // 获取所有参与者
     return SharedPtr<ActorList>{new ActorList{  // 返回新的参与者列表
                                   _episode,
-                                  _episode.Lock()->GetAllTheActorsInTheEpisode()}};  // 获取所有参与者
+                                  std::move(actors),
+                                  std::move(state)}};
   }
 
   SharedPtr<ActorList> World::GetActors(const std::vector<ActorId> &actor_ids) const {  // 根据ID列表获取参与者的方法
@@ -162,6 +174,10 @@ namespace client {
     _episode.Lock()->RemoveOnTickEvent(callback_id); // 根据ID移除
   }
 
+  SharedPtr<EpisodeStateStream> World::MakeEpisodeStateStream(rpc::EpisodeStateFilter filter) const {
+    return MakeShared<EpisodeStateStream>(_episode, std::move(filter));
+  }
+
   uint64_t World::Tick(time_duration timeout) { // 执行tick操作
     time_duration local_timeout = timeout.milliseconds() == 0 ?
         _episode.Lock()->GetNetworkingTimeout() : timeout; // 确定超时时间
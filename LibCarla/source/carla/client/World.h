@@ -11,6 +11,7 @@
 #include "carla/Memory.h"
 #include "carla/Time.h"
 #include "carla/client/DebugHelper.h"
+#include "carla/client/EpisodeStateStream.h"
 #include "carla/client/Landmark.h"
 #include "carla/client/Waypoint.h"
 #include "carla/client/Junction.h"
@@ -22,6 +23,7 @@
 #include "carla/rpc/Actor.h"
 #include "carla/rpc/AttachmentType.h"
 #include "carla/rpc/EpisodeSettings.h"
+#include "carla/rpc/EpisodeStateFilter.h"
 #include "carla/rpc/EnvironmentObject.h"
 #include "carla/rpc/LabelledPoint.h"
 #include "carla/rpc/MapLayer.h"
@@ -107,6 +109,14 @@ namespace client {
     /// 返回当前世界的快照.
     WorldSnapshot GetSnapshot() const;
 
+    /// 返回最近若干帧中帧号为 @a frame 的快照，例如与某一帧的传感器数据
+    /// 对齐。该帧没有收到或已超出历史范围时返回空.
+    boost::optional<WorldSnapshot> GetSnapshot(uint64_t frame) const;
+
+    /// 由最近若干帧插值得到参与者在仿真时间 @a elapsed_seconds 的变换，
+    /// 时间超出历史范围时返回空.
+    boost::optional<geom::Transform> GetActorTransformAt(ActorId id, double elapsed_seconds) const;
+
     /// 根据id查找actor，如果没有找到则返回nullptr.
     SharedPtr<Actor> GetActor(ActorId id) const;
 
@@ -144,6 +154,10 @@ namespace client {
     /// Remove a callback registered with OnTick.
     void RemoveOnTick(size_t callback_id);
 
+    /// 创建一个只包含满足 @a filter 的参与者的仿真状态流，调用其 Listen
+    /// 后开始接收。
+    SharedPtr<EpisodeStateStream> MakeEpisodeStateStream(rpc::EpisodeStateFilter filter) const;
+
     /// 通知模拟器继续进行下一个节拍(仅对同步模式有效).
     ///
     /// @return 这个调用开始的帧的id.
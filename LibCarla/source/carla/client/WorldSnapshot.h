@@ -51,6 +51,16 @@ namespace client {
       return _state->size();
     }
 
+	// 返回这个世界快照中所有参与者的 ID
+    auto GetActorIds() const {
+      return _state->GetActorIds();
+    }
+
+    // 返回参与者 ID 集合的摘要，见 EpisodeState::GetActorIdDigest
+    uint64_t GetActorIdDigest() const {
+      return _state->GetActorIdDigest();
+    }
+
 	// 返回指向参与者快照列表的开始迭代器
     auto begin() const {
       return _state->begin();
@@ -7,13 +7,19 @@
 #pragma once
 
 #include "carla/NonCopyable.h"
+#include "carla/WildcardPattern.h"
 #include "carla/rpc/Actor.h"
 
-#include <boost/iterator/transform_iterator.hpp>
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/optional.hpp>
 
 #include <algorithm>
 #include <iterator>
 #include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace carla {
 namespace client {
@@ -47,13 +53,41 @@ namespace detail {
     template <typename RangeT>
     std::vector<rpc::Actor> GetActorsById(const RangeT &range) const;
 
+    /// 返回类型 ID 等于 @a key 或以 "@a key." 开头的所有已索引参与者的 ID；
+    /// 上次 UpdateTypeIndex 之后销毁的参与者仍可能在其中。
+    std::vector<ActorId> GetIdsByTypePrefix(const std::string &key) const;
+
+    /// 使类型 ID 索引只包含 @a alive_ids 中的参与者：移除其余参与者，并重新
+    /// 索引再次出现的已缓存参与者。参与者的描述仍保留在缓存中。
+    template <typename RangeT>
+    void UpdateTypeIndex(const RangeT &alive_ids);
+
+    /// 返回可以用于 GetIdsByTypePrefix 的索引键：所有与 @a pattern 匹配的
+    /// 类型 ID 都在该键下。模式不以完整的 "a.b." 段开头时返回空。
+    static boost::optional<std::string> GetIndexKey(const WildcardPattern &pattern);
+
     void Clear();
 
   private:
 
+    /// 按类型 ID 的每个以 '.' 分隔的前缀（以及完整的类型 ID）索引参与者，
+    /// 调用前必须已持有 _mutex。
+    void IndexTypeId(const rpc::Actor &actor);
+
+    /// 对类型 ID @a type_id 的每个前缀调用 @a functor(prefix)。
+    template <typename FunctorT>
+    static void ForEachTypePrefix(const std::string &type_id, FunctorT &&functor);
+
     mutable std::mutex _mutex;
 
     std::unordered_map<ActorId, rpc::Actor> _actors;
+
+    /// 类型 ID 前缀到参与者 ID 的索引，例如 "vehicle"、"vehicle.tesla"、
+    /// "vehicle.tesla.model3" 下都有该车辆。
+    std::unordered_map<std::string, std::vector<ActorId>> _ids_by_type_prefix;
+
+    /// 当前在 _ids_by_type_prefix 中的参与者。
+    std::unordered_set<ActorId> _indexed_ids;
   };
 
   // ===========================================================================
@@ -63,20 +97,22 @@ namespace detail {
   inline void CachedActorList::Insert(rpc::Actor actor) {
     std::lock_guard<std::mutex> lock(_mutex);
     auto id = actor.id;
-    _actors.emplace(id, std::move(actor));
+    auto result = _actors.emplace(id, std::move(actor));
+    if (result.second) {
+      IndexTypeId(result.first->second);
+    }
   }
 
   template <typename RangeT>
   inline void CachedActorList::InsertRange(RangeT range) {
-    auto make_a_pair = [](rpc::Actor actor) {
-      auto id = actor.id;
-      return std::make_pair(id, std::move(actor));
-    };
-    auto make_iterator = [&make_a_pair](auto it) {
-      return boost::make_transform_iterator(std::make_move_iterator(it), make_a_pair);
-    };
     std::lock_guard<std::mutex> lock(_mutex);
-    _actors.insert(make_iterator(std::begin(range)), make_iterator(std::end(range)));
+    for (auto &&actor : range) {
+      auto id = actor.id;
+      auto result = _actors.emplace(id, std::move(actor));
+      if (result.second) {
+        IndexTypeId(result.first->second);
+      }
+    }
   }
 
   template <typename RangeT>
@@ -113,9 +149,99 @@ namespace detail {
     return result;
   }
 
+  inline std::vector<ActorId> CachedActorList::GetIdsByTypePrefix(const std::string &key) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _ids_by_type_prefix.find(key);
+    if (it != _ids_by_type_prefix.end()) {
+      return it->second;
+    }
+    return {};
+  }
+
+  template <typename RangeT>
+  inline void CachedActorList::UpdateTypeIndex(const RangeT &alive_ids) {
+    const std::unordered_set<ActorId> alive(std::begin(alive_ids), std::end(alive_ids));
+    std::lock_guard<std::mutex> lock(_mutex);
+    // 收集已销毁的参与者及其所在的索引键。
+    std::unordered_set<ActorId> removed;
+    std::unordered_set<std::string> keys;
+    for (auto id : _indexed_ids) {
+      if (alive.find(id) == alive.end()) {
+        removed.insert(id);
+        auto it = _actors.find(id);
+        if (it != _actors.end()) {
+          ForEachTypePrefix(it->second.description.id, [&](std::string prefix) {
+            keys.insert(std::move(prefix));
+          });
+        }
+      }
+    }
+    for (const auto &key : keys) {
+      auto it = _ids_by_type_prefix.find(key);
+      if (it == _ids_by_type_prefix.end()) {
+        continue;
+      }
+      auto &ids = it->second;
+      ids.erase(std::remove_if(ids.begin(), ids.end(), [&](ActorId id) {
+        return removed.find(id) != removed.end();
+      }), ids.end());
+      if (ids.empty()) {
+        _ids_by_type_prefix.erase(it);
+      }
+    }
+    for (auto id : removed) {
+      _indexed_ids.erase(id);
+    }
+    // 例如生成时在出现于世界状态之前就已缓存、因而被移出索引的参与者。
+    for (auto id : alive) {
+      if (_indexed_ids.find(id) == _indexed_ids.end()) {
+        auto it = _actors.find(id);
+        if (it != _actors.end()) {
+          IndexTypeId(it->second);
+        }
+      }
+    }
+  }
+
+  inline boost::optional<std::string> CachedActorList::GetIndexKey(const WildcardPattern &pattern) {
+    const auto &prefix = pattern.GetLiteralPrefix();
+    std::string key;
+    if (pattern.IsLiteral()) {
+      key = prefix;
+    } else {
+      const auto dot = prefix.rfind('.');
+      if (dot == std::string::npos || dot == 0u) {
+        return boost::none;
+      }
+      key = prefix.substr(0u, dot);
+    }
+    // 类型 ID 通常为小写，不区分大小写的平台上把键也转换为小写。
+    if (!WildcardPattern::IsCaseSensitive()) {
+      boost::algorithm::to_lower(key);
+    }
+    return key;
+  }
+
+  template <typename FunctorT>
+  inline void CachedActorList::ForEachTypePrefix(const std::string &type_id, FunctorT &&functor) {
+    for (auto dot = type_id.find('.'); dot != std::string::npos; dot = type_id.find('.', dot + 1u)) {
+      functor(type_id.substr(0u, dot));
+    }
+    functor(type_id);
+  }
+
+  inline void CachedActorList::IndexTypeId(const rpc::Actor &actor) {
+    ForEachTypePrefix(actor.description.id, [&](std::string prefix) {
+      _ids_by_type_prefix[std::move(prefix)].push_back(actor.id);
+    });
+    _indexed_ids.insert(actor.id);
+  }
+
   inline void CachedActorList::Clear() {
     std::lock_guard<std::mutex> lock(_mutex);
     _actors.clear();
+    _ids_by_type_prefix.clear();
+    _indexed_ids.clear();
   }
 
 } // namespace detail
@@ -0,0 +1,157 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/client/detail/CallbackExecutor.h"
+
+#include "carla/Debug.h"
+#include "carla/Logging.h"
+
+#include <boost/asio/post.hpp>
+
+#include <algorithm>
+#include <exception>
+
+namespace carla {
+namespace client {
+namespace detail {
+
+  constexpr size_t CallbackExecutor::DEFAULT_MAX_QUEUE_DEPTH;
+
+  static void InvokeCallback(const std::function<void()> &callback) {
+    try {
+      callback();
+    } catch (const std::exception &e) {
+      log_error("exception in stream callback:", e.what());
+    } catch (...) {
+      log_error("unknown exception in stream callback");
+    }
+  }
+
+  // ===========================================================================
+  // -- CallbackExecutor::Queue ------------------------------------------------
+  // ===========================================================================
+
+  void CallbackExecutor::Queue::Post(std::function<void()> callback) {
+    if ((_policy == CallbackPolicy::Inline) || (_executor._worker_count == 0u)) {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        ++_stats.executed;
+      }
+      InvokeCallback(callback);
+      return;
+    }
+    bool schedule = false;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if ((_policy == CallbackPolicy::LatestOnly) && !_pending.empty()) {
+        // 尚未执行的旧快照已经过时，只保留最新的一个。
+        _stats.coalesced += _pending.size();
+        _pending.clear();
+      } else if ((_max_depth > 0u) && (_pending.size() >= _max_depth)) {
+        // 回调跟不上数据的速度，丢弃最旧的数据而不是无限积压。
+        _pending.pop_front();
+        ++_stats.dropped;
+      }
+      _pending.push_back(Pending{std::move(callback), clock::now()});
+      _stats.depth = _pending.size();
+      _stats.max_depth = std::max(_stats.max_depth, _stats.depth);
+      schedule = !_scheduled;
+      _scheduled = true;
+    }
+    if (schedule) {
+      auto self = shared_from_this();
+      boost::asio::post(_executor._thread_pool.io_context(), [self]() { self->RunOne(); });
+    }
+  }
+
+  void CallbackExecutor::Queue::RunOne() {
+    Pending item;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      DEBUG_ASSERT(_scheduled);
+      if (_pending.empty()) {
+        _scheduled = false;
+        return;
+      }
+      item = std::move(_pending.front());
+      _pending.pop_front();
+      _stats.depth = _pending.size();
+      const auto latency = static_cast<size_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+          clock::now() - item.enqueued).count());
+      _stats.total_latency_us += latency;
+      _stats.max_latency_us = std::max(_stats.max_latency_us, latency);
+    }
+    InvokeCallback(item.callback);
+    bool reschedule;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      ++_stats.executed;
+      reschedule = !_pending.empty();
+      _scheduled = reschedule;
+    }
+    // 每次只执行一个回调后重新排队，让其它流的队列有机会执行。
+    if (reschedule) {
+      auto self = shared_from_this();
+      boost::asio::post(_executor._thread_pool.io_context(), [self]() { self->RunOne(); });
+    }
+  }
+
+  CallbackQueueStats CallbackExecutor::Queue::GetStats() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+  }
+
+  // ===========================================================================
+  // -- CallbackExecutor -------------------------------------------------------
+  // ===========================================================================
+
+  CallbackExecutor::CallbackExecutor(size_t worker_threads)
+    : _worker_count(worker_threads) {
+    if (_worker_count > 0u) {
+      _thread_pool.AsyncRun(_worker_count);
+    }
+  }
+
+  CallbackExecutor::~CallbackExecutor() {
+    _thread_pool.Stop();
+  }
+
+  std::shared_ptr<CallbackExecutor::Queue> CallbackExecutor::MakeQueue(
+      CallbackPolicy policy,
+      size_t max_depth) {
+    auto queue = std::make_shared<Queue>(*this, policy, max_depth);
+    std::lock_guard<std::mutex> lock(_queues_mutex);
+    // 顺便清理已经销毁的队列。
+    _queues.erase(
+        std::remove_if(_queues.begin(), _queues.end(), [](const auto &weak) { return weak.expired(); }),
+        _queues.end());
+    _queues.emplace_back(queue);
+    return queue;
+  }
+
+  CallbackQueueStats CallbackExecutor::GetStats() const {
+    CallbackQueueStats result;
+    std::lock_guard<std::mutex> lock(_queues_mutex);
+    for (const auto &weak : _queues) {
+      auto queue = weak.lock();
+      if (queue == nullptr) {
+        continue;
+      }
+      const auto stats = queue->GetStats();
+      result.depth += stats.depth;
+      result.max_depth = std::max(result.max_depth, stats.max_depth);
+      result.executed += stats.executed;
+      result.coalesced += stats.coalesced;
+      result.dropped += stats.dropped;
+      result.total_latency_us += stats.total_latency_us;
+      result.max_latency_us = std::max(result.max_latency_us, stats.max_latency_us);
+    }
+    return result;
+  }
+
+} // namespace detail
+} // namespace client
+} // namespace carla
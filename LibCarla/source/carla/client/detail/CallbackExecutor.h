@@ -0,0 +1,124 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/ThreadPool.h"
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace carla {
+namespace client {
+namespace detail {
+
+  /// 回调在队列中的执行方式。
+  enum class CallbackPolicy {
+    Inline,     ///< 在调用 Post 的线程中立即执行（即流客户端的网络线程）
+    Serial,     ///< 按顺序执行每个回调，积压达到队列上限时丢弃最旧的回调
+    LatestOnly  ///< 只执行最新的回调，尚未执行的旧回调被合并丢弃
+  };
+
+  /// 回调队列的统计，时间均以微秒计。
+  struct CallbackQueueStats {
+    size_t depth = 0u;           ///< 当前排队中的回调数
+    size_t max_depth = 0u;       ///< 排队回调数的历史最大值
+    size_t executed = 0u;        ///< 已执行的回调数
+    size_t coalesced = 0u;       ///< 被更新的回调合并丢弃的回调数
+    size_t dropped = 0u;         ///< 队列已满时丢弃的最旧回调数
+    size_t total_latency_us = 0u; ///< 从入队到开始执行的累计等待时间
+    size_t max_latency_us = 0u;  ///< 从入队到开始执行的最长等待时间
+  };
+
+  /// 在独立线程池中执行流数据的用户回调，使网络线程从不等待用户代码。
+  ///
+  /// 每个流拥有自己的队列，同一队列中的回调按顺序在某个工作线程中执行，
+  /// 不同队列之间并行执行；一个慢回调只会使它自己的队列积压，积压的长度
+  /// 有上限，超出时丢弃最旧的回调（及其持有的传感器数据），内存不会无限增长。
+  class CallbackExecutor : private NonCopyable {
+  public:
+
+    using clock = std::chrono::steady_clock;
+
+    /// Serial 队列默认的积压上限，约为 20 FPS 下一秒的数据。
+    static constexpr size_t DEFAULT_MAX_QUEUE_DEPTH = 20u;
+
+    class Queue : public std::enable_shared_from_this<Queue>, private NonCopyable {
+    public:
+
+      /// @param max_depth 排队回调数的上限，为 0 时不限。
+      Queue(CallbackExecutor &executor, CallbackPolicy policy, size_t max_depth)
+        : _executor(executor),
+          _policy(policy),
+          _max_depth(max_depth) {}
+
+      /// 将回调入队；Inline 队列直接执行回调。
+      void Post(std::function<void()> callback);
+
+      CallbackQueueStats GetStats() const;
+
+    private:
+
+      struct Pending {
+        std::function<void()> callback;
+        clock::time_point enqueued;
+      };
+
+      /// 在工作线程中执行一个回调，队列不为空时重新调度自己。
+      void RunOne();
+
+      CallbackExecutor &_executor;
+
+      const CallbackPolicy _policy;
+
+      const size_t _max_depth;
+
+      mutable std::mutex _mutex;
+
+      std::deque<Pending> _pending;
+
+      /// 队列已提交到线程池、尚未执行完毕时为 true，保证同一队列串行执行。
+      bool _scheduled = false;
+
+      CallbackQueueStats _stats;
+    };
+
+    /// @param worker_threads 工作线程数，为 0 时所有队列都在网络线程中
+    ///        直接执行回调（与没有执行器时的行为相同）。
+    explicit CallbackExecutor(size_t worker_threads);
+
+    ~CallbackExecutor();
+
+    /// @param max_depth Serial 队列排队回调数的上限，为 0 时不限，例如不能
+    ///        丢失的事件回调。
+    std::shared_ptr<Queue> MakeQueue(CallbackPolicy policy, size_t max_depth = DEFAULT_MAX_QUEUE_DEPTH);
+
+    /// 所有仍然存在的队列的统计之和，max_* 取各队列的最大值。
+    CallbackQueueStats GetStats() const;
+
+    size_t GetWorkerCount() const {
+      return _worker_count;
+    }
+
+  private:
+
+    const size_t _worker_count;
+
+    mutable std::mutex _queues_mutex;
+
+    std::vector<std::weak_ptr<Queue>> _queues;
+
+    ThreadPool _thread_pool;
+  };
+
+} // namespace detail
+} // namespace client
+} // namespace carla
@@ -10,6 +10,7 @@
 #include "carla/Version.h"
 #include "carla/client/FileTransfer.h"
 #include "carla/client/TimeoutException.h"
+#include "carla/profiler/Tracer.h"
 #include "carla/rpc/AckermannControllerSettings.h"
 #include "carla/rpc/ActorDescription.h"
 #include "carla/rpc/BoneTransformDataIn.h"
@@ -48,9 +49,10 @@ namespace detail {
   class Client::Pimpl {
   public:
 
-    Pimpl(const std::string &host, uint16_t port, size_t worker_threads)
+    Pimpl(const std::string &host, uint16_t port, size_t worker_threads, size_t callback_threads)
       : endpoint(host + ":" + std::to_string(port)),
         rpc_client(host, port),
+        callback_executor(callback_threads),
         streaming_client(host) {
       rpc_client.set_timeout(5000u);
       streaming_client.AsyncRun(
@@ -59,6 +61,7 @@ namespace detail {
 
     template <typename ... Args>
     auto RawCall(const std::string &function, Args && ... args) {
+      CARLA_TRACE_SCOPE("rpc", function);
       try {
         return rpc_client.call(function, std::forward<Args>(args) ...);
       } catch (const ::rpc::timeout &) {
@@ -80,6 +83,7 @@ namespace detail {
     template <typename ... Args>
     void AsyncCall(const std::string &function, Args && ... args) {
       // Discard returned future.
+      CARLA_TRACE_INSTANT("rpc", function.c_str());
       rpc_client.async_call(function, std::forward<Args>(args) ...);
     }
 
@@ -93,7 +97,28 @@ namespace detail {
 
     rpc::Client rpc_client;
 
+    /// 必须在 streaming_client 之前构造、之后销毁，流的回调会引用其中的队列。
+    CallbackExecutor callback_executor;
+
     streaming::Client streaming_client;
+
+    /// 在回调执行器中执行 @a callback 的流回调。
+    std::function<void(Buffer)> WrapCallback(
+        std::function<void(Buffer)> callback,
+        CallbackPolicy policy) {
+      if (policy == CallbackPolicy::Inline || callback_executor.GetWorkerCount() == 0u) {
+        return callback;
+      }
+      auto queue = callback_executor.MakeQueue(policy);
+      auto shared_callback = std::make_shared<std::function<void(Buffer)>>(std::move(callback));
+      return [queue, shared_callback](Buffer buffer) {
+        // std::function 要求可复制，因此用共享指针持有缓冲区。
+        auto shared_buffer = std::make_shared<Buffer>(std::move(buffer));
+        queue->Post([shared_callback, shared_buffer]() {
+          (*shared_callback)(std::move(*shared_buffer));
+        });
+      };
+    }
   };
 
   // ===========================================================================
@@ -103,8 +128,9 @@ namespace detail {
   Client::Client(
       const std::string &host,
       const uint16_t port,
-      const size_t worker_threads)
-    : _pimpl(std::make_unique<Pimpl>(host, port, worker_threads)) {}
+      const size_t worker_threads,
+      const size_t callback_threads)
+    : _pimpl(std::make_unique<Pimpl>(host, port, worker_threads, callback_threads)) {}
 
   bool Client::IsTrafficManagerRunning(uint16_t port) const {
     return _pimpl->CallAndWait<bool>("is_traffic_manager_running", port);
@@ -648,18 +674,43 @@ namespace detail {
     _pimpl->AsyncCall("set_replayer_ignore_spectator", ignore_spectator);
   }
 
+  void Client::SetRecorderCompression(bool enabled) {
+    _pimpl->AsyncCall("set_recorder_compression", enabled);
+  }
+
   void Client::SubscribeToStream(
       const streaming::Token &token,
-      std::function<void(Buffer)> callback) {
+      std::function<void(Buffer)> callback,
+      CallbackPolicy policy) {
     carla::streaming::detail::token_type thisToken(token);
     streaming::Token receivedToken = _pimpl->CallAndWait<streaming::Token>("get_sensor_token", thisToken.get_stream_id());
-    _pimpl->streaming_client.Subscribe(receivedToken, std::move(callback));
+    _pimpl->streaming_client.Subscribe(receivedToken, _pimpl->WrapCallback(std::move(callback), policy));
+  }
+
+  std::shared_ptr<CallbackExecutor::Queue> Client::MakeCallbackQueue(
+      CallbackPolicy policy,
+      size_t max_depth) {
+    return _pimpl->callback_executor.MakeQueue(policy, max_depth);
+  }
+
+  CallbackQueueStats Client::GetCallbackStats() const {
+    return _pimpl->callback_executor.GetStats();
   }
 
   void Client::UnSubscribeFromStream(const streaming::Token &token) {
     _pimpl->streaming_client.UnSubscribe(token);
   }
 
+  streaming::Token Client::SubscribeToEpisodeState(const rpc::EpisodeStateFilter &filter) {
+    return _pimpl->CallAndWait<streaming::Token>("subscribe_to_episode_state", filter);
+  }
+
+  void Client::UnSubscribeFromEpisodeState(const streaming::Token &token) {
+    _pimpl->streaming_client.UnSubscribe(token);
+    carla::streaming::detail::token_type thisToken(token);
+    _pimpl->AsyncCall("unsubscribe_from_episode_state", thisToken.get_stream_id());
+  }
+
   void Client::EnableForROS(const streaming::Token &token) {
     carla::streaming::detail::token_type thisToken(token);
     _pimpl->AsyncCall("enable_sensor_for_ros", thisToken.get_stream_id());
@@ -687,7 +738,7 @@ namespace detail {
     std::vector<unsigned char> token_data = _pimpl->CallAndWait<std::vector<unsigned char>>("get_gbuffer_token", ActorId, GBufferId);
     streaming::Token token;
     std::memcpy(&token.data[0u], token_data.data(), token_data.size());
-    _pimpl->streaming_client.Subscribe(token, std::move(callback));
+    _pimpl->streaming_client.Subscribe(token, _pimpl->WrapCallback(std::move(callback), CallbackPolicy::Serial));
   }
 
   void Client::UnSubscribeFromGBuffer(
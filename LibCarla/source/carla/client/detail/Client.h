@@ -9,6 +9,7 @@
 #include "carla/Memory.h"
 #include "carla/NonCopyable.h"
 #include "carla/Time.h"
+#include "carla/client/detail/CallbackExecutor.h"
 #include "carla/geom/Transform.h"
 #include "carla/geom/Location.h"
 #include "carla/rpc/Actor.h"
@@ -19,6 +20,7 @@
 #include "carla/rpc/EnvironmentObject.h"
 #include "carla/rpc/EpisodeInfo.h"
 #include "carla/rpc/EpisodeSettings.h"
+#include "carla/rpc/EpisodeStateFilter.h"
 #include "carla/rpc/LabelledPoint.h"
 #include "carla/rpc/LightState.h"
 #include "carla/rpc/MapInfo.h"
@@ -71,10 +73,13 @@ namespace detail {
   class Client : private NonCopyable {
   public:
 
+    /// @param callback_threads 执行流数据回调的线程数，为 0 时回调直接在
+    ///        流客户端的网络线程中执行。
     explicit Client(
         const std::string &host,
         uint16_t port,
-        size_t worker_threads = 0u);
+        size_t worker_threads = 0u,
+        size_t callback_threads = 1u);
 
     ~Client();
 
@@ -410,11 +415,24 @@ namespace detail {
 
     void SetReplayerIgnoreSpectator(bool ignore_spectator);
 
+    void SetRecorderCompression(bool enabled);
+
     void StopReplayer(bool keep_actors);
 
+    /// 订阅流数据，@a callback 按 @a policy 在回调执行器中执行。
     void SubscribeToStream(
         const streaming::Token &token,
-        std::function<void(Buffer)> callback);
+        std::function<void(Buffer)> callback,
+        CallbackPolicy policy = CallbackPolicy::Serial);
+
+    /// 创建一个在回调执行器中执行的回调队列，@a max_depth 见
+    /// CallbackExecutor::MakeQueue。
+    std::shared_ptr<CallbackExecutor::Queue> MakeCallbackQueue(
+        CallbackPolicy policy,
+        size_t max_depth = CallbackExecutor::DEFAULT_MAX_QUEUE_DEPTH);
+
+    /// 所有回调队列的积压与延迟统计。
+    CallbackQueueStats GetCallbackStats() const;
 
     void SubscribeToGBuffer(
         rpc::ActorId ActorId,
@@ -423,6 +441,12 @@ namespace detail {
 
     void UnSubscribeFromStream(const streaming::Token &token);
 
+    /// 在服务器上创建只包含满足 @a filter 的参与者的仿真状态流。
+    streaming::Token SubscribeToEpisodeState(const rpc::EpisodeStateFilter &filter);
+
+    /// 关闭 SubscribeToEpisodeState 创建的流。
+    void UnSubscribeFromEpisodeState(const streaming::Token &token);
+
     void EnableForROS(const streaming::Token &token);
 
     void DisableForROS(const streaming::Token &token);
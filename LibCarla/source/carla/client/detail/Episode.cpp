@@ -10,8 +10,10 @@
 #include "carla/client/detail/Client.h"
 #include "carla/client/detail/WalkerNavigation.h"
 #include "carla/sensor/Deserializer.h"
+#include "carla/streaming/StreamMetrics.h"
 #include "carla/trafficmanager/TrafficManager.h"
 
+#include <algorithm>
 #include <exception>
 
 namespace carla {
@@ -43,6 +45,9 @@ using namespace std::chrono_literals;
   Episode::Episode(Client &client, const rpc::EpisodeInfo &info, std::weak_ptr<Simulator> simulator)
     : _client(client),
       _state(std::make_shared<EpisodeState>(info.id)),
+      _tick_callback_queue(client.MakeCallbackQueue(CallbackPolicy::LatestOnly)),
+      // 光照与地图变化是事件而不是数据流，不能丢弃
+      _light_update_callback_queue(client.MakeCallbackQueue(CallbackPolicy::Serial, 0u)),
       _simulator(simulator),
       _token(info.token) {}
 // 析构函数，尝试取消订阅流并处理可能的异常
@@ -56,9 +61,12 @@ using namespace std::chrono_literals;
 // 开始监听流数据的函数
   void Episode::Listen() {
     std::weak_ptr<Episode> weak = shared_from_this();
+    // 仿真状态在网络线程中直接解析，以便尽快唤醒 WaitForTick；
+    // 用户回调则在回调执行器中执行，不会阻塞后续数据的接收。
     _client.SubscribeToStream(_token, [weak](auto buffer) {
       auto self = weak.lock();
       if (self != nullptr) {
+        const auto arrival = streaming::StreamCounters::Now();
         // 反序列化数据
         auto data = sensor::Deserializer::Deserialize(std::move(buffer));
         auto next = std::make_shared<const EpisodeState>(CastData(*data));
@@ -85,13 +93,13 @@ using namespace std::chrono_literals;
 
           do {
             if (prev->GetFrame() >= next->GetFrame() && !episode_changed) {
-              self->_on_tick_callbacks.Call(next);
+              self->PostTickCallbacks(next);
               return;
             }
           } while (!self->_state.compare_exchange(&prev, next));
 
           if(UpdateLights || HasMapChanged) {
-            self->_on_light_update_callbacks.Call(next);
+            self->PostLightUpdateCallbacks(next);
           }
 
           if(HasMapChanged) {
@@ -100,16 +108,41 @@ using namespace std::chrono_literals;
 
           /// Episode 改变
           if(episode_changed) {
+            // 不同剧集的状态之间不能插值
+            self->_state_history.Clear();
+            self->_arrival_times.Clear();
             self->OnEpisodeChanged();
           }
+          self->_state_history.Push(next);
+          self->_arrival_times.Record(next->GetFrame(), arrival);
 
           // 通知等待的线程并执行回调。
           self->_snapshot.SetValue(next);
 
           // 调用用户回调函数
-          self->_on_tick_callbacks.Call(next);
+          self->PostTickCallbacks(next);
         }
       }
+    }, CallbackPolicy::Inline);
+  }
+
+  void Episode::PostTickCallbacks(std::shared_ptr<const EpisodeState> state) {
+    std::weak_ptr<Episode> weak = shared_from_this();
+    _tick_callback_queue->Post([weak, state=std::move(state)]() {
+      auto self = weak.lock();
+      if (self != nullptr) {
+        self->_on_tick_callbacks.Call(state);
+      }
+    });
+  }
+
+  void Episode::PostLightUpdateCallbacks(std::shared_ptr<const EpisodeState> state) {
+    std::weak_ptr<Episode> weak = shared_from_this();
+    _light_update_callback_queue->Post([weak, state=std::move(state)]() {
+      auto self = weak.lock();
+      if (self != nullptr) {
+        self->_on_light_update_callbacks.Call(state);
+      }
     });
   }
 // 根据参与者ID获取单个参与者，如果不存在则从客户端获取并插入到缓存中
@@ -128,13 +161,69 @@ using namespace std::chrono_literals;
   std::vector<rpc::Actor> Episode::GetActorsById(const std::vector<ActorId> &actor_ids) {
     return GetActorsById_Impl(_client, _actors, actor_ids);
   }
-// 获取所有参与者列表，使用模板函数实现
+// 获取所有参与者列表
   std::vector<rpc::Actor> Episode::GetActors() {
-    return GetActorsById_Impl(_client, _actors, GetState()->GetActorIds());
+    return GetActors(*GetState());
+  }
+
+  std::vector<rpc::Actor> Episode::GetActors(const EpisodeState &state) {
+    CacheActorsOf(state);
+    return _actors.GetActorsById(state.GetActorIds());
+  }
+
+  std::vector<rpc::Actor> Episode::GetActorsMatching(const EpisodeState &state, const WildcardPattern &pattern) {
+    CacheActorsOf(state);
+    const auto key = CachedActorList::GetIndexKey(pattern);
+    std::vector<rpc::Actor> result;
+    if (key.has_value()) {
+      // 索引可能落后于 state（例如在其他线程中更新），只保留仍在 state 中的参与者。
+      auto ids = _actors.GetIdsByTypePrefix(*key);
+      ids.erase(std::remove_if(ids.begin(), ids.end(), [&](ActorId id) {
+        return !state.ContainsActorSnapshot(id);
+      }), ids.end());
+      result = _actors.GetActorsById(ids);
+    } else {
+      result = _actors.GetActorsById(state.GetActorIds());
+    }
+    result.erase(std::remove_if(result.begin(), result.end(), [&](const rpc::Actor &actor) {
+      return !pattern.Match(actor.description.id);
+    }), result.end());
+    return result;
+  }
+
+  void Episode::CacheActorsOf(const EpisodeState &state) {
+    // 参与者 ID 集合没有变化时，所有参与者在上次就已经缓存，无需逐个检查。
+    {
+      std::lock_guard<std::mutex> lock(_cached_state_mutex);
+      if (_cached_state_size == state.size() && _cached_state_digest == state.GetActorIdDigest()) {
+        return;
+      }
+    }
+    auto missing_ids = _actors.GetMissingIds(state.GetActorIds());
+    bool complete = true;
+    if (!missing_ids.empty()) {
+      auto actors = _client.GetActorsById(missing_ids);
+      complete = (actors.size() == missing_ids.size());
+      _actors.InsertRange(std::move(actors));
+    }
+    // 参与者集合有变化，将已销毁的参与者移出类型索引。
+    _actors.UpdateTypeIndex(state.GetActorIds());
+    if (!complete) {
+      // 服务器没有返回全部参与者（例如刚被销毁），下次仍需检查。
+      return;
+    }
+    std::lock_guard<std::mutex> lock(_cached_state_mutex);
+    _cached_state_digest = state.GetActorIdDigest();
+    _cached_state_size = state.size();
   }
 // 当Episode开始时的处理函数
   void Episode::OnEpisodeStarted() {
     _actors.Clear();
+    {
+      std::lock_guard<std::mutex> lock(_cached_state_mutex);
+      _cached_state_digest = 0u;
+      _cached_state_size = 0u;
+    }
     _on_tick_callbacks.Clear();
     _walker_navigation.reset();
     traffic_manager::TrafficManager::Release();
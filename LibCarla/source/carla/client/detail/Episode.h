@@ -12,11 +12,15 @@
 #include "carla/client/Timestamp.h" // 引入时间戳
 #include "carla/client/WorldSnapshot.h" // 引入世界快照
 #include "carla/client/detail/CachedActorList.h" // 引入缓存参与者列表
+#include "carla/client/detail/CallbackExecutor.h" // 引入回调执行器
 #include "carla/client/detail/CallbackList.h" // 引入回调列表
 #include "carla/client/detail/EpisodeState.h" // 引入剧集状态
 #include "carla/client/detail/EpisodeProxy.h" // 引入剧集代理
+#include "carla/client/detail/StateHistory.h" // 引入按帧索引的状态历史
 #include "carla/rpc/EpisodeInfo.h" // 引入剧集信息
 
+#include <atomic> // 引入原子类型
+#include <mutex> // 引入互斥锁
 #include <vector> // 引入向量类
 
 namespace carla {
@@ -49,15 +53,37 @@ namespace detail {
       return _state.load();
     }
 
-    void RegisterParticipant(rpc::Actor actor) { // 注册参与者
+    /// 最近收到的帧号为 @a frame 的状态，不在历史中时返回 nullptr。
+    std::shared_ptr<const EpisodeState> GetStateByFrame(uint64_t frame) const {
+      return _state_history.GetByFrame(frame);
+    }
+
+    /// 由历史中前后两帧插值得到参与者在仿真时间 @a elapsed_seconds 的变换。
+    boost::optional<geom::Transform> GetActorTransformAt(ActorId id, double elapsed_seconds) const {
+      return _state_history.GetActorTransformAt(id, elapsed_seconds);
+    }
+
+    /// 帧 @a frame 的传感器数据在 @a now（steady_clock 纳秒）到达时的延迟，
+    /// 以同一帧的世界状态到达客户端的时刻为起点，见 FrameArrivalTimes。
+    boost::optional<uint64_t> GetSensorLatency(uint64_t frame, uint64_t now) const {
+      return _arrival_times.GetLatency(frame, now);
+    }
+
+    void RegisterActor(rpc::Actor actor) { // 注册参与者
       _actors.Insert(std::move(actor));
     }
 
-    boost::optional<rpc::Actor> GetParticipantById(ActorId id); // 根据 ID 获取参与者
+    boost::optional<rpc::Actor> GetActorById(ActorId id); // 根据 ID 获取参与者
+
+    std::vector<rpc::Actor> GetActorsById(const std::vector<ActorId> &actor_ids); // 根据 ID 列表获取参与者
+
+    std::vector<rpc::Actor> GetActors(); // 获取所有参与者
 
-    std::vector<rpc::Actor> GetParticipantsById(const std::vector<ActorId> &actor_ids); // 根据 ID 列表获取参与者
+    std::vector<rpc::Actor> GetActors(const EpisodeState &state); // 获取 state 中的所有参与者
 
-    std::vector<rpc::Actor> GetParticipants(); // 获取所有参与者
+    /// 获取 @a state 中类型 ID 与 @a pattern 匹配的参与者。能从模式得到类型 ID
+    /// 前缀时只检查索引中该前缀下的参与者，耗时与结果数量成正比。
+    std::vector<rpc::Actor> GetActorsMatching(const EpisodeState &state, const WildcardPattern &pattern);
 
     boost::optional<WorldSnapshot> WaitForState(time_duration timeout) { // 等待状态变化
       return _snapshot.WaitFor(timeout);
@@ -108,20 +134,43 @@ namespace detail {
 
     void OnEpisodeChanged(); // 处理剧集变化事件
 
+    void CacheActorsOf(const EpisodeState &state); // 确保 state 中的所有参与者都已缓存
+
+    void PostTickCallbacks(std::shared_ptr<const EpisodeState> state); // 在回调执行器中调用 tick 回调
+
+    void PostLightUpdateCallbacks(std::shared_ptr<const EpisodeState> state); // 在回调执行器中调用光照更新回调
+
     Client &_client; // 引用客户端
 
     AtomicSharedPtr<const EpisodeState> _state; // 原子共享指针指向剧集状态
 
+    /// 保留的历史帧数，约为同步模式下 20 FPS 的三秒。
+    static constexpr size_t STATE_HISTORY_CAPACITY = 64u;
+
+    StateHistory<const EpisodeState> _state_history{STATE_HISTORY_CAPACITY}; // 最近若干帧的状态
+
+    FrameArrivalTimes _arrival_times{STATE_HISTORY_CAPACITY}; // 最近若干帧的状态到达时刻
+
     std::string _pending_exceptions_msg; // 待处理异常消息
 
     CachedActorList _actors; // 缓存的参与者列表
 
+    std::mutex _cached_state_mutex; // 保护下面两个成员
+
+    uint64_t _cached_state_digest = 0u; // 最近一次缓存完整的参与者 ID 集合的摘要
+
+    size_t _cached_state_size = 0u; // 以及该集合的参与者数量，两者都为 0 表示尚未缓存
+
     CallbackList<WorldSnapshot> _on_tick_callbacks; // tick 事件回调列表
 
     CallbackList<WorldSnapshot> _on_map_change_callbacks; // 地图变化事件回调列表
 
     CallbackList<WorldSnapshot> _on_light_update_callbacks; // 光照更新事件回调列表
 
+    std::shared_ptr<CallbackExecutor::Queue> _tick_callback_queue; // tick 回调队列，只执行最新的快照
+
+    std::shared_ptr<CallbackExecutor::Queue> _light_update_callback_queue; // 光照更新回调队列，按顺序执行
+
     RecurrentSharedFuture<WorldSnapshot> _snapshot; // 递归共享未来的世界快照
 
     AtomicSharedPtr<WalkerNavigation> _walker_navigation; // 原子共享指针指向 WalkerNavigation
@@ -10,6 +10,15 @@ namespace carla {
 namespace client {
 namespace detail {
 
+  /// 将参与者 ID 打散为 64 位值（splitmix64 的最终混合步骤），
+  /// 各 ID 的结果相加即得到与顺序无关的集合摘要。
+  static uint64_t MixActorId(ActorId id) {
+    uint64_t x = static_cast<uint64_t>(id) + 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30u)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27u)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31u);
+  }
+
   EpisodeState::EpisodeState(const sensor::data::RawEpisodeState &state)
     : _episode_id(state.GetEpisodeId()),
       _timestamp(
@@ -33,6 +42,7 @@ namespace detail {
               actor.acceleration,
               actor.state});
       DEBUG_ASSERT(result.second);
+      _actor_id_digest += MixActorId(actor.id);
     }
   }
 
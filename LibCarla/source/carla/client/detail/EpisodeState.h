@@ -94,6 +94,12 @@ namespace detail { // 定义detail子命名空间
           iterator::make_map_keys_const_iterator(_actors.end())); // 获取参与者ID迭代器
     }
 
+    /// 当前帧参与者 ID 集合的摘要，与顺序无关。相邻两帧的摘要和参与者
+    /// 数量都相同时，可以认为参与者集合没有变化，无需逐个比较 ID。
+    uint64_t GetActorIdDigest() const {
+      return _actor_id_digest;
+    }
+
     // 获取参与者数量
     size_t size() const {
       return _actors.size(); // 返回参与者数量
@@ -128,6 +134,8 @@ namespace detail { // 定义detail子命名空间
 
     SimulationState _simulation_state; // 存储模拟状态
 
+    uint64_t _actor_id_digest = 0u; // 参与者 ID 集合的摘要
+
     std::unordered_map<ActorId, ActorSnapshot> _actors; // 存储参与者快照的无序映射
   };
 
@@ -20,6 +20,8 @@
 #include "carla/client/detail/WalkerNavigation.h"
 #include "carla/trafficmanager/TrafficManager.h"
 #include "carla/sensor/Deserializer.h"
+#include "carla/streaming/StreamMetrics.h"
+#include "carla/streaming/detail/Token.h"
 
 #include <exception>
 #include <thread>
@@ -73,9 +75,10 @@ namespace detail {
       const std::string &host,
       const uint16_t port,
       const size_t worker_threads,
-      const bool enable_garbage_collection)
+      const bool enable_garbage_collection,
+      const size_t callback_threads)
     : LIBCARLA_INITIALIZE_LIFETIME_PROFILER("SimulatorClient("s + host + ":" + std::to_string(port) + ")"),
-      _client(host, port, worker_threads),
+      _client(host, port, worker_threads, callback_threads),
       _light_manager(new LightManager()),
       _gc_policy(enable_garbage_collection ?
         GarbageCollectionPolicy::Enabled : GarbageCollectionPolicy::Disabled) {}
@@ -405,11 +408,24 @@ EpisodeProxy Simulator::GetCurrentEpisode() {
       const Sensor &sensor,
       std::function<void(SharedPtr<sensor::SensorData>)> callback) {
     DEBUG_ASSERT(_episode != nullptr);
+    const auto &token = sensor.GetActorDescription().GetStreamToken();
+    const auto stream_id = streaming::detail::token_type(token).get_stream_id();
     _client.SubscribeToStream(
-        sensor.GetActorDescription().GetStreamToken(),
-        [cb=std::move(callback), ep=WeakEpisodeProxy{shared_from_this()}](auto buffer) {
+        token,
+        [cb=std::move(callback),
+         ep=WeakEpisodeProxy{shared_from_this()},
+         episode=std::weak_ptr<Episode>(_episode),
+         metrics=streaming::StreamMetrics::Get(stream_id)](auto buffer) {
           auto data = sensor::Deserializer::Deserialize(std::move(buffer));
           data->_episode = ep.TryLock();
+          // 端到端延迟以同一帧的世界状态到达客户端的时刻为起点。
+          auto self = episode.lock();
+          if (self != nullptr) {
+            const auto latency = self->GetSensorLatency(data->GetFrame(), streaming::StreamCounters::Now());
+            if (latency.has_value()) {
+              metrics->RecordLatency(*latency);
+            }
+          }
           cb(std::move(data));
         });
   }
@@ -419,6 +435,22 @@ EpisodeProxy Simulator::GetCurrentEpisode() {
     // 如果将来我们需要单独取消订阅每个 gbuffer，则应该在这里完成。
   }
 
+  streaming::Token Simulator::SubscribeToEpisodeState(
+      const rpc::EpisodeStateFilter &filter,
+      std::function<void(WorldSnapshot)> callback) {
+    const auto token = _client.SubscribeToEpisodeState(filter);
+    _client.SubscribeToStream(token, [cb=std::move(callback)](auto buffer) {
+      auto data = sensor::Deserializer::Deserialize(std::move(buffer));
+      const auto &raw = static_cast<const sensor::data::RawEpisodeState &>(*data);
+      cb(WorldSnapshot{std::make_shared<const EpisodeState>(raw)});
+    });
+    return token;
+  }
+
+  void Simulator::UnSubscribeFromEpisodeState(const streaming::Token &token) {
+    _client.UnSubscribeFromEpisodeState(token);
+  }
+
   void Simulator::EnableForROS(const Sensor &sensor) {
     _client.EnableForROS(sensor.GetActorDescription().GetStreamToken());
   }
@@ -61,7 +61,8 @@ namespace detail {
         const std::string &host,      // 主服务器的IP地址
         uint16_t port,                // 连接主服务器的端口号，默认为 2000
         size_t worker_threads = 0u,   // 仿真器使用的工作线程数，默认全部启用
-        bool enable_garbage_collection = false);    // 是否启用垃圾回收，默认不启用
+        bool enable_garbage_collection = false,    // 是否启用垃圾回收，默认不启用
+        size_t callback_threads = 1u);    // 执行流数据回调的线程数，0 表示在网络线程中执行
 
     /// @}
     // =========================================================================
@@ -125,6 +126,21 @@ namespace detail {
       return WorldSnapshot{_episode->GetState()};
     }
 
+    /// 历史中帧号为 @a frame 的快照，该帧已不在历史中时返回空。
+    boost::optional<WorldSnapshot> GetWorldSnapshot(uint64_t frame) const {
+      DEBUG_ASSERT(_episode != nullptr);
+      auto state = _episode->GetStateByFrame(frame);
+      if (state == nullptr) {
+        return boost::none;
+      }
+      return WorldSnapshot{std::move(state)};
+    }
+
+    boost::optional<geom::Transform> GetActorTransformAt(ActorId id, double elapsed_seconds) const {
+      DEBUG_ASSERT(_episode != nullptr);
+      return _episode->GetActorTransformAt(id, elapsed_seconds);
+    }
+
     /// @}
     // =========================================================================
     /// @name 地图相关的方法
@@ -175,6 +191,10 @@ namespace detail {
       return _client.GetTimeout();
     }
 
+    CallbackQueueStats GetCallbackStats() const {
+      return _client.GetCallbackStats();
+    }
+
     std::string GetClientVersion() {
       return _client.GetClientVersion();
     }
@@ -341,6 +361,23 @@ namespace detail {
       return _episode->GetActors();
     }
 
+    /// 当前的剧集状态，用于之后在同一帧上查询参与者。
+    std::shared_ptr<const EpisodeState> GetEpisodeState() const {
+      DEBUG_ASSERT(_episode != nullptr);
+      return _episode->GetState();
+    }
+
+    std::vector<rpc::Actor> GetAllTheActorsInTheEpisode(const EpisodeState &state) const {
+      DEBUG_ASSERT(_episode != nullptr);
+      return _episode->GetActors(state);
+    }
+
+    /// 返回 @a state 中类型 ID 与 @a pattern 匹配的参与者。
+    std::vector<rpc::Actor> GetActorsMatching(const EpisodeState &state, const WildcardPattern &pattern) const {
+      DEBUG_ASSERT(_episode != nullptr);
+      return _episode->GetActorsMatching(state, pattern);
+    }
+
     /// 根据现有参与者的描述创建一个参与者实例。请注意，这不会生成参与者。
     ///
     /// If @a gc is GarbageCollectionPolicy::Enabled, the shared pointer
@@ -667,6 +704,10 @@ namespace detail {
       _client.SetReplayerIgnoreSpectator(ignore_spectator);
     }
 
+    void SetRecorderCompression(bool enabled) {
+      _client.SetRecorderCompression(enabled);
+    }
+
     void StopReplayer(bool keep_actors) {
       _client.StopReplayer(keep_actors);
   }
@@ -683,6 +724,13 @@ namespace detail {
 
     void UnSubscribeFromSensor(Actor &sensor);
 
+    /// 在服务器上创建过滤后的仿真状态流并订阅，返回流的 token。
+    streaming::Token SubscribeToEpisodeState(
+        const rpc::EpisodeStateFilter &filter,
+        std::function<void(WorldSnapshot)> callback);
+
+    void UnSubscribeFromEpisodeState(const streaming::Token &token);
+
     void EnableForROS(const Sensor &sensor);
 
     void DisableForROS(const Sensor &sensor);
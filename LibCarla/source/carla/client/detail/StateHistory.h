@@ -0,0 +1,250 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/AtomicSharedPtr.h"
+#include "carla/NonCopyable.h"
+#include "carla/geom/Transform.h"
+#include "carla/rpc/ActorId.h"
+
+#include <boost/optional.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace carla {
+namespace client {
+namespace detail {
+
+  /// 在 @a a 与 @a b 之间按 @a alpha 插值变换，旋转角沿最短方向插值。
+  inline geom::Transform InterpolateTransform(
+      const geom::Transform &a,
+      const geom::Transform &b,
+      float alpha) {
+    auto lerp_angle = [alpha](float from, float to) {
+      // 把角度差归一化到 [-180, 180)，避免 179° 到 -179° 绕行一整圈。
+      const float delta = std::fmod(std::fmod(to - from, 360.0f) + 540.0f, 360.0f) - 180.0f;
+      return from + alpha * delta;
+    };
+    geom::Transform result;
+    const geom::Vector3D from = a.location;
+    const geom::Vector3D to = b.location;
+    result.location = geom::Location(from + alpha * (to - from));
+    result.rotation.pitch = lerp_angle(a.rotation.pitch, b.rotation.pitch);
+    result.rotation.yaw = lerp_angle(a.rotation.yaw, b.rotation.yaw);
+    result.rotation.roll = lerp_angle(a.rotation.roll, b.rotation.roll);
+    return result;
+  }
+
+  /// 最近若干帧状态的定长环形缓冲区，按帧号索引。
+  ///
+  /// 帧 f 保存在第 f % capacity 个槽中，按帧号查找只需读取一个槽并核对帧号，
+  /// 复杂度为 O(1)；新帧直接覆盖同一槽中的旧帧，因此内存占用有上界。
+  /// 每个槽都是 AtomicSharedPtr，写入（网络线程）与读取（任意线程）之间
+  /// 不需要额外的锁，读者拿到的状态在其持有期间不会被释放。
+  ///
+  /// @a T 需要提供 GetFrame() 与 GetTimestamp()（见 EpisodeState）。
+  template <typename T>
+  class StateHistory : private NonCopyable {
+  public:
+
+    using StatePtr = std::shared_ptr<T>;
+
+    /// @a capacity 会向上取整为 2 的幂。
+    explicit StateHistory(size_t capacity)
+      : _capacity(RoundUpToPowerOfTwo(capacity)),
+        _slots(new AtomicSharedPtr<T>[_capacity]) {}
+
+    size_t capacity() const {
+      return _capacity;
+    }
+
+    /// 写入一帧状态。只应在一个线程中调用（Episode 的流回调）。
+    void Push(StatePtr state) {
+      if (state == nullptr) {
+        return;
+      }
+      _slots[Index(state->GetFrame())].store(state);
+      _latest.store(std::move(state));
+    }
+
+    /// 清空所有帧，例如切换剧集时。
+    void Clear() {
+      _latest.reset();
+      for (size_t i = 0u; i < _capacity; ++i) {
+        _slots[i].reset();
+      }
+    }
+
+    StatePtr GetLatest() const {
+      return _latest.load();
+    }
+
+    /// 返回帧号为 @a frame 的状态；该帧没有收到或已被覆盖时返回 nullptr。
+    StatePtr GetByFrame(uint64_t frame) const {
+      auto state = _slots[Index(frame)].load();
+      if (state != nullptr && static_cast<uint64_t>(state->GetFrame()) == frame) {
+        return state;
+      }
+      return nullptr;
+    }
+
+    /// 返回仿真时间上包围 @a elapsed_seconds 的两帧：不晚于它的最后一帧与
+    /// 不早于它的第一帧。恰好落在某一帧上时两者相同，超出缓冲区范围时
+    /// 对应一侧为 nullptr。需要遍历所有槽，复杂度为 O(capacity)。
+    std::pair<StatePtr, StatePtr> GetBracket(double elapsed_seconds) const {
+      std::pair<StatePtr, StatePtr> result;
+      for (size_t i = 0u; i < _capacity; ++i) {
+        auto state = _slots[i].load();
+        if (state == nullptr) {
+          continue;
+        }
+        const double time = state->GetTimestamp().elapsed_seconds;
+        if (time <= elapsed_seconds &&
+            (result.first == nullptr || time > result.first->GetTimestamp().elapsed_seconds)) {
+          result.first = state;
+        }
+        if (time >= elapsed_seconds &&
+            (result.second == nullptr || time < result.second->GetTimestamp().elapsed_seconds)) {
+          result.second = state;
+        }
+      }
+      return result;
+    }
+
+    /// 参与者 @a id 在仿真时间 @a elapsed_seconds 的变换，由前后两帧线性插值
+    /// 得到。时间超出缓冲区范围，或参与者不在其中任一帧时返回空。
+    boost::optional<geom::Transform> GetActorTransformAt(
+        ActorId id,
+        double elapsed_seconds) const {
+      const auto bracket = GetBracket(elapsed_seconds);
+      if (bracket.first == nullptr || bracket.second == nullptr) {
+        return boost::none;
+      }
+      const auto before = bracket.first->GetActorSnapshotIfPresent(id);
+      const auto after = bracket.second->GetActorSnapshotIfPresent(id);
+      if (!before.has_value() || !after.has_value()) {
+        return boost::none;
+      }
+      const double t0 = bracket.first->GetTimestamp().elapsed_seconds;
+      const double t1 = bracket.second->GetTimestamp().elapsed_seconds;
+      if (t1 <= t0) {
+        return before->transform;
+      }
+      const auto alpha = static_cast<float>((elapsed_seconds - t0) / (t1 - t0));
+      return InterpolateTransform(before->transform, after->transform, alpha);
+    }
+
+  private:
+
+    static size_t RoundUpToPowerOfTwo(size_t value) {
+      size_t result = 1u;
+      while (result < value) {
+        result <<= 1u;
+      }
+      return result;
+    }
+
+    size_t Index(uint64_t frame) const {
+      return static_cast<size_t>(frame) & (_capacity - 1u);
+    }
+
+    const size_t _capacity;
+
+    const std::unique_ptr<AtomicSharedPtr<T>[]> _slots;
+
+    AtomicSharedPtr<T> _latest;
+  };
+
+  /// 最近若干帧的世界状态到达客户端的时刻，按帧号索引，用于计算传感器数据
+  /// 的端到端延迟：同一帧的状态与传感器数据由服务器在同一时刻发出，因此以
+  /// 状态的到达时刻为起点可以避开服务器与客户端时钟不一致的问题。
+  ///
+  /// 与 StateHistory 一样按 frame % capacity 存放，记录（网络线程）与查询
+  /// （各传感器的回调线程）由一个互斥锁保护，两者都只访问一个槽。
+  class FrameArrivalTimes : private NonCopyable {
+  public:
+
+    /// @a capacity 会向上取整为 2 的幂。
+    explicit FrameArrivalTimes(size_t capacity)
+      : _capacity(RoundUpToPowerOfTwo(capacity)),
+        _slots(new Slot[_capacity]) {}
+
+    /// 记录帧 @a frame 的状态在 @a arrival（steady_clock 纳秒）到达。
+    void Record(uint64_t frame, uint64_t arrival) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _slots[Index(frame)] = Slot{frame, arrival, true};
+      if (!_has_latest || frame > _latest_frame) {
+        _latest_frame = frame;
+        _has_latest = true;
+      }
+    }
+
+    /// 清空所有帧，例如切换剧集时（帧号不再可比）。
+    void Clear() {
+      std::lock_guard<std::mutex> lock(_mutex);
+      for (size_t i = 0u; i < _capacity; ++i) {
+        _slots[i].valid = false;
+      }
+      _has_latest = false;
+    }
+
+    /// 帧 @a frame 的传感器数据在 @a now 到达时的延迟（纳秒）。该帧的状态
+    /// 尚未到达（比最近收到的帧更新）时传感器数据先到，延迟为 0；还没有
+    /// 收到任何状态，或该帧的状态已被覆盖或没有收到时无法计算，返回空。
+    boost::optional<uint64_t> GetLatency(uint64_t frame, uint64_t now) const {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (!_has_latest) {
+        return boost::none;
+      }
+      const Slot &slot = _slots[Index(frame)];
+      if (slot.valid && slot.frame == frame) {
+        return now > slot.arrival ? now - slot.arrival : 0u;
+      }
+      if (frame > _latest_frame) {
+        return uint64_t(0u);
+      }
+      return boost::none;
+    }
+
+  private:
+
+    struct Slot {
+      uint64_t frame = 0u;
+      uint64_t arrival = 0u;
+      bool valid = false;
+    };
+
+    static size_t RoundUpToPowerOfTwo(size_t value) {
+      size_t result = 1u;
+      while (result < value) {
+        result <<= 1u;
+      }
+      return result;
+    }
+
+    size_t Index(uint64_t frame) const {
+      return static_cast<size_t>(frame) & (_capacity - 1u);
+    }
+
+    const size_t _capacity;
+
+    const std::unique_ptr<Slot[]> _slots;
+
+    mutable std::mutex _mutex;
+
+    uint64_t _latest_frame = 0u;
+
+    bool _has_latest = false;
+  };
+
+} // namespace detail
+} // namespace client
+} // namespace carla
@@ -12,6 +12,7 @@
 #include "carla/geom/Location.h"
 #include "carla/geom/Vector3D.h"
 
+#include <algorithm>
 #include <array>
 
 #ifdef LIBCARLA_INCLUDED_FROM_UE4
@@ -6,12 +6,18 @@
 
 #include <carla/geom/Mesh.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
 #include <string>
 #include <sstream>
 #include <ios>
 #include <iostream>
 #include <fstream>
 
+#include <carla/Exception.h>
 #include <carla/geom/Math.h>
 
 namespace carla {
@@ -149,33 +155,53 @@ namespace geom {
   }
 
   std::string Mesh::GenerateOBJ() const {
+    std::stringstream out;
+    WriteOBJ(out);
+    return out.str();
+  }
+
+  std::string Mesh::GenerateOBJForRecast() const {
+    std::stringstream out;
+    WriteOBJForRecast(out);
+    return out.str();
+  }
+
+  std::string Mesh::GeneratePLY() const {
     if (!IsValid()) {
-      return "";
+      return "Invalid Mesh";
     }
     std::stringstream out;
+    WritePLY(out, false);
+    return out.str();
+  }
+
+  void Mesh::WriteOBJ(std::ostream &out) const {
+    if (!IsValid()) {
+      return;
+    }
     out << std::fixed; // 避免使用科学计数法
 
-    out << "# List of geometric vertices, with (x, y, z) coordinates." << std::endl;
+    out << "# List of geometric vertices, with (x, y, z) coordinates.\n";
     for (auto &v : _vertices) {
-      out << "v " << v.x << " " << v.y << " " << v.z << std::endl;
+      out << "v " << v.x << " " << v.y << " " << v.z << '\n';
     }
 
     if (!_uvs.empty()) {
-      out << std::endl << "# List of texture coordinates, in (u, v) coordinates, these will vary between 0 and 1." << std::endl;
+      out << "\n# List of texture coordinates, in (u, v) coordinates, these will vary between 0 and 1.\n";
       for (auto &vt : _uvs) {
-        out << "vt " << vt.x << " " << vt.y << std::endl;
+        out << "vt " << vt.x << " " << vt.y << '\n';
       }
     }
 
     if (!_normals.empty()) {
-      out << std::endl << "# List of vertex normals in (x, y, z) form; normals might not be unit vectors." << std::endl;
+      out << "\n# List of vertex normals in (x, y, z) form; normals might not be unit vectors.\n";
       for (auto &vn : _normals) {
-        out << "vn " << vn.x << " " << vn.y << " " << vn.z << std::endl;
+        out << "vn " << vn.x << " " << vn.y << " " << vn.z << '\n';
       }
     }
 
     if (!_indexes.empty()) {
-      out << std::endl << "# Polygonal face element." << std::endl;
+      out << "\n# Polygonal face element.\n";
       auto it_m = _materials.begin();
       auto it = _indexes.begin();
       size_t index_counter = 0u;
@@ -188,37 +214,34 @@ namespace geom {
           }
           // 如果当前材料从该索引开始
           if (it_m->index_start == index_counter) {
-            out << "\nusemtl " << it_m->name << std::endl;
+            out << "\nusemtl " << it_m->name << '\n';
           }
         }
 
         // 使用 3 个连续的索引添加实际表面
         out << "f " << *it; ++it;
         out << " " << *it; ++it;
-        out << " " << *it << std::endl; ++it;
+        out << " " << *it << '\n'; ++it;
 
         index_counter += 3;
       }
     }
-
-    return out.str();
   }
 
-  std::string Mesh::GenerateOBJForRecast() const {
+  void Mesh::WriteOBJForRecast(std::ostream &out) const {
     if (!IsValid()) {
-      return "";
+      return;
     }
-    std::stringstream out;
     out << std::fixed; // 避免使用科学计数法
 
-    out << "# List of geometric vertices, with (x, y, z) coordinates." << std::endl;
+    out << "# List of geometric vertices, with (x, y, z) coordinates.\n";
     for (auto &v : _vertices) {
       // 为 Recast 库切换“y”和“z”
-      out << "v " << v.x << " " << v.z << " " << v.y << std::endl;
+      out << "v " << v.x << " " << v.z << " " << v.y << '\n';
     }
 
     if (!_indexes.empty()) {
-      out << std::endl << "# Polygonal face element." << std::endl;
+      out << "\n# Polygonal face element.\n";
       auto it_m = _materials.begin();
       auto it = _indexes.begin();
       size_t index_counter = 0u;
@@ -231,28 +254,187 @@ namespace geom {
           }
           // 如果当前材料从该索引开始
           if (it_m->index_start == index_counter) {
-            out << "\nusemtl " << it_m->name << std::endl;
+            out << "\nusemtl " << it_m->name << '\n';
           }
         }
         // 使用 3 个连续的索引添加实际面由于空间已经改变，因此将面构建方向更改为顺时针。
         out << "f " << *it; ++it;
         const auto i_2 = *it; ++it;
         const auto i_3 = *it; ++it;
-        out << " " << i_3 << " " << i_2 << std::endl;
+        out << " " << i_3 << " " << i_2 << '\n';
         index_counter += 3;
       }
     }
-
-    return out.str();
   }
 
-  std::string Mesh::GeneratePLY() const {
+  void Mesh::WritePLY(std::ostream &out, bool binary) const {
     if (!IsValid()) {
-      return "Invalid Mesh";
+      return;
     }
+    const bool with_normals = !_normals.empty() && _normals.size() == _vertices.size();
+    const bool with_uvs = !_uvs.empty() && _uvs.size() == _vertices.size();
+
     // 生成头
-    std::stringstream out;
-    return out.str();
+    out << "ply\n"
+        << "format " << (binary ? "binary_little_endian" : "ascii") << " 1.0\n"
+        << "element vertex " << _vertices.size() << "\n"
+        << "property float x\nproperty float y\nproperty float z\n";
+    if (with_normals) {
+      out << "property float nx\nproperty float ny\nproperty float nz\n";
+    }
+    if (with_uvs) {
+      out << "property float s\nproperty float t\n";
+    }
+    out << "element face " << _indexes.size() / 3u << "\n"
+        << "property list uchar uint vertex_indices\n"
+        << "end_header\n";
+
+    if (binary) {
+      // 顶点属性交错存放，先在缓冲区中拼好每个顶点再整块写出
+      std::vector<float> vertex_buffer;
+      vertex_buffer.reserve(_vertices.size() * (3u + (with_normals ? 3u : 0u) + (with_uvs ? 2u : 0u)));
+      for (size_t i = 0u; i < _vertices.size(); ++i) {
+        const auto &v = _vertices[i];
+        vertex_buffer.insert(vertex_buffer.end(), {v.x, v.y, v.z});
+        if (with_normals) {
+          const auto &n = _normals[i];
+          vertex_buffer.insert(vertex_buffer.end(), {n.x, n.y, n.z});
+        }
+        if (with_uvs) {
+          const auto &uv = _uvs[i];
+          vertex_buffer.insert(vertex_buffer.end(), {uv.x, uv.y});
+        }
+      }
+      out.write(
+          reinterpret_cast<const char *>(vertex_buffer.data()),
+          static_cast<std::streamsize>(vertex_buffer.size() * sizeof(float)));
+
+      // 每个面为 1 字节的顶点数加 3 个 uint32 索引，PLY 的索引从 0 开始
+      constexpr size_t face_size = sizeof(uint8_t) + 3u * sizeof(uint32_t);
+      std::vector<char> face_buffer(_indexes.size() / 3u * face_size);
+      char *face = face_buffer.data();
+      for (size_t i = 0u; i < _indexes.size(); i += 3u) {
+        *face = 3;
+        for (size_t j = 0u; j < 3u; ++j) {
+          const auto index = static_cast<uint32_t>(_indexes[i + j] - 1u);
+          std::memcpy(face + sizeof(uint8_t) + j * sizeof(uint32_t), &index, sizeof(uint32_t));
+        }
+        face += face_size;
+      }
+      out.write(face_buffer.data(), static_cast<std::streamsize>(face_buffer.size()));
+    } else {
+      out << std::fixed; // 避免使用科学计数法
+      for (size_t i = 0u; i < _vertices.size(); ++i) {
+        const auto &v = _vertices[i];
+        out << v.x << ' ' << v.y << ' ' << v.z;
+        if (with_normals) {
+          const auto &n = _normals[i];
+          out << ' ' << n.x << ' ' << n.y << ' ' << n.z;
+        }
+        if (with_uvs) {
+          out << ' ' << _uvs[i].x << ' ' << _uvs[i].y;
+        }
+        out << '\n';
+      }
+      for (size_t i = 0u; i < _indexes.size(); i += 3u) {
+        out << "3 " << _indexes[i] - 1u << ' ' << _indexes[i + 1u] - 1u << ' ' << _indexes[i + 2u] - 1u << '\n';
+      }
+    }
+  }
+
+  // ===========================================================================
+  // -- 二进制网格格式 ----------------------------------------------------------
+  // ===========================================================================
+
+  /// 二进制网格的魔数与版本，格式变化时需要更新版本号
+  static constexpr uint32_t BINARY_MESH_MAGIC = 0x48534D43u; // "CMSH"
+  static constexpr uint32_t BINARY_MESH_VERSION = 1u;
+
+  template <typename T>
+  static void WriteValue(std::ostream &out, const T &value) {
+    out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+
+  template <typename T>
+  static T ReadValue(std::istream &in) {
+    T value;
+    if (!in.read(reinterpret_cast<char *>(&value), sizeof(T))) {
+      throw_exception(std::runtime_error("unexpected end of binary mesh"));
+    }
+    return value;
+  }
+
+  template <typename T>
+  static void WriteArray(std::ostream &out, const std::vector<T> &values) {
+    out.write(
+        reinterpret_cast<const char *>(values.data()),
+        static_cast<std::streamsize>(values.size() * sizeof(T)));
+  }
+
+  template <typename T>
+  static void ReadArray(std::istream &in, std::vector<T> &values, uint64_t size) {
+    values.resize(static_cast<size_t>(size));
+    if (!in.read(
+        reinterpret_cast<char *>(values.data()),
+        static_cast<std::streamsize>(values.size() * sizeof(T)))) {
+      throw_exception(std::runtime_error("unexpected end of binary mesh"));
+    }
+  }
+
+  void Mesh::WriteBinary(std::ostream &out) const {
+    static_assert(sizeof(vertex_type) == 3u * sizeof(float), "Invalid vertex size");
+    static_assert(sizeof(uv_type) == 2u * sizeof(float), "Invalid uv size");
+    WriteValue(out, BINARY_MESH_MAGIC);
+    WriteValue(out, BINARY_MESH_VERSION);
+    WriteValue(out, static_cast<uint64_t>(_vertices.size()));
+    WriteValue(out, static_cast<uint64_t>(_normals.size()));
+    WriteValue(out, static_cast<uint64_t>(_uvs.size()));
+    WriteValue(out, static_cast<uint64_t>(_indexes.size()));
+    WriteValue(out, static_cast<uint64_t>(_materials.size()));
+    WriteArray(out, _vertices);
+    WriteArray(out, _normals);
+    WriteArray(out, _uvs);
+    // 索引以 uint32 存储，顶点数超过其范围的网格无法导出
+    if (_vertices.size() > std::numeric_limits<uint32_t>::max()) {
+      throw_exception(std::length_error("mesh too large for the binary mesh format"));
+    }
+    std::vector<uint32_t> indexes(_indexes.begin(), _indexes.end());
+    WriteArray(out, indexes);
+    for (const auto &material : _materials) {
+      WriteValue(out, static_cast<uint32_t>(material.name.size()));
+      out.write(material.name.data(), static_cast<std::streamsize>(material.name.size()));
+      WriteValue(out, static_cast<uint64_t>(material.index_start));
+      WriteValue(out, static_cast<uint64_t>(material.index_end));
+    }
+  }
+
+  Mesh Mesh::ReadBinary(std::istream &in) {
+    if ((ReadValue<uint32_t>(in) != BINARY_MESH_MAGIC) ||
+        (ReadValue<uint32_t>(in) != BINARY_MESH_VERSION)) {
+      throw_exception(std::runtime_error("invalid binary mesh header"));
+    }
+    const auto vertices = ReadValue<uint64_t>(in);
+    const auto normals = ReadValue<uint64_t>(in);
+    const auto uvs = ReadValue<uint64_t>(in);
+    const auto indexes = ReadValue<uint64_t>(in);
+    const auto materials = ReadValue<uint64_t>(in);
+    Mesh mesh;
+    ReadArray(in, mesh._vertices, vertices);
+    ReadArray(in, mesh._normals, normals);
+    ReadArray(in, mesh._uvs, uvs);
+    std::vector<uint32_t> index_buffer;
+    ReadArray(in, index_buffer, indexes);
+    mesh._indexes.assign(index_buffer.begin(), index_buffer.end());
+    for (uint64_t i = 0u; i < materials; ++i) {
+      std::string name(ReadValue<uint32_t>(in), '\0');
+      if (!in.read(&name[0], static_cast<std::streamsize>(name.size()))) {
+        throw_exception(std::runtime_error("unexpected end of binary mesh"));
+      }
+      const auto start = ReadValue<uint64_t>(in);
+      const auto end = ReadValue<uint64_t>(in);
+      mesh._materials.emplace_back(name, static_cast<size_t>(start), static_cast<size_t>(end));
+    }
+    return mesh;
   }
 
   const std::vector<Mesh::vertex_type> &Mesh::GetVertices() const {
@@ -6,6 +6,9 @@
 
 #pragma once
 
+#include <istream>
+#include <ostream>
+#include <string>
 #include <vector>
 
 #include <carla/geom/Vector3D.h>
@@ -117,6 +120,24 @@ namespace geom {
     /// 返回包含 PLY 中编码的网格的字符串。单位为米。
     std::string GeneratePLY() const;
 
+    /// 将 OBJ 编码的网格直接写入 @a out，不在内存中构建整个字符串。
+    void WriteOBJ(std::ostream &out) const;
+
+    /// 将供 Recast 使用的 OBJ 编码网格直接写入 @a out。
+    void WriteOBJForRecast(std::ostream &out) const;
+
+    /// 将 PLY 编码的网格写入 @a out，默认使用 binary_little_endian 格式。
+    /// 法线与 UV 的数量与顶点数一致时作为顶点属性一并写出。
+    void WritePLY(std::ostream &out, bool binary = true) const;
+
+    /// 以紧凑的二进制索引格式写入网格，包括顶点、法线、UV、索引与材质。
+    /// 每个网格自带长度信息，多个网格可以依次写入同一个流，再用 ReadBinary
+    /// 逐个读出。
+    void WriteBinary(std::ostream &out) const;
+
+    /// 从 @a in 读取一个由 WriteBinary 写入的网格，数据无效时抛出异常。
+    static Mesh ReadBinary(std::istream &in);
+
     // =========================================================================
     // -- 其他方法 -------------------------------------------------------------
     // =========================================================================
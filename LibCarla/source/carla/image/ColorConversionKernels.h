@@ -0,0 +1,488 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+#include "carla/ThreadGroup.h"
+#include "carla/image/CityScapesPalette.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+// 仅在 x86 平台上启用 SIMD 路径。GCC/Clang 通过 target 属性单独编译
+// AVX2/SSE4.1 函数，并在运行时检测 CPU 支持；MSVC 的 AVX2 依据编译选项决定，
+// SSE4.1 通过 __cpuid 在运行时检测。
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  define LIBCARLA_IMAGE_WITH_X86_SIMD
+#  include <immintrin.h>
+#  if defined(_MSC_VER)
+#    include <intrin.h>
+#  endif
+#  if defined(__GNUC__)
+#    define LIBCARLA_IMAGE_TARGET_AVX2 __attribute__((target("avx2")))
+#    define LIBCARLA_IMAGE_TARGET_SSE41 __attribute__((target("sse4.1")))
+#  else
+#    define LIBCARLA_IMAGE_TARGET_AVX2
+#    define LIBCARLA_IMAGE_TARGET_SSE41
+#  endif
+#endif
+
+namespace carla {
+namespace image {
+
+  /// 针对连续 BGRA8 缓冲区的批量颜色转换内核。
+  ///
+  /// 结果与 ColorConverter 中基于 boost::gil 的逐像素转换完全一致，
+  /// 但按块处理像素：在支持的 CPU 上使用 AVX2/SSE4.1，否则退回标量实现；
+  /// 像素数超过 ParallelThreshold() 的图像会拆分到多个线程中处理。
+  ///
+  /// 所有函数的 @a num_threads 参数为 0 时自动选择线程数，为 1 时在当前线程中执行。
+  class ColorConversionKernels {
+  public:
+
+    /// 超过该像素数的图像默认使用多线程转换。
+    static constexpr size_t ParallelThreshold() {
+      return 1024u * 1024u;
+    }
+
+    // =========================================================================
+    // -- 标量参考实现 ------------------------------------------------------------
+    // =========================================================================
+
+    /// 将 RGB 编码的深度解码为灰度值，等价于 ColorConverter::Depth。
+    static uint8_t DepthToGray(uint8_t r, uint8_t g, uint8_t b) {
+      const float depth = static_cast<float>(r + (g * 256) + (b * 256 * 256));
+      const float normalized = depth / static_cast<float>(256 * 256 * 256 - 1);
+      return ToChannel(normalized);
+    }
+
+    /// 将 RGB 编码的深度解码为对数灰度值，等价于 ColorConverter::LogarithmicDepth。
+    static uint8_t LogarithmicDepthToGray(uint8_t r, uint8_t g, uint8_t b) {
+      return LogarithmicDepthToGray(static_cast<uint32_t>(r + (g * 256) + (b * 256 * 256)));
+    }
+
+    // =========================================================================
+    // -- 批量内核 ---------------------------------------------------------------
+    // =========================================================================
+
+    /// 原地将 @a count 个 BGRA8 像素的编码深度转换为灰度。
+    static void Depth(uint8_t *bgra, size_t count, size_t num_threads = 0u) {
+      ParallelFor(count, num_threads, [bgra](size_t begin, size_t end) {
+        DepthRange(bgra + 4u * begin, end - begin);
+      });
+    }
+
+    /// 原地将 @a count 个 BGRA8 像素的编码深度转换为对数灰度。
+    static void LogarithmicDepth(uint8_t *bgra, size_t count, size_t num_threads = 0u) {
+      const auto &table = GetLogarithmicDepthTable();
+      ParallelFor(count, num_threads, [bgra, &table](size_t begin, size_t end) {
+        LogarithmicDepthRange(bgra + 4u * begin, end - begin, table.data());
+      });
+    }
+
+    /// 原地将 @a count 个 BGRA8 像素的语义标签（红色通道）映射为 CityScapes 调色板颜色。
+    static void CityScapesPalette(uint8_t *bgra, size_t count, size_t num_threads = 0u) {
+      const auto &lut = GetCityScapesLookupTable();
+      ParallelFor(count, num_threads, [bgra, &lut](size_t begin, size_t end) {
+        CityScapesPaletteRange(bgra + 4u * begin, end - begin, lut.data());
+      });
+    }
+
+    /// 将 @a count 个光流像素（交错存储的 x、y 分量）按 HSV 色轮编码为 BGRA8 颜色。
+    ///
+    /// 逐像素需要 atan2/log，因此只做多线程拆分，不做向量化。
+    static void ColorCodedFlow(const float *flow, uint8_t *bgra, size_t count, size_t num_threads = 0u) {
+      ParallelFor(count, num_threads, [flow, bgra](size_t begin, size_t end) {
+        for (auto i = begin; i < end; ++i) {
+          ColorCodedFlowPixel(flow[2u * i], flow[2u * i + 1u], bgra + 4u * i);
+        }
+      });
+    }
+
+  private:
+
+    using LookupTable = std::array<uint32_t, 256u>;
+
+    /// 与 boost::gil 中 float32 到 uint8 的通道转换保持一致。
+    static uint8_t ToChannel(float value) {
+      return static_cast<uint8_t>(value * 255.0f + 0.5f);
+    }
+
+    static uint8_t LogarithmicDepthToGray(uint32_t depth) {
+      const float normalized = static_cast<float>(depth) / static_cast<float>(256 * 256 * 256 - 1);
+      const float value = 1.0f + std::log(normalized) / 5.70378f;
+      const float clamped = std::max(std::min(value, 1.0f), 0.005f);
+      return ToChannel(clamped);
+    }
+
+    /// 对数深度表的桶数：深度 0 单独一个桶，其余按 float(depth) 的指数与
+    /// 尾数最高 8 位分桶（指数 0-23，共 24 * 256 个桶）。
+    static constexpr size_t LogarithmicDepthBucketCount = 1u + 24u * 256u;
+
+    using LogarithmicDepthTable = std::array<uint32_t, LogarithmicDepthBucketCount>;
+
+    static uint32_t FloatBits(float value) {
+      uint32_t bits;
+      std::memcpy(&bits, &value, sizeof(bits));
+      return bits;
+    }
+
+    static float FloatFromBits(uint32_t bits) {
+      float value;
+      std::memcpy(&value, &bits, sizeof(value));
+      return value;
+    }
+
+    /// 深度小于 2^24，转换为 float 是精确的。
+    static uint32_t LogarithmicDepthBucket(uint32_t depth) {
+      const uint32_t key = FloatBits(static_cast<float>(depth)) >> 15u;
+      return (depth == 0u) ? 0u : key - ((127u << 8u) - 1u);
+    }
+
+    /// 对数深度的输出随深度单调不减，而每个桶覆盖的相对深度范围只有 2^-8，
+    /// 其中输出至多变化一级。因此每个桶只需记录桶内最小输出 base 和使输出
+    /// 加一的最小深度 split，逐像素一次查表加一次比较即可得到与 std::log
+    /// 完全一致的结果。表项按 ((split - 1) << 8) | base 打包。
+    static const LogarithmicDepthTable &GetLogarithmicDepthTable() {
+      static const LogarithmicDepthTable table = [] {
+        constexpr uint32_t max_depth = 256u * 256u * 256u;
+        // 每个灰度值对应的最小深度。
+        std::array<uint32_t, 257u> thresholds;
+        for (auto value = 0u; value < thresholds.size(); ++value) {
+          uint32_t low = 0u;
+          uint32_t high = max_depth;
+          while (low < high) {
+            const uint32_t middle = low + (high - low) / 2u;
+            if (LogarithmicDepthToGray(middle) >= value) {
+              high = middle;
+            } else {
+              low = middle + 1u;
+            }
+          }
+          thresholds[value] = low;
+        }
+        LogarithmicDepthTable result;
+        for (auto bucket = 0u; bucket < result.size(); ++bucket) {
+          const uint32_t low = (bucket == 0u) ?
+              0u :
+              static_cast<uint32_t>(FloatFromBits((bucket + (127u << 8u) - 1u) << 15u));
+          const uint32_t base = LogarithmicDepthToGray(std::min(low, max_depth - 1u));
+          const uint32_t split = thresholds[base + 1u];
+          DEBUG_ASSERT(split > 0u);
+          result[bucket] = ((split - 1u) << 8u) | base;
+        }
+        return result;
+      }();
+      return table;
+    }
+
+    static uint8_t LookupLogarithmicDepth(uint32_t depth, const uint32_t *table) {
+      const uint32_t entry = table[LogarithmicDepthBucket(depth)];
+      return static_cast<uint8_t>((entry & 0xFFu) + ((depth > (entry >> 8u)) ? 1u : 0u));
+    }
+
+    /// 以小端序打包的 BGRA 颜色，按标签（0-255）索引。
+    static const LookupTable &GetCityScapesLookupTable() {
+      static const LookupTable table = [] {
+        LookupTable result;
+        for (auto tag = 0u; tag < result.size(); ++tag) {
+          const auto color = image::CityScapesPalette::GetColor(static_cast<uint8_t>(tag));
+          result[tag] =
+              static_cast<uint32_t>(color[2u]) |
+              (static_cast<uint32_t>(color[1u]) << 8u) |
+              (static_cast<uint32_t>(color[0u]) << 16u) |
+              (0xFFu << 24u);
+        }
+        return result;
+      }();
+      return table;
+    }
+
+    static void ColorCodedFlowPixel(float vx, float vy, uint8_t *dst) {
+      constexpr float pi = 3.1415f;
+      constexpr float rad2ang = 360.f/(2.f*pi);
+      float angle = 180.f + std::atan2(vy, vx)*rad2ang;
+      if (angle < 0) angle = 360.f + angle;
+      angle = std::fmod(angle, 360.f);
+
+      const float norm = std::sqrt(vx*vx + vy*vy);
+      const float shift = 0.999f;
+      const float a = 1.f/std::log(0.1f + shift);
+      const float intensity = std::min(std::max(a*std::log(norm + shift), 0.f), 1.f);
+
+      // HSV（S = 1）到 RGB 的转换。
+      const float H_60 = angle*(1.f/60.f);
+      const float C = intensity;
+      const float X = C*(1.f - std::abs(std::fmod(H_60, 2.f) - 1.f));
+      const float m = intensity - C;
+      float r = 1.f, g = 1.f, b = 1.f;
+      switch (static_cast<unsigned int>(H_60)) {
+        case 0: r = C; g = X; b = 0; break;
+        case 1: r = X; g = C; b = 0; break;
+        case 2: r = 0; g = C; b = X; break;
+        case 3: r = 0; g = X; b = C; break;
+        case 4: r = X; g = 0; b = C; break;
+        case 5: r = C; g = 0; b = X; break;
+        default: break;
+      }
+      dst[0u] = static_cast<uint8_t>((b+m)*255.f);
+      dst[1u] = static_cast<uint8_t>((g+m)*255.f);
+      dst[2u] = static_cast<uint8_t>((r+m)*255.f);
+      dst[3u] = 0u;
+    }
+
+    /// 将 [0, count) 切分为若干连续区间并行执行 @a functor(begin, end)，
+    /// 第一个区间在调用线程中执行。
+    template <typename F>
+    static void ParallelFor(size_t count, size_t num_threads, F functor) {
+      if (num_threads == 0u) {
+        num_threads = (count < ParallelThreshold()) ?
+            1u :
+            std::max(1u, std::thread::hardware_concurrency());
+      }
+      // 区间按 8 像素对齐，使每个线程都能完整使用向量指令。
+      const size_t batch = ((count / num_threads) + 7u) & ~size_t(7u);
+      if ((num_threads == 1u) || (batch == 0u) || (batch >= count)) {
+        functor(0u, count);
+        return;
+      }
+      ThreadGroup workers;
+      for (auto begin = batch; begin < count; begin += batch) {
+        const auto end = std::min(begin + batch, count);
+        workers.CreateThread([=]() { functor(begin, end); });
+      }
+      functor(0u, batch);
+      workers.JoinAll();
+    }
+
+    static void DepthRange(uint8_t *bgra, size_t count) {
+      size_t i = 0u;
+#ifdef LIBCARLA_IMAGE_WITH_X86_SIMD
+      if (HasAVX2()) {
+        i = DepthAVX2(bgra, count);
+      } else if (HasSSE41()) {
+        i = DepthSSE41(bgra, count);
+      }
+#endif // LIBCARLA_IMAGE_WITH_X86_SIMD
+      for (; i < count; ++i) {
+        uint8_t *p = bgra + 4u * i;
+        const uint8_t gray = DepthToGray(p[2u], p[1u], p[0u]);
+        p[0u] = p[1u] = p[2u] = gray;
+        p[3u] = 255u;
+      }
+    }
+
+    static void LogarithmicDepthRange(uint8_t *bgra, size_t count, const uint32_t *table) {
+      size_t i = 0u;
+#ifdef LIBCARLA_IMAGE_WITH_X86_SIMD
+      if (HasAVX2()) {
+        i = LogarithmicDepthAVX2(bgra, count, table);
+      } else if (HasSSE41()) {
+        i = LogarithmicDepthSSE41(bgra, count, table);
+      }
+#endif // LIBCARLA_IMAGE_WITH_X86_SIMD
+      for (; i < count; ++i) {
+        uint8_t *p = bgra + 4u * i;
+        const uint32_t depth = p[2u] + (p[1u] * 256u) + (p[0u] * 256u * 256u);
+        const uint8_t gray = LookupLogarithmicDepth(depth, table);
+        p[0u] = p[1u] = p[2u] = gray;
+        p[3u] = 255u;
+      }
+    }
+
+    static void CityScapesPaletteRange(uint8_t *bgra, size_t count, const uint32_t *lut) {
+      size_t i = 0u;
+#ifdef LIBCARLA_IMAGE_WITH_X86_SIMD
+      if (HasAVX2()) {
+        i = CityScapesPaletteAVX2(bgra, count, lut);
+      } else if (HasSSE41()) {
+        i = CityScapesPaletteSSE41(bgra, count, lut);
+      }
+#endif // LIBCARLA_IMAGE_WITH_X86_SIMD
+      for (; i < count; ++i) {
+        uint8_t *p = bgra + 4u * i;
+        const uint32_t color = lut[p[2u]];
+        p[0u] = static_cast<uint8_t>(color);
+        p[1u] = static_cast<uint8_t>(color >> 8u);
+        p[2u] = static_cast<uint8_t>(color >> 16u);
+        p[3u] = static_cast<uint8_t>(color >> 24u);
+      }
+    }
+
+#ifdef LIBCARLA_IMAGE_WITH_X86_SIMD
+
+    static bool HasAVX2() {
+#if defined(__GNUC__)
+      static const bool result = __builtin_cpu_supports("avx2");
+      return result;
+#elif defined(__AVX2__)
+      return true;
+#else
+      return false;
+#endif
+    }
+
+    static bool HasSSE41() {
+#if defined(__GNUC__)
+      static const bool result = __builtin_cpu_supports("sse4.1");
+      return result;
+#elif defined(_MSC_VER)
+      // CPUID 功能号 1，ECX 第 19 位。
+      static const bool result = [] {
+        int info[4];
+        __cpuid(info, 1);
+        return (info[2] & (1 << 19)) != 0;
+      }();
+      return result;
+#else
+      return false;
+#endif
+    }
+
+    // 将 BGRA 像素重排为深度整数 R | G << 8 | B << 16。
+    #define LIBCARLA_IMAGE_DEPTH_SHUFFLE \
+        2, 1, 0, -128, 6, 5, 4, -128, 10, 9, 8, -128, 14, 13, 12, -128
+
+    // 将每个像素的灰度（最低字节）复制到 B、G、R 三个通道。
+    #define LIBCARLA_IMAGE_GRAY_SHUFFLE \
+        0, 0, 0, -128, 4, 4, 4, -128, 8, 8, 8, -128, 12, 12, 12, -128
+
+    LIBCARLA_IMAGE_TARGET_SSE41
+    static size_t DepthSSE41(uint8_t *bgra, size_t count) {
+      const __m128i depth_shuffle = _mm_setr_epi8(LIBCARLA_IMAGE_DEPTH_SHUFFLE);
+      const __m128i gray_shuffle = _mm_setr_epi8(LIBCARLA_IMAGE_GRAY_SHUFFLE);
+      const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+      const __m128 max_depth = _mm_set1_ps(static_cast<float>(256 * 256 * 256 - 1));
+      const __m128 scale = _mm_set1_ps(255.0f);
+      const __m128 half = _mm_set1_ps(0.5f);
+      const size_t simd_count = count & ~size_t(3u);
+      for (size_t i = 0u; i < simd_count; i += 4u) {
+        auto *p = reinterpret_cast<__m128i *>(bgra + 4u * i);
+        const __m128i pixels = _mm_loadu_si128(p);
+        const __m128 depth = _mm_cvtepi32_ps(_mm_shuffle_epi8(pixels, depth_shuffle));
+        const __m128 normalized = _mm_div_ps(depth, max_depth);
+        const __m128i gray = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(normalized, scale), half));
+        _mm_storeu_si128(p, _mm_or_si128(_mm_shuffle_epi8(gray, gray_shuffle), alpha));
+      }
+      return simd_count;
+    }
+
+    LIBCARLA_IMAGE_TARGET_AVX2
+    static size_t DepthAVX2(uint8_t *bgra, size_t count) {
+      const __m256i depth_shuffle = _mm256_setr_epi8(
+          LIBCARLA_IMAGE_DEPTH_SHUFFLE, LIBCARLA_IMAGE_DEPTH_SHUFFLE);
+      const __m256i gray_shuffle = _mm256_setr_epi8(
+          LIBCARLA_IMAGE_GRAY_SHUFFLE, LIBCARLA_IMAGE_GRAY_SHUFFLE);
+      const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+      const __m256 max_depth = _mm256_set1_ps(static_cast<float>(256 * 256 * 256 - 1));
+      const __m256 scale = _mm256_set1_ps(255.0f);
+      const __m256 half = _mm256_set1_ps(0.5f);
+      const size_t simd_count = count & ~size_t(7u);
+      for (size_t i = 0u; i < simd_count; i += 8u) {
+        auto *p = reinterpret_cast<__m256i *>(bgra + 4u * i);
+        const __m256i pixels = _mm256_loadu_si256(p);
+        const __m256 depth = _mm256_cvtepi32_ps(_mm256_shuffle_epi8(pixels, depth_shuffle));
+        const __m256 normalized = _mm256_div_ps(depth, max_depth);
+        const __m256i gray = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(normalized, scale), half));
+        _mm256_storeu_si256(p, _mm256_or_si256(_mm256_shuffle_epi8(gray, gray_shuffle), alpha));
+      }
+      return simd_count;
+    }
+
+    // SSE 没有 gather 指令，查表逐个取出下标完成，其余步骤与 AVX2 版本相同。
+    LIBCARLA_IMAGE_TARGET_SSE41
+    static size_t LogarithmicDepthSSE41(uint8_t *bgra, size_t count, const uint32_t *table) {
+      const __m128i depth_shuffle = _mm_setr_epi8(LIBCARLA_IMAGE_DEPTH_SHUFFLE);
+      const __m128i gray_shuffle = _mm_setr_epi8(LIBCARLA_IMAGE_GRAY_SHUFFLE);
+      const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+      const __m128i bucket_offset = _mm_set1_epi32((127 << 8) - 1);
+      const __m128i base_mask = _mm_set1_epi32(0xFF);
+      const size_t simd_count = count & ~size_t(3u);
+      for (size_t i = 0u; i < simd_count; i += 4u) {
+        auto *p = reinterpret_cast<__m128i *>(bgra + 4u * i);
+        const __m128i depth = _mm_shuffle_epi8(_mm_loadu_si128(p), depth_shuffle);
+        const __m128i key = _mm_srli_epi32(_mm_castps_si128(_mm_cvtepi32_ps(depth)), 15);
+        const __m128i bucket = _mm_max_epi32(_mm_sub_epi32(key, bucket_offset), _mm_setzero_si128());
+        const __m128i entry = _mm_setr_epi32(
+            static_cast<int>(table[_mm_extract_epi32(bucket, 0)]),
+            static_cast<int>(table[_mm_extract_epi32(bucket, 1)]),
+            static_cast<int>(table[_mm_extract_epi32(bucket, 2)]),
+            static_cast<int>(table[_mm_extract_epi32(bucket, 3)]));
+        const __m128i step = _mm_cmpgt_epi32(depth, _mm_srli_epi32(entry, 8));
+        const __m128i gray = _mm_sub_epi32(_mm_and_si128(entry, base_mask), step);
+        _mm_storeu_si128(p, _mm_or_si128(_mm_shuffle_epi8(gray, gray_shuffle), alpha));
+      }
+      return simd_count;
+    }
+
+    LIBCARLA_IMAGE_TARGET_AVX2
+    static size_t LogarithmicDepthAVX2(uint8_t *bgra, size_t count, const uint32_t *table) {
+      const __m256i depth_shuffle = _mm256_setr_epi8(
+          LIBCARLA_IMAGE_DEPTH_SHUFFLE, LIBCARLA_IMAGE_DEPTH_SHUFFLE);
+      const __m256i gray_shuffle = _mm256_setr_epi8(
+          LIBCARLA_IMAGE_GRAY_SHUFFLE, LIBCARLA_IMAGE_GRAY_SHUFFLE);
+      const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+      const __m256i bucket_offset = _mm256_set1_epi32((127 << 8) - 1);
+      const __m256i base_mask = _mm256_set1_epi32(0xFF);
+      const auto *entries = reinterpret_cast<const int *>(table);
+      const size_t simd_count = count & ~size_t(7u);
+      for (size_t i = 0u; i < simd_count; i += 8u) {
+        auto *p = reinterpret_cast<__m256i *>(bgra + 4u * i);
+        const __m256i depth = _mm256_shuffle_epi8(_mm256_loadu_si256(p), depth_shuffle);
+        const __m256i key = _mm256_srli_epi32(_mm256_castps_si256(_mm256_cvtepi32_ps(depth)), 15);
+        // 深度为 0 时 key 为 0，相减后为负数，截断到桶 0。
+        const __m256i bucket = _mm256_max_epi32(_mm256_sub_epi32(key, bucket_offset), _mm256_setzero_si256());
+        const __m256i entry = _mm256_i32gather_epi32(entries, bucket, 4);
+        // 深度大于 split - 1 时比较结果为 -1，相减即加一。
+        const __m256i step = _mm256_cmpgt_epi32(depth, _mm256_srli_epi32(entry, 8));
+        const __m256i gray = _mm256_sub_epi32(_mm256_and_si256(entry, base_mask), step);
+        _mm256_storeu_si256(p, _mm256_or_si256(_mm256_shuffle_epi8(gray, gray_shuffle), alpha));
+      }
+      return simd_count;
+    }
+
+    LIBCARLA_IMAGE_TARGET_SSE41
+    static size_t CityScapesPaletteSSE41(uint8_t *bgra, size_t count, const uint32_t *lut) {
+      const __m128i tag_mask = _mm_set1_epi32(0xFF);
+      const size_t simd_count = count & ~size_t(3u);
+      for (size_t i = 0u; i < simd_count; i += 4u) {
+        auto *p = reinterpret_cast<__m128i *>(bgra + 4u * i);
+        const __m128i tags = _mm_and_si128(_mm_srli_epi32(_mm_loadu_si128(p), 16), tag_mask);
+        _mm_storeu_si128(p, _mm_setr_epi32(
+            static_cast<int>(lut[_mm_extract_epi32(tags, 0)]),
+            static_cast<int>(lut[_mm_extract_epi32(tags, 1)]),
+            static_cast<int>(lut[_mm_extract_epi32(tags, 2)]),
+            static_cast<int>(lut[_mm_extract_epi32(tags, 3)])));
+      }
+      return simd_count;
+    }
+
+    LIBCARLA_IMAGE_TARGET_AVX2
+    static size_t CityScapesPaletteAVX2(uint8_t *bgra, size_t count, const uint32_t *lut) {
+      const auto *table = reinterpret_cast<const int *>(lut);
+      const __m256i tag_mask = _mm256_set1_epi32(0xFF);
+      const size_t simd_count = count & ~size_t(7u);
+      for (size_t i = 0u; i < simd_count; i += 8u) {
+        auto *p = reinterpret_cast<__m256i *>(bgra + 4u * i);
+        const __m256i tags = _mm256_and_si256(_mm256_srli_epi32(_mm256_loadu_si256(p), 16), tag_mask);
+        _mm256_storeu_si256(p, _mm256_i32gather_epi32(table, tags, 4));
+      }
+      return simd_count;
+    }
+
+    #undef LIBCARLA_IMAGE_DEPTH_SHUFFLE
+    #undef LIBCARLA_IMAGE_GRAY_SHUFFLE
+
+#endif // LIBCARLA_IMAGE_WITH_X86_SIMD
+  };
+
+} // namespace image
+} // namespace carla
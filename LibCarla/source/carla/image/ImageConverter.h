@@ -6,6 +6,7 @@
 
 #pragma once // 确保头文件只被包含一次
 
+#include "carla/image/ColorConversionKernels.h" // 引入批量颜色转换内核
 #include "carla/image/ImageView.h" // 引入ImageView头文件
 
 namespace carla { // carla命名空间
@@ -28,6 +29,44 @@ namespace image { // image子命名空间
           ImageView::MakeColorConvertedView<MutableImageView, DstPixelT>(image_view, converter), // 创建颜色转换后的视图
           image_view); // 目标为原始图像视图
     }
+
+    /// @name 连续 BGRA8 图像的快速路径
+    ///
+    /// 传感器图像通常是连续存储的 BGRA8 视图，此时直接调用
+    /// ColorConversionKernels 中的批量内核，结果与通用路径一致。
+    /// @{
+
+    static void ConvertInPlace(boost::gil::bgra8_view_t &image_view, ColorConverter::Depth converter) {
+      if (image_view.is_1d_traversable()) {
+        ColorConversionKernels::Depth(GetRawData(image_view), image_view.size());
+      } else {
+        ConvertInPlace<ColorConverter::Depth>(image_view, converter);
+      }
+    }
+
+    static void ConvertInPlace(boost::gil::bgra8_view_t &image_view, ColorConverter::LogarithmicDepth converter) {
+      if (image_view.is_1d_traversable()) {
+        ColorConversionKernels::LogarithmicDepth(GetRawData(image_view), image_view.size());
+      } else {
+        ConvertInPlace<ColorConverter::LogarithmicDepth>(image_view, converter);
+      }
+    }
+
+    static void ConvertInPlace(boost::gil::bgra8_view_t &image_view, ColorConverter::CityScapesPalette converter) {
+      if (image_view.is_1d_traversable()) {
+        ColorConversionKernels::CityScapesPalette(GetRawData(image_view), image_view.size());
+      } else {
+        ConvertInPlace<ColorConverter::CityScapesPalette>(image_view, converter);
+      }
+    }
+
+    /// @}
+
+  private:
+
+    static uint8_t *GetRawData(boost::gil::bgra8_view_t &image_view) {
+      return reinterpret_cast<uint8_t *>(boost::gil::interleaved_view_get_raw_data(image_view));
+    }
   };
 
 } // namespace image
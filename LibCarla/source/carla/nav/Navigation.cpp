@@ -39,6 +39,8 @@ namespace nav {
   static const float AGENT_UNBLOCK_DISTANCE_SQUARED = AGENT_UNBLOCK_DISTANCE * AGENT_UNBLOCK_DISTANCE;
   static const float AGENT_UNBLOCK_TIME = 4.0f;
 
+  static const size_t PATH_PLANNER_WORKERS = 2u;
+
   static const float AREA_GRASS_COST =  1.0f;
   static const float AREA_ROAD_COST  = 10.0f;
 
@@ -54,6 +56,8 @@ namespace nav {
 
   Navigation::~Navigation() {
     _ready = false;
+    // 先停止后台规划，工作线程还在使用导航网格
+    _path_planner.Stop();
     _time_to_unblock = 0.0f;
     _mapped_walkers_id.clear();
     _mapped_vehicles_id.clear();
@@ -182,6 +186,7 @@ namespace nav {
     }
 
     // 交换
+    _path_planner.Stop();
     dtFreeNavMesh(_nav_mesh);
     _nav_mesh = mesh;
 
@@ -190,6 +195,9 @@ namespace nav {
     _nav_query = dtAllocNavMeshQuery();
     _nav_query->init(_nav_mesh, MAX_QUERY_SEARCH_NODES);
 
+    // 启动后台路径规划
+    _path_planner.Start(_nav_mesh, MAX_QUERY_SEARCH_NODES, PATH_PLANNER_WORKERS);
+
     // 拷贝
     _binary_mesh = std::move(content);
     _ready = true;
@@ -372,17 +380,6 @@ namespace nav {
 
   bool Navigation::GetAgentRoute(ActorId id, carla::geom::Location from, carla::geom::Location to,
   std::vector<carla::geom::Location> &path, std::vector<unsigned char> &area) {
-    // 找到路径
-    float straight_path[MAX_POLYS * 3];
-    unsigned char straight_path_flags[MAX_POLYS];
-    dtPolyRef straight_path_polys[MAX_POLYS];
-    int num_straight_path = 0;
-    int straight_path_options = DT_STRAIGHTPATH_AREA_CROSSINGS;
-
-    // 路径中的多边形
-    dtPolyRef polys[MAX_POLYS];
-    int num_polys;
-
     // 检查是否一切就绪
     if (!_ready) {
       return false;
@@ -390,82 +387,63 @@ namespace nav {
 
     DEBUG_ASSERT(_nav_query != nullptr);
 
-    // 点的扩展
-    float poly_pick_ext[3] = {2,4,2};
-
-    // 从代理获取当前过滤器
-    auto it = _mapped_walkers_id.find(id);
-    if (it == _mapped_walkers_id.end())
-      return false;
-
-    const dtQueryFilter *filter;
-    {
-      // 关键部分，强制单线程运行这里
-      std::lock_guard<std::mutex> lock(_mutex);
-      filter = _crowd->getFilter(_crowd->getAgent(it->second)->params.queryFilterType);
-    }
-
-    // 设置点
-    dtPolyRef start_ref = 0;
-    dtPolyRef end_ref = 0;
-    float start_pos[3] = { from.x, from.z, from.y };
-    float end_pos[3] = { to.x, to.z, to.y };
+    PathResult result;
     {
       // 关键部分，强制单线程运行这里
       std::lock_guard<std::mutex> lock(_mutex);
-      _nav_query->findNearestPoly(start_pos, poly_pick_ext, filter, &start_ref, 0);
-      _nav_query->findNearestPoly(end_pos, poly_pick_ext, filter, &end_ref, 0);
+      PathRequest request;
+      if (!MakeAgentRequest(id, from, to, request)) {
+        return false;
+      }
+      _path_planner.FindPath(*_nav_query, request, result);
     }
-    if (!start_ref || !end_ref) {
+    if (!result.success) {
       return false;
     }
 
-    // 获取点的路径
-    {
-      // 关键部分，强制单线程运行这里
-      std::lock_guard<std::mutex> lock(_mutex);
-      _nav_query->findPath(start_ref, end_ref, start_pos, end_pos, filter, polys, &num_polys, MAX_POLYS);
-    }
+    path = std::move(result.path);
+    area = std::move(result.area);
+    return true;
+  }
 
-    // 获取点的路径
-    if (num_polys == 0) {
+  // 将路径规划请求交给后台线程
+  bool Navigation::RequestAgentRoute(ActorId id, uint64_t ticket, carla::geom::Location from,
+  carla::geom::Location to) {
+    // 检查是否一切就绪
+    if (!_ready || !_path_planner.IsRunning()) {
       return false;
     }
 
-    // 如果是部分路径，请确保终点与最后一个多边形相接
-    float end_pos2[3];
-    dtVcopy(end_pos2, end_pos);
-    if (polys[num_polys - 1] != end_ref) {
-      // 关键部分，强制单线程运行这里
-      std::lock_guard<std::mutex> lock(_mutex);
-      _nav_query->closestPointOnPoly(polys[num_polys - 1], end_pos, end_pos2, 0);
-    }
-
-    // 获取点
+    PathRequest request;
     {
       // 关键部分，强制单线程运行这里
       std::lock_guard<std::mutex> lock(_mutex);
-      _nav_query->findStraightPath(start_pos, end_pos2, polys, num_polys,
-      straight_path, straight_path_flags,
-      straight_path_polys, &num_straight_path, MAX_POLYS, straight_path_options);
-    }
-
-    // 将路径复制到输出缓冲区
-    path.clear();
-    path.reserve(static_cast<unsigned long>(num_straight_path));
-    unsigned char area_type;
-    for (int i = 0, j = 0; j < num_straight_path; i += 3, ++j) {
-      // 保存虚幻轴的坐标（x，z，y）
-      path.emplace_back(straight_path[i], straight_path[i + 2], straight_path[i + 1]);
-      // 保存面积类型
-      {
-        // 关键部分，强制单线程运行这里
-        std::lock_guard<std::mutex> lock(_mutex);
-        _nav_mesh->getPolyArea(straight_path_polys[j], &area_type);
+      if (!MakeAgentRequest(id, from, to, request)) {
+        return false;
       }
-      area.emplace_back(area_type);
     }
+    request.ticket = ticket;
+    return _path_planner.Request(std::move(request));
+  }
 
+  void Navigation::TakeAgentRoutes(std::vector<PathResult> &results) {
+    _path_planner.TakeResults(results);
+  }
+
+  bool Navigation::MakeAgentRequest(ActorId id, carla::geom::Location from, carla::geom::Location to,
+  PathRequest &request) {
+    // 从代理获取当前过滤器
+    auto it = _mapped_walkers_id.find(id);
+    if (it == _mapped_walkers_id.end()) {
+      return false;
+    }
+    const unsigned char filter_type = _crowd->getAgent(it->second)->params.queryFilterType;
+    request.id = id;
+    request.ticket = 0u;
+    request.from = from;
+    request.to = to;
+    request.filter = *_crowd->getFilter(filter_type);
+    request.filter_type = filter_type;
     return true;
   }
 
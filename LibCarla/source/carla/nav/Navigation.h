@@ -13,6 +13,7 @@
 // 使用几何库相关功能
 #include "carla/geom/Location.h"
 #include "carla/geom/Transform.h"
+#include "carla/nav/PathPlanner.h"
 #include "carla/nav/WalkerManager.h" 
 
 // 使用远程过程调用相关功能
@@ -76,6 +77,10 @@ namespace nav {
     std::vector<carla::geom::Location> &path, std::vector<unsigned char> &area);
     bool GetAgentRoute(ActorId id, carla::geom::Location from, carla::geom::Location to,
     std::vector<carla::geom::Location> &path, std::vector<unsigned char> &area);
+    /// 将代理的路径规划请求放入后台队列，服务不可用时返回 false
+    bool RequestAgentRoute(ActorId id, uint64_t ticket, carla::geom::Location from, carla::geom::Location to);
+    /// 取走后台已完成的路径规划结果
+    void TakeAgentRoutes(std::vector<PathResult> &results);
 
     /// 引用模拟器来访问API函数
     void SetSimulator(std::weak_ptr<carla::client::detail::Simulator> simulator);
@@ -148,6 +153,9 @@ namespace nav {
     /// 行人管理器负责带事件的路线规划
     WalkerManager _walker_manager;
 
+    /// 后台路径规划，每个工作线程使用自己的查询对象
+    PathPlanner _path_planner;
+
     std::weak_ptr<carla::client::detail::Simulator> _simulator;
     
     mutable std::mutex _mutex;
@@ -156,6 +164,8 @@ namespace nav {
 
     /// 为代理分配过滤索引
     void SetAgentFilter(int agent_index, int filter_index);
+    /// 填充代理的路径规划请求，需要持有 _mutex
+    bool MakeAgentRequest(ActorId id, carla::geom::Location from, carla::geom::Location to, PathRequest &request);
   };
 
 } // namespace nav
@@ -0,0 +1,134 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace carla {
+namespace nav {
+
+  /// 以（起点多边形、终点多边形、过滤器类型）为键的最近最少使用缓存，
+  /// 保存两者之间由 findPath 得到的多边形走廊。
+  ///
+  /// 行人的起终点常常集中在少数多边形上（例如人行横道两端），命中时只需
+  /// 在走廊上重新计算拐点路径，跳过 A* 搜索。可被多个线程同时访问。
+  template <typename PolyRef>
+  class PathCache : private NonCopyable {
+  public:
+
+    using Corridor = std::vector<PolyRef>;
+
+    struct Key {
+      PolyRef start;
+      PolyRef end;
+      unsigned char filter_type;
+
+      bool operator==(const Key &rhs) const {
+        return start == rhs.start && end == rhs.end && filter_type == rhs.filter_type;
+      }
+    };
+
+    /// @a capacity 为 0 时禁用缓存。
+    explicit PathCache(size_t capacity = 1024u)
+      : _capacity(capacity) {}
+
+    /// 查找走廊，命中时将该项移到最前面。
+    bool Get(const Key &key, Corridor &corridor) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      auto it = _index.find(key);
+      if (it == _index.end()) {
+        ++_misses;
+        return false;
+      }
+      _entries.splice(_entries.begin(), _entries, it->second);
+      corridor = it->second->second;
+      ++_hits;
+      return true;
+    }
+
+    /// 插入或更新走廊，超出容量时淘汰最久未使用的项。
+    void Put(const Key &key, Corridor corridor) {
+      if (_capacity == 0u) {
+        return;
+      }
+      std::lock_guard<std::mutex> lock(_mutex);
+      auto it = _index.find(key);
+      if (it != _index.end()) {
+        it->second->second = std::move(corridor);
+        _entries.splice(_entries.begin(), _entries, it->second);
+        return;
+      }
+      if (_entries.size() >= _capacity) {
+        _index.erase(_entries.back().first);
+        _entries.pop_back();
+      }
+      _entries.emplace_front(key, std::move(corridor));
+      _index.emplace(key, _entries.begin());
+    }
+
+    void Clear() {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _entries.clear();
+      _index.clear();
+      _hits = 0u;
+      _misses = 0u;
+    }
+
+    size_t GetSize() const {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _entries.size();
+    }
+
+    size_t GetCapacity() const {
+      return _capacity;
+    }
+
+    uint64_t GetHits() const {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _hits;
+    }
+
+    uint64_t GetMisses() const {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _misses;
+    }
+
+  private:
+
+    struct KeyHash {
+      size_t operator()(const Key &key) const {
+        const size_t start = std::hash<PolyRef>()(key.start);
+        const size_t end = std::hash<PolyRef>()(key.end);
+        return (start * 31u + end) * 31u + key.filter_type;
+      }
+    };
+
+    using Entries = std::list<std::pair<Key, Corridor>>;
+
+    const size_t _capacity;
+
+    mutable std::mutex _mutex;
+
+    Entries _entries;
+
+    std::unordered_map<Key, typename Entries::iterator, KeyHash> _index;
+
+    uint64_t _hits = 0u;
+
+    uint64_t _misses = 0u;
+  };
+
+} // namespace nav
+} // namespace carla
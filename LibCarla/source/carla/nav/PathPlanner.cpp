@@ -0,0 +1,191 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/nav/PathPlanner.h"
+
+#include "carla/Debug.h"
+#include "carla/Logging.h"
+
+#include <recast/DetourCommon.h>
+
+namespace carla {
+namespace nav {
+
+  // 与 Navigation.cpp 中的 MAX_POLYS 相同
+  static const int MAX_POLYS = 256;
+
+  PathPlanner::PathPlanner(size_t cache_capacity)
+    : _cache(cache_capacity) {}
+
+  PathPlanner::~PathPlanner() {
+    Stop();
+  }
+
+  void PathPlanner::Start(const dtNavMesh *mesh, int max_search_nodes, size_t number_of_workers) {
+    DEBUG_ASSERT(mesh != nullptr);
+    Stop();
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = false;
+    }
+    _workers.reserve(number_of_workers);
+    for (size_t i = 0u; i < number_of_workers; ++i) {
+      // 每个线程独立的查询对象，在这里创建以便知道服务是否可用
+      dtNavMeshQuery *query = dtAllocNavMeshQuery();
+      if (query == nullptr || dtStatusFailed(query->init(mesh, max_search_nodes))) {
+        log_error("Nav: failed to create path planner query");
+        dtFreeNavMeshQuery(query);
+        break;
+      }
+      _workers.emplace_back([this, query]() { Run(query); });
+    }
+  }
+
+  void PathPlanner::Stop() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _condition.notify_all();
+    for (auto &worker : _workers) {
+      worker.join();
+    }
+    _workers.clear();
+    std::lock_guard<std::mutex> lock(_mutex);
+    // 排队中的请求不会再被计算，以失败结果答复，调用方可以重新请求
+    for (auto &request : _requests) {
+      PathResult result;
+      result.id = request.id;
+      result.ticket = request.ticket;
+      result.success = false;
+      _results.emplace_back(std::move(result));
+    }
+    _requests.clear();
+    // 缓存中的多边形引用只对当前网格有效
+    _cache.Clear();
+  }
+
+  bool PathPlanner::Request(PathRequest request) {
+    if (!IsRunning()) {
+      return false;
+    }
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _requests.emplace_back(std::move(request));
+    }
+    _condition.notify_one();
+    return true;
+  }
+
+  void PathPlanner::TakeResults(std::vector<PathResult> &results) {
+    results.clear();
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::swap(results, _results);
+  }
+
+  size_t PathPlanner::GetPendingCount() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _requests.size() + _in_progress;
+  }
+
+  void PathPlanner::Run(dtNavMeshQuery *query) {
+    PathRequest request;
+    PathResult result;
+    std::unique_lock<std::mutex> lock(_mutex);
+    for (;;) {
+      _condition.wait(lock, [this]() { return _stop || !_requests.empty(); });
+      if (_stop) {
+        break;
+      }
+      request = std::move(_requests.front());
+      _requests.pop_front();
+      ++_in_progress;
+      lock.unlock();
+
+      FindPath(*query, request, result);
+
+      lock.lock();
+      --_in_progress;
+      _results.emplace_back(std::move(result));
+    }
+
+    dtFreeNavMeshQuery(query);
+  }
+
+  bool PathPlanner::FindPath(dtNavMeshQuery &query, const PathRequest &request, PathResult &result) {
+    result.id = request.id;
+    result.ticket = request.ticket;
+    result.success = false;
+    result.path.clear();
+    result.area.clear();
+
+    // 点的扩展
+    const float poly_pick_ext[3] = {2,4,2};
+
+    // 设置点
+    dtPolyRef start_ref = 0;
+    dtPolyRef end_ref = 0;
+    float start_pos[3] = { request.from.x, request.from.z, request.from.y };
+    float end_pos[3] = { request.to.x, request.to.z, request.to.y };
+    query.findNearestPoly(start_pos, poly_pick_ext, &request.filter, &start_ref, 0);
+    query.findNearestPoly(end_pos, poly_pick_ext, &request.filter, &end_ref, 0);
+    if (!start_ref || !end_ref) {
+      return false;
+    }
+
+    // 获取多边形走廊，优先使用缓存
+    const PathCache<dtPolyRef>::Key key{start_ref, end_ref, request.filter_type};
+    PathCache<dtPolyRef>::Corridor polys;
+    if (!_cache.Get(key, polys)) {
+      polys.resize(MAX_POLYS);
+      int num_polys = 0;
+      query.findPath(start_ref, end_ref, start_pos, end_pos, &request.filter, polys.data(), &num_polys, MAX_POLYS);
+      polys.resize(static_cast<size_t>(num_polys));
+      // 只缓存完整的路径
+      if (!polys.empty() && polys.back() == end_ref) {
+        _cache.Put(key, polys);
+      }
+    }
+    if (polys.empty()) {
+      return false;
+    }
+    const int num_polys = static_cast<int>(polys.size());
+
+    // 如果是部分路径，请确保终点与最后一个多边形相接
+    float end_pos2[3];
+    dtVcopy(end_pos2, end_pos);
+    if (polys.back() != end_ref) {
+      query.closestPointOnPoly(polys.back(), end_pos, end_pos2, 0);
+    }
+
+    // 获取点
+    float straight_path[MAX_POLYS * 3];
+    unsigned char straight_path_flags[MAX_POLYS];
+    dtPolyRef straight_path_polys[MAX_POLYS];
+    int num_straight_path = 0;
+    query.findStraightPath(start_pos, end_pos2, polys.data(), num_polys,
+    straight_path, straight_path_flags,
+    straight_path_polys, &num_straight_path, MAX_POLYS, DT_STRAIGHTPATH_AREA_CROSSINGS);
+
+    // 将路径复制到输出缓冲区
+    const dtNavMesh *mesh = query.getAttachedNavMesh();
+    result.path.reserve(static_cast<size_t>(num_straight_path));
+    result.area.reserve(static_cast<size_t>(num_straight_path));
+    unsigned char area_type = 0;
+    for (int i = 0, j = 0; j < num_straight_path; i += 3, ++j) {
+      // 保存虚幻轴的坐标（x，z，y）
+      result.path.emplace_back(straight_path[i], straight_path[i + 2], straight_path[i + 1]);
+      // 保存区域类型
+      mesh->getPolyArea(straight_path_polys[j], &area_type);
+      result.area.emplace_back(area_type);
+    }
+
+    result.success = true;
+    return true;
+  }
+
+} // namespace nav
+} // namespace carla
@@ -0,0 +1,113 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/geom/Location.h"
+#include "carla/nav/PathCache.h"
+#include "carla/rpc/ActorId.h"
+
+#include <recast/DetourNavMesh.h>
+#include <recast/DetourNavMeshQuery.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace carla {
+namespace nav {
+
+  /// 一次行人路径规划请求。
+  struct PathRequest {
+    ActorId id;
+    /// 由调用方分配，用于丢弃已过期的结果。
+    uint64_t ticket;
+    carla::geom::Location from;
+    carla::geom::Location to;
+    /// 过滤器的副本，工作线程不会访问人群对象。
+    dtQueryFilter filter;
+    unsigned char filter_type;
+  };
+
+  /// 路径规划结果，路径点使用虚幻坐标轴。
+  struct PathResult {
+    ActorId id;
+    uint64_t ticket;
+    bool success;
+    std::vector<carla::geom::Location> path;
+    std::vector<unsigned char> area;
+  };
+
+  /// 在后台线程上计算行人路径。
+  ///
+  /// 每个工作线程拥有自己的 dtNavMeshQuery（查询对象内部的节点池不能共享），
+  /// 导航网格本身只读，因此多个线程可以同时搜索。请求被放入队列，结果由
+  /// 仿真线程在之后的节拍中通过 TakeResults 取走。
+  class PathPlanner : private NonCopyable {
+  public:
+
+    explicit PathPlanner(size_t cache_capacity = 1024u);
+
+    ~PathPlanner();
+
+    /// 在 @a mesh 上启动 @a number_of_workers 个工作线程。调用方需保证
+    /// Stop 之前网格不被修改或释放。查询对象在调用线程上创建，全部创建
+    /// 失败时服务不会启动（IsRunning 返回 false），调用方应改为同步计算。
+    void Start(const dtNavMesh *mesh, int max_search_nodes, size_t number_of_workers);
+
+    /// 停止工作线程并清空缓存。计算中的请求照常完成；排队中的请求以失败
+    /// 结果返回，等待它们的调用方仍能通过 TakeResults 得到答复。
+    void Stop();
+
+    bool IsRunning() const {
+      return !_workers.empty();
+    }
+
+    /// 放入一个请求，服务未启动时返回 false。
+    bool Request(PathRequest request);
+
+    /// 取走所有已完成的结果。
+    void TakeResults(std::vector<PathResult> &results);
+
+    /// 尚未完成的请求数。
+    size_t GetPendingCount() const;
+
+    /// 用 @a query 同步计算路径，可在任意线程上调用，但 @a query 不能被
+    /// 其它线程同时使用。
+    bool FindPath(dtNavMeshQuery &query, const PathRequest &request, PathResult &result);
+
+    const PathCache<dtPolyRef> &GetCache() const {
+      return _cache;
+    }
+
+  private:
+
+    /// 工作线程的主循环，退出时释放 @a query。
+    void Run(dtNavMeshQuery *query);
+
+    PathCache<dtPolyRef> _cache;
+
+    mutable std::mutex _mutex;
+
+    std::condition_variable _condition;
+
+    std::deque<PathRequest> _requests;
+
+    std::vector<PathResult> _results;
+
+    /// 已出队但还在计算中的请求数。
+    size_t _in_progress = 0u;
+
+    bool _stop = false;
+
+    std::vector<std::thread> _workers;
+  };
+
+} // namespace nav
+} // namespace carla
@@ -60,6 +60,9 @@ namespace nav {
 	// 更新所有行人路线
     bool WalkerManager::Update(double delta) {
 
+        // 先应用之前节拍请求的路线
+        ApplyPendingRoutes();
+
         // 检查所有行人
         for (auto &it : _walkers) {
 
@@ -104,6 +107,9 @@ namespace nav {
                 case WALKER_STOP:
                     info.state = WALKER_IDLE;// 停止后切换状态为闲置
                     break;
+
+                case WALKER_WAITING_ROUTE:
+                    break;// 路线由 ApplyPendingRoutes 设置
             }
         }
 
@@ -137,17 +143,53 @@ namespace nav {
 
         // 获取行人信息
         WalkerInfo &info = it->second;
-        std::vector<carla::geom::Location> path;
-        std::vector<unsigned char> area;// 存储区域信息
 
         // 保存起点和终点
         _nav->GetWalkerPosition(id, info.from);
         info.to = to;
         info.currentIndex = 0;
         info.state = WALKER_IDLE;// 初始化状态为闲置
+        info.route.clear();// 清空现有路线
 
-        // 从导航中获取路径
+        // 优先交给后台计算，结果在之后的节拍中应用
+        info.routeTicket = ++_next_route_ticket;
+        if (_nav->RequestAgentRoute(id, info.routeTicket, info.from, to)) {
+            info.state = WALKER_WAITING_ROUTE;
+            return true;
+        }
+
+        // 后台服务不可用时同步获取路径
+        std::vector<carla::geom::Location> path;
+        std::vector<unsigned char> area;// 存储区域信息
         _nav->GetAgentRoute(id, info.from, to, path, area);
+        BuildWalkerRoute(id, info, path, area);
+        return true;
+    }
+
+    // 应用后台完成的路径规划结果
+    void WalkerManager::ApplyPendingRoutes() {
+        if (_nav == nullptr)
+            return;
+
+        _nav->TakeAgentRoutes(_route_results);
+        for (auto &result : _route_results) {
+            // 行人可能已被移除，或者之后又请求了新的路线
+            auto it = _walkers.find(result.id);
+            if (it == _walkers.end())
+                continue;
+            WalkerInfo &info = it->second;
+            if (info.state != WALKER_WAITING_ROUTE || info.routeTicket != result.ticket)
+                continue;
+            BuildWalkerRoute(result.id, info, result.path, result.area);
+        }
+        _route_results.clear();
+    }
+
+    // 根据路径点创建行人路线
+    void WalkerManager::BuildWalkerRoute(ActorId id, WalkerInfo &info,
+        std::vector<carla::geom::Location> &path, std::vector<unsigned char> &area) {
+        info.currentIndex = 0;
+        info.state = WALKER_IDLE;
 
         // 创建每个路径点
         info.route.clear();// 清空现有路线
@@ -177,7 +219,6 @@ namespace nav {
 
         // 分配下一个要走的点
         SetWalkerNextPoint(id);
-        return true;
     }
 
     // 设置路线中的下一个点
@@ -11,6 +11,7 @@
 #include "carla/client/TrafficLight.h"
 #include "carla/client/World.h"
 #include "carla/geom/Location.h"
+#include "carla/nav/PathPlanner.h"
 #include "carla/nav/WalkerEvent.h"
 #include "carla/rpc/ActorId.h"
 #include "carla/rpc/TrafficLightState.h"
@@ -25,7 +26,8 @@ namespace nav {
         WALKER_IDLE,
         WALKER_WALKING,
         WALKER_IN_EVENT,
-        WALKER_STOP
+        WALKER_STOP,
+        WALKER_WAITING_ROUTE // 等待后台路径规划的结果
     };
 
     // 定义一个结构体用于表示行人路线中的某一点
@@ -44,6 +46,7 @@ namespace nav {
         unsigned int currentIndex { 0 };
         WalkerState state;
         std::vector<WalkerRoutePoint> route;
+        uint64_t routeTicket { 0 };// 最近一次路径规划请求的编号
     };
 
   // 定义 WalkerManager 类用于管理行人及其路径
@@ -96,10 +99,19 @@ namespace nav {
     // 执行特定事件的处理
     EventResult ExecuteEvent(ActorId id, WalkerInfo &info, double delta);
 
+    // 应用后台完成的路径规划结果
+    void ApplyPendingRoutes();
+
+    // 根据路径点创建行人路线并开始行走
+    void BuildWalkerRoute(ActorId id, WalkerInfo &info,
+        std::vector<carla::geom::Location> &path, std::vector<unsigned char> &area);
+
     std::unordered_map<ActorId, WalkerInfo> _walkers;
     std::vector<std::pair<SharedPtr<carla::client::TrafficLight>, carla::geom::Location>> _traffic_lights;
     Navigation *_nav { nullptr };
     std::weak_ptr<carla::client::detail::Simulator> _simulator;
+    uint64_t _next_route_ticket { 0 };
+    std::vector<PathResult> _route_results;
   };
 
 } // namespace nav
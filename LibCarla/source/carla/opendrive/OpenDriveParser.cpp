@@ -24,7 +24,9 @@
 namespace carla {
 namespace opendrive {
 
-  boost::optional<road::Map> OpenDriveParser::Load(const std::string &opendrive) {
+  boost::optional<road::Map> OpenDriveParser::Load(
+      const std::string &opendrive,
+      std::istream *rtree_cache) {
     pugi::xml_document xml;
     pugi::xml_parse_result parse_result = xml.load_string(opendrive.c_str());  // 使用 pugixml XML 处理工具加载OpenDrive文件
 
@@ -34,6 +36,7 @@ namespace opendrive {
     }
 // 创建MapBuilder对象，用于构建地图
     carla::road::MapBuilder map_builder;
+    map_builder.SetSourceFingerprint(road::Map::ComputeRtreeFingerprint(opendrive));
  // 使用GeoReferenceParser解析器解析XML中的地理参考信息（如坐标系统），并将这些信息传递给map_builder对象以构建地图的地理基础  
     parser::GeoReferenceParser::Parse(xml, map_builder);
  // 使用RoadParser解析器解析XML中的道路信息（如道路形状、类型等）， 并将这些信息添加到map_builder对象中 
@@ -55,7 +58,7 @@ namespace opendrive {
   // 使用ControllerParser解析器解析XML中可能存在的控制器配置信息  ，并将这些信息添加到map_builder对象中  
     parser::ControllerParser::Parse(xml, map_builder);
 
-    return map_builder.Build();
+    return map_builder.Build(rtree_cache);
   }
 
 } // namespace opendrive
@@ -20,7 +20,10 @@ namespace opendrive {
 // 函数返回一个boost::optional<road::Map>类型的值 ， boost::optional是一个模板类，用于表示一个可能不存在的值  
 // 在这里，它表示可能成功解析并生成一个road::Map对象，也可能因为某些原因（如文件不存在、解析错误等）而失败  
 // road::Map是CARLA中定义的一个类，用于表示一个完整的道路网络地图  
-    static boost::optional<road::Map> Load(const std::string &opendrive);
+// 可选的 @a rtree_cache 为 road::Map::SaveRtree 写出的缓存，有效时不再重新生成路段 R 树
+    static boost::optional<road::Map> Load(
+        const std::string &opendrive,
+        std::istream *rtree_cache = nullptr);
   };
 
 } // namespace opendrive
@@ -6,11 +6,14 @@
 
 #pragma once
 
+#include "carla/Exception.h"
 #include "carla/FileSystem.h"
 
 #include <fstream>
 #include <iterator>
 #include <iomanip>
+#include <stdexcept>
+#include <type_traits>
 
 namespace carla {// 定义命名空间carla，用于组织相关的代码和数据
 namespace pointcloud {// 定义命名空间pointcloud，进一步组织特定于点云处理的代码
@@ -42,13 +45,42 @@ namespace pointcloud {// 定义命名空间pointcloud，进一步组织特定于
       return path;
     }
 
+    /// 以 binary_little_endian 格式写入 PLY。要求点类型的内存布局与其
+    /// WritePlyHeaderInfo 声明的属性逐字节一致（LiDAR 与语义 LiDAR 的检测点
+    /// 均为紧凑布局），因此点数据无需格式化，可直接整块写出。
+    template <typename T>
+    static void DumpBinary(std::ostream &out, const T *begin, const T *end) {
+      static_assert(std::is_trivially_copyable<T>::value, "Point type must be trivially copyable");
+      WriteHeader(out, begin, end, "binary_little_endian");
+      out.write(
+          reinterpret_cast<const char *>(begin),
+          static_cast<std::streamsize>(sizeof(T) * static_cast<size_t>(end - begin)));
+    }
+
+    template <typename T>
+    static std::string SaveToDiskBinary(std::string path, const T *begin, const T *end) {
+      FileSystem::ValidateFilePath(path, ".ply");
+      std::ofstream out(path, std::ios::binary);
+      DumpBinary(out, begin, end);
+      // 打开或写入失败时抛出异常，调用者（如 AsyncDataWriter）据此统计失败的任务。
+      out.close();
+      if (!out) {
+        throw_exception(std::runtime_error("failed to write " + path));
+      }
+      return path;
+    }
+
   private:
-    template <typename PointIt> static void WriteHeader(std::ostream &out, PointIt begin, PointIt end) {
+    template <typename PointIt> static void WriteHeader(
+        std::ostream &out,
+        PointIt begin,
+        PointIt end,
+        const char *format = "ascii") {
       // 断言确保点云数据的数量非负
       DEBUG_ASSERT(std::distance(begin, end) >= 0);
       // 写入PLY文件的基本头部信息
       out << "ply\n"
-           "format ascii 1.0\n"
+           "format " << format << " 1.0\n"
            // 写入元素(vertex)的数量，即点云中的点数
            "element vertex " << std::to_string(static_cast<size_t>(std::distance(begin, end))) << "\n";
       // 假设每个点对象都有WritePlyHeaderInfo方法，用于写入特定的头部信息      
@@ -0,0 +1,316 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/pointcloud/VoxelMap.h"
+
+#include "carla/Debug.h"
+#include "carla/ThreadGroup.h"
+#include "carla/sensor/data/LidarMeasurement.h"
+#include "carla/sensor/data/SemanticLidarMeasurement.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <thread>
+
+namespace carla {
+namespace pointcloud {
+
+  // 每个轴上体素下标的位数。
+  static constexpr int64_t AxisBits = 21;
+  static constexpr int64_t AxisOffset = int64_t(1) << (AxisBits - 1);
+
+  // 超过该点数时默认使用多线程。
+  static constexpr size_t ParallelThreshold = 32u * 1024u;
+
+  static constexpr uint8_t InvalidShard = 0xFFu;
+
+  static bool ToVoxelIndex(double coordinate, double inverse_size, int64_t &index) {
+    const double cell = std::floor(coordinate * inverse_size);
+    // NaN 与超出范围的坐标都不满足该条件。
+    if (!(cell >= -static_cast<double>(AxisOffset) && cell < static_cast<double>(AxisOffset))) {
+      return false;
+    }
+    index = static_cast<int64_t>(cell) + AxisOffset;
+    return true;
+  }
+
+  static uint64_t Mix(uint64_t value) {
+    value ^= value >> 30u;
+    value *= 0xbf58476d1ce4e5b9ull;
+    value ^= value >> 27u;
+    value *= 0x94d049bb133111ebull;
+    value ^= value >> 31u;
+    return value;
+  }
+
+  template <typename T>
+  static T ReadField(const unsigned char *element, int offset) {
+    T value;
+    std::memcpy(&value, element + offset, sizeof(T));
+    return value;
+  }
+
+  // ===========================================================================
+  // -- VoxelMap::Voxel --------------------------------------------------------
+  // ===========================================================================
+
+  void VoxelMap::Voxel::AddTag(uint32_t tag) {
+    for (auto &candidate : tags) {
+      if (candidate.second > 0u && candidate.first == tag) {
+        ++candidate.second;
+        return;
+      }
+    }
+    for (auto &candidate : tags) {
+      if (candidate.second == 0u) {
+        candidate = {tag, 1u};
+        return;
+      }
+    }
+    // 候选已满：所有计数减一（Misra-Gries）。
+    for (auto &candidate : tags) {
+      --candidate.second;
+    }
+  }
+
+  uint32_t VoxelMap::Voxel::GetTag() const {
+    uint32_t tag = 0u;
+    uint32_t best = 0u;
+    for (const auto &candidate : tags) {
+      if (candidate.second > best) {
+        tag = candidate.first;
+        best = candidate.second;
+      }
+    }
+    return tag;
+  }
+
+  // ===========================================================================
+  // -- VoxelMap ---------------------------------------------------------------
+  // ===========================================================================
+
+  VoxelMap::VoxelMap(const Options &options)
+    : _options(options),
+      _inverse_voxel_size(1.0f / options.voxel_size) {
+    DEBUG_ASSERT(options.voxel_size > 0.0f);
+  }
+
+  size_t VoxelMap::GetThreadCount(size_t work) const {
+    size_t threads = _options.threads;
+    if (threads == 0u) {
+      threads = (work < ParallelThreshold) ?
+          1u :
+          std::max(1u, std::thread::hardware_concurrency());
+    }
+    return std::min(threads, ShardCount);
+  }
+
+  template <typename F>
+  void VoxelMap::ParallelFor(size_t count, size_t num_threads, F functor) const {
+    const size_t batch = (count + num_threads - 1u) / std::max<size_t>(num_threads, 1u);
+    if (num_threads <= 1u || batch >= count) {
+      functor(size_t(0u), count);
+      return;
+    }
+    ThreadGroup workers;
+    for (auto begin = batch; begin < count; begin += batch) {
+      const auto end = std::min(begin + batch, count);
+      workers.CreateThread([=]() { functor(begin, end); });
+    }
+    functor(size_t(0u), batch);
+    workers.JoinAll();
+  }
+
+  void VoxelMap::AddPoints(
+      const PointBuffer &points,
+      const geom::Transform &sensor_transform,
+      const double timestamp) {
+    DEBUG_ASSERT(points.count == 0u || points.data != nullptr);
+    std::lock_guard<std::mutex> lock(_mutex);
+    _cloud = nullptr;
+    _latest_timestamp = _has_timestamp ? std::max(_latest_timestamp, timestamp) : timestamp;
+    _has_timestamp = true;
+
+    const size_t count = points.count;
+    _world.resize(count);
+    _keys.resize(count);
+    _point_shards.resize(count);
+    const size_t num_threads = GetThreadCount(count);
+
+    // 变换到世界坐标系并计算体素键值与分片。
+    const auto matrix = sensor_transform.GetMatrix();
+    const double inverse_size = _inverse_voxel_size;
+    ParallelFor(count, num_threads, [&](size_t begin, size_t end) {
+      for (auto i = begin; i < end; ++i) {
+        const unsigned char *element = points.data + i * points.stride;
+        const double x = ReadField<float>(element, 0);
+        const double y = ReadField<float>(element, sizeof(float));
+        const double z = ReadField<float>(element, 2 * sizeof(float));
+        const double wx = matrix[0] * x + matrix[1] * y + matrix[2] * z + matrix[3];
+        const double wy = matrix[4] * x + matrix[5] * y + matrix[6] * z + matrix[7];
+        const double wz = matrix[8] * x + matrix[9] * y + matrix[10] * z + matrix[11];
+        int64_t ix, iy, iz;
+        if (!ToVoxelIndex(wx, inverse_size, ix) ||
+            !ToVoxelIndex(wy, inverse_size, iy) ||
+            !ToVoxelIndex(wz, inverse_size, iz)) {
+          _point_shards[i] = InvalidShard;
+          continue;
+        }
+        const Key key =
+            (static_cast<Key>(ix) << (2 * AxisBits)) |
+            (static_cast<Key>(iy) << AxisBits) |
+            static_cast<Key>(iz);
+        _world[i] = geom::Location(
+            static_cast<float>(wx),
+            static_cast<float>(wy),
+            static_cast<float>(wz));
+        _keys[i] = key;
+        _point_shards[i] = static_cast<uint8_t>(Mix(key) % ShardCount);
+      }
+    });
+
+    // 每个线程只更新自己的分片，分片内按输入顺序累积。
+    const geom::Location sensor_location = sensor_transform.location;
+    const bool evict = ShouldEvict(sensor_location);
+    ParallelFor(ShardCount, num_threads, [&](size_t first_shard, size_t last_shard) {
+      for (size_t i = 0u; i < count; ++i) {
+        const size_t shard = _point_shards[i];
+        if (shard < first_shard || shard >= last_shard) {
+          continue;
+        }
+        const unsigned char *element = points.data + i * points.stride;
+        Voxel &voxel = _shards[shard][_keys[i]];
+        voxel.sum_x += _world[i].x;
+        voxel.sum_y += _world[i].y;
+        voxel.sum_z += _world[i].z;
+        if (points.intensity_offset >= 0) {
+          voxel.sum_intensity += ReadField<float>(element, points.intensity_offset);
+        }
+        voxel.AddTag(points.tag_offset >= 0 ? ReadField<uint32_t>(element, points.tag_offset) : 0u);
+        voxel.last_seen = std::max(voxel.last_seen, timestamp);
+        ++voxel.count;
+      }
+      for (auto shard = first_shard; evict && shard < last_shard; ++shard) {
+        Evict(_shards[shard], _latest_timestamp, sensor_location);
+      }
+    });
+  }
+
+  bool VoxelMap::ShouldEvict(const geom::Location &sensor_location) {
+    const bool evict_old = _options.max_age > 0.0;
+    const bool evict_far = _options.max_distance > 0.0f;
+    if (!evict_old && !evict_far) {
+      return false;
+    }
+    // 遍历所有体素的代价与地图大小成正比，因此只在窗口移动了 1/8 之后才执行。
+    const bool evict = !_has_evicted ||
+        (evict_old && (_latest_timestamp - _eviction_timestamp) >= (_options.max_age / 8.0)) ||
+        (evict_far && sensor_location.Distance(_eviction_location) >= (_options.max_distance / 8.0f));
+    if (evict) {
+      _has_evicted = true;
+      _eviction_timestamp = _latest_timestamp;
+      _eviction_location = sensor_location;
+    }
+    return evict;
+  }
+
+  void VoxelMap::Evict(Shard &shard, const double timestamp, const geom::Location &sensor_location) const {
+    const bool evict_old = _options.max_age > 0.0;
+    const bool evict_far = _options.max_distance > 0.0f;
+    const double oldest = timestamp - _options.max_age;
+    const double max_squared_distance =
+        static_cast<double>(_options.max_distance) * static_cast<double>(_options.max_distance);
+    for (auto it = shard.begin(); it != shard.end();) {
+      const Voxel &voxel = it->second;
+      bool evict = evict_old && (voxel.last_seen < oldest);
+      if (!evict && evict_far) {
+        const double dx = voxel.sum_x / voxel.count - sensor_location.x;
+        const double dy = voxel.sum_y / voxel.count - sensor_location.y;
+        const double dz = voxel.sum_z / voxel.count - sensor_location.z;
+        evict = (dx * dx + dy * dy + dz * dz) > max_squared_distance;
+      }
+      it = evict ? shard.erase(it) : std::next(it);
+    }
+  }
+
+  void VoxelMap::AddLidar(const sensor::data::LidarMeasurement &measurement) {
+    using Detection = sensor::data::LidarDetection;
+    PointBuffer points;
+    points.data = reinterpret_cast<const unsigned char *>(measurement.data());
+    points.count = measurement.size();
+    points.stride = sizeof(Detection);
+    points.intensity_offset = offsetof(Detection, intensity);
+    AddPoints(points, measurement.GetSensorTransform(), measurement.GetTimestamp());
+  }
+
+  void VoxelMap::AddSemanticLidar(const sensor::data::SemanticLidarMeasurement &measurement) {
+    using Detection = sensor::data::SemanticLidarDetection;
+    PointBuffer points;
+    points.data = reinterpret_cast<const unsigned char *>(measurement.data());
+    points.count = measurement.size();
+    points.stride = sizeof(Detection);
+    points.intensity_offset = offsetof(Detection, cos_inc_angle);
+    points.tag_offset = offsetof(Detection, object_tag);
+    AddPoints(points, measurement.GetSensorTransform(), measurement.GetTimestamp());
+  }
+
+  void VoxelMap::Clear() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto &shard : _shards) {
+      shard.clear();
+    }
+    _latest_timestamp = 0.0;
+    _has_timestamp = false;
+    _has_evicted = false;
+    _cloud = nullptr;
+  }
+
+  size_t VoxelMap::GetVoxelCount() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    size_t count = 0u;
+    for (const auto &shard : _shards) {
+      count += shard.size();
+    }
+    return count;
+  }
+
+  SharedPtr<const VoxelCloud> VoxelMap::GetCloud() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_cloud != nullptr) {
+      return _cloud;
+    }
+    std::array<size_t, ShardCount + 1u> offsets;
+    offsets[0u] = 0u;
+    for (size_t shard = 0u; shard < ShardCount; ++shard) {
+      offsets[shard + 1u] = offsets[shard] + _shards[shard].size();
+    }
+    auto cloud = MakeShared<VoxelCloud>();
+    cloud->points.resize(offsets.back());
+    ParallelFor(ShardCount, GetThreadCount(offsets.back()), [&](size_t first_shard, size_t last_shard) {
+      for (auto shard = first_shard; shard < last_shard; ++shard) {
+        VoxelPoint *output = cloud->points.data() + offsets[shard];
+        for (const auto &item : _shards[shard]) {
+          const Voxel &voxel = item.second;
+          const double count = voxel.count;
+          *output++ = VoxelPoint{
+              static_cast<float>(voxel.sum_x / count),
+              static_cast<float>(voxel.sum_y / count),
+              static_cast<float>(voxel.sum_z / count),
+              static_cast<float>(voxel.sum_intensity / count),
+              voxel.GetTag(),
+              voxel.count};
+        }
+      }
+    });
+    _cloud = std::move(cloud);
+    return _cloud;
+  }
+
+} // namespace pointcloud
+} // namespace carla
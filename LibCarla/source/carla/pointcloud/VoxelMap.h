@@ -0,0 +1,174 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Memory.h"
+#include "carla/NonCopyable.h"
+#include "carla/geom/Location.h"
+#include "carla/geom/Transform.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace carla {
+namespace sensor {
+namespace data {
+  class LidarMeasurement;
+  class SemanticLidarMeasurement;
+} // namespace data
+} // namespace sensor
+
+namespace pointcloud {
+
+  /// 体素地图中的一个体素：点的质心（世界坐标，米）、平均强度、出现次数最多
+  /// 的语义标签以及落入该体素的点数。
+  struct VoxelPoint {
+    float x;
+    float y;
+    float z;
+    float intensity;
+    uint32_t tag;
+    uint32_t count;
+  };
+
+  static_assert(sizeof(VoxelPoint) == 24u, "Invalid VoxelPoint size");
+
+  /// VoxelMap 在某一时刻的不可变快照，之后对地图的修改不会影响它。
+  struct VoxelCloud {
+    std::vector<VoxelPoint> points;
+  };
+
+  /// 传感器缓冲区中的点，相邻元素相隔 @a stride 字节，每个元素以 x, y, z
+  /// 三个 float（传感器坐标系，米）开头。
+  struct PointBuffer {
+    const unsigned char *data = nullptr;
+    size_t count = 0u;
+    size_t stride = 0u;
+    /// 强度字段（float）在元素内的字节偏移，没有时为 -1。
+    int intensity_offset = -1;
+    /// 语义标签字段（uint32_t）在元素内的字节偏移，没有时为 -1。
+    int tag_offset = -1;
+  };
+
+  /// 将多帧、多个传感器的点云累积到世界坐标系下的稀疏体素哈希中。
+  ///
+  /// 体素按键值分到固定数量的分片中，每个分片只由一个线程更新，因此不需要
+  /// 加锁，并且每个体素内的点总是按输入顺序累积，结果与线程数无关。每个体素
+  /// 记录质心、平均强度与至多 4 个候选语义标签（Misra-Gries），体素内不超过
+  /// 4 种标签时得到的就是准确的多数标签。
+  ///
+  /// 可选的滑动窗口会移除过旧或离传感器过远的体素，适用于长距离行驶。为了不在
+  /// 每次添加时遍历整个地图，只有窗口移动了其大小的 1/8 之后才会执行移除，因此
+  /// 体素可能在超出窗口不多时仍然保留。公有方法之间互斥，可以从多个线程调用
+  /// （例如 Python 端释放 GIL 后的多个传感器回调），同一时刻只有一个在执行。
+  class VoxelMap : private NonCopyable {
+  public:
+
+    struct Options {
+      /// 体素边长（米）。每个轴上的体素下标限制在 [-2^20, 2^20) 内，超出的点被忽略。
+      float voxel_size = 0.1f;
+      /// 超过该时长（秒，以测量的时间戳计）没有新点的体素会被移除，0 表示不限。
+      double max_age = 0.0;
+      /// 质心距最近一次传感器位置超过该距离（米）的体素会被移除，0 表示不限。
+      float max_distance = 0.0f;
+      /// 线程数，0 表示自动选择，1 表示在调用线程中执行。
+      size_t threads = 0u;
+    };
+
+    explicit VoxelMap(const Options &options);
+
+    VoxelMap() : VoxelMap(Options{}) {}
+
+    const Options &GetOptions() const {
+      return _options;
+    }
+
+    /// 以测量头中的传感器变换将 @a points 变换到世界坐标系后累积。
+    void AddPoints(const PointBuffer &points, const geom::Transform &sensor_transform, double timestamp);
+
+    /// 累积一次激光雷达测量，标签为 0。
+    void AddLidar(const sensor::data::LidarMeasurement &measurement);
+
+    /// 累积一次语义激光雷达测量，强度为入射角的余弦。
+    void AddSemanticLidar(const sensor::data::SemanticLidarMeasurement &measurement);
+
+    void Clear();
+
+    size_t GetVoxelCount() const;
+
+    /// 返回当前地图的快照，地图没有变化时重复调用返回同一个对象。
+    SharedPtr<const VoxelCloud> GetCloud();
+
+  private:
+
+    using Key = uint64_t;
+
+    struct Voxel {
+      double sum_x = 0.0;
+      double sum_y = 0.0;
+      double sum_z = 0.0;
+      double sum_intensity = 0.0;
+      double last_seen = 0.0;
+      uint32_t count = 0u;
+      /// 候选标签与其计数，计数为 0 的位置为空。
+      std::array<std::pair<uint32_t, uint32_t>, 4u> tags{};
+
+      void AddTag(uint32_t tag);
+
+      uint32_t GetTag() const;
+    };
+
+    using Shard = std::unordered_map<Key, Voxel>;
+
+    static constexpr size_t ShardCount = 64u;
+
+    size_t GetThreadCount(size_t work) const;
+
+    /// 并行执行 functor(begin, end)，将 [0, count) 切分为连续区间。
+    template <typename F>
+    void ParallelFor(size_t count, size_t num_threads, F functor) const;
+
+    /// 滑动窗口自上次移除后移动得足够远时返回 true。
+    bool ShouldEvict(const geom::Location &sensor_location);
+
+    void Evict(Shard &shard, double timestamp, const geom::Location &sensor_location) const;
+
+    Options _options;
+
+    float _inverse_voxel_size;
+
+    mutable std::mutex _mutex;
+
+    std::array<Shard, ShardCount> _shards;
+
+    double _latest_timestamp = 0.0;
+
+    bool _has_timestamp = false;
+
+    bool _has_evicted = false;
+
+    double _eviction_timestamp = 0.0;
+
+    geom::Location _eviction_location;
+
+    SharedPtr<const VoxelCloud> _cloud;
+
+    // 每次添加复用的缓冲区。
+    std::vector<geom::Location> _world;
+
+    std::vector<Key> _keys;
+
+    std::vector<uint8_t> _point_shards;
+  };
+
+} // namespace pointcloud
+} // namespace carla
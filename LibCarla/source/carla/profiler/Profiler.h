@@ -100,25 +100,28 @@ namespace detail { // 开始 detail 命名空间
 #  define LIBCARLA_GTEST_GET_TEST_NAME() std::string("") // 否则返回空字符串
 #endif // LIBCARLA_WITH_GTEST
 
-#define CARLA_PROFILE_SCOPE(context, profiler_name) \ // 定义性能分析作用域宏
-    static thread_local ::carla::profiler::detail::ProfilerData carla_profiler_ ## context ## _ ## profiler_name ## _data( \ // 创建性能数据实例
-        LIBCARLA_GTEST_GET_TEST_NAME() + "." #context "." #profiler_name); \ // 初始化性能数据名称
-    ::carla::profiler::detail::ScopedProfiler carla_profiler_ ## context ## _ ## profiler_name ## _scoped_profiler( \ // 创建作用域性能分析器
-        carla_profiler_ ## context ## _ ## profiler_name ## _data); // 关联到性能数据
-
-#define CARLA_PROFILE_FPS(context, profiler_name) \ // 定义性能分析FPS宏
-    { \ // 开始代码块
-      static thread_local ::carla::StopWatch stop_watch; \ // 创建计时器实例
-      stop_watch.Stop(); \ // 停止计时器
-      static thread_local bool first_time = true; \ // 首次标志变量
-      if (!first_time) { \ // 如果不是第一次
-        static thread_local ::carla::profiler::detail::ProfilerData profiler_data( \ // 创建性能数据实例
-            LIBCARLA_GTEST_GET_TEST_NAME() + "." #context "." #profiler_name, true); \ // 初始化名称并设置打印FPS为真
-        profiler_data.Annotate(stop_watch); \ // 注解计时器数据
-      } else { \ // 如果是第一次
-        first_time = false; \ // 更新首次标志
+// 定义性能分析作用域宏：创建线程局部的性能数据实例，并用作用域性能分析器统计本作用域的耗时
+// （注释不能写在续行符之后，否则续行符失效）
+#define CARLA_PROFILE_SCOPE(context, profiler_name) \
+    static thread_local ::carla::profiler::detail::ProfilerData carla_profiler_ ## context ## _ ## profiler_name ## _data( \
+        LIBCARLA_GTEST_GET_TEST_NAME() + "." #context "." #profiler_name); \
+    ::carla::profiler::detail::ScopedProfiler carla_profiler_ ## context ## _ ## profiler_name ## _scoped_profiler( \
+        carla_profiler_ ## context ## _ ## profiler_name ## _data);
+
+// 定义性能分析FPS宏：统计相邻两次经过此处的间隔，第一次只启动计时器
+#define CARLA_PROFILE_FPS(context, profiler_name) \
+    { \
+      static thread_local ::carla::StopWatch stop_watch; \
+      stop_watch.Stop(); \
+      static thread_local bool first_time = true; \
+      if (!first_time) { \
+        static thread_local ::carla::profiler::detail::ProfilerData profiler_data( \
+            LIBCARLA_GTEST_GET_TEST_NAME() + "." #context "." #profiler_name, true); \
+        profiler_data.Annotate(stop_watch); \
+      } else { \
+        first_time = false; \
       } \
-      stop_watch.Restart(); \ // 重新启动计时器
+      stop_watch.Restart(); \
     }
 
 #endif // LIBCARLA_ENABLE_PROFILER 
@@ -0,0 +1,364 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/profiler/Tracer.h"
+
+#include "carla/Logging.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#ifdef _WIN32
+#  include <process.h>
+#else
+#  include <unistd.h>
+#endif
+
+namespace carla {
+namespace profiler {
+
+  constexpr size_t Tracer::EVENTS_PER_THREAD;
+
+  constexpr size_t Tracer::MAX_NAME_LENGTH;
+
+  std::atomic_bool Tracer::_enabled{false};
+
+  namespace {
+
+    enum class EventType : uint8_t {
+      Span,
+      Counter,
+      Instant
+    };
+
+    struct Event {
+      const char *category;
+      uint64_t timestamp;
+      union {
+        uint64_t duration;
+        double value;
+      };
+      EventType type;
+      char name[Tracer::MAX_NAME_LENGTH + 1u];
+    };
+
+    static_assert(sizeof(Event) == 64u, "unexpected trace event size");
+
+    static_assert(
+        (Tracer::EVENTS_PER_THREAD & (Tracer::EVENTS_PER_THREAD - 1u)) == 0u,
+        "EVENTS_PER_THREAD must be a power of two");
+
+    /// 单个线程的事件缓冲区，只有所属线程写入。
+    struct ThreadBuffer {
+      uint32_t tid = 0u;
+      /// 由 Registry::mutex 保护。
+      std::string name;
+      /// 已写入的事件总数，事件 i 位于 events[i % EVENTS_PER_THREAD]。
+      std::atomic<uint64_t> head{0u};
+      /// Clear() 时的 head，导出时忽略之前的事件。
+      std::atomic<uint64_t> cleared{0u};
+      std::atomic_bool alive{true};
+      std::unique_ptr<Event[]> events{new Event[Tracer::EVENTS_PER_THREAD]};
+    };
+
+    struct Registry {
+      std::mutex mutex;
+      std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+      uint32_t next_tid = 1u;
+      const uint64_t epoch = Tracer::Now();
+    };
+
+    static Registry &GetRegistry() {
+      static Registry registry;
+      return registry;
+    }
+
+    /// 线程退出时标记缓冲区，已记录的事件仍可导出。
+    struct ThreadBufferHolder {
+      std::shared_ptr<ThreadBuffer> buffer;
+
+      ~ThreadBufferHolder() {
+        if (buffer != nullptr) {
+          buffer->alive = false;
+        }
+      }
+    };
+
+    /// 当前线程的名称。与缓冲区分开保存，追踪关闭时命名线程不会分配缓冲区。
+    static std::string &GetThreadName() {
+      static thread_local std::string name;
+      return name;
+    }
+
+    static ThreadBufferHolder &GetThreadBufferHolder() {
+      static thread_local ThreadBufferHolder holder;
+      return holder;
+    }
+
+    /// 线程第一次记录事件时才分配缓冲区。
+    static ThreadBuffer &GetThreadBuffer() {
+      auto &holder = GetThreadBufferHolder();
+      if (holder.buffer == nullptr) {
+        auto buffer = std::make_shared<ThreadBuffer>();
+        auto &registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        buffer->tid = registry.next_tid++;
+        buffer->name = GetThreadName();
+        registry.buffers.push_back(buffer);
+        holder.buffer = std::move(buffer);
+      }
+      return *holder.buffer;
+    }
+
+    static Event &BeginEvent(ThreadBuffer &buffer, uint64_t &index) {
+      index = buffer.head.load(std::memory_order_relaxed);
+      return buffer.events[index & (Tracer::EVENTS_PER_THREAD - 1u)];
+    }
+
+    static void CommitEvent(ThreadBuffer &buffer, uint64_t index) {
+      buffer.head.store(index + 1u, std::memory_order_release);
+    }
+
+    static void CopyName(Event &event, const char *name) {
+      if (name == nullptr) {
+        event.name[0u] = '\0';
+        return;
+      }
+      std::strncpy(event.name, name, Tracer::MAX_NAME_LENGTH);
+      event.name[Tracer::MAX_NAME_LENGTH] = '\0';
+    }
+
+    static void WriteJsonString(std::ostream &out, const char *str) {
+      out << '"';
+      for (; str != nullptr && *str != '\0'; ++str) {
+        const char c = *str;
+        switch (c) {
+          case '"':  out << "\\\""; break;
+          case '\\': out << "\\\\"; break;
+          case '\n': out << "\\n"; break;
+          case '\t': out << "\\t"; break;
+          default:
+            if (static_cast<unsigned char>(c) < 0x20u) {
+              out << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                  << static_cast<int>(c) << std::dec << std::setfill(' ');
+            } else {
+              out << c;
+            }
+        }
+      }
+      out << '"';
+    }
+
+    /// 复制缓冲区中仍然有效的事件。写入线程可能同时覆盖最旧的事件，
+    /// 复制后再次读取 head，丢弃期间可能被覆盖的部分。
+    static std::vector<Event> CopyEvents(const ThreadBuffer &buffer) {
+      constexpr uint64_t capacity = Tracer::EVENTS_PER_THREAD;
+      const uint64_t cleared = buffer.cleared.load(std::memory_order_acquire);
+      const uint64_t head = buffer.head.load(std::memory_order_acquire);
+      uint64_t begin = std::max(cleared, head > capacity ? head - capacity : 0u);
+      std::vector<Event> events;
+      events.reserve(static_cast<size_t>(head - begin));
+      for (uint64_t i = begin; i < head; ++i) {
+        events.push_back(buffer.events[i & (capacity - 1u)]);
+      }
+      // 写入线程可能正在写第 head 个事件（尚未提交），它与第 head - capacity 个共用一个槽；
+      // 线程已退出时没有正在写的事件。
+      const uint64_t in_flight = buffer.alive.load(std::memory_order_acquire) ? 1u : 0u;
+      const uint64_t new_head = buffer.head.load(std::memory_order_acquire) + in_flight;
+      const uint64_t first_valid = new_head > capacity ? new_head - capacity : 0u;
+      if (first_valid > begin) {
+        const auto dropped = static_cast<size_t>(std::min(first_valid, head) - begin);
+        events.erase(events.begin(), events.begin() + dropped);
+      }
+      return events;
+    }
+
+    static int GetProcessId() {
+#ifdef _WIN32
+      return _getpid();
+#else
+      return static_cast<int>(getpid());
+#endif
+    }
+
+    /// 设置了 CARLA_TRACE_FILE 时，启动即开启追踪并在进程退出时写出结果。
+    class TraceFileWriter {
+    public:
+
+      TraceFileWriter() {
+        const char *filename = std::getenv("CARLA_TRACE_FILE");
+        if (filename != nullptr && filename[0] != '\0') {
+          // 先构造 Registry，保证它在本对象之后析构。
+          GetRegistry();
+          _filename = filename;
+          Tracer::Enable();
+        }
+      }
+
+      ~TraceFileWriter() {
+        if (!_filename.empty()) {
+          Tracer::Disable();
+          Tracer::ExportChromeTrace(_filename);
+        }
+      }
+
+    private:
+
+      std::string _filename;
+    };
+
+    static TraceFileWriter TRACE_FILE_WRITER;
+
+  } // namespace
+
+  void Tracer::Enable(const bool enable) {
+    _enabled.store(enable, std::memory_order_relaxed);
+  }
+
+  void Tracer::Clear() {
+    auto &registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto &buffers = registry.buffers;
+    buffers.erase(std::remove_if(buffers.begin(), buffers.end(), [](const auto &buffer) {
+      return !buffer->alive.load();
+    }), buffers.end());
+    for (auto &buffer : buffers) {
+      buffer->cleared.store(buffer->head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+  }
+
+  void Tracer::SetThreadName(const std::string &name) {
+    GetThreadName() = name;
+    auto &buffer = GetThreadBufferHolder().buffer;
+    if (buffer != nullptr) {
+      auto &registry = GetRegistry();
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      buffer->name = name;
+    }
+  }
+
+  uint64_t Tracer::GetEventCount() {
+    const auto &buffer = GetThreadBufferHolder().buffer;
+    if (buffer == nullptr) {
+      return 0u;
+    }
+    return buffer->head.load(std::memory_order_relaxed) - buffer->cleared.load(std::memory_order_relaxed);
+  }
+
+  void Tracer::RecordSpan(const char *category, const char *name, uint64_t begin_ns, uint64_t end_ns) {
+    auto &buffer = GetThreadBuffer();
+    uint64_t index;
+    auto &event = BeginEvent(buffer, index);
+    event.category = category;
+    event.timestamp = begin_ns;
+    event.duration = end_ns > begin_ns ? end_ns - begin_ns : 0u;
+    event.type = EventType::Span;
+    CopyName(event, name);
+    CommitEvent(buffer, index);
+  }
+
+  void Tracer::RecordCounter(const char *category, const char *name, double value) {
+    auto &buffer = GetThreadBuffer();
+    uint64_t index;
+    auto &event = BeginEvent(buffer, index);
+    event.category = category;
+    event.timestamp = Now();
+    event.value = value;
+    event.type = EventType::Counter;
+    CopyName(event, name);
+    CommitEvent(buffer, index);
+  }
+
+  void Tracer::RecordInstant(const char *category, const char *name) {
+    auto &buffer = GetThreadBuffer();
+    uint64_t index;
+    auto &event = BeginEvent(buffer, index);
+    event.category = category;
+    event.timestamp = Now();
+    event.duration = 0u;
+    event.type = EventType::Instant;
+    CopyName(event, name);
+    CommitEvent(buffer, index);
+  }
+
+  void Tracer::ExportChromeTrace(std::ostream &out) {
+    auto &registry = GetRegistry();
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    std::vector<std::string> names;
+    {
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      buffers = registry.buffers;
+      for (auto &buffer : buffers) {
+        names.push_back(buffer->name);
+      }
+    }
+    const int pid = GetProcessId();
+    const auto to_us = [&](uint64_t ns) {
+      return 1e-3 * static_cast<double>(ns > registry.epoch ? ns - registry.epoch : 0u);
+    };
+
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    auto separator = [&]() {
+      if (!first) {
+        out << ",\n";
+      }
+      first = false;
+    };
+    for (size_t i = 0u; i < buffers.size(); ++i) {
+      const auto &buffer = *buffers[i];
+      if (!names[i].empty()) {
+        separator();
+        out << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << pid << ",\"tid\":" << buffer.tid
+            << ",\"args\":{\"name\":";
+        WriteJsonString(out, names[i].c_str());
+        out << "}}";
+      }
+      for (const auto &event : CopyEvents(buffer)) {
+        separator();
+        out << "{\"name\":";
+        WriteJsonString(out, event.name);
+        out << ",\"cat\":";
+        WriteJsonString(out, event.category);
+        out << ",\"pid\":" << pid << ",\"tid\":" << buffer.tid
+            << ",\"ts\":" << to_us(event.timestamp);
+        switch (event.type) {
+          case EventType::Span:
+            out << ",\"ph\":\"X\",\"dur\":" << 1e-3 * static_cast<double>(event.duration);
+            break;
+          case EventType::Counter:
+            out << ",\"ph\":\"C\",\"args\":{\"value\":" << event.value << '}';
+            break;
+          case EventType::Instant:
+            out << ",\"ph\":\"i\",\"s\":\"t\"";
+            break;
+        }
+        out << '}';
+      }
+    }
+    out << "]}\n";
+  }
+
+  bool Tracer::ExportChromeTrace(const std::string &filename) {
+    std::ofstream out(filename, std::ios_base::out | std::ios_base::trunc);
+    if (!out.is_open()) {
+      log_error("tracer: unable to open", filename);
+      return false;
+    }
+    ExportChromeTrace(out);
+    return out.good();
+  }
+
+} // namespace profiler
+} // namespace carla
@@ -0,0 +1,152 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+namespace carla {
+namespace profiler {
+
+  /// 热路径事件追踪。
+  ///
+  /// 与 Profiler.h 中只统计最小/平均/最大耗时的计数器不同，Tracer 记录每一次
+  /// 事件（时间区间、计数器取值），导出为 Chrome trace JSON 后可以在
+  /// chrome://tracing 或 Perfetto UI 中查看，用于定位偶发的长尾延迟。
+  ///
+  /// 每个线程写入自己的定长环形缓冲区，记录一个事件只需几次普通写入和一次
+  /// release 存储，不加锁；缓冲区写满后覆盖最旧的事件。追踪默认关闭，关闭时
+  /// 每个追踪点只剩一次 relaxed 原子读取；定义 LIBCARLA_DISABLE_TRACING 可以
+  /// 在编译期完全去掉追踪点。
+  ///
+  /// 环境变量 CARLA_TRACE_FILE 非空时，进程启动即开启追踪，并在退出时把追踪
+  /// 结果写入该文件。
+  class Tracer {
+  public:
+
+    /// 每个线程缓冲区保留的事件数（每个事件 64 字节，缓冲区在线程第一次记录时分配）。
+    static constexpr size_t EVENTS_PER_THREAD = 1u << 14u;
+
+    /// 事件名称的最大长度（超出部分被截断）。
+    static constexpr size_t MAX_NAME_LENGTH = 38u;
+
+    static bool IsEnabled() {
+      return _enabled.load(std::memory_order_relaxed);
+    }
+
+    static void Enable(bool enable = true);
+
+    static void Disable() {
+      Enable(false);
+    }
+
+    /// 丢弃已记录的事件，并释放已退出线程的缓冲区。
+    static void Clear();
+
+    /// 为当前线程命名，显示在追踪视图中。只保存名称，不分配事件缓冲区。
+    static void SetThreadName(const std::string &name);
+
+    /// 以 Chrome trace 事件格式（JSON）写出所有线程中保留的事件。
+    static void ExportChromeTrace(std::ostream &out);
+
+    /// 写入文件，成功时返回 true。
+    static bool ExportChromeTrace(const std::string &filename);
+
+    /// 当前线程已记录的事件总数（包括已被覆盖的），主要用于测试。
+    static uint64_t GetEventCount();
+
+    /// 追踪使用的时间戳，单位为纳秒。
+    static uint64_t Now() {
+      return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    /// @name 记录事件
+    ///
+    /// @a category 必须是字符串字面量（或生命周期足够长的字符串），只保存指针；
+    /// @a name 会被复制。
+    /// @{
+
+    static void RecordSpan(const char *category, const char *name, uint64_t begin_ns, uint64_t end_ns);
+
+    static void RecordSpan(const char *category, const std::string &name, uint64_t begin_ns, uint64_t end_ns) {
+      RecordSpan(category, name.c_str(), begin_ns, end_ns);
+    }
+
+    static void RecordCounter(const char *category, const char *name, double value);
+
+    static void RecordInstant(const char *category, const char *name);
+
+    /// @}
+
+  private:
+
+    static std::atomic_bool _enabled;
+  };
+
+  /// 在作用域内记录一个时间区间。构造时追踪关闭则什么也不做。
+  class ScopedSpan {
+  public:
+
+    ScopedSpan(const char *category, const char *name)
+      : _category(Tracer::IsEnabled() ? category : nullptr),
+        _name(name),
+        _begin(_category != nullptr ? Tracer::Now() : 0u) {}
+
+    ScopedSpan(const char *category, const std::string &name)
+      : ScopedSpan(category, name.c_str()) {}
+
+    ~ScopedSpan() {
+      if (_category != nullptr) {
+        Tracer::RecordSpan(_category, _name, _begin, Tracer::Now());
+      }
+    }
+
+    ScopedSpan(const ScopedSpan &) = delete;
+    ScopedSpan &operator=(const ScopedSpan &) = delete;
+
+  private:
+
+    const char *_category;
+
+    const char *_name;
+
+    const uint64_t _begin;
+  };
+
+} // namespace profiler
+} // namespace carla
+
+#define CARLA_TRACE_CONCAT_IMPL(a, b) a ## b
+#define CARLA_TRACE_CONCAT(a, b) CARLA_TRACE_CONCAT_IMPL(a, b)
+
+#ifdef LIBCARLA_DISABLE_TRACING
+#  define CARLA_TRACE_SCOPE(category, name)
+#  define CARLA_TRACE_COUNTER(category, name, value) do {} while (false)
+#  define CARLA_TRACE_INSTANT(category, name) do {} while (false)
+#else
+/// 记录从此处到作用域结束的时间区间。@a name 在作用域结束前必须保持有效。
+#  define CARLA_TRACE_SCOPE(category, name) \
+    ::carla::profiler::ScopedSpan CARLA_TRACE_CONCAT(carla_trace_span_, __LINE__)(category, name)
+/// 记录计数器的当前取值。
+#  define CARLA_TRACE_COUNTER(category, name, value) \
+    do { \
+      if (::carla::profiler::Tracer::IsEnabled()) { \
+        ::carla::profiler::Tracer::RecordCounter(category, name, static_cast<double>(value)); \
+      } \
+    } while (false)
+/// 记录一个瞬时事件。
+#  define CARLA_TRACE_INSTANT(category, name) \
+    do { \
+      if (::carla::profiler::Tracer::IsEnabled()) { \
+        ::carla::profiler::Tracer::RecordInstant(category, name); \
+      } \
+    } while (false)
+#endif // LIBCARLA_DISABLE_TRACING
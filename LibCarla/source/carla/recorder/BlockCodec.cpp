@@ -0,0 +1,413 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/recorder/BlockCodec.h"
+
+#include <cstring>
+#include <limits>
+
+namespace carla {
+namespace recorder {
+
+  constexpr uint32_t BlockCodec::BLOCK_MAGIC;
+  constexpr size_t BlockCodec::BLOCK_HEADER_SIZE;
+  constexpr uint16_t BlockCodec::RAW_FILE_VERSION;
+  constexpr uint16_t BlockCodec::COMPRESSED_FILE_VERSION;
+  constexpr size_t BlockCodec::PACKET_HEADER_SIZE;
+  constexpr uint8_t BlockCodec::POSITION_PACKET_ID;
+  constexpr size_t BlockCodec::POSITION_RECORD_SIZE;
+
+  // ===========================================================================
+  // -- 辅助函数 ---------------------------------------------------------------
+  // ===========================================================================
+
+  namespace {
+
+    // 录制文件以本机字节序写出，这里保持一致。
+    template <typename T>
+    static T Load(const char *data) {
+      T value;
+      std::memcpy(&value, data, sizeof(T));
+      return value;
+    }
+
+    template <typename T>
+    static void Append(std::vector<char> &out, const T &value) {
+      const auto *begin = reinterpret_cast<const char *>(&value);
+      out.insert(out.end(), begin, begin + sizeof(T));
+    }
+
+    static void AppendBytes(std::vector<char> &out, const char *data, size_t size) {
+      out.insert(out.end(), data, data + size);
+    }
+
+    static uint32_t ZigZag(uint32_t delta) {
+      return (delta << 1u) ^ static_cast<uint32_t>(-static_cast<int32_t>(delta >> 31u));
+    }
+
+    static uint32_t UnZigZag(uint32_t value) {
+      return (value >> 1u) ^ static_cast<uint32_t>(-static_cast<int32_t>(value & 1u));
+    }
+
+    static void AppendVarint(std::vector<char> &out, uint32_t value) {
+      while (value >= 0x80u) {
+        out.push_back(static_cast<char>((value & 0x7Fu) | 0x80u));
+        value >>= 7u;
+      }
+      out.push_back(static_cast<char>(value));
+    }
+
+    static bool ReadVarint(const char *&it, const char *end, uint32_t &value) {
+      value = 0u;
+      for (uint32_t shift = 0u; shift < 35u; shift += 7u) {
+        if (it == end) {
+          return false;
+        }
+        const auto byte = static_cast<uint8_t>(*it++);
+        value |= static_cast<uint32_t>(byte & 0x7Fu) << shift;
+        if ((byte & 0x80u) == 0u) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    static void AppendLength(std::vector<char> &out, size_t length) {
+      for (; length >= 255u; length -= 255u) {
+        out.push_back(static_cast<char>(255));
+      }
+      out.push_back(static_cast<char>(length));
+    }
+
+    static bool ReadLength(const char *&it, const char *end, size_t &length) {
+      uint8_t byte;
+      do {
+        if (it == end) {
+          return false;
+        }
+        byte = static_cast<uint8_t>(*it++);
+        length += byte;
+      } while (byte == 255u);
+      return true;
+    }
+
+    constexpr size_t POSITION_WORDS = BlockCodec::POSITION_RECORD_SIZE / sizeof(uint32_t);
+
+    static_assert(BlockCodec::POSITION_RECORD_SIZE % sizeof(uint32_t) == 0u, "");
+
+  } // namespace
+
+  // ===========================================================================
+  // -- 位置差分 ---------------------------------------------------------------
+  // ===========================================================================
+
+  bool BlockCodec::EncodePositionDelta(const char *data, const size_t size, std::vector<char> &out) {
+    std::vector<uint32_t> previous;
+    std::vector<uint32_t> current;
+    size_t pos = 0u;
+    while (pos < size) {
+      if (size - pos < PACKET_HEADER_SIZE) {
+        return false;
+      }
+      const auto id = static_cast<uint8_t>(data[pos]);
+      const auto packet_size = Load<uint32_t>(data + pos + 1u);
+      if (packet_size > size - pos - PACKET_HEADER_SIZE) {
+        return false;
+      }
+      AppendBytes(out, data + pos, PACKET_HEADER_SIZE);
+      const char *payload = data + pos + PACKET_HEADER_SIZE;
+      if (id == POSITION_PACKET_ID && packet_size >= sizeof(uint16_t)) {
+        const auto count = Load<uint16_t>(payload);
+        if (packet_size != sizeof(uint16_t) + count * POSITION_RECORD_SIZE) {
+          return false;
+        }
+        Append(out, count);
+        current.resize(count * POSITION_WORDS);
+        for (size_t i = 0u; i < current.size(); ++i) {
+          current[i] = Load<uint32_t>(payload + sizeof(uint16_t) + i * sizeof(uint32_t));
+          const uint32_t predicted = i < previous.size() ? previous[i] : 0u;
+          AppendVarint(out, ZigZag(current[i] - predicted));
+        }
+        std::swap(previous, current);
+      } else {
+        AppendBytes(out, payload, packet_size);
+      }
+      pos += PACKET_HEADER_SIZE + packet_size;
+    }
+    return true;
+  }
+
+  bool BlockCodec::DecodePositionDelta(
+      const char *data,
+      const size_t size,
+      const size_t raw_size,
+      std::vector<char> &out) {
+    const size_t base = out.size();
+    std::vector<uint32_t> previous;
+    std::vector<uint32_t> current;
+    const char *it = data;
+    const char *end = data + size;
+    while (it != end) {
+      if (static_cast<size_t>(end - it) < PACKET_HEADER_SIZE) {
+        return false;
+      }
+      const auto id = static_cast<uint8_t>(*it);
+      const auto packet_size = Load<uint32_t>(it + 1u);
+      const size_t produced = out.size() - base;
+      if (produced + PACKET_HEADER_SIZE > raw_size ||
+          packet_size > raw_size - produced - PACKET_HEADER_SIZE) {
+        return false;
+      }
+      AppendBytes(out, it, PACKET_HEADER_SIZE);
+      it += PACKET_HEADER_SIZE;
+      if (id == POSITION_PACKET_ID && packet_size >= sizeof(uint16_t)) {
+        if (static_cast<size_t>(end - it) < sizeof(uint16_t)) {
+          return false;
+        }
+        const auto count = Load<uint16_t>(it);
+        if (packet_size != sizeof(uint16_t) + count * POSITION_RECORD_SIZE) {
+          return false;
+        }
+        Append(out, count);
+        it += sizeof(uint16_t);
+        current.resize(count * POSITION_WORDS);
+        for (size_t i = 0u; i < current.size(); ++i) {
+          uint32_t value;
+          if (!ReadVarint(it, end, value)) {
+            return false;
+          }
+          const uint32_t predicted = i < previous.size() ? previous[i] : 0u;
+          current[i] = UnZigZag(value) + predicted;
+          Append(out, current[i]);
+        }
+        std::swap(previous, current);
+      } else {
+        if (static_cast<size_t>(end - it) < packet_size) {
+          return false;
+        }
+        AppendBytes(out, it, packet_size);
+        it += packet_size;
+      }
+    }
+    return out.size() - base == raw_size;
+  }
+
+  // ===========================================================================
+  // -- LZ ---------------------------------------------------------------------
+  // ===========================================================================
+
+  namespace {
+
+    constexpr size_t LZ_MIN_MATCH = 4u;
+    constexpr size_t LZ_MAX_OFFSET = std::numeric_limits<uint16_t>::max();
+    constexpr uint32_t LZ_HASH_BITS = 14u;
+
+    static uint32_t HashLZ(uint32_t sequence) {
+      return (sequence * 2654435761u) >> (32u - LZ_HASH_BITS);
+    }
+
+    /// 序列格式：token（高 4 位为字面量长度，低 4 位为匹配长度 - 4，等于 15
+    /// 时后接扩展长度）| 字面量 | uint16 偏移 | 匹配长度扩展。最后一个序列只有字面量。
+    static void AppendSequence(
+        std::vector<char> &out,
+        const char *literals,
+        size_t literal_length,
+        size_t offset,
+        size_t match_length) {
+      const size_t match_code = match_length - LZ_MIN_MATCH;
+      const auto token = static_cast<uint8_t>(
+          ((literal_length < 15u ? literal_length : 15u) << 4u) |
+          (match_code < 15u ? match_code : 15u));
+      out.push_back(static_cast<char>(token));
+      if (literal_length >= 15u) {
+        AppendLength(out, literal_length - 15u);
+      }
+      AppendBytes(out, literals, literal_length);
+      Append(out, static_cast<uint16_t>(offset));
+      if (match_code >= 15u) {
+        AppendLength(out, match_code - 15u);
+      }
+    }
+
+  } // namespace
+
+  void BlockCodec::CompressLZ(const char *data, const size_t size, std::vector<char> &out) {
+    // 0 表示空，其余为位置 + 1。
+    std::vector<uint32_t> table(1u << LZ_HASH_BITS, 0u);
+    size_t anchor = 0u;
+    size_t i = 0u;
+    while (i + LZ_MIN_MATCH <= size) {
+      const auto sequence = Load<uint32_t>(data + i);
+      const auto hash = HashLZ(sequence);
+      const size_t candidate = table[hash];
+      table[hash] = static_cast<uint32_t>(i + 1u);
+      if (candidate == 0u ||
+          i - (candidate - 1u) > LZ_MAX_OFFSET ||
+          Load<uint32_t>(data + candidate - 1u) != sequence) {
+        ++i;
+        continue;
+      }
+      const size_t match = candidate - 1u;
+      size_t length = LZ_MIN_MATCH;
+      while (i + length < size && data[match + length] == data[i + length]) {
+        ++length;
+      }
+      AppendSequence(out, data + anchor, i - anchor, i - match, length);
+      i += length;
+      anchor = i;
+    }
+    // 最后一个序列只有字面量。
+    const size_t literal_length = size - anchor;
+    out.push_back(static_cast<char>((literal_length < 15u ? literal_length : 15u) << 4u));
+    if (literal_length >= 15u) {
+      AppendLength(out, literal_length - 15u);
+    }
+    AppendBytes(out, data + anchor, literal_length);
+  }
+
+  bool BlockCodec::DecompressLZ(
+      const char *data,
+      const size_t size,
+      const size_t max_size,
+      std::vector<char> &out) {
+    const size_t base = out.size();
+    const char *it = data;
+    const char *end = data + size;
+    while (it != end) {
+      const auto token = static_cast<uint8_t>(*it++);
+      size_t literal_length = token >> 4u;
+      if (literal_length == 15u && !ReadLength(it, end, literal_length)) {
+        return false;
+      }
+      if (literal_length > static_cast<size_t>(end - it) ||
+          literal_length > max_size - (out.size() - base)) {
+        return false;
+      }
+      AppendBytes(out, it, literal_length);
+      it += literal_length;
+      if (it == end) {
+        break;
+      }
+      if (static_cast<size_t>(end - it) < sizeof(uint16_t)) {
+        return false;
+      }
+      const size_t offset = Load<uint16_t>(it);
+      it += sizeof(uint16_t);
+      size_t match_length = token & 0x0Fu;
+      if (match_length == 15u && !ReadLength(it, end, match_length)) {
+        return false;
+      }
+      match_length += LZ_MIN_MATCH;
+      if (offset == 0u || offset > out.size() - base ||
+          match_length > max_size - (out.size() - base)) {
+        return false;
+      }
+      // 匹配区间可能与输出重叠，逐字节复制。
+      size_t from = out.size() - offset;
+      for (size_t n = 0u; n < match_length; ++n) {
+        out.push_back(out[from + n]);
+      }
+    }
+    return true;
+  }
+
+  // ===========================================================================
+  // -- 块 ---------------------------------------------------------------------
+  // ===========================================================================
+
+  void BlockCodec::EncodeBlock(
+      const char *data,
+      const size_t size,
+      std::vector<char> &out,
+      const bool delta,
+      const bool lz) {
+    const char *stored = data;
+    size_t stored_size = size;
+    uint8_t flags = None;
+
+    std::vector<char> delta_buffer;
+    if (delta) {
+      delta_buffer.reserve(size);
+      if (EncodePositionDelta(data, size, delta_buffer) && delta_buffer.size() < size) {
+        stored = delta_buffer.data();
+        stored_size = delta_buffer.size();
+        flags |= PositionDelta;
+      }
+    }
+
+    std::vector<char> lz_buffer;
+    if (lz) {
+      lz_buffer.reserve(stored_size);
+      CompressLZ(stored, stored_size, lz_buffer);
+      if (lz_buffer.size() < stored_size) {
+        stored = lz_buffer.data();
+        stored_size = lz_buffer.size();
+        flags |= LZ;
+      }
+    }
+
+    Append(out, BLOCK_MAGIC);
+    Append(out, static_cast<uint32_t>(size));
+    Append(out, static_cast<uint32_t>(stored_size));
+    Append(out, flags);
+    AppendBytes(out, stored, stored_size);
+  }
+
+  bool BlockCodec::ReadBlockHeader(
+      const char *data,
+      const size_t size,
+      size_t &raw_size,
+      size_t &stored_size) {
+    if (size < BLOCK_HEADER_SIZE || Load<uint32_t>(data) != BLOCK_MAGIC) {
+      return false;
+    }
+    raw_size = Load<uint32_t>(data + 4u);
+    stored_size = Load<uint32_t>(data + 8u);
+    return true;
+  }
+
+  size_t BlockCodec::DecodeBlock(const char *data, const size_t size, std::vector<char> &out) {
+    size_t raw_size;
+    size_t stored_size;
+    if (!ReadBlockHeader(data, size, raw_size, stored_size)) {
+      return 0u;
+    }
+    const auto flags = static_cast<uint8_t>(data[12u]);
+    if (stored_size > size - BLOCK_HEADER_SIZE) {
+      return 0u;
+    }
+    const char *stored = data + BLOCK_HEADER_SIZE;
+    const size_t base = out.size();
+
+    std::vector<char> lz_buffer;
+    if (flags & LZ) {
+      // 差分只在变小时使用，因此中间结果不会超过原始大小。
+      lz_buffer.reserve(raw_size);
+      if (!DecompressLZ(stored, stored_size, raw_size, lz_buffer)) {
+        return 0u;
+      }
+    }
+    const char *intermediate = (flags & LZ) ? lz_buffer.data() : stored;
+    const size_t intermediate_size = (flags & LZ) ? lz_buffer.size() : stored_size;
+
+    bool success;
+    if (flags & PositionDelta) {
+      success = DecodePositionDelta(intermediate, intermediate_size, raw_size, out);
+    } else {
+      success = (intermediate_size == raw_size);
+      if (success) {
+        AppendBytes(out, intermediate, intermediate_size);
+      }
+    }
+    if (!success) {
+      out.resize(base);
+      return 0u;
+    }
+    return BLOCK_HEADER_SIZE + stored_size;
+  }
+
+} // namespace recorder
+} // namespace carla
@@ -0,0 +1,82 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace carla {
+namespace recorder {
+
+  /// 录制文件（.log）帧数据的块压缩。
+  ///
+  /// 压缩的录制文件（版本号为 COMPRESSED_FILE_VERSION）在文件头之后由若干块
+  /// 组成，每块包含整数个帧：
+  ///
+  ///     uint32 magic | uint32 原始大小 | uint32 存储大小 | uint8 标志 | 数据
+  ///
+  /// 数据依次经过两级可选的变换：
+  ///
+  ///   - PositionDelta：位置数据包中的每条记录与上一个位置数据包中同一下标的
+  ///     记录做差（参与者 id 与浮点数的位模式均按整数相减），再以 zigzag +
+  ///     varint 编码。静止或缓慢移动的参与者只需一到两个字节。
+  ///   - LZ：简单的 LZ77 字节级压缩（与 LZ4 块格式类似，不依赖外部库）。
+  ///
+  /// 每块独立解码，差分的参考状态在块开始时清空。
+  class BlockCodec {
+  public:
+
+    static constexpr uint32_t BLOCK_MAGIC = 0x4b425243u; // "CRBK"
+
+    static constexpr size_t BLOCK_HEADER_SIZE = 13u;
+
+    /// 未压缩与压缩录制文件的版本号（CarlaRecorderInfo::Version）。
+    static constexpr uint16_t RAW_FILE_VERSION = 1u;
+    static constexpr uint16_t COMPRESSED_FILE_VERSION = 2u;
+
+    /// 录制文件中数据包的布局：uint8 id + uint32 大小 + 数据。
+    static constexpr size_t PACKET_HEADER_SIZE = 5u;
+    static constexpr uint8_t POSITION_PACKET_ID = 6u;
+    /// 位置记录：uint32 参与者 id + 3 个 float 位置 + 3 个 float 旋转。
+    static constexpr size_t POSITION_RECORD_SIZE = 28u;
+
+    enum Flags : uint8_t {
+      None = 0u,
+      PositionDelta = 1u << 0u,
+      LZ = 1u << 1u,
+    };
+
+    /// 压缩 @a size 字节（必须由完整的数据包组成）并把一个完整的块（含块头）
+    /// 追加到 @a out。某一级变换无效（数据包不完整或没有变小）时自动跳过。
+    static void EncodeBlock(const char *data, size_t size, std::vector<char> &out, bool delta = true, bool lz = true);
+
+    /// 读取块头，得到块的原始大小与存储大小（不含块头）；块头不完整或 magic
+    /// 不符时返回 false。
+    static bool ReadBlockHeader(const char *data, size_t size, size_t &raw_size, size_t &stored_size);
+
+    /// 从 @a data 解码一个块，把原始数据追加到 @a out，返回消耗的字节数；
+    /// 数据不完整或损坏时返回 0。
+    static size_t DecodeBlock(const char *data, size_t size, std::vector<char> &out);
+
+    /// @name 各级变换，主要用于测试
+    /// @{
+
+    static bool EncodePositionDelta(const char *data, size_t size, std::vector<char> &out);
+
+    static bool DecodePositionDelta(const char *data, size_t size, size_t raw_size, std::vector<char> &out);
+
+    static void CompressLZ(const char *data, size_t size, std::vector<char> &out);
+
+    /// 解压后的数据超过 @a max_size 时失败。
+    static bool DecompressLZ(const char *data, size_t size, size_t max_size, std::vector<char> &out);
+
+    /// @}
+  };
+
+} // namespace recorder
+} // namespace carla
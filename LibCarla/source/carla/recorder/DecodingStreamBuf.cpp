@@ -0,0 +1,184 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/recorder/DecodingStreamBuf.h"
+
+#include "carla/Logging.h"
+#include "carla/recorder/BlockCodec.h"
+
+#include <algorithm>
+
+namespace carla {
+namespace recorder {
+
+  void DecodingStreamBuf::Open(std::streambuf &source, const size_t header_size, std::string name) {
+    Close();
+    _source = &source;
+    _name = std::move(name);
+    const auto end = source.pubseekoff(0, std::ios_base::end, std::ios_base::in);
+    _file_size = (end == pos_type(off_type(-1))) ? 0u : static_cast<uint64_t>(end);
+    _blocks.push_back(Block{0u, header_size, 0u, header_size});
+    LoadBlock(0u);
+  }
+
+  void DecodingStreamBuf::Close() {
+    setg(nullptr, nullptr, nullptr);
+    _source = nullptr;
+    _file_size = 0u;
+    _blocks.clear();
+    _indexed = false;
+    _current = 0u;
+    _loaded = false;
+    std::vector<char>().swap(_stored);
+    std::vector<char>().swap(_decoded);
+  }
+
+  bool DecodingStreamBuf::ReadAt(const uint64_t offset, char *data, const size_t size) {
+    const auto position = _source->pubseekpos(static_cast<off_type>(offset), std::ios_base::in);
+    if (position != pos_type(static_cast<off_type>(offset))) {
+      return false;
+    }
+    return _source->sgetn(data, static_cast<std::streamsize>(size)) == static_cast<std::streamsize>(size);
+  }
+
+  bool DecodingStreamBuf::IndexNextBlock() {
+    if (_indexed || _blocks.empty()) {
+      return false;
+    }
+    const Block last = _blocks.back();
+    const uint64_t file_offset = last.file_offset + last.file_size;
+    if (file_offset >= _file_size) {
+      _indexed = true;
+      return false;
+    }
+    char header[BlockCodec::BLOCK_HEADER_SIZE];
+    size_t raw_size;
+    size_t stored_size;
+    if (!ReadAt(file_offset, header, sizeof(header)) ||
+        !BlockCodec::ReadBlockHeader(header, sizeof(header), raw_size, stored_size) ||
+        stored_size > _file_size - file_offset - sizeof(header)) {
+      log_warning("recorder file", _name, "is truncated or corrupted at byte", file_offset);
+      _indexed = true;
+      return false;
+    }
+    _blocks.push_back(Block{
+        last.decoded_offset + last.decoded_size,
+        raw_size,
+        file_offset,
+        sizeof(header) + stored_size});
+    return true;
+  }
+
+  bool DecodingStreamBuf::LoadBlock(const size_t index) {
+    if (_loaded && (_current == index)) {
+      setg(eback(), eback(), egptr());
+      return true;
+    }
+    const Block block = _blocks[index];
+    _loaded = false;
+    _current = index;
+    setg(nullptr, nullptr, nullptr);
+    _stored.resize(static_cast<size_t>(block.file_size));
+    bool success = ReadAt(block.file_offset, _stored.data(), _stored.size());
+    _decoded.clear();
+    if (success && (index == 0u)) {
+      _decoded.swap(_stored);
+    } else if (success) {
+      success = (BlockCodec::DecodeBlock(_stored.data(), _stored.size(), _decoded) == _stored.size());
+    }
+    if (!success) {
+      // 之后的数据都读不到了，当作文件在这个块之前结束。
+      log_warning("recorder file", _name, "is truncated or corrupted at byte", block.file_offset);
+      _blocks.resize(index);
+      _indexed = true;
+      return false;
+    }
+    _loaded = true;
+    setg(_decoded.data(), _decoded.data(), _decoded.data() + _decoded.size());
+    return true;
+  }
+
+  uint64_t DecodingStreamBuf::GetIndexedSize() const {
+    return _blocks.empty() ? 0u : (_blocks.back().decoded_offset + _blocks.back().decoded_size);
+  }
+
+  uint64_t DecodingStreamBuf::GetPosition() const {
+    if (!_loaded) {
+      return GetIndexedSize();
+    }
+    return _blocks[_current].decoded_offset + static_cast<uint64_t>(gptr() - eback());
+  }
+
+  DecodingStreamBuf::int_type DecodingStreamBuf::underflow() {
+    if (gptr() < egptr()) {
+      return traits_type::to_int_type(*gptr());
+    }
+    if (!_loaded) {
+      return traits_type::eof();
+    }
+    // 跳过空块。
+    for (size_t next = _current + 1u; ; ++next) {
+      if ((next >= _blocks.size()) && !IndexNextBlock()) {
+        return traits_type::eof();
+      }
+      if (!LoadBlock(next)) {
+        return traits_type::eof();
+      }
+      if (gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+      }
+    }
+  }
+
+  DecodingStreamBuf::pos_type DecodingStreamBuf::Seek(const uint64_t position) {
+    while (position >= GetIndexedSize() && IndexNextBlock()) {}
+    if (_blocks.empty() || position > GetIndexedSize()) {
+      return pos_type(off_type(-1));
+    }
+    // 最后一个起始位置不大于 position 的块；定位到末尾时停在最后一个块的末尾。
+    const auto it = std::upper_bound(_blocks.begin(), _blocks.end(), position,
+        [](uint64_t value, const Block &block) { return value < block.decoded_offset; });
+    const auto index = static_cast<size_t>(it - _blocks.begin()) - 1u;
+    if (!LoadBlock(index)) {
+      // 块损坏，文件被截断到它之前，按新的长度重新定位。
+      return Seek(std::min(position, GetIndexedSize()));
+    }
+    const auto offset = static_cast<size_t>(position - _blocks[index].decoded_offset);
+    setg(eback(), eback() + offset, egptr());
+    return pos_type(static_cast<off_type>(position));
+  }
+
+  DecodingStreamBuf::pos_type DecodingStreamBuf::seekoff(
+      const off_type off,
+      const std::ios_base::seekdir dir,
+      const std::ios_base::openmode which) {
+    if ((_source == nullptr) || !(which & std::ios_base::in)) {
+      return pos_type(off_type(-1));
+    }
+    off_type base = 0;
+    if (dir == std::ios_base::cur) {
+      base = static_cast<off_type>(GetPosition());
+      if (off == 0) {
+        return pos_type(base);
+      }
+    } else if (dir == std::ios_base::end) {
+      while (IndexNextBlock()) {}
+      base = static_cast<off_type>(GetIndexedSize());
+    }
+    if (base + off < 0) {
+      return pos_type(off_type(-1));
+    }
+    return Seek(static_cast<uint64_t>(base + off));
+  }
+
+  DecodingStreamBuf::pos_type DecodingStreamBuf::seekpos(
+      const pos_type pos,
+      const std::ios_base::openmode which) {
+    return seekoff(off_type(pos), std::ios_base::beg, which);
+  }
+
+} // namespace recorder
+} // namespace carla
@@ -0,0 +1,92 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+
+#include <cstdint>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace recorder {
+
+  /// 逐块解码压缩录制文件（版本 2）的输入流缓冲区。
+  ///
+  /// 包装读取压缩文件的 @a source，文件头原样读出，其后的块在读到时才解码，
+  /// 内存中只保留当前块解码前后的数据。位置（tellg/seekg）是解码后数据中的
+  /// 偏移。块的位置与原始大小只需读取块头即可得到，因此向前跳过数据包不会
+  /// 解码中间的块；已经读过块头的块被记录下来，回退时直接定位。
+  class DecodingStreamBuf : public std::streambuf, private NonCopyable {
+  public:
+
+    DecodingStreamBuf() = default;
+
+    /// 开始读取 @a source，文件头占前 @a header_size 字节。@a source 在
+    /// Close 之前必须保持有效；@a name 只用于日志。
+    void Open(std::streambuf &source, size_t header_size, std::string name = "");
+
+    /// 释放缓冲区，不会关闭 @a source。
+    void Close();
+
+  protected:
+
+    int_type underflow() override;
+
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+
+  private:
+
+    /// 文件头或一个压缩块在解码后数据与文件中的位置。
+    struct Block {
+      uint64_t decoded_offset;
+      uint64_t decoded_size;
+      uint64_t file_offset;
+      uint64_t file_size;
+    };
+
+    bool ReadAt(uint64_t offset, char *data, size_t size);
+
+    /// 读取下一个块的块头并记录，没有更多块或块头损坏时返回 false。
+    bool IndexNextBlock();
+
+    /// 解码第 @a index 个块并让读取指针指向其开头，损坏时截断文件。
+    bool LoadBlock(size_t index);
+
+    uint64_t GetIndexedSize() const;
+
+    uint64_t GetPosition() const;
+
+    pos_type Seek(uint64_t position);
+
+    std::streambuf *_source = nullptr;
+
+    std::string _name;
+
+    uint64_t _file_size = 0u;
+
+    /// 已读取块头的块，第一项是文件头。
+    std::vector<Block> _blocks;
+
+    /// 所有块都已记录（或遇到了损坏的块）。
+    bool _indexed = false;
+
+    /// 读取指针所在的块，_loaded 为 false 时数据已读完或损坏。
+    size_t _current = 0u;
+
+    bool _loaded = false;
+
+    std::vector<char> _stored;
+
+    std::vector<char> _decoded;
+  };
+
+} // namespace recorder
+} // namespace carla
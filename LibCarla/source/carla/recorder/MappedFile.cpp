@@ -0,0 +1,115 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/recorder/MappedFile.h"
+
+#include "carla/Exception.h"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif // _WIN32
+
+namespace carla {
+namespace recorder {
+
+#ifdef _WIN32
+
+  MappedFile::MappedFile(const std::string &path) {
+    _file = CreateFileA(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr);
+    if (_file == INVALID_HANDLE_VALUE) {
+      _file = nullptr;
+      throw_exception(std::runtime_error("cannot open recorder file " + path));
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(_file, &size)) {
+      CloseHandle(_file);
+      throw_exception(std::runtime_error("cannot read the size of " + path));
+    }
+    _size = static_cast<size_t>(size.QuadPart);
+    if (_size == 0u) {
+      return;
+    }
+    _mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (_mapping == nullptr) {
+      CloseHandle(_file);
+      throw_exception(std::runtime_error("cannot map recorder file " + path));
+    }
+    _data = static_cast<const char *>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (_data == nullptr) {
+      CloseHandle(_mapping);
+      CloseHandle(_file);
+      throw_exception(std::runtime_error("cannot map recorder file " + path));
+    }
+  }
+
+  MappedFile::~MappedFile() {
+    if (_data != nullptr) {
+      UnmapViewOfFile(_data);
+    }
+    if (_mapping != nullptr) {
+      CloseHandle(_mapping);
+    }
+    if (_file != nullptr) {
+      CloseHandle(_file);
+    }
+  }
+
+#else
+
+  MappedFile::MappedFile(const std::string &path) {
+    _file = ::open(path.c_str(), O_RDONLY);
+    if (_file < 0) {
+      throw_exception(std::runtime_error("cannot open recorder file " + path));
+    }
+    struct stat info;
+    if (::fstat(_file, &info) != 0) {
+      ::close(_file);
+      throw_exception(std::runtime_error("cannot read the size of " + path));
+    }
+    _size = static_cast<size_t>(info.st_size);
+    if (_size == 0u) {
+      return;
+    }
+    void *address = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _file, 0);
+    if (address == MAP_FAILED) {
+      ::close(_file);
+      throw_exception(std::runtime_error("cannot map recorder file " + path));
+    }
+    // 帧数据按顺序解析
+    ::madvise(address, _size, MADV_SEQUENTIAL);
+    _data = static_cast<const char *>(address);
+  }
+
+  MappedFile::~MappedFile() {
+    if (_data != nullptr) {
+      ::munmap(const_cast<char *>(_data), _size);
+    }
+    if (_file >= 0) {
+      ::close(_file);
+    }
+  }
+
+#endif // _WIN32
+
+} // namespace recorder
+} // namespace carla
@@ -0,0 +1,50 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+
+#include <cstddef>
+#include <string>
+
+namespace carla {
+namespace recorder {
+
+  /// 以只读方式映射到内存的文件。
+  class MappedFile : private NonCopyable {
+  public:
+
+    /// @throw std::runtime_error 如果无法打开或映射文件。
+    explicit MappedFile(const std::string &path);
+
+    ~MappedFile();
+
+    const char *data() const {
+      return _data;
+    }
+
+    size_t size() const {
+      return _size;
+    }
+
+  private:
+
+    const char *_data = nullptr;
+
+    size_t _size = 0u;
+
+#ifdef _WIN32
+    void *_file = nullptr;
+
+    void *_mapping = nullptr;
+#else
+    int _file = -1;
+#endif // _WIN32
+  };
+
+} // namespace recorder
+} // namespace carla
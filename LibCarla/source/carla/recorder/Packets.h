@@ -0,0 +1,130 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Exception.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace carla {
+namespace recorder {
+
+  /// 录制文件中的数据包类型，与服务器端 CarlaRecorderPacketId 一致。
+  enum class PacketId : uint8_t {
+    FrameStart = 0,
+    FrameEnd,
+    EventAdd,
+    EventDel,
+    EventParent,
+    Collision,
+    Position,
+    State,
+    AnimVehicle,
+    AnimWalker,
+    VehicleLight,
+    SceneLight,
+    Kinematics,
+    BoundingBox,
+    PlatformTime,
+    PhysicsControl,
+    TrafficLightTime,
+    TriggerVolume,
+    FrameCounter,
+    WalkerBones,
+    VisualTime,
+    VehicleDoor,
+    AnimVehicleWheels,
+    AnimBiker
+  };
+
+  namespace packets {
+
+    /// 数据包头：uint8 id + uint32 大小。
+    constexpr size_t HEADER_SIZE = 5u;
+
+    /// 帧开始：uint64 帧号 + double 本帧时长 + double 已用时间。
+    constexpr size_t FRAME_START_SIZE = 24u;
+
+    /// 位置记录：uint32 参与者 id + 3 个 float 位置 + 3 个 float 旋转。
+    constexpr size_t POSITION_RECORD_SIZE = 28u;
+
+    /// 碰撞记录：uint32 id + 两个 uint32 参与者 id + 两个 bool（是否为英雄），
+    /// 服务器端的结构体按 1 字节对齐，没有填充。
+    constexpr size_t COLLISION_RECORD_SIZE = 14u;
+
+    template <typename T>
+    static inline T Load(const char *data) {
+      T value;
+      std::memcpy(&value, data, sizeof(T));
+      return value;
+    }
+
+    /// 数据包 @a data（含包头，@a available 为可用字节数）的数据大小，
+    /// 数据不完整时返回 false。
+    static inline bool GetPayloadSize(const char *data, size_t available, size_t &payload_size) {
+      if (available < HEADER_SIZE) {
+        return false;
+      }
+      payload_size = Load<uint32_t>(data + 1u);
+      return payload_size <= available - HEADER_SIZE;
+    }
+
+    /// 按顺序读取一段数据，越界时抛出异常。
+    class Reader {
+    public:
+
+      Reader(const char *data, size_t size)
+        : _it(data),
+          _end(data + size) {}
+
+      template <typename T>
+      T Read() {
+        Require(sizeof(T));
+        const auto value = Load<T>(_it);
+        _it += sizeof(T);
+        return value;
+      }
+
+      /// 字符串：uint16 长度 + UTF-8 文本。
+      std::string ReadString() {
+        const auto length = Read<uint16_t>();
+        Require(length);
+        std::string result(_it, length);
+        _it += length;
+        return result;
+      }
+
+      void Skip(size_t size) {
+        Require(size);
+        _it += size;
+      }
+
+      const char *Position() const {
+        return _it;
+      }
+
+    private:
+
+      void Require(size_t size) const {
+        if (static_cast<size_t>(_end - _it) < size) {
+          throw_exception(std::runtime_error("recorder data is truncated or corrupted"));
+        }
+      }
+
+      const char *_it;
+
+      const char *_end;
+    };
+
+  } // namespace packets
+
+} // namespace recorder
+} // namespace carla
@@ -0,0 +1,115 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/recorder/RecorderFile.h"
+
+#include "carla/Exception.h"
+#include "carla/Logging.h"
+#include "carla/recorder/BlockCodec.h"
+#include "carla/recorder/Packets.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace carla {
+namespace recorder {
+
+  static const char RECORDER_MAGIC[] = "CARLA_RECORDER";
+
+  RecorderFile::RecorderFile(const std::string &path)
+    : _path(path),
+      _mapped(std::make_unique<MappedFile>(path)),
+      _data(_mapped->data()),
+      _size(_mapped->size()) {
+    ReadInfo();
+    if (_info.version == BlockCodec::COMPRESSED_FILE_VERSION) {
+      Decompress();
+    }
+    IndexFrames();
+  }
+
+  std::pair<size_t, size_t> RecorderFile::FindFrames(const double begin, const double end) const {
+    const auto first = std::lower_bound(_frames.begin(), _frames.end(), begin,
+        [](const FrameIndex &frame, double time) { return frame.elapsed < time; });
+    const auto last = std::upper_bound(first, _frames.end(), end,
+        [](double time, const FrameIndex &frame) { return time < frame.elapsed; });
+    return std::make_pair(
+        static_cast<size_t>(first - _frames.begin()),
+        static_cast<size_t>(last - _frames.begin()));
+  }
+
+  void RecorderFile::ReadInfo() {
+    packets::Reader reader(_data, _size);
+    _info.version = reader.Read<uint16_t>();
+    _info.magic = reader.ReadString();
+    if (_info.magic != RECORDER_MAGIC) {
+      throw_exception(std::runtime_error(_path + " is not a CARLA recorder file"));
+    }
+    _info.date = reader.Read<int64_t>();
+    _info.map = reader.ReadString();
+    _header_size = static_cast<size_t>(reader.Position() - _data);
+    if ((_info.version != BlockCodec::RAW_FILE_VERSION) &&
+        (_info.version != BlockCodec::COMPRESSED_FILE_VERSION)) {
+      throw_exception(std::runtime_error(
+          _path + ": unsupported recorder file version " + std::to_string(_info.version)));
+    }
+  }
+
+  void RecorderFile::Decompress() {
+    _decoded.assign(_data, _data + _header_size);
+    size_t offset = _header_size;
+    while (offset < _size) {
+      const auto consumed = BlockCodec::DecodeBlock(_data + offset, _size - offset, _decoded);
+      if (consumed == 0u) {
+        log_warning("recorder file", _path, "is truncated or corrupted at byte", offset);
+        break;
+      }
+      offset += consumed;
+    }
+    // 不再需要映射原文件
+    _mapped.reset();
+    _data = _decoded.data();
+    _size = _decoded.size();
+  }
+
+  void RecorderFile::IndexFrames() {
+    FrameIndex frame;
+    bool in_frame = false;
+    size_t pos = _header_size;
+    while (pos < _size) {
+      size_t payload_size;
+      if (!packets::GetPayloadSize(_data + pos, _size - pos, payload_size)) {
+        log_warning("recorder file", _path, "is truncated at byte", pos);
+        break;
+      }
+      const auto id = static_cast<PacketId>(_data[pos]);
+      const size_t payload = pos + packets::HEADER_SIZE;
+      if (id == PacketId::FrameStart) {
+        if (payload_size < packets::FRAME_START_SIZE) {
+          throw_exception(std::runtime_error(
+              _path + ": malformed frame packet at byte " + std::to_string(pos)));
+        }
+        packets::Reader reader(_data + payload, payload_size);
+        frame.id = reader.Read<uint64_t>();
+        frame.duration = std::max(reader.Read<double>(), 0.0);
+        frame.elapsed = reader.Read<double>();
+        frame.begin = payload + payload_size;
+        in_frame = true;
+      } else if ((id == PacketId::FrameEnd) && in_frame) {
+        frame.end = pos;
+        _frames.emplace_back(frame);
+        in_frame = false;
+      }
+      pos = payload + payload_size;
+    }
+    // 录制被中断时最后一帧可能不完整，忽略它
+    if (in_frame) {
+      log_warning("recorder file", _path, "ends with an incomplete frame");
+    }
+  }
+
+} // namespace recorder
+} // namespace carla
@@ -0,0 +1,104 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/recorder/MappedFile.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace carla {
+namespace recorder {
+
+  /// 录制文件头（服务器端的 CarlaRecorderInfo）。
+  struct RecorderInfo {
+    uint16_t version = 0u;
+    std::string magic;
+    /// 录制开始的时间（time_t）。
+    int64_t date = 0;
+    std::string map;
+  };
+
+  /// 录制文件中一帧的位置与时间。
+  struct FrameIndex {
+    uint64_t id = 0u;
+    /// 本帧的时长（秒），最后一帧为 0。
+    double duration = 0.0;
+    /// 从录制开始经过的时间（秒）。
+    double elapsed = 0.0;
+    /// 帧开始数据包之后第一个数据包的偏移。
+    size_t begin = 0u;
+    /// 帧结束数据包的偏移。
+    size_t end = 0u;
+  };
+
+  /// 不依赖模拟器读取录制文件（.log）。
+  ///
+  /// 未压缩的文件直接映射到内存；压缩的文件（版本 2）整体解码到内存中。
+  /// 打开时只扫描数据包头，建立帧索引，各帧的内容由 Recording 按需解析。
+  class RecorderFile : private NonCopyable {
+  public:
+
+    /// @throw std::runtime_error 如果无法读取文件或文件不是 CARLA 录制文件。
+    explicit RecorderFile(const std::string &path);
+
+    const std::string &GetPath() const {
+      return _path;
+    }
+
+    const RecorderInfo &GetInfo() const {
+      return _info;
+    }
+
+    const std::vector<FrameIndex> &GetFrames() const {
+      return _frames;
+    }
+
+    /// 已用时间在 [@a begin, @a end] 内的帧的下标范围 [first, last)。
+    std::pair<size_t, size_t> FindFrames(double begin, double end) const;
+
+    /// 录制数据（压缩文件为解码后的数据），帧索引中的偏移相对于此。
+    const char *data() const {
+      return _data;
+    }
+
+    size_t size() const {
+      return _size;
+    }
+
+  private:
+
+    void ReadInfo();
+
+    void Decompress();
+
+    void IndexFrames();
+
+    std::string _path;
+
+    std::unique_ptr<MappedFile> _mapped;
+
+    std::vector<char> _decoded;
+
+    const char *_data = nullptr;
+
+    size_t _size = 0u;
+
+    /// 文件头的大小，帧数据从这里开始。
+    size_t _header_size = 0u;
+
+    RecorderInfo _info;
+
+    std::vector<FrameIndex> _frames;
+  };
+
+} // namespace recorder
+} // namespace carla
@@ -0,0 +1,399 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/recorder/Recording.h"
+
+#include "carla/ThreadGroup.h"
+#include "carla/recorder/Packets.h"
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <thread>
+#include <unordered_set>
+
+namespace carla {
+namespace recorder {
+
+  // 每块至少包含的帧数，帧数较少时不值得启动线程
+  static constexpr size_t MIN_FRAMES_PER_CHUNK = 64u;
+
+  static size_t GetNumberOfThreads(size_t threads) {
+    if (threads == 0u) {
+      threads = std::thread::hardware_concurrency();
+    }
+    return std::max<size_t>(threads, 1u);
+  }
+
+  /// 把 [0, count) 分成 @a chunks 段，在各自的线程中调用 @a functor(index, first, last)。
+  template <typename F>
+  static void ParallelFor(size_t count, size_t chunks, F &&functor) {
+    chunks = std::max<size_t>(std::min(chunks, count), 1u);
+    if (chunks == 1u) {
+      functor(0u, 0u, count);
+      return;
+    }
+    ThreadGroup threads;
+    for (size_t i = 0u; i < chunks; ++i) {
+      const size_t first = count * i / chunks;
+      const size_t last = count * (i + 1u) / chunks;
+      threads.CreateThread([&functor, i, first, last]() { functor(i, first, last); });
+    }
+    threads.JoinAll();
+  }
+
+  // ===========================================================================
+  // -- RecordedActor 与 Trajectory --------------------------------------------
+  // ===========================================================================
+
+  char RecordedActor::GetCategory() const {
+    static const char CATEGORIES[] = {'o', 'v', 'w', 't', 'h'};
+    return type < sizeof(CATEGORIES) ? CATEGORIES[type] : 'o';
+  }
+
+  template <typename T>
+  static void AppendColumn(std::vector<T> &column, const std::vector<T> &other) {
+    column.insert(column.end(), other.begin(), other.end());
+  }
+
+  void Trajectory::Append(const Trajectory &other) {
+    AppendColumn(frame, other.frame);
+    AppendColumn(time, other.time);
+    AppendColumn(x, other.x);
+    AppendColumn(y, other.y);
+    AppendColumn(z, other.z);
+    AppendColumn(roll, other.roll);
+    AppendColumn(pitch, other.pitch);
+    AppendColumn(yaw, other.yaw);
+  }
+
+  // ===========================================================================
+  // -- 解码 -------------------------------------------------------------------
+  // ===========================================================================
+
+  /// 一块帧的解码结果。参与者事件按出现的顺序保存，合并时依次应用。
+  struct Recording::Chunk {
+    struct ActorEvent {
+      PacketId type;
+      uint32_t id;
+      uint32_t parent;
+      double time;
+      size_t added;
+    };
+
+    std::vector<ActorEvent> events;
+
+    std::vector<RecordedActor> added;
+
+    std::vector<RecordedCollision> collisions;
+
+    std::unordered_map<uint32_t, Trajectory> trajectories;
+
+    std::exception_ptr error;
+  };
+
+  Recording::Recording(const RecorderFile &file)
+    : Recording(file, Options()) {}
+
+  Recording::Recording(const RecorderFile &file, const Options &options)
+    : _threads(GetNumberOfThreads(options.threads)),
+      _info(file.GetInfo()),
+      _frames(file.GetFrames()),
+      _frame_range(file.FindFrames(options.begin, options.end)) {
+    Decode(file);
+  }
+
+  void Recording::Decode(const RecorderFile &file) {
+    // 时间窗口之前的帧也要解码，以获得参与者事件
+    const size_t count = _frame_range.second;
+    const size_t chunks = std::min(_threads, std::max<size_t>(count / MIN_FRAMES_PER_CHUNK, 1u));
+    std::vector<Chunk> results(chunks);
+    ParallelFor(count, chunks, [&](size_t index, size_t first, size_t last) {
+      try {
+        DecodeChunk(file, first, last, results[index]);
+      } catch (...) {
+        results[index].error = std::current_exception();
+      }
+    });
+
+    // 按帧的顺序合并
+    for (auto &chunk : results) {
+      if (chunk.error) {
+        std::rethrow_exception(chunk.error);
+      }
+      for (const auto &event : chunk.events) {
+        switch (event.type) {
+          case PacketId::EventAdd:
+            _actors[event.id] = std::move(chunk.added[event.added]);
+            break;
+          case PacketId::EventDel: {
+            auto it = _actors.find(event.id);
+            if (it != _actors.end()) {
+              it->second.destroy_time = event.time;
+            }
+            break;
+          }
+          case PacketId::EventParent: {
+            auto it = _actors.find(event.id);
+            if (it != _actors.end()) {
+              it->second.parent = event.parent;
+            }
+            break;
+          }
+          default:
+            break;
+        }
+      }
+      _collisions.insert(_collisions.end(), chunk.collisions.begin(), chunk.collisions.end());
+      for (auto &item : chunk.trajectories) {
+        auto &trajectory = _trajectories[item.first];
+        if (trajectory.empty()) {
+          trajectory = std::move(item.second);
+        } else {
+          trajectory.Append(item.second);
+        }
+      }
+    }
+  }
+
+  void Recording::DecodeChunk(
+      const RecorderFile &file,
+      const size_t first,
+      const size_t last,
+      Chunk &chunk) const {
+    const char *data = file.data();
+    for (size_t index = first; index < last; ++index) {
+      const FrameIndex &frame = _frames[index];
+      const bool in_window = index >= _frame_range.first;
+      size_t pos = frame.begin;
+      while (pos < frame.end) {
+        size_t payload_size;
+        if (!packets::GetPayloadSize(data + pos, frame.end - pos, payload_size)) {
+          throw_exception(std::runtime_error(
+              file.GetPath() + ": malformed packet at byte " + std::to_string(pos)));
+        }
+        const auto id = static_cast<PacketId>(data[pos]);
+        packets::Reader reader(data + pos + packets::HEADER_SIZE, payload_size);
+        pos += packets::HEADER_SIZE + payload_size;
+
+        switch (id) {
+          case PacketId::EventAdd: {
+            const auto total = reader.Read<uint16_t>();
+            for (uint16_t i = 0u; i < total; ++i) {
+              RecordedActor actor;
+              actor.id = reader.Read<uint32_t>();
+              actor.type = reader.Read<uint8_t>();
+              for (auto &value : actor.location) {
+                value = reader.Read<float>();
+              }
+              for (auto &value : actor.rotation) {
+                value = reader.Read<float>();
+              }
+              reader.Skip(sizeof(uint32_t)); // uid
+              actor.description = reader.ReadString();
+              const auto attributes = reader.Read<uint16_t>();
+              actor.attributes.reserve(attributes);
+              for (uint16_t j = 0u; j < attributes; ++j) {
+                reader.Skip(sizeof(uint8_t)); // type
+                auto key = reader.ReadString();
+                auto value = reader.ReadString();
+                actor.attributes.emplace_back(std::move(key), std::move(value));
+              }
+              actor.spawn_time = frame.elapsed;
+              chunk.events.push_back({id, actor.id, 0u, frame.elapsed, chunk.added.size()});
+              chunk.added.emplace_back(std::move(actor));
+            }
+            break;
+          }
+          case PacketId::EventDel: {
+            const auto total = reader.Read<uint16_t>();
+            for (uint16_t i = 0u; i < total; ++i) {
+              chunk.events.push_back({id, reader.Read<uint32_t>(), 0u, frame.elapsed, 0u});
+            }
+            break;
+          }
+          case PacketId::EventParent: {
+            const auto total = reader.Read<uint16_t>();
+            for (uint16_t i = 0u; i < total; ++i) {
+              const auto actor = reader.Read<uint32_t>();
+              const auto parent = reader.Read<uint32_t>();
+              chunk.events.push_back({id, actor, parent, frame.elapsed, 0u});
+            }
+            break;
+          }
+          case PacketId::Collision: {
+            if (!in_window) {
+              break;
+            }
+            const auto total = reader.Read<uint16_t>();
+            for (uint16_t i = 0u; i < total; ++i) {
+              RecordedCollision collision;
+              collision.frame = static_cast<uint32_t>(index);
+              reader.Skip(sizeof(uint32_t)); // id
+              collision.actor1 = reader.Read<uint32_t>();
+              collision.actor2 = reader.Read<uint32_t>();
+              collision.is_actor1_hero = reader.Read<uint8_t>() != 0u;
+              collision.is_actor2_hero = reader.Read<uint8_t>() != 0u;
+              chunk.collisions.emplace_back(collision);
+            }
+            break;
+          }
+          case PacketId::Position: {
+            if (!in_window) {
+              break;
+            }
+            const auto total = reader.Read<uint16_t>();
+            for (uint16_t i = 0u; i < total; ++i) {
+              auto &trajectory = chunk.trajectories[reader.Read<uint32_t>()];
+              trajectory.frame.emplace_back(static_cast<uint32_t>(index));
+              trajectory.time.emplace_back(frame.elapsed);
+              trajectory.x.emplace_back(reader.Read<float>());
+              trajectory.y.emplace_back(reader.Read<float>());
+              trajectory.z.emplace_back(reader.Read<float>());
+              trajectory.roll.emplace_back(reader.Read<float>());
+              trajectory.pitch.emplace_back(reader.Read<float>());
+              trajectory.yaw.emplace_back(reader.Read<float>());
+            }
+            break;
+          }
+          default:
+            break;
+        }
+      }
+    }
+  }
+
+  // ===========================================================================
+  // -- 查询 -------------------------------------------------------------------
+  // ===========================================================================
+
+  const Trajectory &Recording::GetTrajectory(const uint32_t actor_id) const {
+    static const Trajectory EMPTY;
+    auto it = _trajectories.find(actor_id);
+    return it != _trajectories.end() ? it->second : EMPTY;
+  }
+
+  std::vector<CollisionEvent> Recording::QueryCollisions(
+      const char category1,
+      const char category2) const {
+    static const RecordedActor UNKNOWN;
+    auto get_actor = [this](uint32_t id) -> const RecordedActor & {
+      auto it = _actors.find(id);
+      return it != _actors.end() ? it->second : UNKNOWN;
+    };
+    auto matches = [](char category, char type, bool is_hero) {
+      return (category == 'a') || (category == type) || ((category == 'h') && is_hero);
+    };
+    struct PairHash {
+      size_t operator()(const std::pair<uint32_t, uint32_t> &pair) const {
+        return (static_cast<size_t>(pair.first) << 32u) + pair.second;
+      }
+    };
+    using PairSet = std::unordered_set<std::pair<uint32_t, uint32_t>, PairHash>;
+
+    std::vector<CollisionEvent> result;
+    // 上一帧的碰撞，用来区分新的碰撞与持续的碰撞
+    PairSet previous;
+    PairSet current;
+    uint32_t current_frame = std::numeric_limits<uint32_t>::max();
+    for (const auto &collision : _collisions) {
+      if (collision.frame != current_frame) {
+        if (collision.frame == current_frame + 1u) {
+          previous = std::move(current);
+        } else {
+          previous.clear();
+        }
+        current.clear();
+        current_frame = collision.frame;
+      }
+      // 非参与者的物体 id 为 -1
+      const auto &actor1 = get_actor(collision.actor1);
+      const auto &actor2 = get_actor(collision.actor2);
+      const char type1 = actor1.GetCategory();
+      const char type2 = actor2.GetCategory();
+      if (!matches(category1, type1, collision.is_actor1_hero) ||
+          !matches(category2, type2, collision.is_actor2_hero)) {
+        continue;
+      }
+      const auto pair = std::make_pair(collision.actor1, collision.actor2);
+      if (previous.count(pair) == 0u) {
+        CollisionEvent event;
+        event.time = _frames[collision.frame].elapsed;
+        event.frame_id = _frames[collision.frame].id;
+        event.actor1 = collision.actor1;
+        event.actor2 = collision.actor2;
+        event.category1 = type1;
+        event.category2 = type2;
+        event.description1 = actor1.description;
+        event.description2 = actor2.description;
+        result.emplace_back(std::move(event));
+      }
+      current.insert(pair);
+    }
+    return result;
+  }
+
+  std::vector<BlockedActor> Recording::QueryBlocked(
+      const double min_time,
+      const double min_distance) const {
+    std::vector<std::pair<uint32_t, const Trajectory *>> trajectories;
+    trajectories.reserve(_trajectories.size());
+    for (const auto &item : _trajectories) {
+      trajectories.emplace_back(item.first, &item.second);
+    }
+
+    const size_t chunks = std::min(_threads, trajectories.size());
+    std::vector<std::vector<BlockedActor>> results(std::max<size_t>(chunks, 1u));
+    ParallelFor(trajectories.size(), chunks, [&](size_t index, size_t first, size_t last) {
+      auto &found = results[index];
+      for (size_t i = first; i < last; ++i) {
+        const uint32_t id = trajectories[i].first;
+        const Trajectory &trajectory = *trajectories[i].second;
+        auto add_result = [&](double time, double duration) {
+          if (duration >= min_time) {
+            auto it = _actors.find(id);
+            found.push_back({id, it != _actors.end() ? it->second.description : "", time, duration});
+          }
+        };
+        // 与最后一次移动后的位置比较
+        float last_x = trajectory.x[0u];
+        float last_y = trajectory.y[0u];
+        float last_z = trajectory.z[0u];
+        double start = 0.0;
+        double duration = 0.0;
+        for (size_t k = 1u; k < trajectory.size(); ++k) {
+          const double dx = trajectory.x[k] - last_x;
+          const double dy = trajectory.y[k] - last_y;
+          const double dz = trajectory.z[k] - last_z;
+          if (std::sqrt(dx * dx + dy * dy + dz * dz) < min_distance) {
+            if (duration == 0.0) {
+              start = trajectory.time[k];
+            }
+            duration += _frames[trajectory.frame[k]].duration;
+          } else {
+            add_result(start, duration);
+            duration = 0.0;
+            last_x = trajectory.x[k];
+            last_y = trajectory.y[k];
+            last_z = trajectory.z[k];
+          }
+        }
+        add_result(start, duration);
+      }
+    });
+
+    std::vector<BlockedActor> result;
+    for (auto &found : results) {
+      result.insert(result.end(), found.begin(), found.end());
+    }
+    std::sort(result.begin(), result.end(), [](const BlockedActor &a, const BlockedActor &b) {
+      return (a.duration != b.duration) ? (a.duration > b.duration) : (a.id < b.id);
+    });
+    return result;
+  }
+
+} // namespace recorder
+} // namespace carla
@@ -0,0 +1,177 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/recorder/RecorderFile.h"
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace carla {
+namespace recorder {
+
+  /// 录制中的参与者（来自创建、销毁与父子关系事件）。
+  struct RecordedActor {
+    uint32_t id = 0u;
+    /// 0 其他、1 车辆、2 行人、3 交通信号灯、4 英雄。
+    uint8_t type = 0u;
+    /// 蓝图 id，例如 "vehicle.tesla.model3"。
+    std::string description;
+    std::vector<std::pair<std::string, std::string>> attributes;
+    /// 创建时的位置与旋转（厘米、度，与录制文件一致）。
+    float location[3] = {0.0f, 0.0f, 0.0f};
+    float rotation[3] = {0.0f, 0.0f, 0.0f};
+    /// 创建与销毁的时间（秒），未销毁时为无穷大。
+    double spawn_time = 0.0;
+    double destroy_time = std::numeric_limits<double>::infinity();
+    uint32_t parent = 0u;
+
+    /// 查询中使用的类别字符：o、v、w、t、h。
+    char GetCategory() const;
+  };
+
+  /// 一个参与者的轨迹，按列存储，每个位置数据包中的记录对应一行。
+  ///
+  /// 位置为厘米，旋转为度（roll、pitch、yaw），与录制文件一致。
+  struct Trajectory {
+    /// Recording::GetFrames() 中的下标。
+    std::vector<uint32_t> frame;
+    std::vector<double> time;
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    std::vector<float> roll;
+    std::vector<float> pitch;
+    std::vector<float> yaw;
+
+    size_t size() const {
+      return frame.size();
+    }
+
+    bool empty() const {
+      return frame.empty();
+    }
+
+    void Append(const Trajectory &other);
+  };
+
+  /// 录制文件中的一条碰撞记录。
+  struct RecordedCollision {
+    uint32_t frame = 0u;
+    uint32_t actor1 = 0u;
+    uint32_t actor2 = 0u;
+    bool is_actor1_hero = false;
+    bool is_actor2_hero = false;
+  };
+
+  /// QueryCollisions 的结果：一次碰撞的开始。
+  struct CollisionEvent {
+    double time = 0.0;
+    uint64_t frame_id = 0u;
+    uint32_t actor1 = 0u;
+    uint32_t actor2 = 0u;
+    char category1 = 'o';
+    char category2 = 'o';
+    std::string description1;
+    std::string description2;
+  };
+
+  /// QueryBlocked 的结果：参与者保持不动的一段时间。
+  struct BlockedActor {
+    uint32_t id = 0u;
+    std::string description;
+    double time = 0.0;
+    double duration = 0.0;
+  };
+
+  /// 录制文件解码后的数据。
+  ///
+  /// 文件按帧分成若干块并行解码，结果按帧的顺序合并为按参与者组织的列式表，
+  /// 之后的查询不再访问文件。
+  class Recording {
+  public:
+
+    struct Options {
+      /// 只解码已用时间在 [begin, end] 内的帧（秒）；在此之前的参与者事件
+      /// 仍会读取，以便知道各参与者的类型。
+      double begin = 0.0;
+      double end = std::numeric_limits<double>::infinity();
+      /// 解码与查询使用的线程数，0 表示使用所有硬件线程。
+      size_t threads = 0u;
+    };
+
+    /// @throw std::runtime_error 如果文件中的数据损坏。
+    explicit Recording(const RecorderFile &file);
+
+    Recording(const RecorderFile &file, const Options &options);
+
+    const RecorderInfo &GetInfo() const {
+      return _info;
+    }
+
+    /// 解码的帧（时间窗口内的帧）在文件中的下标范围 [first, last)。
+    std::pair<size_t, size_t> GetFrameRange() const {
+      return _frame_range;
+    }
+
+    /// 文件中的所有帧，轨迹与碰撞中的帧下标指向这里。
+    const std::vector<FrameIndex> &GetFrames() const {
+      return _frames;
+    }
+
+    const std::unordered_map<uint32_t, RecordedActor> &GetActors() const {
+      return _actors;
+    }
+
+    const std::vector<RecordedCollision> &GetCollisions() const {
+      return _collisions;
+    }
+
+    const std::unordered_map<uint32_t, Trajectory> &GetTrajectories() const {
+      return _trajectories;
+    }
+
+    /// 参与者的轨迹，没有记录时返回空轨迹。
+    const Trajectory &GetTrajectory(uint32_t actor_id) const;
+
+    /// 类别 @a category1 与 @a category2 之间的碰撞（'a' 表示任意，'h' 表示英雄），
+    /// 只返回每次碰撞的开始，与服务器端的 show_recorder_collisions 一致。
+    std::vector<CollisionEvent> QueryCollisions(char category1 = 'a', char category2 = 'a') const;
+
+    /// 移动距离小于 @a min_distance（厘米）超过 @a min_time 秒的参与者，
+    /// 按持续时间从长到短排序，与服务器端的 show_recorder_actors_blocked 一致。
+    std::vector<BlockedActor> QueryBlocked(double min_time = 30.0, double min_distance = 10.0) const;
+
+  private:
+
+    struct Chunk;
+
+    void Decode(const RecorderFile &file);
+
+    void DecodeChunk(const RecorderFile &file, size_t first, size_t last, Chunk &chunk) const;
+
+    size_t _threads = 1u;
+
+    RecorderInfo _info;
+
+    std::vector<FrameIndex> _frames;
+
+    std::pair<size_t, size_t> _frame_range;
+
+    std::unordered_map<uint32_t, RecordedActor> _actors;
+
+    std::vector<RecordedCollision> _collisions;
+
+    std::unordered_map<uint32_t, Trajectory> _trajectories;
+  };
+
+} // namespace recorder
+} // namespace carla
@@ -29,6 +29,12 @@
 #include <thread> // 导入线程相关库
 #include <iomanip> // 导入格式化输入输出库
 #include <cmath> // 导入数学库
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <type_traits>
 
 namespace carla {
 namespace road {
@@ -838,13 +844,13 @@ const Lane &Map::GetLane(Waypoint waypoint) const {
 // -- Map: Private functions -------------------------------------------------
 // ===========================================================================
 
-// 使用线段两端的Waypoints位置将新元素添加到R树元素列表中
-void Map::AddElementToRtree(
-    std::vector<Rtree::TreeElement> &rtree_elements, // R树元素列表
-    geom::Transform &current_transform,               // 当前变换
-    geom::Transform &next_transform,                  // 下一个变换
-    Waypoint &current_waypoint,                       // 当前Waypoint
-    Waypoint &next_waypoint) {                        // 下一个Waypoint
+  // 使用线段两端的Waypoints位置将新元素添加到R树元素列表中
+  void Map::AddElementToRtree(
+      std::vector<Rtree::TreeElement> &rtree_elements, // R树元素列表
+      geom::Transform &current_transform,               // 当前变换
+      geom::Transform &next_transform,                  // 下一个变换
+      Waypoint &current_waypoint,                       // 当前Waypoint
+      Waypoint &next_waypoint) const {                  // 下一个Waypoint
     // 初始化点
     Rtree::BPoint init =
         Rtree::BPoint(
@@ -860,14 +866,14 @@ void Map::AddElementToRtree(
     // 将线段和相应的Waypoints加入R树元素列表
     rtree_elements.emplace_back(std::make_pair(Rtree::BSegment(init, end),
         std::make_pair(current_waypoint, next_waypoint)));
-}
+  }
 
-// 使用Waypoints的位置将新元素添加到R树元素列表中，并更新变换
-void Map::AddElementToRtreeAndUpdateTransforms(
-    std::vector<Rtree::TreeElement> &rtree_elements, // R树元素列表
-    geom::Transform &current_transform,               // 当前变换
-    Waypoint &current_waypoint,                       // 当前Waypoint
-    Waypoint &next_waypoint) {                        // 下一个Waypoint
+  // 使用Waypoints的位置将新元素添加到R树元素列表中，并更新变换
+  void Map::AddElementToRtreeAndUpdateTransforms(
+      std::vector<Rtree::TreeElement> &rtree_elements, // R树元素列表
+      geom::Transform &current_transform,               // 当前变换
+      Waypoint &current_waypoint,                       // 当前Waypoint
+      Waypoint &next_waypoint) const {                  // 下一个Waypoint
     // 计算下一个Waypoint的变换
     geom::Transform next_transform = ComputeTransform(next_waypoint);
     // 添加元素到R树
@@ -876,21 +882,23 @@ void Map::AddElementToRtreeAndUpdateTransforms(
     // 更新当前Waypoint和变换
     current_waypoint = next_waypoint;
     current_transform = next_transform;
-}
+  }
 
-// 根据车道方向返回几何图形的剩余长度
-double GetRemainingLength(const Lane &lane, double current_s) {
+  // 根据车道方向返回几何图形的剩余长度
+  static double GetRemainingLength(const Lane &lane, double current_s) {
     if (lane.GetId() < 0) {
-        // 如果车道ID小于0，计算剩余长度
-        return (lane.GetDistance() + lane.GetLength() - current_s);
+      // 如果车道ID小于0，计算剩余长度
+      return (lane.GetDistance() + lane.GetLength() - current_s);
     } else {
-        // 如果车道ID大于等于0，返回从当前s到车道起始位置的长度
-        return (current_s - lane.GetDistance());
+      // 如果车道ID大于等于0，返回从当前s到车道起始位置的长度
+      return (current_s - lane.GetDistance());
     }
-}
+  }
 
-// 创建R树
-void Map::CreateRtree() {
+  // 生成一条车道的所有线段，只读取地图数据，可在多个线程中同时调用
+  void Map::AddLaneToRtree(
+      std::vector<Rtree::TreeElement> &rtree_elements, // R树元素列表
+      Waypoint lane_start) const {                      // 车道起始路点
     const double epsilon = 0.000001; // 设置一个小的增量以防止数值误差
     const double min_delta_s = 1;    // 每个段的最小长度为1米
 
@@ -899,27 +907,7 @@ void Map::CreateRtree() {
     // 线段的最大长度
     constexpr double max_segment_length = 100.0;
 
-    // 在每条车道的起始位置生成Waypoints
-    std::vector<Waypoint> topology; // 存储所有Waypoints
-    for (const auto &pair : _data.GetRoads()) { // 遍历所有道路
-        const auto &road = pair.second; // 获取道路信息
-        // 对每条车道进行操作
-        ForEachLane(road, Lane::LaneType::Any, [&](auto &&waypoint) {
-            if(waypoint.lane_id != 0) { // 排除ID为0的车道
-                topology.push_back(waypoint); // 将Waypoint加入到topology中
-            }
-        });
-    }
-}
-
-// 段和路点的容器
-std::vector<Rtree::TreeElement> rtree_elements;
-
-// 遍历所有车道
-for (auto &waypoint : topology) {
-    auto &lane_start_waypoint = waypoint; // 车道起始路点
-
-    auto current_waypoint = lane_start_waypoint; // 当前路点
+    auto current_waypoint = lane_start; // 当前路点
 
     const Lane &lane = GetLane(current_waypoint); // 获取当前路点所在的车道
 
@@ -927,78 +915,247 @@ for (auto &waypoint : topology) {
 
     // 在直线段中节省计算时间
     if (lane.IsStraight()) { // 如果车道是直的
+      double delta_s = min_delta_s; // 初始化增量距离
+      double remaining_length = GetRemainingLength(lane, current_waypoint.s); // 获取剩余长度
+      remaining_length -= epsilon; // 减去一个小值以避免数值问题
+      delta_s = remaining_length; // 更新增量距离
+      if (delta_s < epsilon) { // 如果增量距离小于阈值
+        return; // 跳过此车道
+      }
+      auto next = GetNext(current_waypoint, delta_s); // 获取下一个路点
+
+      RELEASE_ASSERT(next.size() == 1); // 确保下一个路点只有一个
+      RELEASE_ASSERT(next.front().road_id == current_waypoint.road_id); // 确保下一个路点在同一路段
+      auto next_waypoint = next.front(); // 下一个路点
+
+      AddElementToRtreeAndUpdateTransforms( // 添加元素到R树并更新变换
+          rtree_elements,
+          current_transform,
+          current_waypoint,
+          next_waypoint);
+      // 到达车道末尾
+    } else {
+      auto next_waypoint = current_waypoint; // 初始化下一个路点
+
+      // 循环直到车道末尾
+      // 按小的s增量前进
+      while (true) {
         double delta_s = min_delta_s; // 初始化增量距离
-        double remaining_length = GetRemainingLength(lane, current_waypoint.s); // 获取剩余长度
+        double remaining_length = GetRemainingLength(lane, next_waypoint.s); // 获取剩余长度
         remaining_length -= epsilon; // 减去一个小值以避免数值问题
-        delta_s = remaining_length; // 更新增量距离
+        delta_s = std::min(delta_s, remaining_length); // 更新增量距离
+
         if (delta_s < epsilon) { // 如果增量距离小于阈值
-            continue; // 跳过此轮
+          AddElementToRtreeAndUpdateTransforms( // 添加当前路点和下一个路点到R树
+              rtree_elements,
+              current_transform,
+              current_waypoint,
+              next_waypoint);
+          break; // 退出循环
         }
-        auto next = GetNext(current_waypoint, delta_s); // 获取下一个路点
-
-        RELEASE_ASSERT(next.size() == 1); // 确保下一个路点只有一个
-        RELEASE_ASSERT(next.front().road_id == current_waypoint.road_id); // 确保下一个路点在同一路段
-        auto next_waypoint = next.front(); // 下一个路点
-
-        AddElementToRtreeAndUpdateTransforms( // 添加元素到R树并更新变换
-            rtree_elements,
-            current_transform,
-            current_waypoint,
-            next_waypoint);
-        // 到达车道末尾
-    } else {
-        auto next_waypoint = current_waypoint; // 初始化下一个路点
-
-        // 循环直到车道末尾
-        // 按小的s增量前进
-        while (true) {
-            double delta_s = min_delta_s; // 初始化增量距离
-            double remaining_length = GetRemainingLength(lane, next_waypoint.s); // 获取剩余长度
-            remaining_length -= epsilon; // 减去一个小值以避免数值问题
-            delta_s = std::min(delta_s, remaining_length); // 更新增量距离
-
-            if (delta_s < epsilon) { // 如果增量距离小于阈值
-                AddElementToRtreeAndUpdateTransforms( // 添加当前路点和下一个路点到R树
-                    rtree_elements,
-                    current_transform,
-                    current_waypoint,
-                    next_waypoint);
-                break; // 退出循环
-            }
 
-            auto next = GetNext(next_waypoint, delta_s); // 获取下一个路点
-            if (next.size() != 1 || // 如果下一个路点不止一个或在不同的区段
-                current_waypoint.section_id != next.front().section_id) {
-                AddElementToRtreeAndUpdateTransforms( // 添加当前和下一个路点到R树
-                    rtree_elements,
-                    current_transform,
-                    current_waypoint,
-                    next_waypoint);
-                break; // 退出循环
-            }
+        auto next = GetNext(next_waypoint, delta_s); // 获取下一个路点
+        if (next.size() != 1 || // 如果下一个路点不止一个或在不同的区段
+            current_waypoint.section_id != next.front().section_id) {
+          AddElementToRtreeAndUpdateTransforms( // 添加当前和下一个路点到R树
+              rtree_elements,
+              current_transform,
+              current_waypoint,
+              next_waypoint);
+          break; // 退出循环
+        }
 
-            next_waypoint = next.front(); // 更新下一个路点
-            geom::Transform next_transform = ComputeTransform(next_waypoint); // 计算下一个路点的变换
-            double angle = geom::Math::GetVectorAngle( // 获取当前和下一个路点的角度
-                current_transform.GetForwardVector(), next_transform.GetForwardVector());
-
-            if (std::abs(angle) > angle_threshold || // 如果角度超过阈值
-                std::abs(current_waypoint.s - next_waypoint.s) > max_segment_length) { // 或者距离超过最大段长度
-                AddElementToRtree( // 将当前和下一个路点的变换添加到R树
-                    rtree_elements,
-                    current_transform,
-                    next_transform,
-                    current_waypoint,
-                    next_waypoint);
-                current_waypoint = next_waypoint; // 更新当前路点
-                current_transform = next_transform; // 更新当前变换
-            }
+        next_waypoint = next.front(); // 更新下一个路点
+        geom::Transform next_transform = ComputeTransform(next_waypoint); // 计算下一个路点的变换
+        double angle = geom::Math::GetVectorAngle( // 获取当前和下一个路点的角度
+            current_transform.GetForwardVector(), next_transform.GetForwardVector());
+
+        if (std::abs(angle) > angle_threshold || // 如果角度超过阈值
+            std::abs(current_waypoint.s - next_waypoint.s) > max_segment_length) { // 或者距离超过最大段长度
+          AddElementToRtree( // 将当前和下一个路点的变换添加到R树
+              rtree_elements,
+              current_transform,
+              next_transform,
+              current_waypoint,
+              next_waypoint);
+          current_waypoint = next_waypoint; // 更新当前路点
+          current_transform = next_transform; // 更新当前变换
+        }
+      }
+    }
+  }
+
+  // 创建R树
+  void Map::CreateRtree() {
+    // 在每条车道的起始位置生成Waypoints
+    std::vector<Waypoint> topology; // 存储所有Waypoints
+    for (const auto &pair : _data.GetRoads()) { // 遍历所有道路
+      const auto &road = pair.second; // 获取道路信息
+      // 对每条车道进行操作
+      ForEachLane(road, Lane::LaneType::Any, [&](auto &&waypoint) {
+        if(waypoint.lane_id != 0) { // 排除ID为0的车道
+          topology.push_back(waypoint); // 将Waypoint加入到topology中
         }
+      });
     }
-}
 
-// 将段添加到R树
-_rtree.InsertElements(rtree_elements);
+    // 各车道的线段互不相关，按车道分块并行生成。每个线程写入自己的块，
+    // 最后按块的顺序拼接，结果与单线程生成的完全一致。
+    constexpr size_t min_lanes_per_thread = 64u;
+    const size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    const size_t num_threads = std::min(max_threads, topology.size() / min_lanes_per_thread + 1u);
+    const size_t lanes_per_thread = (topology.size() + num_threads - 1u) / num_threads;
+
+    std::vector<std::vector<Rtree::TreeElement>> chunks(num_threads);
+#ifndef LIBCARLA_NO_EXCEPTIONS
+    // 工作线程中的异常在合并之前转交给调用线程重新抛出。
+    std::vector<std::exception_ptr> errors(num_threads);
+#endif // LIBCARLA_NO_EXCEPTIONS
+    auto generate_chunk = [&](size_t index) {
+#ifndef LIBCARLA_NO_EXCEPTIONS
+      try {
+#endif // LIBCARLA_NO_EXCEPTIONS
+        const size_t begin = index * lanes_per_thread;
+        const size_t end = std::min(begin + lanes_per_thread, topology.size());
+        for (size_t i = begin; i < end; ++i) {
+          AddLaneToRtree(chunks[index], topology[i]);
+        }
+#ifndef LIBCARLA_NO_EXCEPTIONS
+      } catch (...) {
+        errors[index] = std::current_exception();
+      }
+#endif // LIBCARLA_NO_EXCEPTIONS
+    };
+
+    std::vector<std::thread> workers; // 存储工作线程
+    for (size_t i = 1u; i < num_threads; ++i) {
+      workers.emplace_back(generate_chunk, i);
+    }
+    generate_chunk(0u); // 当前线程处理第一块
+    for (auto &worker : workers) {
+      worker.join();
+    }
+#ifndef LIBCARLA_NO_EXCEPTIONS
+    for (auto &error : errors) {
+      if (error) {
+        std::rethrow_exception(error);
+      }
+    }
+#endif // LIBCARLA_NO_EXCEPTIONS
+
+    // 段和路点的容器
+    std::vector<Rtree::TreeElement> rtree_elements = std::move(chunks[0u]);
+    for (size_t i = 1u; i < num_threads; ++i) {
+      rtree_elements.insert(rtree_elements.end(), chunks[i].begin(), chunks[i].end());
+    }
+
+    // 将段一次性打包加载到R树
+    _rtree.InsertElements(rtree_elements);
+  }
+
+  // ===========================================================================
+  // -- Map: R 树缓存 ----------------------------------------------------------
+  // ===========================================================================
+
+  /// 缓存文件的魔数与版本，格式变化时需要更新版本号
+  static constexpr uint32_t RTREE_CACHE_MAGIC = 0x45525452u; // "RTRE"
+  static constexpr uint32_t RTREE_CACHE_VERSION = 2u;
+
+  template <typename T>
+  static void WriteBinary(std::ostream &out, const T &value) {
+    static_assert(std::is_arithmetic<T>::value, "Only arithmetic types are written");
+    out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+
+  template <typename T>
+  static bool ReadBinary(std::istream &in, T &value) {
+    static_assert(std::is_arithmetic<T>::value, "Only arithmetic types are read");
+    return static_cast<bool>(in.read(reinterpret_cast<char *>(&value), sizeof(T)));
+  }
+
+  static void WriteWaypoint(std::ostream &out, const Waypoint &waypoint) {
+    WriteBinary(out, waypoint.road_id);
+    WriteBinary(out, waypoint.section_id);
+    WriteBinary(out, waypoint.lane_id);
+    WriteBinary(out, waypoint.s);
+  }
+
+  static bool ReadWaypoint(std::istream &in, Waypoint &waypoint) {
+    return ReadBinary(in, waypoint.road_id) &&
+           ReadBinary(in, waypoint.section_id) &&
+           ReadBinary(in, waypoint.lane_id) &&
+           ReadBinary(in, waypoint.s);
+  }
+
+  static void WritePoint(std::ostream &out, const geom::SegmentCloudRtree<Waypoint>::BPoint &point) {
+    WriteBinary(out, point.get<0>());
+    WriteBinary(out, point.get<1>());
+    WriteBinary(out, point.get<2>());
+  }
+
+  static bool ReadPoint(std::istream &in, geom::SegmentCloudRtree<Waypoint>::BPoint &point) {
+    float x, y, z;
+    if (!(ReadBinary(in, x) && ReadBinary(in, y) && ReadBinary(in, z))) {
+      return false;
+    }
+    point = geom::SegmentCloudRtree<Waypoint>::BPoint(x, y, z);
+    return true;
+  }
+
+  uint64_t Map::ComputeRtreeFingerprint(const std::string &opendrive) {
+    // 64 位 FNV-1a，结果与平台无关；缓存格式的版本号也计入指纹
+    uint64_t fingerprint = 14695981039346656037ull ^ RTREE_CACHE_VERSION;
+    for (const char c : opendrive) {
+      fingerprint ^= static_cast<uint8_t>(c);
+      fingerprint *= 1099511628211ull;
+    }
+    // 0 保留给不是由 OpenDRIVE 文件生成的地图
+    return fingerprint != 0u ? fingerprint : 1u;
+  }
+
+  void Map::SaveRtree(std::ostream &out) const {
+    const auto elements = _rtree.GetElements();
+    WriteBinary(out, RTREE_CACHE_MAGIC);
+    WriteBinary(out, RTREE_CACHE_VERSION);
+    WriteBinary(out, _data.GetSourceFingerprint());
+    WriteBinary(out, static_cast<uint64_t>(elements.size()));
+    for (const auto &element : elements) {
+      WritePoint(out, element.first.first);
+      WritePoint(out, element.first.second);
+      WriteWaypoint(out, element.second.first);
+      WriteWaypoint(out, element.second.second);
+    }
+  }
+
+  bool Map::LoadRtree(std::istream &in) {
+    uint32_t magic = 0u;
+    uint32_t version = 0u;
+    uint64_t fingerprint = 0u;
+    uint64_t size = 0u;
+    if (!(ReadBinary(in, magic) && ReadBinary(in, version) &&
+          ReadBinary(in, fingerprint) && ReadBinary(in, size)) ||
+        (magic != RTREE_CACHE_MAGIC) ||
+        (version != RTREE_CACHE_VERSION) ||
+        (fingerprint == 0u) ||
+        (fingerprint != _data.GetSourceFingerprint())) {
+      return false;
+    }
+    std::vector<Rtree::TreeElement> elements;
+    for (uint64_t i = 0u; i < size; ++i) {
+      Rtree::TreeElement element;
+      if (!(ReadPoint(in, element.first.first) &&
+            ReadPoint(in, element.first.second) &&
+            ReadWaypoint(in, element.second.first) &&
+            ReadWaypoint(in, element.second.second))) {
+        return false;
+      }
+      elements.emplace_back(std::move(element));
+    }
+    Rtree rtree;
+    rtree.InsertElements(elements);
+    _rtree = std::move(rtree);
+    return true;
+  }
 
 Junction* Map::GetJunction(JuncId id) { // 获取交叉口
     return _data.GetJunction(id); // 返回指定ID的交叉口
@@ -1086,39 +1243,7 @@ std::vector<std::unique_ptr<geom::Mesh>> Map::GenerateChunkedMesh(
 
     // 生成交叉口内的道路并进行光滑处理
     for (const auto &junc_pair : _data.GetJunctions()) { // 遍历所有交叉口
-      const auto &junction = junc_pair.second; // 获取当前交叉口
-      std::vector<std::unique_ptr<geom::Mesh>> lane_meshes; // 存储车道网格
-      std::vector<std::unique_ptr<geom::Mesh>> sidewalk_lane_meshes; // 存储人行道网格
-      for(const auto &connection_pair : junction.GetConnections()) { // 遍历交叉口的连接
-        const auto &connection = connection_pair.second; // 获取连接信息
-        const auto &road = _data.GetRoads().at(connection.connecting_road); // 获取连接的道路
-        for (auto &&lane_section : road.GetLaneSections()) { // 遍历道路的车道段
-          for (auto &&lane_pair : lane_section.GetLanes()) { // 遍历车道
-            const auto &lane = lane_pair.second; // 获取当前车道
-            if (lane.GetType() != road::Lane::LaneType::Sidewalk) { // 如果车道不是人行道
-              lane_meshes.push_back(mesh_factory.Generate(lane)); // 生成车道网格并添加
-            } else {
-              sidewalk_lane_meshes.push_back(mesh_factory.Generate(lane)); // 生成人行道网格并添加
-            }
-          }
-        }
-      }
-      if(params.smooth_junctions) { // 如果需要光滑处理交叉口
-        auto merged_mesh = mesh_factory.MergeAndSmooth(lane_meshes); // 合并并光滑车道网格
-        for(auto& lane : sidewalk_lane_meshes) { // 遍历人行道网格
-          *merged_mesh += *lane; // 将人行道网格添加到合并网格中
-        }
-        out_mesh_list.push_back(std::move(merged_mesh)); // 将合并后的网格添加到输出列表
-      } else {
-        std::unique_ptr<geom::Mesh> junction_mesh = std::make_unique<geom::Mesh>(); // 创建新的交叉口网格
-        for(auto& lane : lane_meshes) { // 遍历车道网格
-          *junction_mesh += *lane; // 将车道网格添加到交叉口网格中
-        }
-        for(auto& lane : sidewalk_lane_meshes) { // 遍历人行道网格
-          *junction_mesh += *lane; // 将人行道网格添加到交叉口网格中
-        }
-        out_mesh_list.push_back(std::move(junction_mesh)); // 将交叉口网格添加到输出列表
-      }
+      out_mesh_list.push_back(GenerateJunctionMesh(mesh_factory, junc_pair.second, params.smooth_junctions));
     }
 
     // 找到输出网格的最小和最大位置
@@ -1150,6 +1275,186 @@ std::vector<std::unique_ptr<geom::Mesh>> Map::GenerateChunkedMesh(
     return result; // 返回生成的结果网格列表
   }
 
+  void Map::GenerateChunkedMesh(
+      const rpc::OpendriveGenerationParameters& params,
+      const std::function<void(std::unique_ptr<geom::Mesh>)> &callback,
+      size_t max_in_flight) const {
+    geom::MeshFactory mesh_factory(params);
+
+    // 每个任务是一条非交叉口道路或一个交叉口，先收集起来以便工作线程领取
+    std::vector<const Road *> roads;
+    for (auto &&pair : _data.GetRoads()) {
+      if (!pair.second.IsJunction()) {
+        roads.push_back(&pair.second);
+      }
+    }
+    std::vector<const Junction *> junctions;
+    for (const auto &junc_pair : _data.GetJunctions()) {
+      junctions.push_back(&junc_pair.second);
+    }
+    const size_t number_of_tasks = roads.size() + junctions.size();
+    if (number_of_tasks == 0u) {
+      return;
+    }
+
+    size_t number_of_threads = std::max(1u, std::thread::hardware_concurrency());
+    number_of_threads = std::min(number_of_threads, number_of_tasks);
+    if (max_in_flight == 0u) {
+      max_in_flight = 2u * number_of_threads;
+    }
+
+    // 有界队列：队列满时工作线程等待调用方消费，峰值内存与地图大小无关
+    std::mutex mutex;
+    std::condition_variable queue_not_full;
+    std::condition_variable queue_not_empty;
+    std::deque<std::unique_ptr<geom::Mesh>> queue;
+    size_t finished_threads = 0u;
+    bool stop = false;
+    std::atomic_size_t next_task{0u};
+
+    auto push = [&](std::unique_ptr<geom::Mesh> mesh) {
+      std::unique_lock<std::mutex> lock(mutex);
+      queue_not_full.wait(lock, [&]() { return stop || queue.size() < max_in_flight; });
+      if (stop) {
+        return false;
+      }
+      queue.push_back(std::move(mesh));
+      queue_not_empty.notify_one();
+      return true;
+    };
+
+    auto generate = [&]() {
+      for (size_t i = next_task++; i < number_of_tasks; i = next_task++) {
+        if (i < roads.size()) {
+          for (auto &mesh : mesh_factory.GenerateAllWithMaxLen(*roads[i])) {
+            if (!push(std::move(mesh))) {
+              break;
+            }
+          }
+        } else if (!push(GenerateJunctionMesh(
+            mesh_factory, *junctions[i - roads.size()], params.smooth_junctions))) {
+          break;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stop) {
+          break;
+        }
+      }
+    };
+
+    // 在调用线程中依次把网格交给回调
+    auto consume = [&]() {
+      while (true) {
+        std::unique_ptr<geom::Mesh> mesh;
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          queue_not_empty.wait(lock, [&]() {
+            return stop || !queue.empty() || finished_threads == number_of_threads;
+          });
+          if (stop || queue.empty()) {
+            break;
+          }
+          mesh = std::move(queue.front());
+          queue.pop_front();
+          queue_not_full.notify_one();
+        }
+        callback(std::move(mesh));
+      }
+    };
+
+#ifndef LIBCARLA_NO_EXCEPTIONS
+    // 工作线程或回调抛出的第一个异常让所有线程停下，等待工作线程退出后
+    // 在调用线程中重新抛出。
+    std::exception_ptr error;
+    auto fail = [&](std::exception_ptr exception) {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (error == nullptr) {
+        error = exception;
+      }
+      stop = true;
+      queue_not_full.notify_all();
+    };
+#endif // LIBCARLA_NO_EXCEPTIONS
+
+    auto worker = [&]() {
+#ifndef LIBCARLA_NO_EXCEPTIONS
+      try {
+#endif // LIBCARLA_NO_EXCEPTIONS
+        generate();
+#ifndef LIBCARLA_NO_EXCEPTIONS
+      } catch (...) {
+        fail(std::current_exception());
+      }
+#endif // LIBCARLA_NO_EXCEPTIONS
+      std::lock_guard<std::mutex> lock(mutex);
+      ++finished_threads;
+      queue_not_empty.notify_one();
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(number_of_threads);
+    for (size_t i = 0u; i < number_of_threads; ++i) {
+      workers.emplace_back(worker);
+    }
+
+#ifndef LIBCARLA_NO_EXCEPTIONS
+    try {
+#endif // LIBCARLA_NO_EXCEPTIONS
+      consume();
+#ifndef LIBCARLA_NO_EXCEPTIONS
+    } catch (...) {
+      fail(std::current_exception());
+    }
+#endif // LIBCARLA_NO_EXCEPTIONS
+
+    for (auto &thread : workers) {
+      thread.join();
+    }
+#ifndef LIBCARLA_NO_EXCEPTIONS
+    if (error != nullptr) {
+      std::rethrow_exception(error);
+    }
+#endif // LIBCARLA_NO_EXCEPTIONS
+  }
+
+  std::unique_ptr<geom::Mesh> Map::GenerateJunctionMesh(
+      const geom::MeshFactory &mesh_factory,
+      const Junction &junction,
+      const bool smooth_junctions) const {
+    std::vector<std::unique_ptr<geom::Mesh>> lane_meshes; // 存储车道网格
+    std::vector<std::unique_ptr<geom::Mesh>> sidewalk_lane_meshes; // 存储人行道网格
+    for(const auto &connection_pair : junction.GetConnections()) { // 遍历交叉口的连接
+      const auto &connection = connection_pair.second; // 获取连接信息
+      const auto &road = _data.GetRoads().at(connection.connecting_road); // 获取连接的道路
+      for (auto &&lane_section : road.GetLaneSections()) { // 遍历道路的车道段
+        for (auto &&lane_pair : lane_section.GetLanes()) { // 遍历车道
+          const auto &lane = lane_pair.second; // 获取当前车道
+          if (lane.GetType() != road::Lane::LaneType::Sidewalk) { // 如果车道不是人行道
+            lane_meshes.push_back(mesh_factory.Generate(lane)); // 生成车道网格并添加
+          } else {
+            sidewalk_lane_meshes.push_back(mesh_factory.Generate(lane)); // 生成人行道网格并添加
+          }
+        }
+      }
+    }
+    if(smooth_junctions) { // 如果需要光滑处理交叉口
+      auto merged_mesh = mesh_factory.MergeAndSmooth(lane_meshes); // 合并并光滑车道网格
+      for(auto& lane : sidewalk_lane_meshes) { // 遍历人行道网格
+        *merged_mesh += *lane; // 将人行道网格添加到合并网格中
+      }
+      return merged_mesh; // 返回合并后的网格
+    } else {
+      std::unique_ptr<geom::Mesh> junction_mesh = std::make_unique<geom::Mesh>(); // 创建新的交叉口网格
+      for(auto& lane : lane_meshes) { // 遍历车道网格
+        *junction_mesh += *lane; // 将车道网格添加到交叉口网格中
+      }
+      for(auto& lane : sidewalk_lane_meshes) { // 遍历人行道网格
+        *junction_mesh += *lane; // 将人行道网格添加到交叉口网格中
+      }
+      return junction_mesh; // 返回交叉口网格
+    }
+  }
+
  std::map<road::Lane::LaneType , std::vector<std::unique_ptr<geom::Mesh>>>
 Map::GenerateOrderedChunkedMeshInLocations(const rpc::OpendriveGenerationParameters& params,
                                             const geom::Vector3D& minpos,
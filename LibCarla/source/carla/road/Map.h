@@ -21,6 +21,9 @@
 
 #include <boost/optional.hpp> // 包含可选类型的定义
 
+#include <functional>
+#include <istream>
+#include <ostream>
 #include <vector> // 包含向量类的定义
 
 namespace carla {
@@ -35,10 +38,30 @@ namespace road {
     /// -- Constructor ---------------------------------------------------------
     /// ========================================================================
 
-    Map(MapData m) : _data(std::move(m)) { // 构造函数，初始化_map数据
-      CreateRtree(); // 创建R树
+    /// @param rtree_cache 可选，由 SaveRtree 写出的 R 树缓存。缓存有效时
+    /// 直接从中恢复 R 树，否则重新生成。
+    Map(MapData m, std::istream *rtree_cache = nullptr) : _data(std::move(m)) { // 构造函数，初始化_map数据
+      if (rtree_cache == nullptr || !LoadRtree(*rtree_cache)) {
+        CreateRtree(); // 创建R树
+      }
     }
 
+    /// ========================================================================
+    /// -- R-tree cache --------------------------------------------------------
+    /// ========================================================================
+
+    /// 将路段 R 树以二进制格式写入 @a out。
+    void SaveRtree(std::ostream &out) const;
+
+    /// 从 SaveRtree 的输出恢复 R 树，跳过逐车道生成线段的过程。
+    /// 数据损坏、由其他 OpenDRIVE 内容生成，或当前地图不是由 OpenDRIVE
+    /// 文件解析得到时返回 false，且不修改当前的 R 树。
+    bool LoadRtree(std::istream &in);
+
+    /// OpenDRIVE 内容 @a opendrive 的指纹，用于校验 R 树缓存，也可作为缓存的文件名。
+    /// 内容的任何修改（几何、车道宽度、高程等）都会改变指纹。
+    static uint64_t ComputeRtreeFingerprint(const std::string &opendrive);
+
     /// ========================================================================
     /// -- Georeference --------------------------------------------------------
     /// ========================================================================
@@ -161,6 +184,16 @@ namespace road {
     std::vector<std::unique_ptr<geom::Mesh>> GenerateChunkedMesh(
         const rpc::OpendriveGenerationParameters& params) const; // 生成分块网格
 
+    /// 流式生成分块网格：工作线程每生成一条道路或一个交叉口的网格，就在
+    /// 调用线程中交给 @a callback，而不是先把整张地图的网格都保存下来。
+    /// 网格按道路/交叉口分块（不做按网格单元的合并），到达顺序不确定。
+    /// 最多 @a max_in_flight 个网格在等待回调（0 表示线程数的两倍），
+    /// 生成或回调中的异常会在所有工作线程退出后重新抛出。
+    void GenerateChunkedMesh(
+        const rpc::OpendriveGenerationParameters& params,
+        const std::function<void(std::unique_ptr<geom::Mesh>)> &callback,
+        size_t max_in_flight = 0u) const;
+
     std::map<road::Lane::LaneType , std::vector<std::unique_ptr<geom::Mesh>>>
       GenerateOrderedChunkedMeshInLocations( const rpc::OpendriveGenerationParameters& params,
                                              const geom::Vector3D& minpos,
@@ -212,18 +245,22 @@ private:
     void CreateRtree();  // 创建R树
 
     // 辅助函数，用于构造R树元素列表
+    void AddLaneToRtree(  // 生成从车道起点开始的一条车道的所有线段
+        std::vector<Rtree::TreeElement> &rtree_elements,  // R树元素列表
+        Waypoint lane_start) const;  // 车道起始路点
+
     void AddElementToRtree(  // 将元素添加到R树
         std::vector<Rtree::TreeElement> &rtree_elements,  // R树元素列表
         geom::Transform &current_transform,  // 当前变换
         geom::Transform &next_transform,  // 下一个变换
         Waypoint &current_waypoint,  // 当前路点
-        Waypoint &next_waypoint);  // 下一个路点
+        Waypoint &next_waypoint) const;  // 下一个路点
 
     void AddElementToRtreeAndUpdateTransforms(  // 添加元素到R树并更新变换
         std::vector<Rtree::TreeElement> &rtree_elements,  // R树元素列表
         geom::Transform &current_transform,  // 当前变换
         Waypoint &current_waypoint,  // 当前路点
-        Waypoint &next_waypoint);  // 下一个路点
+        Waypoint &next_waypoint) const;  // 下一个路点
 
 public:
     inline float GetZPosInDeformation(float posx, float posy) const;  // 获取变形中的Z轴位置
@@ -256,6 +293,12 @@ public:
       const geom::Vector3D& minpos,  // 最小位置
       const geom::Vector3D& maxpos ) const;  // 最大位置
 
+    // 生成一个交叉口内所有连接道路的网格，按需对车道部分做光滑处理
+    std::unique_ptr<geom::Mesh> GenerateJunctionMesh(
+      const carla::geom::MeshFactory& mesh_factory,
+      const Junction& junction,
+      const bool smooth_junctions) const;
+
     std::unique_ptr<geom::Mesh> SDFToMesh(const road::Junction& jinput, const std::vector<geom::Vector3D>& sdfinput, int grid_cells_per_dim) const;  // 将SDF转换为网格
   };
 
@@ -35,7 +35,7 @@ using namespace carla::road::element; // 使用carla::road::element命名空间
 namespace carla {
 namespace road {
 
-  boost::optional<Map> MapBuilder::Build() {
+  boost::optional<Map> MapBuilder::Build(std::istream *rtree_cache) {
 
     CreatePointersBetweenRoadSegments(); // 创建路段之间的指针
     RemoveZeroLaneValiditySignalReferences(); // 移除无效车道信号引用
@@ -62,7 +62,7 @@ namespace road {
     // _map_data is a member of MapBuilder so you must especify if
     // you want to keep it (will return copy -> Map(const Map &))
     // or move it (will return move -> Map(Map &&))
-    Map map(std::move(_map_data)); // 移动并创建地图对象
+    Map map(std::move(_map_data), rtree_cache); // 移动并创建地图对象
     CreateJunctionBoundingBoxes(map); // 创建交叉口的边界框
     ComputeJunctionRoadConflicts(map); // 计算交叉口道路冲突
     CheckSignalsOnRoads(map); // 检查道路上的信号
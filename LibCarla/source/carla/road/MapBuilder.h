@@ -20,7 +20,14 @@ namespace road {
   class MapBuilder {
   public:
 
-    boost::optional<Map> Build(); // 构建地图并返回一个可选的地图对象
+    /// 构建地图并返回一个可选的地图对象。@a rtree_cache 为可选的 R 树缓存，
+    /// 见 Map::SaveRtree。
+    boost::optional<Map> Build(std::istream *rtree_cache = nullptr);
+
+    /// 记录生成地图的 OpenDRIVE 内容的指纹，用于校验 R 树缓存。
+    void SetSourceFingerprint(uint64_t fingerprint) {
+      _map_data._source_fingerprint = fingerprint;
+    }
 
     // 从道路解析器调用
     carla::road::Road *AddRoad(
@@ -45,6 +45,12 @@ namespace road { // 定义 road 命名空间
       return _junctions; // 返回交叉口映射
     }
 
+    /// 生成该地图的 OpenDRIVE 内容的指纹，见 Map::ComputeRtreeFingerprint；
+    /// 不是由 OpenDRIVE 文件解析得到时为 0。
+    uint64_t GetSourceFingerprint() const {
+      return _source_fingerprint;
+    }
+
     bool ContainsRoad(RoadId id) const { // 检查是否包含特定道路
       return (_roads.find(id) != _roads.end()); // 返回是否找到该道路
     }
@@ -98,6 +104,8 @@ namespace road { // 定义 road 命名空间
     std::unordered_map<SignId, std::unique_ptr<Signal>> _signals; // 信号映射成员变量
 
     std::unordered_map<ContId, std::unique_ptr<Controller>> _controllers; // 控制器映射成员变量
+
+    uint64_t _source_fingerprint = 0u; // OpenDRIVE 内容的指纹
   };
 
 } // namespace road
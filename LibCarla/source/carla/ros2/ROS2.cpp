@@ -6,6 +6,7 @@
 
 #include "carla/Logging.h" // 引入日志模块
 #include "carla/ros2/ROS2.h" // 引入ROS2模块
+#include "carla/ros2/ROS2PublishQueue.h" // 引入ROS2发布队列
 #include "carla/geom/GeoLocation.h" // 引入地理位置模块
 #include "carla/geom/Vector3D.h" // 引入三维向量模块
 #include "carla/sensor/data/DVSEvent.h" // 引入DVS事件数据模块
@@ -73,6 +74,9 @@ enum ESensors { // 定义传感器枚举
 void ROS2::Enable(bool enable) { // 启用或禁用ROS2
   _enabled = enable; // 设置启用状态
   log_info("ROS2 enabled: ", _enabled); // 记录启用状态
+  if (_enabled) {
+    _publish_queue.Start(); // 启动发布线程
+  }
   _clock_publisher = std::make_shared<CarlaClockPublisher>("clock", ""); // 创建时钟发布者
   _clock_publisher->Init(); // 初始化时钟发布者
 }
@@ -126,6 +130,8 @@ void ROS2::RemoveActorRosName(void *actor) { // 移除操作者的ROS名称
 
   _publishers.erase(actor); // 移除发布者
   _transforms.erase(actor); // 移除变换数据
+  LogPublishStats(actor);
+  _topic_stats.erase(actor);
 }
 
 void ROS2::UpdateActorRosName(void *actor, std::string ros_name) { // 更新操作者的ROS名称
@@ -476,6 +482,83 @@ parent_ros_name.c_str());// 创建新的深度相机发布者
   return { publisher, transform };// 返回当前发布者和变换发布者
 }
 
+// 相机数据的发布任务：任务持有 BufferView，图像数据直到发布线程上才被复制进消息。
+template <typename PublisherT, typename SerializerT, typename PixelT>
+static ROS2PublishQueue::Task MakeCameraTask(
+    std::shared_ptr<CarlaPublisher> sensor,
+    carla::SharedBufferView buffer,
+    int W, int H, float Fov,
+    int32_t seconds, uint32_t nanoseconds) {
+  std::shared_ptr<PublisherT> publisher = std::dynamic_pointer_cast<PublisherT>(std::move(sensor));
+  return [=]() {
+    const typename SerializerT::ImageHeader *header =// 获取图像头信息
+      reinterpret_cast<const typename SerializerT::ImageHeader *>(buffer->data());
+    if (!header)// 如果头信息为空
+      return false;
+    if (!publisher->HasBeenInitialized())// 如果发布者未初始化
+      publisher->InitInfoData(0, 0, H, W, Fov, true);// 初始化信息数据
+    publisher->SetImageData(seconds, nanoseconds, header->height, header->width, (const PixelT*) (buffer->data() + SerializerT::header_offset));// 设置图像数据
+    publisher->SetCameraInfoData(seconds, nanoseconds);// 设置相机信息数据
+    return publisher->Publish();// 发布数据
+  };
+}
+
+ROS2TopicStatsEntry &ROS2::GetOrCreateTopicStats(void *actor) {
+  auto it = _topic_stats.find(actor);
+  if (it == _topic_stats.end()) {
+    ROS2TopicStatsEntry entry;
+    entry.name = GetActorRosName(actor);
+    entry.sensor = std::make_shared<ROS2TopicStats>();
+    entry.transform = std::make_shared<ROS2TopicStats>();
+    it = _topic_stats.emplace(actor, std::move(entry)).first;
+  }
+  return it->second;
+}
+
+void ROS2::PublishSensorData(void *actor, ROS2PublishQueue::Task task) {
+  _publish_queue.Push(std::move(task), GetOrCreateTopicStats(actor).sensor);
+  if (!_publish_queue.IsRunning()) {
+    // 发布线程未启动时在调用线程上发布
+    _publish_queue.Flush();
+  }
+}
+
+void ROS2::PublishTransform(
+    void *actor,
+    std::shared_ptr<CarlaTransformPublisher> publisher,
+    const carla::geom::Transform &sensor_transform) {
+  const int32_t seconds = _seconds;
+  const uint32_t nanoseconds = _nanoseconds;
+  _publish_queue.Push([=]() {
+    publisher->SetData(seconds, nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置位置信息和旋转信息
+    return publisher->Publish();// 发布数据
+  }, GetOrCreateTopicStats(actor).transform);
+  if (!_publish_queue.IsRunning()) {
+    _publish_queue.Flush();
+  }
+}
+
+void ROS2::LogPublishStats(void *actor) const {
+  auto it = _topic_stats.find(actor);
+  if (it == _topic_stats.end()) {
+    return;
+  }
+  const auto log_topic = [&](const char *topic, const ROS2TopicStats &stats) {
+    log_info("ROS2 publish stats:", it->second.name, topic,
+        "published.", stats.published.load(), "dropped.", stats.dropped.load(), "failed.", stats.failed.load(),
+        "latency ms (avg/last/max).", stats.GetAverageLatencyMs(),
+        1e-6 * static_cast<double>(stats.last_latency_ns.load()),
+        1e-6 * static_cast<double>(stats.max_latency_ns.load()));
+  };
+  log_topic("data", *it->second.sensor);
+  log_topic("transform", *it->second.transform);
+}
+
+std::shared_ptr<const ROS2TopicStats> ROS2::GetSensorPublishStats(void *actor) const {
+  auto it = _topic_stats.find(actor);
+  return it == _topic_stats.end() ? nullptr : it->second.sensor;
+}
+
 void ROS2::ProcessDataFromCamera(
     uint64_t sensor_type,// 传感器类型
     carla::streaming::detail::stream_id_type stream_id,// 流ID
@@ -483,181 +566,83 @@ void ROS2::ProcessDataFromCamera(
     int W, int H, float Fov, // 宽度、高度、视场角
     const carla::SharedBufferView buffer,// 数据缓冲区
     void *actor) { // 操作者
-
+  namespace s11n = carla::sensor::s11n;
+  std::pair<std::shared_ptr<CarlaPublisher>, std::shared_ptr<CarlaTransformPublisher>> sensors;
+  ROS2PublishQueue::Task task;
   switch (sensor_type) { // 根据传感器类型进行处理
     case ESensors::CollisionSensor:// 碰撞传感器
       log_info("Sensor Collision to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size());// 记录碰撞传感器数据
-      break;
+      return;
     case ESensors::DepthCamera:// 深度相机
-      {
-        log_info("Sensor DepthCamera to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size());// 记录深度相机数据
-        auto sensors = GetOrCreateSensor(ESensors::DepthCamera, stream_id, actor);
-        if (sensors.first) {// 如果存在第一个传感器
-          std::shared_ptr<CarlaDepthCameraPublisher> publisher = std::dynamic_pointer_cast<CarlaDepthCameraPublisher>(sensors.first); // 转换为深度相机发布者
-          const carla::sensor::s11n::ImageSerializer::ImageHeader *header =// 获取图像头信息
-            reinterpret_cast<const carla::sensor::s11n::ImageSerializer::ImageHeader *>(buffer->data());
-          if (!header) // 如果头信息为空
-            return;// 返回
-          if (!publisher->HasBeenInitialized())// 如果发布者未初始化
-            publisher->InitInfoData(0, 0, H, W, Fov, true); // 初始化信息数据
-          publisher->SetImageData(_seconds, _nanoseconds, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置图像数据
-          publisher->SetCameraInfoData(_seconds, _nanoseconds);// 设置相机信息数据
-          publisher->Publish();// 发布数据
-        }
-        if (sensors.second) {// 如果存在第二个传感器
-          std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second); // 转换为变换发布者
-          publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置位置信息和旋转信息
-          publisher->Publish();// 发布数据
-        }
-      }
+      log_info("Sensor DepthCamera to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size());// 记录深度相机数据
+      sensors = GetOrCreateSensor(ESensors::DepthCamera, stream_id, actor);
+      if (sensors.first)
+        task = MakeCameraTask<CarlaDepthCameraPublisher, s11n::ImageSerializer, uint8_t>(sensors.first, buffer, W, H, Fov, _seconds, _nanoseconds);
       break;
     case ESensors::NormalsCamera: // 法线相机
       log_info("Sensor NormalsCamera to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size());// 记录法线相机数据
-      {
-        auto sensors = GetOrCreateSensor(ESensors::NormalsCamera, stream_id, actor); // 获取或创建传感器
-        if (sensors.first) { // 如果存在第一个传感器
-          std::shared_ptr<CarlaNormalsCameraPublisher> publisher = std::dynamic_pointer_cast<CarlaNormalsCameraPublisher>(sensors.first);// 转换为法线相机发布者
-          const carla::sensor::s11n::ImageSerializer::ImageHeader *header =// 获取图像头信息
-            reinterpret_cast<const carla::sensor::s11n::ImageSerializer::ImageHeader *>(buffer->data());
-          if (!header)// 如果头信息为空
-            return;// 返回
-          if (!publisher->HasBeenInitialized())// 如果发布者未初始化
-            publisher->InitInfoData(0, 0, H, W, Fov, true);// 初始化信息数据
-          publisher->SetImageData(_seconds, _nanoseconds, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置图像数据
-          publisher->SetCameraInfoData(_seconds, _nanoseconds);// 设置相机信息数据
-          publisher->Publish();// 发布数据
-        }
-        if (sensors.second) {// 如果存在第二个传感器
-          std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second); // 转换为变换发布者
-          publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置位置信息和旋转信息
-          publisher->Publish(); // 发布数据
-        }
-      }
+      sensors = GetOrCreateSensor(ESensors::NormalsCamera, stream_id, actor); // 获取或创建传感器
+      if (sensors.first)
+        task = MakeCameraTask<CarlaNormalsCameraPublisher, s11n::ImageSerializer, uint8_t>(sensors.first, buffer, W, H, Fov, _seconds, _nanoseconds);
       break;
     case ESensors::LaneInvasionSensor:// 压线传感器
       log_info("Sensor LaneInvasionSensor to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size());// 记录压线传感器的数据到ROS，输出帧、传感器类型、流ID和缓冲区大小
-      {
-        auto sensors = GetOrCreateSensor(ESensors::LaneInvasionSensor, stream_id, actor);// 获取或创建压线传感器
-        if (sensors.first) {// 如果第一个传感器存在
-          std::shared_ptr<CarlaLineInvasionPublisher> publisher = std::dynamic_pointer_cast<CarlaLineInvasionPublisher>(sensors.first); // 转换为压线发布者
-          publisher->SetData(_seconds, _nanoseconds, (const int32_t*) buffer->data());// 设置数据
-          publisher->Publish();// 发布数据
-        }
-        if (sensors.second) {// 如果第二个传感器存在
-          std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 转换为变换发布者
-          publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置位置信息和旋转信息
-          publisher->Publish();// 发布数据
-        }
+      sensors = GetOrCreateSensor(ESensors::LaneInvasionSensor, stream_id, actor);// 获取或创建压线传感器
+      if (sensors.first) {// 如果第一个传感器存在
+        std::shared_ptr<CarlaLineInvasionPublisher> publisher = std::dynamic_pointer_cast<CarlaLineInvasionPublisher>(sensors.first); // 转换为压线发布者
+        const int32_t seconds = _seconds;
+        const uint32_t nanoseconds = _nanoseconds;
+        task = [=]() {
+          publisher->SetData(seconds, nanoseconds, (const int32_t*) buffer->data());// 设置数据
+          return publisher->Publish();// 发布数据
+        };
       }
       break;
     case ESensors::OpticalFlowCamera:// 光流相机传感器
       log_info("Sensor OpticalFlowCamera to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size());// 记录光流相机的数据到ROS，输出帧、传感器类型、流ID和缓冲区大小
-      {
-        auto sensors = GetOrCreateSensor(ESensors::OpticalFlowCamera, stream_id, actor);// 获取或创建光流相机传感器
-        if (sensors.first) { // 如果第一个传感器存在
-          std::shared_ptr<CarlaOpticalFlowCameraPublisher> publisher = std::dynamic_pointer_cast<CarlaOpticalFlowCameraPublisher>(sensors.first);// 转换为光流相机发布者
-          const carla::sensor::s11n::OpticalFlowImageSerializer::ImageHeader *header =// 获取图像头信息
-            reinterpret_cast<const carla::sensor::s11n::OpticalFlowImageSerializer::ImageHeader *>(buffer->data());
-          if (!header) // 如果没有图像头，返回
-            return;
-          if (!publisher->HasBeenInitialized())// 如果发布者尚未初始化
-            publisher->InitInfoData(0, 0, H, W, Fov, true);// 初始化信息数据
-          publisher->SetImageData(_seconds, _nanoseconds, header->height, header->width, (const float*) (buffer->data() + carla::sensor::s11n::OpticalFlowImageSerializer::header_offset));// 设置图像数据
-          publisher->SetCameraInfoData(_seconds, _nanoseconds);
-          publisher->Publish();// 发布数据
-        }
-        if (sensors.second) {// 如果第二个传感器存在
-          std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 转换为变换发布者
-          publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置位置信息和旋转信息
-          publisher->Publish();// 发布数据
-        }
-      }
+      sensors = GetOrCreateSensor(ESensors::OpticalFlowCamera, stream_id, actor);// 获取或创建光流相机传感器
+      if (sensors.first)
+        task = MakeCameraTask<CarlaOpticalFlowCameraPublisher, s11n::OpticalFlowImageSerializer, float>(sensors.first, buffer, W, H, Fov, _seconds, _nanoseconds);
       break;
     case ESensors::RssSensor:// RSS传感器
       log_info("Sensor RssSensor to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size()); // 记录RSS传感器的数据到ROS，输出帧、传感器类型、流ID和缓冲区大小
-      break;
+      return;
     case ESensors::SceneCaptureCamera:// 场景捕捉相机传感器
-    {
       log_info("Sensor SceneCaptureCamera to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size());// 记录场景捕捉相机的数据到ROS，输出帧、传感器类型、流ID和缓冲区大小
-      {
-        auto sensors = GetOrCreateSensor(ESensors::SceneCaptureCamera, stream_id, actor);// 获取或创建场景捕捉相机传感器
-        if (sensors.first) {// 如果第一个传感器存在
-          std::shared_ptr<CarlaRGBCameraPublisher> publisher = std::dynamic_pointer_cast<CarlaRGBCameraPublisher>(sensors.first);// 设置图像数据
-          const carla::sensor::s11n::ImageSerializer::ImageHeader *header =// 获取图像头信息
-            reinterpret_cast<const carla::sensor::s11n::ImageSerializer::ImageHeader *>(buffer->data());
-          if (!header)// 如果没有图像头，返回
-            return;
-          if (!publisher->HasBeenInitialized())// 如果发布者尚未初始化
-            publisher->InitInfoData(0, 0, H, W, Fov, true);// 初始化信息数据
-          publisher->SetImageData(_seconds, _nanoseconds, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置图像数据
-          publisher->SetCameraInfoData(_seconds, _nanoseconds);
-          publisher->Publish();// 发布数据
-        }
-        if (sensors.second) {// 如果第二个传感器存在
-          std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 转换为变换发布者
-          publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation); // 设置位置信息和旋转信息
-          publisher->Publish();// 发布数据
-        }
-      }
+      sensors = GetOrCreateSensor(ESensors::SceneCaptureCamera, stream_id, actor);// 获取或创建场景捕捉相机传感器
+      if (sensors.first)
+        task = MakeCameraTask<CarlaRGBCameraPublisher, s11n::ImageSerializer, uint8_t>(sensors.first, buffer, W, H, Fov, _seconds, _nanoseconds);
       break;
-    }
     case ESensors::SemanticSegmentationCamera:// 语义分割相机
       log_info("Sensor SemanticSegmentationCamera to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size());// 记录信息：语义分割相机到ROS数据
-      {
-        auto sensors = GetOrCreateSensor(ESensors::SemanticSegmentationCamera, stream_id, actor);// 获取或创建传感器
-        if (sensors.first) {// 如果第一个传感器存在
-          std::shared_ptr<CarlaSSCameraPublisher> publisher = std::dynamic_pointer_cast<CarlaSSCameraPublisher>(sensors.first);// 转换为语义分割相机发布者
-          const carla::sensor::s11n::ImageSerializer::ImageHeader *header =// 获取图像头信息
-            reinterpret_cast<const carla::sensor::s11n::ImageSerializer::ImageHeader *>(buffer->data());// 从缓冲区中获取数据
-          if (!header) // 如果图像头不存在
-            return;// 返回
-          if (!publisher->HasBeenInitialized())// 如果发布者尚未初始化
-            publisher->InitInfoData(0, 0, H, W, Fov, true);// 初始化信息数据
-          publisher->SetImageData(_seconds, _nanoseconds, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置图像数据
-          publisher->SetCameraInfoData(_seconds, _nanoseconds); // 设置相机信息数据
-          publisher->Publish();// 发布数据
-        }
-        if (sensors.second) {// 如果第二个传感器存在
-          std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 转换为变换发布者
-          publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置位置信息和旋转信息
-          publisher->Publish();// 发布数据
-        }
-      }
-      break;// 结束该case
+      sensors = GetOrCreateSensor(ESensors::SemanticSegmentationCamera, stream_id, actor);// 获取或创建传感器
+      if (sensors.first)
+        task = MakeCameraTask<CarlaSSCameraPublisher, s11n::ImageSerializer, uint8_t>(sensors.first, buffer, W, H, Fov, _seconds, _nanoseconds);
+      break;
     case ESensors::InstanceSegmentationCamera:// 实例分割相机
       log_info("Sensor InstanceSegmentationCamera to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size());// 记录信息：实例分割相机到ROS数据
-      {
-        auto sensors = GetOrCreateSensor(ESensors::InstanceSegmentationCamera, stream_id, actor);// 获取或创建传感器
-        if (sensors.first) { // 如果第一个传感器存在
-          std::shared_ptr<CarlaISCameraPublisher> publisher = std::dynamic_pointer_cast<CarlaISCameraPublisher>(sensors.first);// 转换为实例分割相机发布者
-          const carla::sensor::s11n::ImageSerializer::ImageHeader *header =// 获取图像头信息
-            reinterpret_cast<const carla::sensor::s11n::ImageSerializer::ImageHeader *>(buffer->data());// 从缓冲区中获取数据
-          if (!header)// 如果图像头不存在
-            return;// 返回
-          if (!publisher->HasBeenInitialized())// 如果发布者尚未初始化
-            publisher->InitInfoData(0, 0, H, W, Fov, true);// 初始化信息数据
-          publisher->SetImageData(_seconds, _nanoseconds, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置图像数据
-          publisher->SetCameraInfoData(_seconds, _nanoseconds);// 设置相机信息数据
-          publisher->Publish();// 发布数据
-        }
-        if (sensors.second) { // 如果第二个传感器存在
-          std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 转换为变换发布者
-          publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置位置信息和旋转信息
-          publisher->Publish();// 发布数据
-        }
-      }
-      break;// 结束该case
+      sensors = GetOrCreateSensor(ESensors::InstanceSegmentationCamera, stream_id, actor);// 获取或创建传感器
+      if (sensors.first)
+        task = MakeCameraTask<CarlaISCameraPublisher, s11n::ImageSerializer, uint8_t>(sensors.first, buffer, W, H, Fov, _seconds, _nanoseconds);
+      break;
     case ESensors::WorldObserver:// 世界观察者
       log_info("Sensor WorldObserver to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size());// 记录信息：世界观察者到ROS数据
-      break;// 结束该case
+      return;
     case ESensors::CameraGBufferUint8:// 相机G缓冲区（无符号8位）
       log_info("Sensor CameraGBufferUint8 to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size()); // 记录信息：相机G缓冲区（无符号8位）到ROS数据
-      break;// 结束该case
+      return;
     case ESensors::CameraGBufferFloat:// 相机G缓冲区（浮点型）
       log_info("Sensor CameraGBufferFloat to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size());// 记录信息：相机G缓冲区（浮点型）到ROS数据
-      break;// 结束该case
+      return;
     default:// 默认情况
       log_info("Sensor to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size());// 记录信息：传感器到ROS数据
+      return;
+  }
+  if (task) {
+    PublishSensorData(actor, std::move(task));
+  }
+  if (sensors.second) {// 如果存在变换发布者
+    PublishTransform(actor, sensors.second, sensor_transform);
   }
 }
 
@@ -671,13 +656,16 @@ void ROS2::ProcessDataFromGNSS(
   auto sensors = GetOrCreateSensor(ESensors::GnssSensor, stream_id, actor);// 获取或创建传感器
   if (sensors.first) { // 如果存在第一个传感器
     std::shared_ptr<CarlaGNSSPublisher> publisher = std::dynamic_pointer_cast<CarlaGNSSPublisher>(sensors.first); // 将传感器转换为GNSS发布者
-    publisher->SetData(_seconds, _nanoseconds, reinterpret_cast<const double*>(&data)); // 设置数据
-    publisher->Publish(); // 发布数据
+    const int32_t seconds = _seconds;
+    const uint32_t nanoseconds = _nanoseconds;
+    const carla::geom::GeoLocation location = data;
+    PublishSensorData(actor, [=]() {
+      publisher->SetData(seconds, nanoseconds, reinterpret_cast<const double*>(&location)); // 设置数据
+      return publisher->Publish(); // 发布数据
+    });
   }
   if (sensors.second) { // 如果存在第二个传感器
-    std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 将传感器转换为变换发布者
-    publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置变换数据
-    publisher->Publish();// 发布变换数据
+    PublishTransform(actor, sensors.second, sensor_transform);
   }
 }
 
@@ -693,13 +681,15 @@ void ROS2::ProcessDataFromIMU(
   auto sensors = GetOrCreateSensor(ESensors::InertialMeasurementUnit, stream_id, actor);// 获取或创建传感器
   if (sensors.first) {// 如果存在第一个传感器
     std::shared_ptr<CarlaIMUPublisher> publisher = std::dynamic_pointer_cast<CarlaIMUPublisher>(sensors.first);// 将传感器转换为IMU发布者
-    publisher->SetData(_seconds, _nanoseconds, reinterpret_cast<float*>(&accelerometer), reinterpret_cast<float*>(&gyroscope), compass);// 设置数据
-    publisher->Publish(); // 发布数据
+    const int32_t seconds = _seconds;
+    const uint32_t nanoseconds = _nanoseconds;
+    PublishSensorData(actor, [=]() mutable {
+      publisher->SetData(seconds, nanoseconds, reinterpret_cast<float*>(&accelerometer), reinterpret_cast<float*>(&gyroscope), compass);// 设置数据
+      return publisher->Publish(); // 发布数据
+    });
   }
   if (sensors.second) {// 如果存在第二个传感器
-    std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 将传感器转换为变换发布者
-    publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置变换数据
-    publisher->Publish();// 发布变换数据
+    PublishTransform(actor, sensors.second, sensor_transform);
   }
 }
 
@@ -714,22 +704,24 @@ void ROS2::ProcessDataFromDVS(
   auto sensors = GetOrCreateSensor(ESensors::DVSCamera, stream_id, actor);// 获取或创建传感器
   if (sensors.first) { // 如果存在第一个传感器
     std::shared_ptr<CarlaDVSCameraPublisher> publisher = std::dynamic_pointer_cast<CarlaDVSCameraPublisher>(sensors.first);// 将传感器转换为DVS相机发布者
-    const carla::sensor::s11n::ImageSerializer::ImageHeader *header =// 图像头信息
-      reinterpret_cast<const carla::sensor::s11n::ImageSerializer::ImageHeader *>(buffer->data());// 从缓冲区获取头部
-    if (!header)// 如果头部为空
-      return; // 退出
-    if (!publisher->HasBeenInitialized())  // 如果发布者尚未初始化
-      publisher->InitInfoData(0, 0, H, W, Fov, true);// 初始化信息数据
-    size_t elements = (buffer->size() - carla::sensor::s11n::ImageSerializer::header_offset) / sizeof(carla::sensor::data::DVSEvent);// 计算元素数量
-    publisher->SetImageData(_seconds, _nanoseconds, elements, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置图像数据
-    publisher->SetCameraInfoData(_seconds, _nanoseconds);// 设置相机信息数据
-    publisher->SetPointCloudData(1, elements * sizeof(carla::sensor::data::DVSEvent), elements, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置点云数据
-    publisher->Publish();// 发布数据
+    const int32_t seconds = _seconds;
+    const uint32_t nanoseconds = _nanoseconds;
+    PublishSensorData(actor, [=]() {
+      const carla::sensor::s11n::ImageSerializer::ImageHeader *header =// 图像头信息
+        reinterpret_cast<const carla::sensor::s11n::ImageSerializer::ImageHeader *>(buffer->data());// 从缓冲区获取头部
+      if (!header)// 如果头部为空
+        return false; // 退出
+      if (!publisher->HasBeenInitialized())  // 如果发布者尚未初始化
+        publisher->InitInfoData(0, 0, H, W, Fov, true);// 初始化信息数据
+      size_t elements = (buffer->size() - carla::sensor::s11n::ImageSerializer::header_offset) / sizeof(carla::sensor::data::DVSEvent);// 计算元素数量
+      publisher->SetImageData(seconds, nanoseconds, elements, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置图像数据
+      publisher->SetCameraInfoData(seconds, nanoseconds);// 设置相机信息数据
+      publisher->SetPointCloudData(1, elements * sizeof(carla::sensor::data::DVSEvent), elements, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));// 设置点云数据
+      return publisher->Publish();// 发布数据
+    });
   }
   if (sensors.second) { // 如果存在第二个传感器
-    std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 将传感器转换为变换发布者
-    publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置变换数据
-    publisher->Publish();// 发布变换数据
+    PublishTransform(actor, sensors.second, sensor_transform);
   }
 }
 
@@ -743,15 +735,19 @@ void ROS2::ProcessDataFromLidar(
   auto sensors = GetOrCreateSensor(ESensors::RayCastLidar, stream_id, actor);// 获取或创建传感器
   if (sensors.first) {// 如果存在第一个传感器
     std::shared_ptr<CarlaLidarPublisher> publisher = std::dynamic_pointer_cast<CarlaLidarPublisher>(sensors.first);// 将传感器转换为激光雷达发布者
-    size_t width = data._points.size();// 获取点云宽度
-    size_t height = 1;// 设置高度为1
-    publisher->SetData(_seconds, _nanoseconds, height, width, (float*)data._points.data());// 设置数据
-    publisher->Publish();// 发布数据
+    const int32_t seconds = _seconds;
+    const uint32_t nanoseconds = _nanoseconds;
+    // 激光雷达在下一帧会复用 data，这里只做一次复制，其余工作都在发布线程上
+    auto points = std::make_shared<std::vector<float>>(data._points);
+    PublishSensorData(actor, [=]() {
+      size_t width = points->size();// 获取点云宽度
+      size_t height = 1;// 设置高度为1
+      publisher->SetData(seconds, nanoseconds, height, width, points->data());// 设置数据
+      return publisher->Publish();// 发布数据
+    });
   }
   if (sensors.second) {// 如果存在第二个传感器
-    std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 将传感器转换为变换发布者
-    publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置变换数据
-    publisher->Publish();// 发布变换数据
+    PublishTransform(actor, sensors.second, sensor_transform);
   }
 }
 
@@ -766,15 +762,18 @@ void ROS2::ProcessDataFromSemanticLidar(
   auto sensors = GetOrCreateSensor(ESensors::RayCastSemanticLidar, stream_id, actor);// 获取或创建传感器
   if (sensors.first) {// 如果传感器存在
     std::shared_ptr<CarlaSemanticLidarPublisher> publisher = std::dynamic_pointer_cast<CarlaSemanticLidarPublisher>(sensors.first);// 动态转换到CarlaSemanticLidarPublisher
-    size_t width = data._ser_points.size();// 点的数量
-    size_t height = 1; // 高度设为1
-    publisher->SetData(_seconds, _nanoseconds, 6, height, width, (float*)data._ser_points.data());// 设置数据
-    publisher->Publish();// 发布数据
+    const int32_t seconds = _seconds;
+    const uint32_t nanoseconds = _nanoseconds;
+    auto points = std::make_shared<std::vector<carla::sensor::data::SemanticLidarDetection>>(data._ser_points);
+    PublishSensorData(actor, [=]() {
+      size_t width = points->size();// 点的数量
+      size_t height = 1; // 高度设为1
+      publisher->SetData(seconds, nanoseconds, 6, height, width, (float*)points->data());// 设置数据
+      return publisher->Publish();// 发布数据
+    });
   }
   if (sensors.second) {// 如果第二个传感器存在
-    std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 动态转换到CarlaTransformPublisher
-    publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation); // 设置变换数据
-    publisher->Publish();// 发布变换数据
+    PublishTransform(actor, sensors.second, sensor_transform);
   }
 }
 
@@ -788,16 +787,19 @@ void ROS2::ProcessDataFromRadar(
   auto sensors = GetOrCreateSensor(ESensors::Radar, stream_id, actor); // 获取或创建传感器
   if (sensors.first) {// 如果传感器存在
     std::shared_ptr<CarlaRadarPublisher> publisher = std::dynamic_pointer_cast<CarlaRadarPublisher>(sensors.first);// 动态转换到CarlaRadarPublisher
-    size_t elements = data.GetDetectionCount();// 获取检测数量
-    size_t width = elements * sizeof(carla::sensor::data::RadarDetection); // 计算宽度
-    size_t height = 1;// 高度设为1
-    publisher->SetData(_seconds, _nanoseconds, height, width, elements, (const uint8_t*)data._detections.data()); // 设置数据
-    publisher->Publish();// 发布数据
+    const int32_t seconds = _seconds;
+    const uint32_t nanoseconds = _nanoseconds;
+    auto detections = std::make_shared<std::vector<carla::sensor::data::RadarDetection>>(data._detections);
+    PublishSensorData(actor, [=]() {
+      size_t elements = detections->size();// 获取检测数量
+      size_t width = elements * sizeof(carla::sensor::data::RadarDetection); // 计算宽度
+      size_t height = 1;// 高度设为1
+      publisher->SetData(seconds, nanoseconds, height, width, elements, (const uint8_t*)detections->data()); // 设置数据
+      return publisher->Publish();// 发布数据
+    });
   }
   if (sensors.second) { // 如果第二个传感器存在
-    std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 动态转换到CarlaTransformPublisher
-    publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置变换数据
-    publisher->Publish(); // 发布变换数据
+    PublishTransform(actor, sensors.second, sensor_transform);
   }
 }
 
@@ -822,17 +824,25 @@ void ROS2::ProcessDataFromCollisionSensor(
   auto sensors = GetOrCreateSensor(ESensors::CollisionSensor, stream_id, actor); // 获取或创建传感器
   if (sensors.first) {// 如果传感器存在
     std::shared_ptr<CarlaCollisionPublisher> publisher = std::dynamic_pointer_cast<CarlaCollisionPublisher>(sensors.first);// 动态转换到CarlaCollisionPublisher
-    publisher->SetData(_seconds, _nanoseconds, other_actor, impulse.x, impulse.y, impulse.z);// 设置碰撞数据
-    publisher->Publish();
+    const int32_t seconds = _seconds;
+    const uint32_t nanoseconds = _nanoseconds;
+    PublishSensorData(actor, [=]() {
+      publisher->SetData(seconds, nanoseconds, other_actor, impulse.x, impulse.y, impulse.z);// 设置碰撞数据
+      return publisher->Publish();
+    });
   }
   if (sensors.second) {// 如果第二个传感器存在
-    std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);// 动态转换到CarlaTransformPublisher
-    publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);// 设置变换数据
-    publisher->Publish();// 发布变换数据
+    PublishTransform(actor, sensors.second, sensor_transform);
   }
 }
 
 void ROS2::Shutdown() {// 关闭
+  // 先发布完已入队的数据，任务中持有的发布者随之释放
+  _publish_queue.Stop();
+  for (auto& element : _topic_stats) {
+    LogPublishStats(element.first);
+  }
+  _topic_stats.clear();
   for (auto& element : _publishers) {// 遍历发布者
     element.second.reset();// 重置发布者
   }
@@ -10,11 +10,13 @@
 #include "carla/BufferView.h" // 引入 Carla 缓冲区视图头文件
 #include "carla/geom/Transform.h" // 引入 Carla 变换几何头文件
 #include "carla/ros2/ROS2CallbackData.h" // 引入 ROS2 回调数据头文件
+#include "carla/ros2/ROS2PublishQueue.h" // 引入 ROS2 发布队列头文件
 #include "carla/streaming/detail/Types.h" // 引入 Carla 流媒体类型头文件
 
 #include <unordered_set> // 引入无序集合头文件
 #include <unordered_map> // 引入无序映射头文件
 #include <memory> // 引入智能指针头文件
+#include <string> // 引入字符串头文件
 #include <vector> // 引入向量头文件
 
 // 前置声明
@@ -42,6 +44,13 @@ namespace ros2 {
   class CarlaClockPublisher; // 声明 CarlaClockPublisher 类
   class CarlaEgoVehicleControlSubscriber; // 声明 CarlaEgoVehicleControlSubscriber 类
 
+  /// 一个传感器的数据话题与变换话题的发布统计。
+  struct ROS2TopicStatsEntry {
+    std::string name;
+    std::shared_ptr<ROS2TopicStats> sensor;
+    std::shared_ptr<ROS2TopicStats> transform;
+  };
+
 class ROS2
 {
   public:
@@ -141,8 +150,18 @@ class ROS2
       carla::geom::Vector3D impulse, // 冲击力
       void* actor); // 当前 Actor
 
+  /// 传感器数据话题的发布计数与延迟，传感器还没有发布过数据时返回 nullptr。
+  std::shared_ptr<const ROS2TopicStats> GetSensorPublishStats(void *actor) const;
+
+  /// 把传感器两个话题的发布统计写入日志。
+  void LogPublishStats(void *actor) const;
+
  private: // 私有成员
  std::pair<std::shared_ptr<CarlaPublisher>, std::shared_ptr<CarlaTransformPublisher>> GetOrCreateSensor(int type, carla::streaming::detail::stream_id_type id, void* actor); // 获取或创建传感器
+ ROS2TopicStatsEntry &GetOrCreateTopicStats(void *actor); // 获取或创建发布统计
+ // 把发布任务交给发布线程，仿真线程上只复制必要的数据
+ void PublishSensorData(void *actor, ROS2PublishQueue::Task task);
+ void PublishTransform(void *actor, std::shared_ptr<CarlaTransformPublisher> publisher, const carla::geom::Transform &sensor_transform);
 
 // 单例
 ROS2() {}; // 构造函数
@@ -161,6 +180,8 @@ std::unordered_map<void *, std::shared_ptr<CarlaPublisher>> _publishers; // 发
 std::unordered_map<void *, std::shared_ptr<CarlaTransformPublisher>> _transforms; // 变换发布者映射
 std::unordered_set<carla::streaming::detail::stream_id_type> _publish_stream; // 发布流集合
 std::unordered_map<void *, ActorCallback> _actor_callbacks; // Actor 回调映射
+std::unordered_map<void *, ROS2TopicStatsEntry> _topic_stats; // 每个传感器的发布统计
+ROS2PublishQueue _publish_queue; // 发布线程与任务队列
 };
 
 } // namespace ros2
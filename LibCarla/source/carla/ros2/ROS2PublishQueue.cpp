@@ -0,0 +1,164 @@
+// Copyright (c) 2023 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/ros2/ROS2PublishQueue.h"
+
+namespace carla {
+namespace ros2 {
+
+  static size_t RoundUpToPowerOfTwo(size_t value) {
+    size_t result = 2u;
+    while (result < value) {
+      result <<= 1u;
+    }
+    return result;
+  }
+
+  ROS2PublishQueue::ROS2PublishQueue(size_t capacity)
+    : _cells(RoundUpToPowerOfTwo(capacity)),
+      _mask(_cells.size() - 1u) {
+    for (size_t i = 0u; i < _cells.size(); ++i) {
+      _cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  ROS2PublishQueue::~ROS2PublishQueue() {
+    Stop();
+  }
+
+  void ROS2PublishQueue::Start() {
+    if (IsRunning()) {
+      return;
+    }
+    _stop = false;
+    _thread = std::thread([this]() { Run(); });
+  }
+
+  void ROS2PublishQueue::Stop() {
+    if (!IsRunning()) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _wake_up.notify_one();
+    _thread.join();
+  }
+
+  bool ROS2PublishQueue::Push(Task task, std::shared_ptr<ROS2TopicStats> stats) {
+    // 有界多生产者队列：每个槽位的序号表示它当前可写还是可读。
+    size_t position = _enqueue_position.load(std::memory_order_relaxed);
+    Cell *cell = nullptr;
+    for (;;) {
+      cell = &_cells[position & _mask];
+      const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      const auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+      if (difference == 0) {
+        if (_enqueue_position.compare_exchange_weak(position, position + 1u, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (difference < 0) {
+        // 队列已满。
+        if (stats != nullptr) {
+          stats->dropped.fetch_add(1u, std::memory_order_relaxed);
+        }
+        return false;
+      } else {
+        position = _enqueue_position.load(std::memory_order_relaxed);
+      }
+    }
+    cell->task = std::move(task);
+    cell->stats = std::move(stats);
+    cell->enqueued = clock::now();
+    cell->sequence.store(position + 1u, std::memory_order_release);
+
+    // 与 Run() 中的栅栏配对：要么发布线程看到新任务，要么这里看到它已休眠。
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_sleeping.load(std::memory_order_relaxed)) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _wake_up.notify_one();
+    }
+    return true;
+  }
+
+  bool ROS2PublishQueue::TryPop(Cell &out) {
+    size_t position = _dequeue_position.load(std::memory_order_relaxed);
+    Cell *cell = nullptr;
+    for (;;) {
+      cell = &_cells[position & _mask];
+      const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      const auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1u);
+      if (difference == 0) {
+        if (_dequeue_position.compare_exchange_weak(position, position + 1u, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (difference < 0) {
+        return false;
+      } else {
+        position = _dequeue_position.load(std::memory_order_relaxed);
+      }
+    }
+    out.task = std::move(cell->task);
+    out.stats = std::move(cell->stats);
+    out.enqueued = cell->enqueued;
+    cell->task = nullptr;
+    cell->sequence.store(position + _mask + 1u, std::memory_order_release);
+    return true;
+  }
+
+  void ROS2PublishQueue::RunOne(Cell &item) {
+    const bool success = item.task();
+    if (item.stats != nullptr) {
+      const auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - item.enqueued);
+      item.stats->AddLatency(static_cast<uint64_t>(latency.count()));
+      (success ? item.stats->published : item.stats->failed).fetch_add(1u, std::memory_order_relaxed);
+    }
+    item.task = nullptr;
+    item.stats.reset();
+    _completed.fetch_add(1u, std::memory_order_release);
+  }
+
+  void ROS2PublishQueue::Run() {
+    Cell item;
+    for (;;) {
+      if (TryPop(item)) {
+        RunOne(item);
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(_mutex);
+      _flushed.notify_all();
+      if (_stop) {
+        break;
+      }
+      _sleeping.store(true, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      _wake_up.wait(lock, [this]() {
+        const size_t position = _dequeue_position.load(std::memory_order_relaxed);
+        const size_t sequence = _cells[position & _mask].sequence.load(std::memory_order_acquire);
+        return _stop || sequence == position + 1u;
+      });
+      _sleeping.store(false, std::memory_order_relaxed);
+    }
+  }
+
+  void ROS2PublishQueue::Flush() {
+    if (!IsRunning()) {
+      Cell item;
+      while (TryPop(item)) {
+        RunOne(item);
+      }
+      return;
+    }
+    const size_t target = _enqueue_position.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> lock(_mutex);
+    _flushed.wait(lock, [&]() {
+      return _completed.load(std::memory_order_acquire) >= target;
+    });
+  }
+
+} // namespace ros2
+} // namespace carla
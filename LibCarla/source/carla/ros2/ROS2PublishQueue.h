@@ -0,0 +1,127 @@
+// Copyright (c) 2023 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace carla {
+namespace ros2 {
+
+  /// 单个话题的发布计数与延迟（从入队到发布完成），由发布线程更新，
+  /// 任何线程都可以读取。
+  struct ROS2TopicStats {
+    std::atomic<uint64_t> published{0u};
+    std::atomic<uint64_t> dropped{0u};
+    std::atomic<uint64_t> failed{0u};
+    std::atomic<uint64_t> total_latency_ns{0u};
+    std::atomic<uint64_t> last_latency_ns{0u};
+    std::atomic<uint64_t> max_latency_ns{0u};
+
+    void AddLatency(uint64_t latency_ns) {
+      total_latency_ns.fetch_add(latency_ns, std::memory_order_relaxed);
+      last_latency_ns.store(latency_ns, std::memory_order_relaxed);
+      auto max = max_latency_ns.load(std::memory_order_relaxed);
+      while (latency_ns > max &&
+             !max_latency_ns.compare_exchange_weak(max, latency_ns, std::memory_order_relaxed)) {}
+    }
+
+    double GetAverageLatencyMs() const {
+      const auto count = published.load(std::memory_order_relaxed) + failed.load(std::memory_order_relaxed);
+      return count == 0u ? 0.0 :
+          1e-6 * static_cast<double>(total_latency_ns.load(std::memory_order_relaxed)) / static_cast<double>(count);
+    }
+  };
+
+  /// 在独立线程上执行 ROS2 发布任务。
+  ///
+  /// 传感器在仿真线程（或渲染线程）上只把任务放入一个定长的无锁多生产者
+  /// 队列，序列化与 DDS 写入都在发布线程上完成。队列满时丢弃新任务并计入
+  /// 对应话题的 dropped，仿真线程永远不会因为 ROS2 订阅方变慢而阻塞。
+  class ROS2PublishQueue : private NonCopyable {
+  public:
+
+    /// 发布任务，返回 false 表示发布失败。
+    using Task = std::function<bool()>;
+
+    /// @a capacity 会被向上取整为 2 的幂。
+    explicit ROS2PublishQueue(size_t capacity = 256u);
+
+    ~ROS2PublishQueue();
+
+    /// 启动发布线程，重复调用没有影响。
+    void Start();
+
+    /// 执行完已入队的任务后停止发布线程。
+    void Stop();
+
+    bool IsRunning() const {
+      return _thread.joinable();
+    }
+
+    /// 放入一个任务；队列已满时丢弃任务并返回 false。
+    bool Push(Task task, std::shared_ptr<ROS2TopicStats> stats = nullptr);
+
+    /// 等待当前已入队的任务全部执行完毕，发布线程未启动时在调用线程上执行。
+    void Flush();
+
+    size_t GetCapacity() const {
+      return _cells.size();
+    }
+
+  private:
+
+    using clock = std::chrono::steady_clock;
+
+    struct Cell {
+      std::atomic<size_t> sequence{0u};
+      Task task;
+      std::shared_ptr<ROS2TopicStats> stats;
+      clock::time_point enqueued;
+    };
+
+    bool TryPop(Cell &out);
+
+    void Run();
+
+    void RunOne(Cell &item);
+
+    std::vector<Cell> _cells;
+
+    const size_t _mask;
+
+    alignas(64) std::atomic<size_t> _enqueue_position{0u};
+
+    alignas(64) std::atomic<size_t> _dequeue_position{0u};
+
+    /// 已执行完毕的任务数，Flush 据此等待。
+    std::atomic<size_t> _completed{0u};
+
+    std::atomic<bool> _sleeping{false};
+
+    std::atomic<bool> _stop{false};
+
+    std::mutex _mutex;
+
+    std::condition_variable _wake_up;
+
+    std::condition_variable _flushed;
+
+    std::thread _thread;
+  };
+
+} // namespace ros2
+} // namespace carla
@@ -461,10 +461,10 @@ namespace ros2 {
  * @param width 图像的宽度
  * @param data 指向图像数据的指针，数据格式为BGRA，每个像素4个字节
  */
-  void CarlaDepthCameraPublisher::SetImageData(int32_t seconds, uint32_t nanoseconds, size_t height, size_t width, const uint8_t* data) {    std::vector<uint8_t> vector_data;
-    const size_t size = height * width * 4;
-    vector_data.resize(size);
-    std::memcpy(&vector_data[0], &data[0], size);
+  void CarlaDepthCameraPublisher::SetImageData(int32_t seconds, uint32_t nanoseconds, size_t height, size_t width, const uint8_t* data) {
+    // 复用上一帧消息的缓冲区，避免每帧重新分配
+    std::vector<uint8_t> vector_data = std::move(_impl->_image.data());
+    vector_data.assign(data, data + height * width * 4);
     SetData(seconds, nanoseconds,height, width, std::move(vector_data));
   }
   /**
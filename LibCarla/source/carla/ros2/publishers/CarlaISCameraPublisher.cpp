@@ -290,10 +290,9 @@ namespace ros2 {
   }
 
   void CarlaISCameraPublisher::SetImageData(int32_t seconds, uint32_t nanoseconds, size_t height, size_t width, const uint8_t* data) {
-    std::vector<uint8_t> vector_data;
-    const size_t size = height * width * 4;
-    vector_data.resize(size);
-    std::memcpy(&vector_data[0], &data[0], size);
+    // 复用上一帧消息的缓冲区，避免每帧重新分配
+    std::vector<uint8_t> vector_data = std::move(_impl->_image.data());
+    vector_data.assign(data, data + height * width * 4);
     SetData(seconds, nanoseconds, height, width, std::move(vector_data));
   }
 
@@ -229,15 +229,16 @@ namespace ros2 {
  * @param data 指向浮点数据数组的指针
  */
 void CarlaLidarPublisher::SetData(int32_t seconds, uint32_t nanoseconds, size_t height, size_t width, float* data) {
-    float* it = data;
-    float* end = &data[height * width];
-    for (++it; it < end; it += 4) {
-        *it *= -1.0f;// 将y值取反（假设data[1]是y值）
-    }
-    std::vector<uint8_t> vector_data;
+    // 复用上一帧消息的缓冲区，并在副本上取反，不修改调用方的数据
+    std::vector<uint8_t> vector_data = std::move(_impl->_lidar.data());
     const size_t size = height * width * sizeof(float);
     vector_data.resize(size);
     std::memcpy(&vector_data[0], &data[0], size);// 将浮点数据复制到字节向量中
+    float* it = reinterpret_cast<float*>(vector_data.data());
+    float* end = it + height * width;
+    for (++it; it < end; it += 4) {
+        *it *= -1.0f;// 将y值取反（假设data[1]是y值）
+    }
     // 调用重载的SetData函数来设置处理后的数据
     SetData(seconds, nanoseconds, height, width, std::move(vector_data));
   }
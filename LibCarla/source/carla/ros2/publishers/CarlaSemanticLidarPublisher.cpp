@@ -204,22 +204,20 @@ namespace ros2 {
  * @param data 指向浮点数据数组的指针，这些数据将被处理并用于设置激光雷达数据
  */
 void CarlaSemanticLidarPublisher::SetData(int32_t seconds, uint32_t nanoseconds, size_t elements, size_t height, size_t width, float* data) {
-    // 指向数据起始位置的迭代器
-    float* it = data;
-    // 指向数据结束位置的迭代器
-    float* end = &data[height * width * elements];
-    // 遍历数据（除了第一个元素），将每个元素乘以-1
-    for (++it; it < end; it += elements) {
-        *it *= -1.0f;
-    }
-    // 用于存储转换后的字节数据的向量
-    std::vector<uint8_t> vector_data;
+    // 用于存储转换后的字节数据的向量，复用上一帧消息的缓冲区
+    std::vector<uint8_t> vector_data = std::move(_impl->_lidar.data());
     // 计算需要存储的字节数据的大小
     const size_t size = height * width * sizeof(float) * elements;
     // 调整向量的大小以匹配数据大小
     vector_data.resize(size);
     // 将浮点数据复制到字节数据向量中
     std::memcpy(&vector_data[0], &data[0], size);
+    // 在副本上遍历数据（除了第一个元素），将每个元素乘以-1，不修改调用方的数据
+    float* it = reinterpret_cast<float*>(vector_data.data());
+    float* end = it + height * width * elements;
+    for (++it; it < end; it += elements) {
+        *it *= -1.0f;
+    }
     // 调用另一个重载的SetData函数来设置处理后的数据
     SetData(seconds, nanoseconds, height, width, std::move(vector_data));
 }
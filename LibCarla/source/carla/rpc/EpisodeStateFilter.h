@@ -0,0 +1,85 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+#include "carla/geom/BoundingBox.h"
+#include "carla/rpc/ActorId.h"
+
+#include <cmath>
+#include <vector>
+
+namespace carla {
+namespace rpc {
+
+  /// 过滤后的仿真状态流只包含满足以下任一条件的参与者：
+  ///
+  ///   - 与参与者 @a actor_id 的距离不超过 @a radius（米），
+  ///   - 位于区域 @a region 内（世界坐标，仅当 @a use_region 为 true），
+  ///   - id 在 @a actor_ids 中。
+  ///
+  /// 条件可以组合，例如以自车为中心的半径加上一组固定的交通灯。
+  class EpisodeStateFilter {
+  public:
+
+    ActorId actor_id = 0u;
+
+    float radius = 0.0f;
+
+    bool use_region = false;
+
+    geom::BoundingBox region;
+
+    std::vector<ActorId> actor_ids;
+
+    static EpisodeStateFilter AroundActor(ActorId id, float radius) {
+      EpisodeStateFilter filter;
+      filter.actor_id = id;
+      filter.radius = radius;
+      return filter;
+    }
+
+    static EpisodeStateFilter InsideRegion(const geom::BoundingBox &region) {
+      EpisodeStateFilter filter;
+      filter.use_region = true;
+      filter.region = region;
+      return filter;
+    }
+
+    static EpisodeStateFilter FromIds(std::vector<ActorId> ids) {
+      EpisodeStateFilter filter;
+      filter.actor_ids = std::move(ids);
+      return filter;
+    }
+
+    bool HasRadius() const {
+      return actor_id != 0u && radius > 0.0f;
+    }
+
+    /// 半径与区域的所有分量都是有限值，且半径与区域的大小不为负。服务器拒绝
+    /// 不满足该条件的过滤器。
+    bool IsValid() const {
+      const auto finite = [](float value) { return std::isfinite(value); };
+      const auto &r = region;
+      return finite(radius) && radius >= 0.0f &&
+          (!use_region || (
+              finite(r.location.x) && finite(r.location.y) && finite(r.location.z) &&
+              finite(r.extent.x) && finite(r.extent.y) && finite(r.extent.z) &&
+              r.extent.x >= 0.0f && r.extent.y >= 0.0f && r.extent.z >= 0.0f &&
+              finite(r.rotation.pitch) && finite(r.rotation.yaw) && finite(r.rotation.roll)));
+    }
+
+    /// 没有任何条件的过滤器不匹配任何参与者。
+    bool IsEmpty() const {
+      return !HasRadius() && !use_region && actor_ids.empty();
+    }
+
+    MSGPACK_DEFINE_ARRAY(actor_id, radius, use_region, region, actor_ids);
+  };
+
+} // namespace rpc
+} // namespace carla
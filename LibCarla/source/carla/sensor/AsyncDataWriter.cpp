@@ -0,0 +1,121 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/sensor/AsyncDataWriter.h"
+
+#include "carla/Logging.h"
+#include "carla/StopWatch.h"
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+
+namespace carla {
+namespace sensor {
+
+  AsyncDataWriter::AsyncDataWriter(
+      size_t worker_threads,
+      size_t max_pending_bytes,
+      OverflowPolicy policy)
+    : _max_pending_bytes(max_pending_bytes),
+      _policy(policy),
+      _worker_count(worker_threads) {
+    if (_worker_count == 0u) {
+      _worker_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    _workers.CreateThreads(_worker_count, [this]() { WorkerLoop(); });
+  }
+
+  AsyncDataWriter::~AsyncDataWriter() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _job_available.notify_all();
+    // 工作线程会先清空队列再退出。
+    _workers.JoinAll();
+  }
+
+  bool AsyncDataWriter::Enqueue(Job job, size_t bytes) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    auto is_full = [&]() {
+      return (_stats.pending_jobs > 0u) &&
+             (_stats.pending_bytes + bytes > _max_pending_bytes);
+    };
+    if (is_full()) {
+      if (_policy == OverflowPolicy::Drop) {
+        ++_stats.dropped_jobs;
+        return false;
+      }
+      StopWatch stop_watch;
+      _job_done.wait(lock, [&]() { return _stop || !is_full(); });
+      _stats.blocked_time_us += stop_watch.GetElapsedTime<std::chrono::microseconds>();
+    }
+    if (_stop) {
+      ++_stats.dropped_jobs;
+      return false;
+    }
+    ++_stats.pending_jobs;
+    _stats.pending_bytes += bytes;
+    _queue.push_back(PendingJob{std::move(job), bytes});
+    lock.unlock();
+    _job_available.notify_one();
+    return true;
+  }
+
+  void AsyncDataWriter::Flush() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _job_done.wait(lock, [this]() { return _stats.pending_jobs == 0u; });
+  }
+
+  AsyncDataWriterStats AsyncDataWriter::GetStats() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+  }
+
+  void AsyncDataWriter::WorkerLoop() {
+    for (;;) {
+      PendingJob pending;
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _job_available.wait(lock, [this]() { return _stop || !_queue.empty(); });
+        if (_queue.empty()) {
+          return; // 已停止且队列为空。
+        }
+        pending = std::move(_queue.front());
+        _queue.pop_front();
+      }
+
+      StopWatch stop_watch;
+      bool succeeded = true;
+      try {
+        pending.job();
+      } catch (const std::exception &e) {
+        log_error("AsyncDataWriter: failed to write sensor data:", e.what());
+        succeeded = false;
+      }
+      const auto elapsed = stop_watch.GetElapsedTime<std::chrono::microseconds>();
+      // 在释放任务持有的数据之后再更新计数，使 pending_bytes 反映真实的内存占用。
+      pending.job = nullptr;
+
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        --_stats.pending_jobs;
+        _stats.pending_bytes -= pending.bytes;
+        _stats.encode_time_us += elapsed;
+        if (succeeded) {
+          ++_stats.written_jobs;
+          _stats.written_bytes += pending.bytes;
+        } else {
+          ++_stats.failed_jobs;
+        }
+      }
+      _job_done.notify_all();
+    }
+  }
+
+} // namespace sensor
+} // namespace carla
@@ -0,0 +1,140 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Exception.h"
+#include "carla/FileSystem.h"
+#include "carla/Memory.h"
+#include "carla/NonCopyable.h"
+#include "carla/ThreadGroup.h"
+#include "carla/pointcloud/PointCloudIO.h"
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+namespace carla {
+namespace sensor {
+
+  /// AsyncDataWriter 的运行统计，所有时间均以微秒计。
+  struct AsyncDataWriterStats {
+    size_t pending_jobs = 0u;     ///< 排队中与正在写入的任务数
+    size_t pending_bytes = 0u;    ///< 上述任务持有的传感器数据字节数
+    size_t written_jobs = 0u;     ///< 已成功写入的任务数
+    size_t written_bytes = 0u;    ///< 已成功写入任务的数据字节数
+    size_t dropped_jobs = 0u;     ///< 因队列已满而被丢弃的任务数
+    size_t failed_jobs = 0u;      ///< 编码或写盘时抛出异常的任务数
+    size_t blocked_time_us = 0u;  ///< 调用方因背压而阻塞的累计时间
+    size_t encode_time_us = 0u;   ///< 工作线程编码与写盘的累计时间
+  };
+
+  /// 异步的传感器数据写盘器。
+  ///
+  /// 任务持有传感器数据的共享指针（即底层 Buffer 的所有权），调用方入队后
+  /// 立即返回，编码（PNG、原始字节、二进制 PLY）与写盘在独立的工作线程池中
+  /// 完成。队列按尚未写完的数据字节数限流：超过上限时按 OverflowPolicy
+  /// 阻塞调用方或丢弃新任务，避免写盘跟不上时内存无限增长。
+  class AsyncDataWriter : private NonCopyable {
+  public:
+
+    /// 队列已满时的处理策略。
+    enum class OverflowPolicy {
+      Block, ///< 阻塞调用方直到有足够空间
+      Drop   ///< 丢弃新任务并计入 dropped_jobs
+    };
+
+    /// 写盘任务，在工作线程中执行，失败时抛出异常。
+    using Job = std::function<void()>;
+
+    /// @param worker_threads 工作线程数，0 表示使用硬件并发数。
+    /// @param max_pending_bytes 排队与写入中数据的字节上限。
+    explicit AsyncDataWriter(
+        size_t worker_threads = 0u,
+        size_t max_pending_bytes = 256u * 1024u * 1024u,
+        OverflowPolicy policy = OverflowPolicy::Block);
+
+    /// 写完所有已入队的任务后再销毁工作线程。
+    ~AsyncDataWriter();
+
+    /// 将任务入队，@a bytes 为任务持有的数据量，用于限流。
+    /// 空闲时总会接受单个超过上限的任务。
+    ///
+    /// @return 任务被丢弃（Drop 策略下队列已满）时返回 false。
+    bool Enqueue(Job job, size_t bytes);
+
+    /// 将数组类传感器数据的原始字节原样写入 @a path。
+    template <typename ArrayT>
+    bool EnqueueRaw(std::string path, SharedPtr<ArrayT> data) {
+      DEBUG_ASSERT(data != nullptr);
+      const size_t bytes = data->size() * sizeof(typename ArrayT::value_type);
+      return Enqueue([path=std::move(path), data=std::move(data), bytes]() mutable {
+        FileSystem::ValidateFilePath(path, "");
+        std::ofstream out(path, std::ios::binary);
+        out.write(reinterpret_cast<const char *>(data->data()), static_cast<std::streamsize>(bytes));
+        if (!out) {
+          throw_exception(std::runtime_error("failed to write " + path));
+        }
+      }, bytes);
+    }
+
+    /// 将点云以二进制 PLY 格式写入 @a path。
+    template <typename ArrayT>
+    bool EnqueuePointCloud(std::string path, SharedPtr<ArrayT> data) {
+      DEBUG_ASSERT(data != nullptr);
+      const size_t bytes = data->size() * sizeof(typename ArrayT::value_type);
+      return Enqueue([path=std::move(path), data=std::move(data)]() {
+        pointcloud::PointCloudIO::SaveToDiskBinary(path, data->data(), data->data() + data->size());
+      }, bytes);
+    }
+
+    /// 阻塞直到所有已入队的任务写完。
+    void Flush();
+
+    AsyncDataWriterStats GetStats() const;
+
+    size_t GetWorkerCount() const {
+      return _worker_count;
+    }
+
+  private:
+
+    struct PendingJob {
+      Job job;
+      size_t bytes;
+    };
+
+    void WorkerLoop();
+
+    const size_t _max_pending_bytes;
+
+    const OverflowPolicy _policy;
+
+    size_t _worker_count;
+
+    mutable std::mutex _mutex;
+
+    /// 有新任务或需要停止时通知工作线程。
+    std::condition_variable _job_available;
+
+    /// 有任务写完时通知被阻塞的生产者与 Flush。
+    std::condition_variable _job_done;
+
+    std::deque<PendingJob> _queue;
+
+    AsyncDataWriterStats _stats;
+
+    bool _stop = false;
+
+    ThreadGroup _workers;
+  };
+
+} // namespace sensor
+} // namespace carla
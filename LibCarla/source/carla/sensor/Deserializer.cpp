@@ -6,12 +6,14 @@
 
 #include "carla/sensor/Deserializer.h"
 
+#include "carla/profiler/Tracer.h"
 #include "carla/sensor/SensorRegistry.h"
 
 namespace carla {
 namespace sensor {
 
   SharedPtr<SensorData> Deserializer::Deserialize(Buffer &&buffer) {
+    CARLA_TRACE_SCOPE("sensor", "Deserialize");
     return SensorRegistry::Deserialize(std::move(buffer));
   }
 
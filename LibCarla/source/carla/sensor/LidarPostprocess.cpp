@@ -0,0 +1,544 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/sensor/LidarPostprocess.h"
+
+#include "carla/Debug.h"
+#include "carla/ThreadGroup.h"
+#include "carla/sensor/data/LidarData.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <thread>
+
+// 与 ColorConversionKernels 相同：GCC/Clang 通过 target 属性单独编译 AVX2
+// 函数并在运行时检测 CPU 支持，MSVC 依据编译选项决定。
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  define LIBCARLA_SENSOR_WITH_X86_SIMD
+#  include <immintrin.h>
+#  if defined(__GNUC__)
+#    define LIBCARLA_SENSOR_TARGET_AVX2 __attribute__((target("avx2")))
+#  else
+#    define LIBCARLA_SENSOR_TARGET_AVX2
+#  endif
+#endif
+
+// 即使以 -mfma 或 -march=native 编译，也不允许将乘加合并为 FMA，否则标量
+// 与向量实现的舍入会不同。
+#if defined(__clang__)
+#  pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#  pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace carla {
+namespace sensor {
+
+  // ===========================================================================
+  // -- 标量实现 -----------------------------------------------------------------
+  // ===========================================================================
+
+  // 与 maxps/minps 的语义一致（包括 NaN 的处理）。
+  static float Max(float a, float b) {
+    return a > b ? a : b;
+  }
+
+  static float Min(float a, float b) {
+    return a < b ? a : b;
+  }
+
+  static uint32_t FloatBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+  }
+
+  static float FloatFromBits(uint32_t bits) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  // 以下多项式来自 Cephes 的 expf/logf，标量与向量版本按相同顺序计算。
+  static constexpr float ExpMin = -87.3f;
+  static constexpr float ExpMax = 88.3f;
+  static constexpr float Log2e = 1.44269504088896341f;
+  static constexpr float Ln2Hi = 0.693359375f;
+  static constexpr float Ln2Lo = -2.12194440e-4f;
+  static constexpr float ExpP0 = 1.9875691500e-4f;
+  static constexpr float ExpP1 = 1.3981999507e-3f;
+  static constexpr float ExpP2 = 8.3334519073e-3f;
+  static constexpr float ExpP3 = 4.1665795894e-2f;
+  static constexpr float ExpP4 = 1.6666665459e-1f;
+  static constexpr float ExpP5 = 5.0000001201e-1f;
+
+  static constexpr float SqrtHalf = 0.707106781186547524f;
+  static constexpr float LogP0 = 7.0376836292e-2f;
+  static constexpr float LogP1 = -1.1514610310e-1f;
+  static constexpr float LogP2 = 1.1676998740e-1f;
+  static constexpr float LogP3 = -1.2420140846e-1f;
+  static constexpr float LogP4 = 1.4249322787e-1f;
+  static constexpr float LogP5 = -1.6668057665e-1f;
+  static constexpr float LogP6 = 2.0000714765e-1f;
+  static constexpr float LogP7 = -2.4999993993e-1f;
+  static constexpr float LogP8 = 3.3333331174e-1f;
+
+  // cos(t) 在 [0, pi/2] 上的泰勒展开，截断误差小于 1e-8。
+  static constexpr float TwoPi = 6.28318530717958648f;
+  static constexpr float CosK0 = 1.0f;
+  static constexpr float CosK1 = -1.0f / 2.0f;
+  static constexpr float CosK2 = 1.0f / 24.0f;
+  static constexpr float CosK3 = -1.0f / 720.0f;
+  static constexpr float CosK4 = 1.0f / 40320.0f;
+  static constexpr float CosK5 = -1.0f / 3628800.0f;
+  static constexpr float CosK6 = 1.0f / 479001600.0f;
+
+  static constexpr float InvTwoPow24 = 1.0f / 16777216.0f;
+  static constexpr uint32_t Golden = 0x9e3779b9u;
+
+  static float Exp(float x) {
+    x = Min(Max(x, ExpMin), ExpMax);
+    const float fx = std::floor(x * Log2e + 0.5f);
+    float r = x - fx * Ln2Hi;
+    r = r - fx * Ln2Lo;
+    const float z = r * r;
+    float p = ExpP0;
+    p = p * r + ExpP1;
+    p = p * r + ExpP2;
+    p = p * r + ExpP3;
+    p = p * r + ExpP4;
+    p = p * r + ExpP5;
+    const float y = p * z + r + 1.0f;
+    const uint32_t n = static_cast<uint32_t>(static_cast<int32_t>(fx) + 127);
+    return y * FloatFromBits(n << 23u);
+  }
+
+  /// 仅用于 (0, 1] 区间内的规格化数。
+  static float Log(float x) {
+    const uint32_t bits = FloatBits(x);
+    float e = static_cast<float>(static_cast<int32_t>(bits >> 23u) - 126);
+    float m = FloatFromBits((bits & 0x807fffffu) | 0x3f000000u);
+    if (m < SqrtHalf) {
+      e = e - 1.0f;
+      m = m + m - 1.0f;
+    } else {
+      m = m - 1.0f;
+    }
+    const float z = m * m;
+    float y = LogP0;
+    y = y * m + LogP1;
+    y = y * m + LogP2;
+    y = y * m + LogP3;
+    y = y * m + LogP4;
+    y = y * m + LogP5;
+    y = y * m + LogP6;
+    y = y * m + LogP7;
+    y = y * m + LogP8;
+    y = y * m;
+    y = y * z;
+    y = y + Ln2Lo * e;
+    y = y - 0.5f * z;
+    float result = m + y;
+    result = result + Ln2Hi * e;
+    return result;
+  }
+
+  /// cos(2 pi u)，u 在 [0, 1) 区间内。利用对称性将角度约减到 [0, pi/2]。
+  static float CosTwoPi(float u) {
+    const float y = std::fabs(u - 0.5f);
+    const float z = Min(y, 0.5f - y);
+    const float t = z * TwoPi;
+    const float t2 = t * t;
+    float c = CosK6;
+    c = c * t2 + CosK5;
+    c = c * t2 + CosK4;
+    c = c * t2 + CosK3;
+    c = c * t2 + CosK2;
+    c = c * t2 + CosK1;
+    c = c * t2 + CosK0;
+    return y < 0.25f ? -c : c;
+  }
+
+  static float UniformOpenZero(uint32_t bits) {
+    return static_cast<float>((bits >> 8u) + 1u) * InvTwoPow24;
+  }
+
+  uint32_t LidarPostprocess::MakeKey(int32_t seed, uint64_t frame) {
+    const uint32_t frame_hash = Hash(static_cast<uint32_t>(frame) ^ Hash(static_cast<uint32_t>(frame >> 32u)));
+    return Hash(static_cast<uint32_t>(seed) ^ frame_hash);
+  }
+
+  float LidarPostprocess::Normal(uint32_t key, uint32_t counter) {
+    const float u1 = UniformOpenZero(Random(key, counter, NoiseRadius));
+    const float u2 = Uniform(key, counter, NoiseAngle);
+    return std::sqrt(-2.0f * Log(u1)) * CosTwoPi(u2);
+  }
+
+  /// 每次调用只计算一次的系数。
+  struct LidarPostprocessCoefficients {
+    explicit LidarPostprocessCoefficients(const LidarPostprocessParams &params)
+      : neg_atten(-params.atmosp_atten_rate),
+        noise_stddev(params.noise_stddev),
+        noise_active(params.noise_stddev > std::numeric_limits<float>::epsilon()),
+        intensity_limit(params.dropoff_intensity_limit),
+        // 点以 alpha * I + beta 的概率保留，I 达到上限时概率为 1。
+        alpha(params.dropoff_intensity_limit > 0.0f ?
+            params.dropoff_at_zero_intensity / params.dropoff_intensity_limit :
+            0.0f),
+        beta(1.0f - params.dropoff_at_zero_intensity) {}
+
+    float neg_atten;
+    float noise_stddev;
+    bool noise_active;
+    float intensity_limit;
+    float alpha;
+    float beta;
+  };
+
+  static size_t ProcessScalar(
+      const LidarPostprocessCoefficients &c,
+      const LidarPostprocess::Matrix &m,
+      const uint32_t key,
+      const float *x,
+      const float *y,
+      const float *z,
+      const size_t begin,
+      const size_t end,
+      const uint32_t first_counter,
+      float *output) {
+    size_t kept = 0u;
+    for (size_t i = begin; i < end; ++i) {
+      float sx = m[0] * x[i] + m[1] * y[i] + m[2] * z[i] + m[3];
+      float sy = m[4] * x[i] + m[5] * y[i] + m[6] * z[i] + m[7];
+      float sz = m[8] * x[i] + m[9] * y[i] + m[10] * z[i] + m[11];
+      const float distance = std::sqrt(sx * sx + sy * sy + sz * sz);
+      const float intensity = Exp(c.neg_atten * distance);
+      const uint32_t counter = first_counter + static_cast<uint32_t>(i);
+
+      if (c.noise_active) {
+        const float noise = LidarPostprocess::Normal(key, counter) * c.noise_stddev;
+        const float scale = distance > 0.0f ? noise / distance : 0.0f;
+        sx = sx + sx * scale;
+        sy = sy + sy * scale;
+        sz = sz + sz * scale;
+      }
+
+      const float u = LidarPostprocess::Uniform(key, counter, LidarPostprocess::IntensityDropOff);
+      if ((intensity > c.intensity_limit) || (u < c.alpha * intensity + c.beta)) {
+        float *point = output + 4u * kept;
+        point[0] = sx;
+        point[1] = sy;
+        point[2] = sz;
+        point[3] = intensity;
+        ++kept;
+      }
+    }
+    return kept;
+  }
+
+  // ===========================================================================
+  // -- AVX2 实现 ----------------------------------------------------------------
+  // ===========================================================================
+
+#ifdef LIBCARLA_SENSOR_WITH_X86_SIMD
+
+  static bool HasAVX2() {
+#if defined(__GNUC__)
+    static const bool result = __builtin_cpu_supports("avx2");
+    return result;
+#elif defined(__AVX2__)
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  LIBCARLA_SENSOR_TARGET_AVX2
+  static inline __m256i HashAVX2(__m256i value) {
+    value = _mm256_xor_si256(value, _mm256_srli_epi32(value, 16));
+    value = _mm256_mullo_epi32(value, _mm256_set1_epi32(0x7feb352d));
+    value = _mm256_xor_si256(value, _mm256_srli_epi32(value, 15));
+    value = _mm256_mullo_epi32(value, _mm256_set1_epi32(static_cast<int>(0x846ca68bu)));
+    value = _mm256_xor_si256(value, _mm256_srli_epi32(value, 16));
+    return value;
+  }
+
+  LIBCARLA_SENSOR_TARGET_AVX2
+  static inline __m256i RandomAVX2(__m256i key, __m256i counter, LidarPostprocess::Stream stream) {
+    const __m256i salt = _mm256_set1_epi32(static_cast<int>(static_cast<uint32_t>(stream) * Golden));
+    return HashAVX2(_mm256_add_epi32(HashAVX2(_mm256_xor_si256(counter, key)), salt));
+  }
+
+  LIBCARLA_SENSOR_TARGET_AVX2
+  static inline __m256 UniformAVX2(__m256i bits) {
+    return _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(bits, 8)), _mm256_set1_ps(InvTwoPow24));
+  }
+
+  LIBCARLA_SENSOR_TARGET_AVX2
+  static inline __m256 UniformOpenZeroAVX2(__m256i bits) {
+    const __m256i value = _mm256_add_epi32(_mm256_srli_epi32(bits, 8), _mm256_set1_epi32(1));
+    return _mm256_mul_ps(_mm256_cvtepi32_ps(value), _mm256_set1_ps(InvTwoPow24));
+  }
+
+  LIBCARLA_SENSOR_TARGET_AVX2
+  static inline __m256 MulAdd(__m256 a, __m256 b, float c) {
+    return _mm256_add_ps(_mm256_mul_ps(a, b), _mm256_set1_ps(c));
+  }
+
+  LIBCARLA_SENSOR_TARGET_AVX2
+  static inline __m256 ExpAVX2(__m256 x) {
+    x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(ExpMin)), _mm256_set1_ps(ExpMax));
+    const __m256 fx = _mm256_floor_ps(MulAdd(x, _mm256_set1_ps(Log2e), 0.5f));
+    __m256 r = _mm256_sub_ps(x, _mm256_mul_ps(fx, _mm256_set1_ps(Ln2Hi)));
+    r = _mm256_sub_ps(r, _mm256_mul_ps(fx, _mm256_set1_ps(Ln2Lo)));
+    const __m256 z = _mm256_mul_ps(r, r);
+    __m256 p = _mm256_set1_ps(ExpP0);
+    p = MulAdd(p, r, ExpP1);
+    p = MulAdd(p, r, ExpP2);
+    p = MulAdd(p, r, ExpP3);
+    p = MulAdd(p, r, ExpP4);
+    p = MulAdd(p, r, ExpP5);
+    const __m256 y = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(p, z), r), _mm256_set1_ps(1.0f));
+    const __m256i n = _mm256_add_epi32(_mm256_cvttps_epi32(fx), _mm256_set1_epi32(127));
+    return _mm256_mul_ps(y, _mm256_castsi256_ps(_mm256_slli_epi32(n, 23)));
+  }
+
+  LIBCARLA_SENSOR_TARGET_AVX2
+  static inline __m256 LogAVX2(__m256 x) {
+    const __m256i bits = _mm256_castps_si256(x);
+    __m256 e = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(126)));
+    __m256 m = _mm256_castsi256_ps(_mm256_or_si256(
+        _mm256_and_si256(bits, _mm256_set1_epi32(static_cast<int>(0x807fffffu))),
+        _mm256_set1_epi32(0x3f000000)));
+    const __m256 mask = _mm256_cmp_ps(m, _mm256_set1_ps(SqrtHalf), _CMP_LT_OQ);
+    e = _mm256_sub_ps(e, _mm256_and_ps(mask, _mm256_set1_ps(1.0f)));
+    m = _mm256_sub_ps(_mm256_add_ps(m, _mm256_and_ps(mask, m)), _mm256_set1_ps(1.0f));
+    const __m256 z = _mm256_mul_ps(m, m);
+    __m256 y = _mm256_set1_ps(LogP0);
+    y = MulAdd(y, m, LogP1);
+    y = MulAdd(y, m, LogP2);
+    y = MulAdd(y, m, LogP3);
+    y = MulAdd(y, m, LogP4);
+    y = MulAdd(y, m, LogP5);
+    y = MulAdd(y, m, LogP6);
+    y = MulAdd(y, m, LogP7);
+    y = MulAdd(y, m, LogP8);
+    y = _mm256_mul_ps(y, m);
+    y = _mm256_mul_ps(y, z);
+    y = _mm256_add_ps(y, _mm256_mul_ps(_mm256_set1_ps(Ln2Lo), e));
+    y = _mm256_sub_ps(y, _mm256_mul_ps(_mm256_set1_ps(0.5f), z));
+    const __m256 result = _mm256_add_ps(m, y);
+    return _mm256_add_ps(result, _mm256_mul_ps(_mm256_set1_ps(Ln2Hi), e));
+  }
+
+  LIBCARLA_SENSOR_TARGET_AVX2
+  static inline __m256 CosTwoPiAVX2(__m256 u) {
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    const __m256 y = _mm256_andnot_ps(sign, _mm256_sub_ps(u, _mm256_set1_ps(0.5f)));
+    const __m256 z = _mm256_min_ps(y, _mm256_sub_ps(_mm256_set1_ps(0.5f), y));
+    const __m256 t = _mm256_mul_ps(z, _mm256_set1_ps(TwoPi));
+    const __m256 t2 = _mm256_mul_ps(t, t);
+    __m256 c = _mm256_set1_ps(CosK6);
+    c = MulAdd(c, t2, CosK5);
+    c = MulAdd(c, t2, CosK4);
+    c = MulAdd(c, t2, CosK3);
+    c = MulAdd(c, t2, CosK2);
+    c = MulAdd(c, t2, CosK1);
+    c = MulAdd(c, t2, CosK0);
+    const __m256 negate = _mm256_cmp_ps(y, _mm256_set1_ps(0.25f), _CMP_LT_OQ);
+    return _mm256_xor_ps(c, _mm256_and_ps(negate, sign));
+  }
+
+  LIBCARLA_SENSOR_TARGET_AVX2
+  static inline __m256 TransformAVX2(
+      const LidarPostprocess::Matrix &m, size_t row, __m256 x, __m256 y, __m256 z) {
+    __m256 result = _mm256_mul_ps(_mm256_set1_ps(m[4u * row]), x);
+    result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_set1_ps(m[4u * row + 1u]), y));
+    result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_set1_ps(m[4u * row + 2u]), z));
+    return _mm256_add_ps(result, _mm256_set1_ps(m[4u * row + 3u]));
+  }
+
+  /// 处理 count 向下取整到 8 的倍数个点，返回保留的点数。
+  LIBCARLA_SENSOR_TARGET_AVX2
+  static size_t ProcessAVX2(
+      const LidarPostprocessCoefficients &c,
+      const LidarPostprocess::Matrix &m,
+      const uint32_t key,
+      const float *x,
+      const float *y,
+      const float *z,
+      const size_t count,
+      const uint32_t first_counter,
+      float *output) {
+    const __m256i key_vector = _mm256_set1_epi32(static_cast<int>(key));
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256 zero = _mm256_setzero_ps();
+    const size_t simd_count = count & ~size_t(7u);
+    size_t kept = 0u;
+    for (size_t i = 0u; i < simd_count; i += 8u) {
+      const __m256 wx = _mm256_loadu_ps(x + i);
+      const __m256 wy = _mm256_loadu_ps(y + i);
+      const __m256 wz = _mm256_loadu_ps(z + i);
+      __m256 sx = TransformAVX2(m, 0u, wx, wy, wz);
+      __m256 sy = TransformAVX2(m, 1u, wx, wy, wz);
+      __m256 sz = TransformAVX2(m, 2u, wx, wy, wz);
+      const __m256 distance = _mm256_sqrt_ps(_mm256_add_ps(
+          _mm256_add_ps(_mm256_mul_ps(sx, sx), _mm256_mul_ps(sy, sy)),
+          _mm256_mul_ps(sz, sz)));
+      const __m256 intensity = ExpAVX2(_mm256_mul_ps(_mm256_set1_ps(c.neg_atten), distance));
+      const __m256i counter = _mm256_add_epi32(
+          _mm256_set1_epi32(static_cast<int>(first_counter + static_cast<uint32_t>(i))),
+          lanes);
+
+      if (c.noise_active) {
+        const __m256 u1 = UniformOpenZeroAVX2(RandomAVX2(key_vector, counter, LidarPostprocess::NoiseRadius));
+        const __m256 u2 = UniformAVX2(RandomAVX2(key_vector, counter, LidarPostprocess::NoiseAngle));
+        const __m256 normal = _mm256_mul_ps(
+            _mm256_sqrt_ps(_mm256_mul_ps(_mm256_set1_ps(-2.0f), LogAVX2(u1))),
+            CosTwoPiAVX2(u2));
+        const __m256 noise = _mm256_mul_ps(normal, _mm256_set1_ps(c.noise_stddev));
+        const __m256 scale = _mm256_and_ps(
+            _mm256_cmp_ps(distance, zero, _CMP_GT_OQ),
+            _mm256_div_ps(noise, distance));
+        sx = _mm256_add_ps(sx, _mm256_mul_ps(sx, scale));
+        sy = _mm256_add_ps(sy, _mm256_mul_ps(sy, scale));
+        sz = _mm256_add_ps(sz, _mm256_mul_ps(sz, scale));
+      }
+
+      const __m256 u = UniformAVX2(RandomAVX2(key_vector, counter, LidarPostprocess::IntensityDropOff));
+      const __m256 keep = _mm256_or_ps(
+          _mm256_cmp_ps(intensity, _mm256_set1_ps(c.intensity_limit), _CMP_GT_OQ),
+          _mm256_cmp_ps(u, MulAdd(_mm256_set1_ps(c.alpha), intensity, c.beta), _CMP_LT_OQ));
+      const int mask = _mm256_movemask_ps(keep);
+      if (mask == 0) {
+        continue;
+      }
+
+      // SoA 转为 x, y, z, I 交错存储，只写出保留的点。
+      __m128 points[8u] = {
+          _mm256_castps256_ps128(sx), _mm256_castps256_ps128(sy),
+          _mm256_castps256_ps128(sz), _mm256_castps256_ps128(intensity),
+          _mm256_extractf128_ps(sx, 1), _mm256_extractf128_ps(sy, 1),
+          _mm256_extractf128_ps(sz, 1), _mm256_extractf128_ps(intensity, 1)};
+      _MM_TRANSPOSE4_PS(points[0u], points[1u], points[2u], points[3u]);
+      _MM_TRANSPOSE4_PS(points[4u], points[5u], points[6u], points[7u]);
+      for (size_t lane = 0u; lane < 8u; ++lane) {
+        if ((mask >> lane) & 1) {
+          _mm_storeu_ps(output + 4u * kept, points[lane]);
+          ++kept;
+        }
+      }
+    }
+    return kept;
+  }
+
+#endif // LIBCARLA_SENSOR_WITH_X86_SIMD
+
+  // ===========================================================================
+  // -- 接口 -------------------------------------------------------------------
+  // ===========================================================================
+
+  size_t LidarPostprocess::ProcessRangeScalar(
+      const LidarPostprocessParams &params,
+      const Matrix &world_to_sensor,
+      const uint32_t key,
+      const float *x,
+      const float *y,
+      const float *z,
+      const size_t count,
+      const uint32_t first_counter,
+      float *output) {
+    const LidarPostprocessCoefficients coefficients(params);
+    return ProcessScalar(coefficients, world_to_sensor, key, x, y, z, 0u, count, first_counter, output);
+  }
+
+  size_t LidarPostprocess::ProcessRange(
+      const LidarPostprocessParams &params,
+      const Matrix &world_to_sensor,
+      const uint32_t key,
+      const float *x,
+      const float *y,
+      const float *z,
+      const size_t count,
+      const uint32_t first_counter,
+      float *output) {
+    const LidarPostprocessCoefficients coefficients(params);
+    size_t begin = 0u;
+    size_t kept = 0u;
+#ifdef LIBCARLA_SENSOR_WITH_X86_SIMD
+    if (HasAVX2()) {
+      kept = ProcessAVX2(coefficients, world_to_sensor, key, x, y, z, count, first_counter, output);
+      begin = count & ~size_t(7u);
+    }
+#endif // LIBCARLA_SENSOR_WITH_X86_SIMD
+    // 计数器按点在整个范围内的下标计算，尾部的点与向量路径的结果一致。
+    return kept + ProcessScalar(
+        coefficients, world_to_sensor, key, x, y, z, begin, count, first_counter, output + 4u * kept);
+  }
+
+  void LidarPostprocess::Process(
+      const LidarPostprocessParams &params,
+      const Matrix &world_to_sensor,
+      const uint32_t key,
+      const LidarHits &hits,
+      data::LidarData &data,
+      size_t num_threads) {
+    const uint32_t channel_count = hits.GetChannelCount();
+    DEBUG_ASSERT(data.GetChannelCount() == channel_count);
+    const size_t point_count = hits.GetPointCount();
+
+    // 每个通道先写到其在 hits 中的位置，之后再依次向前紧凑。
+    auto &points = data._points;
+    points.resize(4u * point_count);
+    std::vector<uint32_t> points_per_channel(channel_count, 0u);
+
+    const auto process_channels = [&](size_t begin, size_t end) {
+      for (auto channel = begin; channel < end; ++channel) {
+        const uint32_t offset = hits.offsets[channel];
+        const size_t count = hits.offsets[channel + 1u] - offset;
+        points_per_channel[channel] = static_cast<uint32_t>(ProcessRange(
+            params, world_to_sensor, key,
+            hits.x.data() + offset, hits.y.data() + offset, hits.z.data() + offset,
+            count, offset, points.data() + 4u * offset));
+      }
+    };
+
+    if (num_threads == 0u) {
+      num_threads = (point_count < ParallelThreshold()) ?
+          1u :
+          std::max(1u, std::thread::hardware_concurrency());
+    }
+    num_threads = std::min<size_t>(num_threads, channel_count);
+    if (num_threads <= 1u) {
+      process_channels(0u, channel_count);
+    } else {
+      const size_t batch = (channel_count + num_threads - 1u) / num_threads;
+      ThreadGroup workers;
+      for (auto begin = batch; begin < channel_count; begin += batch) {
+        const auto end = std::min<size_t>(begin + batch, channel_count);
+        workers.CreateThread([=]() { process_channels(begin, end); });
+      }
+      process_channels(0u, batch);
+      workers.JoinAll();
+    }
+
+    size_t write = 0u;
+    for (auto channel = 0u; channel < channel_count; ++channel) {
+      const size_t read = 4u * hits.offsets[channel];
+      const size_t size = 4u * points_per_channel[channel];
+      if (read != write && size > 0u) {
+        std::memmove(points.data() + write, points.data() + read, sizeof(float) * size);
+      }
+      write += size;
+    }
+    points.resize(write);
+    data.WriteChannelCount(points_per_channel);
+  }
+
+} // namespace sensor
+} // namespace carla
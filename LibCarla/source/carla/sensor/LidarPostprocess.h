@@ -0,0 +1,185 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace carla {
+namespace sensor {
+
+namespace data {
+  class LidarData;
+}
+
+  /// RayCastLidar 的后处理参数，与 FLidarDescription 中的同名字段一致。
+  struct LidarPostprocessParams {
+    /// 大气衰减率（m^-1）
+    float atmosp_atten_rate = 0.004f;
+    /// 沿射线方向的噪声标准差（米）
+    float noise_stddev = 0.0f;
+    /// 随机丢弃的射线比例
+    float dropoff_gen_rate = 0.45f;
+    /// 强度高于该值的点不会被丢弃
+    float dropoff_intensity_limit = 0.8f;
+    /// 强度为零的点被丢弃的概率
+    float dropoff_at_zero_intensity = 0.4f;
+  };
+
+  /// 按通道连续存放的激光雷达命中点（SoA），坐标为世界坐标系下的米。
+  class LidarHits {
+  public:
+
+    void Clear() {
+      x.clear();
+      y.clear();
+      z.clear();
+      offsets.assign(1u, 0u);
+    }
+
+    void Reserve(size_t point_count) {
+      x.reserve(point_count);
+      y.reserve(point_count);
+      z.reserve(point_count);
+    }
+
+    void AddPoint(float px, float py, float pz) {
+      x.emplace_back(px);
+      y.emplace_back(py);
+      z.emplace_back(pz);
+    }
+
+    /// 结束当前通道，之后添加的点属于下一个通道。
+    void CloseChannel() {
+      offsets.emplace_back(static_cast<uint32_t>(x.size()));
+    }
+
+    uint32_t GetChannelCount() const {
+      return static_cast<uint32_t>(offsets.size() - 1u);
+    }
+
+    size_t GetPointCount() const {
+      return x.size();
+    }
+
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+
+    /// 第 i 个通道的点为 [offsets[i], offsets[i + 1])。
+    std::vector<uint32_t> offsets = {0u};
+  };
+
+  /// RayCastLidar 的点云后处理内核，与虚幻引擎无关。
+  ///
+  /// 对 SoA 形式的命中点依次执行：变换到传感器坐标系、按大气衰减计算强度、
+  /// 沿射线方向加入高斯噪声、按强度随机丢弃，结果直接写入 LidarData 的
+  /// x, y, z, I 交错布局。在支持的 CPU 上每次处理 8 个点（AVX2），否则退回
+  /// 标量实现；两者的运算顺序完全相同，不依赖 FMA。
+  ///
+  /// 随机数基于计数器：每个随机数只取决于 (key, counter, stream)，因此结果
+  /// 与线程数和处理顺序无关，同一种子与帧号总能得到相同的点云。
+  class LidarPostprocess {
+  public:
+
+    /// 4x4 行主序矩阵，与 geom::Transform::GetInverseMatrix() 的布局相同。
+    using Matrix = std::array<float, 16u>;
+
+    /// 随机数流，同一计数器在不同的流上得到相互独立的随机数。
+    enum Stream : uint32_t {
+      RayDropOff,
+      NoiseRadius,
+      NoiseAngle,
+      IntensityDropOff
+    };
+
+    /// 超过该点数的点云默认使用多线程处理。
+    static constexpr size_t ParallelThreshold() {
+      return 64u * 1024u;
+    }
+
+    // =========================================================================
+    // -- 基于计数器的随机数 -------------------------------------------------------
+    // =========================================================================
+
+    /// 由传感器种子和帧号得到本帧的随机数密钥。
+    static uint32_t MakeKey(int32_t seed, uint64_t frame);
+
+    /// 32 位整数混合函数（lowbias32），是一个双射。
+    static uint32_t Hash(uint32_t value) {
+      value ^= value >> 16u;
+      value *= 0x7feb352du;
+      value ^= value >> 15u;
+      value *= 0x846ca68bu;
+      value ^= value >> 16u;
+      return value;
+    }
+
+    static uint32_t Random(uint32_t key, uint32_t counter, Stream stream) {
+      return Hash(Hash(counter ^ key) + static_cast<uint32_t>(stream) * 0x9e3779b9u);
+    }
+
+    /// [0, 1) 区间上的均匀分布。
+    static float Uniform(uint32_t key, uint32_t counter, Stream stream) {
+      return static_cast<float>(Random(key, counter, stream) >> 8u) * (1.0f / 16777216.0f);
+    }
+
+    /// 标准正态分布（Box-Muller）。
+    static float Normal(uint32_t key, uint32_t counter);
+
+    /// 第 @a ray 条射线是否发射，被丢弃的概率为 @a dropoff_gen_rate。
+    static bool KeepRay(uint32_t key, uint32_t ray, float dropoff_gen_rate) {
+      return !(Uniform(key, ray, RayDropOff) < dropoff_gen_rate);
+    }
+
+    // =========================================================================
+    // -- 内核 -------------------------------------------------------------------
+    // =========================================================================
+
+    /// 处理 @a count 个点，第 i 个点使用计数器 @a first_counter + i。保留的点
+    /// 依次写入 @a output（每个点 4 个 float，至少需要 4 * @a count 的空间），
+    /// 返回保留的点数。@a world_to_sensor 的平移部分与点坐标单位相同。
+    static size_t ProcessRange(
+        const LidarPostprocessParams &params,
+        const Matrix &world_to_sensor,
+        uint32_t key,
+        const float *x,
+        const float *y,
+        const float *z,
+        size_t count,
+        uint32_t first_counter,
+        float *output);
+
+    /// 处理所有通道并写入 @a data 的点与各通道点数，计数器为点在 @a hits 中的下标。
+    /// @a data 的通道数必须与 @a hits 相同。
+    ///
+    /// @a num_threads 为 0 时自动选择线程数，为 1 时在当前线程中执行。
+    static void Process(
+        const LidarPostprocessParams &params,
+        const Matrix &world_to_sensor,
+        uint32_t key,
+        const LidarHits &hits,
+        data::LidarData &data,
+        size_t num_threads = 0u);
+
+    /// 标量参考实现，与 ProcessRange 的结果逐位一致。
+    static size_t ProcessRangeScalar(
+        const LidarPostprocessParams &params,
+        const Matrix &world_to_sensor,
+        uint32_t key,
+        const float *x,
+        const float *y,
+        const float *z,
+        size_t count,
+        uint32_t first_counter,
+        float *output);
+  };
+
+} // namespace sensor
+} // namespace carla
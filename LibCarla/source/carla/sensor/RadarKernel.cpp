@@ -0,0 +1,160 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/sensor/RadarKernel.h"
+
+#include "carla/Debug.h"
+#include "carla/sensor/data/RadarData.h"
+
+#include <cmath>
+
+// 与 LidarPostprocess 相同的运行时分派方式。
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  define LIBCARLA_SENSOR_WITH_X86_SIMD
+#  include <immintrin.h>
+#  if defined(__GNUC__)
+#    define LIBCARLA_SENSOR_TARGET_AVX2 __attribute__((target("avx2")))
+#  else
+#    define LIBCARLA_SENSOR_TARGET_AVX2
+#  endif
+#endif
+
+#if defined(__clang__)
+#  pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#  pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace carla {
+namespace sensor {
+
+  // 视线长度的平方小于该值（平方米）时不计算速度。
+  static constexpr float MinSquaredDistance = 1e-12f;
+
+  static void ComputeVelocitiesRange(
+      const RadarHits &hits,
+      const geom::Location &location,
+      const geom::Vector3D &velocity,
+      const size_t begin,
+      const size_t end,
+      float *output) {
+    for (size_t i = begin; i < end; ++i) {
+      const float dx = hits.x[i] - location.x;
+      const float dy = hits.y[i] - location.y;
+      const float dz = hits.z[i] - location.z;
+      const float squared_distance = dx * dx + dy * dy + dz * dz;
+      const float projection =
+          (hits.vx[i] - velocity.x) * dx +
+          (hits.vy[i] - velocity.y) * dy +
+          (hits.vz[i] - velocity.z) * dz;
+      output[i] = squared_distance > MinSquaredDistance ?
+          projection / std::sqrt(squared_distance) :
+          0.0f;
+    }
+  }
+
+#ifdef LIBCARLA_SENSOR_WITH_X86_SIMD
+
+  static bool HasAVX2() {
+#if defined(__GNUC__)
+    static const bool result = __builtin_cpu_supports("avx2");
+    return result;
+#elif defined(__AVX2__)
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  /// 返回已处理的命中点数（8 的倍数），剩余的由标量实现处理。
+  LIBCARLA_SENSOR_TARGET_AVX2
+  static size_t ComputeVelocitiesAVX2(
+      const RadarHits &hits,
+      const geom::Location &location,
+      const geom::Vector3D &velocity,
+      float *output) {
+    const size_t count = hits.GetHitCount() & ~size_t(7u);
+    const __m256 lx = _mm256_set1_ps(location.x);
+    const __m256 ly = _mm256_set1_ps(location.y);
+    const __m256 lz = _mm256_set1_ps(location.z);
+    const __m256 svx = _mm256_set1_ps(velocity.x);
+    const __m256 svy = _mm256_set1_ps(velocity.y);
+    const __m256 svz = _mm256_set1_ps(velocity.z);
+    const __m256 min_squared_distance = _mm256_set1_ps(MinSquaredDistance);
+    for (size_t i = 0u; i < count; i += 8u) {
+      const __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(hits.x.data() + i), lx);
+      const __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(hits.y.data() + i), ly);
+      const __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(hits.z.data() + i), lz);
+      const __m256 squared_distance = _mm256_add_ps(
+          _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)),
+          _mm256_mul_ps(dz, dz));
+      const __m256 projection = _mm256_add_ps(
+          _mm256_add_ps(
+              _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(hits.vx.data() + i), svx), dx),
+              _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(hits.vy.data() + i), svy), dy)),
+          _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(hits.vz.data() + i), svz), dz));
+      const __m256 valid = _mm256_cmp_ps(squared_distance, min_squared_distance, _CMP_GT_OQ);
+      const __m256 result = _mm256_div_ps(projection, _mm256_sqrt_ps(squared_distance));
+      _mm256_storeu_ps(output + i, _mm256_and_ps(valid, result));
+    }
+    return count;
+  }
+
+#endif // LIBCARLA_SENSOR_WITH_X86_SIMD
+
+  geom::Vector3D RadarKernel::GetRayEnd(
+      const float range,
+      const float max_rx,
+      const float max_ry,
+      const float radius,
+      const float angle) {
+    return {range, max_rx * radius * std::cos(angle), max_ry * radius * std::sin(angle)};
+  }
+
+  void RadarKernel::ComputeVelocitiesScalar(
+      const RadarHits &hits,
+      const geom::Location &sensor_location,
+      const geom::Vector3D &sensor_velocity,
+      float *velocity) {
+    ComputeVelocitiesRange(hits, sensor_location, sensor_velocity, 0u, hits.GetHitCount(), velocity);
+  }
+
+  void RadarKernel::ComputeVelocities(
+      const RadarHits &hits,
+      const geom::Location &sensor_location,
+      const geom::Vector3D &sensor_velocity,
+      float *velocity) {
+    size_t begin = 0u;
+#ifdef LIBCARLA_SENSOR_WITH_X86_SIMD
+    if (HasAVX2()) {
+      begin = ComputeVelocitiesAVX2(hits, sensor_location, sensor_velocity, velocity);
+    }
+#endif // LIBCARLA_SENSOR_WITH_X86_SIMD
+    ComputeVelocitiesRange(hits, sensor_location, sensor_velocity, begin, hits.GetHitCount(), velocity);
+  }
+
+  void RadarKernel::Process(
+      const RadarHits &hits,
+      const geom::Location &sensor_location,
+      const geom::Vector3D &sensor_velocity,
+      data::RadarData &data) {
+    const size_t count = hits.GetHitCount();
+    DEBUG_ASSERT(hits.x.size() == count && hits.dir_x.size() == count);
+    std::vector<float> velocities(count);
+    ComputeVelocities(hits, sensor_location, sensor_velocity, velocities.data());
+    for (size_t i = 0u; i < count; ++i) {
+      // 方位角与高度角只取决于射线在传感器坐标系下的方向。
+      const float horizontal = std::sqrt(hits.dir_x[i] * hits.dir_x[i] + hits.dir_y[i] * hits.dir_y[i]);
+      data.WriteDetection({
+          velocities[i],
+          std::atan2(hits.dir_y[i], hits.dir_x[i]),
+          std::atan2(hits.dir_z[i], horizontal),
+          hits.depth[i]});
+    }
+  }
+
+} // namespace sensor
+} // namespace carla
@@ -0,0 +1,125 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/geom/Location.h"
+#include "carla/geom/Vector3D.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace carla {
+namespace sensor {
+
+namespace data {
+  class RadarData;
+}
+
+  /// 一帧雷达射线的命中结果（SoA），长度单位为米，速度单位为米每秒。
+  class RadarHits {
+  public:
+
+    void Clear() {
+      dir_x.clear();
+      dir_y.clear();
+      dir_z.clear();
+      x.clear();
+      y.clear();
+      z.clear();
+      vx.clear();
+      vy.clear();
+      vz.clear();
+      depth.clear();
+    }
+
+    void Reserve(size_t hit_count) {
+      dir_x.reserve(hit_count);
+      dir_y.reserve(hit_count);
+      dir_z.reserve(hit_count);
+      x.reserve(hit_count);
+      y.reserve(hit_count);
+      z.reserve(hit_count);
+      vx.reserve(hit_count);
+      vy.reserve(hit_count);
+      vz.reserve(hit_count);
+      depth.reserve(hit_count);
+    }
+
+    /// @param direction 传感器坐标系下的射线方向，长度任意。
+    /// @param point 世界坐标系下的命中点。
+    /// @param velocity 被命中物体的速度（世界坐标系）。
+    /// @param distance 传感器到命中点的距离。
+    void AddHit(
+        const geom::Vector3D &direction,
+        const geom::Location &point,
+        const geom::Vector3D &velocity,
+        float distance) {
+      dir_x.emplace_back(direction.x);
+      dir_y.emplace_back(direction.y);
+      dir_z.emplace_back(direction.z);
+      x.emplace_back(point.x);
+      y.emplace_back(point.y);
+      z.emplace_back(point.z);
+      vx.emplace_back(velocity.x);
+      vy.emplace_back(velocity.y);
+      vz.emplace_back(velocity.z);
+      depth.emplace_back(distance);
+    }
+
+    size_t GetHitCount() const {
+      return depth.size();
+    }
+
+    std::vector<float> dir_x;
+    std::vector<float> dir_y;
+    std::vector<float> dir_z;
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    std::vector<float> vx;
+    std::vector<float> vy;
+    std::vector<float> vz;
+    std::vector<float> depth;
+  };
+
+  /// Radar 的检测计算内核，与虚幻引擎无关，可以用录制的命中结果离线测试。
+  ///
+  /// 相对速度是目标与传感器的速度差在视线方向上的投影，在支持的 CPU 上每次
+  /// 计算 8 个命中点（AVX2），否则退回标量实现；两者只用到加、乘、除与开方，
+  /// 且不依赖 FMA，结果逐位一致。
+  class RadarKernel {
+  public:
+
+    /// 视场内的一条射线在传感器坐标系下的终点。@a radius 在 [0, 1) 内，
+    /// @a angle 为弧度，@a max_rx 与 @a max_ry 为终点在水平与竖直方向的最大偏移。
+    static geom::Vector3D GetRayEnd(float range, float max_rx, float max_ry, float radius, float angle);
+
+    /// 计算每个命中点的相对速度（米每秒，远离传感器为正），写入 @a velocity，
+    /// 其长度至少为命中点数。命中点与传感器重合时速度为 0。
+    static void ComputeVelocities(
+        const RadarHits &hits,
+        const geom::Location &sensor_location,
+        const geom::Vector3D &sensor_velocity,
+        float *velocity);
+
+    /// 标量参考实现，与 ComputeVelocities 的结果逐位一致。
+    static void ComputeVelocitiesScalar(
+        const RadarHits &hits,
+        const geom::Location &sensor_location,
+        const geom::Vector3D &sensor_velocity,
+        float *velocity);
+
+    /// 将所有命中点按顺序写入 @a data 的检测列表，已有的检测保持不变。
+    static void Process(
+        const RadarHits &hits,
+        const geom::Location &sensor_location,
+        const geom::Vector3D &sensor_velocity,
+        data::RadarData &data);
+  };
+
+} // namespace sensor
+} // namespace carla
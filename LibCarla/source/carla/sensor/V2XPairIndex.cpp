@@ -0,0 +1,88 @@
+// Copyright (c) 2024 Institut fuer Technik der Informationsverarbeitung (ITIV) at the
+// Karlsruhe Institute of Technology
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/sensor/V2XPairIndex.h"
+
+#include "carla/geom/Math.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace carla {
+namespace sensor {
+
+  static int32_t ToCell(float coordinate, float cell_size) {
+    const float cell = std::floor(coordinate / cell_size);
+    if (!(cell > static_cast<float>(std::numeric_limits<int32_t>::min()))) {
+      return std::numeric_limits<int32_t>::min();
+    }
+    if (!(cell < static_cast<float>(std::numeric_limits<int32_t>::max()))) {
+      return std::numeric_limits<int32_t>::max();
+    }
+    return static_cast<int32_t>(cell);
+  }
+
+  void V2XPairIndex::FindPairs(
+      const geom::Location *positions,
+      const size_t count,
+      const float max_distance,
+      std::vector<Pair> &pairs) {
+    pairs.clear();
+    if (count < 2u || !(max_distance > 0.0f)) {
+      return;
+    }
+
+    // 建立网格
+    _node_cells.resize(count);
+    _sorted.clear();
+    _cells.clear();
+    for (uint32_t i = 0u; i < count; ++i) {
+      const int32_t x = ToCell(positions[i].x, max_distance);
+      const int32_t y = ToCell(positions[i].y, max_distance);
+      _node_cells[i] = {x, y};
+      _sorted.emplace_back(GetCellKey(x, y), i);
+    }
+    std::sort(_sorted.begin(), _sorted.end());
+    for (uint32_t first = 0u; first < _sorted.size();) {
+      uint32_t last = first + 1u;
+      while (last < _sorted.size() && _sorted[last].first == _sorted[first].first) {
+        ++last;
+      }
+      _cells.emplace(_sorted[first].first, std::make_pair(first, last));
+      first = last;
+    }
+
+    // 只检查相邻网格中下标更大的节点，每对只出现一次
+    const float squared_distance = max_distance * max_distance;
+    for (uint32_t i = 0u; i < count; ++i) {
+      const auto first = pairs.size();
+      const int64_t cell_x = _node_cells[i].first;
+      const int64_t cell_y = _node_cells[i].second;
+      for (int64_t x = cell_x - 1; x <= cell_x + 1; ++x) {
+        for (int64_t y = cell_y - 1; y <= cell_y + 1; ++y) {
+          if (x < std::numeric_limits<int32_t>::min() || x > std::numeric_limits<int32_t>::max() ||
+              y < std::numeric_limits<int32_t>::min() || y > std::numeric_limits<int32_t>::max()) {
+            continue;
+          }
+          const auto cell = _cells.find(GetCellKey(static_cast<int32_t>(x), static_cast<int32_t>(y)));
+          if (cell == _cells.end()) {
+            continue;
+          }
+          for (auto k = cell->second.first; k < cell->second.second; ++k) {
+            const uint32_t j = _sorted[k].second;
+            if (j > i && geom::Math::DistanceSquared(positions[i], positions[j]) < squared_distance) {
+              pairs.emplace_back(i, j);
+            }
+          }
+        }
+      }
+      std::sort(pairs.begin() + static_cast<std::ptrdiff_t>(first), pairs.end());
+    }
+  }
+
+} // namespace sensor
+} // namespace carla
@@ -0,0 +1,57 @@
+// Copyright (c) 2024 Institut fuer Technik der Informationsverarbeitung (ITIV) at the
+// Karlsruhe Institute of Technology
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/geom/Location.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace carla {
+namespace sensor {
+
+  /// 查找彼此距离小于给定值的 V2X 节点对。
+  ///
+  /// 节点按 XY 平面上边长为最大距离的网格分桶，每个节点只需检查相邻的
+  /// 3x3 个网格，避免对所有节点两两计算距离。内部缓冲区在多次调用之间
+  /// 复用。
+  class V2XPairIndex : private NonCopyable {
+  public:
+
+    using Pair = std::pair<uint32_t, uint32_t>;
+
+    /// 将所有满足三维距离小于 @a max_distance 的无序节点对 (i, j)（i < j）
+    /// 按字典序写入 @a pairs。
+    void FindPairs(
+        const geom::Location *positions,
+        size_t count,
+        float max_distance,
+        std::vector<Pair> &pairs);
+
+  private:
+
+    using CellKey = uint64_t;
+
+    static CellKey GetCellKey(int32_t x, int32_t y) {
+      return (static_cast<CellKey>(static_cast<uint32_t>(x)) << 32u) | static_cast<uint32_t>(y);
+    }
+
+    /// 每个节点所在的网格。
+    std::vector<std::pair<int32_t, int32_t>> _node_cells;
+
+    /// 按网格排序的节点下标。
+    std::vector<std::pair<CellKey, uint32_t>> _sorted;
+
+    /// 网格 -> 在 _sorted 中的范围 [first, last)。
+    std::unordered_map<CellKey, std::pair<uint32_t, uint32_t>> _cells;
+  };
+
+} // namespace sensor
+} // namespace carla
@@ -0,0 +1,156 @@
+// Copyright (c) 2024 Institut fuer Technik der Informationsverarbeitung (ITIV) at the
+// Karlsruhe Institute of Technology
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/sensor/V2XPathLoss.h"
+
+#include "carla/geom/Math.h"
+
+#include <cmath>
+
+namespace carla {
+namespace sensor {
+
+  double V2XPathLoss::Wavelength(double frequency_ghz) {
+    return SpeedOfLight / (frequency_ghz * 1e9);
+  }
+
+  float V2XPathLoss::Winner(V2XPathState state, V2XScenario scenario, double distance, double frequency_ghz) {
+    if (state == V2XPathState::NLOSb) {
+      return static_cast<float>(36.85 + 30.0 * std::log10(distance) + 18.9 * std::log10(frequency_ghz));
+    }
+    // LOS 与 NLOSv
+    if (scenario == V2XScenario::Highway) {
+      return static_cast<float>(32.4 + 20.0 * std::log10(distance) + 20.0 * std::log10(frequency_ghz));
+    }
+    return static_cast<float>(38.77 + 16.7 * std::log10(distance) + 18.2 * std::log10(frequency_ghz));
+  }
+
+  double V2XPathLoss::FreeSpace(double distance, double wavelength) {
+    return 20.0 * std::log10(distance) + 20.0 * std::log10(4.0 * geom::Math::Pi<double>() / wavelength);
+  }
+
+  double V2XPathLoss::FreeSpaceAtReference(double reference_distance, double frequency_ghz) {
+    return 20.0 * std::log10(reference_distance) + 20.0 * std::log10(frequency_ghz * 1e9) +
+        20.0 * std::log10(4.0 * geom::Math::Pi<double>() / SpeedOfLight);
+  }
+
+  double V2XPathLoss::LogDistance(double fspl_d0, double exponent, double distance, double reference_distance) {
+    return fspl_d0 + 10.0 * exponent * std::log10(distance / reference_distance);
+  }
+
+  double V2XPathLoss::TwoRay(double distance, double tx_height, double rx_height, double wavelength, double epsilon_r) {
+    // 地面上的距离与反射路径的长度
+    const double d_ground = std::sqrt(distance * distance - (tx_height - rx_height) * (tx_height - rx_height));
+    const double d_refl = std::sqrt(distance * distance + 4.0 * tx_height * rx_height);
+
+    // 入射角的正弦与余弦
+    const double sin_theta = (tx_height + rx_height) / d_refl;
+    const double cos_theta = d_ground / d_refl;
+    const double root = std::sqrt(epsilon_r - cos_theta * cos_theta);
+    const double gamma = (sin_theta - root) / (sin_theta + root);
+    const double phi = 2.0 * geom::Math::Pi<double>() / wavelength * (distance - d_refl);
+
+    const double real = 1.0 + gamma * std::cos(phi);
+    const double imag = gamma * std::sin(phi);
+    return 20.0 * std::log10(4.0 * geom::Math::Pi<double>() * d_ground / wavelength / std::sqrt(real * real + imag * imag));
+  }
+
+  float V2XPathLoss::TwoRaySimple(double distance, double tx_height, double rx_height) {
+    return static_cast<float>(40.0 * std::log10(distance) -
+        10.0 * std::log10(tx_height * tx_height * rx_height * rx_height));
+  }
+
+  double V2XPathLoss::VehicleDiffraction(double d1, double d2, double height, double wavelength) {
+    const double v = height * std::sqrt(2.0 * (d1 + d2) / (wavelength * d1 * d2));
+    if (v >= -0.78) {
+      const double t = (v - 0.1) * (v - 0.1);
+      return 6.9 + 20.0 * std::log10(std::sqrt(t + 1.0) + v - 0.1);
+    }
+    return 0.0;
+  }
+
+  double V2XPathLoss::VehicleBlockage(
+      double tx_x, double tx_y,
+      double rx_x, double rx_y,
+      const V2XObstacle *obstacles, size_t count,
+      double wavelength) {
+    double max_loss = 0.0;
+    for (size_t i = 0u; i < count; ++i) {
+      const V2XObstacle &obstacle = obstacles[i];
+      const double d1 = std::hypot(obstacle.x - tx_x, obstacle.y - tx_y);
+      const double d2 = std::hypot(rx_x - obstacle.x, rx_y - obstacle.y);
+      const double loss = VehicleDiffraction(d1, d2, obstacle.height, wavelength);
+      if (loss >= max_loss) {
+        max_loss = loss;
+      }
+    }
+    return max_loss;
+  }
+
+  double V2XPathLoss::Compute(
+      const V2XPathLossParams &params,
+      V2XPathState state,
+      double distance,
+      double tx_x, double tx_y, double tx_height,
+      double rx_x, double rx_y, double rx_height,
+      const V2XObstacle *obstacles, size_t count) {
+    const double wavelength = Wavelength(params.frequency_ghz);
+    if (params.model == V2XPathLossModel::Winner) {
+      double loss = Winner(state, params.scenario, distance, params.frequency_ghz);
+      if (state == V2XPathState::NLOSv) {
+        loss += VehicleBlockage(tx_x, tx_y, rx_x, rx_y, obstacles, count, wavelength);
+      }
+      return loss;
+    }
+    switch (state) {
+      case V2XPathState::LOS:
+        return TwoRay(distance, tx_height, rx_height, wavelength, params.epsilon_r);
+      case V2XPathState::NLOSb:
+        return LogDistance(
+            FreeSpaceAtReference(params.reference_distance_fspl, params.frequency_ghz),
+            params.path_loss_exponent,
+            distance,
+            params.reference_distance_fspl);
+      case V2XPathState::NLOSv:
+      default:
+        return FreeSpace(distance, wavelength) +
+            VehicleBlockage(tx_x, tx_y, rx_x, rx_y, obstacles, count, wavelength);
+    }
+  }
+
+  float V2XPathLoss::ShadowFadingStdDev(
+      V2XPathState state,
+      V2XScenario scenario,
+      bool use_etsi_fading,
+      float custom_stddev) {
+    if (!use_etsi_fading) {
+      return custom_stddev;
+    }
+    switch (state) {
+      case V2XPathState::LOS:
+        switch (scenario) {
+          case V2XScenario::Highway: return 3.3f;
+          case V2XScenario::Urban:   return 5.2f;
+          // ETSI 没有给出乡村场景的值，取高速与城市的中间值
+          case V2XScenario::Rural:
+          default:                   return 4.25f;
+        }
+      case V2XPathState::NLOSb:
+        // ETSI 中 NLOSb 只适用于城市场景，其它场景使用相同的值
+        return 6.8f;
+      case V2XPathState::NLOSv:
+      default:
+        switch (scenario) {
+          case V2XScenario::Highway: return 3.8f;
+          case V2XScenario::Urban:   return 5.3f;
+          case V2XScenario::Rural:
+          default:                   return 4.55f;
+        }
+    }
+  }
+
+} // namespace sensor
+} // namespace carla
@@ -0,0 +1,108 @@
+// Copyright (c) 2024 Institut fuer Technik der Informationsverarbeitung (ITIV) at the
+// Karlsruhe Institute of Technology
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace carla {
+namespace sensor {
+
+  /// 发送端与接收端之间的传播状态。
+  enum class V2XPathState : uint8_t {
+    LOS,   ///< 视距
+    NLOSb, ///< 被建筑物遮挡
+    NLOSv  ///< 被车辆遮挡
+  };
+
+  enum class V2XPathLossModel : uint8_t {
+    Winner,
+    Geometric
+  };
+
+  enum class V2XScenario : uint8_t {
+    Highway,
+    Rural,
+    Urban
+  };
+
+  /// 遮挡的车辆，坐标与高度单位为米，高度相对于收发两端中较低的地面。
+  struct V2XObstacle {
+    double x;
+    double y;
+    double height;
+  };
+
+  /// 一个 V2X 传感器的传播参数。
+  struct V2XPathLossParams {
+    V2XPathLossModel model = V2XPathLossModel::Winner;
+    V2XScenario scenario = V2XScenario::Urban;
+    /// 传输频率（GHz）
+    double frequency_ghz = 5.9;
+    /// 对数距离路径损耗模型的参考距离（米）
+    double reference_distance_fspl = 1.0;
+    /// 建筑物遮挡时的路径损耗指数
+    double path_loss_exponent = 2.7;
+    /// 双射线模型中地面的相对介电常数
+    double epsilon_r = 1.02;
+  };
+
+  /// V2X 信道的路径损耗计算，与虚幻引擎无关，单位均为米与 dB。
+  ///
+  /// 公式来自 ETSI TR 103 257-1 V1.1.1 与 WINNER+ 信道模型，阴影衰落的
+  /// 随机数由调用方生成。
+  class V2XPathLoss {
+  public:
+
+    static constexpr double SpeedOfLight = 299792458.0;
+
+    /// 波长（米）
+    static double Wavelength(double frequency_ghz);
+
+    /// WINNER+ 路径损耗，@a distance 为收发两端的直线距离。
+    static float Winner(V2XPathState state, V2XScenario scenario, double distance, double frequency_ghz);
+
+    /// 自由空间路径损耗
+    static double FreeSpace(double distance, double wavelength);
+
+    /// 参考距离处的自由空间路径损耗，用于对数距离模型。
+    static double FreeSpaceAtReference(double reference_distance, double frequency_ghz);
+
+    /// 对数距离路径损耗
+    static double LogDistance(double fspl_d0, double exponent, double distance, double reference_distance);
+
+    /// 完整的双射线地面反射模型，@a tx_height 与 @a rx_height 相对于共同的地面。
+    static double TwoRay(double distance, double tx_height, double rx_height, double wavelength, double epsilon_r = 1.02);
+
+    /// 简化的双射线模型，只在距离远大于 4πhthr/λ 时成立。
+    static float TwoRaySimple(double distance, double tx_height, double rx_height);
+
+    /// 单个车辆的刀刃衍射损耗，@a d1、@a d2 为车辆到两端的水平距离。
+    static double VehicleDiffraction(double d1, double d2, double height, double wavelength);
+
+    /// 多个遮挡车辆中最大的衍射损耗。
+    static double VehicleBlockage(
+        double tx_x, double tx_y,
+        double rx_x, double rx_y,
+        const V2XObstacle *obstacles, size_t count,
+        double wavelength);
+
+    /// 不含阴影衰落的总路径损耗。
+    static double Compute(
+        const V2XPathLossParams &params,
+        V2XPathState state,
+        double distance,
+        double tx_x, double tx_y, double tx_height,
+        double rx_x, double rx_y, double rx_height,
+        const V2XObstacle *obstacles, size_t count);
+
+    /// 阴影衰落的标准差（dB），ETSI TR 103 257-1 表 6。
+    static float ShadowFadingStdDev(V2XPathState state, V2XScenario scenario, bool use_etsi_fading, float custom_stddev);
+  };
+
+} // namespace sensor
+} // namespace carla
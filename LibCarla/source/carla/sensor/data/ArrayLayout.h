@@ -0,0 +1,128 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/sensor/data/DVSEvent.h"
+#include "carla/sensor/data/LidarData.h"
+#include "carla/sensor/data/RadarData.h"
+#include "carla/sensor/data/SemanticLidarData.h"
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+
+namespace carla {
+namespace sensor {
+namespace data {
+
+  /// 传感器数组中单个元素字段的内存描述。
+  ///
+  /// @a format 使用 PEP 3118（Python 缓冲区协议）的单字符格式码，
+  /// 配合元素步长即可在不拷贝数据的情况下得到某一列的跨步视图。
+  struct ArrayField {
+    const char *name;   ///< 字段名
+    const char *format; ///< 字段格式码，例如 "H"、"q"、"f"
+    size_t offset;      ///< 字段在元素内的字节偏移
+    size_t size;        ///< 字段字节数
+  };
+
+  /// 描述传感器数组元素类型 @a T 的内存布局，用于导出零拷贝的结构化视图。
+  ///
+  /// 每个特化提供：
+  ///   - @a format()：整个元素的 PEP 3118 结构化格式串（T{...}）；
+  ///   - @a fields()：各字段的 ArrayField 描述。
+  template <typename T>
+  struct ArrayLayout;
+
+  template <>
+  struct ArrayLayout<DVSEvent> {
+    static_assert(sizeof(DVSEvent) == 13u, "Invalid DVSEvent size");
+
+    static const char *format() {
+      return "T{=H:x:H:y:q:t:?:pol:}";
+    }
+
+    static const std::array<ArrayField, 4u> &fields() {
+      static const std::array<ArrayField, 4u> result = {{
+        {"x",   "H", offsetof(DVSEvent, x),   sizeof(std::uint16_t)},
+        {"y",   "H", offsetof(DVSEvent, y),   sizeof(std::uint16_t)},
+        {"t",   "q", offsetof(DVSEvent, t),   sizeof(std::int64_t)},
+        {"pol", "?", offsetof(DVSEvent, pol), sizeof(bool)}}};
+      return result;
+    }
+  };
+
+  template <>
+  struct ArrayLayout<RadarDetection> {
+    static_assert(sizeof(RadarDetection) == 4u * sizeof(float), "Invalid RadarDetection size");
+
+    static const char *format() {
+      return "T{=f:velocity:f:azimuth:f:altitude:f:depth:}";
+    }
+
+    static const std::array<ArrayField, 4u> &fields() {
+      static const std::array<ArrayField, 4u> result = {{
+        {"velocity", "f", offsetof(RadarDetection, velocity), sizeof(float)},
+        {"azimuth",  "f", offsetof(RadarDetection, azimuth),  sizeof(float)},
+        {"altitude", "f", offsetof(RadarDetection, altitude), sizeof(float)},
+        {"depth",    "f", offsetof(RadarDetection, depth),    sizeof(float)}}};
+      return result;
+    }
+  };
+
+  template <>
+  struct ArrayLayout<LidarDetection> {
+    static_assert(sizeof(LidarDetection) == 4u * sizeof(float), "Invalid LidarDetection size");
+
+    static const char *format() {
+      return "T{=f:x:f:y:f:z:f:intensity:}";
+    }
+
+    static const std::array<ArrayField, 4u> &fields() {
+      static const std::array<ArrayField, 4u> result = {{
+        {"x",         "f", 0u * sizeof(float), sizeof(float)},
+        {"y",         "f", 1u * sizeof(float), sizeof(float)},
+        {"z",         "f", 2u * sizeof(float), sizeof(float)},
+        {"intensity", "f", 3u * sizeof(float), sizeof(float)}}};
+      return result;
+    }
+  };
+
+  template <>
+  struct ArrayLayout<SemanticLidarDetection> {
+    static_assert(sizeof(SemanticLidarDetection) == 6u * sizeof(float), "Invalid SemanticLidarDetection size");
+
+    static const char *format() {
+      return "T{=f:x:f:y:f:z:f:cos_inc_angle:I:object_idx:I:object_tag:}";
+    }
+
+    static const std::array<ArrayField, 6u> &fields() {
+      static const std::array<ArrayField, 6u> result = {{
+        {"x",             "f", 0u * sizeof(float), sizeof(float)},
+        {"y",             "f", 1u * sizeof(float), sizeof(float)},
+        {"z",             "f", 2u * sizeof(float), sizeof(float)},
+        {"cos_inc_angle", "f", 3u * sizeof(float), sizeof(float)},
+        {"object_idx",    "I", 4u * sizeof(float), sizeof(uint32_t)},
+        {"object_tag",    "I", 5u * sizeof(float), sizeof(uint32_t)}}};
+      return result;
+    }
+  };
+
+  /// 按名称查找元素类型 @a T 的字段描述，找不到时返回 nullptr。
+  template <typename T>
+  static inline const ArrayField *FindArrayField(const char *name) {
+    for (const auto &field : ArrayLayout<T>::fields()) {
+      if (std::strcmp(field.name, name) == 0) {
+        return &field;
+      }
+    }
+    return nullptr;
+  }
+
+} // namespace data
+} // namespace sensor
+} // namespace carla
@@ -8,6 +8,7 @@
 
 // 引入C++标准库中固定宽度整数类型的头文件，后续结构体中的成员变量会用到相关整数类型定义
 #include <cstdint>
+#include <utility>
 
 namespace carla {
 namespace sensor {
@@ -68,8 +68,12 @@ namespace data {
     }
 
     /// 获取事件的纯向量格式数组
+    ///
+    /// @note 每个事件都会分配一个向量，事件较多时请使用 Python 端的
+    /// view()/field_view()，直接以零拷贝方式访问原始数据
     std::vector<std::vector<std::int64_t>> ToArray() const { 
       std::vector<std::vector<std::int64_t>> array; // 创建二维数组
+      array.reserve(size()); // 预先分配空间，避免逐个插入时反复扩容
       for (const auto &event : *this) { // 遍历所有事件
         array.push_back({static_cast<std::int64_t>(event.x), static_cast<std::int64_t>(event.y), static_cast<std::int64_t>(event.t), (2*static_cast<std::int64_t>(event.pol)) - 1}); // 添加事件的x, y, t和极性信息
       }
@@ -79,6 +83,7 @@ namespace data {
     /// 获取所有事件的x坐标，便于使用
     std::vector<std::uint16_t> ToArrayX() const { 
       std::vector<std::uint16_t> array; // 创建x坐标数组
+      array.reserve(size()); // 预先分配空间，避免逐个插入时反复扩容
       for (const auto &event : *this) { // 遍历所有事件
         array.push_back(event.x); // 添加x坐标
       }
@@ -88,6 +93,7 @@ namespace data {
     /// 获取所有事件的y坐标，便于使用
     std::vector<std::uint16_t> ToArrayY() const { 
       std::vector<std::uint16_t> array; // 创建y坐标数组
+      array.reserve(size()); // 预先分配空间，避免逐个插入时反复扩容
       for (const auto &event : *this) { // 遍历所有事件
         array.push_back(event.y); // 添加y坐标
       }
@@ -97,6 +103,7 @@ namespace data {
     /// 获取所有事件的时间戳，便于使用
     std::vector<std::int64_t> ToArrayT() const { 
       std::vector<std::int64_t> array; // 创建时间戳数组
+      array.reserve(size()); // 预先分配空间，避免逐个插入时反复扩容
       for (const auto &event : *this) { // 遍历所有事件
         array.push_back(event.t); // 添加时间戳
       }
@@ -106,6 +113,7 @@ namespace data {
     /// 获取所有事件的极性，便于使用
     std::vector<short> ToArrayPol() const { 
       std::vector<short> array; // 创建极性数组
+      array.reserve(size()); // 预先分配空间，避免逐个插入时反复扩容
       for (const auto &event : *this) { // 遍历所有事件
         array.push_back(2*static_cast<short>(event.pol) - 1); // 将极性转换为-1和1
       }
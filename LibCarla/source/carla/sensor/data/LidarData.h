@@ -20,6 +20,8 @@ namespace ros2 {
 
 namespace sensor {
 
+  class LidarPostprocess;
+
 namespace s11n {
   class LidarSerializer;
   class LidarHeaderView;
@@ -112,6 +114,7 @@ namespace data {
 
     friend class s11n::LidarSerializer;
     friend class s11n::LidarHeaderView;
+    friend class sensor::LidarPostprocess;
     friend class carla::ros2::ROS2;
   };
 
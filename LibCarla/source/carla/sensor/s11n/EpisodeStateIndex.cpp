@@ -0,0 +1,184 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/sensor/s11n/EpisodeStateIndex.h"
+
+#include "carla/Debug.h"
+#include "carla/geom/BoundingBox.h"
+#include "carla/geom/Math.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace carla {
+namespace sensor {
+namespace s11n {
+
+  EpisodeStateIndex::EpisodeStateIndex(float cell_size)
+    : _cell_size(cell_size) {
+    DEBUG_ASSERT(_cell_size > 0.0f);
+  }
+
+  int32_t EpisodeStateIndex::ToCell(float coordinate) const {
+    const float cell = std::floor(coordinate / _cell_size);
+    if (!(cell > static_cast<float>(std::numeric_limits<int32_t>::min()))) {
+      return std::numeric_limits<int32_t>::min();
+    }
+    if (!(cell < static_cast<float>(std::numeric_limits<int32_t>::max()))) {
+      return std::numeric_limits<int32_t>::max();
+    }
+    return static_cast<int32_t>(cell);
+  }
+
+  void EpisodeStateIndex::Reset(const ActorDynamicState *states, size_t count) {
+    DEBUG_ASSERT(states != nullptr || count == 0u);
+    _states = states;
+    _count = count;
+    _sorted.clear();
+    _cells.clear();
+    _ids.clear();
+    _sorted.reserve(count);
+    _ids.reserve(count);
+    for (uint32_t i = 0u; i < count; ++i) {
+      const geom::Location location = states[i].transform.location;
+      const ActorId id = states[i].id;
+      _sorted.emplace_back(GetCellKey(ToCell(location.x), ToCell(location.y)), i);
+      _ids.emplace(id, i);
+    }
+    std::sort(_sorted.begin(), _sorted.end());
+    for (uint32_t first = 0u; first < _sorted.size();) {
+      uint32_t last = first + 1u;
+      while (last < _sorted.size() && _sorted[last].first == _sorted[first].first) {
+        ++last;
+      }
+      _cells.emplace(_sorted[first].first, std::make_pair(first, last));
+      first = last;
+    }
+  }
+
+  template <typename Functor>
+  void EpisodeStateIndex::ForEachInRange(
+      float min_x,
+      float min_y,
+      float max_x,
+      float max_y,
+      Functor &&callback) const {
+    const int32_t first_x = ToCell(min_x);
+    const int32_t first_y = ToCell(min_y);
+    const int32_t last_x = ToCell(max_x);
+    const int32_t last_y = ToCell(max_y);
+    const auto visit = [&](const std::pair<uint32_t, uint32_t> &range) {
+      for (auto i = range.first; i < range.second; ++i) {
+        callback(_sorted[i].second);
+      }
+    };
+    if (last_x < first_x || last_y < first_y) {
+      return;
+    }
+    // 宽与高都不超过 2^32，乘积可能溢出，因此用除法与已占用的网格数比较。
+    const uint64_t width = static_cast<uint64_t>(static_cast<int64_t>(last_x) - first_x + 1);
+    const uint64_t height = static_cast<uint64_t>(static_cast<int64_t>(last_y) - first_y + 1);
+    const uint64_t occupied = _cells.size();
+    if (width > occupied || height > occupied / width) {
+      // 范围比已占用的网格还多时，直接遍历已占用的网格。
+      for (const auto &cell : _cells) {
+        const auto x = static_cast<int32_t>(static_cast<uint32_t>(cell.first >> 32u));
+        const auto y = static_cast<int32_t>(static_cast<uint32_t>(cell.first));
+        if (x >= first_x && x <= last_x && y >= first_y && y <= last_y) {
+          visit(cell.second);
+        }
+      }
+    } else {
+      for (int64_t x = first_x; x <= last_x; ++x) {
+        for (int64_t y = first_y; y <= last_y; ++y) {
+          const auto cell = _cells.find(GetCellKey(static_cast<int32_t>(x), static_cast<int32_t>(y)));
+          if (cell != _cells.end()) {
+            visit(cell->second);
+          }
+        }
+      }
+    }
+  }
+
+  void EpisodeStateIndex::Select(
+      const rpc::EpisodeStateFilter &filter,
+      std::vector<uint32_t> &indices) const {
+    indices.clear();
+    if (_count == 0u) {
+      return;
+    }
+
+    if (filter.HasRadius()) {
+      const auto center_index = _ids.find(filter.actor_id);
+      if (center_index != _ids.end()) {
+        const geom::Location center = _states[center_index->second].transform.location;
+        const float radius = filter.radius;
+        const float squared_radius = radius * radius;
+        ForEachInRange(
+            center.x - radius, center.y - radius,
+            center.x + radius, center.y + radius,
+            [&](uint32_t i) {
+              const geom::Location location = _states[i].transform.location;
+              if (geom::Math::DistanceSquared(location, center) <= squared_radius) {
+                indices.emplace_back(i);
+              }
+            });
+      }
+    }
+
+    if (filter.use_region) {
+      const geom::Transform region_to_world{filter.region.location, filter.region.rotation};
+      const geom::BoundingBox box{filter.region.extent};
+      float min_x = std::numeric_limits<float>::max();
+      float min_y = std::numeric_limits<float>::max();
+      float max_x = std::numeric_limits<float>::lowest();
+      float max_y = std::numeric_limits<float>::lowest();
+      for (const auto &vertex : box.GetWorldVertices(region_to_world)) {
+        min_x = std::min(min_x, vertex.x);
+        min_y = std::min(min_y, vertex.y);
+        max_x = std::max(max_x, vertex.x);
+        max_y = std::max(max_y, vertex.y);
+      }
+      ForEachInRange(min_x, min_y, max_x, max_y, [&](uint32_t i) {
+        const geom::Location location = _states[i].transform.location;
+        if (box.Contains(location, region_to_world)) {
+          indices.emplace_back(i);
+        }
+      });
+    }
+
+    for (const auto id : filter.actor_ids) {
+      const auto index = _ids.find(id);
+      if (index != _ids.end()) {
+        indices.emplace_back(index->second);
+      }
+    }
+
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+  }
+
+  Buffer EpisodeStateIndex::Serialize(
+      const EpisodeStateSerializer::Header &header,
+      const std::vector<uint32_t> &indices,
+      Buffer &&buffer) const {
+    buffer.reset(sizeof(header) + indices.size() * sizeof(ActorDynamicState));
+    auto *output = buffer.data();
+    std::memcpy(output, &header, sizeof(header));
+    output += sizeof(header);
+    for (const auto i : indices) {
+      DEBUG_ASSERT(i < _count);
+      std::memcpy(output, &_states[i], sizeof(ActorDynamicState));
+      output += sizeof(ActorDynamicState);
+    }
+    return std::move(buffer);
+  }
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
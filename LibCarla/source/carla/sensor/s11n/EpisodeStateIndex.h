@@ -0,0 +1,90 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/NonCopyable.h"
+#include "carla/rpc/EpisodeStateFilter.h"
+#include "carla/sensor/data/ActorDynamicState.h"
+#include "carla/sensor/s11n/EpisodeStateSerializer.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace carla {
+namespace sensor {
+namespace s11n {
+
+  /// 一帧中所有参与者状态的空间索引，用于为每个过滤后的仿真状态流选出
+  /// 需要发送的参与者。
+  ///
+  /// 参与者按 XY 平面上的均匀网格分桶，每帧重建一次，代价与参与者数量成
+  /// 线性关系；之后每个订阅的查询只访问与其范围相交的网格。
+  class EpisodeStateIndex : private NonCopyable {
+  public:
+
+    using ActorDynamicState = data::ActorDynamicState;
+
+    /// @param cell_size 网格边长（米）。
+    explicit EpisodeStateIndex(float cell_size = 50.0f);
+
+    /// 为 @a count 个参与者状态重建索引。不复制状态，@a states 在下次
+    /// Reset 之前必须保持有效。
+    void Reset(const ActorDynamicState *states, size_t count);
+
+    size_t size() const {
+      return _count;
+    }
+
+    /// 将满足 @a filter 的参与者在状态数组中的下标按升序写入 @a indices，
+    /// 即保持与完整仿真状态相同的顺序。
+    void Select(const rpc::EpisodeStateFilter &filter, std::vector<uint32_t> &indices) const;
+
+    /// 写入 @a header 与 @a indices 选出的参与者状态，格式与完整的仿真状态
+    /// 相同，客户端按 RawEpisodeState 解析。
+    Buffer Serialize(
+        const EpisodeStateSerializer::Header &header,
+        const std::vector<uint32_t> &indices,
+        Buffer &&buffer) const;
+
+  private:
+
+    using CellKey = uint64_t;
+
+    CellKey GetCellKey(int32_t x, int32_t y) const {
+      return (static_cast<CellKey>(static_cast<uint32_t>(x)) << 32u) | static_cast<uint32_t>(y);
+    }
+
+    /// 超出 int32 范围的坐标（包括无穷大）饱和到边界，NaN 映射为最小值。
+    int32_t ToCell(float coordinate) const;
+
+    /// 对 XY 平面上 [min, max] 范围内的网格中的每个参与者调用 @a callback。
+    /// 范围内的网格比已占用的网格多时改为遍历已占用的网格，因此耗时不会
+    /// 超过与已占用网格数成正比。
+    template <typename Functor>
+    void ForEachInRange(float min_x, float min_y, float max_x, float max_y, Functor &&callback) const;
+
+    const float _cell_size;
+
+    const ActorDynamicState *_states = nullptr;
+
+    size_t _count = 0u;
+
+    /// 按网格排序的参与者下标。
+    std::vector<std::pair<CellKey, uint32_t>> _sorted;
+
+    /// 网格 -> 在 _sorted 中的范围 [first, last)。
+    std::unordered_map<CellKey, std::pair<uint32_t, uint32_t>> _cells;
+
+    std::unordered_map<ActorId, uint32_t> _ids;
+  };
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
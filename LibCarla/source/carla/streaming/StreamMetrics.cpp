@@ -0,0 +1,461 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/StreamMetrics.h"
+
+#include "carla/Logging.h"
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read_until.hpp>
+#include <boost/asio/streambuf.hpp>
+#include <boost/asio/write.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <istream>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <thread>
+
+namespace carla {
+namespace streaming {
+
+  // ===========================================================================
+  // -- StreamCounters ---------------------------------------------------------
+  // ===========================================================================
+
+  static double ToSeconds(uint64_t nanoseconds) {
+    return 1e-9 * static_cast<double>(nanoseconds);
+  }
+
+  void StreamCounters::Duration::Record(const uint64_t nanoseconds) {
+    count.fetch_add(1u, std::memory_order_relaxed);
+    total.fetch_add(nanoseconds, std::memory_order_relaxed);
+    uint64_t current = max.load(std::memory_order_relaxed);
+    while (nanoseconds > current &&
+           !max.compare_exchange_weak(current, nanoseconds, std::memory_order_relaxed)) {}
+  }
+
+  void StreamCounters::Duration::Reset() {
+    count.store(0u, std::memory_order_relaxed);
+    total.store(0u, std::memory_order_relaxed);
+    max.store(0u, std::memory_order_relaxed);
+  }
+
+  void StreamCounters::RecordLatency(const uint64_t nanoseconds) {
+    _latency.Record(nanoseconds);
+    const double seconds = ToSeconds(nanoseconds);
+    for (size_t i = 0u; i < STREAM_LATENCY_BUCKETS.size(); ++i) {
+      if (seconds <= STREAM_LATENCY_BUCKETS[i]) {
+        _latency_buckets[i].fetch_add(1u, std::memory_order_relaxed);
+        break;
+      }
+    }
+  }
+
+  StreamStatistics StreamCounters::GetStatistics() const {
+    StreamStatistics result;
+    result.stream_id = _stream_id;
+    result.messages_sent = _messages_sent.load(std::memory_order_relaxed);
+    result.bytes_sent = _bytes_sent.load(std::memory_order_relaxed);
+    result.messages_dropped = _messages_dropped.load(std::memory_order_relaxed);
+    result.write_wait_count = _write_wait.count.load(std::memory_order_relaxed);
+    result.write_wait_total = ToSeconds(_write_wait.total.load(std::memory_order_relaxed));
+    result.write_wait_max = ToSeconds(_write_wait.max.load(std::memory_order_relaxed));
+    result.messages_received = _messages_received.load(std::memory_order_relaxed);
+    result.bytes_received = _bytes_received.load(std::memory_order_relaxed);
+    result.reconnects = _reconnects.load(std::memory_order_relaxed);
+    result.latency_count = _latency.count.load(std::memory_order_relaxed);
+    result.latency_total = ToSeconds(_latency.total.load(std::memory_order_relaxed));
+    result.latency_max = ToSeconds(_latency.max.load(std::memory_order_relaxed));
+    for (size_t i = 0u; i < _latency_buckets.size(); ++i) {
+      result.latency_buckets[i] = _latency_buckets[i].load(std::memory_order_relaxed);
+    }
+    return result;
+  }
+
+  void StreamCounters::Reset() {
+    _messages_sent.store(0u, std::memory_order_relaxed);
+    _bytes_sent.store(0u, std::memory_order_relaxed);
+    _messages_dropped.store(0u, std::memory_order_relaxed);
+    _write_wait.Reset();
+    _messages_received.store(0u, std::memory_order_relaxed);
+    _bytes_received.store(0u, std::memory_order_relaxed);
+    _reconnects.store(0u, std::memory_order_relaxed);
+    _latency.Reset();
+    for (auto &bucket : _latency_buckets) {
+      bucket.store(0u, std::memory_order_relaxed);
+    }
+  }
+
+  // ===========================================================================
+  // -- StreamMetrics ----------------------------------------------------------
+  // ===========================================================================
+
+  namespace {
+
+    struct Registry {
+      std::mutex mutex;
+      std::map<stream_id_type, std::shared_ptr<StreamCounters>> streams;
+    };
+
+    static Registry &GetRegistry() {
+      static Registry registry;
+      return registry;
+    }
+
+    /// 每个指标的说明与类型，写出时每个指标只输出一次。
+    static void WriteHeader(std::ostream &out, const char *name, const char *type, const char *help) {
+      out << "# HELP " << name << ' ' << help << '\n';
+      out << "# TYPE " << name << ' ' << type << '\n';
+    }
+
+    template <typename Getter>
+    static void WriteMetric(
+        std::ostream &out,
+        const std::vector<StreamStatistics> &streams,
+        const char *name,
+        const char *type,
+        const char *help,
+        Getter &&get) {
+      WriteHeader(out, name, type, help);
+      for (const auto &stream : streams) {
+        out << name << "{stream_id=\"" << stream.stream_id << "\"} " << get(stream) << '\n';
+      }
+    }
+
+    /// 本地 HTTP 端点，每个请求都返回当前的统计数据。
+    class MetricsServer {
+    public:
+
+      MetricsServer() : _acceptor(_io_context) {}
+
+      /// 在 @a address:@a port 上开始监听。使用 error_code 版本的接口，
+      /// 服务器端不启用异常（LIBCARLA_NO_EXCEPTIONS）时同样可用。
+      bool Listen(const std::string &address, uint16_t port, boost::system::error_code &ec) {
+        const auto ip = boost::asio::ip::make_address(address, ec);
+        if (ec) {
+          return false;
+        }
+        const boost::asio::ip::tcp::endpoint endpoint{ip, port};
+        _acceptor.open(endpoint.protocol(), ec);
+        if (!ec) {
+          _acceptor.set_option(boost::asio::ip::tcp::acceptor::reuse_address(true), ec);
+        }
+        if (!ec) {
+          _acceptor.bind(endpoint, ec);
+        }
+        if (!ec) {
+          _acceptor.listen(boost::asio::socket_base::max_listen_connections, ec);
+        }
+        if (ec) {
+          return false;
+        }
+        Accept();
+        _thread = std::thread([this]() { _io_context.run(); });
+        return true;
+      }
+
+      ~MetricsServer() {
+        _io_context.stop();
+        if (_thread.joinable()) {
+          _thread.join();
+        }
+      }
+
+      uint16_t GetPort() const {
+        boost::system::error_code ec;
+        const auto endpoint = _acceptor.local_endpoint(ec);
+        return ec ? uint16_t(0u) : endpoint.port();
+      }
+
+    private:
+
+      struct Connection {
+        explicit Connection(boost::asio::io_context &io_context) : socket(io_context) {}
+
+        boost::asio::ip::tcp::socket socket;
+        /// 请求头的长度上限，超出时读取失败并断开连接。
+        boost::asio::streambuf request{8192u};
+        std::string response;
+      };
+
+      void Accept() {
+        auto connection = std::make_shared<Connection>(_io_context);
+        _acceptor.async_accept(connection->socket, [this, connection](boost::system::error_code ec) {
+          if (!ec) {
+            Serve(connection);
+          } else if (ec == boost::asio::error::operation_aborted) {
+            return;
+          }
+          Accept();
+        });
+      }
+
+      static void Serve(std::shared_ptr<Connection> connection) {
+        boost::asio::async_read_until(
+            connection->socket,
+            connection->request,
+            "\r\n\r\n",
+            [connection](boost::system::error_code ec, size_t) {
+          if (ec) {
+            return;
+          }
+          std::istream request(&connection->request);
+          std::string method;
+          std::string path;
+          request >> method >> path;
+          std::ostringstream response;
+          if (method == "GET" && (path == "/metrics" || path == "/")) {
+            std::ostringstream body;
+            StreamMetrics::ExportPrometheus(body);
+            const auto content = body.str();
+            response << "HTTP/1.1 200 OK\r\n"
+                     << "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                     << "Content-Length: " << content.size() << "\r\n"
+                     << "Connection: close\r\n\r\n"
+                     << content;
+          } else {
+            response << "HTTP/1.1 404 Not Found\r\n"
+                     << "Content-Length: 0\r\n"
+                     << "Connection: close\r\n\r\n";
+          }
+          connection->response = response.str();
+          boost::asio::async_write(
+              connection->socket,
+              boost::asio::buffer(connection->response),
+              [connection](boost::system::error_code, size_t) {
+            boost::system::error_code ignored;
+            connection->socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ignored);
+            connection->socket.close(ignored);
+          });
+        });
+      }
+
+      boost::asio::io_context _io_context;
+
+      boost::asio::ip::tcp::acceptor _acceptor;
+
+      std::thread _thread;
+    };
+
+    struct ServerHolder {
+      std::mutex mutex;
+      std::unique_ptr<MetricsServer> server;
+    };
+
+    static ServerHolder &GetServerHolder() {
+      static ServerHolder holder;
+      return holder;
+    }
+
+    /// 处理 CARLA_STREAM_METRICS_PORT 与 CARLA_STREAM_METRICS_FILE。
+    class MetricsEnvironment {
+    public:
+
+      MetricsEnvironment() {
+        // 先构造注册表与 HTTP 端点，保证它们在本对象之后析构。
+        GetRegistry();
+        GetServerHolder();
+        const char *port = std::getenv("CARLA_STREAM_METRICS_PORT");
+        if (port != nullptr && port[0] != '\0') {
+          StreamMetrics::StartServer(static_cast<uint16_t>(std::atoi(port)));
+        }
+        const char *filename = std::getenv("CARLA_STREAM_METRICS_FILE");
+        if (filename != nullptr && filename[0] != '\0') {
+          _filename = filename;
+        }
+      }
+
+      ~MetricsEnvironment() {
+        StreamMetrics::StopServer();
+        if (!_filename.empty()) {
+          StreamMetrics::ExportPrometheus(_filename);
+        }
+      }
+
+    private:
+
+      std::string _filename;
+    };
+
+    static MetricsEnvironment METRICS_ENVIRONMENT;
+
+  } // namespace
+
+  std::shared_ptr<StreamCounters> StreamMetrics::Get(const stream_id_type stream_id) {
+    auto &registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto &counters = registry.streams[stream_id];
+    if (counters == nullptr) {
+      counters = std::make_shared<StreamCounters>(stream_id);
+    }
+    return counters;
+  }
+
+  StreamStatistics StreamMetrics::GetStatistics(const stream_id_type stream_id) {
+    std::shared_ptr<StreamCounters> counters;
+    {
+      auto &registry = GetRegistry();
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      auto it = registry.streams.find(stream_id);
+      if (it != registry.streams.end()) {
+        counters = it->second;
+      }
+    }
+    if (counters == nullptr) {
+      StreamStatistics result;
+      result.stream_id = stream_id;
+      return result;
+    }
+    return counters->GetStatistics();
+  }
+
+  std::vector<StreamStatistics> StreamMetrics::GetStatistics() {
+    std::vector<std::shared_ptr<StreamCounters>> streams;
+    {
+      auto &registry = GetRegistry();
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      streams.reserve(registry.streams.size());
+      for (const auto &item : registry.streams) {
+        streams.emplace_back(item.second);
+      }
+    }
+    std::vector<StreamStatistics> result;
+    result.reserve(streams.size());
+    for (const auto &counters : streams) {
+      result.emplace_back(counters->GetStatistics());
+    }
+    return result;
+  }
+
+  void StreamMetrics::Reset() {
+    auto &registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (auto it = registry.streams.begin(); it != registry.streams.end();) {
+      if (it->second.use_count() == 1) {
+        it = registry.streams.erase(it);
+      } else {
+        it->second->Reset();
+        ++it;
+      }
+    }
+  }
+
+  void StreamMetrics::ExportPrometheus(std::ostream &out) {
+    const auto streams = GetStatistics();
+    const auto precision = out.precision(9);
+    WriteMetric(out, streams, "carla_stream_messages_sent_total", "counter",
+        "Messages written to the socket by the streaming server.",
+        [](const auto &s) { return s.messages_sent; });
+    WriteMetric(out, streams, "carla_stream_bytes_sent_total", "counter",
+        "Payload bytes written to the socket by the streaming server.",
+        [](const auto &s) { return s.bytes_sent; });
+    WriteMetric(out, streams, "carla_stream_messages_dropped_total", "counter",
+        "Messages discarded because the previous message was still being sent.",
+        [](const auto &s) { return s.messages_dropped; });
+    WriteMetric(out, streams, "carla_stream_messages_received_total", "counter",
+        "Messages read from the socket by the streaming client.",
+        [](const auto &s) { return s.messages_received; });
+    WriteMetric(out, streams, "carla_stream_bytes_received_total", "counter",
+        "Payload bytes read from the socket by the streaming client.",
+        [](const auto &s) { return s.bytes_received; });
+    WriteMetric(out, streams, "carla_stream_reconnects_total", "counter",
+        "Connection attempts of the streaming client after the first one.",
+        [](const auto &s) { return s.reconnects; });
+
+    WriteHeader(out, "carla_stream_write_wait_seconds", "summary",
+        "Time a message waited for the previous message to be sent.");
+    for (const auto &stream : streams) {
+      out << "carla_stream_write_wait_seconds_sum{stream_id=\"" << stream.stream_id << "\"} "
+          << stream.write_wait_total << '\n';
+      out << "carla_stream_write_wait_seconds_count{stream_id=\"" << stream.stream_id << "\"} "
+          << stream.write_wait_count << '\n';
+    }
+    WriteMetric(out, streams, "carla_stream_write_wait_seconds_max", "gauge",
+        "Longest time a message waited for the previous message to be sent.",
+        [](const auto &s) { return s.write_wait_max; });
+
+    WriteHeader(out, "carla_stream_latency_seconds", "histogram",
+        "Time from the sensor timestamp to the delivery of the data to the client callback.");
+    for (const auto &stream : streams) {
+      uint64_t cumulative = 0u;
+      for (size_t i = 0u; i < STREAM_LATENCY_BUCKETS.size(); ++i) {
+        cumulative += stream.latency_buckets[i];
+        out << "carla_stream_latency_seconds_bucket{stream_id=\"" << stream.stream_id
+            << "\",le=\"" << STREAM_LATENCY_BUCKETS[i] << "\"} " << cumulative << '\n';
+      }
+      out << "carla_stream_latency_seconds_bucket{stream_id=\"" << stream.stream_id
+          << "\",le=\"+Inf\"} " << stream.latency_count << '\n';
+      out << "carla_stream_latency_seconds_sum{stream_id=\"" << stream.stream_id << "\"} "
+          << stream.latency_total << '\n';
+      out << "carla_stream_latency_seconds_count{stream_id=\"" << stream.stream_id << "\"} "
+          << stream.latency_count << '\n';
+    }
+    WriteMetric(out, streams, "carla_stream_latency_seconds_max", "gauge",
+        "Longest time from the sensor timestamp to the delivery of the data to the client callback.",
+        [](const auto &s) { return s.latency_max; });
+    out.precision(precision);
+  }
+
+  bool StreamMetrics::ExportPrometheus(const std::string &filename) {
+    const std::string temporary = filename + ".tmp";
+    {
+      std::ofstream out(temporary, std::ios_base::out | std::ios_base::trunc);
+      if (!out.is_open()) {
+        log_error("stream metrics: unable to open", temporary);
+        return false;
+      }
+      ExportPrometheus(out);
+      if (!out.good()) {
+        return false;
+      }
+    }
+#ifdef _WIN32
+    // Windows 上 rename 不会覆盖已有的文件。
+    std::remove(filename.c_str());
+#endif
+    if (std::rename(temporary.c_str(), filename.c_str()) != 0) {
+      log_error("stream metrics: unable to write", filename);
+      return false;
+    }
+    return true;
+  }
+
+  bool StreamMetrics::StartServer(const uint16_t port, const std::string &address) {
+    auto &holder = GetServerHolder();
+    std::lock_guard<std::mutex> lock(holder.mutex);
+    holder.server.reset();
+    auto server = std::make_unique<MetricsServer>();
+    boost::system::error_code ec;
+    if (!server->Listen(address, port, ec)) {
+      log_error("stream metrics: unable to serve on", address, "port", port, ':', ec.message());
+      return false;
+    }
+    holder.server = std::move(server);
+    log_info("stream metrics: serving on", address, "port", holder.server->GetPort());
+    return true;
+  }
+
+  void StreamMetrics::StopServer() {
+    auto &holder = GetServerHolder();
+    std::lock_guard<std::mutex> lock(holder.mutex);
+    holder.server.reset();
+  }
+
+  uint16_t StreamMetrics::GetServerPort() {
+    auto &holder = GetServerHolder();
+    std::lock_guard<std::mutex> lock(holder.mutex);
+    return holder.server != nullptr ? holder.server->GetPort() : 0u;
+  }
+
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,192 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/streaming/detail/Types.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace streaming {
+
+  using detail::stream_id_type;
+
+  /// 延迟直方图各个桶的上界（秒），最后一个桶之外的样本只计入总数。
+  static constexpr std::array<double, 12u> STREAM_LATENCY_BUCKETS = {
+      0.001, 0.002, 0.005, 0.01, 0.02, 0.05, 0.1, 0.2, 0.5, 1.0, 2.0, 5.0};
+
+  /// 某个流在某一时刻的统计数据快照，时间单位为秒。
+  struct StreamStatistics {
+    stream_id_type stream_id = 0u;
+
+    /// @name 服务器端
+    /// @{
+
+    uint64_t messages_sent = 0u;
+    uint64_t bytes_sent = 0u;
+    /// 上一条消息尚未发送完毕时（异步模式）被丢弃的消息数。
+    uint64_t messages_dropped = 0u;
+    /// 消息等待上一条消息发送完毕的时间（同步模式），每条发送的消息记录一次。
+    uint64_t write_wait_count = 0u;
+    double write_wait_total = 0.0;
+    double write_wait_max = 0.0;
+
+    /// @}
+    /// @name 客户端
+    /// @{
+
+    uint64_t messages_received = 0u;
+    uint64_t bytes_received = 0u;
+    /// 首次连接之后的连接尝试次数。
+    uint64_t reconnects = 0u;
+    /// 传感器数据的端到端延迟，见 StreamCounters::RecordLatency。
+    uint64_t latency_count = 0u;
+    double latency_total = 0.0;
+    double latency_max = 0.0;
+    /// 每个桶内（不累计）的样本数，与 STREAM_LATENCY_BUCKETS 对应。
+    std::array<uint64_t, STREAM_LATENCY_BUCKETS.size()> latency_buckets{};
+
+    /// @}
+
+    double GetAverageWriteWait() const {
+      return write_wait_count > 0u ? write_wait_total / static_cast<double>(write_wait_count) : 0.0;
+    }
+
+    double GetAverageLatency() const {
+      return latency_count > 0u ? latency_total / static_cast<double>(latency_count) : 0.0;
+    }
+  };
+
+  /// 单个流的计数器。所有方法都是无锁的，只做几次 relaxed 原子操作，可以在
+  /// 网络线程的热路径上调用；通过 StreamMetrics::Get 取得后应保存下来重复使用。
+  class StreamCounters {
+  public:
+
+    explicit StreamCounters(stream_id_type stream_id) : _stream_id(stream_id) {}
+
+    stream_id_type GetStreamId() const {
+      return _stream_id;
+    }
+
+    void RecordSent(size_t bytes) {
+      _messages_sent.fetch_add(1u, std::memory_order_relaxed);
+      _bytes_sent.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    void RecordDropped() {
+      _messages_dropped.fetch_add(1u, std::memory_order_relaxed);
+    }
+
+    void RecordWriteWait(uint64_t nanoseconds) {
+      _write_wait.Record(nanoseconds);
+    }
+
+    void RecordReceived(size_t bytes) {
+      _messages_received.fetch_add(1u, std::memory_order_relaxed);
+      _bytes_received.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    void RecordReconnect() {
+      _reconnects.fetch_add(1u, std::memory_order_relaxed);
+    }
+
+    /// 记录一条传感器数据的延迟：从同一帧的世界状态到达客户端到数据交给用户回调的时间。
+    void RecordLatency(uint64_t nanoseconds);
+
+    StreamStatistics GetStatistics() const;
+
+    void Reset();
+
+    /// steady_clock 的当前时间，单位为纳秒。
+    static uint64_t Now() {
+      return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+  private:
+
+    /// 耗时的样本数、总和与最大值（纳秒）。
+    struct Duration {
+      std::atomic<uint64_t> count{0u};
+      std::atomic<uint64_t> total{0u};
+      std::atomic<uint64_t> max{0u};
+
+      void Record(uint64_t nanoseconds);
+
+      void Reset();
+    };
+
+    const stream_id_type _stream_id;
+
+    std::atomic<uint64_t> _messages_sent{0u};
+
+    std::atomic<uint64_t> _bytes_sent{0u};
+
+    std::atomic<uint64_t> _messages_dropped{0u};
+
+    Duration _write_wait;
+
+    std::atomic<uint64_t> _messages_received{0u};
+
+    std::atomic<uint64_t> _bytes_received{0u};
+
+    std::atomic<uint64_t> _reconnects{0u};
+
+    Duration _latency;
+
+    std::array<std::atomic<uint64_t>, STREAM_LATENCY_BUCKETS.size()> _latency_buckets{};
+  };
+
+  /// 按流 id 统计流式传输的带宽与延迟。
+  ///
+  /// 服务器会话记录发送、丢弃的消息与写入等待时间，客户端记录接收的消息、
+  /// 重连次数与传感器数据的端到端延迟；同一进程中的服务器与客户端共用一个
+  /// 注册表。统计数据可以查询，也可以导出为 Prometheus 文本格式写入文件，或由
+  /// 本地的 HTTP 端点（/metrics）提供给 Prometheus 抓取。
+  ///
+  /// 环境变量 CARLA_STREAM_METRICS_PORT 非空时，进程启动即在该端口提供 HTTP
+  /// 端点；CARLA_STREAM_METRICS_FILE 非空时，进程退出时把统计数据写入该文件。
+  class StreamMetrics {
+  public:
+
+    /// 返回流 @a stream_id 的计数器，不存在时创建。需要加锁，不应在每条消息上调用。
+    static std::shared_ptr<StreamCounters> Get(stream_id_type stream_id);
+
+    /// 流 @a stream_id 的统计数据，流尚未传输任何数据时所有计数为 0。
+    static StreamStatistics GetStatistics(stream_id_type stream_id);
+
+    /// 所有流的统计数据，按流 id 排序。
+    static std::vector<StreamStatistics> GetStatistics();
+
+    /// 将所有计数清零，并移除不再使用的流。
+    static void Reset();
+
+    /// 以 Prometheus 文本格式（0.0.4）写出所有流的统计数据。
+    static void ExportPrometheus(std::ostream &out);
+
+    /// 写入文件，成功时返回 true。先写入临时文件再重命名，抓取方不会读到一半的内容。
+    static bool ExportPrometheus(const std::string &filename);
+
+    /// 在本地端口 @a port 上提供 HTTP 端点，返回是否成功；已经在运行时先停止。
+    /// @a port 为 0 时由系统选择端口，见 GetServerPort。
+    static bool StartServer(uint16_t port, const std::string &address = "127.0.0.1");
+
+    static void StopServer();
+
+    /// HTTP 端点的端口，没有运行时返回 0。
+    static uint16_t GetServerPort();
+  };
+
+} // namespace streaming
+} // namespace carla
@@ -11,6 +11,8 @@
 #include "carla/Exception.h"
 #include "carla/Logging.h"
 #include "carla/Time.h"
+#include "carla/profiler/Tracer.h"
+#include "carla/streaming/StreamMetrics.h"
 
 // C++ Boost Asio是一个基于事件驱动的网络编程库，提供了异步的、非阻塞的网络编程接口。
 #include <boost/asio/connect.hpp>
@@ -81,7 +83,8 @@ namespace tcp {
       _socket(io_context),
       _strand(io_context),
       _connection_timer(io_context),
-      _buffer_pool(std::make_shared<BufferPool>()) {
+      _buffer_pool(std::make_shared<BufferPool>()),
+      _metrics(StreamMetrics::Get(token.get_stream_id())) {
     if (!_token.protocol_is_tcp()) {
       throw_exception(std::invalid_argument("invalid token, only TCP tokens supported"));
     }
@@ -99,6 +102,11 @@ namespace tcp {
 
       using boost::system::error_code;
 
+      if (_connect_attempted) {
+        _metrics->RecordReconnect();
+      }
+      _connect_attempted = true;
+
       if (_socket.is_open()) {
         _socket.close();
       }
@@ -195,6 +203,9 @@ namespace tcp {
           DEBUG_ASSERT_NE(bytes, 0u);
           // 将缓冲区移动到回调函数并开始读取下一块数据。
           // log_debug("streaming client: success reading data, calling the callback");
+          CARLA_TRACE_SCOPE("stream", "Client::Callback");
+          CARLA_TRACE_COUNTER("stream", "Client::bytes_received", message->size());
+          _metrics->RecordReceived(message->size());
           self->_callback(message->pop());
           ReadData();
         } else {
@@ -27,6 +27,9 @@ namespace carla {
   class BufferPool;
 
 namespace streaming {
+
+  class StreamCounters;
+
 namespace detail {
 namespace tcp {
 
@@ -107,6 +110,10 @@ namespace tcp {
 ///
 /// 这是一个原子布尔值，用于在线程之间安全地表示客户端是否已完成其工作。初始值为false，表示客户端仍在运行。
     std::atomic_bool _done{false};
+    /// @brief 流的统计计数器。
+    std::shared_ptr<StreamCounters> _metrics;
+    /// @brief 是否已经尝试过连接，之后的每次连接尝试都计为一次重连。
+    bool _connect_attempted = false;
   };
 
 } // namespace tcp
@@ -9,6 +9,8 @@
 
 #include "carla/Debug.h"
 #include "carla/Logging.h"
+#include "carla/profiler/Tracer.h"
+#include "carla/streaming/StreamMetrics.h"
 
 #include <boost/asio/read.hpp>
 #include <boost/asio/write.hpp>
@@ -68,6 +70,7 @@ namespace tcp {
           DEBUG_ASSERT_EQ(bytes_received, sizeof(_stream_id));
           // 打印调试信息，表示会话已启动
           log_debug("session", _session_id, "for stream", _stream_id, " started");
+          _metrics = StreamMetrics::Get(_stream_id);
           // 在strand的上下文环境中执行回调函数
           boost::asio::post(_strand.context(), [=]() { callback(self); });
         } else {
@@ -97,22 +100,36 @@ namespace tcp {
       if (!_socket.is_open()) {
         return;
       }
+      uint64_t write_wait = 0u;
       if (_is_writing) {
         if (_server.IsSynchronousMode()) {
           // 等待上一条消息发送完毕
+          const auto wait_begin = StreamCounters::Now();
           while (_is_writing) {
             std::this_thread::yield();
           }
+          write_wait = StreamCounters::Now() - wait_begin;
         } else {
           // 忽略该消息
           log_debug("session", _session_id, ": connection too slow: message discarded");
+          if (_metrics != nullptr) {
+            _metrics->RecordDropped();
+          }
           return;
         }
       }
+      if (_metrics != nullptr) {
+        _metrics->RecordWriteWait(write_wait);
+      }
       _is_writing = true;
+      // 追踪开启时记录从发起写入到写入完成的时间区间
+      const uint64_t write_begin = profiler::Tracer::IsEnabled() ? profiler::Tracer::Now() : 0u;
 // 定义消息发送完成后的回调函数
-      auto handle_sent = [this, self, message](const boost::system::error_code &ec, size_t DEBUG_ONLY(bytes)) {
+      auto handle_sent = [this, self, message, write_begin](const boost::system::error_code &ec, size_t DEBUG_ONLY(bytes)) {
         _is_writing = false;
+        if (write_begin != 0u) {
+          profiler::Tracer::RecordSpan("stream", "ServerSession::Write", write_begin, profiler::Tracer::Now());
+        }
         if (ec) {
         	// 如果发送出错，打印错误信息并立即关闭会话
           log_info("session", _session_id, ": error sending data :", ec.message());
@@ -121,6 +138,9 @@ namespace tcp {
         	// 如果发送成功，打印调试信息（可选）并断言发送的字节数正确
           DEBUG_ONLY(log_debug("session", _session_id, ": successfully sent", bytes, "bytes"));
           DEBUG_ASSERT_EQ(bytes, sizeof(message_size_type) + message->size());
+          if (_metrics != nullptr) {
+            _metrics->RecordSent(message->size());
+          }
         }
       };
 // 打印调试信息，表示要发送的消息大小
@@ -108,6 +108,9 @@
                 */
 namespace carla {
 namespace streaming {
+
+  class StreamCounters;
+
 namespace detail {
 namespace tcp {
     /**
@@ -245,6 +248,8 @@ namespace tcp {
     callback_function_type _on_closed;
     /// @brief 表示当前是否正在进行写入操作的标志。
     bool _is_writing = false;
+    /// @brief 流的统计计数器，收到流ID后创建。
+    std::shared_ptr<StreamCounters> _metrics;
   };
 
 } // namespace tcp
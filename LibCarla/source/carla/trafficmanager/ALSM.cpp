@@ -46,52 +46,29 @@ ALSM::ALSM(
 void ALSM::Update() {
   //获取是否启用混合物理模式参数
   bool hybrid_physics_mode = parameters.GetHybridPhysicsMode();
-  //定义两个集合用于存储世界中的车辆 ID 和行人 ID
-  std::set<ActorId> world_vehicle_ids;
-  std::set<ActorId> world_pedestrian_ids;
-  //存储待删除的未注册参与者的 ID 列表
-  std::vector<ActorId> unregistered_list_to_be_deleted;
 
-  current_timestamp = world.GetSnapshot().GetTimestamp(); //获取当前时间截
-  ActorList world_actors = world.GetActors();//获取当前世界中的所有参与者列表
+  const cc::WorldSnapshot snapshot = world.GetSnapshot(); //获取当前世界快照
+  current_timestamp = snapshot.GetTimestamp(); //获取当前时间截
+
+  // 根据与上一帧参与者 ID 集合的差异得到生成和销毁的参与者
+  const ActorDelta actor_delta = actor_tracker.Update(
+      snapshot.GetId(),
+      snapshot.GetActorIdDigest(),
+      snapshot.size(),
+      snapshot.GetActorIds());
 
   // 找到已经销毁的参与者并进行清理
-  const ALSM::DestroyeddActors destroyed_actors = IdentifyDestroyedActors(world_actors);
-  
-  //处理已注册的被销毁的参与者
-  const ActorIdSet &destroyed_registered = destroyed_actors.first;
-  for (const auto &deletion_id: destroyed_registered) {
-    RemoveActor(deletion_id, true); //删除角色并标记为注册参与者
-  }
-  //处理未注册的被销毁参与者
-  const ActorIdSet &destroyed_unregistered = destroyed_actors.second;
-  for (auto deletion_id : destroyed_unregistered) {
-    RemoveActor(deletion_id, false);
-  }
+  RemoveDestroyedActors(actor_delta.removed);
 
-  // 检查英雄参与者是否存活，如果英雄参与者已被销毁，则将其从英雄列表中移除
-  if (hero_actors.size() != 0u) {
-    ActorIdSet hero_actors_to_delete;
-    //遍历英雄参与者，查看它们是否已被销毁
-    for (auto &hero_actor_info: hero_actors) { 
-    //如果在未注册销毁列表中找到英雄参与者，则标记其删除
-      if (destroyed_unregistered.find(hero_actor_info.first) != destroyed_unregistered.end()) {
-        hero_actors_to_delete.insert(hero_actor_info.first);
-      }
-      //如果在已注册销毁列表中找到英雄参与者，则标记其删除
-      if (destroyed_registered.find(hero_actor_info.first) != destroyed_registered.end()) {
-        hero_actors_to_delete.insert(hero_actor_info.first);
-      }
-    }
-    
-    //删除所有已标记的英雄参与者
-    for (auto &deletion_id: hero_actors_to_delete) {
-      hero_actors.erase(deletion_id);
-    }
+  // 已注册车辆集合发生变化时，同步未注册参与者集合
+  const int current_registered_vehicles_state = registered_vehicles.GetState();
+  if (current_registered_vehicles_state != registered_vehicles_state) {
+    SynchronizeRegisteredActors();
+    registered_vehicles_state = current_registered_vehicles_state;
   }
 
-  // 扫描并识别新的未注册参与者
-  IdentifyNewActors(world_actors);
+  // 识别并缓存新的参与者
+  IdentifyNewActors(actor_delta.added);
 
   // 更新所有已注册的车辆的动态状态和静态属性
   ALSM::IdleInfo max_idle_time = std::make_pair(0u, current_timestamp.elapsed_seconds);
@@ -123,69 +100,76 @@ void ALSM::Update() {
 }
 
 //识别新的参与者
-void ALSM::IdentifyNewActors(const ActorList &actor_list) {
-    //遍历传入的参与者列表
+void ALSM::IdentifyNewActors(const std::vector<ActorId> &actor_ids) {
+  if (actor_ids.empty()) {
+    return;
+  }
+  // 只为新生成的参与者获取描述，类型与英雄身份在此缓存一次
+  const auto actor_list = world.GetActors(actor_ids);
   for (auto iter = actor_list->begin(); iter != actor_list->end(); ++iter) {
     ActorPtr actor = *iter; //获取当前的参与者对象
     ActorId actor_id = actor->GetId(); //获取当前参与者的唯一标识符（ID）
-    // 识别新的英雄车辆
-    if (actor->GetTypeId().front() == 'v') { //通过其类型（ID）判断当前参与者
-     //如果没有任何已识别的英雄车辆，或者该参与者不在英雄参与者列表中
-     if (hero_actors.size() == 0u || hero_actors.find(actor_id) == hero_actors.end()) {
-      //遍历该参与者的所有属性
+    const std::string &type_id = actor->GetTypeId();
+
+    TrackedActor tracked_actor {actor, ActorType::Any, false};
+    if (type_id.front() == 'v') { //通过其类型（ID）判断当前参与者
+      tracked_actor.type = ActorType::Vehicle;
+      //如果属性的 ID 是 "role_name"，并且其值是 "hero"，则为英雄车辆
       for (auto&& attribute: actor->GetAttributes()) {
-        //如果属性的 ID 是 "role_name"，并且其值是 "hero"
         if (attribute.GetId() == "role_name" && attribute.GetValue() == "hero") {
-         //将英雄车辆插入到英雄列表中
-          hero_actors.insert({actor_id, actor});
+          tracked_actor.is_hero = true;
+          hero_actors.insert({actor_id, actor}); //将英雄车辆插入到英雄列表中
         }
       }
+    } else if (type_id.front() == 'w') {
+      tracked_actor.type = ActorType::Pedestrian;
     }
-  }
-    //如果该参与者不在已注册车辆列表中，且不在未注册的参与者列表中
-    if (!registered_vehicles.Contains(actor_id)
-        && unregistered_actors.find(actor_id) == unregistered_actors.end()) {
-      //将该参与者添加到未注册参与者中
-      unregistered_actors.insert({actor_id, actor});
+    world_actors.insert({actor_id, tracked_actor});
+
+    //如果该参与者不在已注册车辆列表中，则添加到未注册参与者中
+    if (!registered_vehicles.Contains(actor_id)) {
+      unregistered_actors.insert({actor_id, tracked_actor});
     }
   }
 }
 
-//识别已销毁的参与者
-ALSM::DestroyeddActors ALSM::IdentifyDestroyedActors(const ActorList &actor_list) {
-
-  ALSM::DestroyeddActors destroyed_actors; //用于存储销毁的参与者 ID
-  ActorIdSet &deleted_registered = destroyed_actors.first; //存储已销毁的注册车辆的 ID
-  ActorIdSet &deleted_unregistered = destroyed_actors.second; //存储已销毁的未注册参与者的 ID
-
-  //构建当前帧中存在的参与者的哈希集合
-  ActorIdSet current_actors;
-  for  (auto iter = actor_list->begin(); iter != actor_list->end(); ++iter) {
-    current_actors.insert((*iter)->GetId()); //将当前参与者的 ID 插入集合中
+//清理已销毁的参与者
+void ALSM::RemoveDestroyedActors(const std::vector<ActorId> &actor_ids) {
+  for (const ActorId &actor_id : actor_ids) {
+    if (registered_vehicles.Contains(actor_id)) {
+      RemoveActor(actor_id, true); //删除角色并标记为注册参与者
+    } else if (unregistered_actors.find(actor_id) != unregistered_actors.end()) {
+      RemoveActor(actor_id, false);
+    }
+    // 英雄参与者已被销毁，将其从英雄列表中移除
+    hero_actors.erase(actor_id);
+    world_actors.erase(actor_id);
   }
+}
 
-  // 查找被销毁的已注册车辆
-  std::vector<ActorId> registered_ids = registered_vehicles.GetIDList();
-  for (const ActorId &actor_id : registered_ids) {
-    //如果当前帧中不存在某个已注册车辆
-    if (current_actors.find(actor_id) == current_actors.end()) {
-        //将该车辆的 ID 加入到已销毁的注册车辆列表中
-      deleted_registered.insert(actor_id);
+//同步已注册与未注册的参与者
+void ALSM::SynchronizeRegisteredActors() {
+  // 新注册的车辆不再作为未注册参与者处理
+  std::vector<ActorId> newly_registered;
+  for (const auto &actor_info : unregistered_actors) {
+    if (registered_vehicles.Contains(actor_info.first)) {
+      newly_registered.push_back(actor_info.first);
+    }
+  }
+  for (const ActorId &actor_id : newly_registered) {
+    RemoveActor(actor_id, false);
+    if (world_actors.at(actor_id).is_hero) {
+      hero_actors.insert({actor_id, world_actors.at(actor_id).actor});
     }
   }
 
-  // 查找被销毁的未注册参与者
-  for (const auto &actor_info: unregistered_actors) {
-    const ActorId &actor_id = actor_info.first;
-    //如果当前帧中不存在某个未注册的参与者，或者该参与者已经注册为车辆
-     if (current_actors.find(actor_id) == current_actors.end()
-         || registered_vehicles.Contains(actor_id)) {
-      //将该参与者的 ID 加入到已销毁的未注册参与者列表中
-      deleted_unregistered.insert(actor_id);
+  // 取消注册的车辆重新作为未注册参与者处理
+  for (const auto &actor_info : world_actors) {
+    if (unregistered_actors.find(actor_info.first) == unregistered_actors.end()
+        && !registered_vehicles.Contains(actor_info.first)) {
+      unregistered_actors.insert(actor_info);
     }
   }
-  //返回销毁的参与者列表
-  return destroyed_actors;
 }
 
 void ALSM::UpdateRegisteredActorsData(const bool hybrid_physics_mode, ALSM::IdleInfo &max_idle_time) {
@@ -313,8 +297,8 @@ void ALSM::UpdateUnregisteredActorsData() {
   for (auto &actor_info: unregistered_actors) {
 
     const ActorId actor_id = actor_info.first; //获取参与者的 ID
-    const ActorPtr actor_ptr = actor_info.second; //获取参与者的指针
-    const std::string type_id = actor_ptr->GetTypeId(); //获取参与者的类型 ID
+    const ActorPtr actor_ptr = actor_info.second.actor; //获取参与者的指针
+    const ActorType cached_type = actor_info.second.type; //获取缓存的参与者类型
      
     const cg::Transform actor_transform = actor_ptr->GetTransform(); //获取参与者的变换信息
     const cg::Location actor_location = actor_transform.location; //获取参与者的位置
@@ -331,7 +315,7 @@ void ALSM::UpdateUnregisteredActorsData() {
 
     //检查参与者在模拟状态中是否存在条目
     bool state_entry_not_present = !simulation_state.ContainsActor(actor_id);
-    if (type_id.front() == 'v') { //如果是车辆
+    if (cached_type == ActorType::Vehicle) { //如果是车辆
       auto vehicle_ptr = boost::static_pointer_cast<cc::Vehicle>(actor_ptr); //转换为车辆指针
       kinematic_state.speed_limit = vehicle_ptr->GetSpeedLimit(); //获取车辆的速度限制
 
@@ -362,7 +346,7 @@ void ALSM::UpdateUnregisteredActorsData() {
         nearest_waypoints.push_back(nearest_waypoint); //添加到最近路点列表
       }
     }
-    else if (type_id.front() == 'w') { //如果是行人
+    else if (cached_type == ActorType::Pedestrian) { //如果是行人
       auto walker_ptr = boost::static_pointer_cast<cc::Walker>(actor_ptr); //转换为行人指针
 
       if (state_entry_not_present) {
@@ -452,9 +436,12 @@ void ALSM::RemoveActor(const ActorId actor_id, const bool registered_actor) {
 // 重置状态
 void ALSM::Reset() {
   // 清空未注册参与者、空闲时间、英雄参与者等数据
+  world_actors.clear();
   unregistered_actors.clear();
   idle_time.clear();
   hero_actors.clear();
+  actor_tracker.Reset();
+  registered_vehicles_state = -1;
   elapsed_last_actor_destruction = 0.0; // 重置上次参与者销毁的时间
   current_timestamp = world.GetSnapshot().GetTimestamp(); // 更新当前时间截
 }
@@ -8,6 +8,7 @@
 #include "carla/client/World.h"
 #include "carla/Memory.h"
 
+#include "carla/trafficmanager/ActorLifecycleTracker.h"
 #include "carla/trafficmanager/AtomicActorSet.h"
 #include "carla/trafficmanager/CollisionStage.h"
 #include "carla/trafficmanager/DataStructures.h"
@@ -30,22 +31,32 @@ namespace chr = std::chrono;  // 引用时间相关的命名空间
 namespace cg = carla::geom;   // 引用几何相关的命名空间
 namespace cc = carla::client;  // 引用客户端相关的命名空间
 
-using ParticipantList = carla::SharedPtr<cc::ActorList>; // 定义参与者列表共享指针类型
-using ParticipantMap = std::unordered_map<ActorId, ActorPtr>; // 定义参与者映射表类型
+using ActorMap = std::unordered_map<ActorId, ActorPtr>; // 定义参与者映射表类型
 using IdleTimeMap = std::unordered_map<ActorId, double>; // 定义闲置时间映射表类型
 using LocalMapPtr = std::shared_ptr<InMemoryMap>; // 定义本地地图共享指针类型
 
+/// 参与者首次出现时缓存的信息，之后每帧不再查询类型与属性
+struct TrackedActor {
+  ActorPtr actor;   // 参与者指针
+  ActorType type;   // 参与者类型，由类型 ID 的首字母确定
+  bool is_hero;     // 是否为 role_name 为 "hero" 的车辆
+};
+using TrackedActorMap = std::unordered_map<ActorId, TrackedActor>; // 定义缓存参与者映射表类型
+
 /// ALSM: 代理生命周期和状态管理
 /// 此类具有更新运动状态本地缓存的功能
 /// 并管理模拟中车辆数量变化的内存和清理。
+/// 参与者的生成与销毁由相邻两帧 EpisodeState 的 ID 集合之差得到，
+/// 每帧的生命周期开销与参与者的变化量成正比，而不是与世界规模成正比。
 class ALSM {
 
 private:
   AtomicActorSet &registered_vehicles; // 引用已注册参与者的原子集合
-  ParticipantMap unregistered_participants; // 存储未注册参与者的结构
+  TrackedActorMap world_actors; // 缓存世界中所有存活的参与者
+  TrackedActorMap unregistered_actors; // 存储未注册参与者的结构
   BufferMap &buffer_map; // 引用缓冲区映射
   IdleTimeMap idle_time; // 存储参与者在位置上停留时间的结构
-  ParticipantMap hero_participants; // 存储角色名称为"hero"的参与者
+  ActorMap hero_actors; // 存储角色名称为"hero"的参与者
   TrackTraffic &track_traffic; // 引用交通跟踪对象
   std::vector<ActorId>& marked_for_removal; // 标记待移除参与者的数组
   const Parameters &parameters; // 引用参数对象
@@ -57,7 +68,9 @@ private:
   TrafficLightStage &traffic_light_stage; // 引用交通灯阶段对象
   MotionPlanStage &motion_plan_stage; // 引用运动规划阶段对象
   VehicleLightStage &vehicle_light_stage; // 引用车辆灯光阶段对象
-  double elapsed_last_participant_destruction {0.0}; // 记录自上次因闲置过久而销毁参与者的时间
+  double elapsed_last_actor_destruction {0.0}; // 记录自上次因闲置过久而销毁参与者的时间
+  ActorLifecycleTracker actor_tracker; // 根据相邻两帧的参与者 ID 集合计算增删
+  int registered_vehicles_state {-1}; // 上次同步时已注册车辆集合的状态计数
   cc::Timestamp current_timestamp; // 当前时间戳
   std::unordered_map<ActorId, bool> has_physics_enabled; // 存储每个参与者是否启用物理的映射
 
@@ -67,23 +80,24 @@ private:
   // 判断一辆车是否长时间停滞不前
   bool IsVehicleStuck(const ActorId& actor_id);
 
-  // 确定自上次更新以来在仿真中新生成的参与者
-  void IdentifyNewParticipants(const ParticipantList &participant_list);
+  // 缓存自上次更新以来在仿真中新生成的参与者
+  void IdentifyNewActors(const std::vector<ActorId> &actor_ids);
+
+  // 清理在上一帧中被销毁的参与者
+  void RemoveDestroyedActors(const std::vector<ActorId> &actor_ids);
 
-  using DestroyeddParticipants = std::pair<ActorIdSet, ActorIdSet>; // 定义删除参与者的数据类型
-  // 确定在上一帧中删除的参与者
-  // 返回已注册和未注册参与者的数组
-  DestroyeddParticipants IdentifyDestroyedParticipants(const ParticipantList &participant_list);
+  // 已注册车辆集合变化后，同步未注册参与者集合
+  void SynchronizeRegisteredActors();
 
   using IdleInfo = std::pair<ActorId, double>; // 定义闲置信息的数据类型
-  void UpdateRegisteredParticipantsData(const bool hybrid_physics_mode, IdleInfo &max_idle_time);
+  void UpdateRegisteredActorsData(const bool hybrid_physics_mode, IdleInfo &max_idle_time);
 
   // 更新参与者数据
   void UpdateData(const bool hybrid_physics_mode, const Actor &vehicle,
                   const bool hero_actor_present, const float physics_radius_square);
 
   // 更新未注册参与者的数据
-  void UpdateUnregisteredParticipantsData();
+  void UpdateUnregisteredActorsData();
 
 public:
   // 构造函数
@@ -105,7 +119,7 @@ public:
   void Update();
 
   // 从交通管理中移除参与者，并清理与该车辆相关的各种数据
-  void RemoveParticipant(const ActorId actor_id, const bool registered_actor);
+  void RemoveActor(const ActorId actor_id, const bool registered_actor);
 
   // 重置方法
   void Reset();
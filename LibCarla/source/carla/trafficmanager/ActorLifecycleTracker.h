@@ -0,0 +1,110 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "carla/rpc/ActorId.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  using ActorId = carla::ActorId;
+
+  /// 相邻两帧之间新增与销毁的参与者。
+  struct ActorDelta {
+    std::vector<ActorId> added;    // 本帧新出现的参与者
+    std::vector<ActorId> removed;  // 本帧已不存在的参与者
+
+    bool empty() const {
+      return added.empty() && removed.empty();
+    }
+  };
+
+  /// 比较相邻两帧 EpisodeState 的参与者 ID 集合，得到参与者的增删。
+  ///
+  /// 参与者数量与 ID 摘要都与上一帧相同时直接返回空增量，不遍历 ID，
+  /// 因此没有参与者生成或销毁的帧几乎没有开销；否则遍历一次本帧的 ID，
+  /// 只为新增的参与者分配内存。
+  class ActorLifecycleTracker {
+
+  public:
+
+    /// @param episode_id 本帧所属的剧集，剧集变化时总会重新比较。
+    /// @param digest 本帧参与者 ID 集合的摘要。
+    /// @param size 本帧参与者的数量。
+    /// @param actor_ids 本帧所有参与者的 ID。
+    template <typename RangeT>
+    ActorDelta Update(
+        uint64_t episode_id,
+        uint64_t digest,
+        size_t size,
+        const RangeT &actor_ids) {
+      ActorDelta delta;
+      if (_initialized &&
+          episode_id == _episode_id &&
+          digest == _digest &&
+          size == _known_actors.size()) {
+        return delta;
+      }
+      _initialized = true;
+      _episode_id = episode_id;
+      _digest = digest;
+
+      // 用帧号标记本帧仍然存在的参与者，未被标记的即为已销毁的参与者。
+      ++_generation;
+      for (const ActorId actor_id : actor_ids) {
+        auto result = _known_actors.emplace(actor_id, _generation);
+        if (result.second) {
+          delta.added.push_back(actor_id);
+        } else {
+          result.first->second = _generation;
+        }
+      }
+      for (auto it = _known_actors.begin(); it != _known_actors.end();) {
+        if (it->second != _generation) {
+          delta.removed.push_back(it->first);
+          it = _known_actors.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      return delta;
+    }
+
+    /// 当前已知存在的参与者数量。
+    size_t size() const {
+      return _known_actors.size();
+    }
+
+    bool Contains(ActorId actor_id) const {
+      return _known_actors.find(actor_id) != _known_actors.end();
+    }
+
+    /// 忘记所有参与者，下一次 Update 会把所有参与者报告为新增。
+    void Reset() {
+      _known_actors.clear();
+      _initialized = false;
+    }
+
+  private:
+
+    std::unordered_map<ActorId, uint64_t> _known_actors; // 参与者 ID 及最后一次出现时的标记
+
+    uint64_t _generation = 0u;
+
+    uint64_t _episode_id = 0u;
+
+    uint64_t _digest = 0u;
+
+    bool _initialized = false;
+  };
+
+} // namespace traffic_manager
+} // namespace carla
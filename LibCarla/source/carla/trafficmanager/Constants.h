@@ -139,6 +139,7 @@ static const float SUN_ALTITUDE_DEGREES_JUST_BEFORE_SUNSET = 145.0f; // 日落
 static const float HEAVY_PRECIPITATION_THRESHOLD = 80.0f; // 大降水阈值
 static const float FOG_DENSITY_THRESHOLD = 20.0f; // 雾密度阈值
 static const float MAX_DISTANCE_LIGHT_CHECK = 225.0f; // 最大光照检测距离
+static const double WORLD_INFO_REFRESH_PERIOD = 1.0; // 重新读取天气与车辆灯光状态的间隔（秒）
 } // namespace VehicleLight
 
 namespace PID {
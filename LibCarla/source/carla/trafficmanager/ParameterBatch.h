@@ -0,0 +1,73 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+#include "carla/rpc/ActorId.h"
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace carla {
+namespace traffic_manager {
+
+  using ActorId = carla::ActorId;
+
+  /// 可以批量设置的逐车辆参数，每个取值对应 TrafficManagerBase 中的一个 setter。
+  enum class VehicleParameter : uint8_t {
+    PercentageSpeedDifference,
+    LaneOffset,
+    DesiredSpeed,
+    DistanceToLeadingVehicle,
+    PercentageIgnoreWalkers,
+    PercentageIgnoreVehicles,
+    PercentageRunningLight,
+    PercentageRunningSign,
+    KeepRightPercentage,
+    RandomLeftLaneChangePercentage,
+    RandomRightLaneChangePercentage,
+    UpdateVehicleLights,   ///< value 非零表示 true
+    AutoLaneChange,        ///< value 非零表示 true
+    ForceLaneChange,       ///< value 非零表示向左
+    SIZE
+  };
+
+  /// 批量参数更新中的一项。只携带参与者 ID 而不是完整的 rpc::Actor，
+  /// 一千辆车的配置只需要十几 KB。
+  ///
+  /// 该结构是平凡可复制的，可以直接放进共享内存（见 SharedControlChannel）。
+  struct ParameterUpdate {
+    ActorId actor_id = 0u;
+    uint8_t parameter = 0u;
+    float value = 0.0f;
+
+    VehicleParameter GetParameter() const {
+      return static_cast<VehicleParameter>(parameter);
+    }
+
+    bool IsValid() const {
+      return parameter < static_cast<uint8_t>(VehicleParameter::SIZE);
+    }
+
+    MSGPACK_DEFINE_ARRAY(actor_id, parameter, value);
+  };
+
+  static_assert(std::is_trivially_copyable<ParameterUpdate>::value, "ParameterUpdate must be trivially copyable");
+
+  using ParameterBatch = std::vector<ParameterUpdate>;
+
+  inline ParameterUpdate MakeParameterUpdate(ActorId actor_id, VehicleParameter parameter, float value) {
+    ParameterUpdate update;
+    update.actor_id = actor_id;
+    update.parameter = static_cast<uint8_t>(parameter);
+    update.value = value;
+    return update;
+  }
+
+} // namespace traffic_manager
+} // namespace carla
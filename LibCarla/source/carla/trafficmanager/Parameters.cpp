@@ -199,6 +199,11 @@ void Parameters::SetOSMMode(const bool mode_switch) {
     osm_mode.store(mode_switch);
 }
 
+void Parameters::SetPipelinedMode(const bool mode_switch) {
+    // 设置流水线模式开关
+    pipelined_mode.store(mode_switch);
+}
+
 void Parameters::SetCustomPath(const ActorPtr &actor, const Path path, const bool empty_buffer) {
     // 设置参与者的自定义路径
     const auto entry = std::make_pair(actor->GetId(), path);
@@ -474,6 +479,11 @@ bool Parameters::GetOSMMode() const {
    return osm_mode.load();
 }
 
+bool Parameters::GetPipelinedMode() const {
+    // 返回是否启用流水线模式的设置
+   return pipelined_mode.load();
+}
+
 bool Parameters::GetUploadPath(const ActorId &actor_id) const {
     // 初始化自定义路径标志
     bool custom_path_bool = false;
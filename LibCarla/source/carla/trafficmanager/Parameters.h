@@ -91,6 +91,8 @@ namespace carla {
             std::atomic<float> hybrid_physics_radius{ 70.0 };
             /// Open Street Map模式参数
             std::atomic<bool> osm_mode{ true };
+            /// 流水线模式开关
+            std::atomic<bool> pipelined_mode{ false };
             /// 是否导入自定义路径的参数映射
             AtomicMap<ActorId, bool> upload_path;
             /// 存储所有自定义路径的结构
@@ -185,6 +187,9 @@ namespace carla {
             /// 设置Open Street Map模式的方法
             void SetOSMMode(const bool mode_switch);///< 是否启用OSM模式的布尔值
 
+            /// 设置流水线模式的方法
+            void SetPipelinedMode(const bool mode_switch);///< 是否在后台提交命令，命令延迟一帧生效（仅异步模式）
+
             /// 设置是否自动重生休眠车辆的方法
             void SetRespawnDormantVehicles(const bool mode_switch); ///< 是否启用的布尔值
 
@@ -280,6 +285,9 @@ namespace carla {
             /// 获取Open Street Map模式的方法
             bool GetOSMMode() const;
 
+            /// 获取流水线模式的方法
+            bool GetPipelinedMode() const;
+
             /// 获取是否正在上传路径的方法
             bool GetUploadPath(const ActorId& actor_id) const;
 
@@ -0,0 +1,233 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/trafficmanager/SharedControlChannel.h"
+
+#include "carla/Debug.h"
+#include "carla/Logging.h"
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/sync/interprocess_condition.hpp>
+#include <boost/interprocess/sync/interprocess_mutex.hpp>
+#include <boost/interprocess/sync/scoped_lock.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+
+namespace carla {
+namespace traffic_manager {
+
+  namespace bip = boost::interprocess;
+
+  constexpr size_t SharedControlChannel::MAX_UPDATES_PER_REQUEST;
+
+  static constexpr uint32_t CONTROL_BLOCK_MAGIC = 0x43544d43u;
+  static constexpr uint32_t CONTROL_BLOCK_VERSION = 2u;
+
+  /// 请求槽的状态：Free -> Pending（客户端写入）-> Processing（服务端取出）
+  /// -> Done（服务端写回结果）-> Free（客户端读取结果）。
+  enum SlotState : uint32_t {
+    SLOT_FREE,
+    SLOT_PENDING,
+    SLOT_PROCESSING,
+    SLOT_DONE
+  };
+
+  /// 放在共享内存中的控制块，两端进程都按此布局访问。
+  struct ControlBlock {
+    uint32_t magic = 0u;
+    uint32_t version = 0u;
+    bip::interprocess_mutex mutex;
+    bip::interprocess_condition request_cv;
+    bip::interprocess_condition reply_cv;
+    uint64_t sequence = 0u;
+    uint32_t state = SLOT_FREE;
+    bool closed = false;
+    /// 客户端在服务端处理期间超时，结果无人读取，完成后直接释放槽。
+    bool abandoned = false;
+    uint32_t update_count = 0u;
+    ParameterUpdate updates[SharedControlChannel::MAX_UPDATES_PER_REQUEST];
+  };
+
+  using scoped_lock = bip::scoped_lock<bip::interprocess_mutex>;
+
+  static boost::posix_time::ptime ToDeadline(SharedControlChannel::time_duration timeout) {
+    return boost::posix_time::microsec_clock::universal_time() +
+        boost::posix_time::milliseconds(timeout.count());
+  }
+
+  struct SharedControlChannel::Impl {
+    std::string name;
+    bool owner = false;
+    bip::shared_memory_object shm;
+    bip::mapped_region region;
+    ControlBlock *block = nullptr;
+  };
+
+  SharedControlChannel::SharedControlChannel(std::unique_ptr<Impl> impl)
+    : _impl(std::move(impl)) {}
+
+  SharedControlChannel::~SharedControlChannel() {
+    if (_impl->owner) {
+      Close();
+      bip::shared_memory_object::remove(_impl->name.c_str());
+    }
+  }
+
+  std::string SharedControlChannel::GetSegmentName(uint16_t port) {
+    return "carla_tm_control_" + std::to_string(port);
+  }
+
+  std::unique_ptr<SharedControlChannel> SharedControlChannel::Create(uint16_t port) {
+    auto impl = std::make_unique<Impl>();
+    impl->name = GetSegmentName(port);
+    impl->owner = true;
+    try {
+      // 上一个服务端异常退出时可能留下同名的共享内存段。
+      bip::shared_memory_object::remove(impl->name.c_str());
+      // 只允许同一用户的进程打开，其他用户无法向服务端注入参数更新。
+#ifdef _WIN32
+      bip::permissions permissions;
+#else
+      bip::permissions permissions(0600);
+#endif // _WIN32
+      impl->shm = bip::shared_memory_object(bip::create_only, impl->name.c_str(), bip::read_write, permissions);
+      impl->shm.truncate(sizeof(ControlBlock));
+      impl->region = bip::mapped_region(impl->shm, bip::read_write);
+      impl->block = new (impl->region.get_address()) ControlBlock();
+      impl->block->version = CONTROL_BLOCK_VERSION;
+      // magic 最后写入，客户端看到它时控制块已经构造完毕。
+      std::atomic_thread_fence(std::memory_order_release);
+      impl->block->magic = CONTROL_BLOCK_MAGIC;
+    } catch (const bip::interprocess_exception &e) {
+      log_warning("traffic manager: shared memory channel unavailable:", e.what());
+      bip::shared_memory_object::remove(impl->name.c_str());
+      return nullptr;
+    }
+    return std::unique_ptr<SharedControlChannel>(new SharedControlChannel(std::move(impl)));
+  }
+
+  std::unique_ptr<SharedControlChannel> SharedControlChannel::Open(uint16_t port) {
+    auto impl = std::make_unique<Impl>();
+    impl->name = GetSegmentName(port);
+    try {
+      impl->shm = bip::shared_memory_object(bip::open_only, impl->name.c_str(), bip::read_write);
+      bip::offset_t size = 0;
+      if (!impl->shm.get_size(size) || size < static_cast<bip::offset_t>(sizeof(ControlBlock))) {
+        return nullptr;
+      }
+      impl->region = bip::mapped_region(impl->shm, bip::read_write);
+      impl->block = static_cast<ControlBlock *>(impl->region.get_address());
+    } catch (const bip::interprocess_exception &) {
+      // 服务端不在本机，或者没有创建共享内存段。
+      return nullptr;
+    }
+    if (impl->block->magic != CONTROL_BLOCK_MAGIC || impl->block->version != CONTROL_BLOCK_VERSION) {
+      return nullptr;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    std::unique_ptr<SharedControlChannel> channel(new SharedControlChannel(std::move(impl)));
+    if (channel->IsClosed()) {
+      return nullptr;
+    }
+    return channel;
+  }
+
+  bool SharedControlChannel::IsClosed() const {
+    auto &block = *_impl->block;
+    scoped_lock lock(block.mutex);
+    return block.closed;
+  }
+
+  bool SharedControlChannel::SubmitUpdates(const ParameterBatch &updates, time_duration timeout) {
+    for (size_t i = 0u; i < updates.size(); i += MAX_UPDATES_PER_REQUEST) {
+      const size_t count = std::min(MAX_UPDATES_PER_REQUEST, updates.size() - i);
+      if (!Submit(updates.data() + i, count, timeout)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool SharedControlChannel::Submit(
+      const ParameterUpdate *updates,
+      const size_t count,
+      const time_duration timeout) {
+    DEBUG_ASSERT(count <= MAX_UPDATES_PER_REQUEST);
+    auto &block = *_impl->block;
+    const auto deadline = ToDeadline(timeout);
+    scoped_lock lock(block.mutex);
+
+    // 等待请求槽空闲（同一时刻可能有多个客户端线程或进程）。
+    const bool slot_free = block.reply_cv.timed_wait(lock, deadline, [&]() {
+      return block.closed || block.state == SLOT_FREE;
+    });
+    if (!slot_free || block.closed) {
+      return false;
+    }
+    std::copy_n(updates, count, block.updates);
+    block.update_count = static_cast<uint32_t>(count);
+    block.abandoned = false;
+    block.state = SLOT_PENDING;
+    const uint64_t sequence = ++block.sequence;
+    block.request_cv.notify_one();
+
+    block.reply_cv.timed_wait(lock, deadline, [&]() {
+      return block.closed || block.state == SLOT_DONE;
+    });
+    if (block.sequence == sequence && block.state == SLOT_DONE) {
+      block.state = SLOT_FREE;
+      block.reply_cv.notify_all();
+      return true;
+    }
+    // 超时或通道关闭：还没被取走的请求直接撤回，处理中的请求交给服务端收尾。
+    if (block.sequence == sequence) {
+      if (block.state == SLOT_PENDING) {
+        block.state = SLOT_FREE;
+        block.reply_cv.notify_all();
+      } else if (block.state == SLOT_PROCESSING) {
+        block.abandoned = true;
+      }
+    }
+    return false;
+  }
+
+  bool SharedControlChannel::WaitForRequest(ParameterBatch &updates) {
+    auto &block = *_impl->block;
+    scoped_lock lock(block.mutex);
+    block.request_cv.wait(lock, [&]() {
+      return block.closed || block.state == SLOT_PENDING;
+    });
+    if (block.closed) {
+      return false;
+    }
+    updates.assign(block.updates, block.updates + block.update_count);
+    block.state = SLOT_PROCESSING;
+    return true;
+  }
+
+  void SharedControlChannel::CompleteRequest() {
+    auto &block = *_impl->block;
+    scoped_lock lock(block.mutex);
+    DEBUG_ASSERT(block.state == SLOT_PROCESSING);
+    block.state = block.abandoned ? SLOT_FREE : SLOT_DONE;
+    block.abandoned = false;
+    block.reply_cv.notify_all();
+  }
+
+  void SharedControlChannel::Close() {
+    auto &block = *_impl->block;
+    scoped_lock lock(block.mutex);
+    block.closed = true;
+    block.request_cv.notify_all();
+    block.reply_cv.notify_all();
+  }
+
+} // namespace traffic_manager
+} // namespace carla
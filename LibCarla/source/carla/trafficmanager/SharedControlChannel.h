@@ -0,0 +1,84 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/trafficmanager/ParameterBatch.h"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace carla {
+namespace traffic_manager {
+
+  /// 同一主机上 TrafficManagerRemote 与 TrafficManagerServer 之间的共享内存控制通道。
+  ///
+  /// 服务端为每个 RPC 端口创建一个只有属主可读写的共享内存段，其中只有一个
+  /// 请求槽：客户端把参数更新写入槽中并唤醒服务端，服务端应用完毕后释放请求槽。
+  /// 与回环 RPC 相比省去了 TCP 往返与 msgpack 编解码。
+  ///
+  /// 通道不传递 tick：TrafficManagerRemote::SynchronousTick 在任何主机上都不会
+  /// 驱动服务端的交通管理器，同步仿真只由服务端所在的客户端推进。
+  ///
+  /// 通道只是加速路径：任何一端超时或通道关闭后，调用者应退回 RPC。
+  class SharedControlChannel : private NonCopyable {
+  public:
+
+    using time_duration = std::chrono::milliseconds;
+
+    /// 一次请求最多携带的参数更新数量，更大的批次会被拆成多次请求。
+    static constexpr size_t MAX_UPDATES_PER_REQUEST = 4096u;
+
+    /// 服务端：创建（或重建）@a port 对应的共享内存段，失败时返回 nullptr。
+    static std::unique_ptr<SharedControlChannel> Create(uint16_t port);
+
+    /// 客户端：打开本机服务端为 @a port 创建的共享内存段，不存在或已关闭时返回 nullptr。
+    static std::unique_ptr<SharedControlChannel> Open(uint16_t port);
+
+    static std::string GetSegmentName(uint16_t port);
+
+    ~SharedControlChannel();
+
+    /// @name 客户端
+    /// @{
+
+    /// 提交参数更新并等待服务端应用完毕。超时或通道已关闭时返回 false。
+    bool SubmitUpdates(const ParameterBatch &updates, time_duration timeout);
+
+    /// @}
+    /// @name 服务端
+    /// @{
+
+    /// 阻塞直到有请求或通道关闭，请求中的参数更新写入 @a updates；
+    /// 通道关闭时返回 false。
+    bool WaitForRequest(ParameterBatch &updates);
+
+    /// 完成 WaitForRequest 取出的请求并唤醒等待的客户端。
+    void CompleteRequest();
+
+    /// 关闭通道，唤醒所有等待者。
+    void Close();
+
+    /// @}
+
+    bool IsClosed() const;
+
+  private:
+
+    struct Impl;
+
+    explicit SharedControlChannel(std::unique_ptr<Impl> impl);
+
+    bool Submit(const ParameterUpdate *updates, size_t count, time_duration timeout);
+
+    std::unique_ptr<Impl> _impl;
+  };
+
+} // namespace traffic_manager
+} // namespace carla
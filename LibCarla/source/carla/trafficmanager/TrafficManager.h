@@ -72,6 +72,15 @@ public:
     }
   }
 
+  /// \brief 设置流水线模式。  
+  /// \param mode_switch 如果为true，本帧的命令在后台提交，同时开始计算下一帧，命令因此延迟一帧生效
+  void SetPipelinedMode(const bool mode_switch) {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if (tm_ptr != nullptr) {
+      tm_ptr->SetPipelinedMode(mode_switch);
+    }
+  }
+
   /// \brief 设置自定义路径。  
 /// \param actor 对应的Actor指针。  
 /// \param path 要设置的路径。  
@@ -214,6 +223,28 @@ public:
     }
   }
 
+  /// @brief 批量设置逐车辆参数。
+/// 远程交通管理器只需一次往返（同一主机上经共享内存），适合一次配置成百上千辆车。
+/// @param updates 参数更新列表，按顺序应用。
+  void SetParameterBatch(const ParameterBatch &updates) {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if(tm_ptr != nullptr){
+      tm_ptr->SetParameterBatch(updates);
+    }
+  }
+
+  /// @brief 为多辆车设置同一个参数。
+/// @param parameter 要设置的参数。
+/// @param values (车辆, 值) 列表，布尔参数以非零表示 true。
+  void SetParameterBatch(VehicleParameter parameter, const std::vector<std::pair<ActorPtr, float>> &values) {
+    ParameterBatch updates;
+    updates.reserve(values.size());
+    for (const auto &value : values) {
+      updates.emplace_back(MakeParameterUpdate(value.first->GetId(), parameter, value.second));
+    }
+    SetParameterBatch(updates);
+  }
+
   /// @brief 设置车辆相对于车道中心线的偏移量。  
 /// 此方法用于设置车辆相对于车道中心线的偏移量。正值表示向右偏移，负值表示向左偏移。
 /// @param actor 要设置车道偏移的车辆。  
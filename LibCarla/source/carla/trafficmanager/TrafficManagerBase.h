@@ -8,6 +8,7 @@
 
 #include <memory>
 #include "carla/client/Actor.h"/// @brief 包含CARLA客户端中Actor类的定义
+#include "carla/trafficmanager/ParameterBatch.h"/// @brief 包含批量参数更新的定义
 #include "carla/trafficmanager/SimpleWaypoint.h"/// @brief 包含CARLA交通管理器中SimpleWaypoint类的定义
 /**
  * @namespace carla::traffic_manager
@@ -294,6 +295,13 @@ public:
  */
   virtual void SetOSMMode(const bool mode_switch) = 0;
 
+  /**
+ * @brief 设置流水线模式。
+ *
+ * @param mode_switch 是否在计算下一帧的同时异步提交本帧的命令（命令延迟一帧生效）。
+ */
+  virtual void SetPipelinedMode(const bool mode_switch) = 0;
+
   /**
    * @brief 设置自定义导入路径。
    *
@@ -387,8 +395,71 @@ public:
  */
   virtual void ShutDown() = 0;
 
+  /**
+ * @brief 批量设置逐车辆参数。
+ *
+ * 一次调用设置任意多个 (车辆, 参数, 值)，远程交通管理器只需一次往返。
+ * 找不到的车辆与未知的参数会被忽略。
+ *
+ * @param updates 参数更新列表，按顺序应用。
+ */
+  virtual void SetParameterBatch(const ParameterBatch &updates) = 0;
+
 protected:
 
+  /**
+ * @brief 把一项参数更新分派到对应的 setter。
+ */
+  void ApplyParameterUpdate(const ActorPtr &actor, const ParameterUpdate &update) {
+    const float value = update.value;
+    switch (update.GetParameter()) {
+      case VehicleParameter::PercentageSpeedDifference:
+        SetPercentageSpeedDifference(actor, value);
+        break;
+      case VehicleParameter::LaneOffset:
+        SetLaneOffset(actor, value);
+        break;
+      case VehicleParameter::DesiredSpeed:
+        SetDesiredSpeed(actor, value);
+        break;
+      case VehicleParameter::DistanceToLeadingVehicle:
+        SetDistanceToLeadingVehicle(actor, value);
+        break;
+      case VehicleParameter::PercentageIgnoreWalkers:
+        SetPercentageIgnoreWalkers(actor, value);
+        break;
+      case VehicleParameter::PercentageIgnoreVehicles:
+        SetPercentageIgnoreVehicles(actor, value);
+        break;
+      case VehicleParameter::PercentageRunningLight:
+        SetPercentageRunningLight(actor, value);
+        break;
+      case VehicleParameter::PercentageRunningSign:
+        SetPercentageRunningSign(actor, value);
+        break;
+      case VehicleParameter::KeepRightPercentage:
+        SetKeepRightPercentage(actor, value);
+        break;
+      case VehicleParameter::RandomLeftLaneChangePercentage:
+        SetRandomLeftLaneChangePercentage(actor, value);
+        break;
+      case VehicleParameter::RandomRightLaneChangePercentage:
+        SetRandomRightLaneChangePercentage(actor, value);
+        break;
+      case VehicleParameter::UpdateVehicleLights:
+        SetUpdateVehicleLights(actor, value != 0.0f);
+        break;
+      case VehicleParameter::AutoLaneChange:
+        SetAutoLaneChange(actor, value != 0.0f);
+        break;
+      case VehicleParameter::ForceLaneChange:
+        SetForceLaneChange(actor, value != 0.0f);
+        break;
+      default:
+        break;
+    }
+  }
+
 };
 
 } // namespace traffic_manager
@@ -8,6 +8,7 @@
 
 #include "carla/trafficmanager/Constants.h"// 引入常量定义
 #include "carla/rpc/Actor.h"// 引入Actor类的定义
+#include "carla/trafficmanager/ParameterBatch.h"// 引入批量参数更新的定义
 
 #include <rpc/client.h>// 引入RPC客户端库
 
@@ -111,6 +112,13 @@ public:
     _client->call("set_percentage_speed_difference", std::move(_actor), percentage);// 调用RPC方法设置速度差异
   }
 
+  /// 在一次RPC中批量设置逐车辆参数。
+  /// @param updates 参数更新列表，服务端按顺序应用。
+  void SetParameterBatch(const ParameterBatch &updates) {
+    DEBUG_ASSERT(_client != nullptr);
+    _client->call("set_parameter_batch", updates);
+  }
+
   /// 设置车辆相对于中心线的车道偏移量。  
 /// 正值表示向右偏移，负值表示向左偏移。  
 /// @param _actor 要设置车道偏移量的车辆。  
@@ -290,6 +298,12 @@ public:
     _client->call("set_osm_mode", mode_switch);/// 调用_client的call方法设置Open Street Map模式
   }
 
+  /// 设置流水线模式
+  void SetPipelinedMode(const bool mode_switch) {
+    DEBUG_ASSERT(_client != nullptr);
+    _client->call("set_pipelined_mode", mode_switch);
+  }
+
   /// 设置自定义路径
   void SetCustomPath(const carla::rpc::Actor &actor, const Path path, const bool empty_buffer) {
     DEBUG_ASSERT(_client != nullptr);/// 断言_client指针不为空
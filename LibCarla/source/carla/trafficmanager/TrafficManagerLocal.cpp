@@ -5,8 +5,10 @@
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
 #include <algorithm>
+#include <unordered_map>
 
 #include "carla/Logging.h"
+#include "carla/profiler/Tracer.h"
 
 #include "carla/client/detail/Simulator.h"
 
@@ -134,11 +136,59 @@ void TrafficManagerLocal::SetupLocalMap() {
 
 void TrafficManagerLocal::Start() {
   run_traffic_manger.store(true);
+  sender_thread = std::make_unique<std::thread>(&TrafficManagerLocal::RunSender, this);
   worker_thread = std::make_unique<std::thread>(&TrafficManagerLocal::Run, this);
 }
 
+void TrafficManagerLocal::RunSender() {
+  profiler::Tracer::SetThreadName("TM sender");
+  std::unique_lock<std::mutex> lock(batch_mutex);
+  while (true) {
+    batch_trigger.wait(lock, [this]() { return batch_pending || !run_traffic_manger.load(); });
+    if (!batch_pending) {
+      break;
+    }
+    // 提交期间不持有锁，工作线程可以继续计算下一帧
+    lock.unlock();
+    try {
+      CARLA_TRACE_SCOPE("tm", "ApplyBatchSync");
+      episode_proxy.Lock()->ApplyBatchSync(pending_control_frame, false);
+    } catch (const std::exception &e) {
+      log_warning("traffic manager: failed to apply pipelined batch:", e.what());
+    }
+    lock.lock();
+    batch_pending = false;
+    batch_trigger.notify_all();
+  }
+}
+
+void TrafficManagerLocal::WaitForPendingBatch() {
+  std::unique_lock<std::mutex> lock(batch_mutex);
+  batch_trigger.wait(lock, [this]() { return !batch_pending; });
+}
+
+void TrafficManagerLocal::SubmitControlFrame(const bool synchronous_mode) {
+  // 上一帧的命令必须先于本帧提交（切换模式时也一样）
+  WaitForPendingBatch();
+  // 同步模式下SynchronousTick返回前命令必须已经应用，只有异步模式使用流水线
+  if (!synchronous_mode && parameters.GetPipelinedMode()) {
+    if (control_frame.size() > 0) {
+      std::lock_guard<std::mutex> lock(batch_mutex);
+      // 交换缓冲区：各阶段持有的是control_frame的引用，交换后仍然有效
+      std::swap(control_frame, pending_control_frame);
+      batch_pending = true;
+      batch_trigger.notify_all();
+    }
+  } else if (synchronous_mode || control_frame.size() > 0) {
+    CARLA_TRACE_SCOPE("tm", "ApplyBatchSync");
+    episode_proxy.Lock()->ApplyBatchSync(control_frame, false);
+  }
+}
+
 void TrafficManagerLocal::Run() {
 
+  profiler::Tracer::SetThreadName("TM worker");
+
   localization_frame.reserve(INITIAL_SIZE);
   collision_frame.reserve(INITIAL_SIZE);
   tl_frame.reserve(INITIAL_SIZE);
@@ -179,9 +229,13 @@ void TrafficManagerLocal::Run() {
       last_frame = timestamp.frame;
     }
 
+    CARLA_TRACE_SCOPE("tm", "Tick");
     std::unique_lock<std::mutex> registration_lock(registration_mutex);
     // 更新模拟状态、角色生命周期并执行必要的清理
-    alsm.Update();
+    {
+      CARLA_TRACE_SCOPE("tm", "ALSM");
+      alsm.Update();
+    }
 
     // 基于已注册车辆数量变化的阶段间通信帧重新分配
     int current_registered_vehicles_state = registered_vehicles.GetState();
@@ -219,31 +273,37 @@ void TrafficManagerLocal::Run() {
     control_frame.resize(number_of_vehicles);
 
     // 运行核心操作阶段
-    for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
-      localization_stage.Update(index);
+    CARLA_TRACE_COUNTER("tm", "vehicles", number_of_vehicles);
+    {
+      CARLA_TRACE_SCOPE("tm", "Localization");
+      for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
+        localization_stage.Update(index);
+      }
     }
-    for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
-      collision_stage.Update(index);
+    {
+      CARLA_TRACE_SCOPE("tm", "Collision");
+      for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
+        collision_stage.Update(index);
+      }
+      collision_stage.ClearCycleCache();
     }
-    collision_stage.ClearCycleCache();
-    vehicle_light_stage.UpdateWorldInfo();
-    for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
-      traffic_light_stage.Update(index);
-      motion_plan_stage.Update(index);
-      vehicle_light_stage.Update(index);
+    {
+      CARLA_TRACE_SCOPE("tm", "TrafficLight+MotionPlan+VehicleLight");
+      vehicle_light_stage.UpdateWorldInfo();
+      for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
+        traffic_light_stage.Update(index);
+        motion_plan_stage.Update(index);
+        vehicle_light_stage.Update(index);
+      }
     }
 
     registration_lock.unlock();
 
     // 将当前周期的批处理命令发送给模拟器
+    SubmitControlFrame(synchronous_mode);
     if (synchronous_mode) {
-      episode_proxy.Lock()->ApplyBatchSync(control_frame, false);
       step_end.store(true);
       step_end_trigger.notify_one();
-    } else {
-      if (control_frame.size() > 0){
-        episode_proxy.Lock()->ApplyBatchSync(control_frame, false);
-      }
     }
   }
 }
@@ -274,6 +334,18 @@ void TrafficManagerLocal::Stop() {
     worker_thread.release();
   }
 
+  // 发送线程先提交完最后一帧再退出
+  {
+    std::lock_guard<std::mutex> lock(batch_mutex);
+    batch_trigger.notify_all();
+  }
+  if (sender_thread) {
+    if (sender_thread->joinable()) {
+      sender_thread->join();
+    }
+    sender_thread.reset();
+  }
+
   vehicle_id_list.clear();
   registered_vehicles.Clear();
   registered_vehicles_state = -1;
@@ -286,12 +358,14 @@ void TrafficManagerLocal::Stop() {
   collision_stage.Reset();
   traffic_light_stage.Reset();
   motion_plan_stage.Reset();
+  vehicle_light_stage.Reset();
 
   buffer_map.clear();
   localization_frame.clear();
   collision_frame.clear();
   tl_frame.clear();
   control_frame.clear();
+  pending_control_frame.clear();
 
   run_traffic_manger.store(true);
   step_begin.store(false);
@@ -399,6 +473,29 @@ void TrafficManagerLocal::SetRandomRightLaneChangePercentage(const ActorPtr &act
   parameters.SetRandomRightLaneChangePercentage(actor, percentage);
 }
 
+void TrafficManagerLocal::SetParameterBatch(const ParameterBatch &updates) {
+  std::unordered_map<ActorId, ActorPtr> actors;
+  for (auto &&vehicle : registered_vehicles.GetList()) {
+    actors.emplace(vehicle->GetId(), vehicle);
+  }
+  for (const auto &update : updates) {
+    if (!update.IsValid()) {
+      continue;
+    }
+    auto it = actors.find(update.actor_id);
+    if (it == actors.end()) {
+      const auto actor = episode_proxy.Lock()->GetActorById(update.actor_id);
+      if (!actor.has_value()) {
+        log_debug("traffic manager: ignoring parameter update for unknown actor", update.actor_id);
+        continue;
+      }
+      const ActorPtr ptr = carla::client::detail::ActorVariant(*actor).Get(episode_proxy);
+      it = actors.emplace(update.actor_id, ptr).first;
+    }
+    ApplyParameterUpdate(it->second, update);
+  }
+}
+
 void TrafficManagerLocal::SetHybridPhysicsMode(const bool mode_switch) {
   parameters.SetHybridPhysicsMode(mode_switch);
 }
@@ -411,6 +508,10 @@ void TrafficManagerLocal::SetOSMMode(const bool mode_switch) {
   parameters.SetOSMMode(mode_switch);
 }
 
+void TrafficManagerLocal::SetPipelinedMode(const bool mode_switch) {
+  parameters.SetPipelinedMode(mode_switch);
+}
+
 void TrafficManagerLocal::SetCustomPath(const ActorPtr &actor, const Path path, const bool empty_buffer) {
   parameters.SetCustomPath(actor, path, empty_buffer);
 }
@@ -135,6 +135,17 @@ private:
   /// @brief 存储运动规划阶段输出数据的数组  
   /// 用于存储运动规划阶段产生的控制指令
   ControlFrame control_frame;
+  /// @brief 流水线模式下交给发送线程提交的控制帧  
+  /// 与control_frame构成双缓冲：发送线程提交第N帧的命令时，工作线程在control_frame中计算第N+1帧
+  ControlFrame pending_control_frame;
+  /// @brief pending_control_frame中是否有尚未提交完毕的命令，由batch_mutex保护
+  bool batch_pending {false};
+  /// @brief 保护batch_pending的互斥锁
+  std::mutex batch_mutex;
+  /// @brief 用于唤醒发送线程以及等待提交完毕的条件变量
+  std::condition_variable batch_trigger;
+  /// @brief 流水线模式下异步提交控制帧的发送线程
+  std::unique_ptr<std::thread> sender_thread;
   /// @brief 用于跟踪当前为帧保留的数组空间的变量 
   /// 这是一个无符号64位整数，用于记录为各个帧数组预留的空间大小
   uint64_t current_reserved_capacity {0u};
@@ -226,6 +237,16 @@ public:
   /// 此方法用于停止TrafficManagerLocal的运行，并可能进行必要的清理工作
   void Stop();
 
+  /// @brief 发送线程的主循环，提交pending_control_frame中的命令
+  void RunSender();
+
+  /// @brief 提交当前周期的控制帧  
+  /// 流水线模式下交换双缓冲并交给发送线程后立即返回，否则同步等待服务器应答
+  void SubmitControlFrame(bool synchronous_mode);
+
+  /// @brief 等待发送线程提交完上一帧的命令
+  void WaitForPendingBatch();
+
   /// @brief 释放交通管理器 
   /// 此方法用于释放TrafficManagerLocal所占用的资源，例如线程、内存等
   void Release();
@@ -329,6 +350,14 @@ public:
 /// @return 如果成功提供同步Tick，则返回true；否则返回false
   bool SynchronousTick();
 
+  /// @brief 批量设置逐车辆参数。
+///
+/// 车辆先在已注册车辆中查找，找不到时再从仿真片段中查找，
+/// 因此也可以在注册之前为车辆设置参数。
+///
+/// @param updates 参数更新列表
+  void SetParameterBatch(const ParameterBatch &updates);
+
   /// @brief 获取CARLA仿真场景的信息代理。  
 ///   
 /// @return 返回CARLA仿真场景的EpisodeProxy引用
@@ -382,6 +411,12 @@ public:
 /// @param mode_switch 是否启用Open Street Map模式。如果为true，则启用；如果为false，则禁用.
   void SetOSMMode(const bool mode_switch);
 
+  /// @brief 设置流水线模式。  
+///   
+/// @param mode_switch 为true时，第N帧的命令在后台线程中提交，同时计算第N+1帧，命令因此延迟一帧生效.
+/// 只在异步模式下生效：同步模式下SynchronousTick总是等待命令应用完毕后返回.
+  void SetPipelinedMode(const bool mode_switch);
+
   /// @brief 设置自定义路径。  
 ///   
 /// @param actor 要设置路径的车辆指针。  
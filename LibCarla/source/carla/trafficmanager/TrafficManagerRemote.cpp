@@ -4,9 +4,11 @@
 // This work is licensed under the terms of the MIT license.
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
+#include <chrono>
 #include <thread>
 // 引入线程库
 
+#include "carla/Logging.h"
 #include "carla/client/detail/Simulator.h"
 // 引入 Carla 客户端的模拟器实现细节头文件
 
@@ -24,6 +26,9 @@ TrafficManagerRemote::TrafficManagerRemote(
     episodeProxyTM(episodeProxy) {
 // 远程交通管理器的构造函数，接收服务器地址对和场景代理对象，初始化成员变量
 
+  OpenControlChannel();
+// 服务端在本机时使用共享内存通道
+
   Start();
 // 启动远程交通管理器
 }
@@ -111,6 +116,9 @@ void TrafficManagerRemote::Reset() {
   episodeProxyTM = episode_proxy;
 // 获取当前场景代理，并更新成员变量
 
+  OpenControlChannel();
+// 服务端可能已经重建了共享内存段，重新打开
+
   Start();
 // 重新启动远程交通管理器
 }
@@ -287,6 +295,11 @@ void TrafficManagerRemote::SetOSMMode(const bool mode_switch) {
 // 通过客户端设置 OSM 模式开关
 }
 
+void TrafficManagerRemote::SetPipelinedMode(const bool mode_switch) {
+  client.SetPipelinedMode(mode_switch);
+// 通过客户端设置流水线模式开关
+}
+
 void TrafficManagerRemote::SetCustomPath(const ActorPtr &_actor, const Path path, const bool empty_buffer) {
   carla::rpc::Actor actor(_actor->Serialize());
 // 将输入的车辆转换为 rpc 格式的车辆
@@ -368,6 +381,47 @@ bool TrafficManagerRemote::SynchronousTick() {
 // 返回假，表示同步时钟滴答函数未实现
 }
 
+void TrafficManagerRemote::SetParameterBatch(const ParameterBatch &updates) {
+  if (updates.empty()) {
+    return;
+  }
+  auto channel = GetControlChannel();
+  if (channel != nullptr) {
+    if (channel->SubmitUpdates(updates, std::chrono::milliseconds(TM_TIMEOUT))) {
+      return;
+    }
+    DisableControlChannel(channel);
+    // 参数设置是幂等的，部分已应用的批次整体重发即可
+  }
+  client.SetParameterBatch(updates);
+// 通过一次RPC发送整个批次
+}
+
+void TrafficManagerRemote::OpenControlChannel() {
+  std::string host;
+  uint16_t port = 0u;
+  client.getServerDetails(host, port);
+  std::shared_ptr<SharedControlChannel> channel;
+  if (host == "localhost" || host == "127.0.0.1" || host == "::1") {
+    channel = SharedControlChannel::Open(port);
+  }
+  std::lock_guard<std::mutex> lock(_control_channel_mutex);
+  _control_channel = std::move(channel);
+}
+
+std::shared_ptr<SharedControlChannel> TrafficManagerRemote::GetControlChannel() {
+  std::lock_guard<std::mutex> lock(_control_channel_mutex);
+  return _control_channel;
+}
+
+void TrafficManagerRemote::DisableControlChannel(const std::shared_ptr<SharedControlChannel> &channel) {
+  std::lock_guard<std::mutex> lock(_control_channel_mutex);
+  if (_control_channel == channel) {
+    log_warning("traffic manager: shared memory channel timed out, falling back to RPC");
+    _control_channel.reset();
+  }
+}
+
 void TrafficManagerRemote::HealthCheckRemoteTM() {
   client.HealthCheckRemoteTM();
 // 通过客户端对远程交通管理器进行健康检查
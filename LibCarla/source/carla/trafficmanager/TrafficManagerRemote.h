@@ -7,6 +7,7 @@
 #pragma once
 
 #include <condition_variable>/// @brief 引入条件变量类，用于线程间的同步
+#include <memory>/// @brief 引入智能指针，用于持有共享内存通道
 #include <mutex>/// @brief 引入互斥锁类，用于保护共享数据的访问
 #include <vector>/// @brief 引入动态数组类，用于储存多个元素
 
@@ -14,6 +15,7 @@
 #include "carla/client/detail/EpisodeProxy.h"/// @brief CARLA客户端EpisodeProxy类的头文件，包含了与仿真片段（Episode）相关的操作和接口
 #include "carla/trafficmanager/TrafficManagerBase.h"/// @brief CARLA交通管理器基础类的头文件，提供了交通管理器的基本功能和接口
 #include "carla/trafficmanager/TrafficManagerClient.h"/// @brief CARLA交通管理器客户端类的头文件，用于与交通管理器进行通信和控制
+#include "carla/trafficmanager/SharedControlChannel.h"/// @brief 同一主机上与交通管理器服务端通信的共享内存通道
 /**
  * @namespace carla::traffic_manager
  * @brief CARLA仿真环境中的交通管理器命名空间。
@@ -293,6 +295,13 @@ public:
  */
   void SetOSMMode(const bool mode_switch);
 
+  /**
+ * @brief 设置流水线模式。
+ *
+ * @param mode_switch 是否启用流水线模式。
+ */
+  void SetPipelinedMode(const bool mode_switch);
+
   /**
  * @brief 设置自定义路径。
  *
@@ -389,10 +398,22 @@ public:
   /**
  * @brief 提供同步Tick。
  *
+ * 只有服务端在同一主机上（共享内存通道可用）时才转发给服务端，
+ * 否则与以前一样由服务端所在的客户端驱动。
+ *
  * @return 是否成功执行同步Tick。
  */
   bool SynchronousTick();
 
+  /**
+ * @brief 批量设置逐车辆参数。
+ *
+ * 同一主机上经共享内存通道发送，否则合并为一次RPC。
+ *
+ * @param updates 参数更新列表。
+ */
+  void SetParameterBatch(const ParameterBatch &updates);
+
   /**
   * @brief 获取CARLA回合信息。
   *
@@ -424,6 +445,29 @@ private:
   */
   carla::client::detail::EpisodeProxy episodeProxyTM;
   /**
+ * @brief 服务端在本机时打开共享内存通道。
+ */
+  void OpenControlChannel();
+
+  /**
+ * @brief 获取当前的共享内存通道，不可用时返回空指针。
+ */
+  std::shared_ptr<SharedControlChannel> GetControlChannel();
+
+  /**
+ * @brief 通道超时或关闭后停用它，之后的请求退回RPC。
+ */
+  void DisableControlChannel(const std::shared_ptr<SharedControlChannel> &channel);
+
+  /**
+ * @brief 同一主机上的共享内存通道，可能为空。
+ */
+  std::shared_ptr<SharedControlChannel> _control_channel;
+  /**
+ * @brief 保护 _control_channel 的互斥锁。
+ */
+  std::mutex _control_channel_mutex;
+  /**
  * @brief 条件变量，用于线程同步。
  */
   std::condition_variable _cv;
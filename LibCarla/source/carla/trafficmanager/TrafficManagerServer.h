@@ -51,6 +51,14 @@
         * 这是交通管理模块的核心类之一，提供了交通管理的基本功能。
         */
 #include "carla/trafficmanager/TrafficManagerBase.h"
+        /**
+         * @brief 引入同一主机上使用的共享内存控制通道
+         */
+#include "carla/trafficmanager/SharedControlChannel.h"
+#include "carla/Logging.h"
+
+#include <memory>
+#include <thread>
         /**
          * @namespace carla::traffic_manager
          * @brief carla命名空间中用于管理交通流的子命名空间。
@@ -173,6 +181,11 @@ public:
         tm->SetUpdateVehicleLights(carla::client::detail::ActorVariant(actor).Get(tm->GetEpisodeProxy()), do_update);
       });
 
+      /// 批量设置逐车辆参数，车辆在服务端按 ID 查找
+      server->bind("set_parameter_batch", [=](const ParameterBatch updates) {
+        tm->SetParameterBatch(updates);
+      });
+
       /// 设置全局相对于限速的速度降低百分比的方法 
       /// 如果小于0，则表示百分比增加
       /// @param percentage 速度降低的百分比（负值表示增加）
@@ -299,6 +312,12 @@ public:
         tm->SetOSMMode(mode_switch);
       });
 
+      /// 设置流水线模式的方法  
+      /// @param mode_switch 是否开启流水线模式
+      server->bind("set_pipelined_mode", [=](const bool mode_switch) {
+        tm->SetPipelinedMode(mode_switch);
+      });
+
       /// 设置自定义路径的方法  
       /// @param actor CARLA中的Actor对象  
       /// @param path 自定义的路径  
@@ -408,6 +427,12 @@ public:
 
       /// 以异步模式运行交通管理器服务器，以响应任何用户客户端的请求
       server->async_run();
+
+      /// 同一主机上的客户端通过共享内存发送参数更新，不经过回环 RPC。
+      _control_channel = SharedControlChannel::Create(RPCPort);
+      if (_control_channel != nullptr) {
+        _control_thread = std::thread(&TrafficManagerServer::RunControlChannel, _control_channel, tm);
+      }
     }
 
   }
@@ -415,6 +440,12 @@ public:
      * @brief 析构函数，释放交通管理器服务器资源
      */
   ~TrafficManagerServer() {
+    if (_control_channel != nullptr) {
+      _control_channel->Close();
+    }
+    if (_control_thread.joinable()) {
+      _control_thread.join();
+    }
     if(server) {
       server->stop();
       delete server;
@@ -431,12 +462,32 @@ public:
 
 private:
 
+  /// 处理共享内存通道中的请求，直到通道关闭。
+  static void RunControlChannel(
+      std::shared_ptr<SharedControlChannel> channel,
+      carla::traffic_manager::TrafficManagerBase *tm) {
+    ParameterBatch updates;
+    while (channel->WaitForRequest(updates)) {
+      try {
+        tm->SetParameterBatch(updates);
+      } catch (const std::exception &e) {
+        log_error("traffic manager: shared memory request failed:", e.what());
+      }
+      channel->CompleteRequest();
+    }
+  }
+
     /// 交通管理器服务器的RPC端口号
   uint16_t _RPCPort;
 
   /// 服务器实例指针
   ::rpc::server *server = nullptr;
 
+  /// 共享内存控制通道及其处理线程。
+  std::shared_ptr<SharedControlChannel> _control_channel;
+
+  std::thread _control_thread;
+
 };
 
 } // namespace traffic_manager
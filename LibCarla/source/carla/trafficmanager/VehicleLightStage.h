@@ -7,22 +7,40 @@
 #include "carla/trafficmanager/SimulationState.h" // 引入交通管理模块的模拟状态定义
 #include "carla/trafficmanager/Stage.h" // 引入交通管理模块的阶段定义
 
+#include <unordered_map>
+
 namespace carla {
 namespace traffic_manager {
 
 /// VehicleLightStage类负责根据车辆当前的状态和周围环境来开启或关闭车辆的灯光
 ///
+/// 天气与各车辆的灯光状态都缓存在本阶段中，只在剧集变化、出现未缓存的车辆
+/// 或超过 WORLD_INFO_REFRESH_PERIOD 时才通过 RPC 重新读取；每辆车只在
+/// 灯光状态实际变化时才生成 SetVehicleLightState 命令。
 class VehicleLightStage: Stage {
 private:
+  using flag_type = rpc::VehicleLightState::flag_type;
+
   const std::vector<ActorId> &vehicle_id_list; // 车辆ID列表的引用
   const BufferMap &buffer_map;  // 一个常量引用，包含了交通管理模块的缓冲区映射
   const Parameters &parameters; // 一个常量引用，包含了交通管理模块的参数
   const cc::World &world; // 一个常量引用，指向当前的仿真世界，用于获取环境信息
   ControlFrame& control_frame; // 一个引用，指向当前的控制帧，用于更新车辆控制信息
-  /// 一个列表，包含了所有车辆的灯光状态，用于管理和更新车辆的灯光
-  rpc::VehicleLightStateList all_light_states;
-  /// 当前的天气参数，用于根据天气情况调整车辆灯光
-  rpc::WeatherParameters weather;
+  /// 各车辆当前的灯光状态：上次从服务器读取的值，加上本阶段之后发出的修改
+  std::unordered_map<ActorId, flag_type> light_states;
+  /// 由当前天气决定的灯光（位置灯、近光灯、雾灯）
+  flag_type weather_lights = 0u;
+  /// 读取缓存时所在的剧集
+  uint64_t cached_episode_id = 0u;
+  /// 上次读取天气与灯光状态的时间
+  TimeInstance last_refresh;
+  bool has_world_info = false;
+
+  /// 通过 RPC 重新读取天气与所有车辆的灯光状态
+  void RefreshWorldInfo();
+
+  /// 检查缓存是否需要重新读取
+  bool IsWorldInfoStale() const;
 
 public:
   VehicleLightStage(const std::vector<ActorId> &vehicle_id_list, // VehicleLightStage类的构造函数，初始化成员变量
@@ -31,13 +49,24 @@ public:
                     const cc::World &world,
                     ControlFrame& control_frame);
 
-  void UpdateWorldInfo(); // 更新世界信息
+  void UpdateWorldInfo(); // 更新世界信息（只在缓存失效时发起 RPC）
 
   void Update(const unsigned long index) override; // 根据给定的索引更新特定车辆的灯光状态
 
   void RemoveActor(const ActorId actor_id) override; // 当车辆被移除时，从车辆灯光控制列表中移除该车辆
 
   void Reset() override;  // 重置车辆灯光控制阶段，可能在仿真重置或重新开始时调用
+
+  /// 根据天气计算位置灯、近光灯与雾灯
+  static flag_type ComputeWeatherLights(const rpc::WeatherParameters &weather);
+
+  /// 由当前灯光状态与各项输入计算新的灯光状态，不受本阶段管理的灯光保持不变
+  static flag_type ComputeLightState(
+      flag_type current,
+      flag_type weather_lights,
+      bool brake,
+      bool left_turn,
+      bool right_turn);
 };
 
 } // namespace traffic_manager
@@ -0,0 +1,764 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "StandInServer.h"
+
+#include <carla/BufferView.h>
+#include <carla/Exception.h>
+#include <carla/Logging.h>
+#include <carla/StringUtil.h>
+#include <carla/Version.h>
+#include <carla/geom/Math.h>
+#include <carla/opendrive/OpenDriveParser.h>
+#include <carla/rpc/ActorDefinition.h>
+#include <carla/rpc/EpisodeInfo.h>
+#include <carla/rpc/EpisodeStateFilter.h>
+#include <carla/rpc/MapInfo.h>
+#include <carla/rpc/Response.h>
+#include <carla/rpc/VehicleLightState.h>
+#include <carla/sensor/SensorRegistry.h>
+#include <carla/sensor/data/ActorDynamicState.h>
+#include <carla/sensor/data/LidarData.h>
+#include <carla/sensor/s11n/EpisodeStateSerializer.h>
+#include <carla/sensor/s11n/ImageSerializer.h>
+#include <carla/sensor/s11n/LidarSerializer.h>
+#include <carla/sensor/s11n/SensorHeaderSerializer.h>
+#include <carla/streaming/detail/Token.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace util {
+
+  namespace cg = carla::geom;
+  namespace cr = carla::rpc;
+  namespace cs = carla::sensor;
+
+  using namespace std::chrono_literals;
+
+  template <typename T>
+  using R = cr::Response<T>;
+
+  // ===========================================================================
+  // -- 运动学模型参数 -----------------------------------------------------------
+  // ===========================================================================
+
+  static constexpr float MAX_ACCELERATION = 4.0f;    // 油门全开时的加速度 (m/s^2)
+  static constexpr float MAX_DECELERATION = 8.0f;    // 刹车踩满时的减速度 (m/s^2)
+  static constexpr float DRAG = 0.05f;               // 与速度成正比的阻力系数 (1/s)
+  static constexpr float MAX_STEER_ANGLE = 70.0f;    // 方向盘打满时的前轮转角 (度)
+  static constexpr float WHEEL_BASE = 2.9f;          // 轴距 (m)
+  static constexpr float SPEED_LIMIT = 50.0f;        // 发布给客户端的限速 (km/h)
+  static constexpr size_t PUBLISH_TIME_HISTORY = 256u;
+
+  static const cg::Vector3D VEHICLE_EXTENT{2.4f, 1.0f, 0.8f};
+  static const cg::Vector3D WALKER_EXTENT{0.3f, 0.3f, 0.9f};
+
+  static const std::string *FindAttribute(
+      const cr::ActorDescription &description,
+      const std::string &id) {
+    for (const auto &attribute : description.attributes) {
+      if (attribute.id == id) {
+        return &attribute.value;
+      }
+    }
+    return nullptr;
+  }
+
+  template <typename T>
+  static T GetAttribute(const cr::ActorDescription &description, const std::string &id, T default_value) {
+    const auto *value = FindAttribute(description, id);
+    return value != nullptr ? static_cast<T>(std::stod(*value)) : default_value;
+  }
+
+  static cr::ActorAttribute MakeAttribute(std::string id, cr::ActorAttributeType type, std::string value) {
+    cr::ActorAttribute attribute;
+    attribute.id = std::move(id);
+    attribute.type = type;
+    attribute.value = std::move(value);
+    return attribute;
+  }
+
+  // ===========================================================================
+  // -- StandInServer ----------------------------------------------------------
+  // ===========================================================================
+
+  StandInServer::StandInServer(Options options)
+    : _options(std::move(options)),
+      _rpc_server(_options.rpc_port),
+      _streaming_server(_options.streaming_port),
+      _episode_stream(_streaming_server.MakeStream()),
+      _episode_id(static_cast<uint64_t>(clock::now().time_since_epoch().count())),
+      _start_time(clock::now()),
+      _publish_times(PUBLISH_TIME_HISTORY) {
+    if (!_options.opendrive.empty()) {
+      _map = carla::opendrive::OpenDriveParser::Load(_options.opendrive);
+      if (!_map.has_value()) {
+        carla::throw_exception(std::invalid_argument("stand-in server: invalid OpenDRIVE"));
+      }
+      for (const auto &waypoint : _map->GenerateWaypointsOnRoadEntries()) {
+        auto transform = _map->ComputeTransform(waypoint);
+        transform.location.z += 0.5f;
+        _spawn_points.push_back(transform);
+      }
+    }
+    if (_spawn_points.empty()) {
+      _spawn_points.emplace_back();
+    }
+    // 与 UE4 中一样，观察者也是一个参与者。
+    cr::ActorDescription spectator;
+    spectator.id = "spectator";
+    _spectator_id = Spawn(spectator, cg::Transform{}).id;
+    BindFunctions();
+  }
+
+  StandInServer::~StandInServer() {
+    Stop();
+  }
+
+  void StandInServer::Start() {
+    _rpc_server.AsyncRun(_options.worker_threads);
+    _streaming_server.AsyncRun(_options.worker_threads);
+    _game_thread.CreateThread([this]() { GameThreadLoop(); });
+  }
+
+  void StandInServer::Stop() {
+    if (!_stop.exchange(true)) {
+      _game_thread.JoinAll();
+      _rpc_server.Stop();
+    }
+  }
+
+  std::vector<carla::ActorId> StandInServer::SpawnVehicles(size_t count) {
+    std::vector<carla::ActorId> result;
+    result.reserve(count);
+    cr::ActorDescription description;
+    description.id = "vehicle.standin.car";
+    description.attributes.push_back(MakeAttribute("role_name", cr::ActorAttributeType::String, "autopilot"));
+    for (auto i = 0u; i < count; ++i) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      auto transform = _spawn_points[_next_spawn_point++ % _spawn_points.size()];
+      result.push_back(Spawn(description, transform).id);
+    }
+    return result;
+  }
+
+  std::vector<carla::ActorId> StandInServer::SpawnWalkers(size_t count) {
+    std::vector<carla::ActorId> result;
+    result.reserve(count);
+    cr::ActorDescription description;
+    description.id = "walker.pedestrian.standin";
+    for (auto i = 0u; i < count; ++i) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      auto transform = _spawn_points[_next_spawn_point++ % _spawn_points.size()];
+      transform.location.y += 4.0f;
+      result.push_back(Spawn(description, transform).id);
+    }
+    return result;
+  }
+
+  size_t StandInServer::GetActorCount() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _actors.size();
+  }
+
+  boost::optional<StandInServer::clock::time_point> StandInServer::GetPublishTime(uint64_t frame) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto &entry = _publish_times[frame % _publish_times.size()];
+    if (entry.first == frame) {
+      return entry.second;
+    }
+    return boost::none;
+  }
+
+  // ===========================================================================
+  // -- 游戏线程 ----------------------------------------------------------------
+  // ===========================================================================
+
+  void StandInServer::GameThreadLoop() {
+    auto next_tick = clock::now();
+    while (!_stop) {
+      // 在游戏线程中执行排队的同步 RPC。
+      _rpc_server.SyncRunFor(carla::time_duration::milliseconds(1u));
+      bool synchronous_mode;
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        synchronous_mode = _settings.synchronous_mode;
+      }
+      if (!synchronous_mode && clock::now() >= next_tick) {
+        next_tick += _options.tick_interval.to_chrono();
+        Tick();
+      }
+    }
+  }
+
+  uint64_t StandInServer::Tick() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const float delta_seconds = _settings.fixed_delta_seconds.has_value() ?
+        static_cast<float>(*_settings.fixed_delta_seconds) :
+        static_cast<float>(_options.tick_interval.milliseconds()) * 1e-3f;
+    ++_frame;
+    _elapsed_seconds += delta_seconds;
+    for (auto &pair : _actors) {
+      Integrate(pair.second, delta_seconds);
+    }
+    PublishEpisodeState(_elapsed_seconds, delta_seconds);
+    for (const auto &pair : _actors) {
+      if (pair.second.stream.has_value()) {
+        PublishSensor(pair.second, _elapsed_seconds, delta_seconds);
+      }
+    }
+    return _frame;
+  }
+
+  void StandInServer::Integrate(SimulatedActor &actor, const float delta_seconds) const {
+    const cg::Vector3D previous_velocity = actor.velocity;
+    if (actor.type == 'v' && actor.simulate_physics) {
+      // 简单的自行车模型，速度沿车头方向。
+      const auto &control = actor.vehicle_control;
+      const cg::Vector3D forward = actor.transform.GetForwardVector();
+      float speed = cg::Math::Dot(actor.velocity, forward);
+      const float direction = control.reverse ? -1.0f : 1.0f;
+      const float brake = control.hand_brake ? 1.0f : control.brake;
+      float acceleration = direction * control.throttle * MAX_ACCELERATION - DRAG * speed;
+      const float braking = brake * MAX_DECELERATION * delta_seconds;
+      speed += acceleration * delta_seconds;
+      speed = std::abs(speed) <= braking ? 0.0f : speed - std::copysign(braking, speed);
+      const float yaw_rate = cg::Math::ToDegrees(
+          speed * std::tan(cg::Math::ToRadians(control.steer * MAX_STEER_ANGLE)) / WHEEL_BASE);
+      actor.transform.rotation.yaw += yaw_rate * delta_seconds;
+      const cg::Vector3D heading = actor.transform.GetForwardVector();
+      actor.velocity = heading * speed;
+      actor.angular_velocity = cg::Vector3D{0.0f, 0.0f, yaw_rate};
+      actor.transform.location += actor.velocity * delta_seconds;
+    } else if (actor.type == 'w') {
+      const auto &control = actor.walker_control;
+      const float length = control.direction.Length();
+      actor.velocity = length > 0.0f ? control.direction * (control.speed / length) : cg::Vector3D{};
+      if (length > 0.0f) {
+        actor.transform.rotation.yaw = cg::Math::ToDegrees(std::atan2(control.direction.y, control.direction.x));
+      }
+      actor.transform.location += actor.velocity * delta_seconds;
+    }
+    actor.acceleration = delta_seconds > 0.0f ?
+        (actor.velocity - previous_velocity) * (1.0f / delta_seconds) :
+        cg::Vector3D{};
+  }
+
+  cg::Transform StandInServer::GetWorldTransform(const SimulatedActor &actor) const {
+    auto parent = _actors.find(actor.description.parent_id);
+    if (actor.description.parent_id == 0u || parent == _actors.end()) {
+      return actor.transform;
+    }
+    cg::Transform result = actor.transform;
+    parent->second.transform.TransformPoint(result.location);
+    result.rotation.pitch += parent->second.transform.rotation.pitch;
+    result.rotation.yaw += parent->second.transform.rotation.yaw;
+    result.rotation.roll += parent->second.transform.rotation.roll;
+    return result;
+  }
+
+  void StandInServer::PublishEpisodeState(const double timestamp, const float delta_seconds) {
+    using Serializer = cs::s11n::EpisodeStateSerializer;
+    using ActorDynamicState = cs::data::ActorDynamicState;
+
+    Serializer::Header header;
+    header.episode_id = _episode_id;
+    header.platform_timestamp = std::chrono::duration<double>(clock::now() - _start_time).count();
+    header.delta_seconds = delta_seconds;
+    header.map_origin = cg::Vector3DInt{};
+    header.simulation_state = Serializer::SimulationState::None;
+
+    carla::Buffer payload = _episode_stream.MakeBuffer();
+    payload.reset(sizeof(header) + _actors.size() * sizeof(ActorDynamicState));
+    payload.copy_from(0u, reinterpret_cast<const unsigned char *>(&header), sizeof(header));
+    size_t offset = sizeof(header);
+    for (const auto &pair : _actors) {
+      const auto &actor = pair.second;
+      ActorDynamicState state{};
+      state.id = pair.first;
+      state.actor_state = cr::ActorState::Active;
+      state.transform = GetWorldTransform(actor);
+      state.velocity = actor.velocity;
+      state.angular_velocity = actor.angular_velocity;
+      state.acceleration = actor.acceleration;
+      if (actor.type == 'v') {
+        state.state.vehicle_data.control = actor.vehicle_control;
+        state.state.vehicle_data.speed_limit = SPEED_LIMIT;
+        state.state.vehicle_data.traffic_light_state = cr::TrafficLightState::Green;
+        state.state.vehicle_data.has_traffic_light = false;
+        state.state.vehicle_data.traffic_light_id = 0u;
+        state.state.vehicle_data.failure_state = cr::VehicleFailureState::None;
+      } else if (actor.type == 'w') {
+        state.state.walker_control = actor.walker_control;
+      }
+      payload.copy_from(offset, reinterpret_cast<const unsigned char *>(&state), sizeof(state));
+      offset += sizeof(state);
+    }
+
+    // 与 UE4 中的 FWorldObserver 一样，过滤后的流从完整的仿真状态中选取参与者。
+    if (!_filtered_streams.empty()) {
+      _index.Reset(
+          reinterpret_cast<const ActorDynamicState *>(payload.data() + sizeof(header)),
+          _actors.size());
+      for (auto &filtered : _filtered_streams) {
+        _index.Select(filtered.filter, _selected);
+        auto filtered_header = cs::s11n::SensorHeaderSerializer::Serialize(
+            cs::SensorRegistry::template get<FWorldObserver *>::index,
+            _frame,
+            timestamp,
+            cg::Transform{});
+        filtered.stream.Write(
+            carla::BufferView::CreateFrom(std::move(filtered_header)),
+            carla::BufferView::CreateFrom(_index.Serialize(header, _selected, filtered.stream.MakeBuffer())));
+      }
+      _index.Reset(nullptr, 0u);
+    }
+
+    auto sensor_header = cs::s11n::SensorHeaderSerializer::Serialize(
+        cs::SensorRegistry::template get<FWorldObserver *>::index,
+        _frame,
+        timestamp,
+        cg::Transform{});
+    _publish_times[_frame % _publish_times.size()] = {_frame, clock::now()};
+    _episode_stream.Write(
+        carla::BufferView::CreateFrom(std::move(sensor_header)),
+        carla::BufferView::CreateFrom(std::move(payload)));
+  }
+
+  void StandInServer::PublishSensor(
+      const SimulatedActor &sensor,
+      const double timestamp,
+      const float delta_seconds) {
+    auto stream = *sensor.stream;
+    const auto &description = sensor.description.description;
+    const auto transform = GetWorldTransform(sensor);
+    carla::Buffer payload = stream.MakeBuffer();
+    uint64_t sensor_type;
+    if (carla::StringUtil::StartsWith(description.id, "sensor.camera")) {
+      // 合成图像：BGRA 像素，内容随帧号变化。
+      using Serializer = cs::s11n::ImageSerializer;
+      Serializer::ImageHeader header = {
+        GetAttribute<uint32_t>(description, "image_size_x", 800u),
+        GetAttribute<uint32_t>(description, "image_size_y", 600u),
+        GetAttribute<float>(description, "fov", 90.0f)};
+      const size_t image_size = 4u * header.width * header.height;
+      payload.reset(sizeof(header) + image_size);
+      std::memcpy(payload.data(), &header, sizeof(header));
+      std::memset(payload.data() + sizeof(header), static_cast<int>(_frame % 256u), image_size);
+      sensor_type = cs::SensorRegistry::template get<ASceneCaptureCamera *>::index;
+    } else {
+      // 合成点云：每个通道一圈距离固定的点。
+      const auto channels = GetAttribute<uint32_t>(description, "channels", 32u);
+      const auto points_per_second = GetAttribute<double>(description, "points_per_second", 56000.0);
+      const auto points_per_channel = static_cast<uint32_t>(
+          points_per_second * delta_seconds / std::max(channels, 1u));
+      cs::data::LidarData lidar(channels);
+      std::vector<uint32_t> points(channels, points_per_channel);
+      lidar.ResetMemory(points);
+      for (auto channel = 0u; channel < channels; ++channel) {
+        const float pitch = -15.0f + 30.0f * static_cast<float>(channel) / std::max(channels, 1u);
+        for (auto i = 0u; i < points_per_channel; ++i) {
+          const float yaw = 360.0f * static_cast<float>(i) / points_per_channel;
+          const float range = 10.0f + static_cast<float>(channel);
+          cs::data::LidarDetection detection(
+              cg::Math::GetForwardVector(cg::Rotation{pitch, yaw, 0.0f}) * range,
+              1.0f - range / 100.0f);
+          lidar.WritePointSync(detection);
+        }
+      }
+      lidar.WriteChannelCount(points);
+      lidar.SetHorizontalAngle(static_cast<float>(std::fmod(timestamp * 360.0, 360.0)));
+      payload = cs::s11n::LidarSerializer::Serialize(*this, lidar, std::move(payload));
+      sensor_type = cs::SensorRegistry::template get<ARayCastLidar *>::index;
+    }
+    auto header = cs::s11n::SensorHeaderSerializer::Serialize(
+        sensor_type,
+        _frame,
+        timestamp,
+        transform);
+    stream.Write(
+        carla::BufferView::CreateFrom(std::move(header)),
+        carla::BufferView::CreateFrom(std::move(payload)));
+  }
+
+  // ===========================================================================
+  // -- 参与者 ------------------------------------------------------------------
+  // ===========================================================================
+
+  cr::Actor StandInServer::Spawn(
+      cr::ActorDescription description,
+      const cg::Transform &transform,
+      const carla::ActorId parent) {
+    SimulatedActor actor;
+    actor.type = description.id.empty() ? 'o' : description.id.front();
+    actor.transform = transform;
+    actor.description.id = _next_actor_id++;
+    actor.description.parent_id = parent;
+    if (actor.type == 'v') {
+      actor.description.bounding_box = cg::BoundingBox(cg::Location{0.0f, 0.0f, VEHICLE_EXTENT.z}, VEHICLE_EXTENT);
+      actor.description.semantic_tags = {14u};
+    } else if (actor.type == 'w') {
+      actor.description.bounding_box = cg::BoundingBox(cg::Location{}, WALKER_EXTENT);
+      actor.description.semantic_tags = {12u};
+    } else if (actor.type == 's') {
+      actor.stream = _streaming_server.MakeStream();
+      const auto token = actor.stream->token();
+      actor.description.stream_token = decltype(actor.description.stream_token)(
+          std::begin(token.data), std::end(token.data));
+    }
+    // 把蓝图中的所有属性补全到描述中，与 UE4 的行为一致。
+    for (const auto &definition : MakeActorDefinitions()) {
+      if (definition.id == description.id) {
+        for (const auto &attribute : definition.attributes) {
+          if (FindAttribute(description, attribute.id) == nullptr) {
+            description.attributes.emplace_back(attribute);
+          }
+        }
+      }
+    }
+    actor.description.description = std::move(description);
+    const auto id = actor.description.id;
+    auto result = actor.description;
+    _actors.emplace(id, std::move(actor));
+    return result;
+  }
+
+  std::vector<cr::ActorDefinition> StandInServer::MakeActorDefinitions() const {
+    std::vector<cr::ActorDefinition> result(4u);
+    result[0u].id = "vehicle.standin.car";
+    result[0u].tags = "vehicle,standin,car";
+    result[0u].attributes = {
+      MakeAttribute("role_name", cr::ActorAttributeType::String, "autopilot"),
+      MakeAttribute("number_of_wheels", cr::ActorAttributeType::Int, "4"),
+      MakeAttribute("base_type", cr::ActorAttributeType::String, "car")};
+    result[1u].id = "walker.pedestrian.standin";
+    result[1u].tags = "walker,pedestrian,standin";
+    result[1u].attributes = {
+      MakeAttribute("role_name", cr::ActorAttributeType::String, "pedestrian"),
+      MakeAttribute("speed", cr::ActorAttributeType::Float, "1.4")};
+    result[2u].id = "sensor.camera.rgb";
+    result[2u].tags = "sensor,camera,rgb";
+    result[2u].attributes = {
+      MakeAttribute("image_size_x", cr::ActorAttributeType::Int, "800"),
+      MakeAttribute("image_size_y", cr::ActorAttributeType::Int, "600"),
+      MakeAttribute("fov", cr::ActorAttributeType::Float, "90.0")};
+    result[3u].id = "sensor.lidar.ray_cast";
+    result[3u].tags = "sensor,lidar,ray_cast";
+    result[3u].attributes = {
+      MakeAttribute("channels", cr::ActorAttributeType::Int, "32"),
+      MakeAttribute("points_per_second", cr::ActorAttributeType::Int, "56000")};
+    for (auto i = 0u; i < result.size(); ++i) {
+      result[i].uid = i + 1u;
+    }
+    return result;
+  }
+
+  /// 按命令类型分别执行批处理命令，每种有效果的命令一个重载。
+  struct StandInServer::CommandVisitor {
+    using C = cr::Command;
+    using result_type = cr::CommandResponse;
+
+    StandInServer &self;
+
+    result_type operator()(const C::SpawnActor &cmd) const {
+      const auto actor = self.Spawn(cmd.description, cmd.transform, cmd.parent.value_or(0u));
+      for (const auto &next : cmd.do_after) {
+        self.Execute(next);
+      }
+      return actor.id;
+    }
+
+    result_type operator()(const C::DestroyActor &cmd) const {
+      return self._actors.erase(cmd.actor) > 0u ? result_type{cmd.actor} : NotFound();
+    }
+
+    result_type operator()(const C::ConsoleCommand &) const {
+      return 0u;
+    }
+
+    result_type operator()(const C::ApplyVehicleControl &cmd) const {
+      return Apply(cmd.actor, [&](SimulatedActor &actor) { actor.vehicle_control = cmd.control; });
+    }
+
+    result_type operator()(const C::ApplyWalkerControl &cmd) const {
+      return Apply(cmd.actor, [&](SimulatedActor &actor) { actor.walker_control = cmd.control; });
+    }
+
+    result_type operator()(const C::ApplyTransform &cmd) const {
+      return Apply(cmd.actor, [&](SimulatedActor &actor) { actor.transform = cmd.transform; });
+    }
+
+    result_type operator()(const C::ApplyLocation &cmd) const {
+      return Apply(cmd.actor, [&](SimulatedActor &actor) { actor.transform.location = cmd.location; });
+    }
+
+    result_type operator()(const C::ApplyTargetVelocity &cmd) const {
+      return Apply(cmd.actor, [&](SimulatedActor &actor) { actor.velocity = cmd.velocity; });
+    }
+
+    result_type operator()(const C::SetSimulatePhysics &cmd) const {
+      return Apply(cmd.actor, [&](SimulatedActor &actor) {
+        actor.simulate_physics = cmd.enabled;
+        if (!cmd.enabled) {
+          actor.velocity = cg::Vector3D{};
+        }
+      });
+    }
+
+    result_type operator()(const C::SetVehicleLightState &cmd) const {
+      return Apply(cmd.actor, [&](SimulatedActor &actor) { actor.light_state = cmd.light_state; });
+    }
+
+    /// 其余命令（力、冲量、自动驾驶等）在替身服务器中没有效果。
+    template <typename T>
+    result_type operator()(const T &cmd) const {
+      return Apply(cmd.actor, [](SimulatedActor &) {});
+    }
+
+  private:
+
+    static result_type NotFound() {
+      return result_type{cr::ResponseError("unable to find actor")};
+    }
+
+    template <typename F>
+    result_type Apply(carla::ActorId id, F &&functor) const {
+      auto it = self._actors.find(id);
+      if (it == self._actors.end()) {
+        return NotFound();
+      }
+      functor(it->second);
+      return id;
+    }
+  };
+
+  cr::CommandResponse StandInServer::Execute(const cr::Command &command) {
+    return boost::variant2::visit(CommandVisitor{*this}, command.command);
+  }
+
+  // ===========================================================================
+  // -- RPC ---------------------------------------------------------------------
+  // ===========================================================================
+
+  void StandInServer::BindFunctions() {
+    auto &server = _rpc_server;
+
+    server.BindAsync("version", []() -> std::string { return carla::version(); });
+
+    server.BindSync("get_episode_info", [this]() -> R<cr::EpisodeInfo> {
+      return cr::EpisodeInfo{_episode_id, _episode_stream.token()};
+    });
+
+    server.BindSync("get_map_info", [this]() -> R<cr::MapInfo> {
+      return cr::MapInfo{_options.map_name, _spawn_points};
+    });
+
+    server.BindSync("get_map_data", [this]() -> R<std::string> {
+      return _options.opendrive;
+    });
+
+    server.BindSync("get_required_files", [](std::string) -> R<std::vector<std::string>> {
+      return std::vector<std::string>{};
+    });
+
+    server.BindSync("get_sensor_token", [this](carla::streaming::detail::stream_id_type id) -> R<carla::streaming::Token> {
+      return _streaming_server.GetToken(id);
+    });
+
+    server.BindSync("subscribe_to_episode_state", [this](const cr::EpisodeStateFilter &filter) -> R<carla::streaming::Token> {
+      std::lock_guard<std::mutex> lock(_mutex);
+      auto stream = _streaming_server.MakeStream();
+      const auto token = stream.token();
+      _filtered_streams.push_back(FilteredStream{std::move(stream), filter});
+      return token;
+    });
+
+    server.BindSync("unsubscribe_from_episode_state", [this](carla::streaming::detail::stream_id_type id) -> R<void> {
+      std::lock_guard<std::mutex> lock(_mutex);
+      const auto it = std::find_if(_filtered_streams.begin(), _filtered_streams.end(), [id](const auto &filtered) {
+        return carla::streaming::detail::token_type(filtered.stream.token()).get_stream_id() == id;
+      });
+      if (it == _filtered_streams.end()) {
+        return cr::ResponseError("unable to unsubscribe: episode state stream not found");
+      }
+      _filtered_streams.erase(it);
+      _streaming_server.CloseStream(id);
+      return R<void>::Success();
+    });
+
+    server.BindSync("get_actor_definitions", [this]() -> R<std::vector<cr::ActorDefinition>> {
+      return MakeActorDefinitions();
+    });
+
+    server.BindSync("get_spectator", [this]() -> R<cr::Actor> {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _actors.at(_spectator_id).description;
+    });
+
+    server.BindSync("get_episode_settings", [this]() -> R<cr::EpisodeSettings> {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _settings;
+    });
+
+    server.BindSync("set_episode_settings", [this](const cr::EpisodeSettings &settings) -> R<uint64_t> {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _settings = settings;
+      return _frame.load();
+    });
+
+    server.BindSync("get_actors_by_id", [this](const std::vector<carla::ActorId> &ids) -> R<std::vector<cr::Actor>> {
+      std::lock_guard<std::mutex> lock(_mutex);
+      std::vector<cr::Actor> result;
+      result.reserve(ids.size());
+      for (auto id : ids) {
+        auto it = _actors.find(id);
+        if (it != _actors.end()) {
+          result.push_back(it->second.description);
+        }
+      }
+      return result;
+    });
+
+    server.BindSync("spawn_actor", [this](
+        cr::ActorDescription description,
+        const cr::Transform &transform) -> R<cr::Actor> {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return Spawn(std::move(description), transform);
+    });
+
+    server.BindSync("spawn_actor_with_parent", [this](
+        cr::ActorDescription description,
+        const cr::Transform &transform,
+        cr::ActorId parent,
+        cr::AttachmentType,
+        const std::string &) -> R<cr::Actor> {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_actors.find(parent) == _actors.end()) {
+        return cr::ResponseError("unable to attach actor: parent not found");
+      }
+      return Spawn(std::move(description), transform, parent);
+    });
+
+    server.BindSync("destroy_actor", [this](cr::ActorId id) -> R<bool> {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_actors.erase(id) == 0u) {
+        return cr::ResponseError("unable to destroy actor: not found");
+      }
+      return true;
+    });
+
+    server.BindSync("apply_batch", [this](
+        const std::vector<cr::Command> &commands,
+        bool do_tick_cue) -> std::vector<cr::CommandResponse> {
+      std::vector<cr::CommandResponse> result;
+      result.reserve(commands.size());
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (const auto &command : commands) {
+          result.emplace_back(Execute(command));
+        }
+      }
+      if (do_tick_cue) {
+        Tick();
+      }
+      return result;
+    });
+
+    server.BindSync("tick_cue", [this]() -> R<uint64_t> {
+      return Tick();
+    });
+
+    // 单个参与者的命令复用批处理命令的实现。
+    server.BindSync("apply_control_to_vehicle", [this](cr::ActorId id, const cr::VehicleControl &control) -> R<void> {
+      std::lock_guard<std::mutex> lock(_mutex);
+      Execute(cr::Command::ApplyVehicleControl{id, control});
+      return R<void>::Success();
+    });
+
+    server.BindSync("apply_control_to_walker", [this](cr::ActorId id, const cr::WalkerControl &control) -> R<void> {
+      std::lock_guard<std::mutex> lock(_mutex);
+      Execute(cr::Command::ApplyWalkerControl{id, control});
+      return R<void>::Success();
+    });
+
+    server.BindSync("set_actor_transform", [this](cr::ActorId id, const cr::Transform &transform) -> R<void> {
+      std::lock_guard<std::mutex> lock(_mutex);
+      Execute(cr::Command::ApplyTransform{id, transform});
+      return R<void>::Success();
+    });
+
+    server.BindSync("set_actor_target_velocity", [this](cr::ActorId id, const cr::Vector3D &velocity) -> R<void> {
+      std::lock_guard<std::mutex> lock(_mutex);
+      Execute(cr::Command::ApplyTargetVelocity{id, velocity});
+      return R<void>::Success();
+    });
+
+    server.BindSync("set_actor_simulate_physics", [this](cr::ActorId id, bool enabled) -> R<void> {
+      std::lock_guard<std::mutex> lock(_mutex);
+      Execute(cr::Command::SetSimulatePhysics{id, enabled});
+      return R<void>::Success();
+    });
+
+    server.BindSync("set_actor_autopilot", [](cr::ActorId, bool) -> R<void> {
+      return R<void>::Success();
+    });
+
+    server.BindSync("get_vehicle_light_state", [this](cr::ActorId id) -> R<cr::VehicleLightState> {
+      std::lock_guard<std::mutex> lock(_mutex);
+      auto it = _actors.find(id);
+      if (it == _actors.end()) {
+        return cr::ResponseError("unable to get light state: actor not found");
+      }
+      return cr::VehicleLightState(it->second.light_state);
+    });
+
+    server.BindSync("get_vehicle_light_states", [this]() -> R<std::vector<std::pair<carla::ActorId, uint32_t>>> {
+      std::lock_guard<std::mutex> lock(_mutex);
+      std::vector<std::pair<carla::ActorId, uint32_t>> result;
+      for (const auto &pair : _actors) {
+        if (pair.second.type == 'v') {
+          result.emplace_back(pair.first, pair.second.light_state);
+        }
+      }
+      return result;
+    });
+
+    server.BindSync("set_vehicle_light_state", [this](cr::ActorId id, const cr::VehicleLightState &state) -> R<void> {
+      std::lock_guard<std::mutex> lock(_mutex);
+      Execute(cr::Command::SetVehicleLightState{id, state.GetLightStateAsValue()});
+      return R<void>::Success();
+    });
+
+    // 交通管理器的注册信息。
+    server.BindSync("is_traffic_manager_running", [this](uint16_t port) -> R<bool> {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _traffic_managers.find(port) != _traffic_managers.end();
+    });
+
+    server.BindSync("get_traffic_manager_running", [this](uint16_t port) -> R<std::pair<std::string, uint16_t>> {
+      std::lock_guard<std::mutex> lock(_mutex);
+      auto it = _traffic_managers.find(port);
+      if (it == _traffic_managers.end()) {
+        return std::pair<std::string, uint16_t>{"", 0u};
+      }
+      return it->second;
+    });
+
+    server.BindSync("add_traffic_manager_running", [this](std::pair<std::string, uint16_t> info) -> R<bool> {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _traffic_managers.emplace(info.second, info).second;
+    });
+
+    server.BindSync("destroy_traffic_manager", [this](uint16_t port) -> R<bool> {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _traffic_managers.erase(port) > 0u;
+    });
+  }
+
+} // namespace util
@@ -0,0 +1,189 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <carla/NonCopyable.h>
+#include <carla/ThreadGroup.h>
+#include <carla/Time.h>
+#include <carla/geom/Transform.h>
+#include <carla/road/Map.h>
+#include <carla/rpc/Actor.h>
+#include <carla/rpc/Command.h>
+#include <carla/rpc/CommandResponse.h>
+#include <carla/rpc/EpisodeSettings.h>
+#include <carla/rpc/EpisodeStateFilter.h>
+#include <carla/rpc/Server.h>
+#include <carla/rpc/VehicleControl.h>
+#include <carla/rpc/WalkerControl.h>
+#include <carla/sensor/s11n/EpisodeStateIndex.h>
+#include <carla/streaming/Server.h>
+
+#include <boost/optional.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace util {
+
+  /// 不依赖 UE4 的替身仿真服务器，用于在 CI 或没有 GPU 的机器上对客户端、
+  /// 交通管理器与流式传输做基准测试和回归测试。
+  ///
+  /// 基于 rpc::Server 与 streaming::Server 实现客户端需要的一组 RPC：加载
+  /// XODR 作为地图，根据施加的控制对车辆与行人做简单的运动学积分，并按帧
+  /// 发布 RawEpisodeState 以及合成的相机图像与激光雷达点云。不模拟碰撞、
+  /// 交通灯与物理细节。
+  class StandInServer : private carla::NonCopyable {
+  public:
+
+    using clock = std::chrono::steady_clock;
+
+    struct Options {
+      uint16_t rpc_port = 2000u;
+
+      /// 为 0 时由系统选择端口，客户端从流的令牌中得到实际端口。
+      uint16_t streaming_port = 0u;
+
+      /// 地图名，客户端据此查找本地缓存的 XODR。
+      std::string map_name = "StandIn";
+
+      /// XODR 内容，为空时不加载地图，也没有推荐生成点。
+      std::string opendrive;
+
+      /// 异步模式下两帧之间的真实时间间隔。
+      carla::time_duration tick_interval = carla::time_duration::milliseconds(50u);
+
+      /// RPC 与流式传输各自的网络线程数。
+      size_t worker_threads = 2u;
+    };
+
+    explicit StandInServer(Options options);
+
+    ~StandInServer();
+
+    /// 启动网络线程与游戏线程。
+    void Start();
+
+    void Stop();
+
+    /// 不经 RPC 直接生成车辆或行人，位置依次取自地图的推荐生成点。
+    std::vector<carla::ActorId> SpawnVehicles(size_t count);
+
+    std::vector<carla::ActorId> SpawnWalkers(size_t count);
+
+    uint64_t GetFrame() const {
+      return _frame;
+    }
+
+    size_t GetActorCount() const;
+
+    /// 第 @a frame 帧的仿真状态写入流的时刻，只保留最近的若干帧。
+    boost::optional<clock::time_point> GetPublishTime(uint64_t frame) const;
+
+  private:
+
+    struct SimulatedActor {
+      carla::rpc::Actor description;
+      carla::geom::Transform transform;
+      carla::geom::Vector3D velocity;
+      carla::geom::Vector3D angular_velocity;
+      carla::geom::Vector3D acceleration;
+      carla::rpc::VehicleControl vehicle_control;
+      carla::rpc::WalkerControl walker_control;
+      uint32_t light_state = 0u;
+      bool simulate_physics = true;
+      char type = 'o'; ///< 类型 ID 的首字母：'v' 车辆、'w' 行人、's' 传感器
+      /// 传感器专用。
+      boost::optional<carla::streaming::Stream> stream;
+    };
+
+    struct FilteredStream {
+      carla::streaming::Stream stream;
+      carla::rpc::EpisodeStateFilter filter;
+    };
+
+    void BindFunctions();
+
+    void GameThreadLoop();
+
+    /// 推进一帧：积分运动学状态并发布仿真状态与传感器数据。
+    uint64_t Tick();
+
+    void Integrate(SimulatedActor &actor, float delta_seconds) const;
+
+    void PublishEpisodeState(double timestamp, float delta_seconds);
+
+    void PublishSensor(const SimulatedActor &sensor, double timestamp, float delta_seconds);
+
+    carla::rpc::Actor Spawn(
+        carla::rpc::ActorDescription description,
+        const carla::geom::Transform &transform,
+        carla::ActorId parent = 0u);
+
+    struct CommandVisitor;
+
+    carla::rpc::CommandResponse Execute(const carla::rpc::Command &command);
+
+    carla::geom::Transform GetWorldTransform(const SimulatedActor &actor) const;
+
+    std::vector<carla::rpc::ActorDefinition> MakeActorDefinitions() const;
+
+    const Options _options;
+
+    boost::optional<carla::road::Map> _map;
+
+    std::vector<carla::geom::Transform> _spawn_points;
+
+    size_t _next_spawn_point = 0u;
+
+    carla::rpc::Server _rpc_server;
+
+    carla::streaming::Server _streaming_server;
+
+    carla::streaming::Stream _episode_stream;
+
+    /// subscribe_to_episode_state 创建的流，由 _mutex 保护。
+    std::vector<FilteredStream> _filtered_streams;
+
+    carla::sensor::s11n::EpisodeStateIndex _index;
+
+    std::vector<uint32_t> _selected;
+
+    const uint64_t _episode_id;
+
+    const clock::time_point _start_time;
+
+    /// 保护以下仿真状态，RPC 在游戏线程中执行，测试线程也可以直接生成参与者。
+    mutable std::mutex _mutex;
+
+    std::map<carla::ActorId, SimulatedActor> _actors;
+
+    carla::ActorId _next_actor_id = 1u;
+
+    carla::ActorId _spectator_id = 0u;
+
+    carla::rpc::EpisodeSettings _settings;
+
+    std::atomic<uint64_t> _frame{0u};
+
+    double _elapsed_seconds = 0.0;
+
+    std::unordered_map<uint16_t, std::pair<std::string, uint16_t>> _traffic_managers;
+
+    std::vector<std::pair<uint64_t, clock::time_point>> _publish_times;
+
+    std::atomic_bool _stop{false};
+
+    carla::ThreadGroup _game_thread;
+  };
+
+} // namespace util
@@ -0,0 +1,75 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/trafficmanager/ActorLifecycleTracker.h>
+
+#include <algorithm>
+#include <vector>
+
+using carla::traffic_manager::ActorDelta;
+using carla::traffic_manager::ActorLifecycleTracker;
+
+static std::vector<carla::ActorId> Sorted(std::vector<carla::ActorId> ids) {
+  std::sort(ids.begin(), ids.end());
+  return ids;
+}
+
+static ActorDelta Update(
+    ActorLifecycleTracker &tracker,
+    const std::vector<carla::ActorId> &ids,
+    uint64_t digest,
+    uint64_t episode = 1u) {
+  auto delta = tracker.Update(episode, digest, ids.size(), ids);
+  delta.added = Sorted(delta.added);
+  delta.removed = Sorted(delta.removed);
+  return delta;
+}
+
+TEST(actor_lifecycle_tracker, reports_added_and_removed) {
+  ActorLifecycleTracker tracker;
+  auto delta = Update(tracker, {3u, 1u, 2u}, 10u);
+  ASSERT_EQ(delta.added, (std::vector<carla::ActorId>{1u, 2u, 3u}));
+  ASSERT_TRUE(delta.removed.empty());
+  ASSERT_EQ(tracker.size(), 3u);
+
+  delta = Update(tracker, {1u, 3u, 4u, 5u}, 20u);
+  ASSERT_EQ(delta.added, (std::vector<carla::ActorId>{4u, 5u}));
+  ASSERT_EQ(delta.removed, (std::vector<carla::ActorId>{2u}));
+  ASSERT_TRUE(tracker.Contains(4u));
+  ASSERT_FALSE(tracker.Contains(2u));
+
+  delta = Update(tracker, {}, 0u);
+  ASSERT_TRUE(delta.added.empty());
+  ASSERT_EQ(delta.removed, (std::vector<carla::ActorId>{1u, 3u, 4u, 5u}));
+  ASSERT_EQ(tracker.size(), 0u);
+}
+
+TEST(actor_lifecycle_tracker, skips_unchanged_frames) {
+  ActorLifecycleTracker tracker;
+  Update(tracker, {1u, 2u}, 42u);
+  // 摘要与数量都未变化时不会遍历 ID，即使传入的 ID 不同。
+  auto delta = Update(tracker, {7u, 8u}, 42u);
+  ASSERT_TRUE(delta.empty());
+  ASSERT_TRUE(tracker.Contains(1u));
+  // 摘要变化时重新比较。
+  delta = Update(tracker, {1u, 3u}, 43u);
+  ASSERT_EQ(delta.added, (std::vector<carla::ActorId>{3u}));
+  ASSERT_EQ(delta.removed, (std::vector<carla::ActorId>{2u}));
+}
+
+TEST(actor_lifecycle_tracker, episode_change_and_reset) {
+  ActorLifecycleTracker tracker;
+  Update(tracker, {1u, 2u}, 42u, 1u);
+  auto delta = Update(tracker, {2u, 5u}, 42u, 2u);
+  ASSERT_EQ(delta.added, (std::vector<carla::ActorId>{5u}));
+  ASSERT_EQ(delta.removed, (std::vector<carla::ActorId>{1u}));
+  tracker.Reset();
+  delta = Update(tracker, {2u, 5u}, 42u, 2u);
+  ASSERT_EQ(delta.added, (std::vector<carla::ActorId>{2u, 5u}));
+  ASSERT_TRUE(delta.removed.empty());
+}
@@ -0,0 +1,182 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/sensor/AsyncDataWriter.h>
+#include <carla/sensor/data/LidarData.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/make_shared.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using carla::sensor::AsyncDataWriter;
+using carla::sensor::data::LidarDetection;
+
+namespace fs = boost::filesystem;
+
+static std::string ReadFile(const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+TEST(async_data_writer, writes_all_jobs) {
+  constexpr size_t number_of_jobs = 200u;
+  std::atomic_size_t count{0u};
+  AsyncDataWriter writer(4u);
+  ASSERT_EQ(writer.GetWorkerCount(), 4u);
+  for (auto i = 0u; i < number_of_jobs; ++i) {
+    ASSERT_TRUE(writer.Enqueue([&]() { ++count; }, 10u));
+  }
+  writer.Flush();
+  ASSERT_EQ(count, number_of_jobs);
+  const auto stats = writer.GetStats();
+  ASSERT_EQ(stats.pending_jobs, 0u);
+  ASSERT_EQ(stats.pending_bytes, 0u);
+  ASSERT_EQ(stats.written_jobs, number_of_jobs);
+  ASSERT_EQ(stats.written_bytes, 10u * number_of_jobs);
+  ASSERT_EQ(stats.dropped_jobs, 0u);
+  ASSERT_EQ(stats.failed_jobs, 0u);
+}
+
+TEST(async_data_writer, drops_when_full) {
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  AsyncDataWriter writer(1u, 100u, AsyncDataWriter::OverflowPolicy::Drop);
+  // 一个超过上限的任务在空闲时仍会被接受。
+  ASSERT_TRUE(writer.Enqueue([released]() { released.wait(); }, 150u));
+  ASSERT_FALSE(writer.Enqueue([]() {}, 1u));
+  ASSERT_FALSE(writer.Enqueue([]() {}, 1u));
+  release.set_value();
+  writer.Flush();
+  ASSERT_TRUE(writer.Enqueue([]() {}, 1u));
+  writer.Flush();
+  const auto stats = writer.GetStats();
+  ASSERT_EQ(stats.written_jobs, 2u);
+  ASSERT_EQ(stats.dropped_jobs, 2u);
+}
+
+TEST(async_data_writer, blocks_when_full) {
+  constexpr size_t max_pending_bytes = 64u;
+  std::atomic_size_t pending{0u};
+  std::atomic_size_t max_pending{0u};
+  AsyncDataWriter writer(2u, max_pending_bytes);
+  for (auto i = 0u; i < 100u; ++i) {
+    writer.Enqueue([&]() {
+      const size_t current = ++pending;
+      size_t previous = max_pending;
+      while (previous < current && !max_pending.compare_exchange_weak(previous, current)) {}
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+      --pending;
+    }, 16u);
+  }
+  writer.Flush();
+  const auto stats = writer.GetStats();
+  ASSERT_EQ(stats.written_jobs, 100u);
+  ASSERT_EQ(stats.dropped_jobs, 0u);
+  ASSERT_LE(max_pending, max_pending_bytes / 16u);
+}
+
+TEST(async_data_writer, counts_failures) {
+  AsyncDataWriter writer(1u);
+  writer.Enqueue([]() { throw std::runtime_error("expected failure"); }, 1u);
+  writer.Enqueue([]() {}, 1u);
+  writer.Flush();
+  const auto stats = writer.GetStats();
+  ASSERT_EQ(stats.written_jobs, 1u);
+  ASSERT_EQ(stats.failed_jobs, 1u);
+}
+
+TEST(async_data_writer, destructor_drains_queue) {
+  std::atomic_size_t count{0u};
+  {
+    AsyncDataWriter writer(1u);
+    for (auto i = 0u; i < 50u; ++i) {
+      writer.Enqueue([&]() { ++count; }, 1u);
+    }
+  }
+  ASSERT_EQ(count, 50u);
+}
+
+TEST(async_data_writer, binary_ply) {
+  std::vector<LidarDetection> points;
+  for (auto i = 0u; i < 10u; ++i) {
+    points.emplace_back(1.0f * i, 2.0f * i, 3.0f * i, 0.5f);
+  }
+  std::ostringstream ascii;
+  carla::pointcloud::PointCloudIO::Dump(ascii, points.begin(), points.end());
+  std::ostringstream binary;
+  carla::pointcloud::PointCloudIO::DumpBinary(binary, points.data(), points.data() + points.size());
+
+  const std::string header =
+      "ply\n"
+      "format binary_little_endian 1.0\n"
+      "element vertex 10\n"
+      "property float32 x\n"
+      "property float32 y\n"
+      "property float32 z\n"
+      "property float32 I\n"
+      "end_header\n";
+  const auto result = binary.str();
+  ASSERT_EQ(result.size(), header.size() + points.size() * sizeof(LidarDetection));
+  ASSERT_EQ(result.substr(0u, header.size()), header);
+  ASSERT_EQ(0, std::memcmp(result.data() + header.size(), points.data(), points.size() * sizeof(LidarDetection)));
+  // 两种格式的头部只有 format 一行不同。
+  ASSERT_NE(ascii.str().find("format ascii 1.0\nelement vertex 10\n"), std::string::npos);
+}
+
+TEST(async_data_writer, writes_files) {
+  const auto folder = fs::temp_directory_path() / fs::unique_path("carla-async-writer-%%%%-%%%%");
+  auto points = boost::make_shared<std::vector<LidarDetection>>();
+  for (auto i = 0u; i < 100u; ++i) {
+    points->emplace_back(0.1f * i, -0.2f * i, 0.3f * i, 1.0f);
+  }
+  const auto bytes = points->size() * sizeof(LidarDetection);
+  {
+    AsyncDataWriter writer(2u);
+    ASSERT_TRUE(writer.EnqueueRaw((folder / "raw" / "points.bin").string(), points));
+    ASSERT_TRUE(writer.EnqueuePointCloud((folder / "ply" / "points").string(), points));
+    writer.Flush();
+    const auto stats = writer.GetStats();
+    ASSERT_EQ(stats.written_jobs, 2u);
+    ASSERT_EQ(stats.written_bytes, 2u * bytes);
+  }
+  const auto raw = ReadFile((folder / "raw" / "points.bin").string());
+  ASSERT_EQ(raw.size(), bytes);
+  ASSERT_EQ(0, std::memcmp(raw.data(), points->data(), bytes));
+  const auto ply = ReadFile((folder / "ply" / "points.ply").string());
+  ASSERT_GT(ply.size(), bytes);
+  ASSERT_EQ(0, std::memcmp(ply.data() + ply.size() - bytes, points->data(), bytes));
+  fs::remove_all(folder);
+}
+
+TEST(async_data_writer, counts_failed_writes) {
+  const auto folder = fs::temp_directory_path() / fs::unique_path("carla-async-writer-%%%%-%%%%");
+  auto points = boost::make_shared<std::vector<LidarDetection>>(10u);
+  // 目标路径是已存在的目录，无法作为文件打开。
+  fs::create_directories(folder / "points.bin");
+  fs::create_directories(folder / "points.ply");
+  {
+    AsyncDataWriter writer(1u);
+    ASSERT_TRUE(writer.EnqueueRaw((folder / "points.bin").string(), points));
+    ASSERT_TRUE(writer.EnqueuePointCloud((folder / "points.ply").string(), points));
+    writer.Flush();
+    const auto stats = writer.GetStats();
+    ASSERT_EQ(stats.written_jobs, 0u);
+    ASSERT_EQ(stats.failed_jobs, 2u);
+  }
+  fs::remove_all(folder);
+}
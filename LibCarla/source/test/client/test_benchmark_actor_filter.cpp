@@ -0,0 +1,191 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/StopWatch.h>
+#include <carla/StringUtil.h>
+#include <carla/WildcardPattern.h>
+#include <carla/client/detail/CachedActorList.h>
+
+#include <algorithm>
+#include <iterator>
+#include <unordered_set>
+
+using carla::StringUtil;
+using carla::WildcardPattern;
+using carla::client::detail::CachedActorList;
+
+static const char *TYPE_IDS[] = {
+  "vehicle.tesla.model3",
+  "vehicle.audi.a2",
+  "vehicle.carlamotors.firetruck",
+  "walker.pedestrian.0001",
+  "walker.pedestrian.0042",
+  "controller.ai.walker",
+  "sensor.camera.rgb",
+  "static.prop.trafficcone01",
+  "traffic.traffic_light",
+  "traffic.stop",
+};
+
+static std::vector<carla::rpc::Actor> MakeActors(size_t count) {
+  std::vector<carla::rpc::Actor> actors(count);
+  for (auto i = 0u; i < count; ++i) {
+    actors[i].id = i + 1u;
+    actors[i].description.id = TYPE_IDS[i % (sizeof(TYPE_IDS) / sizeof(TYPE_IDS[0u]))];
+  }
+  return actors;
+}
+
+// 与 Episode::GetActorsMatching 相同的查找过程：索引给出候选，再过滤存活与匹配。
+static std::vector<carla::ActorId> FilterWithIndex(
+    const CachedActorList &cache,
+    const std::unordered_set<carla::ActorId> &alive,
+    const std::string &wildcard_pattern) {
+  const auto pattern = WildcardPattern::Compile(wildcard_pattern);
+  const auto key = CachedActorList::GetIndexKey(*pattern);
+  EXPECT_TRUE(key.has_value());
+  auto ids = cache.GetIdsByTypePrefix(*key);
+  ids.erase(std::remove_if(ids.begin(), ids.end(), [&](carla::ActorId id) {
+    return alive.find(id) == alive.end();
+  }), ids.end());
+  std::vector<carla::ActorId> result;
+  for (const auto &actor : cache.GetActorsById(ids)) {
+    if (pattern->Match(actor.description.id)) {
+      result.push_back(actor.id);
+    }
+  }
+  return result;
+}
+
+// 原来的 world.get_actors().filter() 过程：先取出全部存活参与者，再逐个匹配。
+static std::vector<carla::ActorId> FilterWithFnmatch(
+    const CachedActorList &cache,
+    const std::vector<carla::ActorId> &alive,
+    const std::string &wildcard_pattern) {
+  std::vector<carla::ActorId> result;
+  for (const auto &actor : cache.GetActorsById(alive)) {
+    if (StringUtil::Match(actor.description.id, wildcard_pattern)) {
+      result.push_back(actor.id);
+    }
+  }
+  return result;
+}
+
+TEST(actor_filter, index_keys) {
+  auto key = [](const char *pattern) {
+    return CachedActorList::GetIndexKey(WildcardPattern(pattern));
+  };
+  ASSERT_EQ(*key("vehicle.*"), "vehicle");
+  ASSERT_EQ(*key("walker.pedestrian.00*"), "walker.pedestrian");
+  ASSERT_EQ(*key("traffic.traffic_light"), "traffic.traffic_light");
+  ASSERT_FALSE(key("*traffic_light*").has_value());
+  ASSERT_FALSE(key("vehicle*").has_value());
+}
+
+TEST(actor_filter, index_matches_fnmatch) {
+  const auto actors = MakeActors(1000u);
+  CachedActorList cache;
+  cache.InsertRange(actors);
+  // 一半参与者已被销毁，但仍留在缓存中。
+  std::vector<carla::ActorId> alive_ids;
+  for (const auto &actor : actors) {
+    if (actor.id % 2u == 0u) {
+      alive_ids.push_back(actor.id);
+    }
+  }
+  const std::unordered_set<carla::ActorId> alive(alive_ids.begin(), alive_ids.end());
+  for (const char *pattern : {"vehicle.*", "walker.pedestrian.0042", "traffic.*", "vehicle.audi.*", "sensor.camera.rgb"}) {
+    auto expected = FilterWithFnmatch(cache, alive_ids, pattern);
+    auto result = FilterWithIndex(cache, alive, pattern);
+    std::sort(result.begin(), result.end());
+    ASSERT_EQ(result, expected) << pattern;
+  }
+  cache.Clear();
+  ASSERT_TRUE(cache.GetIdsByTypePrefix("vehicle").empty());
+}
+
+TEST(actor_filter, index_drops_destroyed_actors) {
+  const auto actors = MakeActors(100u);
+  CachedActorList cache;
+  cache.InsertRange(actors);
+  const auto vehicles = cache.GetIdsByTypePrefix("vehicle").size();
+  ASSERT_GT(vehicles, 0u);
+
+  // 只有编号为偶数的参与者仍然存活。
+  std::vector<carla::ActorId> alive;
+  for (const auto &actor : actors) {
+    if (actor.id % 2u == 0u) {
+      alive.push_back(actor.id);
+    }
+  }
+  cache.UpdateTypeIndex(alive);
+  for (const char *key : {"vehicle", "walker.pedestrian", "traffic.stop"}) {
+    for (auto id : cache.GetIdsByTypePrefix(key)) {
+      ASSERT_EQ(id % 2u, 0u) << key;
+    }
+  }
+  ASSERT_LT(cache.GetIdsByTypePrefix("vehicle").size(), vehicles);
+  // 描述仍在缓存中。
+  ASSERT_TRUE(cache.GetActorById(1u).has_value());
+
+  // 全部销毁后索引为空。
+  cache.UpdateTypeIndex(std::vector<carla::ActorId>{});
+  ASSERT_TRUE(cache.GetIdsByTypePrefix("vehicle").empty());
+  ASSERT_TRUE(cache.GetIdsByTypePrefix("walker").empty());
+
+  // 已缓存的参与者重新出现在世界状态中时重新加入索引。
+  cache.UpdateTypeIndex(std::vector<carla::ActorId>{1u});
+  ASSERT_EQ(cache.GetIdsByTypePrefix("vehicle.tesla"), std::vector<carla::ActorId>{1u});
+}
+
+TEST(actor_filter, benchmark_10k_actors) {
+  constexpr auto number_of_actors = 10000u;
+  constexpr auto iterations = 100u;
+  const auto actors = MakeActors(number_of_actors);
+  CachedActorList cache;
+  cache.InsertRange(actors);
+  std::vector<carla::ActorId> alive_ids;
+  for (const auto &actor : actors) {
+    alive_ids.push_back(actor.id);
+  }
+  const std::unordered_set<carla::ActorId> alive(alive_ids.begin(), alive_ids.end());
+
+  for (const char *pattern : {"vehicle.*", "traffic.traffic_light", "walker.pedestrian.*"}) {
+    size_t fnmatch_count = 0u;
+    carla::StopWatch fnmatch_watch;
+    for (auto i = 0u; i < iterations; ++i) {
+      fnmatch_count += FilterWithFnmatch(cache, alive_ids, pattern).size();
+    }
+    fnmatch_watch.Stop();
+
+    size_t compiled_count = 0u;
+    carla::StopWatch compiled_watch;
+    for (auto i = 0u; i < iterations; ++i) {
+      const auto compiled = WildcardPattern::Compile(pattern);
+      for (const auto &actor : cache.GetActorsById(alive_ids)) {
+        compiled_count += compiled->Match(actor.description.id) ? 1u : 0u;
+      }
+    }
+    compiled_watch.Stop();
+
+    size_t index_count = 0u;
+    carla::StopWatch index_watch;
+    for (auto i = 0u; i < iterations; ++i) {
+      index_count += FilterWithIndex(cache, alive, pattern).size();
+    }
+    index_watch.Stop();
+
+    ASSERT_EQ(compiled_count, fnmatch_count);
+    ASSERT_EQ(index_count, fnmatch_count);
+    carla::logging::log(
+        "filter", pattern, "over", number_of_actors, "actors (us/call): fnmatch",
+        fnmatch_watch.GetElapsedTime<std::chrono::microseconds>() / iterations,
+        "compiled", compiled_watch.GetElapsedTime<std::chrono::microseconds>() / iterations,
+        "index", index_watch.GetElapsedTime<std::chrono::microseconds>() / iterations);
+  }
+}
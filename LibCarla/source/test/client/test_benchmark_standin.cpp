@@ -0,0 +1,208 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "OpenDrive.h"
+#include "StandInServer.h"
+
+#include <carla/StopWatch.h>
+#include <carla/client/ActorList.h>
+#include <carla/client/Client.h>
+#include <carla/client/World.h>
+#include <carla/trafficmanager/TrafficManager.h>
+
+#include <algorithm>
+#include <mutex>
+
+namespace cc = carla::client;
+
+using namespace std::chrono_literals;
+using util::StandInServer;
+
+// 替身服务器的 RPC 端口，与 test_rpc 相同，TESTING_PORT 为 0 时使用固定端口；
+// 流式传输端口由系统选择，客户端从令牌中得到。
+static constexpr uint16_t STANDIN_RPC_PORT = (TESTING_PORT != 0u ? TESTING_PORT : 2300u);
+static constexpr uint16_t STANDIN_TM_PORT = 8300u;
+
+static StandInServer::Options MakeOptions() {
+  StandInServer::Options options;
+  options.rpc_port = STANDIN_RPC_PORT;
+  const auto files = util::OpenDrive::GetAvailableFiles();
+  if (!files.empty()) {
+    options.map_name = files.front().substr(0u, files.front().rfind('.'));
+    options.opendrive = util::OpenDrive::Load(files.front());
+  }
+  return options;
+}
+
+static cc::World MakeSynchronousWorld(cc::Client &client) {
+  auto world = client.GetWorld();
+  auto settings = world.GetSettings();
+  settings.synchronous_mode = true;
+  settings.fixed_delta_seconds = 0.05;
+  world.ApplySettings(settings, 10s);
+  return world;
+}
+
+static double Percentile(std::vector<double> values, double p) {
+  if (values.empty()) {
+    return 0.0;
+  }
+  std::sort(values.begin(), values.end());
+  return values[static_cast<size_t>(p * static_cast<double>(values.size() - 1u))];
+}
+
+// 客户端每帧解析仿真状态并遍历所有参与者的开销。
+static void BenchmarkSnapshotThroughput(const size_t number_of_actors) {
+  constexpr auto number_of_ticks = 100u;
+  StandInServer server(MakeOptions());
+  server.SpawnVehicles(number_of_actors / 2u);
+  server.SpawnWalkers(number_of_actors - number_of_actors / 2u);
+  server.Start();
+
+  cc::Client client("localhost", STANDIN_RPC_PORT);
+  client.SetTimeout(10s);
+  auto world = MakeSynchronousWorld(client);
+
+  carla::StopWatch stop_watch;
+  size_t actors_seen = 0u;
+  for (auto i = 0u; i < number_of_ticks; ++i) {
+    world.Tick(10s);
+    const auto snapshot = world.GetSnapshot();
+    for (const auto &actor : snapshot) {
+      actors_seen += actor.id != 0u ? 1u : 0u;
+    }
+  }
+  stop_watch.Stop();
+  ASSERT_EQ(actors_seen, number_of_ticks * server.GetActorCount());
+
+  const auto fps = 1e3 * number_of_ticks / std::max<size_t>(stop_watch.GetElapsedTime(), 1u);
+  carla::logging::log(
+      "stand-in client throughput:", number_of_actors, "actors,", fps, "ticks/s");
+}
+
+TEST(benchmark_standin, client_snapshot_throughput) {
+  for (const size_t number_of_actors : {100u, 1000u}) {
+    BenchmarkSnapshotThroughput(number_of_actors);
+  }
+}
+
+// 一万个参与者的场景耗时较长，默认不运行，需要时加上
+// --gtest_also_run_disabled_tests --gtest_filter=benchmark_standin.*
+TEST(benchmark_standin, DISABLED_client_snapshot_throughput_10k_actors) {
+  BenchmarkSnapshotThroughput(10000u);
+}
+
+// 服务器写入仿真状态到客户端回调被调用之间的延迟。
+TEST(benchmark_standin, streaming_latency) {
+  auto options = MakeOptions();
+  options.tick_interval = carla::time_duration::milliseconds(10u);
+  StandInServer server(std::move(options));
+  server.SpawnVehicles(500u);
+  server.Start();
+
+  cc::Client client("localhost", STANDIN_RPC_PORT);
+  client.SetTimeout(10s);
+  auto world = client.GetWorld();
+
+  std::mutex mutex;
+  std::vector<double> latencies;
+  const auto id = world.OnTick([&](cc::WorldSnapshot snapshot) {
+    const auto received = StandInServer::clock::now();
+    const auto published = server.GetPublishTime(snapshot.GetFrame());
+    if (published.has_value()) {
+      std::lock_guard<std::mutex> lock(mutex);
+      latencies.push_back(std::chrono::duration<double, std::micro>(received - *published).count());
+    }
+  });
+  std::this_thread::sleep_for(2s);
+  world.RemoveOnTick(id);
+
+  std::lock_guard<std::mutex> lock(mutex);
+  ASSERT_FALSE(latencies.empty());
+  carla::logging::log(
+      "stand-in streaming latency (us): p50", Percentile(latencies, 0.5),
+      "p99", Percentile(latencies, 0.99),
+      "over", latencies.size(), "frames");
+}
+
+// 异步模式下交通管理器逐帧提交与流水线提交的对比：交通管理器在后台处理
+// 每一帧的同时，客户端 world.Tick 的延迟与吞吐量。流水线只在异步模式下生效。
+TEST(benchmark_standin, traffic_manager_pipelined_tick) {
+  constexpr auto number_of_ticks = 100u;
+  for (const bool pipelined : {false, true}) {
+    StandInServer server(MakeOptions());
+    const auto vehicle_ids = server.SpawnVehicles(1000u);
+    server.Start();
+
+    cc::Client client("localhost", STANDIN_RPC_PORT);
+    client.SetTimeout(10s);
+    auto world = MakeSynchronousWorld(client);
+
+    auto actors = world.GetActors(vehicle_ids);
+    std::vector<carla::SharedPtr<cc::Actor>> vehicles(actors->begin(), actors->end());
+    ASSERT_EQ(vehicles.size(), vehicle_ids.size());
+
+    auto traffic_manager = client.GetInstanceTM(STANDIN_TM_PORT);
+    traffic_manager.SetSynchronousMode(false);
+    traffic_manager.SetPipelinedMode(pipelined);
+    traffic_manager.RegisterVehicles(vehicles);
+
+    std::vector<double> tick_latencies;
+    tick_latencies.reserve(number_of_ticks);
+    carla::StopWatch total;
+    for (auto i = 0u; i < number_of_ticks; ++i) {
+      carla::StopWatch stop_watch;
+      world.Tick(10s);
+      stop_watch.Stop();
+      tick_latencies.push_back(static_cast<double>(stop_watch.GetElapsedTime<std::chrono::microseconds>()));
+    }
+    total.Stop();
+    traffic_manager.ShutDown();
+
+    const auto fps = 1e3 * number_of_ticks / std::max<size_t>(total.GetElapsedTime(), 1u);
+    carla::logging::log(
+        pipelined ? "stand-in traffic manager (pipelined):" : "stand-in traffic manager (lockstep):",
+        "world tick latency (us) p50", Percentile(tick_latencies, 0.5),
+        "p99", Percentile(tick_latencies, 0.99),
+        "throughput", fps, "ticks/s");
+  }
+}
+
+// 交通管理器在同步模式下每帧的耗时。
+TEST(benchmark_standin, traffic_manager_tick) {
+  constexpr auto number_of_ticks = 100u;
+  StandInServer server(MakeOptions());
+  const auto vehicle_ids = server.SpawnVehicles(200u);
+  server.Start();
+
+  cc::Client client("localhost", STANDIN_RPC_PORT);
+  client.SetTimeout(10s);
+  auto world = MakeSynchronousWorld(client);
+
+  auto actors = world.GetActors(vehicle_ids);
+  std::vector<carla::SharedPtr<cc::Actor>> vehicles(actors->begin(), actors->end());
+  ASSERT_EQ(vehicles.size(), vehicle_ids.size());
+
+  auto traffic_manager = client.GetInstanceTM(STANDIN_TM_PORT);
+  traffic_manager.SetSynchronousMode(true);
+  traffic_manager.RegisterVehicles(vehicles);
+
+  std::vector<double> tick_times;
+  tick_times.reserve(number_of_ticks);
+  for (auto i = 0u; i < number_of_ticks; ++i) {
+    carla::StopWatch stop_watch;
+    ASSERT_TRUE(traffic_manager.SynchronousTick());
+    world.Tick(10s);
+    stop_watch.Stop();
+    tick_times.push_back(static_cast<double>(stop_watch.GetElapsedTime<std::chrono::microseconds>()));
+  }
+  traffic_manager.ShutDown();
+
+  carla::logging::log(
+      "stand-in traffic manager tick (us): p50", Percentile(tick_times, 0.5),
+      "p99", Percentile(tick_times, 0.99));
+}
@@ -0,0 +1,126 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/client/detail/CallbackExecutor.h>
+
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+using carla::client::detail::CallbackExecutor;
+using carla::client::detail::CallbackPolicy;
+
+template <typename F>
+static bool WaitUntil(F &&condition) {
+  for (auto i = 0; i < 2000; ++i) {
+    if (condition()) {
+      return true;
+    }
+    std::this_thread::sleep_for(1ms);
+  }
+  return condition();
+}
+
+TEST(callback_executor, serial_queue_keeps_order) {
+  CallbackExecutor executor(4u);
+  auto queue = executor.MakeQueue(CallbackPolicy::Serial, 0u);
+  std::mutex mutex;
+  std::vector<int> result;
+  for (auto i = 0; i < 1000; ++i) {
+    queue->Post([&, i]() {
+      std::lock_guard<std::mutex> lock(mutex);
+      result.push_back(i);
+    });
+  }
+  ASSERT_TRUE(WaitUntil([&]() { return queue->GetStats().executed == 1000u; }));
+  std::lock_guard<std::mutex> lock(mutex);
+  ASSERT_EQ(result.size(), 1000u);
+  for (auto i = 0; i < 1000; ++i) {
+    ASSERT_EQ(result[i], i);
+  }
+}
+
+TEST(callback_executor, serial_queue_drops_oldest) {
+  CallbackExecutor executor(1u);
+  auto queue = executor.MakeQueue(CallbackPolicy::Serial, 4u);
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  std::mutex mutex;
+  std::vector<int> result;
+  // 第一个回调阻塞工作线程，期间积压超过上限的旧回调被丢弃。
+  queue->Post([released]() { released.wait(); });
+  ASSERT_TRUE(WaitUntil([&]() { return queue->GetStats().depth == 0u; }));
+  for (auto i = 0; i < 10; ++i) {
+    queue->Post([&, i]() {
+      std::lock_guard<std::mutex> lock(mutex);
+      result.push_back(i);
+    });
+  }
+  ASSERT_EQ(queue->GetStats().depth, 4u);
+  release.set_value();
+  ASSERT_TRUE(WaitUntil([&]() { return queue->GetStats().executed == 5u; }));
+  const auto stats = queue->GetStats();
+  ASSERT_EQ(stats.dropped, 6u);
+  ASSERT_EQ(stats.max_depth, 4u);
+  ASSERT_EQ(executor.GetStats().dropped, 6u);
+  std::lock_guard<std::mutex> lock(mutex);
+  ASSERT_EQ(result, (std::vector<int>{6, 7, 8, 9}));
+}
+
+TEST(callback_executor, latest_only_coalesces) {
+  CallbackExecutor executor(1u);
+  auto queue = executor.MakeQueue(CallbackPolicy::LatestOnly);
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  std::atomic_int last{-1};
+  // 第一个回调阻塞工作线程，期间入队的回调只保留最后一个。
+  queue->Post([released]() { released.wait(); });
+  ASSERT_TRUE(WaitUntil([&]() { return queue->GetStats().depth == 0u; }));
+  for (auto i = 0; i < 10; ++i) {
+    queue->Post([&, i]() { last = i; });
+  }
+  release.set_value();
+  ASSERT_TRUE(WaitUntil([&]() { return queue->GetStats().executed == 2u; }));
+  const auto stats = queue->GetStats();
+  ASSERT_EQ(last, 9);
+  ASSERT_EQ(stats.coalesced, 9u);
+  ASSERT_EQ(stats.max_depth, 1u);
+}
+
+TEST(callback_executor, slow_queue_does_not_block_others) {
+  CallbackExecutor executor(2u);
+  auto slow = executor.MakeQueue(CallbackPolicy::Serial);
+  auto fast = executor.MakeQueue(CallbackPolicy::Serial, 0u);
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  slow->Post([released]() { released.wait(); });
+  std::atomic_int count{0};
+  for (auto i = 0; i < 100; ++i) {
+    fast->Post([&]() { ++count; });
+  }
+  ASSERT_TRUE(WaitUntil([&]() { return count == 100; }));
+  ASSERT_EQ(slow->GetStats().executed, 0u);
+  release.set_value();
+  ASSERT_TRUE(WaitUntil([&]() { return slow->GetStats().executed == 1u; }));
+  ASSERT_EQ(executor.GetStats().executed, 101u);
+}
+
+TEST(callback_executor, inline_without_workers) {
+  CallbackExecutor executor(0u);
+  auto queue = executor.MakeQueue(CallbackPolicy::LatestOnly);
+  const auto caller = std::this_thread::get_id();
+  std::thread::id callee;
+  queue->Post([&]() { callee = std::this_thread::get_id(); });
+  ASSERT_EQ(callee, caller);
+  // 回调中的异常不会传播到网络线程。
+  queue->Post([]() { throw std::runtime_error("callback failed"); });
+  ASSERT_EQ(queue->GetStats().executed, 2u);
+}
@@ -0,0 +1,119 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "StandInServer.h"
+
+#include <carla/client/ActorBlueprint.h>
+#include <carla/client/BlueprintLibrary.h>
+#include <carla/client/Client.h>
+#include <carla/client/EpisodeStateStream.h>
+#include <carla/client/World.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+
+namespace cc = carla::client;
+namespace cg = carla::geom;
+namespace cr = carla::rpc;
+
+using namespace std::chrono_literals;
+using util::StandInServer;
+
+// 替身服务器的 RPC 端口，与 test_rpc 相同，TESTING_PORT 为 0 时使用固定端口；
+// 流式传输端口由系统选择，客户端从令牌中得到。
+static constexpr uint16_t STANDIN_RPC_PORT = (TESTING_PORT != 0u ? TESTING_PORT : 2310u);
+
+namespace {
+
+  /// 记录过滤后的流最近收到的一帧。
+  class SnapshotReceiver {
+  public:
+
+    void operator()(cc::WorldSnapshot snapshot) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _frame = snapshot.GetFrame();
+      _ids.clear();
+      for (const auto &actor : snapshot) {
+        _ids.insert(actor.id);
+      }
+      _condition.notify_all();
+    }
+
+    std::set<carla::ActorId> WaitForFrame(uint64_t frame) {
+      std::unique_lock<std::mutex> lock(_mutex);
+      const bool received = _condition.wait_for(lock, 10s, [&]() { return _frame >= frame; });
+      EXPECT_TRUE(received) << "timed out waiting for frame " << frame;
+      return _ids;
+    }
+
+  private:
+
+    std::mutex _mutex;
+
+    std::condition_variable _condition;
+
+    uint64_t _frame = 0u;
+
+    std::set<carla::ActorId> _ids;
+  };
+
+} // namespace
+
+TEST(episode_state_stream, filters) {
+  StandInServer::Options options;
+  options.rpc_port = STANDIN_RPC_PORT;
+  StandInServer server(std::move(options));
+  server.Start();
+
+  cc::Client client("localhost", STANDIN_RPC_PORT);
+  client.SetTimeout(10s);
+  auto world = client.GetWorld();
+  auto settings = world.GetSettings();
+  settings.synchronous_mode = true;
+  settings.fixed_delta_seconds = 0.05;
+  world.ApplySettings(settings, 10s);
+
+  // 沿 X 轴每隔 20 米放置一辆车，不施加控制，位置保持不变。
+  auto blueprint = *world.GetBlueprintLibrary()->Find("vehicle.standin.car");
+  std::vector<carla::ActorId> vehicles;
+  for (auto i = 0u; i < 10u; ++i) {
+    const cg::Location location{20.0f * static_cast<float>(i), 0.0f, 0.0f};
+    vehicles.push_back(world.SpawnActor(blueprint, cg::Transform{location})->GetId());
+  }
+
+  auto around = world.MakeEpisodeStateStream(cr::EpisodeStateFilter::AroundActor(vehicles[5u], 45.0f));
+  auto region = world.MakeEpisodeStateStream(cr::EpisodeStateFilter::InsideRegion(
+      cg::BoundingBox{cg::Location{175.0f, 0.0f, 0.0f}, cg::Vector3D{20.0f, 5.0f, 5.0f}}));
+  auto ids = world.MakeEpisodeStateStream(cr::EpisodeStateFilter::FromIds({vehicles[0u], vehicles[9u], 12345u}));
+
+  SnapshotReceiver around_receiver;
+  SnapshotReceiver region_receiver;
+  SnapshotReceiver ids_receiver;
+  around->Listen(std::ref(around_receiver));
+  region->Listen(std::ref(region_receiver));
+  ids->Listen(std::ref(ids_receiver));
+  ASSERT_TRUE(around->IsListening());
+
+  const auto frame = world.Tick(10s);
+  ASSERT_EQ(
+      around_receiver.WaitForFrame(frame),
+      (std::set<carla::ActorId>{vehicles[3u], vehicles[4u], vehicles[5u], vehicles[6u], vehicles[7u]}));
+  ASSERT_EQ(region_receiver.WaitForFrame(frame), (std::set<carla::ActorId>{vehicles[8u], vehicles[9u]}));
+  ASSERT_EQ(ids_receiver.WaitForFrame(frame), (std::set<carla::ActorId>{vehicles[0u], vehicles[9u]}));
+
+  // 完整的仿真状态不受影响。
+  ASSERT_GE(world.GetSnapshot().size(), vehicles.size());
+
+  around->Stop();
+  region->Stop();
+  ASSERT_FALSE(around->IsListening());
+  const auto next_frame = world.Tick(10s);
+  ASSERT_EQ(ids_receiver.WaitForFrame(next_frame).size(), 2u);
+  ids.reset();
+}
@@ -5,12 +5,17 @@
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
 #include "test.h"
+#include "Random.h"
 
+#include <carla/StopWatch.h>
+#include <carla/image/ColorConversionKernels.h>
 #include <carla/image/ImageConverter.h>
 #include <carla/image/ImageIO.h>
 #include <carla/image/ImageView.h>
 
+#include <cstring>
 #include <memory>
+#include <vector>
 
 template <typename ViewT, typename PixelT>
 struct TestImage {
@@ -218,3 +223,104 @@ TEST(image, semantic_segmentation) {
     }
   }
 }
+// 测试批量颜色转换内核与逐像素的 boost::gil 转换结果一致（包括非8对齐的尾部像素与多线程拆分）
+TEST(image, color_conversion_kernels) {
+  using namespace boost::gil;
+  using namespace carla::image;
+  constexpr auto width = 1237u;
+  constexpr auto height = 3u;
+  auto source = MakeTestImage<bgra8_pixel_t>(width, height);
+  for (auto &&pixel : source.view) {
+    for (auto c = 0u; c < 4u; ++c) {
+      pixel[c] = static_cast<uint8_t>(util::Random::Uniform(0.0, 256.0));
+    }
+  }
+  // 把一部分像素的红色通道设为合法的语义标签
+  auto it = source.view.begin();
+  for (auto tag = 0u; tag < width; ++tag, ++it) {
+    get_color(*it, red_t()) = static_cast<uint8_t>(tag % CityScapesPalette::GetNumberOfTags());
+  }
+  auto expected = MakeTestImage<bgra8_pixel_t>(width, height);
+  auto serial = MakeTestImage<bgra8_pixel_t>(width, height);
+  auto parallel = MakeTestImage<bgra8_pixel_t>(width, height);
+  const auto bytes = 4u * width * height;
+  auto raw = [](auto &image) { return reinterpret_cast<uint8_t *>(image.data.get()); };
+
+  auto check = [&](auto converter, auto kernel) {
+    ImageConverter::CopyPixels(source.view, expected.view);
+    ImageConverter::ConvertInPlace<decltype(converter)>(expected.view, converter);
+    std::memcpy(raw(serial), raw(source), bytes);
+    std::memcpy(raw(parallel), raw(source), bytes);
+    kernel(raw(serial), width * height, 1u);
+    kernel(raw(parallel), width * height, 4u);
+    ASSERT_EQ(0, std::memcmp(raw(expected), raw(serial), bytes));
+    ASSERT_EQ(0, std::memcmp(raw(expected), raw(parallel), bytes));
+  };
+
+  check(ColorConverter::Depth(), ColorConversionKernels::Depth);
+  check(ColorConverter::LogarithmicDepth(), ColorConversionKernels::LogarithmicDepth);
+  check(ColorConverter::CityScapesPalette(), ColorConversionKernels::CityScapesPalette);
+
+  // 光流编码：多线程结果与单线程一致，零光流编码为黑色
+  std::vector<float> flow(2u * width * height);
+  for (auto &&value : flow) {
+    value = static_cast<float>(util::Random::Uniform(-2.0, 2.0));
+  }
+  flow[0u] = flow[1u] = 0.0f;
+  ColorConversionKernels::ColorCodedFlow(flow.data(), raw(serial), width * height, 1u);
+  ColorConversionKernels::ColorCodedFlow(flow.data(), raw(parallel), width * height, 4u);
+  ASSERT_EQ(0, std::memcmp(raw(serial), raw(parallel), bytes));
+  ASSERT_EQ(0u, raw(serial)[0u] + raw(serial)[1u] + raw(serial)[2u] + raw(serial)[3u]);
+}
+
+// 对比逐像素转换与批量内核（单线程/多线程）在 1080p 图像上的耗时
+TEST(image, benchmark_color_conversion) {
+#ifndef NDEBUG
+  carla::log_info("This test only happens in release (too slow).");
+#else
+  using namespace boost::gil;
+  using namespace carla::image;
+  constexpr auto width = 1920u;
+  constexpr auto height = 1080u;
+  constexpr auto iterations = 20u;
+  auto source = MakeTestImage<bgra8_pixel_t>(width, height);
+  for (auto &&pixel : source.view) {
+    for (auto c = 0u; c < 4u; ++c) {
+      pixel[c] = static_cast<uint8_t>(util::Random::Uniform(0.0, 256.0));
+    }
+  }
+  auto image = MakeTestImage<bgra8_pixel_t>(width, height);
+  auto *data = reinterpret_cast<uint8_t *>(image.data.get());
+
+  auto benchmark = [&](const char *name, auto converter, auto kernel) {
+    size_t elapsed[3u] = {0u, 0u, 0u};
+    for (auto i = 0u; i < iterations; ++i) {
+      ImageConverter::CopyPixels(source.view, image.view);
+      carla::StopWatch stop_watch;
+      ImageConverter::ConvertInPlace<decltype(converter)>(image.view, converter);
+      stop_watch.Stop();
+      elapsed[0u] += stop_watch.GetElapsedTime<std::chrono::microseconds>();
+
+      ImageConverter::CopyPixels(source.view, image.view);
+      stop_watch.Restart();
+      kernel(data, width * height, 1u);
+      stop_watch.Stop();
+      elapsed[1u] += stop_watch.GetElapsedTime<std::chrono::microseconds>();
+
+      ImageConverter::CopyPixels(source.view, image.view);
+      stop_watch.Restart();
+      kernel(data, width * height, 0u);
+      stop_watch.Stop();
+      elapsed[2u] += stop_watch.GetElapsedTime<std::chrono::microseconds>();
+    }
+    carla::logging::log(
+        name, "(us/frame): per-pixel =", elapsed[0u] / iterations,
+        ", kernel =", elapsed[1u] / iterations,
+        ", kernel multi-threaded =", elapsed[2u] / iterations);
+  };
+
+  benchmark("depth", ColorConverter::Depth(), ColorConversionKernels::Depth);
+  benchmark("logarithmic depth", ColorConverter::LogarithmicDepth(), ColorConversionKernels::LogarithmicDepth);
+  benchmark("cityscapes palette", ColorConverter::CityScapesPalette(), ColorConversionKernels::CityScapesPalette);
+#endif // NDEBUG
+}
@@ -0,0 +1,78 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/ThreadGroup.h>
+#include <carla/nav/PathCache.h>
+
+#include <atomic>
+
+using Cache = carla::nav::PathCache<uint32_t>;
+
+TEST(nav_path_cache, least_recently_used) {
+  Cache cache(2u);
+  Cache::Corridor corridor;
+  ASSERT_FALSE(cache.Get({1u, 2u, 0u}, corridor));
+
+  cache.Put({1u, 2u, 0u}, {1u, 5u, 2u});
+  cache.Put({3u, 4u, 0u}, {3u, 4u});
+  ASSERT_TRUE(cache.Get({1u, 2u, 0u}, corridor));
+  ASSERT_EQ(corridor, (Cache::Corridor{1u, 5u, 2u}));
+  // 过滤器类型不同视为不同的键。
+  ASSERT_FALSE(cache.Get({1u, 2u, 1u}, corridor));
+
+  // {3, 4} 最久未使用，被淘汰。
+  cache.Put({5u, 6u, 0u}, {5u, 6u});
+  ASSERT_EQ(cache.GetSize(), 2u);
+  ASSERT_FALSE(cache.Get({3u, 4u, 0u}, corridor));
+  ASSERT_TRUE(cache.Get({1u, 2u, 0u}, corridor));
+  ASSERT_TRUE(cache.Get({5u, 6u, 0u}, corridor));
+
+  // 更新已有的键不会淘汰其它项。
+  cache.Put({1u, 2u, 0u}, {1u, 2u});
+  ASSERT_EQ(cache.GetSize(), 2u);
+  ASSERT_TRUE(cache.Get({1u, 2u, 0u}, corridor));
+  ASSERT_EQ(corridor, (Cache::Corridor{1u, 2u}));
+  ASSERT_EQ(cache.GetHits(), 4u);
+  ASSERT_EQ(cache.GetMisses(), 3u);
+
+  cache.Clear();
+  ASSERT_EQ(cache.GetSize(), 0u);
+  ASSERT_EQ(cache.GetHits(), 0u);
+}
+
+TEST(nav_path_cache, disabled) {
+  Cache cache(0u);
+  Cache::Corridor corridor;
+  cache.Put({1u, 2u, 0u}, {1u, 2u});
+  ASSERT_EQ(cache.GetSize(), 0u);
+  ASSERT_FALSE(cache.Get({1u, 2u, 0u}, corridor));
+}
+
+TEST(nav_path_cache, concurrent_access) {
+  constexpr uint32_t number_of_keys = 64u;
+  Cache cache(16u);
+  std::atomic<uint32_t> next_thread{0u};
+  {
+    carla::ThreadGroup threads;
+    threads.CreateThreads(4u, [&]() {
+      const uint32_t offset = next_thread++;
+      Cache::Corridor corridor;
+      for (uint32_t i = 0u; i < 10000u; ++i) {
+        const uint32_t start = (i + offset) % number_of_keys;
+        if (cache.Get({start, start + 1u, 0u}, corridor)) {
+          // 命中的走廊必须属于同一个键。
+          ASSERT_EQ(corridor, (Cache::Corridor{start, start + 1u}));
+        } else {
+          cache.Put({start, start + 1u, 0u}, {start, start + 1u});
+        }
+      }
+    });
+  }
+  ASSERT_LE(cache.GetSize(), cache.GetCapacity());
+  ASSERT_EQ(cache.GetHits() + cache.GetMisses(), 40000u);
+}
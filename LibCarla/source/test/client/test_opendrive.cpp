@@ -10,6 +10,8 @@
 
 #include <carla/StopWatch.h> /// @brief 包含CARLA的计时器类，用于性能测量。
 #include <carla/ThreadPool.h>/// @brief 包含CARLA的线程池类，用于并行处理任务。
+#include <carla/client/Map.h>
+#include <carla/client/Waypoint.h>
 #include <carla/geom/Location.h>/// @brief 包含地理位置相关的类，如点、向量等。
 #include <carla/geom/Math.h>/// @brief 包含几何数学运算相关的函数和类。
 #include <carla/opendrive/OpenDriveParser.h>/// @brief 包含OpenDrive解析器类，用于解析OpenDrive格式的地图文件。
@@ -22,6 +24,7 @@
 #include <pugixml/pugixml.hpp>/// @brief 包含pugixml库的头文件，用于XML解析和生成。
 
 #include <fstream>/// @brief 包含C++标准库的文件流类，用于文件读写。
+#include <sstream>
 #include <string>/// @brief 包含C++标准库的字符串类。
 
 using namespace carla::road;/// 导入CARLA的路面相关命名空间，包括道路定义和元素。
@@ -400,6 +403,96 @@ TEST(road, iterate_waypoints) {
   }
 }
 
+TEST(road, rtree_cache) {
+  std::string previous_cache;
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    carla::logging::log("Parsing", file);
+    const auto xodr = util::OpenDrive::Load(file);
+
+    carla::StopWatch stop_watch;
+    auto built = OpenDriveParser::Load(xodr);
+    const auto build_time = stop_watch.GetElapsedTime<std::chrono::microseconds>();
+    ASSERT_TRUE(built.has_value());
+
+    std::stringstream cache;
+    built->SaveRtree(cache);
+
+    stop_watch.Restart();
+    auto loaded = OpenDriveParser::Load(xodr, &cache);
+    const auto load_time = stop_watch.GetElapsedTime<std::chrono::microseconds>();
+    ASSERT_TRUE(loaded.has_value());
+    carla::logging::log(file, "built in", build_time, "us, loaded from cache in", load_time, "us.");
+
+    // 从缓存恢复的 R 树必须给出完全相同的查询结果
+    for (auto i = 0u; i < 1'000u; ++i) {
+      const auto location = Random::Location(-500.0f, 500.0f);
+      auto expected = built->GetClosestWaypointOnRoad(location);
+      auto result = loaded->GetClosestWaypointOnRoad(location);
+      ASSERT_EQ(expected.has_value(), result.has_value());
+      if (expected.has_value()) {
+        ASSERT_EQ(expected->road_id, result->road_id);
+        ASSERT_EQ(expected->section_id, result->section_id);
+        ASSERT_EQ(expected->lane_id, result->lane_id);
+        ASSERT_EQ(expected->s, result->s);
+      }
+    }
+
+    // 截断的缓存与其他地图的缓存都应被拒绝
+    const auto data = cache.str();
+    std::stringstream truncated(data.substr(0u, data.size() / 2u));
+    ASSERT_FALSE(loaded->LoadRtree(truncated));
+    if (!previous_cache.empty()) {
+      std::stringstream other(previous_cache);
+      ASSERT_FALSE(loaded->LoadRtree(other));
+    }
+    previous_cache = data;
+  }
+}
+
+// 只修改几何参数时，旧的 R 树缓存必须失效
+TEST(road, rtree_cache_geometry_change) {
+  const auto files = util::OpenDrive::GetAvailableFiles();
+  ASSERT_FALSE(files.empty());
+  const auto xodr = util::OpenDrive::Load(files.front());
+
+  // 把第一段几何的起点沿 x 方向平移 10 米，道路与车道的数量、长度都不变
+  auto edited = xodr;
+  const auto geometry = edited.find("<geometry");
+  ASSERT_NE(geometry, std::string::npos);
+  const auto begin = edited.find(" x=\"", geometry) + 4u;
+  const auto end = edited.find('"', begin);
+  const auto x = std::stod(edited.substr(begin, end - begin));
+  edited.replace(begin, end - begin, std::to_string(x + 10.0));
+  ASSERT_NE(Map::ComputeRtreeFingerprint(xodr), Map::ComputeRtreeFingerprint(edited));
+
+  auto original = OpenDriveParser::Load(xodr);
+  ASSERT_TRUE(original.has_value());
+  std::stringstream cache;
+  original->SaveRtree(cache);
+  const auto data = cache.str();
+
+  auto expected = OpenDriveParser::Load(edited);
+  ASSERT_TRUE(expected.has_value());
+  std::stringstream stale(data);
+  ASSERT_FALSE(expected->LoadRtree(stale));
+
+  // 传入旧缓存时重新生成 R 树，结果与不使用缓存时一致
+  std::stringstream stale_cache(data);
+  auto result = OpenDriveParser::Load(edited, &stale_cache);
+  ASSERT_TRUE(result.has_value());
+  for (auto i = 0u; i < 1'000u; ++i) {
+    const auto location = Random::Location(-500.0f, 500.0f);
+    auto a = expected->GetClosestWaypointOnRoad(location);
+    auto b = result->GetClosestWaypointOnRoad(location);
+    ASSERT_EQ(a.has_value(), b.has_value());
+    if (a.has_value()) {
+      ASSERT_EQ(a->road_id, b->road_id);
+      ASSERT_EQ(a->lane_id, b->lane_id);
+      ASSERT_EQ(a->s, b->s);
+    }
+  }
+}
+
 TEST(road, get_waypoint) {
   carla::ThreadPool pool;
   pool.AsyncRun();
@@ -446,3 +539,54 @@ TEST(road, get_waypoint) {
     result.get();
   }
 }
+
+TEST(road, waypoint_batch) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    carla::logging::log("Parsing", file);
+    auto map = std::make_shared<carla::client::Map>(file, util::OpenDrive::Load(file));
+    const auto &road_map = map->GetMap();
+
+    // 批量生成的路点与逐个生成的结果一致
+    auto expected = road_map.GenerateWaypoints(2.0);
+    auto batch = map->GenerateWaypointBatch(2.0);
+    ASSERT_EQ(batch.size(), expected.size());
+    ASSERT_EQ(batch.transforms.size(), expected.size());
+    ASSERT_TRUE(batch.source.empty());
+    for (auto i = 0u; i < expected.size(); ++i) {
+      ASSERT_EQ(batch.waypoints[i], expected[i]);
+    }
+    if (batch.empty()) {
+      continue;
+    }
+
+    // 批量 GetNext 按输入顺序展开，source 指回输入下标
+    auto next = map->GetNextBatch(batch.waypoints, 5.0);
+    ASSERT_EQ(next.source.size(), next.size());
+    ASSERT_EQ(next.transforms.size(), next.size());
+    auto k = 0u;
+    for (auto i = 0u; i < batch.size(); ++i) {
+      for (auto &wp : road_map.GetNext(batch.waypoints[i], 5.0)) {
+        ASSERT_LT(k, next.size());
+        ASSERT_EQ(next.source[k], i);
+        ASSERT_EQ(next.waypoints[k], wp);
+        const auto transform = road_map.ComputeTransform(wp);
+        ASSERT_EQ(next.transforms[k].location, transform.location);
+        ++k;
+      }
+    }
+    ASSERT_EQ(k, next.size());
+
+    // 批量查找位置：每个结果都能还原为完整的 Waypoint
+    std::vector<Location> locations;
+    for (auto i = 0u; i < 100u; ++i) {
+      locations.emplace_back(Random::Location(-500.0f, 500.0f));
+    }
+    auto found = map->GetWaypointBatch(locations);
+    ASSERT_EQ(found.size(), locations.size());
+    for (auto i = 0u; i < found.size(); ++i) {
+      auto waypoint = map->GetWaypoint(locations[found.source[i]]);
+      ASSERT_NE(waypoint, nullptr);
+      ASSERT_EQ(map->MakeWaypoint(found.waypoints[i])->GetId(), waypoint->GetId());
+    }
+  }
+}
@@ -0,0 +1,354 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/recorder/BlockCodec.h>
+#include <carla/recorder/Recording.h>
+
+#include <boost/filesystem.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using carla::recorder::BlockCodec;
+using carla::recorder::RecorderFile;
+using carla::recorder::Recording;
+
+namespace fs = boost::filesystem;
+
+// 按服务器端的格式生成录制文件。
+class RecordingBuilder {
+public:
+
+  RecordingBuilder() {
+    Append<uint16_t>(_header, BlockCodec::RAW_FILE_VERSION);
+    AppendString(_header, "CARLA_RECORDER");
+    Append<int64_t>(_header, 1600000000);
+    AppendString(_header, "Town10HD");
+  }
+
+  void BeginFrame(uint64_t id, double elapsed) {
+    // 上一帧的时长由下一帧回填
+    if (_previous_duration_offset != 0u) {
+      const double duration = elapsed - _previous_elapsed;
+      std::memcpy(_frames.data() + _previous_duration_offset, &duration, sizeof(double));
+    }
+    std::vector<char> payload;
+    Append<uint64_t>(payload, id);
+    _previous_duration_offset = _frames.size() + 5u + sizeof(uint64_t);
+    Append<double>(payload, -1.0);
+    Append<double>(payload, elapsed);
+    _previous_elapsed = elapsed;
+    AppendPacket(0u, payload);
+  }
+
+  void EndFrame() {
+    AppendPacket(1u, {});
+  }
+
+  void AddActor(uint32_t id, uint8_t type, const std::string &description) {
+    std::vector<char> payload;
+    Append<uint16_t>(payload, 1u);
+    Append<uint32_t>(payload, id);
+    Append<uint8_t>(payload, type);
+    for (auto i = 0u; i < 6u; ++i) {
+      Append<float>(payload, 0.0f);
+    }
+    Append<uint32_t>(payload, 0u);
+    AppendString(payload, description);
+    Append<uint16_t>(payload, 1u);
+    Append<uint8_t>(payload, 0u);
+    AppendString(payload, "role_name");
+    AppendString(payload, "autopilot");
+    AppendPacket(2u, payload);
+  }
+
+  void DeleteActor(uint32_t id) {
+    std::vector<char> payload;
+    Append<uint16_t>(payload, 1u);
+    Append<uint32_t>(payload, id);
+    AppendPacket(3u, payload);
+  }
+
+  void Collide(uint32_t id1, uint32_t id2, bool hero1) {
+    std::vector<char> payload;
+    Append<uint16_t>(payload, 1u);
+    Append<uint32_t>(payload, 0u);
+    Append<uint32_t>(payload, id1);
+    Append<uint32_t>(payload, id2);
+    Append<bool>(payload, hero1);
+    Append<bool>(payload, false);
+    AppendPacket(5u, payload);
+  }
+
+  void Positions(const std::vector<std::pair<uint32_t, float>> &actors) {
+    std::vector<char> payload;
+    Append<uint16_t>(payload, static_cast<uint16_t>(actors.size()));
+    for (const auto &actor : actors) {
+      Append<uint32_t>(payload, actor.first);
+      Append<float>(payload, actor.second);
+      Append<float>(payload, 2.0f * actor.second);
+      Append<float>(payload, 30.0f);
+      Append<float>(payload, 0.0f);
+      Append<float>(payload, 0.0f);
+      Append<float>(payload, 90.0f);
+    }
+    AppendPacket(6u, payload);
+  }
+
+  void Other() {
+    AppendPacket(20u, std::vector<char>(sizeof(double), 0));
+  }
+
+  void Save(const std::string &path, bool compress, size_t block_size = 4096u) const {
+    std::vector<char> data = _header;
+    if (compress) {
+      data[0u] = static_cast<char>(BlockCodec::COMPRESSED_FILE_VERSION);
+      // 块中只包含完整的帧
+      size_t begin = 0u;
+      for (size_t end : _frame_ends) {
+        if (end - begin >= block_size || end == _frames.size()) {
+          BlockCodec::EncodeBlock(_frames.data() + begin, end - begin, data);
+          begin = end;
+        }
+      }
+    } else {
+      data.insert(data.end(), _frames.begin(), _frames.end());
+    }
+    std::ofstream out(path, std::ios::binary);
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+  }
+
+  void MarkFrameEnd() {
+    _frame_ends.push_back(_frames.size());
+  }
+
+private:
+
+  template <typename T>
+  static void Append(std::vector<char> &out, const T &value) {
+    const auto *begin = reinterpret_cast<const char *>(&value);
+    out.insert(out.end(), begin, begin + sizeof(T));
+  }
+
+  static void AppendString(std::vector<char> &out, const std::string &str) {
+    Append<uint16_t>(out, static_cast<uint16_t>(str.size()));
+    out.insert(out.end(), str.begin(), str.end());
+  }
+
+  void AppendPacket(uint8_t id, const std::vector<char> &payload) {
+    Append<uint8_t>(_frames, id);
+    Append<uint32_t>(_frames, static_cast<uint32_t>(payload.size()));
+    _frames.insert(_frames.end(), payload.begin(), payload.end());
+  }
+
+  std::vector<char> _header;
+
+  std::vector<char> _frames;
+
+  std::vector<size_t> _frame_ends;
+
+  size_t _previous_duration_offset = 0u;
+
+  double _previous_elapsed = 0.0;
+};
+
+// 1000 帧，每帧 0.1 秒：
+//   - 参与者 1（车辆）一直移动；
+//   - 参与者 2（车辆）在 20 秒到 60 秒之间停止；
+//   - 参与者 3（行人）在第 500 帧被销毁；
+//   - 第 100 到 102 帧车辆 1 与 2 碰撞（英雄），第 300 帧车辆 1 与行人 3 碰撞。
+static RecordingBuilder MakeRecording() {
+  RecordingBuilder builder;
+  float position2 = 0.0f;
+  for (uint64_t frame = 0u; frame < 1000u; ++frame) {
+    const double elapsed = 0.1 * static_cast<double>(frame);
+    builder.BeginFrame(frame + 1u, elapsed);
+    builder.Other();
+    if (frame == 0u) {
+      builder.AddActor(1u, 1u, "vehicle.tesla.model3");
+      builder.AddActor(2u, 1u, "vehicle.audi.tt");
+      builder.AddActor(3u, 2u, "walker.pedestrian.0001");
+    }
+    if (frame == 500u) {
+      builder.DeleteActor(3u);
+    }
+    if (frame >= 100u && frame <= 102u) {
+      builder.Collide(1u, 2u, true);
+    }
+    if (frame == 300u) {
+      builder.Collide(1u, 3u, false);
+    }
+    if (frame < 200u || frame >= 600u) {
+      position2 += 50.0f;
+    }
+    std::vector<std::pair<uint32_t, float>> positions = {
+        {1u, 100.0f * static_cast<float>(frame)},
+        {2u, position2}};
+    if (frame < 500u) {
+      positions.emplace_back(3u, static_cast<float>(frame));
+    }
+    builder.Positions(positions);
+    builder.EndFrame();
+    builder.MarkFrameEnd();
+  }
+  return builder;
+}
+
+class recorder_reader : public ::testing::Test {
+protected:
+
+  void SetUp() override {
+    _folder = fs::temp_directory_path() / fs::unique_path("carla-recorder-%%%%-%%%%");
+    fs::create_directories(_folder);
+  }
+
+  void TearDown() override {
+    fs::remove_all(_folder);
+  }
+
+  std::string Path(const std::string &name) const {
+    return (_folder / name).string();
+  }
+
+  fs::path _folder;
+};
+
+TEST_F(recorder_reader, file_index) {
+  const auto path = Path("raw.log");
+  MakeRecording().Save(path, false);
+  RecorderFile file(path);
+  ASSERT_EQ(file.GetInfo().version, BlockCodec::RAW_FILE_VERSION);
+  ASSERT_EQ(file.GetInfo().map, "Town10HD");
+  ASSERT_EQ(file.GetInfo().date, 1600000000);
+  const auto &frames = file.GetFrames();
+  ASSERT_EQ(frames.size(), 1000u);
+  ASSERT_EQ(frames.front().id, 1u);
+  ASSERT_NEAR(frames[10].elapsed, 1.0, 1e-9);
+  ASSERT_NEAR(frames[10].duration, 0.1, 1e-9);
+  ASSERT_EQ(frames.back().duration, 0.0);
+  const auto range = file.FindFrames(10.0, 20.0);
+  ASSERT_EQ(range.first, 100u);
+  ASSERT_EQ(range.second, 201u);
+}
+
+TEST_F(recorder_reader, collisions) {
+  const auto path = Path("raw.log");
+  MakeRecording().Save(path, false);
+  RecorderFile file(path);
+  Recording recording(file);
+  ASSERT_EQ(recording.GetCollisions().size(), 4u);
+  // 连续帧中的同一碰撞只报告一次
+  const auto all = recording.QueryCollisions();
+  ASSERT_EQ(all.size(), 2u);
+  ASSERT_NEAR(all[0].time, 10.0, 1e-9);
+  ASSERT_EQ(all[0].actor1, 1u);
+  ASSERT_EQ(all[0].actor2, 2u);
+  ASSERT_EQ(all[0].description2, "vehicle.audi.tt");
+  ASSERT_EQ(all[1].category2, 'w');
+  ASSERT_EQ(recording.QueryCollisions('v', 'w').size(), 1u);
+  ASSERT_EQ(recording.QueryCollisions('h', 'v').size(), 1u);
+  ASSERT_EQ(recording.QueryCollisions('w', 'a').size(), 0u);
+}
+
+TEST_F(recorder_reader, blocked_and_actors) {
+  const auto path = Path("raw.log");
+  MakeRecording().Save(path, false);
+  RecorderFile file(path);
+  Recording recording(file);
+  const auto &actors = recording.GetActors();
+  ASSERT_EQ(actors.size(), 3u);
+  ASSERT_NEAR(actors.at(3u).destroy_time, 50.0, 1e-9);
+  ASSERT_EQ(actors.at(1u).attributes.size(), 1u);
+  const auto blocked = recording.QueryBlocked(30.0, 10.0);
+  ASSERT_EQ(blocked.size(), 1u);
+  ASSERT_EQ(blocked[0].id, 2u);
+  ASSERT_EQ(blocked[0].description, "vehicle.audi.tt");
+  ASSERT_NEAR(blocked[0].time, 20.0, 1e-6);
+  ASSERT_NEAR(blocked[0].duration, 40.0, 1e-6);
+  // 行人每帧只移动 1 厘米，车辆 2 每帧移动 50 厘米
+  ASSERT_EQ(recording.QueryBlocked(30.0, 1000.0).size(), 2u);
+}
+
+TEST_F(recorder_reader, trajectories_and_time_window) {
+  const auto path = Path("raw.log");
+  MakeRecording().Save(path, false);
+  RecorderFile file(path);
+  Recording recording(file);
+  const auto &trajectory = recording.GetTrajectory(1u);
+  ASSERT_EQ(trajectory.size(), 1000u);
+  ASSERT_EQ(trajectory.x[250], 25000.0f);
+  ASSERT_EQ(trajectory.y[250], 50000.0f);
+  ASSERT_EQ(trajectory.yaw[250], 90.0f);
+  ASSERT_EQ(recording.GetTrajectory(3u).size(), 500u);
+  ASSERT_TRUE(recording.GetTrajectory(42u).empty());
+
+  Recording::Options options;
+  options.begin = 29.95;
+  options.end = 40.0;
+  Recording window(file, options);
+  ASSERT_EQ(window.GetFrameRange().first, 300u);
+  ASSERT_EQ(window.GetFrameRange().second, 401u);
+  ASSERT_EQ(window.GetTrajectory(1u).size(), 101u);
+  ASSERT_EQ(window.GetTrajectory(1u).frame.front(), 300u);
+  ASSERT_EQ(window.GetActors().size(), 3u);
+  const auto collisions = window.QueryCollisions();
+  ASSERT_EQ(collisions.size(), 1u);
+  ASSERT_EQ(collisions[0].category2, 'w');
+}
+
+TEST_F(recorder_reader, parallel_and_compressed_match) {
+  const auto builder = MakeRecording();
+  const auto raw_path = Path("raw.log");
+  const auto compressed_path = Path("compressed.log");
+  builder.Save(raw_path, false);
+  builder.Save(compressed_path, true);
+  ASSERT_LT(fs::file_size(compressed_path), fs::file_size(raw_path));
+
+  RecorderFile raw(raw_path);
+  RecorderFile compressed(compressed_path);
+  ASSERT_EQ(compressed.GetInfo().version, BlockCodec::COMPRESSED_FILE_VERSION);
+  ASSERT_EQ(compressed.GetFrames().size(), raw.GetFrames().size());
+
+  Recording::Options single;
+  single.threads = 1u;
+  Recording::Options parallel;
+  parallel.threads = 7u;
+  const Recording expected(raw, single);
+  for (const auto *file : {&raw, &compressed}) {
+    const Recording recording(*file, parallel);
+    ASSERT_EQ(recording.GetTrajectories().size(), expected.GetTrajectories().size());
+    for (const auto &item : expected.GetTrajectories()) {
+      const auto &trajectory = recording.GetTrajectory(item.first);
+      ASSERT_EQ(trajectory.frame, item.second.frame);
+      ASSERT_EQ(trajectory.x, item.second.x);
+      ASSERT_EQ(trajectory.yaw, item.second.yaw);
+    }
+    ASSERT_EQ(recording.QueryCollisions().size(), expected.QueryCollisions().size());
+    ASSERT_EQ(recording.QueryBlocked(30.0, 1000.0).size(), expected.QueryBlocked(30.0, 1000.0).size());
+  }
+}
+
+TEST_F(recorder_reader, invalid_files) {
+  ASSERT_THROW(RecorderFile(Path("missing.log")), std::runtime_error);
+  const auto path = Path("invalid.log");
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << "this is not a recording";
+  }
+  ASSERT_THROW(RecorderFile file(path), std::runtime_error);
+
+  // 被截断的文件只保留完整的帧
+  const auto truncated = Path("truncated.log");
+  MakeRecording().Save(truncated, false);
+  fs::resize_file(truncated, fs::file_size(truncated) - 10u);
+  RecorderFile file(truncated);
+  ASSERT_EQ(file.GetFrames().size(), 999u);
+}
@@ -0,0 +1,218 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/client/Timestamp.h>
+#include <carla/client/detail/StateHistory.h>
+
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+
+using carla::client::Timestamp;
+using carla::client::detail::FrameArrivalTimes;
+using carla::client::detail::InterpolateTransform;
+using carla::client::detail::StateHistory;
+using carla::geom::Location;
+using carla::geom::Rotation;
+using carla::geom::Transform;
+
+// 只提供 StateHistory 所需接口的简化版 EpisodeState。
+class FakeState {
+public:
+
+  struct Snapshot {
+    Transform transform;
+  };
+
+  FakeState(size_t frame, double elapsed_seconds)
+    : _timestamp(frame, elapsed_seconds, 0.05, 0.0) {}
+
+  size_t GetFrame() const {
+    return _timestamp.frame;
+  }
+
+  const Timestamp &GetTimestamp() const {
+    return _timestamp;
+  }
+
+  boost::optional<Snapshot> GetActorSnapshotIfPresent(carla::ActorId id) const {
+    auto it = _actors.find(id);
+    if (it == _actors.end()) {
+      return boost::none;
+    }
+    return it->second;
+  }
+
+  std::unordered_map<carla::ActorId, Snapshot> _actors;
+
+private:
+
+  const Timestamp _timestamp;
+};
+
+static std::shared_ptr<const FakeState> MakeState(size_t frame, double elapsed_seconds, float x, float yaw) {
+  auto state = std::make_shared<FakeState>(frame, elapsed_seconds);
+  state->_actors[1u].transform = Transform{Location{x, 0.0f, 0.0f}, Rotation{0.0f, yaw, 0.0f}};
+  return state;
+}
+
+TEST(state_history, capacity_is_power_of_two) {
+  ASSERT_EQ(StateHistory<const FakeState>(1u).capacity(), 1u);
+  ASSERT_EQ(StateHistory<const FakeState>(60u).capacity(), 64u);
+  ASSERT_EQ(StateHistory<const FakeState>(64u).capacity(), 64u);
+}
+
+TEST(state_history, lookup_by_frame) {
+  StateHistory<const FakeState> history(8u);
+  ASSERT_EQ(history.GetLatest(), nullptr);
+  ASSERT_EQ(history.GetByFrame(0u), nullptr);
+  for (auto frame = 100u; frame < 120u; ++frame) {
+    history.Push(MakeState(frame, 0.05 * frame, 0.0f, 0.0f));
+  }
+  ASSERT_EQ(history.GetLatest()->GetFrame(), 119u);
+  // 只保留最近 8 帧，更早的帧已被覆盖。
+  for (auto frame = 100u; frame < 112u; ++frame) {
+    ASSERT_EQ(history.GetByFrame(frame), nullptr);
+  }
+  for (auto frame = 112u; frame < 120u; ++frame) {
+    auto state = history.GetByFrame(frame);
+    ASSERT_NE(state, nullptr);
+    ASSERT_EQ(state->GetFrame(), frame);
+  }
+  ASSERT_EQ(history.GetByFrame(120u), nullptr);
+  history.Clear();
+  ASSERT_EQ(history.GetLatest(), nullptr);
+  ASSERT_EQ(history.GetByFrame(119u), nullptr);
+}
+
+TEST(state_history, skipped_frames) {
+  // 异步模式下客户端可能漏掉一些帧。
+  StateHistory<const FakeState> history(4u);
+  history.Push(MakeState(10u, 1.0, 0.0f, 0.0f));
+  history.Push(MakeState(13u, 1.3, 0.0f, 0.0f));
+  history.Push(MakeState(14u, 1.4, 0.0f, 0.0f));
+  ASSERT_NE(history.GetByFrame(13u), nullptr);
+  ASSERT_EQ(history.GetByFrame(11u), nullptr);
+  ASSERT_EQ(history.GetByFrame(10u), nullptr);
+  auto bracket = history.GetBracket(1.35);
+  ASSERT_EQ(bracket.first->GetFrame(), 13u);
+  ASSERT_EQ(bracket.second->GetFrame(), 14u);
+}
+
+TEST(state_history, interpolation) {
+  StateHistory<const FakeState> history(16u);
+  history.Push(MakeState(1u, 1.0, 0.0f, 170.0f));
+  history.Push(MakeState(2u, 2.0, 10.0f, -170.0f));
+  history.Push(MakeState(3u, 3.0, 30.0f, -160.0f));
+
+  auto transform = history.GetActorTransformAt(1u, 1.5);
+  ASSERT_TRUE(transform.has_value());
+  ASSERT_NEAR(transform->location.x, 5.0f, 1e-4f);
+  // 沿最短方向经过 180°，而不是绕回 0°。
+  ASSERT_NEAR(std::fabs(transform->rotation.yaw), 180.0f, 1e-3f);
+
+  transform = history.GetActorTransformAt(1u, 2.25);
+  ASSERT_TRUE(transform.has_value());
+  ASSERT_NEAR(transform->location.x, 15.0f, 1e-4f);
+  ASSERT_NEAR(transform->rotation.yaw, -167.5f, 1e-3f);
+
+  // 恰好落在某一帧上。
+  transform = history.GetActorTransformAt(1u, 3.0);
+  ASSERT_TRUE(transform.has_value());
+  ASSERT_EQ(transform->location.x, 30.0f);
+
+  // 超出历史范围或参与者不存在。
+  ASSERT_FALSE(history.GetActorTransformAt(1u, 0.5).has_value());
+  ASSERT_FALSE(history.GetActorTransformAt(1u, 3.5).has_value());
+  ASSERT_FALSE(history.GetActorTransformAt(2u, 1.5).has_value());
+}
+
+TEST(state_history, interpolate_transform) {
+  const Transform a{Location{0.0f, 0.0f, 0.0f}, Rotation{10.0f, -90.0f, 0.0f}};
+  const Transform b{Location{2.0f, -4.0f, 6.0f}, Rotation{30.0f, 80.0f, 350.0f}};
+  auto t = InterpolateTransform(a, b, 0.5f);
+  ASSERT_EQ(t.location, (Location{1.0f, -2.0f, 3.0f}));
+  ASSERT_NEAR(t.rotation.pitch, 20.0f, 1e-4f);
+  ASSERT_NEAR(t.rotation.yaw, -5.0f, 1e-4f);
+  ASSERT_NEAR(t.rotation.roll, -5.0f, 1e-4f);
+  ASSERT_EQ(InterpolateTransform(a, b, 0.0f).location, a.location);
+  ASSERT_EQ(InterpolateTransform(a, b, 1.0f).location, b.location);
+}
+
+TEST(state_history, concurrent_readers) {
+  constexpr auto number_of_frames = 20'000u;
+  StateHistory<const FakeState> history(32u);
+  std::atomic_bool done{false};
+  std::atomic_size_t errors{0u};
+  std::vector<std::thread> readers;
+  for (auto i = 0u; i < 4u; ++i) {
+    readers.emplace_back([&]() {
+      while (!done) {
+        auto latest = history.GetLatest();
+        if (latest == nullptr) {
+          continue;
+        }
+        const auto frame = latest->GetFrame();
+        for (auto f = frame; f + 16u > frame && f > 0u; --f) {
+          auto state = history.GetByFrame(f);
+          // 读到的状态要么是请求的帧，要么已被覆盖。
+          if (state != nullptr && state->GetFrame() != f) {
+            ++errors;
+          }
+        }
+      }
+    });
+  }
+  for (auto frame = 1u; frame <= number_of_frames; ++frame) {
+    history.Push(MakeState(frame, 0.05 * frame, 0.0f, 0.0f));
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  ASSERT_EQ(errors, 0u);
+  ASSERT_EQ(history.GetLatest()->GetFrame(), number_of_frames);
+}
+
+// 无法计算时返回 -1。
+static int64_t Latency(const FrameArrivalTimes &arrivals, uint64_t frame, uint64_t now) {
+  const auto latency = arrivals.GetLatency(frame, now);
+  return latency.has_value() ? static_cast<int64_t>(*latency) : -1;
+}
+
+TEST(state_history, frame_arrival_times) {
+  FrameArrivalTimes arrivals(4u);
+  // 还没有收到任何状态。
+  ASSERT_EQ(Latency(arrivals, 10u, 1000u), -1);
+
+  arrivals.Record(10u, 1000u);
+  arrivals.Record(11u, 1050u);
+  ASSERT_EQ(Latency(arrivals, 10u, 1200u), 200);
+  ASSERT_EQ(Latency(arrivals, 11u, 1200u), 150);
+  // 以该帧而不是最近一帧的状态为起点。
+  ASSERT_EQ(Latency(arrivals, 10u, 1060u), 60);
+
+  // 传感器数据早于同一帧的状态到达。
+  ASSERT_EQ(Latency(arrivals, 12u, 1060u), 0);
+  arrivals.Record(12u, 1100u);
+  ASSERT_EQ(Latency(arrivals, 12u, 1130u), 30);
+
+  // 跳过的帧与被覆盖的帧都无法计算。
+  arrivals.Record(14u, 1200u);
+  ASSERT_EQ(Latency(arrivals, 13u, 1300u), -1);
+  arrivals.Record(15u, 1250u);
+  ASSERT_EQ(Latency(arrivals, 11u, 1300u), -1);
+  ASSERT_EQ(Latency(arrivals, 15u, 1300u), 50);
+
+  // 切换剧集后帧号从头开始。
+  arrivals.Clear();
+  ASSERT_EQ(Latency(arrivals, 15u, 1300u), -1);
+  arrivals.Record(1u, 2000u);
+  ASSERT_EQ(Latency(arrivals, 1u, 2010u), 10);
+  ASSERT_EQ(Latency(arrivals, 2u, 2010u), 0);
+}
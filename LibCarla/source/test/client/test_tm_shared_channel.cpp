@@ -0,0 +1,170 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/StopWatch.h>
+#include <carla/trafficmanager/SharedControlChannel.h>
+
+#include <atomic>
+#include <thread>
+
+#ifdef __linux__
+#include <sys/stat.h>
+#endif // __linux__
+
+using namespace std::chrono_literals;
+using carla::traffic_manager::MakeParameterUpdate;
+using carla::traffic_manager::ParameterBatch;
+using carla::traffic_manager::SharedControlChannel;
+using carla::traffic_manager::VehicleParameter;
+
+// 模拟 TrafficManagerServer 中的处理线程。
+class ChannelServer {
+public:
+
+  explicit ChannelServer(SharedControlChannel &channel)
+    : _channel(channel),
+      _thread([this, &channel]() {
+        ParameterBatch updates;
+        while (channel.WaitForRequest(updates)) {
+          applied.insert(applied.end(), updates.begin(), updates.end());
+          ++requests;
+          channel.CompleteRequest();
+        }
+      }) {}
+
+  ~ChannelServer() {
+    _channel.Close();
+    Join();
+  }
+
+  void Join() {
+    if (_thread.joinable()) {
+      _thread.join();
+    }
+  }
+
+  ParameterBatch applied;
+
+  std::atomic_size_t requests{0u};
+
+private:
+
+  SharedControlChannel &_channel;
+
+  std::thread _thread;
+};
+
+TEST(tm_shared_channel, open_requires_server) {
+  ASSERT_EQ(SharedControlChannel::Open(TESTING_PORT + 10u), nullptr);
+  auto server = SharedControlChannel::Create(TESTING_PORT + 10u);
+  ASSERT_NE(server, nullptr);
+  ASSERT_NE(SharedControlChannel::Open(TESTING_PORT + 10u), nullptr);
+#ifdef __linux__
+  // 其他用户不能读写控制块。
+  struct stat info;
+  const auto path = "/dev/shm/" + SharedControlChannel::GetSegmentName(TESTING_PORT + 10u);
+  ASSERT_EQ(stat(path.c_str(), &info), 0);
+  ASSERT_EQ(info.st_mode & 0077, 0u);
+#endif // __linux__
+  server->Close();
+  ASSERT_EQ(SharedControlChannel::Open(TESTING_PORT + 10u), nullptr);
+  server.reset();
+  ASSERT_EQ(SharedControlChannel::Open(TESTING_PORT + 10u), nullptr);
+}
+
+TEST(tm_shared_channel, split_updates) {
+  auto server_channel = SharedControlChannel::Create(TESTING_PORT + 11u);
+  ASSERT_NE(server_channel, nullptr);
+  auto client_channel = SharedControlChannel::Open(TESTING_PORT + 11u);
+  ASSERT_NE(client_channel, nullptr);
+
+  // 大于单次请求容量，会被拆成多次请求。
+  ParameterBatch batch;
+  for (auto i = 0u; i < 3u * SharedControlChannel::MAX_UPDATES_PER_REQUEST + 7u; ++i) {
+    batch.push_back(MakeParameterUpdate(i, VehicleParameter::DistanceToLeadingVehicle, static_cast<float>(i)));
+  }
+  ChannelServer server(*server_channel);
+  ASSERT_TRUE(client_channel->SubmitUpdates(batch, 2s));
+  ASSERT_TRUE(client_channel->SubmitUpdates({}, 2s));
+  server_channel->Close();
+  // 关闭后客户端立即失败，调用者退回 RPC。
+  carla::StopWatch watch;
+  ASSERT_FALSE(client_channel->SubmitUpdates(batch, 2s));
+  ASSERT_LT(watch.GetElapsedTime(), 1000u);
+  server.Join();
+  ASSERT_EQ(server.applied.size(), batch.size());
+  ASSERT_EQ(server.requests, 4u);
+}
+
+TEST(tm_shared_channel, applied_in_order) {
+  auto server_channel = SharedControlChannel::Create(TESTING_PORT + 12u);
+  auto client_channel = SharedControlChannel::Open(TESTING_PORT + 12u);
+  ASSERT_NE(client_channel, nullptr);
+  ParameterBatch batch;
+  for (auto i = 0u; i < 10000u; ++i) {
+    batch.push_back(MakeParameterUpdate(i, VehicleParameter::PercentageSpeedDifference, -0.5f * static_cast<float>(i)));
+  }
+  ChannelServer server(*server_channel);
+  ASSERT_TRUE(client_channel->SubmitUpdates(batch, 2s));
+  server_channel->Close();
+  server.Join();
+  ASSERT_EQ(server.applied.size(), batch.size());
+  for (auto i = 0u; i < batch.size(); ++i) {
+    ASSERT_EQ(server.applied[i].actor_id, batch[i].actor_id);
+    ASSERT_EQ(server.applied[i].GetParameter(), VehicleParameter::PercentageSpeedDifference);
+    ASSERT_EQ(server.applied[i].value, batch[i].value);
+  }
+}
+
+TEST(tm_shared_channel, timeout_releases_slot) {
+  auto server_channel = SharedControlChannel::Create(TESTING_PORT + 13u);
+  auto client_channel = SharedControlChannel::Open(TESTING_PORT + 13u);
+  ASSERT_NE(client_channel, nullptr);
+  const ParameterBatch batch = {MakeParameterUpdate(1u, VehicleParameter::AutoLaneChange, 1.0f)};
+  // 没有服务线程：请求超时并被撤回。
+  carla::StopWatch watch;
+  ASSERT_FALSE(client_channel->SubmitUpdates(batch, 50ms));
+  ASSERT_GE(watch.GetElapsedTime(), 40u);
+  {
+    ChannelServer server(*server_channel);
+    ASSERT_TRUE(client_channel->SubmitUpdates(batch, 2s));
+    server_channel->Close();
+    server.Join();
+    ASSERT_EQ(server.requests, 1u);
+    ASSERT_EQ(server.applied.size(), 1u);
+  }
+}
+
+TEST(tm_shared_channel, concurrent_clients) {
+  auto server_channel = SharedControlChannel::Create(TESTING_PORT + 14u);
+  ASSERT_NE(server_channel, nullptr);
+  ChannelServer server(*server_channel);
+  constexpr auto number_of_clients = 4u;
+  constexpr auto requests_per_client = 200u;
+  std::atomic_size_t failures{0u};
+  std::vector<std::thread> clients;
+  for (auto i = 0u; i < number_of_clients; ++i) {
+    clients.emplace_back([&, i]() {
+      auto channel = SharedControlChannel::Open(TESTING_PORT + 14u);
+      for (auto j = 0u; j < requests_per_client; ++j) {
+        const ParameterBatch batch = {MakeParameterUpdate(i, VehicleParameter::PercentageSpeedDifference, static_cast<float>(j))};
+        if (channel == nullptr || !channel->SubmitUpdates(batch, 2s)) {
+          ++failures;
+        }
+      }
+    });
+  }
+  for (auto &client : clients) {
+    client.join();
+  }
+  server_channel->Close();
+  server.Join();
+  ASSERT_EQ(failures, 0u);
+  ASSERT_EQ(server.requests, number_of_clients * requests_per_client);
+  ASSERT_EQ(server.applied.size(), number_of_clients * requests_per_client);
+}
@@ -0,0 +1,104 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/rpc/VehicleLightState.h>
+#include <carla/rpc/WeatherParameters.h>
+#include <carla/trafficmanager/Constants.h>
+#include <carla/trafficmanager/VehicleLightStage.h>
+
+using carla::rpc::WeatherParameters;
+using carla::traffic_manager::VehicleLightStage;
+using LightState = carla::rpc::VehicleLightState::LightState;
+using flag_type = carla::rpc::VehicleLightState::flag_type;
+
+namespace constants = carla::traffic_manager::constants::VehicleLight;
+
+static flag_type Flag(LightState state) {
+  return static_cast<flag_type>(state);
+}
+
+static const flag_type POSITION = Flag(LightState::Position);
+static const flag_type LOW_BEAM = POSITION | Flag(LightState::LowBeam);
+static const flag_type FOG = LOW_BEAM | Flag(LightState::Fog);
+
+// 晴朗的正午，不需要任何灯光。
+static WeatherParameters ClearNoon() {
+  WeatherParameters weather;
+  weather.sun_altitude_angle = 90.0f;
+  weather.precipitation = 0.0f;
+  weather.fog_density = 0.0f;
+  return weather;
+}
+
+static flag_type WeatherLightsAtSunAltitude(float altitude) {
+  auto weather = ClearNoon();
+  weather.sun_altitude_angle = altitude;
+  return VehicleLightStage::ComputeWeatherLights(weather);
+}
+
+TEST(vehicle_light_stage, day_and_night) {
+  ASSERT_EQ(VehicleLightStage::ComputeWeatherLights(ClearNoon()), 0u);
+
+  // 夜间：黎明之前与日落之后开启近光灯。
+  ASSERT_EQ(WeatherLightsAtSunAltitude(-30.0f), LOW_BEAM);
+  ASSERT_EQ(WeatherLightsAtSunAltitude(constants::SUN_ALTITUDE_DEGREES_BEFORE_DAWN - 0.1f), LOW_BEAM);
+  ASSERT_EQ(WeatherLightsAtSunAltitude(constants::SUN_ALTITUDE_DEGREES_AFTER_SUNSET + 0.1f), LOW_BEAM);
+
+  // 黄昏：只开位置灯，阈值本身属于较亮的一侧。
+  ASSERT_EQ(WeatherLightsAtSunAltitude(constants::SUN_ALTITUDE_DEGREES_BEFORE_DAWN), POSITION);
+  ASSERT_EQ(WeatherLightsAtSunAltitude(constants::SUN_ALTITUDE_DEGREES_JUST_AFTER_DAWN - 0.1f), POSITION);
+  ASSERT_EQ(WeatherLightsAtSunAltitude(constants::SUN_ALTITUDE_DEGREES_JUST_BEFORE_SUNSET + 0.1f), POSITION);
+  ASSERT_EQ(WeatherLightsAtSunAltitude(constants::SUN_ALTITUDE_DEGREES_AFTER_SUNSET), POSITION);
+
+  // 白天。
+  ASSERT_EQ(WeatherLightsAtSunAltitude(constants::SUN_ALTITUDE_DEGREES_JUST_AFTER_DAWN), 0u);
+  ASSERT_EQ(WeatherLightsAtSunAltitude(constants::SUN_ALTITUDE_DEGREES_JUST_BEFORE_SUNSET), 0u);
+}
+
+TEST(vehicle_light_stage, weather_thresholds) {
+  auto weather = ClearNoon();
+  weather.precipitation = constants::HEAVY_PRECIPITATION_THRESHOLD;
+  ASSERT_EQ(VehicleLightStage::ComputeWeatherLights(weather), 0u);
+  weather.precipitation = constants::HEAVY_PRECIPITATION_THRESHOLD + 0.1f;
+  ASSERT_EQ(VehicleLightStage::ComputeWeatherLights(weather), LOW_BEAM);
+
+  weather = ClearNoon();
+  weather.fog_density = constants::FOG_DENSITY_THRESHOLD;
+  ASSERT_EQ(VehicleLightStage::ComputeWeatherLights(weather), 0u);
+  weather.fog_density = constants::FOG_DENSITY_THRESHOLD + 0.1f;
+  ASSERT_EQ(VehicleLightStage::ComputeWeatherLights(weather), FOG);
+
+  // 各项条件叠加。
+  weather.precipitation = 100.0f;
+  weather.sun_altitude_angle = -10.0f;
+  ASSERT_EQ(VehicleLightStage::ComputeWeatherLights(weather), FOG);
+  weather.fog_density = 0.0f;
+  weather.sun_altitude_angle = constants::SUN_ALTITUDE_DEGREES_BEFORE_DAWN;
+  ASSERT_EQ(VehicleLightStage::ComputeWeatherLights(weather), LOW_BEAM);
+}
+
+TEST(vehicle_light_stage, light_state) {
+  const flag_type none = 0u;
+  ASSERT_EQ(VehicleLightStage::ComputeLightState(none, none, false, false, false), none);
+  ASSERT_EQ(VehicleLightStage::ComputeLightState(none, LOW_BEAM, true, false, false),
+            LOW_BEAM | Flag(LightState::Brake));
+  ASSERT_EQ(VehicleLightStage::ComputeLightState(none, none, false, true, false),
+            Flag(LightState::LeftBlinker));
+  ASSERT_EQ(VehicleLightStage::ComputeLightState(none, none, false, false, true),
+            Flag(LightState::RightBlinker));
+
+  // 本阶段管理的灯光按输入重新计算，其他灯光（倒车灯、内饰灯）保持不变。
+  const flag_type current =
+      Flag(LightState::Brake) | Flag(LightState::HighBeam) | Flag(LightState::LeftBlinker) |
+      Flag(LightState::Reverse) | Flag(LightState::Interior);
+  ASSERT_EQ(VehicleLightStage::ComputeLightState(current, POSITION, false, false, true),
+            POSITION | Flag(LightState::RightBlinker) | Flag(LightState::Reverse) | Flag(LightState::Interior));
+
+  // 天气灯光中不受管理的位不会被写入。
+  ASSERT_EQ(VehicleLightStage::ComputeLightState(none, FOG | Flag(LightState::Special1), false, false, false), FOG);
+}
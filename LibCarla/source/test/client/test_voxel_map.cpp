@@ -0,0 +1,283 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "Random.h"
+
+#include <carla/StopWatch.h>
+#include <carla/pointcloud/VoxelMap.h>
+#include <carla/sensor/data/LidarData.h>
+#include <carla/sensor/data/SemanticLidarData.h>
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+using carla::geom::Location;
+using carla::geom::Rotation;
+using carla::geom::Transform;
+using carla::pointcloud::PointBuffer;
+using carla::pointcloud::VoxelMap;
+using carla::pointcloud::VoxelPoint;
+using carla::sensor::data::LidarDetection;
+using carla::sensor::data::SemanticLidarDetection;
+
+static PointBuffer MakeBuffer(const std::vector<LidarDetection> &points) {
+  PointBuffer buffer;
+  buffer.data = reinterpret_cast<const unsigned char *>(points.data());
+  buffer.count = points.size();
+  buffer.stride = sizeof(LidarDetection);
+  buffer.intensity_offset = offsetof(LidarDetection, intensity);
+  return buffer;
+}
+
+static PointBuffer MakeBuffer(const std::vector<SemanticLidarDetection> &points) {
+  PointBuffer buffer;
+  buffer.data = reinterpret_cast<const unsigned char *>(points.data());
+  buffer.count = points.size();
+  buffer.stride = sizeof(SemanticLidarDetection);
+  buffer.intensity_offset = offsetof(SemanticLidarDetection, cos_inc_angle);
+  buffer.tag_offset = offsetof(SemanticLidarDetection, object_tag);
+  return buffer;
+}
+
+static std::vector<LidarDetection> MakeSweep(size_t count, float extent) {
+  std::vector<LidarDetection> points;
+  points.reserve(count);
+  for (auto i = 0u; i < count; ++i) {
+    points.emplace_back(util::Random::Location(-extent, extent), static_cast<float>(util::Random::Uniform(0.0, 1.0)));
+  }
+  return points;
+}
+
+// 传感器坐标系下的一次扫描：地面（传感器下方 1.8 米）与两侧的墙面。
+static std::vector<LidarDetection> MakeStreetSweep(size_t count) {
+  std::vector<LidarDetection> points;
+  points.reserve(count);
+  for (auto i = 0u; i < count; ++i) {
+    const auto x = static_cast<float>(util::Random::Uniform(-50.0, 50.0));
+    const auto u = static_cast<float>(util::Random::Uniform(0.0, 1.0));
+    if (i % 2u == 0u) {
+      points.emplace_back(x, 20.0f * u - 10.0f, -1.8f, 0.8f);
+    } else {
+      points.emplace_back(x, (i % 4u == 1u) ? -10.0f : 10.0f, 8.0f * u - 1.8f, 0.6f);
+    }
+  }
+  return points;
+}
+
+static const VoxelPoint *FindVoxel(const std::vector<VoxelPoint> &points, float x, float y, float z) {
+  for (const auto &point : points) {
+    if (std::abs(point.x - x) < 1e-4f && std::abs(point.y - y) < 1e-4f && std::abs(point.z - z) < 1e-4f) {
+      return &point;
+    }
+  }
+  return nullptr;
+}
+
+TEST(voxel_map, centroid_intensity_and_tag) {
+  VoxelMap::Options options;
+  options.voxel_size = 1.0f;
+  VoxelMap map(options);
+  const std::vector<SemanticLidarDetection> points = {
+      {0.2f, 0.2f, 0.2f, 0.1f, 0u, 7u},
+      {0.4f, 0.6f, 0.8f, 0.3f, 0u, 7u},
+      {0.6f, 0.4f, 0.2f, 0.5f, 0u, 4u},
+      {1.5f, 0.5f, 0.5f, 1.0f, 0u, 9u},
+      // 负坐标向下取整到 -1。
+      {-0.5f, 0.5f, 0.5f, 1.0f, 0u, 2u}};
+  map.AddPoints(MakeBuffer(points), Transform{}, 0.0);
+  ASSERT_EQ(map.GetVoxelCount(), 3u);
+
+  const auto cloud = map.GetCloud();
+  ASSERT_EQ(cloud->points.size(), 3u);
+  const auto *voxel = FindVoxel(cloud->points, 0.4f, 0.4f, 0.4f);
+  ASSERT_NE(voxel, nullptr);
+  ASSERT_EQ(voxel->count, 3u);
+  ASSERT_NEAR(voxel->intensity, 0.3f, 1e-6f);
+  ASSERT_EQ(voxel->tag, 7u);
+  voxel = FindVoxel(cloud->points, -0.5f, 0.5f, 0.5f);
+  ASSERT_NE(voxel, nullptr);
+  ASSERT_EQ(voxel->tag, 2u);
+
+  // 超过 4 种标签时仍然得到多数标签。
+  std::vector<SemanticLidarDetection> mixed;
+  for (auto tag : {1u, 2u, 3u, 4u, 5u, 6u, 10u, 10u, 10u, 10u, 10u, 10u}) {
+    mixed.emplace_back(5.5f, 5.5f, 5.5f, 0.0f, 0u, tag);
+  }
+  map.AddPoints(MakeBuffer(mixed), Transform{}, 0.0);
+  voxel = FindVoxel(map.GetCloud()->points, 5.5f, 5.5f, 5.5f);
+  ASSERT_NE(voxel, nullptr);
+  ASSERT_EQ(voxel->tag, 10u);
+  ASSERT_EQ(voxel->count, 12u);
+}
+
+TEST(voxel_map, sensor_transform) {
+  VoxelMap map;
+  const Transform transform{Location{100.0f, -50.0f, 2.0f}, Rotation{0.0f, 90.0f, 0.0f}};
+  const std::vector<LidarDetection> points = {{10.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, -1.0f, 1.0f}};
+  map.AddPoints(MakeBuffer(points), transform, 0.0);
+  const auto cloud = map.GetCloud();
+  ASSERT_EQ(cloud->points.size(), 2u);
+  for (const auto &point : points) {
+    Location expected = point.point;
+    transform.TransformPoint(expected);
+    ASSERT_NE(FindVoxel(cloud->points, expected.x, expected.y, expected.z), nullptr);
+  }
+}
+
+TEST(voxel_map, snapshots) {
+  VoxelMap map;
+  const auto points = MakeSweep(1000u, 10.0f);
+  map.AddPoints(MakeBuffer(points), Transform{}, 0.0);
+  const auto cloud = map.GetCloud();
+  ASSERT_EQ(cloud, map.GetCloud());
+  const auto size = cloud->points.size();
+
+  // 之后的修改不影响已取得的快照。
+  map.AddPoints(MakeBuffer(MakeSweep(1000u, 10.0f)), Transform{Location{50.0f, 0.0f, 0.0f}}, 0.1);
+  ASSERT_NE(cloud, map.GetCloud());
+  ASSERT_EQ(cloud->points.size(), size);
+  ASSERT_GT(map.GetCloud()->points.size(), size);
+
+  map.Clear();
+  ASSERT_EQ(map.GetVoxelCount(), 0u);
+  ASSERT_TRUE(map.GetCloud()->points.empty());
+}
+
+TEST(voxel_map, sliding_window) {
+  VoxelMap::Options options;
+  options.voxel_size = 0.5f;
+  options.max_age = 1.0;
+  VoxelMap by_age(options);
+  const std::vector<LidarDetection> first = {{0.1f, 0.1f, 0.1f, 1.0f}, {5.1f, 0.1f, 0.1f, 1.0f}};
+  const std::vector<LidarDetection> second = {{5.2f, 0.2f, 0.2f, 1.0f}};
+  by_age.AddPoints(MakeBuffer(first), Transform{}, 10.0);
+  by_age.AddPoints(MakeBuffer(second), Transform{}, 10.5);
+  ASSERT_EQ(by_age.GetVoxelCount(), 2u);
+  // 第一个体素最后一次更新在 10.0，第二个在 10.5。
+  by_age.AddPoints(MakeBuffer(std::vector<LidarDetection>{}), Transform{}, 11.2);
+  ASSERT_EQ(by_age.GetVoxelCount(), 1u);
+  ASSERT_EQ(by_age.GetCloud()->points[0u].count, 2u);
+
+  options.max_age = 0.0;
+  options.max_distance = 20.0f;
+  VoxelMap by_distance(options);
+  by_distance.AddPoints(MakeBuffer(MakeSweep(500u, 5.0f)), Transform{}, 0.0);
+  const auto near_count = by_distance.GetVoxelCount();
+  // 传感器向前移动 30 米后，原来的体素都超出范围。
+  const Transform moved{Location{30.0f, 0.0f, 0.0f}};
+  by_distance.AddPoints(MakeBuffer(MakeSweep(500u, 5.0f)), moved, 0.1);
+  for (const auto &point : by_distance.GetCloud()->points) {
+    ASSERT_LT(Location(point.x, point.y, point.z).Distance(moved.location), 20.0f);
+  }
+  ASSERT_LE(by_distance.GetVoxelCount(), near_count + 500u);
+}
+
+TEST(voxel_map, deterministic_across_threads) {
+  const auto first = MakeSweep(50000u, 30.0f);
+  const auto second = MakeSweep(50000u, 30.0f);
+  const Transform transform{Location{3.0f, 1.0f, 0.5f}, Rotation{0.0f, 10.0f, 0.0f}};
+
+  std::vector<VoxelPoint> reference;
+  for (size_t threads : {1u, 3u, 8u, 0u}) {
+    VoxelMap::Options options;
+    options.voxel_size = 0.5f;
+    options.threads = threads;
+    VoxelMap map(options);
+    map.AddPoints(MakeBuffer(first), Transform{}, 0.0);
+    map.AddPoints(MakeBuffer(second), transform, 0.1);
+    const auto cloud = map.GetCloud();
+    if (reference.empty()) {
+      reference = cloud->points;
+      continue;
+    }
+    ASSERT_EQ(cloud->points.size(), reference.size());
+    ASSERT_EQ(std::memcmp(cloud->points.data(), reference.data(), sizeof(VoxelPoint) * reference.size()), 0);
+  }
+}
+
+TEST(voxel_map, concurrent_callers) {
+  constexpr auto sensors = 4u;
+  constexpr auto sweeps = 10u;
+  std::vector<std::vector<LidarDetection>> data;
+  for (auto i = 0u; i < sensors; ++i) {
+    data.emplace_back(MakeSweep(5000u, 20.0f));
+  }
+
+  VoxelMap::Options options;
+  options.voxel_size = 0.5f;
+  VoxelMap reference(options);
+  for (auto i = 0u; i < sensors; ++i) {
+    for (auto j = 0u; j < sweeps; ++j) {
+      reference.AddPoints(MakeBuffer(data[i]), Transform{}, 0.0);
+    }
+  }
+
+  // 多个传感器回调同时写入，另一个线程不断读取快照。
+  VoxelMap map(options);
+  std::atomic_bool done{false};
+  std::thread reader([&]() {
+    while (!done) {
+      const auto cloud = map.GetCloud();
+      ASSERT_LE(cloud->points.size(), reference.GetVoxelCount());
+      ASSERT_LE(map.GetVoxelCount(), reference.GetVoxelCount());
+    }
+  });
+  std::vector<std::thread> writers;
+  for (auto i = 0u; i < sensors; ++i) {
+    writers.emplace_back([&, i]() {
+      for (auto j = 0u; j < sweeps; ++j) {
+        map.AddPoints(MakeBuffer(data[i]), Transform{}, 0.0);
+      }
+    });
+  }
+  for (auto &writer : writers) {
+    writer.join();
+  }
+  done = true;
+  reader.join();
+
+  const auto cloud = map.GetCloud();
+  ASSERT_EQ(cloud->points.size(), reference.GetVoxelCount());
+  size_t count = 0u;
+  for (const auto &point : cloud->points) {
+    count += point.count;
+  }
+  ASSERT_EQ(count, sensors * sweeps * 5000u);
+}
+
+TEST(voxel_map, benchmark) {
+  constexpr auto sweeps = 20u;
+  constexpr auto points_per_sweep = 100000u;
+  std::vector<std::vector<LidarDetection>> data;
+  std::vector<Transform> transforms;
+  for (auto i = 0u; i < sweeps; ++i) {
+    data.emplace_back(MakeStreetSweep(points_per_sweep));
+    transforms.emplace_back(Location{static_cast<float>(i), 0.0f, 0.0f});
+  }
+
+  size_t voxels = 0u;
+  std::array<size_t, 2u> elapsed;
+  for (size_t threads : {1u, 0u}) {
+    VoxelMap::Options options;
+    options.voxel_size = 0.2f;
+    options.max_distance = 60.0f;
+    options.threads = threads;
+    VoxelMap map(options);
+    carla::StopWatch watch;
+    for (auto i = 0u; i < sweeps; ++i) {
+      map.AddPoints(MakeBuffer(data[i]), transforms[i], 0.05 * i);
+    }
+    voxels = map.GetCloud()->points.size();
+    watch.Stop();
+    elapsed[threads == 1u ? 0u : 1u] = watch.GetElapsedTime<std::chrono::microseconds>();
+  }
+  ASSERT_GT(voxels, 0u);
+  carla::logging::log(
+      "voxel map over", sweeps, "sweeps of", points_per_sweep, "points (us/sweep): one thread",
+      elapsed[0u] / sweeps, "threads", elapsed[1u] / sweeps, "voxels", voxels);
+}
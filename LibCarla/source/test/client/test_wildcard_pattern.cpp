@@ -0,0 +1,91 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/StringUtil.h>
+#include <carla/WildcardPattern.h>
+
+#include <string>
+#include <vector>
+
+using carla::StringUtil;
+using carla::WildcardPattern;
+
+static const std::vector<std::string> TYPE_IDS = {
+  "",
+  "vehicle",
+  "vehicle.",
+  "vehicle.tesla.model3",
+  "vehicle.audi.a2",
+  "vehicle.carlamotors.firetruck",
+  "walker.pedestrian.0001",
+  "walker.pedestrian.0042",
+  "traffic.traffic_light",
+  "traffic.stop",
+  "sensor.camera.rgb",
+  "sensor.other.collision",
+  "spectator",
+  "static.prop.trafficcone01",
+  "aaa",
+  "abab",
+};
+
+static const std::vector<std::string> PATTERNS = {
+  "",
+  "*",
+  "**",
+  "vehicle",
+  "vehicle.*",
+  "vehicle.*.*",
+  "vehicle.t*",
+  "*traffic_light*",
+  "*traffic*",
+  "*.rgb",
+  "*0042",
+  "walker.pedestrian.00??",
+  "walker.*.0001",
+  "*.*.*",
+  "?",
+  "??",
+  "a*a",
+  "a*b*",
+  "*a*b",
+  "ab*ab",
+  "*ab*ab*",
+  "s*r.*.c*n",
+  "vehicle.[at]*",
+  "walker.pedestrian.000[0-9]",
+  "traffic.\\*",
+};
+
+TEST(wildcard_pattern, same_results_as_string_util) {
+  for (const auto &pattern : PATTERNS) {
+    const WildcardPattern compiled(pattern);
+    for (const auto &type_id : TYPE_IDS) {
+      EXPECT_EQ(compiled.Match(type_id), StringUtil::Match(type_id, pattern))
+          << "pattern '" << pattern << "' type id '" << type_id << "'";
+    }
+  }
+}
+
+TEST(wildcard_pattern, literal_prefix) {
+  ASSERT_EQ(WildcardPattern("vehicle.*").GetLiteralPrefix(), "vehicle.");
+  ASSERT_EQ(WildcardPattern("walker.pedestrian.00??").GetLiteralPrefix(), "walker.pedestrian.00");
+  ASSERT_EQ(WildcardPattern("*traffic_light*").GetLiteralPrefix(), "");
+  ASSERT_EQ(WildcardPattern("vehicle.[at]*").GetLiteralPrefix(), "vehicle.");
+  ASSERT_TRUE(WildcardPattern("spectator").IsLiteral());
+  ASSERT_FALSE(WildcardPattern("spectator*").IsLiteral());
+}
+
+TEST(wildcard_pattern, compile_is_cached) {
+  const auto a = WildcardPattern::Compile("vehicle.*");
+  const auto b = WildcardPattern::Compile("vehicle.*");
+  const auto c = WildcardPattern::Compile("walker.*");
+  ASSERT_EQ(a.get(), b.get());
+  ASSERT_NE(a.get(), c.get());
+  ASSERT_EQ(a->GetPattern(), "vehicle.*");
+}
@@ -0,0 +1,217 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "Random.h"
+
+#include <carla/geom/BoundingBox.h>
+#include <carla/geom/Math.h>
+#include <carla/rpc/EpisodeStateFilter.h>
+#include <carla/sensor/s11n/EpisodeStateIndex.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+using carla::sensor::data::ActorDynamicState;
+using carla::sensor::s11n::EpisodeStateIndex;
+using carla::sensor::s11n::EpisodeStateSerializer;
+
+namespace cg = carla::geom;
+namespace cr = carla::rpc;
+
+static std::vector<ActorDynamicState> MakeStates(size_t count, float range) {
+  std::vector<ActorDynamicState> states(count, ActorDynamicState{});
+  for (auto i = 0u; i < count; ++i) {
+    states[i].id = static_cast<carla::ActorId>(100u + i);
+    states[i].transform = cg::Transform{util::Random::Location(-range, range)};
+  }
+  return states;
+}
+
+// 不使用索引，逐个检查所有参与者。
+static std::vector<uint32_t> SelectBruteForce(
+    const std::vector<ActorDynamicState> &states,
+    const cr::EpisodeStateFilter &filter) {
+  bool has_center = false;
+  cg::Location center;
+  for (const auto &state : states) {
+    const carla::ActorId id = state.id;
+    if (filter.HasRadius() && id == filter.actor_id) {
+      has_center = true;
+      center = cg::Location{state.transform.location};
+    }
+  }
+  const cg::Transform region_to_world{filter.region.location, filter.region.rotation};
+  const cg::BoundingBox box{filter.region.extent};
+  std::vector<uint32_t> result;
+  for (uint32_t i = 0u; i < states.size(); ++i) {
+    const cg::Location location = states[i].transform.location;
+    const bool in_radius = has_center &&
+        cg::Math::DistanceSquared(location, center) <= filter.radius * filter.radius;
+    const bool in_region = filter.use_region && box.Contains(location, region_to_world);
+    const carla::ActorId id = states[i].id;
+    const bool in_ids = std::find(filter.actor_ids.begin(), filter.actor_ids.end(), id) != filter.actor_ids.end();
+    if (in_radius || in_region || in_ids) {
+      result.push_back(i);
+    }
+  }
+  return result;
+}
+
+TEST(episode_state_index, empty) {
+  EpisodeStateIndex index;
+  index.Reset(nullptr, 0u);
+  std::vector<uint32_t> selected{1u, 2u};
+  index.Select(cr::EpisodeStateFilter::AroundActor(1u, 100.0f), selected);
+  ASSERT_TRUE(selected.empty());
+
+  auto states = MakeStates(10u, 100.0f);
+  index.Reset(states.data(), states.size());
+  index.Select(cr::EpisodeStateFilter{}, selected);
+  ASSERT_TRUE(selected.empty());
+  ASSERT_TRUE(cr::EpisodeStateFilter{}.IsEmpty());
+}
+
+TEST(episode_state_index, radius) {
+  std::vector<ActorDynamicState> states(4u, ActorDynamicState{});
+  const cg::Location locations[] = {{0.0f, 0.0f, 0.0f}, {30.0f, 0.0f, 0.0f}, {0.0f, -49.0f, 0.0f}, {-45.0f, 30.0f, 0.0f}};
+  for (auto i = 0u; i < states.size(); ++i) {
+    states[i].id = i + 1u;
+    states[i].transform = cg::Transform{locations[i]};
+  }
+  EpisodeStateIndex index(10.0f);
+  index.Reset(states.data(), states.size());
+  std::vector<uint32_t> selected;
+
+  index.Select(cr::EpisodeStateFilter::AroundActor(1u, 50.0f), selected);
+  ASSERT_EQ(selected, (std::vector<uint32_t>{0u, 1u, 2u}));
+
+  index.Select(cr::EpisodeStateFilter::AroundActor(2u, 31.0f), selected);
+  ASSERT_EQ(selected, (std::vector<uint32_t>{0u, 1u}));
+
+  // 参与者不存在时没有中心，只有 id 列表中的参与者。
+  auto filter = cr::EpisodeStateFilter::AroundActor(42u, 1000.0f);
+  filter.actor_ids = {4u, 4u, 99u};
+  index.Select(filter, selected);
+  ASSERT_EQ(selected, (std::vector<uint32_t>{3u}));
+}
+
+TEST(episode_state_index, region) {
+  std::vector<ActorDynamicState> states(3u, ActorDynamicState{});
+  const cg::Location locations[] = {{10.0f, 10.0f, 0.0f}, {10.0f, -10.0f, 0.0f}, {10.0f, 10.0f, 20.0f}};
+  for (auto i = 0u; i < states.size(); ++i) {
+    states[i].id = i + 1u;
+    states[i].transform = cg::Transform{locations[i]};
+  }
+  EpisodeStateIndex index(5.0f);
+  index.Reset(states.data(), states.size());
+  std::vector<uint32_t> selected;
+
+  // 绕 Z 轴旋转 45 度、沿 X 方向细长的区域只包含 (10, 10)。
+  cg::BoundingBox region{cg::Location{0.0f, 0.0f, 0.0f}, cg::Vector3D{20.0f, 2.0f, 5.0f}, cg::Rotation{0.0f, 45.0f, 0.0f}};
+  index.Select(cr::EpisodeStateFilter::InsideRegion(region), selected);
+  ASSERT_EQ(selected, (std::vector<uint32_t>{0u}));
+
+  region.rotation.yaw = -45.0f;
+  index.Select(cr::EpisodeStateFilter::InsideRegion(region), selected);
+  ASSERT_EQ(selected, (std::vector<uint32_t>{1u}));
+}
+
+TEST(episode_state_index, unbounded_range) {
+  const float inf = std::numeric_limits<float>::infinity();
+  const float max = std::numeric_limits<float>::max();
+  auto states = MakeStates(100u, 1000.0f);
+  EpisodeStateIndex index;
+  index.Reset(states.data(), states.size());
+  std::vector<uint32_t> selected;
+
+  // 网格下标饱和到 int32 的边界，不能逐个遍历范围内的网格。
+  index.Select(cr::EpisodeStateFilter::AroundActor(100u, inf), selected);
+  ASSERT_EQ(selected.size(), states.size());
+  index.Select(cr::EpisodeStateFilter::AroundActor(100u, max), selected);
+  ASSERT_EQ(selected.size(), states.size());
+  cg::BoundingBox region{cg::Vector3D{max, max, max}};
+  index.Select(cr::EpisodeStateFilter::InsideRegion(region), selected);
+  ASSERT_EQ(selected, SelectBruteForce(states, cr::EpisodeStateFilter::InsideRegion(region)));
+
+  // 服务器拒绝非有限值与负值。
+  ASSERT_TRUE(cr::EpisodeStateFilter::AroundActor(100u, 50.0f).IsValid());
+  ASSERT_TRUE(cr::EpisodeStateFilter::InsideRegion(region).IsValid());
+  ASSERT_FALSE(cr::EpisodeStateFilter::AroundActor(100u, inf).IsValid());
+  ASSERT_FALSE(cr::EpisodeStateFilter::AroundActor(100u, std::nanf("")).IsValid());
+  ASSERT_FALSE(cr::EpisodeStateFilter::AroundActor(100u, -1.0f).IsValid());
+  region.extent.y = -1.0f;
+  ASSERT_FALSE(cr::EpisodeStateFilter::InsideRegion(region).IsValid());
+  region = cg::BoundingBox{cg::Vector3D{10.0f, 10.0f, 10.0f}};
+  region.location.x = inf;
+  ASSERT_FALSE(cr::EpisodeStateFilter::InsideRegion(region).IsValid());
+  region.location.x = 0.0f;
+  region.rotation.yaw = std::nanf("");
+  ASSERT_FALSE(cr::EpisodeStateFilter::InsideRegion(region).IsValid());
+}
+
+TEST(episode_state_index, matches_brute_force) {
+  constexpr auto number_of_actors = 2000u;
+  constexpr auto number_of_queries = 200u;
+  const auto states = MakeStates(number_of_actors, 500.0f);
+  EpisodeStateIndex index(25.0f);
+  index.Reset(states.data(), states.size());
+  ASSERT_EQ(index.size(), number_of_actors);
+  std::vector<uint32_t> selected;
+  for (auto i = 0u; i < number_of_queries; ++i) {
+    cr::EpisodeStateFilter filter;
+    if (i % 2u == 0u) {
+      filter.actor_id = 100u + static_cast<carla::ActorId>(util::Random::Uniform(0.0, number_of_actors - 1.0));
+      // 包括大于整个场景的半径，此时改为遍历所有网格。
+      filter.radius = static_cast<float>(util::Random::Uniform(1.0, i % 10u == 0u ? 5000.0 : 150.0));
+    }
+    if (i % 3u == 0u) {
+      filter.use_region = true;
+      filter.region = cg::BoundingBox{
+          util::Random::Location(-400.0f, 400.0f),
+          cg::Vector3D{util::Random::Location(5.0f, 200.0f)},
+          cg::Rotation{0.0f, static_cast<float>(util::Random::Uniform(-180.0, 180.0)), 0.0f}};
+    }
+    if (i % 5u == 0u) {
+      for (auto j = 0u; j < 10u; ++j) {
+        filter.actor_ids.push_back(static_cast<carla::ActorId>(util::Random::Uniform(0.0, 3000.0)));
+      }
+    }
+    index.Select(filter, selected);
+    ASSERT_EQ(selected, SelectBruteForce(states, filter)) << "query " << i;
+  }
+}
+
+TEST(episode_state_index, serialize) {
+  const auto states = MakeStates(50u, 100.0f);
+  EpisodeStateIndex index;
+  index.Reset(states.data(), states.size());
+
+  EpisodeStateSerializer::Header header;
+  header.episode_id = 42u;
+  header.platform_timestamp = 1.5;
+  header.delta_seconds = 0.05f;
+  header.map_origin = cg::Vector3DInt{};
+  const std::vector<uint32_t> selected = {3u, 7u, 49u};
+
+  const auto buffer = index.Serialize(header, selected, carla::Buffer{});
+  ASSERT_EQ(buffer.size(), sizeof(header) + selected.size() * sizeof(ActorDynamicState));
+  EpisodeStateSerializer::Header read_header;
+  std::memcpy(&read_header, buffer.data(), sizeof(read_header));
+  ASSERT_EQ(read_header.episode_id, 42u);
+  ASSERT_EQ(read_header.delta_seconds, 0.05f);
+  for (auto i = 0u; i < selected.size(); ++i) {
+    ActorDynamicState state;
+    std::memcpy(&state, buffer.data() + sizeof(header) + i * sizeof(ActorDynamicState), sizeof(state));
+    const carla::ActorId id = state.id;
+    const carla::ActorId expected_id = states[selected[i]].id;
+    ASSERT_EQ(id, expected_id);
+    ASSERT_EQ(cg::Location{state.transform.location}, cg::Location{states[selected[i]].transform.location});
+  }
+}
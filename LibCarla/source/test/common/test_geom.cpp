@@ -10,7 +10,10 @@
 #include <carla/geom/Math.h>
 #include <carla/geom/BoundingBox.h>
 #include <carla/geom/Transform.h>
+#include <carla/geom/Mesh.h>
+#include <cstring>
 #include <limits>
+#include <sstream>
 // 定义一个名为carla的命名空间，用于组织相关的代码和类型
 namespace carla {
 // 在carla命名空间内部，再定义一个名为geom的子命名空间
@@ -235,3 +238,80 @@ TEST(geom, nearest_point_arc) {
   ASSERT_NEAR(Math::DistanceArcToPoint(Vector3D(1,2,0),
       Vector3D(0,0,0), 1.57f, 0, 1).second, 1.0f, 0.01f);
 }
+
+static Mesh MakeTestMesh() {
+  Mesh mesh;
+  mesh.AddMaterial("road");
+  mesh.AddTriangleStrip({
+      Vector3D(0.0f, 0.0f, 0.0f), Vector3D(0.0f, 1.0f, 0.0f),
+      Vector3D(1.0f, 0.0f, 0.5f), Vector3D(1.0f, 1.0f, 0.5f)});
+  mesh.EndMaterial();
+  for (auto i = 0u; i < mesh.GetVerticesNum(); ++i) {
+    mesh.AddNormal(Vector3D(0.0f, 0.0f, 1.0f));
+    mesh.AddUV(Vector2D(0.25f * i, 1.0f));
+  }
+  return mesh;
+}
+
+TEST(geom, mesh_binary_round_trip) {
+  const auto mesh = MakeTestMesh();
+  std::stringstream stream;
+  // 多个网格可以依次写入同一个流
+  mesh.WriteBinary(stream);
+  mesh.WriteBinary(stream);
+  for (auto i = 0u; i < 2u; ++i) {
+    const auto result = Mesh::ReadBinary(stream);
+    ASSERT_EQ(result.GetVertices(), mesh.GetVertices());
+    ASSERT_EQ(result.GetNormals(), mesh.GetNormals());
+    ASSERT_EQ(result.GetIndexes(), mesh.GetIndexes());
+    ASSERT_EQ(result.GetUVs().size(), mesh.GetUVs().size());
+    ASSERT_EQ(result.GetMaterials().size(), 1u);
+    ASSERT_EQ(result.GetMaterials()[0].name, "road");
+    ASSERT_EQ(result.GetMaterials()[0].index_end, mesh.GetMaterials()[0].index_end);
+    ASSERT_EQ(result.GenerateOBJ(), mesh.GenerateOBJ());
+  }
+#ifndef LIBCARLA_NO_EXCEPTIONS
+  ASSERT_THROW(Mesh::ReadBinary(stream), std::runtime_error);
+#endif // LIBCARLA_NO_EXCEPTIONS
+}
+
+TEST(geom, mesh_streamed_obj) {
+  const auto mesh = MakeTestMesh();
+  std::stringstream obj;
+  mesh.WriteOBJ(obj);
+  ASSERT_EQ(obj.str(), mesh.GenerateOBJ());
+  ASSERT_NE(obj.str().find("usemtl road\nf 1 2 3\n"), std::string::npos);
+  std::stringstream recast;
+  mesh.WriteOBJForRecast(recast);
+  ASSERT_EQ(recast.str(), mesh.GenerateOBJForRecast());
+  ASSERT_NE(recast.str().find("f 1 3 2\n"), std::string::npos);
+}
+
+TEST(geom, mesh_binary_ply) {
+  const auto mesh = MakeTestMesh();
+  std::stringstream stream;
+  mesh.WritePLY(stream);
+  const auto ply = stream.str();
+  const std::string end_header = "end_header\n";
+  const auto body = ply.find(end_header);
+  ASSERT_NE(body, std::string::npos);
+  ASSERT_NE(ply.find("format binary_little_endian 1.0\nelement vertex 4\n"), std::string::npos);
+  ASSERT_NE(ply.find("element face 2\n"), std::string::npos);
+  const char *data = ply.data() + body + end_header.size();
+  const size_t vertex_size = 8u * sizeof(float);
+  ASSERT_EQ(ply.size() - body - end_header.size(), 4u * vertex_size + 2u * (1u + 3u * sizeof(uint32_t)));
+  float vertex[8];
+  std::memcpy(vertex, data + 2u * vertex_size, sizeof(vertex));
+  ASSERT_EQ(vertex[0], 1.0f);
+  ASSERT_EQ(vertex[2], 0.5f);
+  ASSERT_EQ(vertex[5], 1.0f);
+  ASSERT_EQ(vertex[6], 0.5f);
+  const char *face = data + 4u * vertex_size;
+  uint32_t indexes[3];
+  std::memcpy(indexes, face + 1u, sizeof(indexes));
+  ASSERT_EQ(face[0], 3);
+  ASSERT_EQ(indexes[0], mesh.GetIndexes()[0] - 1u);
+  ASSERT_EQ(indexes[1], mesh.GetIndexes()[1] - 1u);
+  ASSERT_EQ(indexes[2], mesh.GetIndexes()[2] - 1u);
+  ASSERT_NE(mesh.GeneratePLY().find("format ascii 1.0\n"), std::string::npos);
+}
@@ -0,0 +1,266 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "Random.h"
+
+#include <carla/Buffer.h>
+#include <carla/StopWatch.h>
+#include <carla/geom/Transform.h>
+#include <carla/sensor/LidarPostprocess.h>
+#include <carla/sensor/data/LidarData.h>
+#include <carla/sensor/s11n/LidarSerializer.h>
+
+#include <cmath>
+#include <cstring>
+#include <random>
+
+using carla::geom::Location;
+using carla::geom::Rotation;
+using carla::geom::Transform;
+using carla::sensor::LidarHits;
+using carla::sensor::LidarPostprocess;
+using carla::sensor::LidarPostprocessParams;
+using carla::sensor::data::LidarData;
+using carla::sensor::data::LidarDetection;
+using carla::sensor::s11n::LidarSerializer;
+
+static const Transform SensorTransform{Location{10.0f, -4.0f, 2.5f}, Rotation{5.0f, 30.0f, -2.0f}};
+
+static LidarHits MakeHits(uint32_t channels, uint32_t max_points_per_channel) {
+  LidarHits hits;
+  for (auto channel = 0u; channel < channels; ++channel) {
+    // 通道内的点数不是 8 的倍数，以覆盖标量尾部。
+    const auto count = static_cast<uint32_t>(util::Random::Uniform(0.0, max_points_per_channel));
+    for (auto i = 0u; i < count; ++i) {
+      const auto point = util::Random::Location(-80.0f, 80.0f);
+      hits.AddPoint(point.x, point.y, point.z);
+    }
+    hits.CloseChannel();
+  }
+  return hits;
+}
+
+static std::vector<float> Serialize(const LidarData &data) {
+  const auto buffer = LidarSerializer::Serialize(0, data, carla::Buffer{});
+  std::vector<float> result(buffer.size() / sizeof(float));
+  std::memcpy(result.data(), buffer.data(), buffer.size());
+  return result;
+}
+
+TEST(lidar_postprocess, counter_random) {
+  constexpr auto count = 200000u;
+  const auto key = LidarPostprocess::MakeKey(42, 1234u);
+  ASSERT_EQ(key, LidarPostprocess::MakeKey(42, 1234u));
+  ASSERT_NE(key, LidarPostprocess::MakeKey(42, 1235u));
+  ASSERT_NE(key, LidarPostprocess::MakeKey(43, 1234u));
+  ASSERT_NE(key, LidarPostprocess::MakeKey(42, 1234u + (uint64_t(1u) << 32u)));
+
+  double sum = 0.0;
+  double squared_sum = 0.0;
+  size_t kept_rays = 0u;
+  for (auto i = 0u; i < count; ++i) {
+    const float u = LidarPostprocess::Uniform(key, i, LidarPostprocess::IntensityDropOff);
+    ASSERT_GE(u, 0.0f);
+    ASSERT_LT(u, 1.0f);
+    const float n = LidarPostprocess::Normal(key, i);
+    ASSERT_TRUE(std::isfinite(n));
+    ASSERT_EQ(n, LidarPostprocess::Normal(key, i));
+    sum += n;
+    squared_sum += n * n;
+    kept_rays += LidarPostprocess::KeepRay(key, i, 0.45f) ? 1u : 0u;
+  }
+  const double mean = sum / count;
+  const double stddev = std::sqrt(squared_sum / count - mean * mean);
+  ASSERT_NEAR(mean, 0.0, 0.01);
+  ASSERT_NEAR(stddev, 1.0, 0.01);
+  ASSERT_NEAR(static_cast<double>(kept_rays) / count, 0.55, 0.01);
+  ASSERT_TRUE(LidarPostprocess::KeepRay(key, 0u, 0.0f));
+  ASSERT_FALSE(LidarPostprocess::KeepRay(key, 0u, 1.0f));
+}
+
+TEST(lidar_postprocess, matches_reference) {
+  // 不加噪声、不丢弃时与逐点的 std::exp 实现一致。
+  LidarPostprocessParams params;
+  params.atmosp_atten_rate = 0.01f;
+  params.dropoff_at_zero_intensity = 0.0f;
+
+  const auto hits = MakeHits(1u, 1000u);
+  const auto count = hits.GetPointCount();
+  std::vector<float> output(4u * count);
+  const auto matrix = SensorTransform.GetInverseMatrix();
+  const auto kept = LidarPostprocess::ProcessRange(
+      params, matrix, 7u, hits.x.data(), hits.y.data(), hits.z.data(), count, 0u, output.data());
+  ASSERT_EQ(kept, count);
+
+  for (auto i = 0u; i < count; ++i) {
+    Location point{hits.x[i], hits.y[i], hits.z[i]};
+    SensorTransform.InverseTransformPoint(point);
+    const float intensity = std::exp(-params.atmosp_atten_rate * point.Length());
+    ASSERT_NEAR(output[4u * i + 0u], point.x, 1e-3f);
+    ASSERT_NEAR(output[4u * i + 1u], point.y, 1e-3f);
+    ASSERT_NEAR(output[4u * i + 2u], point.z, 1e-3f);
+    ASSERT_NEAR(output[4u * i + 3u], intensity, 1e-6f);
+  }
+}
+
+TEST(lidar_postprocess, vectorized_matches_scalar) {
+  LidarPostprocessParams params;
+  params.noise_stddev = 0.2f;
+  const auto matrix = SensorTransform.GetInverseMatrix();
+  const auto hits = MakeHits(1u, 5000u);
+  for (size_t count : {0u, 1u, 7u, 8u, 9u, 31u, static_cast<unsigned>(hits.GetPointCount())}) {
+    std::vector<float> vectorized(4u * count);
+    std::vector<float> scalar(4u * count);
+    const auto vectorized_kept = LidarPostprocess::ProcessRange(
+        params, matrix, 99u, hits.x.data(), hits.y.data(), hits.z.data(), count, 17u, vectorized.data());
+    const auto scalar_kept = LidarPostprocess::ProcessRangeScalar(
+        params, matrix, 99u, hits.x.data(), hits.y.data(), hits.z.data(), count, 17u, scalar.data());
+    ASSERT_EQ(vectorized_kept, scalar_kept);
+    if (scalar_kept > 0u) {
+      ASSERT_EQ(std::memcmp(vectorized.data(), scalar.data(), sizeof(float) * 4u * scalar_kept), 0);
+    }
+  }
+
+  // 噪声沿射线方向，距离的变化服从 N(0, noise_stddev)。
+  LidarPostprocessParams keep_all = params;
+  keep_all.dropoff_at_zero_intensity = 0.0f;
+  const auto count = hits.GetPointCount();
+  std::vector<float> noisy(4u * count);
+  std::vector<float> clean(4u * count);
+  LidarPostprocess::ProcessRange(
+      keep_all, matrix, 3u, hits.x.data(), hits.y.data(), hits.z.data(), count, 0u, noisy.data());
+  keep_all.noise_stddev = 0.0f;
+  LidarPostprocess::ProcessRange(
+      keep_all, matrix, 3u, hits.x.data(), hits.y.data(), hits.z.data(), count, 0u, clean.data());
+  double squared_sum = 0.0;
+  for (auto i = 0u; i < count; ++i) {
+    const Location a{noisy[4u * i], noisy[4u * i + 1u], noisy[4u * i + 2u]};
+    const Location b{clean[4u * i], clean[4u * i + 1u], clean[4u * i + 2u]};
+    const double delta = a.Length() - b.Length();
+    squared_sum += delta * delta;
+    ASSERT_EQ(noisy[4u * i + 3u], clean[4u * i + 3u]);
+  }
+  ASSERT_NEAR(std::sqrt(squared_sum / static_cast<double>(count)), params.noise_stddev, 0.02);
+}
+
+TEST(lidar_postprocess, intensity_dropoff) {
+  // 强度恒为 0.3（atten * distance 为常数），保留概率为 alpha * 0.3 + beta。
+  LidarPostprocessParams params;
+  params.dropoff_intensity_limit = 0.8f;
+  params.dropoff_at_zero_intensity = 0.4f;
+  constexpr auto count = 100000u;
+  const float distance = 50.0f;
+  params.atmosp_atten_rate = -std::log(0.3f) / distance;
+  const std::vector<float> x(count, distance);
+  const std::vector<float> zeros(count, 0.0f);
+  std::vector<float> output(4u * count);
+  const LidarPostprocess::Matrix identity = {
+      1.0f, 0.0f, 0.0f, 0.0f,
+      0.0f, 1.0f, 0.0f, 0.0f,
+      0.0f, 0.0f, 1.0f, 0.0f,
+      0.0f, 0.0f, 0.0f, 1.0f};
+  const auto kept = LidarPostprocess::ProcessRange(
+      params, identity, 5u, x.data(), zeros.data(), zeros.data(), count, 0u, output.data());
+  const double expected = 0.4 / 0.8 * 0.3 + 0.6;
+  ASSERT_NEAR(static_cast<double>(kept) / count, expected, 0.01);
+
+  // 超过上限的点全部保留。
+  params.atmosp_atten_rate = 0.0f;
+  ASSERT_EQ(LidarPostprocess::ProcessRange(
+      params, identity, 5u, x.data(), zeros.data(), zeros.data(), count, 0u, output.data()), count);
+}
+
+TEST(lidar_postprocess, deterministic_across_threads) {
+  LidarPostprocessParams params;
+  params.noise_stddev = 0.1f;
+  constexpr auto channels = 32u;
+  const auto hits = MakeHits(channels, 800u);
+  const auto matrix = SensorTransform.GetInverseMatrix();
+  const auto key = LidarPostprocess::MakeKey(7, 100u);
+
+  // 逐通道处理并拼接的结果作为参考。
+  std::vector<float> expected;
+  std::vector<uint32_t> expected_counts;
+  for (auto channel = 0u; channel < channels; ++channel) {
+    const auto offset = hits.offsets[channel];
+    const auto count = hits.offsets[channel + 1u] - offset;
+    std::vector<float> output(4u * count);
+    const auto kept = LidarPostprocess::ProcessRange(
+        params, matrix, key, hits.x.data() + offset, hits.y.data() + offset, hits.z.data() + offset,
+        count, offset, output.data());
+    expected.insert(expected.end(), output.begin(), output.begin() + 4u * kept);
+    expected_counts.emplace_back(static_cast<uint32_t>(kept));
+  }
+
+  for (size_t num_threads : {1u, 3u, 8u, 0u, 64u}) {
+    LidarData data(channels);
+    // 上一帧留下的数据会被覆盖。
+    LidarDetection detection{1.0f, 2.0f, 3.0f, 4.0f};
+    data.WritePointSync(detection);
+    LidarPostprocess::Process(params, matrix, key, hits, data, num_threads);
+    const auto serialized = Serialize(data);
+    constexpr auto header_size = 2u + channels;
+    ASSERT_EQ(serialized.size(), header_size + expected.size());
+    for (auto channel = 0u; channel < channels; ++channel) {
+      uint32_t count;
+      std::memcpy(&count, &serialized[2u + channel], sizeof(count));
+      ASSERT_EQ(count, expected_counts[channel]);
+    }
+    ASSERT_EQ(std::memcmp(serialized.data() + header_size, expected.data(), sizeof(float) * expected.size()), 0);
+  }
+}
+
+TEST(lidar_postprocess, benchmark) {
+  // 与 ARayCastLidar 原来的逐点实现对比：变换、std::exp、std::normal_distribution。
+  constexpr auto channels = 64u;
+  constexpr auto iterations = 20u;
+  LidarPostprocessParams params;
+  params.noise_stddev = 0.02f;
+  const auto hits = MakeHits(channels, 4000u);
+  const auto matrix = SensorTransform.GetInverseMatrix();
+
+  std::mt19937 engine(42u);
+  std::vector<float> points;
+  carla::StopWatch per_point_watch;
+  for (auto iteration = 0u; iteration < iterations; ++iteration) {
+    points.clear();
+    const float alpha = params.dropoff_at_zero_intensity / params.dropoff_intensity_limit;
+    const float beta = 1.0f - params.dropoff_at_zero_intensity;
+    for (auto i = 0u; i < hits.GetPointCount(); ++i) {
+      Location point{hits.x[i], hits.y[i], hits.z[i]};
+      SensorTransform.InverseTransformPoint(point);
+      const float intensity = std::exp(-params.atmosp_atten_rate * point.Length());
+      point += point.MakeUnitVector() * std::normal_distribution<float>(0.0f, params.noise_stddev)(engine);
+      if (intensity > params.dropoff_intensity_limit ||
+          std::uniform_real_distribution<float>(0.0f, 1.0f)(engine) < alpha * intensity + beta) {
+        points.insert(points.end(), {point.x, point.y, point.z, intensity});
+      }
+    }
+  }
+  per_point_watch.Stop();
+
+  LidarData data(channels);
+  carla::StopWatch kernel_watch;
+  for (auto iteration = 0u; iteration < iterations; ++iteration) {
+    LidarPostprocess::Process(params, matrix, LidarPostprocess::MakeKey(0, iteration), hits, data, 1u);
+  }
+  kernel_watch.Stop();
+  const auto kernel_count = (Serialize(data).size() - 2u - channels) / 4u;
+
+  carla::StopWatch parallel_watch;
+  for (auto iteration = 0u; iteration < iterations; ++iteration) {
+    LidarPostprocess::Process(params, matrix, LidarPostprocess::MakeKey(0, iteration), hits, data);
+  }
+  parallel_watch.Stop();
+
+  ASSERT_NEAR(static_cast<double>(kernel_count) / static_cast<double>(points.size() / 4u), 1.0, 0.02);
+  carla::logging::log(
+      "lidar postprocess over", hits.GetPointCount(), "points (us/frame): per point",
+      per_point_watch.GetElapsedTime<std::chrono::microseconds>() / iterations,
+      "kernel", kernel_watch.GetElapsedTime<std::chrono::microseconds>() / iterations,
+      "kernel (threads)", parallel_watch.GetElapsedTime<std::chrono::microseconds>() / iterations);
+}
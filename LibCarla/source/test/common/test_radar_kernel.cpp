@@ -0,0 +1,170 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "Random.h"
+
+#include <carla/Buffer.h>
+#include <carla/StopWatch.h>
+#include <carla/geom/Math.h>
+#include <carla/geom/Transform.h>
+#include <carla/sensor/RadarKernel.h>
+#include <carla/sensor/data/RadarData.h>
+#include <carla/sensor/s11n/RadarSerializer.h>
+
+#include <cmath>
+#include <cstring>
+
+using carla::geom::Location;
+using carla::geom::Rotation;
+using carla::geom::Transform;
+using carla::geom::Vector3D;
+using carla::sensor::RadarHits;
+using carla::sensor::RadarKernel;
+using carla::sensor::data::RadarData;
+using carla::sensor::data::RadarDetection;
+using carla::sensor::s11n::RadarSerializer;
+
+static const Transform SensorTransform{Location{10.0f, -4.0f, 1.5f}, Rotation{3.0f, 40.0f, 0.0f}};
+
+static const Vector3D SensorVelocity{8.0f, 2.0f, 0.0f};
+
+static std::vector<RadarDetection> GetDetections(const RadarData &data) {
+  const auto buffer = RadarSerializer::Serialize(0, data, carla::Buffer{});
+  std::vector<RadarDetection> result(buffer.size() / sizeof(RadarDetection));
+  if (!result.empty()) {
+    std::memcpy(result.data(), buffer.data(), buffer.size());
+  }
+  return result;
+}
+
+// 模拟 ARadar 的一帧：在视场内随机生成射线，命中点在射线上随机位置。
+static RadarHits MakeHits(size_t count) {
+  constexpr float range = 100.0f;
+  const float max_rx = std::tan(carla::geom::Math::ToRadians(30.0f * 0.5f)) * range;
+  const float max_ry = std::tan(carla::geom::Math::ToRadians(20.0f * 0.5f)) * range;
+  RadarHits hits;
+  hits.Reserve(count);
+  for (auto i = 0u; i < count; ++i) {
+    const auto radius = static_cast<float>(util::Random::Uniform(0.0, 1.0));
+    const auto angle = static_cast<float>(util::Random::Uniform(0.0, carla::geom::Math::Pi2<double>()));
+    const auto end = RadarKernel::GetRayEnd(range, max_rx, max_ry, radius, angle);
+    const auto fraction = static_cast<float>(util::Random::Uniform(0.01, 1.0));
+    Location point = end * fraction;
+    SensorTransform.TransformPoint(point);
+    const auto velocity = util::Random::Location(-20.0f, 20.0f);
+    hits.AddHit(end, point, velocity, end.Length() * fraction);
+  }
+  return hits;
+}
+
+TEST(radar_kernel, recorded_hits) {
+  RadarHits hits;
+  // 正前方远离的目标、左前方 45 度靠近的目标、正上方静止的目标。
+  hits.AddHit({1.0f, 0.0f, 0.0f}, {20.0f, 0.0f, 0.0f}, {5.0f, 0.0f, 0.0f}, 20.0f);
+  hits.AddHit({1.0f, 1.0f, 0.0f}, {10.0f, 10.0f, 0.0f}, {-3.0f, -3.0f, 0.0f}, std::sqrt(200.0f));
+  hits.AddHit({1.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 4.0f}, {0.0f, 0.0f, 0.0f}, 4.0f);
+  // 与传感器重合的命中点速度为 0。
+  hits.AddHit({1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f}, 0.0f);
+
+  RadarData data;
+  data.SetResolution(16u);
+  RadarKernel::Process(hits, Location{}, Vector3D{1.0f, 0.0f, 1.0f}, data);
+  const auto detections = GetDetections(data);
+  ASSERT_EQ(detections.size(), 4u);
+
+  ASSERT_NEAR(detections[0u].velocity, 4.0f, 1e-6f);
+  ASSERT_NEAR(detections[0u].azimuth, 0.0f, 1e-6f);
+  ASSERT_NEAR(detections[0u].altitude, 0.0f, 1e-6f);
+  ASSERT_NEAR(detections[0u].depth, 20.0f, 1e-6f);
+
+  ASSERT_NEAR(detections[1u].velocity, -7.0f / std::sqrt(2.0f), 1e-5f);
+  ASSERT_NEAR(detections[1u].azimuth, carla::geom::Math::Pi<float>() / 4.0f, 1e-6f);
+  ASSERT_NEAR(detections[1u].altitude, 0.0f, 1e-6f);
+
+  ASSERT_NEAR(detections[2u].velocity, -1.0f, 1e-6f);
+  ASSERT_NEAR(detections[2u].altitude, carla::geom::Math::Pi<float>() / 4.0f, 1e-6f);
+
+  ASSERT_EQ(detections[3u].velocity, 0.0f);
+}
+
+TEST(radar_kernel, matches_reference) {
+  // 与 ARadar 原来的计算方式对比：在世界坐标系下归一化视线方向，并将射线方向
+  // 投影到传感器的坐标轴上求方位角与高度角。
+  const auto hits = MakeHits(1000u);
+  RadarData data;
+  data.SetResolution(1000u);
+  RadarKernel::Process(hits, SensorTransform.location, SensorVelocity, data);
+  const auto detections = GetDetections(data);
+  ASSERT_EQ(detections.size(), hits.GetHitCount());
+
+  const auto forward = SensorTransform.GetForwardVector();
+  const auto right = SensorTransform.GetRightVector();
+  const auto up = SensorTransform.GetUpVector();
+  for (auto i = 0u; i < hits.GetHitCount(); ++i) {
+    const Location point{hits.x[i], hits.y[i], hits.z[i]};
+    const Vector3D target_velocity{hits.vx[i], hits.vy[i], hits.vz[i]};
+    const auto direction = (point - SensorTransform.location).MakeUnitVector();
+    const auto velocity = carla::geom::Math::Dot(target_velocity - SensorVelocity, direction);
+    ASSERT_NEAR(detections[i].velocity, velocity, 1e-4f);
+
+    Vector3D ray{hits.dir_x[i], hits.dir_y[i], hits.dir_z[i]};
+    SensorTransform.TransformVector(ray);
+    ray = ray.MakeUnitVector();
+    const float x = carla::geom::Math::Dot(ray, forward);
+    const float y = carla::geom::Math::Dot(ray, right);
+    const float z = carla::geom::Math::Dot(ray, up);
+    ASSERT_NEAR(detections[i].azimuth, std::atan2(y, x), 1e-4f);
+    ASSERT_NEAR(detections[i].altitude, std::atan2(z, std::sqrt(x * x + y * y)), 1e-4f);
+    ASSERT_EQ(detections[i].depth, hits.depth[i]);
+  }
+}
+
+TEST(radar_kernel, vectorized_matches_scalar) {
+  // 命中点数不是 8 的倍数，以覆盖标量尾部。
+  for (auto count : {0u, 5u, 8u, 1003u}) {
+    const auto hits = MakeHits(count);
+    std::vector<float> scalar(count + 1u);
+    std::vector<float> vectorized(count + 1u);
+    RadarKernel::ComputeVelocitiesScalar(hits, SensorTransform.location, SensorVelocity, scalar.data());
+    RadarKernel::ComputeVelocities(hits, SensorTransform.location, SensorVelocity, vectorized.data());
+    ASSERT_EQ(std::memcmp(scalar.data(), vectorized.data(), sizeof(float) * scalar.size()), 0);
+  }
+}
+
+TEST(radar_kernel, benchmark) {
+  constexpr auto iterations = 20u;
+  const auto hits = MakeHits(200000u);
+  std::vector<float> velocities(hits.GetHitCount());
+
+  carla::StopWatch scalar_watch;
+  for (auto iteration = 0u; iteration < iterations; ++iteration) {
+    RadarKernel::ComputeVelocitiesScalar(hits, SensorTransform.location, SensorVelocity, velocities.data());
+  }
+  scalar_watch.Stop();
+
+  carla::StopWatch kernel_watch;
+  for (auto iteration = 0u; iteration < iterations; ++iteration) {
+    RadarKernel::ComputeVelocities(hits, SensorTransform.location, SensorVelocity, velocities.data());
+  }
+  kernel_watch.Stop();
+
+  RadarData data;
+  data.SetResolution(static_cast<uint32_t>(hits.GetHitCount()));
+  carla::StopWatch process_watch;
+  for (auto iteration = 0u; iteration < iterations; ++iteration) {
+    data.Reset();
+    RadarKernel::Process(hits, SensorTransform.location, SensorVelocity, data);
+  }
+  process_watch.Stop();
+
+  ASSERT_EQ(data.GetDetectionCount(), hits.GetHitCount());
+  carla::logging::log(
+      "radar kernel over", hits.GetHitCount(), "hits (us/frame): scalar velocity",
+      scalar_watch.GetElapsedTime<std::chrono::microseconds>() / iterations,
+      "velocity", kernel_watch.GetElapsedTime<std::chrono::microseconds>() / iterations,
+      "detections", process_watch.GetElapsedTime<std::chrono::microseconds>() / iterations);
+}
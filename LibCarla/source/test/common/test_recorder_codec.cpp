@@ -0,0 +1,283 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/recorder/BlockCodec.h>
+#include <carla/recorder/DecodingStreamBuf.h>
+
+#include <cstring>
+#include <istream>
+#include <iterator>
+#include <random>
+#include <sstream>
+
+using carla::recorder::BlockCodec;
+using carla::recorder::DecodingStreamBuf;
+
+static std::mt19937 ENGINE{42u};
+
+static size_t RandomInt(size_t min, size_t max) {
+  return std::uniform_int_distribution<size_t>(min, max)(ENGINE);
+}
+
+template <typename T>
+static void Append(std::vector<char> &out, const T &value) {
+  const auto *begin = reinterpret_cast<const char *>(&value);
+  out.insert(out.end(), begin, begin + sizeof(T));
+}
+
+static void AppendPacket(std::vector<char> &out, uint8_t id, const std::vector<char> &payload) {
+  Append(out, id);
+  Append(out, static_cast<uint32_t>(payload.size()));
+  out.insert(out.end(), payload.begin(), payload.end());
+}
+
+// 模拟若干帧录制数据：帧开始、位置数据包（参与者缓慢移动）、其他数据包、帧结束。
+static std::vector<char> MakeFrames(size_t number_of_frames, uint16_t number_of_actors) {
+  std::vector<char> data;
+  for (size_t frame = 0u; frame < number_of_frames; ++frame) {
+    std::vector<char> header;
+    Append(header, static_cast<uint64_t>(frame));
+    Append(header, -1.0);
+    Append(header, 0.05 * static_cast<double>(frame));
+    AppendPacket(data, 0u, header);
+
+    std::vector<char> positions;
+    Append(positions, number_of_actors);
+    for (uint32_t actor = 0u; actor < number_of_actors; ++actor) {
+      Append(positions, actor + 100u);
+      const float speed = (actor % 3u == 0u) ? 0.0f : 0.1f * static_cast<float>(actor % 7u);
+      Append(positions, 10.0f * static_cast<float>(actor) + speed * static_cast<float>(frame));
+      Append(positions, -5.0f * static_cast<float>(actor));
+      Append(positions, 0.5f);
+      Append(positions, 0.0f);
+      Append(positions, 90.0f + 0.01f * static_cast<float>(frame));
+      Append(positions, 0.0f);
+    }
+    AppendPacket(data, BlockCodec::POSITION_PACKET_ID, positions);
+
+    std::vector<char> other(37u, static_cast<char>(frame & 0xFFu));
+    AppendPacket(data, 8u, other);
+
+    AppendPacket(data, 1u, {});
+  }
+  return data;
+}
+
+static std::vector<char> RoundTrip(const std::vector<char> &data, bool delta, bool lz, size_t &encoded_size) {
+  std::vector<char> encoded;
+  BlockCodec::EncodeBlock(data.data(), data.size(), encoded, delta, lz);
+  encoded_size = encoded.size();
+  std::vector<char> decoded;
+  EXPECT_EQ(BlockCodec::DecodeBlock(encoded.data(), encoded.size(), decoded), encoded.size());
+  return decoded;
+}
+
+TEST(recorder_codec, round_trip) {
+  const auto data = MakeFrames(50u, 300u);
+  size_t raw, delta, lz, both;
+  ASSERT_EQ(RoundTrip(data, false, false, raw), data);
+  ASSERT_EQ(RoundTrip(data, true, false, delta), data);
+  ASSERT_EQ(RoundTrip(data, false, true, lz), data);
+  ASSERT_EQ(RoundTrip(data, true, true, both), data);
+  ASSERT_EQ(raw, data.size() + BlockCodec::BLOCK_HEADER_SIZE);
+  ASSERT_LT(delta, raw / 2u);
+  ASSERT_LT(lz, raw);
+  ASSERT_LT(both, delta);
+}
+
+TEST(recorder_codec, position_delta) {
+  const auto data = MakeFrames(10u, 20u);
+  std::vector<char> encoded;
+  ASSERT_TRUE(BlockCodec::EncodePositionDelta(data.data(), data.size(), encoded));
+  ASSERT_LT(encoded.size(), data.size());
+  std::vector<char> decoded;
+  ASSERT_TRUE(BlockCodec::DecodePositionDelta(encoded.data(), encoded.size(), data.size(), decoded));
+  ASSERT_EQ(decoded, data);
+  // 数据包不完整时不做差分。
+  std::vector<char> truncated(data.begin(), data.end() - 3);
+  encoded.clear();
+  ASSERT_FALSE(BlockCodec::EncodePositionDelta(truncated.data(), truncated.size(), encoded));
+  std::vector<char> output;
+  BlockCodec::EncodeBlock(truncated.data(), truncated.size(), output);
+  decoded.clear();
+  ASSERT_EQ(BlockCodec::DecodeBlock(output.data(), output.size(), decoded), output.size());
+  ASSERT_EQ(decoded, truncated);
+}
+
+TEST(recorder_codec, lz_edge_cases) {
+  std::vector<std::vector<char>> inputs;
+  inputs.emplace_back();
+  inputs.emplace_back(1u, 'a');
+  inputs.emplace_back(3u, 'b');
+  inputs.emplace_back(100000u, 'c');
+  std::vector<char> random(200000u);
+  for (auto &c : random) {
+    c = static_cast<char>(RandomInt(0, 255));
+  }
+  inputs.emplace_back(random);
+  // 重复出现但间隔超过最大偏移的数据。
+  std::vector<char> far(random.begin(), random.begin() + 70000);
+  far.insert(far.end(), random.begin(), random.begin() + 1000);
+  inputs.emplace_back(far);
+  for (const auto &input : inputs) {
+    std::vector<char> compressed;
+    BlockCodec::CompressLZ(input.data(), input.size(), compressed);
+    std::vector<char> decompressed;
+    ASSERT_TRUE(BlockCodec::DecompressLZ(compressed.data(), compressed.size(), input.size(), decompressed));
+    ASSERT_EQ(decompressed, input);
+  }
+}
+
+TEST(recorder_codec, corrupted_input) {
+  const auto data = MakeFrames(20u, 50u);
+  std::vector<char> encoded;
+  BlockCodec::EncodeBlock(data.data(), data.size(), encoded);
+  std::vector<char> decoded;
+  // 不完整的块。
+  ASSERT_EQ(BlockCodec::DecodeBlock(encoded.data(), encoded.size() - 1u, decoded), 0u);
+  ASSERT_EQ(BlockCodec::DecodeBlock(encoded.data(), 5u, decoded), 0u);
+  ASSERT_TRUE(decoded.empty());
+  // 随机破坏数据：解码要么失败，要么得到大小正确的数据，不能越界。
+  for (auto i = 0u; i < 200u; ++i) {
+    auto corrupted = encoded;
+    const auto index = RandomInt(BlockCodec::BLOCK_HEADER_SIZE, corrupted.size() - 1u);
+    corrupted[index] = static_cast<char>(RandomInt(0, 255));
+    decoded.clear();
+    if (BlockCodec::DecodeBlock(corrupted.data(), corrupted.size(), decoded) != 0u) {
+      ASSERT_EQ(decoded.size(), data.size());
+    } else {
+      ASSERT_TRUE(decoded.empty());
+    }
+  }
+}
+
+TEST(recorder_codec, multiple_blocks) {
+  const auto first = MakeFrames(5u, 10u);
+  const auto second = MakeFrames(7u, 12u);
+  std::vector<char> encoded;
+  BlockCodec::EncodeBlock(first.data(), first.size(), encoded);
+  BlockCodec::EncodeBlock(second.data(), second.size(), encoded);
+  std::vector<char> decoded;
+  const auto consumed = BlockCodec::DecodeBlock(encoded.data(), encoded.size(), decoded);
+  ASSERT_GT(consumed, 0u);
+  ASSERT_EQ(BlockCodec::DecodeBlock(encoded.data() + consumed, encoded.size() - consumed, decoded), encoded.size() - consumed);
+  auto expected = first;
+  expected.insert(expected.end(), second.begin(), second.end());
+  ASSERT_EQ(decoded, expected);
+}
+
+TEST(recorder_codec, collision_packet_size) {
+  // 碰撞记录按 1 字节对齐写出（每条 14 字节），差分时要正确跳过碰撞数据包
+  // 并定位后面的位置数据包。
+  auto data = MakeFrames(1u, 10u);
+  std::vector<char> collisions;
+  Append(collisions, static_cast<uint16_t>(2u));
+  for (uint32_t i = 0u; i < 2u; ++i) {
+    Append(collisions, i);
+    Append(collisions, 100u + i);
+    Append(collisions, 200u + i);
+    Append(collisions, true);
+    Append(collisions, false);
+  }
+  data.push_back(static_cast<char>(5u));
+  Append(data, static_cast<uint32_t>(2u + 2u * 14u));
+  data.insert(data.end(), collisions.begin(), collisions.end());
+  const auto next = MakeFrames(5u, 10u);
+  data.insert(data.end(), next.begin(), next.end());
+  std::vector<char> encoded;
+  ASSERT_TRUE(BlockCodec::EncodePositionDelta(data.data(), data.size(), encoded));
+  std::vector<char> decoded;
+  ASSERT_TRUE(BlockCodec::DecodePositionDelta(encoded.data(), encoded.size(), data.size(), decoded));
+  ASSERT_EQ(decoded, data);
+}
+
+// 压缩录制文件：文件头之后是若干块。
+struct CompressedFile {
+  std::string header = "recorder file header";
+  std::vector<char> decoded;
+  std::string encoded;
+  /// 各块在解码后数据中的起始位置。
+  std::vector<size_t> block_offsets;
+};
+
+static CompressedFile MakeCompressedFile(size_t number_of_blocks) {
+  CompressedFile file;
+  file.decoded.assign(file.header.begin(), file.header.end());
+  std::vector<char> encoded(file.header.begin(), file.header.end());
+  for (size_t i = 0u; i < number_of_blocks; ++i) {
+    file.block_offsets.push_back(file.decoded.size());
+    const auto frames = MakeFrames(3u + i, static_cast<uint16_t>(20u + i));
+    BlockCodec::EncodeBlock(frames.data(), frames.size(), encoded);
+    file.decoded.insert(file.decoded.end(), frames.begin(), frames.end());
+  }
+  file.encoded.assign(encoded.begin(), encoded.end());
+  return file;
+}
+
+static std::vector<char> ReadAll(std::istream &in) {
+  return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+TEST(recorder_codec, decoding_stream) {
+  const auto file = MakeCompressedFile(4u);
+  std::stringbuf source(file.encoded, std::ios_base::in);
+  DecodingStreamBuf decoder;
+  decoder.Open(source, file.header.size(), "test.log");
+  std::istream in(&decoder);
+  ASSERT_EQ(ReadAll(in), file.decoded);
+
+  // 向前跳过若干块，再回到开头。
+  in.clear();
+  ASSERT_EQ(in.seekg(0, std::ios_base::beg).tellg(), 0);
+  char c;
+  ASSERT_TRUE(in.read(&c, 1));
+  ASSERT_EQ(c, file.decoded[0u]);
+  const auto target = file.block_offsets[2u] + 17u;
+  ASSERT_TRUE(in.seekg(static_cast<std::streamoff>(target - 1u), std::ios_base::cur));
+  ASSERT_EQ(in.tellg(), static_cast<std::streamoff>(target));
+  ASSERT_TRUE(in.read(&c, 1));
+  ASSERT_EQ(c, file.decoded[target]);
+  ASSERT_TRUE(in.seekg(static_cast<std::streamoff>(file.block_offsets[1u]), std::ios_base::beg));
+  std::vector<char> rest = ReadAll(in);
+  ASSERT_EQ(rest, std::vector<char>(file.decoded.begin() + file.block_offsets[1u], file.decoded.end()));
+
+  // 定位到末尾以及越过末尾。
+  in.clear();
+  ASSERT_EQ(in.seekg(0, std::ios_base::end).tellg(), static_cast<std::streamoff>(file.decoded.size()));
+  ASSERT_FALSE(in.read(&c, 1));
+  in.clear();
+  ASSERT_FALSE(in.seekg(static_cast<std::streamoff>(file.decoded.size() + 1u), std::ios_base::beg));
+
+  // 关闭后不再读取数据源。
+  decoder.Close();
+  in.clear();
+  ASSERT_EQ(ReadAll(in).size(), 0u);
+}
+
+TEST(recorder_codec, decoding_stream_truncated) {
+  const auto file = MakeCompressedFile(3u);
+  // 最后一个块被截断，只能读到之前的数据。
+  std::stringbuf source(file.encoded.substr(0u, file.encoded.size() - 5u), std::ios_base::in);
+  DecodingStreamBuf decoder;
+  decoder.Open(source, file.header.size(), "test.log");
+  std::istream in(&decoder);
+  const std::vector<char> expected(file.decoded.begin(), file.decoded.begin() + file.block_offsets[2u]);
+  ASSERT_EQ(ReadAll(in), expected);
+  in.clear();
+  ASSERT_EQ(in.seekg(0, std::ios_base::end).tellg(), static_cast<std::streamoff>(expected.size()));
+
+  // 块的数据损坏：读到损坏的块时停止。
+  auto corrupted = file.encoded;
+  corrupted[file.header.size() + BlockCodec::BLOCK_HEADER_SIZE + 3u] ^= 0x5a;
+  std::stringbuf corrupted_source(corrupted, std::ios_base::in);
+  decoder.Open(corrupted_source, file.header.size(), "test.log");
+  in.clear();
+  const auto data = ReadAll(in);
+  ASSERT_LE(data.size(), file.decoded.size());
+  ASSERT_TRUE(std::equal(data.begin(), data.end(), file.decoded.begin()));
+}
@@ -0,0 +1,250 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/ThreadGroup.h>
+#include <carla/streaming/StreamMetrics.h>
+#include <carla/streaming/detail/Token.h>
+#include <carla/streaming/detail/tcp/Client.h>
+#include <carla/streaming/detail/tcp/Server.h>
+#include <carla/streaming/low_level/Client.h>
+#include <carla/streaming/low_level/Server.h>
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
+#include <atomic>
+#include <fstream>
+#include <sstream>
+
+using namespace std::chrono_literals;
+
+using carla::streaming::StreamCounters;
+using carla::streaming::StreamMetrics;
+using carla::streaming::StreamStatistics;
+
+// 测试之间互不影响，流 id 从不会被服务器使用的值开始。
+static carla::streaming::stream_id_type NextStreamId() {
+  static carla::streaming::stream_id_type next = 1000000u;
+  return ++next;
+}
+
+static std::string ExportPrometheus() {
+  std::ostringstream out;
+  StreamMetrics::ExportPrometheus(out);
+  return out.str();
+}
+
+TEST(stream_metrics, counters) {
+  const auto id = NextStreamId();
+  auto counters = StreamMetrics::Get(id);
+  ASSERT_EQ(counters, StreamMetrics::Get(id));
+  ASSERT_EQ(counters->GetStreamId(), id);
+
+  counters->RecordSent(100u);
+  counters->RecordSent(50u);
+  counters->RecordDropped();
+  counters->RecordWriteWait(0u);
+  counters->RecordWriteWait(3000000u);
+  counters->RecordReceived(70u);
+  counters->RecordReconnect();
+  counters->RecordLatency(500000u);
+  counters->RecordLatency(4000000u);
+  counters->RecordLatency(9000000000u);
+
+  const auto stats = StreamMetrics::GetStatistics(id);
+  ASSERT_EQ(stats.stream_id, id);
+  ASSERT_EQ(stats.messages_sent, 2u);
+  ASSERT_EQ(stats.bytes_sent, 150u);
+  ASSERT_EQ(stats.messages_dropped, 1u);
+  ASSERT_EQ(stats.write_wait_count, 2u);
+  ASSERT_NEAR(stats.write_wait_total, 0.003, 1e-12);
+  ASSERT_NEAR(stats.write_wait_max, 0.003, 1e-12);
+  ASSERT_NEAR(stats.GetAverageWriteWait(), 0.0015, 1e-12);
+  ASSERT_EQ(stats.messages_received, 1u);
+  ASSERT_EQ(stats.bytes_received, 70u);
+  ASSERT_EQ(stats.reconnects, 1u);
+  ASSERT_EQ(stats.latency_count, 3u);
+  ASSERT_NEAR(stats.latency_max, 9.0, 1e-12);
+  // 0.5 毫秒落在第一个桶，4 毫秒落在 5 毫秒的桶，9 秒超出所有桶。
+  ASSERT_EQ(stats.latency_buckets[0u], 1u);
+  ASSERT_EQ(stats.latency_buckets[2u], 1u);
+  uint64_t bucketed = 0u;
+  for (auto count : stats.latency_buckets) {
+    bucketed += count;
+  }
+  ASSERT_EQ(bucketed, 2u);
+
+  // 仍被使用的流在 Reset 后保留，计数清零。
+  StreamMetrics::Reset();
+  const auto reset = StreamMetrics::GetStatistics(id);
+  ASSERT_EQ(reset.messages_sent, 0u);
+  ASSERT_EQ(reset.latency_count, 0u);
+  ASSERT_EQ(reset.latency_max, 0.0);
+  ASSERT_EQ(counters, StreamMetrics::Get(id));
+
+  // 不再使用的流被移除，查询时返回全 0。
+  const auto unused = NextStreamId();
+  StreamMetrics::Get(unused)->RecordSent(10u);
+  StreamMetrics::Reset();
+  ASSERT_EQ(StreamMetrics::GetStatistics(unused).messages_sent, 0u);
+  for (const auto &stream : StreamMetrics::GetStatistics()) {
+    ASSERT_NE(stream.stream_id, unused);
+  }
+}
+
+TEST(stream_metrics, concurrent_updates) {
+  constexpr auto threads = 4u;
+  constexpr auto iterations = 100000u;
+  const auto id = NextStreamId();
+  auto counters = StreamMetrics::Get(id);
+  {
+    carla::ThreadGroup group;
+    group.CreateThreads(threads, [&]() {
+      for (auto i = 0u; i < iterations; ++i) {
+        counters->RecordSent(2u);
+        counters->RecordLatency(i);
+      }
+    });
+  }
+  const auto stats = counters->GetStatistics();
+  ASSERT_EQ(stats.messages_sent, threads * iterations);
+  ASSERT_EQ(stats.bytes_sent, 2u * threads * iterations);
+  ASSERT_EQ(stats.latency_count, threads * iterations);
+  ASSERT_NEAR(stats.latency_max, 1e-9 * (iterations - 1u), 1e-15);
+}
+
+TEST(stream_metrics, prometheus_format) {
+  const auto id = NextStreamId();
+  auto counters = StreamMetrics::Get(id);
+  counters->RecordSent(1234u);
+  counters->RecordLatency(1500000u);
+  counters->RecordLatency(30000000u);
+  const auto text = ExportPrometheus();
+  const auto label = "{stream_id=\"" + std::to_string(id) + "\"}";
+
+  ASSERT_NE(text.find("# TYPE carla_stream_bytes_sent_total counter\n"), std::string::npos);
+  ASSERT_NE(text.find("carla_stream_messages_sent_total" + label + " 1\n"), std::string::npos);
+  ASSERT_NE(text.find("carla_stream_bytes_sent_total" + label + " 1234\n"), std::string::npos);
+  ASSERT_NE(text.find("# TYPE carla_stream_latency_seconds histogram\n"), std::string::npos);
+  // 直方图的桶是累计的。
+  const auto bucket = "carla_stream_latency_seconds_bucket{stream_id=\"" + std::to_string(id) + "\",le=\"";
+  ASSERT_NE(text.find(bucket + "0.001\"} 0\n"), std::string::npos);
+  ASSERT_NE(text.find(bucket + "0.002\"} 1\n"), std::string::npos);
+  ASSERT_NE(text.find(bucket + "0.05\"} 2\n"), std::string::npos);
+  ASSERT_NE(text.find(bucket + "+Inf\"} 2\n"), std::string::npos);
+  ASSERT_NE(text.find("carla_stream_latency_seconds_sum" + label + " 0.0315\n"), std::string::npos);
+  ASSERT_NE(text.find("carla_stream_latency_seconds_count" + label + " 2\n"), std::string::npos);
+  // 每个指标的说明只出现一次。
+  const auto help = "# HELP carla_stream_bytes_sent_total ";
+  ASSERT_EQ(text.find(help), text.rfind(help));
+
+  const std::string filename = "stream_metrics_test.prom";
+  ASSERT_TRUE(StreamMetrics::ExportPrometheus(filename));
+  std::ifstream file(filename);
+  std::stringstream content;
+  content << file.rdbuf();
+  file.close();
+  ASSERT_NE(content.str().find("carla_stream_bytes_sent_total" + label + " 1234\n"), std::string::npos);
+  std::remove(filename.c_str());
+}
+
+TEST(stream_metrics, streaming_server_and_client) {
+  using namespace carla::streaming::detail;
+
+  constexpr auto number_of_messages = 50u;
+  const std::string message_text = "Hello client!";
+
+  // 每个 Dispatcher 都从 1 开始分配流 id，而注册表是整个进程共享的，
+  // 之前的测试（例如 test_streaming）可能已经在同一个 id 上计过数。
+  StreamMetrics::Reset();
+
+  boost::asio::io_context io_context;
+  boost::asio::io_context::work work(io_context);
+  carla::ThreadGroup threads;
+  threads.CreateThreads(2u, [&]() { io_context.run(); });
+
+  carla::streaming::low_level::Server<tcp::Server> srv(io_context, TESTING_PORT);
+  srv.SetTimeout(1s);
+  srv.SetSynchronousMode(true);
+  auto stream = srv.MakeStream();
+  const auto id = token_type(stream.token()).get_stream_id();
+
+  std::atomic_size_t message_count{0u};
+  carla::streaming::low_level::Client<tcp::Client> c;
+  c.Subscribe(io_context, stream.token(), [&](auto) { ++message_count; });
+
+  // 等待客户端连接。
+  for (auto i = 0u; i < 100u && !stream.AreClientsListening(); ++i) {
+    std::this_thread::sleep_for(10ms);
+  }
+  ASSERT_TRUE(stream.AreClientsListening());
+
+  carla::Buffer buffer(boost::asio::buffer(message_text.c_str(), message_text.size()));
+  carla::SharedBufferView view = carla::BufferView::CreateFrom(std::move(buffer));
+  for (auto i = 0u; i < number_of_messages; ++i) {
+    carla::SharedBufferView message = view;
+    stream.Write(message);
+  }
+  for (auto i = 0u; i < 200u && message_count < number_of_messages; ++i) {
+    std::this_thread::sleep_for(10ms);
+  }
+  ASSERT_EQ(message_count, number_of_messages);
+
+  // 发送计数在写入完成的回调中更新，可能晚于客户端收到最后一条消息。
+  auto stats = StreamMetrics::GetStatistics(id);
+  for (auto i = 0u; i < 200u && stats.messages_sent < number_of_messages; ++i) {
+    std::this_thread::sleep_for(10ms);
+    stats = StreamMetrics::GetStatistics(id);
+  }
+  ASSERT_EQ(stats.messages_sent, number_of_messages);
+  ASSERT_EQ(stats.bytes_sent, number_of_messages * message_text.size());
+  ASSERT_EQ(stats.messages_dropped, 0u);
+  ASSERT_EQ(stats.write_wait_count, number_of_messages);
+  ASSERT_EQ(stats.messages_received, number_of_messages);
+  ASSERT_EQ(stats.bytes_received, number_of_messages * message_text.size());
+  ASSERT_EQ(stats.reconnects, 0u);
+
+  io_context.stop();
+}
+
+TEST(stream_metrics, http_endpoint) {
+  const auto id = NextStreamId();
+  StreamMetrics::Get(id)->RecordReceived(42u);
+
+  ASSERT_TRUE(StreamMetrics::StartServer(0u));
+  const auto port = StreamMetrics::GetServerPort();
+  ASSERT_NE(port, 0u);
+
+  const auto request = [port](const std::string &path) {
+    using boost::asio::ip::tcp;
+    boost::asio::io_context io_context;
+    tcp::socket socket(io_context);
+    socket.connect({boost::asio::ip::make_address("127.0.0.1"), port});
+    const std::string text = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    boost::asio::write(socket, boost::asio::buffer(text));
+    std::string response;
+    boost::system::error_code ec;
+    boost::asio::read(socket, boost::asio::dynamic_buffer(response), ec);
+    return response;
+  };
+
+  const auto metrics = request("/metrics");
+  ASSERT_EQ(metrics.find("HTTP/1.1 200 OK\r\n"), 0u);
+  ASSERT_NE(metrics.find("text/plain; version=0.0.4"), std::string::npos);
+  const auto line = "carla_stream_bytes_received_total{stream_id=\"" + std::to_string(id) + "\"} 42\n";
+  ASSERT_NE(metrics.find(line), std::string::npos);
+  ASSERT_EQ(request("/other").find("HTTP/1.1 404"), 0u);
+
+  StreamMetrics::StopServer();
+  ASSERT_EQ(StreamMetrics::GetServerPort(), 0u);
+
+  // 错误通过返回值报告，服务器端不启用异常。
+  ASSERT_FALSE(StreamMetrics::StartServer(0u, "not an address"));
+  ASSERT_EQ(StreamMetrics::GetServerPort(), 0u);
+}
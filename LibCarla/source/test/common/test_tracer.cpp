@@ -0,0 +1,184 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/profiler/Tracer.h>
+
+#include <sstream>
+#include <thread>
+
+using carla::profiler::Tracer;
+
+// 每个测试都从干净、关闭的状态开始。
+class TracerGuard {
+public:
+
+  TracerGuard() {
+    Tracer::Disable();
+    Tracer::Clear();
+  }
+
+  ~TracerGuard() {
+    Tracer::Disable();
+    Tracer::Clear();
+  }
+};
+
+static std::string Export() {
+  std::ostringstream out;
+  Tracer::ExportChromeTrace(out);
+  return out.str();
+}
+
+static size_t CountOccurrences(const std::string &str, const std::string &pattern) {
+  size_t count = 0u;
+  for (auto pos = str.find(pattern); pos != std::string::npos; pos = str.find(pattern, pos + 1u)) {
+    ++count;
+  }
+  return count;
+}
+
+TEST(tracer, disabled_records_nothing) {
+  TracerGuard guard;
+  const auto before = Tracer::GetEventCount();
+  {
+    CARLA_TRACE_SCOPE("test", "disabled_span");
+    CARLA_TRACE_COUNTER("test", "disabled_counter", 1);
+    CARLA_TRACE_INSTANT("test", "disabled_instant");
+  }
+  ASSERT_EQ(Tracer::GetEventCount(), before);
+  ASSERT_EQ(Export().find("disabled_"), std::string::npos);
+}
+
+TEST(tracer, span_enabled_at_construction) {
+  TracerGuard guard;
+  Tracer::Enable();
+  {
+    CARLA_TRACE_SCOPE("test", "outer_span");
+    // 作用域结束前关闭追踪，区间仍然被记录。
+    Tracer::Disable();
+  }
+  {
+    Tracer::Disable();
+    CARLA_TRACE_SCOPE("test", "never_recorded");
+    Tracer::Enable();
+  }
+  ASSERT_EQ(Tracer::GetEventCount(), 1u);
+  const auto json = Export();
+  ASSERT_NE(json.find("\"outer_span\""), std::string::npos);
+  ASSERT_EQ(json.find("never_recorded"), std::string::npos);
+}
+
+TEST(tracer, export_chrome_trace) {
+  TracerGuard guard;
+  Tracer::Enable();
+  Tracer::SetThreadName("test \"main\"");
+  {
+    const std::string name = "string_span";
+    CARLA_TRACE_SCOPE("test", name);
+  }
+  CARLA_TRACE_COUNTER("test", "some_counter", 42);
+  CARLA_TRACE_INSTANT("test", "some_instant");
+  Tracer::RecordSpan("test", "this_name_is_longer_than_the_maximum_name_length", 1000u, 3000u);
+  const auto json = Export();
+  ASSERT_EQ(json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["), 0u);
+  ASSERT_NE(json.find("\"string_span\""), std::string::npos);
+  ASSERT_NE(json.find("\"ph\":\"X\""), std::string::npos);
+  ASSERT_NE(json.find("\"some_counter\""), std::string::npos);
+  ASSERT_NE(json.find("\"args\":{\"value\":42.000}"), std::string::npos);
+  ASSERT_NE(json.find("\"some_instant\""), std::string::npos);
+  ASSERT_NE(json.find("\"ph\":\"i\""), std::string::npos);
+  ASSERT_NE(json.find("\"thread_name\""), std::string::npos);
+  ASSERT_NE(json.find("\"test \\\"main\\\"\""), std::string::npos);
+  ASSERT_NE(json.find("\"dur\":2.000"), std::string::npos);
+  // 名称被截断。
+  const std::string truncated(std::string("this_name_is_longer_than_the_maximum_name_length"), 0u, Tracer::MAX_NAME_LENGTH);
+  ASSERT_NE(json.find("\"" + truncated + "\""), std::string::npos);
+  ASSERT_EQ(json.find("this_name_is_longer_than_the_maximum_name_length"), std::string::npos);
+}
+
+TEST(tracer, multiple_threads) {
+  TracerGuard guard;
+  Tracer::Enable();
+  constexpr auto number_of_threads = 4u;
+  constexpr auto number_of_spans = 1000u;
+  std::vector<std::thread> threads;
+  for (auto i = 0u; i < number_of_threads; ++i) {
+    threads.emplace_back([i]() {
+      Tracer::SetThreadName("worker_" + std::to_string(i));
+      for (auto j = 0u; j < number_of_spans; ++j) {
+        CARLA_TRACE_SCOPE("test", "worker_span");
+      }
+    });
+  }
+  // 写入的同时导出，不应出现错误。
+  for (auto i = 0u; i < 10u; ++i) {
+    Export();
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  // 线程退出后事件仍然保留。
+  const auto json = Export();
+  ASSERT_EQ(CountOccurrences(json, "\"worker_span\""), number_of_threads * number_of_spans);
+  for (auto i = 0u; i < number_of_threads; ++i) {
+    ASSERT_NE(json.find("\"worker_" + std::to_string(i) + "\""), std::string::npos);
+  }
+  Tracer::Clear();
+  ASSERT_EQ(Export().find("worker_span"), std::string::npos);
+}
+
+TEST(tracer, ring_buffer_overflow) {
+  TracerGuard guard;
+  Tracer::Enable();
+  std::thread thread([]() {
+    constexpr auto total = Tracer::EVENTS_PER_THREAD + 100u;
+    for (auto i = 0u; i < total; ++i) {
+      Tracer::RecordSpan("test", i < 100u ? "overwritten" : "kept", i, i + 1u);
+    }
+    ASSERT_EQ(Tracer::GetEventCount(), total);
+  });
+  thread.join();
+  const auto json = Export();
+  ASSERT_EQ(CountOccurrences(json, "\"overwritten\""), 0u);
+  ASSERT_EQ(CountOccurrences(json, "\"kept\""), Tracer::EVENTS_PER_THREAD);
+}
+
+TEST(tracer, clear) {
+  TracerGuard guard;
+  Tracer::Enable();
+  CARLA_TRACE_INSTANT("test", "before_clear");
+  Tracer::Clear();
+  ASSERT_EQ(Tracer::GetEventCount(), 0u);
+  CARLA_TRACE_INSTANT("test", "after_clear");
+  ASSERT_EQ(Tracer::GetEventCount(), 1u);
+  const auto json = Export();
+  ASSERT_EQ(json.find("before_clear"), std::string::npos);
+  ASSERT_NE(json.find("after_clear"), std::string::npos);
+}
+
+TEST(tracer, thread_name_without_events) {
+  TracerGuard guard;
+  // 追踪关闭时命名线程不分配缓冲区，没有事件的线程不出现在导出结果中。
+  std::thread idle([]() {
+    Tracer::SetThreadName("idle_thread");
+    ASSERT_EQ(Tracer::GetEventCount(), 0u);
+  });
+  idle.join();
+  ASSERT_EQ(Export().find("idle_thread"), std::string::npos);
+
+  // 名称在之后第一次记录事件时生效。
+  std::thread named_later([]() {
+    Tracer::SetThreadName("late_thread");
+    Tracer::Enable();
+    CARLA_TRACE_INSTANT("test", "late_instant");
+  });
+  named_later.join();
+  const auto json = Export();
+  ASSERT_NE(json.find("\"late_thread\""), std::string::npos);
+  ASSERT_NE(json.find("\"late_instant\""), std::string::npos);
+}
@@ -0,0 +1,157 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "Random.h"
+
+#include <carla/StopWatch.h>
+#include <carla/geom/Math.h>
+#include <carla/sensor/V2XPairIndex.h>
+#include <carla/sensor/V2XPathLoss.h>
+
+#include <cmath>
+
+using carla::geom::Location;
+using carla::sensor::V2XObstacle;
+using carla::sensor::V2XPairIndex;
+using carla::sensor::V2XPathLoss;
+using carla::sensor::V2XPathLossModel;
+using carla::sensor::V2XPathLossParams;
+using carla::sensor::V2XPathState;
+using carla::sensor::V2XScenario;
+
+// 原来每个传感器对所有其它节点逐一计算距离。
+static std::vector<V2XPairIndex::Pair> FindPairsBruteForce(
+    const std::vector<Location> &positions,
+    float max_distance) {
+  std::vector<V2XPairIndex::Pair> pairs;
+  for (uint32_t i = 0u; i < positions.size(); ++i) {
+    for (uint32_t j = i + 1u; j < positions.size(); ++j) {
+      if (positions[i].Distance(positions[j]) < max_distance) {
+        pairs.emplace_back(i, j);
+      }
+    }
+  }
+  return pairs;
+}
+
+static std::vector<Location> MakePositions(size_t count, float extent) {
+  std::vector<Location> positions;
+  positions.reserve(count);
+  for (auto i = 0u; i < count; ++i) {
+    auto location = util::Random::Location(-extent, extent);
+    location.z = static_cast<float>(util::Random::Uniform(0.0, 5.0));
+    positions.emplace_back(location);
+  }
+  return positions;
+}
+
+TEST(v2x_channel, winner_path_loss) {
+  const double f = 5.9;
+  ASSERT_NEAR(V2XPathLoss::Winner(V2XPathState::LOS, V2XScenario::Urban, 100.0, f),
+              38.77 + 16.7 * 2.0 + 18.2 * std::log10(f), 1e-4);
+  ASSERT_NEAR(V2XPathLoss::Winner(V2XPathState::NLOSv, V2XScenario::Highway, 10.0, f),
+              32.4 + 20.0 + 20.0 * std::log10(f), 1e-4);
+  ASSERT_NEAR(V2XPathLoss::Winner(V2XPathState::NLOSb, V2XScenario::Highway, 1000.0, f),
+              36.85 + 90.0 + 18.9 * std::log10(f), 1e-4);
+  // 路径损耗随距离增加。
+  ASSERT_LT(V2XPathLoss::Winner(V2XPathState::LOS, V2XScenario::Rural, 50.0, f),
+            V2XPathLoss::Winner(V2XPathState::LOS, V2XScenario::Rural, 60.0, f));
+}
+
+TEST(v2x_channel, free_space_and_two_ray) {
+  const double lambda = V2XPathLoss::Wavelength(5.9);
+  ASSERT_NEAR(lambda, 0.0508, 1e-4);
+  ASSERT_NEAR(V2XPathLoss::FreeSpace(1.0, lambda), V2XPathLoss::FreeSpaceAtReference(1.0, 5.9), 1e-9);
+  // 距离加倍，自由空间损耗增加约 6 dB。
+  ASSERT_NEAR(V2XPathLoss::FreeSpace(200.0, lambda) - V2XPathLoss::FreeSpace(100.0, lambda), 6.0206, 1e-3);
+  ASSERT_NEAR(V2XPathLoss::LogDistance(47.0, 2.7, 100.0, 1.0), 47.0 + 54.0, 1e-9);
+
+  // 远距离时完整的双射线模型趋近于简化模型。
+  const double d = 50000.0;
+  ASSERT_NEAR(V2XPathLoss::TwoRay(d, 1.5, 1.5, lambda), V2XPathLoss::TwoRaySimple(d, 1.5, 1.5), 0.1);
+  ASSERT_TRUE(std::isfinite(V2XPathLoss::TwoRay(30.0, 1.5, 2.0, lambda)));
+}
+
+TEST(v2x_channel, vehicle_blockage) {
+  const double lambda = V2XPathLoss::Wavelength(5.9);
+  // v = 0 时为 6.9 + 20 log10(sqrt(1.01) - 0.1)。
+  ASSERT_NEAR(V2XPathLoss::VehicleDiffraction(10.0, 10.0, 0.0, lambda),
+              6.9 + 20.0 * std::log10(std::sqrt(1.01) - 0.1), 1e-9);
+  // 车辆远低于视线时没有损耗。
+  ASSERT_EQ(V2XPathLoss::VehicleDiffraction(10.0, 10.0, -1.0, lambda), 0.0);
+
+  const V2XObstacle obstacles[] = {{10.0, 0.0, 0.2}, {50.0, 0.0, 0.5}, {90.0, 0.0, 0.1}};
+  const double expected = V2XPathLoss::VehicleDiffraction(50.0, 50.0, 0.5, lambda);
+  ASSERT_NEAR(V2XPathLoss::VehicleBlockage(0.0, 0.0, 100.0, 0.0, obstacles, 3u, lambda), expected, 1e-9);
+  ASSERT_EQ(V2XPathLoss::VehicleBlockage(0.0, 0.0, 100.0, 0.0, obstacles, 0u, lambda), 0.0);
+
+  V2XPathLossParams params;
+  params.model = V2XPathLossModel::Winner;
+  params.scenario = V2XScenario::Urban;
+  const double los = V2XPathLoss::Compute(params, V2XPathState::LOS, 100.0, 0.0, 0.0, 1.5, 100.0, 0.0, 1.5, obstacles, 3u);
+  const double nlosv = V2XPathLoss::Compute(params, V2XPathState::NLOSv, 100.0, 0.0, 0.0, 1.5, 100.0, 0.0, 1.5, obstacles, 3u);
+  ASSERT_NEAR(nlosv - los, expected, 1e-4);
+
+  params.model = V2XPathLossModel::Geometric;
+  const double nlosb = V2XPathLoss::Compute(params, V2XPathState::NLOSb, 100.0, 0.0, 0.0, 1.5, 100.0, 0.0, 1.5, nullptr, 0u);
+  ASSERT_NEAR(nlosb, V2XPathLoss::FreeSpace(1.0, V2XPathLoss::Wavelength(5.9)) + 27.0 * 2.0, 1e-9);
+}
+
+TEST(v2x_channel, shadow_fading) {
+  ASSERT_EQ(V2XPathLoss::ShadowFadingStdDev(V2XPathState::LOS, V2XScenario::Highway, true, 0.0f), 3.3f);
+  ASSERT_EQ(V2XPathLoss::ShadowFadingStdDev(V2XPathState::LOS, V2XScenario::Rural, true, 0.0f), 4.25f);
+  ASSERT_EQ(V2XPathLoss::ShadowFadingStdDev(V2XPathState::NLOSb, V2XScenario::Highway, true, 0.0f), 6.8f);
+  ASSERT_EQ(V2XPathLoss::ShadowFadingStdDev(V2XPathState::NLOSv, V2XScenario::Urban, true, 0.0f), 5.3f);
+  ASSERT_EQ(V2XPathLoss::ShadowFadingStdDev(V2XPathState::NLOSv, V2XScenario::Urban, false, 1.5f), 1.5f);
+}
+
+TEST(v2x_channel, pairs_match_brute_force) {
+  V2XPairIndex index;
+  std::vector<V2XPairIndex::Pair> pairs;
+  for (const float max_distance : {5.0f, 50.0f, 500.0f, 5000.0f}) {
+    const auto positions = MakePositions(300u, 400.0f);
+    index.FindPairs(positions.data(), positions.size(), max_distance, pairs);
+    ASSERT_EQ(pairs, FindPairsBruteForce(positions, max_distance)) << max_distance;
+  }
+  // 负坐标与网格边界。
+  const std::vector<Location> positions = {{-1.0f, -1.0f, 0.0f}, {1.0f, 1.0f, 0.0f}, {-3.0f, 0.0f, 0.0f}};
+  index.FindPairs(positions.data(), positions.size(), 3.0f, pairs);
+  ASSERT_EQ(pairs, (std::vector<V2XPairIndex::Pair>{{0u, 1u}, {0u, 2u}}));
+  index.FindPairs(positions.data(), 1u, 3.0f, pairs);
+  ASSERT_TRUE(pairs.empty());
+}
+
+TEST(v2x_channel, benchmark_pairs) {
+  constexpr auto number_of_nodes = 2000u;
+  constexpr auto iterations = 10u;
+  constexpr float max_distance = 300.0f;
+  const auto positions = MakePositions(number_of_nodes, 2500.0f);
+
+  size_t brute_force_count = 0u;
+  carla::StopWatch brute_force_watch;
+  for (auto i = 0u; i < iterations; ++i) {
+    brute_force_count += FindPairsBruteForce(positions, max_distance).size();
+  }
+  brute_force_watch.Stop();
+
+  V2XPairIndex index;
+  std::vector<V2XPairIndex::Pair> pairs;
+  size_t index_count = 0u;
+  carla::StopWatch index_watch;
+  for (auto i = 0u; i < iterations; ++i) {
+    index.FindPairs(positions.data(), positions.size(), max_distance, pairs);
+    index_count += pairs.size();
+  }
+  index_watch.Stop();
+
+  ASSERT_EQ(index_count, brute_force_count);
+  carla::logging::log(
+      "v2x pairs over", number_of_nodes, "nodes (us/tick): brute force",
+      brute_force_watch.GetElapsedTime<std::chrono::microseconds>() / iterations,
+      "spatial hash", index_watch.GetElapsedTime<std::chrono::microseconds>() / iterations,
+      "pairs", pairs.size());
+}
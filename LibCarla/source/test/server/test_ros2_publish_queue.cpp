@@ -0,0 +1,87 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/ThreadGroup.h>
+#include <carla/ros2/ROS2PublishQueue.h>
+
+#include <atomic>
+#include <vector>
+
+using carla::ros2::ROS2PublishQueue;
+using carla::ros2::ROS2TopicStats;
+
+TEST(ros2_publish_queue, runs_in_order_without_thread) {
+  ROS2PublishQueue queue(4u);
+  ASSERT_EQ(queue.GetCapacity(), 4u);
+  auto stats = std::make_shared<ROS2TopicStats>();
+  std::vector<int> result;
+  for (int i = 0; i < 6; ++i) {
+    queue.Push([&result, i]() { result.push_back(i); return i != 2; }, stats);
+  }
+  // 发布线程未启动，超出容量的任务被丢弃。
+  ASSERT_TRUE(result.empty());
+  ASSERT_EQ(stats->dropped, 2u);
+  queue.Flush();
+  ASSERT_EQ(result, (std::vector<int>{0, 1, 2, 3}));
+  ASSERT_EQ(stats->published, 3u);
+  ASSERT_EQ(stats->failed, 1u);
+
+  // 出队后槽位可以重复使用。
+  queue.Push([&result]() { result.push_back(4); return true; });
+  queue.Flush();
+  ASSERT_EQ(result.back(), 4);
+}
+
+TEST(ros2_publish_queue, multiple_producers) {
+  constexpr size_t number_of_producers = 4u;
+  constexpr size_t tasks_per_producer = 20000u;
+  ROS2PublishQueue queue(64u);
+  queue.Start();
+  ASSERT_TRUE(queue.IsRunning());
+
+  std::vector<std::shared_ptr<ROS2TopicStats>> stats;
+  std::vector<std::vector<size_t>> received(number_of_producers);
+  for (size_t i = 0u; i < number_of_producers; ++i) {
+    stats.emplace_back(std::make_shared<ROS2TopicStats>());
+  }
+  std::atomic<size_t> next_producer{0u};
+  {
+    carla::ThreadGroup producers;
+    producers.CreateThreads(number_of_producers, [&]() {
+      const size_t producer = next_producer++;
+      for (size_t j = 0u; j < tasks_per_producer; ++j) {
+        // 只有发布线程访问 received，不需要加锁。
+        queue.Push([&received, producer, j]() {
+          received[producer].push_back(j);
+          return true;
+        }, stats[producer]);
+      }
+    });
+  }
+  queue.Flush();
+
+  for (size_t i = 0u; i < number_of_producers; ++i) {
+    const auto &values = received[i];
+    ASSERT_EQ(values.size() + stats[i]->dropped, tasks_per_producer);
+    ASSERT_EQ(values.size(), stats[i]->published);
+    // 同一个生产者的任务按入队顺序执行。
+    for (size_t j = 1u; j < values.size(); ++j) {
+      ASSERT_LT(values[j - 1u], values[j]);
+    }
+    ASSERT_GE(stats[i]->max_latency_ns, stats[i]->last_latency_ns);
+  }
+
+  // Stop 会先执行完已入队的任务。
+  std::atomic<size_t> count{0u};
+  for (size_t i = 0u; i < 32u; ++i) {
+    queue.Push([&count]() { ++count; return true; });
+  }
+  queue.Stop();
+  ASSERT_FALSE(queue.IsRunning());
+  ASSERT_EQ(count, 32u);
+}
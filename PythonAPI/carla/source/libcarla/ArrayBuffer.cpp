@@ -0,0 +1,93 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+// ArrayBuffer：通过Python缓冲区协议（PEP 3118）导出传感器数组、批量路点等连续数组的零拷贝视图。
+// 视图持有数组所属Python对象的引用，保证底层内存在视图存活期间有效；
+// 配合格式串与步长，numpy.asarray() 可直接得到结构化数组或某一字段的跨步数组。
+#if PY_MAJOR_VERSION >= 3
+struct ArrayBufferObject {
+  PyObject_HEAD
+  PyObject *owner;      // 持有数组的Python对象
+  char *data;           // 首个元素（或字段）的地址
+  Py_ssize_t shape;     // 元素个数
+  Py_ssize_t stride;    // 相邻元素之间的字节数
+  Py_ssize_t itemsize;  // 单个元素（或字段）的字节数
+  const char *format;   // PEP 3118格式串，必须是静态字符串
+};
+
+static int ArrayBuffer_GetBuffer(PyObject *obj, Py_buffer *view, int flags) {
+  auto *self = reinterpret_cast<ArrayBufferObject *>(obj);
+  if ((flags & PyBUF_WRITABLE) == PyBUF_WRITABLE) {
+    PyErr_SetString(PyExc_BufferError, "array views are read-only");
+    return -1;
+  }
+  // 跨步视图无法以连续内存的形式导出。
+  if (((flags & PyBUF_STRIDES) != PyBUF_STRIDES) && (self->stride != self->itemsize)) {
+    PyErr_SetString(PyExc_BufferError, "array view is not contiguous");
+    return -1;
+  }
+  view->buf = self->data;
+  view->obj = obj;
+  Py_INCREF(obj);
+  view->len = self->shape * self->itemsize;
+  view->readonly = 1;
+  view->itemsize = self->itemsize;
+  view->format = ((flags & PyBUF_FORMAT) == PyBUF_FORMAT) ? const_cast<char *>(self->format) : nullptr;
+  view->ndim = 1;
+  view->shape = ((flags & PyBUF_ND) == PyBUF_ND) ? &self->shape : nullptr;
+  view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? &self->stride : nullptr;
+  view->suboffsets = nullptr;
+  view->internal = nullptr;
+  return 0;
+}
+
+static void ArrayBuffer_Dealloc(PyObject *obj) {
+  auto *self = reinterpret_cast<ArrayBufferObject *>(obj);
+  Py_XDECREF(self->owner);
+  Py_TYPE(obj)->tp_free(obj);
+}
+
+static PyBufferProcs ArrayBufferProcs = { ArrayBuffer_GetBuffer, nullptr };
+
+static PyTypeObject ArrayBufferType = { PyVarObject_HEAD_INIT(nullptr, 0) };
+
+static void RegisterArrayBufferType() {
+  if ((ArrayBufferType.tp_flags & Py_TPFLAGS_READY) == Py_TPFLAGS_READY) {
+    return;
+  }
+  ArrayBufferType.tp_name = "carla.libcarla.ArrayBuffer";
+  ArrayBufferType.tp_basicsize = sizeof(ArrayBufferObject);
+  ArrayBufferType.tp_dealloc = ArrayBuffer_Dealloc;
+  ArrayBufferType.tp_as_buffer = &ArrayBufferProcs;
+  ArrayBufferType.tp_flags = Py_TPFLAGS_DEFAULT;
+  ArrayBufferType.tp_doc = "Read-only zero-copy view over a LibCarla array.";
+  if (PyType_Ready(&ArrayBufferType) < 0) {
+    boost::python::throw_error_already_set();
+  }
+}
+
+static boost::python::object MakeArrayBufferView(
+    boost::python::object owner,
+    char *data,
+    Py_ssize_t shape,
+    Py_ssize_t stride,
+    Py_ssize_t itemsize,
+    const char *format) {
+  auto *self = PyObject_New(ArrayBufferObject, &ArrayBufferType);
+  if (self == nullptr) {
+    boost::python::throw_error_already_set();
+  }
+  self->owner = boost::python::incref(owner.ptr());
+  self->data = data;
+  self->shape = shape;
+  self->stride = stride;
+  self->itemsize = itemsize;
+  self->format = format;
+  boost::python::handle<> buffer(reinterpret_cast<PyObject *>(self));
+  // 返回memoryview，其通过buffer.obj持有ArrayBuffer，进而持有数组所属的对象。
+  return boost::python::object(boost::python::handle<>(PyMemoryView_FromObject(buffer.get())));
+}
+#endif // PY_MAJOR_VERSION >= 3
@@ -209,9 +209,20 @@ void export_client() {
     .def_readwrite("enable_pedestrian_navigation", &rpc::OpendriveGenerationParameters::enable_pedestrian_navigation)
   ;
 
+  class_<cc::detail::CallbackQueueStats>("CallbackStats", no_init)
+    .def_readonly("depth", &cc::detail::CallbackQueueStats::depth)
+    .def_readonly("max_depth", &cc::detail::CallbackQueueStats::max_depth)
+    .def_readonly("executed", &cc::detail::CallbackQueueStats::executed)
+    .def_readonly("coalesced", &cc::detail::CallbackQueueStats::coalesced)
+    .def_readonly("dropped", &cc::detail::CallbackQueueStats::dropped)
+    .def_readonly("total_latency_us", &cc::detail::CallbackQueueStats::total_latency_us)
+    .def_readonly("max_latency_us", &cc::detail::CallbackQueueStats::max_latency_us)
+  ;
+
   class_<cc::Client>("Client",
-      init<std::string, uint16_t, size_t>((arg("host")="127.0.0.1", arg("port")=2000, arg("worker_threads")=0u)))
+      init<std::string, uint16_t, size_t, size_t>((arg("host")="127.0.0.1", arg("port")=2000, arg("worker_threads")=0u, arg("callback_threads")=1u)))
     .def("set_timeout", &::SetTimeout, (arg("seconds")))
+    .def("get_callback_stats", &cc::Client::GetCallbackStats)
     .def("get_client_version", &cc::Client::GetClientVersion)
     .def("get_server_version", CONST_CALL_WITHOUT_GIL(cc::Client, GetServerVersion))
     .def("get_world", &cc::Client::GetWorld)
@@ -235,6 +246,7 @@ void export_client() {
     .def("set_replayer_time_factor", &cc::Client::SetReplayerTimeFactor, (arg("time_factor")))
     .def("set_replayer_ignore_hero", &cc::Client::SetReplayerIgnoreHero, (arg("ignore_hero")))
     .def("set_replayer_ignore_spectator", &cc::Client::SetReplayerIgnoreSpectator, (arg("ignore_spectator")))
+    .def("set_recorder_compression", &cc::Client::SetRecorderCompression, (arg("enabled")))
     .def("apply_batch", &ApplyBatchCommands, (arg("commands"), arg("do_tick")=false))
     .def("apply_batch_sync", &ApplyBatchCommandsSync, (arg("commands"), arg("do_tick")=false))
     .def("get_trafficmanager", CONST_CALL_WITHOUT_GIL_1(cc::Client, GetInstanceTM, uint16_t), (arg("port")=ctm::TM_DEFAULT_PORT))
@@ -12,10 +12,12 @@
 #include <carla/client/Junction.h>
 #include <carla/client/Map.h>
 #include <carla/client/Waypoint.h>
+#include <carla/client/WaypointBatch.h>
 #include <carla/road/element/LaneMarking.h>
 #include <carla/client/Landmark.h>
 #include <carla/road/SignalType.h>
 
+#include <cstddef>
 #include <ostream>
 #include <fstream>
 
@@ -109,6 +111,112 @@ static carla::geom::GeoLocation ToGeolocation(
   return self.GetGeoReference().Transform(location);
 }
 
+// 批量路点句柄与变换在内存中的布局，与下面的 PEP 3118 格式串对应
+static_assert(sizeof(carla::client::WaypointHandle) == 24u, "unexpected waypoint handle layout");
+static_assert(offsetof(carla::client::WaypointHandle, s) == 16u, "unexpected waypoint handle layout");
+static_assert(sizeof(carla::geom::Transform) == 24u, "unexpected transform layout");
+
+// 把位置序列（carla.Location 或形如 (x, y, z) 的元素，例如 N×3 的 numpy 数组）转换为 vector
+static std::vector<carla::geom::Location> ToLocationVector(boost::python::object locations) {
+  namespace py = boost::python;
+  std::vector<carla::geom::Location> result;
+  const auto size = py::len(locations);
+  result.reserve(size);
+  for (auto i = 0; i < size; ++i) {
+    py::object item = locations[i];
+    py::extract<carla::geom::Location> location(item);
+    if (location.check()) {
+      result.emplace_back(location());
+    } else {
+      result.emplace_back(
+          py::extract<float>(item[0])(),
+          py::extract<float>(item[1])(),
+          py::extract<float>(item[2])());
+    }
+  }
+  return result;
+}
+
+// 批量查找位置对应的路点
+static carla::client::WaypointBatch GetWaypointBatch(
+    const carla::client::Map &self,
+    boost::python::object locations,
+    bool project_to_road,
+    carla::road::Lane::LaneType lane_type) {
+  auto input = ToLocationVector(locations);
+  carla::PythonUtil::ReleaseGIL unlock;
+  return self.GetWaypointBatch(input, project_to_road, static_cast<int32_t>(lane_type));
+}
+
+static carla::client::WaypointBatch GenerateWaypointBatch(const carla::client::Map &self, double distance) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  return self.GenerateWaypointBatch(distance);
+}
+
+static carla::client::WaypointBatch GetNextBatch(
+    const carla::client::Map &self,
+    const carla::client::WaypointBatch &batch,
+    double distance) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  return self.GetNextBatch(batch.waypoints, distance);
+}
+
+static carla::client::WaypointBatch GetPreviousBatch(
+    const carla::client::Map &self,
+    const carla::client::WaypointBatch &batch,
+    double distance) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  return self.GetPreviousBatch(batch.waypoints, distance);
+}
+
+// 由批量结果中的第 index 个路点创建 carla.Waypoint
+static carla::SharedPtr<carla::client::Waypoint> MakeWaypointFromBatch(
+    const carla::client::Map &self,
+    const carla::client::WaypointBatch &batch,
+    int index) {
+  if (index < 0) {
+    index += static_cast<int>(batch.size());
+  }
+  if (index < 0 || static_cast<size_t>(index) >= batch.size()) {
+    PyErr_SetString(PyExc_IndexError, "waypoint batch index out of range");
+    boost::python::throw_error_already_set();
+  }
+  return self.MakeWaypoint(batch.waypoints[index]);
+}
+
+// 批量结果中各数组的只读零拷贝视图，numpy.asarray() 可直接得到结构化数组
+template <typename T>
+static boost::python::object GetWaypointBatchView(
+    boost::python::object self,
+    std::vector<T> carla::client::WaypointBatch::*member,
+    const char *format) {
+#if PY_MAJOR_VERSION >= 3
+  carla::client::WaypointBatch &batch = boost::python::extract<carla::client::WaypointBatch &>(self);
+  auto &array = batch.*member;
+  return MakeArrayBufferView(
+      self,
+      reinterpret_cast<char *>(array.data()),
+      static_cast<Py_ssize_t>(array.size()),
+      static_cast<Py_ssize_t>(sizeof(T)),
+      static_cast<Py_ssize_t>(sizeof(T)),
+      format);
+#else
+  throw std::runtime_error("waypoint batch views require Python 3");
+#endif
+}
+
+static boost::python::object GetWaypointBatchWaypoints(boost::python::object self) {
+  return GetWaypointBatchView(self, &carla::client::WaypointBatch::waypoints, "T{=I:road_id:I:section_id:i:lane_id:4x:d:s:}");
+}
+
+static boost::python::object GetWaypointBatchTransforms(boost::python::object self) {
+  return GetWaypointBatchView(self, &carla::client::WaypointBatch::transforms, "T{=f:x:f:y:f:z:f:pitch:f:yaw:f:roll:}");
+}
+
+static boost::python::object GetWaypointBatchSource(boost::python::object self) {
+  return GetWaypointBatchView(self, &carla::client::WaypointBatch::source, "I");
+}
+
 void export_map() {
   using namespace boost::python;
   namespace cc = carla::client;
@@ -185,6 +293,17 @@ void export_map() {
   // -- Map --------------------------------------------------------------------
   // ===========================================================================
 
+#if PY_MAJOR_VERSION >= 3
+  RegisterArrayBufferType();
+#endif
+
+  class_<cc::WaypointBatch>("WaypointBatch", no_init)
+    .def("__len__", &cc::WaypointBatch::size)
+    .add_property("waypoints", &GetWaypointBatchWaypoints)
+    .add_property("transforms", &GetWaypointBatchTransforms)
+    .add_property("source", &GetWaypointBatchSource)
+  ;
+
   class_<cc::Map, boost::noncopyable, boost::shared_ptr<cc::Map>>("Map", no_init)
     .def(init<std::string, std::string>((arg("name"), arg("xodr_content"))))
     .add_property("name", CALL_RETURNING_COPY(cc::Map, GetName))
@@ -193,6 +312,11 @@ void export_map() {
     .def("get_waypoint_xodr", &cc::Map::GetWaypointXODR, (arg("road_id"), arg("lane_id"), arg("s")))
     .def("get_topology", &GetTopology)
     .def("generate_waypoints", CALL_RETURNING_LIST_1(cc::Map, GenerateWaypoints, double), (args("distance")))
+    .def("generate_waypoint_batch", &GenerateWaypointBatch, (arg("distance")))
+    .def("get_waypoint_batch", &GetWaypointBatch, (arg("locations"), arg("project_to_road")=true, arg("lane_type")=cr::Lane::LaneType::Driving))
+    .def("next_batch", &GetNextBatch, (arg("batch"), arg("distance")))
+    .def("previous_batch", &GetPreviousBatch, (arg("batch"), arg("distance")))
+    .def("make_waypoint", &MakeWaypointFromBatch, (arg("batch"), arg("index")))
     .def("transform_to_geolocation", &ToGeolocation, (arg("location")))
     .def("to_opendrive", CALL_RETURNING_COPY(cc::Map, GetOpenDrive))
     .def("save_to_disk", &SaveOpenDriveToDisk, (arg("path")=""))
@@ -0,0 +1,102 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <carla/pointcloud/VoxelMap.h>
+#include <carla/sensor/data/LidarMeasurement.h>
+#include <carla/sensor/data/SemanticLidarMeasurement.h>
+
+namespace carla {
+namespace pointcloud {
+
+  std::ostream &operator<<(std::ostream &out, const VoxelCloud &cloud) {
+    out << "VoxelCloud(number_of_points=" << std::to_string(cloud.points.size()) << ')';
+    return out;
+  }
+
+} // namespace pointcloud
+} // namespace carla
+
+static boost::shared_ptr<carla::pointcloud::VoxelMap> MakeVoxelMap(
+    float voxel_size,
+    double max_age,
+    float max_distance,
+    size_t threads) {
+  if (!(voxel_size > 0.0f)) {
+    throw std::invalid_argument("voxel_size must be positive");
+  }
+  carla::pointcloud::VoxelMap::Options options;
+  options.voxel_size = voxel_size;
+  options.max_age = max_age;
+  options.max_distance = max_distance;
+  options.threads = threads;
+  return boost::make_shared<carla::pointcloud::VoxelMap>(options);
+}
+
+// 快照不可变，Python 端持有的对象与 VoxelMap 之后的修改无关
+static boost::shared_ptr<carla::pointcloud::VoxelCloud> GetVoxelCloud(carla::pointcloud::VoxelMap &self) {
+  carla::SharedPtr<const carla::pointcloud::VoxelCloud> cloud;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    cloud = self.GetCloud();
+  }
+  return boost::const_pointer_cast<carla::pointcloud::VoxelCloud>(cloud);
+}
+
+// 体素数组的只读零拷贝视图，numpy.asarray() 可直接得到结构化数组
+static boost::python::object GetVoxelCloudPoints(boost::python::object self) {
+#if PY_MAJOR_VERSION >= 3
+  carla::pointcloud::VoxelCloud &cloud = boost::python::extract<carla::pointcloud::VoxelCloud &>(self);
+  return MakeArrayBufferView(
+      self,
+      reinterpret_cast<char *>(cloud.points.data()),
+      static_cast<Py_ssize_t>(cloud.points.size()),
+      static_cast<Py_ssize_t>(sizeof(carla::pointcloud::VoxelPoint)),
+      static_cast<Py_ssize_t>(sizeof(carla::pointcloud::VoxelPoint)),
+      "T{=f:x:f:y:f:z:f:intensity:I:tag:I:count:}");
+#else
+  throw std::runtime_error("voxel cloud views require Python 3");
+#endif
+}
+
+void export_pointcloud() {
+  using namespace boost::python;
+  namespace cp = carla::pointcloud;
+  namespace csd = carla::sensor::data;
+
+  class_<cp::VoxelCloud, boost::noncopyable, boost::shared_ptr<cp::VoxelCloud>>("VoxelCloud", no_init)
+    .def("__len__", +[](const cp::VoxelCloud &self) { return self.points.size(); })
+    .add_property("points", &GetVoxelCloudPoints)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<cp::VoxelMap, boost::noncopyable, boost::shared_ptr<cp::VoxelMap>>("VoxelMap", no_init)
+    .def("__init__", make_constructor(
+        &MakeVoxelMap,
+        default_call_policies(),
+        (arg("voxel_size")=0.1f,
+         arg("max_age")=0.0,
+         arg("max_distance")=0.0f,
+         arg("threads")=0u)))
+    .add_property("voxel_size", +[](const cp::VoxelMap &self) { return self.GetOptions().voxel_size; })
+    .def("__len__", +[](const cp::VoxelMap &self) {
+      carla::PythonUtil::ReleaseGIL unlock;
+      return self.GetVoxelCount();
+    })
+    .def("add_lidar", +[](cp::VoxelMap &self, const csd::LidarMeasurement &measurement) {
+      carla::PythonUtil::ReleaseGIL unlock;
+      self.AddLidar(measurement);
+    }, (arg("measurement")))
+    .def("add_semantic_lidar", +[](cp::VoxelMap &self, const csd::SemanticLidarMeasurement &measurement) {
+      carla::PythonUtil::ReleaseGIL unlock;
+      self.AddSemanticLidar(measurement);
+    }, (arg("measurement")))
+    .def("clear", +[](cp::VoxelMap &self) {
+      carla::PythonUtil::ReleaseGIL unlock;
+      self.Clear();
+    })
+    .def("snapshot", &GetVoxelCloud)
+  ;
+}
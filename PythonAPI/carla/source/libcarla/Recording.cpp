@@ -0,0 +1,169 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <carla/recorder/Recording.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace carla {
+namespace recorder {
+
+  std::ostream &operator<<(std::ostream &out, const RecordedActor &actor) {
+    out << "RecordedActor(id=" << actor.id
+        << ", type=" << actor.description
+        << ", category=" << actor.GetCategory() << ')';
+    return out;
+  }
+
+  std::ostream &operator<<(std::ostream &out, const CollisionEvent &event) {
+    out << "CollisionEvent(time=" << std::to_string(event.time)
+        << ", actor1=" << event.actor1 << " (" << event.category1 << ')'
+        << ", actor2=" << event.actor2 << " (" << event.category2 << "))";
+    return out;
+  }
+
+  std::ostream &operator<<(std::ostream &out, const BlockedActor &blocked) {
+    out << "BlockedActor(id=" << blocked.id
+        << ", time=" << std::to_string(blocked.time)
+        << ", duration=" << std::to_string(blocked.duration) << ')';
+    return out;
+  }
+
+} // namespace recorder
+} // namespace carla
+
+static boost::shared_ptr<carla::recorder::Recording> MakeRecording(
+    const std::string &path,
+    double begin,
+    double end,
+    size_t threads) {
+  namespace cr = carla::recorder;
+  carla::PythonUtil::ReleaseGIL unlock;
+  cr::RecorderFile file(path);
+  cr::Recording::Options options;
+  options.begin = begin;
+  options.end = end;
+  options.threads = threads;
+  return boost::make_shared<cr::Recording>(file, options);
+}
+
+template <typename T>
+static boost::python::list ToList(const std::vector<T> &column) {
+  boost::python::list result;
+  for (const auto &value : column) {
+    result.append(value);
+  }
+  return result;
+}
+
+// 按列返回，可以直接构造 pandas.DataFrame
+static boost::python::dict GetTrajectory(const carla::recorder::Recording &self, uint32_t actor_id) {
+  const auto &trajectory = self.GetTrajectory(actor_id);
+  boost::python::list frames;
+  for (const auto index : trajectory.frame) {
+    frames.append(self.GetFrames()[index].id);
+  }
+  boost::python::dict result;
+  result["frame"] = frames;
+  result["time"] = ToList(trajectory.time);
+  result["x"] = ToList(trajectory.x);
+  result["y"] = ToList(trajectory.y);
+  result["z"] = ToList(trajectory.z);
+  result["roll"] = ToList(trajectory.roll);
+  result["pitch"] = ToList(trajectory.pitch);
+  result["yaw"] = ToList(trajectory.yaw);
+  return result;
+}
+
+static boost::python::dict GetActorAttributes(const carla::recorder::RecordedActor &self) {
+  boost::python::dict result;
+  for (const auto &attribute : self.attributes) {
+    result[attribute.first] = attribute.second;
+  }
+  return result;
+}
+
+static boost::python::list GetRecordedActors(const carla::recorder::Recording &self) {
+  std::vector<carla::recorder::RecordedActor> actors;
+  actors.reserve(self.GetActors().size());
+  for (const auto &item : self.GetActors()) {
+    actors.emplace_back(item.second);
+  }
+  std::sort(actors.begin(), actors.end(), [](const auto &a, const auto &b) { return a.id < b.id; });
+  return ToList(actors);
+}
+
+void export_recording() {
+  using namespace boost::python;
+  namespace cr = carla::recorder;
+
+  class_<cr::RecordedActor>("RecordedActor", no_init)
+    .def_readonly("id", &cr::RecordedActor::id)
+    .def_readonly("type_id", &cr::RecordedActor::description)
+    .add_property("category", &cr::RecordedActor::GetCategory)
+    .add_property("attributes", &GetActorAttributes)
+    .def_readonly("spawn_time", &cr::RecordedActor::spawn_time)
+    .def_readonly("destroy_time", &cr::RecordedActor::destroy_time)
+    .def_readonly("parent_id", &cr::RecordedActor::parent)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<cr::CollisionEvent>("RecordedCollision", no_init)
+    .def_readonly("time", &cr::CollisionEvent::time)
+    .def_readonly("frame", &cr::CollisionEvent::frame_id)
+    .def_readonly("actor1_id", &cr::CollisionEvent::actor1)
+    .def_readonly("actor2_id", &cr::CollisionEvent::actor2)
+    .def_readonly("actor1_category", &cr::CollisionEvent::category1)
+    .def_readonly("actor2_category", &cr::CollisionEvent::category2)
+    .def_readonly("actor1_type_id", &cr::CollisionEvent::description1)
+    .def_readonly("actor2_type_id", &cr::CollisionEvent::description2)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<cr::BlockedActor>("RecordedBlockedActor", no_init)
+    .def_readonly("id", &cr::BlockedActor::id)
+    .def_readonly("type_id", &cr::BlockedActor::description)
+    .def_readonly("time", &cr::BlockedActor::time)
+    .def_readonly("duration", &cr::BlockedActor::duration)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<cr::Recording, boost::noncopyable, boost::shared_ptr<cr::Recording>>("Recording", no_init)
+    .def("__init__", make_constructor(
+        &MakeRecording,
+        default_call_policies(),
+        (arg("path"),
+         arg("time_start")=0.0,
+         arg("time_end")=std::numeric_limits<double>::infinity(),
+         arg("threads")=0u)))
+    .add_property("map_name", +[](const cr::Recording &self) { return self.GetInfo().map; })
+    .add_property("version", +[](const cr::Recording &self) { return self.GetInfo().version; })
+    .add_property("date", +[](const cr::Recording &self) { return self.GetInfo().date; })
+    .add_property("frame_count", +[](const cr::Recording &self) { return self.GetFrames().size(); })
+    .add_property("duration", +[](const cr::Recording &self) {
+      return self.GetFrames().empty() ? 0.0 : self.GetFrames().back().elapsed;
+    })
+    .def("get_actors", &GetRecordedActors)
+    .def("get_trajectory", &GetTrajectory, (arg("actor_id")))
+    .def("query_collisions", +[](const cr::Recording &self, char category1, char category2) {
+      std::vector<cr::CollisionEvent> result;
+      {
+        carla::PythonUtil::ReleaseGIL unlock;
+        result = self.QueryCollisions(category1, category2);
+      }
+      return ToList(result);
+    }, (arg("category1")='a', arg("category2")='a'))
+    .def("query_blocked", +[](const cr::Recording &self, double min_time, double min_distance) {
+      std::vector<cr::BlockedActor> result;
+      {
+        carla::PythonUtil::ReleaseGIL unlock;
+        result = self.QueryBlocked(min_time, min_distance);
+      }
+      return ToList(result);
+    }, (arg("min_time")=30.0, arg("min_distance")=10.0))
+  ;
+}
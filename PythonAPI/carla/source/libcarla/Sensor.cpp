@@ -42,6 +42,7 @@ void export_sensor() {
     .def("disable_for_ros", &cc::ServerSideSensor::DisableForROS)
     .def("is_enabled_for_ros", &cc::ServerSideSensor::IsEnabledForROS)
     .def("send", &cc::ServerSideSensor::Send, (arg("message")))
+    .def("get_stream_statistics", &cc::ServerSideSensor::GetStreamStatistics)
     .def(self_ns::str(self_ns::self))
   ;
 // 定义一个名为 ClientSideSensor 的 Python 类，继承自 cc::Sensor，并设置为不可复制，使用智能指针管理
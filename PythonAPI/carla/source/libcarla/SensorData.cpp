@@ -5,11 +5,14 @@
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
 #include <carla/PythonUtil.h>
+#include <carla/image/ColorConversionKernels.h>
 #include <carla/image/ImageConverter.h>
 #include <carla/image/ImageIO.h>
 #include <carla/image/ImageView.h>
 #include <carla/pointcloud/PointCloudIO.h>
+#include <carla/sensor/AsyncDataWriter.h>
 #include <carla/sensor/SensorData.h>
+#include <carla/sensor/data/ArrayLayout.h>
 #include <carla/sensor/data/CollisionEvent.h>
 #include <carla/sensor/data/IMUMeasurement.h>
 #include <carla/sensor/data/ObstacleDetectionEvent.h>
@@ -263,6 +266,46 @@ static auto GetRawDataAsBuffer(T &self) {
     return boost::python::object(boost::python::handle<>(ptr));  
 }  
   
+// 获取传感器数组的结构化零拷贝视图，每个元素对应一条记录（见 carla/sensor/data/ArrayLayout.h）。
+template <typename T>
+static boost::python::object GetArrayView(boost::python::object self) {
+#if PY_MAJOR_VERSION >= 3
+  using value_type = typename T::value_type;
+  T &array = boost::python::extract<T &>(self);
+  return MakeArrayBufferView(
+      self,
+      reinterpret_cast<char *>(array.data()),
+      static_cast<Py_ssize_t>(array.size()),
+      static_cast<Py_ssize_t>(sizeof(value_type)),
+      static_cast<Py_ssize_t>(sizeof(value_type)),
+      carla::sensor::data::ArrayLayout<value_type>::format());
+#else
+  return GetRawDataAsBuffer(boost::python::extract<T &>(self)());
+#endif
+}
+
+// 获取传感器数组中某一字段的跨步零拷贝视图，例如 DVS 事件的 "x"、"t" 或 "pol"。
+template <typename T>
+static boost::python::object GetArrayFieldView(boost::python::object self, const std::string &name) {
+  using value_type = typename T::value_type;
+  const auto *field = carla::sensor::data::FindArrayField<value_type>(name.c_str());
+  if (field == nullptr) {
+    throw std::invalid_argument("invalid field name: " + name);
+  }
+#if PY_MAJOR_VERSION >= 3
+  T &array = boost::python::extract<T &>(self);
+  return MakeArrayBufferView(
+      self,
+      reinterpret_cast<char *>(array.data()) + field->offset,
+      static_cast<Py_ssize_t>(array.size()),
+      static_cast<Py_ssize_t>(sizeof(value_type)),
+      static_cast<Py_ssize_t>(field->size),
+      field->format);
+#else
+  throw std::runtime_error("field views require Python 3");
+#endif
+}
+  
 // 模板函数ConvertImage，用于根据指定的颜色转换器类型转换图像数据  
 template <typename T>  
 static void ConvertImage(T &self, EColorConverter cc) {  
@@ -301,12 +344,10 @@ class FakeImage : public std::vector<uint8_t> {
 // ColorCodedFlow函数，用于将光学流图像转换为RGB图像  
 static FakeImage ColorCodedFlow(  
     carla::sensor::data::OpticalFlowImage& image) {  
-    // 使用命名空间别名简化代码  
-    namespace bp = boost::python;  
     namespace csd = carla::sensor::data;  
-    // 定义常量π和弧度转角度的系数  
-    constexpr float pi = 3.1415f;  
-    constexpr float rad2ang = 360.f/(2.f*pi);  
+    static_assert(sizeof(csd::OpticalFlowPixel) == 2u * sizeof(float), "Invalid pixel size");
+    // 释放全局解释器锁，转换可能在多个线程中进行
+    carla::PythonUtil::ReleaseGIL unlock;
     // 创建FakeImage对象，用于存储转换后的图像数据  
     FakeImage result;  
     // 设置图像的宽度、高度和视野角度  
@@ -315,118 +356,16 @@ static FakeImage ColorCodedFlow(
     result.FOV = image.GetFOVAngle();  
     // 调整result的大小，以适应RGB图像的数据量（每个像素4个字节）  
     result.resize(image.GetHeight()*image.GetWidth()* 4);
-
-  // Lambda函数，用于批量处理像素（计算光流数据并映射为颜色）
-  auto command = [&] (size_t min_index, size_t max_index) {
-    // 遍历图像像素的索引，从 min_index 到 max_index
-    for (size_t index = min_index; index < max_index; index++) {
-      const csd::OpticalFlowPixel& pixel = image[index];
-      // 提取光流的 x 和 y 分量，表示在 x 和 y 方向上的流动
-      float vx = pixel.x;
-      float vy = pixel.y;
-
-       // 计算光流向量的角度，角度范围为 [0, 360] 度
-      float angle = 180.f + std::atan2(vy, vx)*rad2ang;
-      if (angle < 0) angle = 360.f + angle;
-      angle = std::fmod(angle, 360.f);
-
-      // 计算光流向量的模（即流动的大小）
-      float norm = std::sqrt(vx*vx + vy*vy);
-      const float shift = 0.999f;
-      const float a = 1.f/std::log(0.1f + shift);
-      float intensity = carla::geom::Math::Clamp(a*std::log(norm + shift), 0.f, 1.f);
-
-      // 将角度（Hue）赋值给 H，饱和度（S）设为 1，亮度（V）使用计算得到的强度值
-      float& H = angle;
-      float  S = 1.f;
-      float V = intensity;
-      float H_60 = H*(1.f/60.f);
-
-      // 计算 HSV 转换到 RGB 的中间值
-      float C = V * S;
-      float X = C*(1.f - std::abs(std::fmod(H_60, 2.f) - 1.f));
-      float m = V - C;
-
-      // 初始化 RGB 分量
-      float r = 0,g = 0,b = 0;
-      // 根据 H 值的范围确定 RGB 分量的值
-      unsigned int angle_case = static_cast<unsigned int>(H_60);
-      switch (angle_case) {
-      case 0:
-        r = C;
-        g = X;
-        b = 0;
-        break;
-      case 1:
-        r = X;
-        g = C;
-        b = 0;
-        break;
-      case 2:
-        r = 0;
-        g = C;
-        b = X;
-        break;
-      case 3:
-        r = 0;
-        g = X;
-        b = C;
-        break;
-      case 4:
-        r = X;
-        g = 0;
-        b = C;
-        break;
-      case 5:
-        r = C;
-        g = 0;
-        b = X;
-        break;
-      default:
-        r = 1;
-        g = 1;
-        b = 1;
-        break;
-      }
-
-      // 将 RGB 分量调整并映射到 [0, 255] 范围，并保存到结果数组中（假设使用 RGBA 格式，A 为 0）
-      uint8_t R = static_cast<uint8_t>((r+m)*255.f);
-      uint8_t G = static_cast<uint8_t>((g+m)*255.f);
-      uint8_t B = static_cast<uint8_t>((b+m)*255.f);
-      // 将计算得到的 RGB 值存储到结果数组中（以 RGBA 格式存储）
-      result[4*index] = B;
-      result[4*index + 1] = G;
-      result[4*index + 2] = R;
-      result[4*index + 3] = 0;
-    }
-  };
-  // 计算可用线程数，至少为 8 个线程，或者根据硬件的核心数决定
-  size_t num_threads = std::max(8u, std::thread::hardware_concurrency());
-  // 计算每个线程处理的像素数量（将图像大小均分给多个线程）
-  size_t batch_size = image.size() / num_threads;
-  // 创建一个线程指针数组，用于存储线程对象（多一个线程是为了保存线程集合的大小）
-  std::vector<std::thread*> t(num_threads+1);
-
-  // 创建 num_threads 个线程，每个线程负责处理不同的图像数据批次
-  for(size_t n = 0; n < num_threads; n++) {
-    // 为每个线程分配任务，处理的范围是从 n * batch_size 到 (n+1) * batch_size
-    t[n] = new std::thread(command, n * batch_size, (n+1) * batch_size);
-  }
-  t[num_threads] = new std::thread(command, num_threads * batch_size, image.size());
-
-  for(size_t n = 0; n <= num_threads; n++) {
-    if(t[n]->joinable()){
-      t[n]->join();
-    }
-    delete t[n];
-  }
-  return result;
+    // 由批量内核完成HSV色轮编码，大图像会自动拆分到多个线程
+    carla::image::ColorConversionKernels::ColorCodedFlow(
+        reinterpret_cast<const float *>(image.data()),
+        result.data(),
+        image.size());
+    return result;
 }
-// 定义一个保存图像到磁盘的模板函数
+// 按颜色转换类型将图像编码写盘，调用方需已释放 GIL
 template <typename T>
-static std::string SaveImageToDisk(T &self, std::string path, EColorConverter cc) {
-  // 释放 Python GIL（全局解释器锁），以便在 C++ 中执行多线程操作
-  carla::PythonUtil::ReleaseGIL unlock;
+static std::string WriteImageToDisk(const T &self, std::string path, EColorConverter cc) {
   using namespace carla::image;
   // 将图像数据转换为图像视图
   auto view = ImageView::MakeView(self);
@@ -453,12 +392,86 @@ static std::string SaveImageToDisk(T &self, std::string path, EColorConverter cc
   }
 }
 
+// 定义一个保存图像到磁盘的模板函数
+template <typename T>
+static std::string SaveImageToDisk(T &self, std::string path, EColorConverter cc) {
+  // 释放 Python GIL（全局解释器锁），以便在 C++ 中执行多线程操作
+  carla::PythonUtil::ReleaseGIL unlock;
+  return WriteImageToDisk(self, std::move(path), cc);
+}
+
 template <typename T>
 static std::string SavePointCloudToDisk(T &self, std::string path) {
   carla::PythonUtil::ReleaseGIL unlock;
   return carla::pointcloud::PointCloudIO::SaveToDisk(std::move(path), self.begin(), self.end());
 }
 
+static boost::shared_ptr<carla::sensor::AsyncDataWriter> MakeAsyncDataWriter(
+    size_t worker_threads,
+    size_t max_pending_mb,
+    bool drop_when_full) {
+  using Writer = carla::sensor::AsyncDataWriter;
+  return boost::make_shared<Writer>(
+      worker_threads,
+      max_pending_mb * 1024u * 1024u,
+      drop_when_full ? Writer::OverflowPolicy::Drop : Writer::OverflowPolicy::Block);
+}
+
+// 取得传感器数据在 C++ 侧的共享指针。不能直接以 SharedPtr 作为参数，
+// 那样得到的指针持有 Python 对象的引用，会在不持有 GIL 的写盘线程中被释放
+template <typename T>
+static carla::SharedPtr<T> GetSharedSensorData(T &data) {
+  return boost::static_pointer_cast<T>(data.shared_from_this());
+}
+
+// 图像的编码（颜色转换与 PNG 压缩）在写盘线程中完成，回调只负责入队
+static bool AsyncSaveImage(
+    carla::sensor::AsyncDataWriter &self,
+    carla::sensor::data::Image &data,
+    std::string path,
+    EColorConverter cc) {
+  auto image = GetSharedSensorData(data);
+  carla::PythonUtil::ReleaseGIL unlock;
+  const size_t bytes = image->size() * sizeof(carla::sensor::data::Color);
+  return self.Enqueue([image=std::move(image), path=std::move(path), cc]() {
+    WriteImageToDisk(*image, path, cc);
+  }, bytes);
+}
+
+template <typename T>
+static bool AsyncSaveRaw(
+    carla::sensor::AsyncDataWriter &self,
+    T &sensor_data,
+    std::string path) {
+  auto data = GetSharedSensorData(sensor_data);
+  carla::PythonUtil::ReleaseGIL unlock;
+  return self.EnqueueRaw(std::move(path), std::move(data));
+}
+
+template <typename T>
+static bool AsyncSavePointCloud(
+    carla::sensor::AsyncDataWriter &self,
+    T &sensor_data,
+    std::string path) {
+  auto data = GetSharedSensorData(sensor_data);
+  carla::PythonUtil::ReleaseGIL unlock;
+  return self.EnqueuePointCloud(std::move(path), std::move(data));
+}
+
+static boost::python::dict GetAsyncDataWriterStats(const carla::sensor::AsyncDataWriter &self) {
+  const auto stats = self.GetStats();
+  boost::python::dict result;
+  result["pending_jobs"] = stats.pending_jobs;
+  result["pending_bytes"] = stats.pending_bytes;
+  result["written_jobs"] = stats.written_jobs;
+  result["written_bytes"] = stats.written_bytes;
+  result["dropped_jobs"] = stats.dropped_jobs;
+  result["failed_jobs"] = stats.failed_jobs;
+  result["blocked_time_us"] = stats.blocked_time_us;
+  result["encode_time_us"] = stats.encode_time_us;
+  return result;
+}
+
 static boost::python::dict GetCAMData(const carla::sensor::data::CAMData message)
 {
     boost::python::dict myDict;
@@ -500,6 +513,10 @@ void export_sensor_data() {
   namespace csd = carla::sensor::data;
   namespace css = carla::sensor::s11n;
 
+#if PY_MAJOR_VERSION >= 3
+  RegisterArrayBufferType();
+#endif
+
   // Fake image returned from optical flow to color conversion
   // fakes the regular image object. Only used for visual purposes
   class_<FakeImage>("FakeImage", no_init)
@@ -580,6 +597,8 @@ void export_sensor_data() {
     .add_property("horizontal_angle", &csd::LidarMeasurement::GetHorizontalAngle)
     .add_property("channels", &csd::LidarMeasurement::GetChannelCount)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::LidarMeasurement>)
+    .def("view", &GetArrayView<csd::LidarMeasurement>)
+    .def("field_view", &GetArrayFieldView<csd::LidarMeasurement>, (arg("name")))
     .def("get_point_count", &csd::LidarMeasurement::GetPointCount, (arg("channel")))
     .def("save_to_disk", &SavePointCloudToDisk<csd::LidarMeasurement>, (arg("path")))
     .def("__len__", &csd::LidarMeasurement::size)
@@ -597,6 +616,8 @@ void export_sensor_data() {
     .add_property("horizontal_angle", &csd::SemanticLidarMeasurement::GetHorizontalAngle)
     .add_property("channels", &csd::SemanticLidarMeasurement::GetChannelCount)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::SemanticLidarMeasurement>)
+    .def("view", &GetArrayView<csd::SemanticLidarMeasurement>)
+    .def("field_view", &GetArrayFieldView<csd::SemanticLidarMeasurement>, (arg("name")))
     .def("get_point_count", &csd::SemanticLidarMeasurement::GetPointCount, (arg("channel")))
     .def("save_to_disk", &SavePointCloudToDisk<csd::SemanticLidarMeasurement>, (arg("path")))
     .def("__len__", &csd::SemanticLidarMeasurement::size)
@@ -646,6 +667,8 @@ void export_sensor_data() {
 
   class_<csd::RadarMeasurement, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::RadarMeasurement>>("RadarMeasurement", no_init)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::RadarMeasurement>)
+    .def("view", &GetArrayView<csd::RadarMeasurement>)
+    .def("field_view", &GetArrayFieldView<csd::RadarMeasurement>, (arg("name")))
     .def("get_detection_count", &csd::RadarMeasurement::GetDetectionAmount)
     .def("__len__", &csd::RadarMeasurement::size)
     .def("__iter__", iterator<csd::RadarMeasurement>())
@@ -693,6 +716,8 @@ void export_sensor_data() {
     .add_property("height", &csd::DVSEventArray::GetHeight)
     .add_property("fov", &csd::DVSEventArray::GetFOVAngle)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::DVSEventArray>)
+    .def("view", &GetArrayView<csd::DVSEventArray>)
+    .def("field_view", &GetArrayFieldView<csd::DVSEventArray>, (arg("name")))
     .def("__len__", &csd::DVSEventArray::size)
     .def("__iter__", iterator<csd::DVSEventArray>())
     .def("__getitem__", +[](const csd::DVSEventArray &self, size_t pos) -> csd::DVSEvent {
@@ -710,6 +735,25 @@ void export_sensor_data() {
     .def(self_ns::str(self_ns::self))
   ;
 
+  class_<cs::AsyncDataWriter, boost::noncopyable, boost::shared_ptr<cs::AsyncDataWriter>>("AsyncDataWriter", no_init)
+    .def("__init__", make_constructor(
+        &MakeAsyncDataWriter,
+        default_call_policies(),
+        (arg("worker_threads")=0u, arg("max_pending_mb")=256u, arg("drop_when_full")=false)))
+    .add_property("worker_threads", &cs::AsyncDataWriter::GetWorkerCount)
+    .def("save_image", &AsyncSaveImage, (arg("image"), arg("path"), arg("color_converter")=EColorConverter::Raw))
+    .def("save_raw", &AsyncSaveRaw<csd::Image>, (arg("data"), arg("path")))
+    .def("save_raw", &AsyncSaveRaw<csd::OpticalFlowImage>, (arg("data"), arg("path")))
+    .def("save_raw", &AsyncSaveRaw<csd::LidarMeasurement>, (arg("data"), arg("path")))
+    .def("save_raw", &AsyncSaveRaw<csd::SemanticLidarMeasurement>, (arg("data"), arg("path")))
+    .def("save_raw", &AsyncSaveRaw<csd::RadarMeasurement>, (arg("data"), arg("path")))
+    .def("save_raw", &AsyncSaveRaw<csd::DVSEventArray>, (arg("data"), arg("path")))
+    .def("save_point_cloud", &AsyncSavePointCloud<csd::LidarMeasurement>, (arg("point_cloud"), arg("path")))
+    .def("save_point_cloud", &AsyncSavePointCloud<csd::SemanticLidarMeasurement>, (arg("point_cloud"), arg("path")))
+    .def("flush", CALL_WITHOUT_GIL(cs::AsyncDataWriter, Flush))
+    .def("get_stats", &GetAsyncDataWriterStats)
+  ;
+
   class_<csd::CAMData>("CAMMessage")
     .def_readwrite("power", &csd::CAMData::Power)
     .def("get", GetCAMData)
@@ -0,0 +1,101 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <carla/streaming/StreamMetrics.h>
+
+#include <sstream>
+
+namespace carla {
+namespace streaming {
+
+  std::ostream &operator<<(std::ostream &out, const StreamStatistics &stats) {
+    out << "StreamStatistics(stream_id=" << stats.stream_id
+        << ", messages_sent=" << stats.messages_sent
+        << ", messages_dropped=" << stats.messages_dropped
+        << ", messages_received=" << stats.messages_received
+        << ", reconnects=" << stats.reconnects
+        << ", average_latency=" << std::to_string(stats.GetAverageLatency()) << ')';
+    return out;
+  }
+
+} // namespace streaming
+} // namespace carla
+
+// 空类，在 PythonAPI 中作为静态方法的命名空间
+class StreamMetrics {};
+
+static boost::python::list GetLatencyBuckets(const carla::streaming::StreamStatistics &self) {
+  boost::python::list result;
+  for (size_t i = 0u; i < self.latency_buckets.size(); ++i) {
+    result.append(boost::python::make_tuple(carla::streaming::STREAM_LATENCY_BUCKETS[i], self.latency_buckets[i]));
+  }
+  return result;
+}
+
+void export_stream_metrics() {
+  using namespace boost::python;
+  namespace cs = carla::streaming;
+
+  class_<cs::StreamStatistics>("StreamStatistics", no_init)
+    .def_readonly("stream_id", &cs::StreamStatistics::stream_id)
+    .def_readonly("messages_sent", &cs::StreamStatistics::messages_sent)
+    .def_readonly("bytes_sent", &cs::StreamStatistics::bytes_sent)
+    .def_readonly("messages_dropped", &cs::StreamStatistics::messages_dropped)
+    .def_readonly("write_wait_count", &cs::StreamStatistics::write_wait_count)
+    .def_readonly("write_wait_total", &cs::StreamStatistics::write_wait_total)
+    .def_readonly("write_wait_max", &cs::StreamStatistics::write_wait_max)
+    .add_property("average_write_wait", &cs::StreamStatistics::GetAverageWriteWait)
+    .def_readonly("messages_received", &cs::StreamStatistics::messages_received)
+    .def_readonly("bytes_received", &cs::StreamStatistics::bytes_received)
+    .def_readonly("reconnects", &cs::StreamStatistics::reconnects)
+    .def_readonly("latency_count", &cs::StreamStatistics::latency_count)
+    .def_readonly("latency_total", &cs::StreamStatistics::latency_total)
+    .def_readonly("latency_max", &cs::StreamStatistics::latency_max)
+    .add_property("average_latency", &cs::StreamStatistics::GetAverageLatency)
+    .add_property("latency_buckets", &GetLatencyBuckets)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<StreamMetrics>("StreamMetrics", no_init)
+    .def("get_statistics", +[]() {
+      boost::python::list result;
+      for (const auto &stats : cs::StreamMetrics::GetStatistics()) {
+        result.append(stats);
+      }
+      return result;
+    })
+    .staticmethod("get_statistics")
+    .def("get_stream_statistics", +[](cs::stream_id_type stream_id) {
+      return cs::StreamMetrics::GetStatistics(stream_id);
+    }, arg("stream_id"))
+    .staticmethod("get_stream_statistics")
+    .def("reset", &cs::StreamMetrics::Reset)
+    .staticmethod("reset")
+    .def("to_prometheus", +[]() {
+      std::ostringstream out;
+      cs::StreamMetrics::ExportPrometheus(out);
+      return out.str();
+    })
+    .staticmethod("to_prometheus")
+    .def("export_prometheus", +[](const std::string &filename) {
+      carla::PythonUtil::ReleaseGIL unlock;
+      return cs::StreamMetrics::ExportPrometheus(filename);
+    }, arg("filename"))
+    .staticmethod("export_prometheus")
+    .def("start_server", +[](uint16_t port, const std::string &address) {
+      carla::PythonUtil::ReleaseGIL unlock;
+      return cs::StreamMetrics::StartServer(port, address);
+    }, (arg("port"), arg("address")="127.0.0.1"))
+    .staticmethod("start_server")
+    .def("stop_server", +[]() {
+      carla::PythonUtil::ReleaseGIL unlock;
+      cs::StreamMetrics::StopServer();
+    })
+    .staticmethod("stop_server")
+    .def("get_server_port", &cs::StreamMetrics::GetServerPort)
+    .staticmethod("get_server_port")
+  ;
+}
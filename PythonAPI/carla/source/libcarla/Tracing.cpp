@@ -0,0 +1,32 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <carla/profiler/Tracer.h>
+
+// 空类，在 PythonAPI 中作为静态方法的命名空间
+class Tracer {};
+
+void export_tracing() {
+  using namespace boost::python;
+  namespace cp = carla::profiler;
+
+  class_<Tracer>("Tracer", no_init)
+    .def("enable", +[]() { cp::Tracer::Enable(); })
+    .staticmethod("enable")
+    .def("disable", +[]() { cp::Tracer::Disable(); })
+    .staticmethod("disable")
+    .def("is_enabled", &cp::Tracer::IsEnabled)
+    .staticmethod("is_enabled")
+    .def("clear", &cp::Tracer::Clear)
+    .staticmethod("clear")
+    .def("export_chrome_trace", +[](const std::string &filename) {
+      // 导出可能需要一些时间，期间释放 GIL
+      carla::PythonUtil::ReleaseGIL unlock;
+      return cp::Tracer::ExportChromeTrace(filename);
+    }, arg("filename"))
+    .staticmethod("export_chrome_trace")
+  ;
+}
@@ -87,6 +87,18 @@ boost::python::list InterGetActionBuffer(carla::traffic_manager::TrafficManager&
   return l;
 }
 
+// 批量设置逐车辆参数，values 为 (actor, value) 元组的列表
+void InterSetParameterBatch(carla::traffic_manager::TrafficManager& self, carla::traffic_manager::VehicleParameter parameter, boost::python::object values) {
+  std::vector<std::pair<ActorPtr, float>> result;
+  const auto size = len(values);
+  result.reserve(size);
+  for (auto i = 0; i < size; ++i) {
+    boost::python::object item = values[i];
+    result.emplace_back(boost::python::extract<ActorPtr>(item[0]), boost::python::extract<float>(item[1]));
+  }
+  self.SetParameterBatch(parameter, result);
+}
+
 
 // 导出TrafficManager相关功能的函数
 void export_trafficmanager() {
@@ -94,6 +106,23 @@ void export_trafficmanager() {
   namespace ctm = carla::traffic_manager; // 定义别名简化命名空间引用
   using namespace boost::python; // 使用Boost.Python命名空间，方便后续代码调用Boost.Python的功能
 
+  enum_<ctm::VehicleParameter>("VehicleParameter")
+    .value("PercentageSpeedDifference", ctm::VehicleParameter::PercentageSpeedDifference)
+    .value("LaneOffset", ctm::VehicleParameter::LaneOffset)
+    .value("DesiredSpeed", ctm::VehicleParameter::DesiredSpeed)
+    .value("DistanceToLeadingVehicle", ctm::VehicleParameter::DistanceToLeadingVehicle)
+    .value("PercentageIgnoreWalkers", ctm::VehicleParameter::PercentageIgnoreWalkers)
+    .value("PercentageIgnoreVehicles", ctm::VehicleParameter::PercentageIgnoreVehicles)
+    .value("PercentageRunningLight", ctm::VehicleParameter::PercentageRunningLight)
+    .value("PercentageRunningSign", ctm::VehicleParameter::PercentageRunningSign)
+    .value("KeepRightPercentage", ctm::VehicleParameter::KeepRightPercentage)
+    .value("RandomLeftLaneChangePercentage", ctm::VehicleParameter::RandomLeftLaneChangePercentage)
+    .value("RandomRightLaneChangePercentage", ctm::VehicleParameter::RandomRightLaneChangePercentage)
+    .value("UpdateVehicleLights", ctm::VehicleParameter::UpdateVehicleLights)
+    .value("AutoLaneChange", ctm::VehicleParameter::AutoLaneChange)
+    .value("ForceLaneChange", ctm::VehicleParameter::ForceLaneChange)
+  ;
+
   class_<ctm::TrafficManager>("TrafficManager", no_init)
     .def("get_port", &ctm::TrafficManager::Port)
     .def("vehicle_percentage_speed_difference", &ctm::TrafficManager::SetPercentageSpeedDifference, (arg("actor"), arg("percentage")))
@@ -119,11 +148,13 @@ void export_trafficmanager() {
     .def("set_hybrid_physics_radius", &ctm::TrafficManager::SetHybridPhysicsRadius, (arg("r")))
     .def("set_random_device_seed", &ctm::TrafficManager::SetRandomDeviceSeed, (arg("value")))
     .def("set_osm_mode", &carla::traffic_manager::TrafficManager::SetOSMMode, (arg("mode_switch")))
+    .def("set_pipelined_mode", &carla::traffic_manager::TrafficManager::SetPipelinedMode, (arg("mode_switch")=true))
     .def("set_path", &InterSetCustomPath, (arg("actor"), arg("path"), arg("empty_buffer")=true))
     .def("set_route", &InterSetImportedRoute, (arg("actor"), arg("path"), arg("empty_buffer")=true))
     .def("set_respawn_dormant_vehicles", &carla::traffic_manager::TrafficManager::SetRespawnDormantVehicles, (arg("mode_switch")))
     .def("set_boundaries_respawn_dormant_vehicles", &carla::traffic_manager::TrafficManager::SetBoundariesRespawnDormantVehicles, (arg("lower_bound"), arg("upper_bound")))
     .def("get_next_action", &InterGetNextAction, (arg("actor")))
     .def("get_all_actions", &InterGetActionBuffer, (arg("actor")))
+    .def("set_parameter_batch", &InterSetParameterBatch, (arg("parameter"), arg("values")))
     .def("shut_down", &ctm::TrafficManager::ShutDown);
 }
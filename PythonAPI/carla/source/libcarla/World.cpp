@@ -7,8 +7,10 @@
 #include <carla/PythonUtil.h>
 #include <carla/client/Actor.h>
 #include <carla/client/ActorList.h>
+#include <carla/client/EpisodeStateStream.h>
 #include <carla/client/World.h>
 #include <carla/rpc/EnvironmentObject.h>
+#include <carla/rpc/EpisodeStateFilter.h>
 #include <carla/rpc/ObjectLabel.h>
 
 // 引入标准库中的字符串处理功能
@@ -82,6 +84,10 @@ static size_t OnTick(carla::client::World &self, boost::python::object callback)
   return self.OnTick(MakeCallback(std::move(callback)));
 }
 
+static void ListenToEpisodeState(carla::client::EpisodeStateStream &self, boost::python::object callback) {
+  self.Listen(MakeCallback(std::move(callback)));
+}
+
 static auto Tick(carla::client::World &world, double seconds) {
   carla::PythonUtil::ReleaseGIL unlock;
   return world.Tick(TimeDurationFromSeconds(seconds));
@@ -306,6 +312,39 @@ void export_world() {
     })
   ;
 
+  class_<cr::EpisodeStateFilter>("EpisodeStateFilter")
+    .def_readwrite("actor_id", &cr::EpisodeStateFilter::actor_id)
+    .def_readwrite("radius", &cr::EpisodeStateFilter::radius)
+    .def_readwrite("use_region", &cr::EpisodeStateFilter::use_region)
+    .def_readwrite("region", &cr::EpisodeStateFilter::region)
+    .add_property("actor_ids",
+        +[](const cr::EpisodeStateFilter &self) {
+          boost::python::list result;
+          for (auto id : self.actor_ids) {
+            result.append(id);
+          }
+          return result;
+        },
+        +[](cr::EpisodeStateFilter &self, boost::python::list &ids) {
+          self.actor_ids = PythonLitstToVector<carla::ActorId>(ids);
+        })
+    .def("around_actor", &cr::EpisodeStateFilter::AroundActor, (arg("actor_id"), arg("radius")))
+    .staticmethod("around_actor")
+    .def("inside_region", &cr::EpisodeStateFilter::InsideRegion, (arg("region")))
+    .staticmethod("inside_region")
+    .def("from_ids", +[](boost::python::list &ids) {
+        return cr::EpisodeStateFilter::FromIds(PythonLitstToVector<carla::ActorId>(ids));
+      }, (arg("actor_ids")))
+    .staticmethod("from_ids")
+  ;
+
+  class_<cc::EpisodeStateStream, boost::noncopyable, boost::shared_ptr<cc::EpisodeStateStream>>("EpisodeStateStream", no_init)
+    .add_property("filter", +[](const cc::EpisodeStateStream &self) { return self.GetFilter(); })
+    .def("listen", &ListenToEpisodeState, (arg("callback")))
+    .def("is_listening", &cc::EpisodeStateStream::IsListening)
+    .def("stop", CALL_WITHOUT_GIL(cc::EpisodeStateStream, Stop))
+  ;
+
 #define SPAWN_ACTOR_WITHOUT_GIL(fn) +[]( \
         cc::World &self, \
         const cc::ActorBlueprint &blueprint, \
@@ -339,7 +378,9 @@ void export_world() {
     .def("set_weather", &cc::World::SetWeather)
     .def("get_imui_sensor_gravity", CONST_CALL_WITHOUT_GIL(cc::World, GetIMUISensorGravity))
     .def("set_imui_sensor_gravity", &cc::World::SetIMUISensorGravity, (arg("NewIMUISensorGravity")) )
-    .def("get_snapshot", &cc::World::GetSnapshot)
+    .def("get_snapshot", +[](const cc::World &self) { return self.GetSnapshot(); })
+    .def("get_snapshot", CALL_RETURNING_OPTIONAL_1(cc::World, GetSnapshot, uint64_t), (arg("frame")))
+    .def("get_actor_transform_at", CALL_RETURNING_OPTIONAL_2(cc::World, GetActorTransformAt, carla::ActorId, double), (arg("actor_id"), arg("elapsed_seconds")))
     .def("get_actor", CONST_CALL_WITHOUT_GIL_1(cc::World, GetActor, carla::ActorId), (arg("actor_id")))
     .def("get_actors", CONST_CALL_WITHOUT_GIL(cc::World, GetActors))
     .def("get_actors", &GetActorsById, (arg("actor_ids")))
@@ -348,6 +389,7 @@ void export_world() {
     .def("wait_for_tick", &WaitForTick, (arg("seconds")=0.0))
     .def("on_tick", &OnTick, (arg("callback")))
     .def("remove_on_tick", &cc::World::RemoveOnTick, (arg("callback_id")))
+    .def("create_episode_state_stream", CONST_CALL_WITHOUT_GIL_1(cc::World, MakeEpisodeStateStream, cr::EpisodeStateFilter), (arg("filter")))
     .def("tick", &Tick, (arg("seconds")=0.0))
     .def("set_pedestrians_cross_factor", CALL_WITHOUT_GIL_1(cc::World, SetPedestriansCrossFactor, float), (arg("percentage")))
     .def("set_pedestrians_seed", CALL_WITHOUT_GIL_1(cc::World, SetPedestriansSeed, unsigned int), (arg("seed")))
@@ -233,6 +233,7 @@ static auto MakeCallback(boost::python::object callback) {
 }
 
 // 17个模块的源代码文件+1个RSS模块
+#include "ArrayBuffer.cpp"
 #include "V2XData.cpp"
 #include "Geom.cpp"
 #include "Actor.cpp"
@@ -250,6 +251,10 @@ static auto MakeCallback(boost::python::object callback) {
 #include "TrafficManager.cpp"
 #include "LightManager.cpp"
 #include "OSM2ODR.cpp"
+#include "Tracing.cpp"
+#include "Recording.cpp"
+#include "PointCloud.cpp"
+#include "StreamMetrics.cpp"
 
 #ifdef LIBCARLA_RSS_ENABLED
 #include "AdRss.cpp"
@@ -280,4 +285,8 @@ BOOST_PYTHON_MODULE(libcarla) {
   export_ad_rss();
   #endif
   export_osm2odr();
+  export_tracing();
+  export_recording();
+  export_pointcloud();
+  export_stream_metrics();
 }
@@ -0,0 +1,159 @@
+#!/usr/bin/env python
+
+# Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma de
+# Barcelona (UAB).
+#
+# This work is licensed under the terms of the MIT license.
+# For a copy, see <https://opensource.org/licenses/MIT>.
+
+"""
+Analyze recorder files (.log) offline, without a running simulator.
+
+Examples:
+    analyze_recorder.py info recordings/*.log
+    analyze_recorder.py collisions -t1 v -t2 w recording.log
+    analyze_recorder.py blocked --min-time 60 recording.log
+    analyze_recorder.py trajectory --actor 24 --time-start 10 --time-end 30 recording.log > actor24.csv
+"""
+
+import glob
+import os
+import sys
+
+# 查找 Carla 的 .egg 文件并加入模块搜索路径
+try:
+    sys.path.append(glob.glob('../carla/dist/carla-*%d.%d-%s.egg' % (
+        sys.version_info.major,
+        sys.version_info.minor,
+        'win-amd64' if os.name == 'nt' else 'linux-x86_64'))[0])
+except IndexError:
+    pass
+
+import carla
+
+import argparse
+import csv
+import time
+
+
+def print_info(path, recording):
+    print('File: %s' % path)
+    print('Version: %d' % recording.version)
+    print('Map: %s' % recording.map_name)
+    print('Date: %s' % time.strftime('%x %X', time.localtime(recording.date)))
+    print('Frames: %d' % recording.frame_count)
+    print('Duration: %.2f seconds' % recording.duration)
+    actors = recording.get_actors()
+    categories = {}
+    for actor in actors:
+        categories[actor.category] = categories.get(actor.category, 0) + 1
+    print('Actors: %d (%s)' % (len(actors), ', '.join(
+        '%s: %d' % (category, count) for category, count in sorted(categories.items()))))
+
+
+def print_collisions(path, recording, args):
+    print('%8s %6s %6s %-35s %6s %-35s' % ('Time', 'Types', 'Id', 'Actor 1', 'Id', 'Actor 2'))
+    for collision in recording.query_collisions(args.type1, args.type2):
+        print('%8.0f %3s %2s %6d %-35s %6d %-35s' % (
+            collision.time,
+            collision.actor1_category,
+            collision.actor2_category,
+            collision.actor1_id,
+            collision.actor1_type_id,
+            collision.actor2_id,
+            collision.actor2_type_id))
+
+
+def print_blocked(path, recording, args):
+    print('%8s %6s %-35s %10s' % ('Time', 'Id', 'Actor', 'Duration'))
+    for blocked in recording.query_blocked(args.min_time, args.min_distance):
+        print('%8.0f %6d %-35s %10.0f' % (blocked.time, blocked.id, blocked.type_id, blocked.duration))
+
+
+def write_trajectory(path, recording, args):
+    columns = ['frame', 'time', 'x', 'y', 'z', 'roll', 'pitch', 'yaw']
+    trajectory = recording.get_trajectory(args.actor)
+    writer = csv.writer(sys.stdout)
+    writer.writerow(['file', 'actor'] + columns)
+    for row in zip(*[trajectory[column] for column in columns]):
+        writer.writerow([path, args.actor] + list(row))
+
+
+def main():
+    argparser = argparse.ArgumentParser(
+        description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    argparser.add_argument(
+        'query',
+        choices=['info', 'collisions', 'blocked', 'trajectory'],
+        help='query to run on each file')
+    argparser.add_argument(
+        'files',
+        nargs='+',
+        help='recorder files (.log)')
+    argparser.add_argument(
+        '--time-start',
+        default=0.0,
+        type=float,
+        help='only decode frames after this time, in seconds (default: 0.0)')
+    argparser.add_argument(
+        '--time-end',
+        default=float('inf'),
+        type=float,
+        help='only decode frames before this time, in seconds (default: end of the recording)')
+    argparser.add_argument(
+        '-j', '--threads',
+        default=0,
+        type=int,
+        help='threads used to decode each file, 0 for all cores (default: 0)')
+    argparser.add_argument(
+        '-t1', '--type1',
+        default='a',
+        help='collisions: category of actor 1, one of a, h, v, w, t, o (default: a)')
+    argparser.add_argument(
+        '-t2', '--type2',
+        default='a',
+        help='collisions: category of actor 2, one of a, h, v, w, t, o (default: a)')
+    argparser.add_argument(
+        '--min-time',
+        default=30.0,
+        type=float,
+        help='blocked: minimum time an actor is stopped, in seconds (default: 30)')
+    argparser.add_argument(
+        '--min-distance',
+        default=10.0,
+        type=float,
+        help='blocked: maximum distance moved while stopped, in centimeters (default: 10)')
+    argparser.add_argument(
+        '--actor',
+        type=int,
+        help='trajectory: id of the actor')
+    args = argparser.parse_args()
+
+    if args.query == 'trajectory' and args.actor is None:
+        argparser.error('the trajectory query needs --actor')
+
+    for path in args.files:
+        try:
+            recording = carla.Recording(path, args.time_start, args.time_end, args.threads)
+        except RuntimeError as error:
+            print('%s: %s' % (path, error), file=sys.stderr)
+            continue
+        if args.query == 'info':
+            print_info(path, recording)
+        elif args.query == 'collisions':
+            print_collisions(path, recording, args)
+        elif args.query == 'blocked':
+            print_blocked(path, recording, args)
+        elif args.query == 'trajectory':
+            write_trajectory(path, recording, args)
+        if args.query != 'trajectory' and len(args.files) > 1:
+            print('')
+
+
+if __name__ == '__main__':
+
+    try:
+        main()
+    except KeyboardInterrupt:
+        pass
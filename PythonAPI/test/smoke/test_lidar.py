@@ -78,6 +78,12 @@ class Sensor():
         if total_np_points != total_detect_points:
             self.error = "The number of points of the raw data does not match with the LidarMeasurament array"
 
+        # Zero-copy views must expose the same points as the raw data
+        view = np.asarray(sensor_data.view())
+        view_x = np.asarray(sensor_data.field_view('x'))
+        if view.shape[0] != total_detect_points or not np.array_equal(view_x, points[:, 0]):
+            self.error = "The zero-copy views do not match with the LidarMeasurament array"
+
         if total_channel_points != total_detect_points:
             self.error = "The sum of the points of all channels does not match with the LidarMeasurament array"
 
@@ -93,6 +93,11 @@ public:
     return SecondaryServer;
   }
 
+  FWorldObserver &GetWorldObserver()// ȡͷ״̬Ĺ۲
+  {
+    return WorldObserver;
+  }
+
 private:
 
   void OnPreTick(UWorld *World, ELevelTick TickType, float DeltaSeconds);
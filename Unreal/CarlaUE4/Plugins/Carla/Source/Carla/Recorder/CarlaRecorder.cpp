@@ -21,6 +21,7 @@
 #include "VehicleAnimInstance.h"
 
 #include <compiler/disable-ue4-macros.h>
+#include "carla/recorder/BlockCodec.h"
 #include "carla/rpc/VehicleLightState.h"
 #include <compiler/enable-ue4-macros.h>
 
@@ -429,20 +430,22 @@ std::string ACarlaRecorder::Start(std::string Name, FString MapName, bool Additi
   std::string Filename = GetRecorderFilename(Name);
 
   // binary file
-  File.open(Filename, std::ios::binary);
-  if (!File.is_open())
+  if (!Writer.Open(Filename, WriterSettings))
   {
     return "";
   }
 
   // save info
-  Info.Version = 1;
+  Info.Version = WriterSettings.bCompress ?
+      carla::recorder::BlockCodec::COMPRESSED_FILE_VERSION :
+      carla::recorder::BlockCodec::RAW_FILE_VERSION;
   Info.Magic = TEXT("CARLA_RECORDER");
   Info.Date = std::time(0);
   Info.Mapfile = MapName;
 
   // write general info
-  Info.Write(File);
+  Info.Write(Writer.GetStream());
+  Writer.CommitHeader();
 
   Frames.Reset();
   PlatformTime.SetStartTime();
@@ -461,9 +464,14 @@ void ACarlaRecorder::Stop(void)
 {
   Disable();
 
-  if (File)
+  if (Writer.IsOpen())
   {
-    File.close();
+    Writer.Close();
+
+    const CarlaRecorderWriterStats Stats = Writer.GetStats();
+    UE_LOG(LogCarla, Log,
+        TEXT("Recorder: %llu frames, %llu bytes serialized, %llu bytes written, %llu stalls (%.3f s)"),
+        Stats.Frames, Stats.RawBytes, Stats.WrittenBytes, Stats.Stalls, Stats.StallSeconds);
   }
 
   Clear();
@@ -494,11 +502,16 @@ void ACarlaRecorder::Clear(void)
 
 void ACarlaRecorder::Write(double DeltaSeconds)
 {
+  TRACE_CPUPROFILER_EVENT_SCOPE(ACarlaRecorder::Write);
+
+  // the frame is serialized in memory, the writer saves it to disk
+  std::ostream &File = Writer.GetStream();
+
   // update this frame data
   Frames.SetFrame(DeltaSeconds);
 
   // start
-  Frames.WriteStart(File);
+  const std::streampos DurationOffset = Frames.WriteStart(File);
   VisualTime.Write(File);
 
   // events
@@ -535,6 +548,8 @@ void ACarlaRecorder::Write(double DeltaSeconds)
   // end
   Frames.WriteEnd(File);
 
+  Writer.CommitFrame(static_cast<size_t>(DurationOffset), Frames.GetDurationThis());
+
   Clear();
 }
 
@@ -33,6 +33,7 @@
 #include "CarlaRecorderState.h"
 #include "CarlaRecorderVisualTime.h"
 #include "CarlaRecorderWalkerBones.h"
+#include "CarlaRecorderWriter.h"
 #include "CarlaRecorderDoorVehicle.h"
 #include "CarlaReplayer.h"
 #include "Carla/Vehicle/CarlaWheeledVehicle.h"
@@ -176,6 +177,17 @@ public:
   void SetReplayerIgnoreSpectator(bool IgnoreSpectator);
   void StopReplayer(bool KeepActors = false);
 
+  // compress the next recordings (file version 2)
+  void SetCompression(bool bCompress)
+  {
+    WriterSettings.bCompress = bCompress;
+  }
+
+  CarlaRecorderWriterStats GetWriterStats() const
+  {
+    return Writer.GetStats();
+  }
+
   void Ticking(float DeltaSeconds);
 
 private:
@@ -187,8 +199,9 @@ private:
 
   uint32_t NextCollisionId = 0;
 
-  // files
-  std::ofstream File;
+  // files, written from a background thread
+  CarlaRecorderWriter Writer;
+  CarlaRecorderWriterSettings WriterSettings;
 
   UCarlaEpisode *Episode = nullptr;
 
@@ -30,7 +30,6 @@ void CarlaRecorderFrames::Reset(void)
   Frame.Id = 0;
   Frame.DurationThis = 0.0f;
   Frame.Elapsed = 0.0f;
-  OffsetPreviousFrame = 0;
 }
 
 void CarlaRecorderFrames::SetFrame(double DeltaSeconds)
@@ -49,9 +48,9 @@ void CarlaRecorderFrames::SetFrame(double DeltaSeconds)
   ++Frame.Id;
 }
 
-void CarlaRecorderFrames::WriteStart(std::ostream &OutFile)
+std::streampos CarlaRecorderFrames::WriteStart(std::ostream &OutFile)
 {
-  std::streampos Pos, Offset;
+  std::streampos Offset;
   double Dummy = -1.0f;
 
   // write the packet id
@@ -67,17 +66,8 @@ void CarlaRecorderFrames::WriteStart(std::ostream &OutFile)
   WriteValue<double>(OutFile, Dummy);
   WriteValue<double>(OutFile, Frame.Elapsed);
 
-  // we need to write this duration to previous frame
-  if (OffsetPreviousFrame > 0)
-  {
-    Pos = OutFile.tellp();
-    OutFile.seekp(OffsetPreviousFrame, std::ios::beg);
-    WriteValue<double>(OutFile, Frame.DurationThis);
-    OutFile.seekp(Pos, std::ios::beg);
-  }
-
-  // save position for next actualization
-  OffsetPreviousFrame = Offset;
+  // the duration of this frame is written to the previous frame by the writer
+  return Offset;
 }
 
 void CarlaRecorderFrames::WriteEnd(std::ostream &OutFile)
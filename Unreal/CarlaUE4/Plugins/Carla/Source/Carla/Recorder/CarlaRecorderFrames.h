@@ -32,11 +32,17 @@ public:
 
   void SetFrame(double DeltaSeconds);
 
-  void WriteStart(std::ostream &OutFile);
+  // 写入帧开始数据包，DurationThis 先写为 -1，返回它在流中的位置，
+  // 由 CarlaRecorderWriter 在收到下一帧时回填
+  std::streampos WriteStart(std::ostream &OutFile);
   void WriteEnd(std::ostream &OutFile);
 
+  double GetDurationThis() const
+  {
+    return Frame.DurationThis;
+  }
+
 private:
 
   CarlaRecorderFrame Frame;
-  std::streampos OffsetPreviousFrame;
 };
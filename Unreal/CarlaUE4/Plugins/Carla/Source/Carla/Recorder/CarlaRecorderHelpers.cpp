@@ -4,11 +4,18 @@
 // This work is licensed under the terms of the MIT license.
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
+#include "Carla.h"
+
 #include <fstream>
 #include <vector>
 
 #include "UnrealString.h"
 #include "CarlaRecorderHelpers.h"
+#include "CarlaRecorderInfo.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include "carla/recorder/BlockCodec.h"
+#include <compiler/enable-ue4-macros.h>
 
 // create a temporal buffer to convert from and to FString and bytes
 static std::vector<uint8_t> CarlaRecorderHelperBuffer;
@@ -30,6 +37,37 @@ std::string GetRecorderFilename(std::string Filename)
   return Filename2;
 }
 
+bool OpenRecorderFile(std::ifstream &File, carla::recorder::DecodingStreamBuf &Decoded, const std::string &Filename)
+{
+  using carla::recorder::BlockCodec;
+
+  // read from the file again if a compressed one was opened before
+  static_cast<std::istream &>(File).rdbuf(File.rdbuf());
+  Decoded.Close();
+
+  File.open(Filename, std::ios::binary);
+  if (!File.is_open())
+  {
+    return false;
+  }
+
+  CarlaRecorderInfo Info;
+  Info.Read(File);
+  if (!File || Info.Version != BlockCodec::COMPRESSED_FILE_VERSION)
+  {
+    File.clear();
+    File.seekg(0, std::ios::beg);
+    return true;
+  }
+  const size_t HeaderSize = static_cast<size_t>(File.tellg());
+
+  // the blocks after the header are decoded one at a time while reading
+  Decoded.Open(*File.rdbuf(), HeaderSize, Filename);
+  static_cast<std::istream &>(File).rdbuf(&Decoded);
+  File.clear();
+  return true;
+}
+
 // ------
 // write
 // ------
@@ -6,12 +6,21 @@
 
 #pragma once
 
+#include <fstream>
 #include <sstream>
 #include <vector>
 
+#include <compiler/disable-ue4-macros.h>
+#include "carla/recorder/DecodingStreamBuf.h"
+#include <compiler/enable-ue4-macros.h>
+
 // get the final path + filename
 std::string GetRecorderFilename(std::string Filename);
 
+// open a recorder file for reading; compressed files (version 2) are decoded
+// block by block through 'Decoded' as the stream reads them
+bool OpenRecorderFile(std::ifstream &File, carla::recorder::DecodingStreamBuf &Decoded, const std::string &Filename);
+
 // ---------
 // recorder
 // ---------
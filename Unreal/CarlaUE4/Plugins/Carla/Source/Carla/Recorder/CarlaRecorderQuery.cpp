@@ -70,8 +70,7 @@ std::string CarlaRecorderQuery::QueryInfo(std::string Filename, bool bShowAll)
   std::string Filename2 = GetRecorderFilename(Filename);
 
   // try to open
-  File.open(Filename2, std::ios::binary);
-  if (!File.is_open())
+  if (!OpenRecorderFile(File, DecodedFile, Filename2))
   {
     Info << "File " << Filename2 << " not found on server\n";
     return Info.str();
@@ -634,6 +633,7 @@ std::string CarlaRecorderQuery::QueryInfo(std::string Filename, bool bShowAll)
   Info << "Duration: " << Frame.Elapsed << " seconds\n";
 
   File.close();
+  DecodedFile.Close();
 
   return Info.str();
 }
@@ -646,8 +646,7 @@ std::string CarlaRecorderQuery::QueryCollisions(std::string Filename, char Categ
   std::string Filename2 = GetRecorderFilename(Filename);
 
   // try to open
-  File.open(Filename2, std::ios::binary);
-  if (!File.is_open())
+  if (!OpenRecorderFile(File, DecodedFile, Filename2))
   {
     Info << "File " << Filename2 << " not found on server\n";
     return Info.str();
@@ -814,6 +813,7 @@ std::string CarlaRecorderQuery::QueryCollisions(std::string Filename, char Categ
   Info << "Duration: " << Frame.Elapsed << " seconds\n";
 
   File.close();
+  DecodedFile.Close();
 
   return Info.str();
 }
@@ -826,8 +826,7 @@ std::string CarlaRecorderQuery::QueryBlocked(std::string Filename, double MinTim
   std::string Filename2 = GetRecorderFilename(Filename);
 
   // try to open
-  File.open(Filename2, std::ios::binary);
-  if (!File.is_open())
+  if (!OpenRecorderFile(File, DecodedFile, Filename2))
   {
     Info << "File " << Filename2 << " not found on server\n";
     return Info.str();
@@ -983,6 +982,7 @@ std::string CarlaRecorderQuery::QueryBlocked(std::string Filename, double MinTim
   Info << "Duration: " << Frame.Elapsed << " seconds\n";
 
   File.close();
+  DecodedFile.Close();
 
   return Info.str();
 }
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <fstream>
+#include <sstream>
 
 #include "CarlaRecorderTraficLightTime.h"
 #include "CarlaRecorderPhysicsControl.h"
@@ -27,6 +28,7 @@
 #include "CarlaRecorderState.h"
 #include "CarlaRecorderWalkerBones.h"
 #include "CarlaRecorderDoorVehicle.h"
+#include "CarlaRecorderHelpers.h"
 
 class CarlaRecorderQuery
 {
@@ -51,6 +53,8 @@ public:
 private:
 
   std::ifstream File;
+  // decoded data of compressed files
+  carla::recorder::DecodingStreamBuf DecodedFile;
   Header Header;
   CarlaRecorderInfo RecInfo;
   CarlaRecorderFrame Frame;
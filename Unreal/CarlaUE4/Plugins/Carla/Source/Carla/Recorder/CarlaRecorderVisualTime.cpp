@@ -32,7 +32,7 @@ void CarlaRecorderVisualTime::Read(std::ifstream &InFile)
   // 并将其赋给当前类（this）的Time成员变量，以完成从文件读取时间数据并设置的操作
 }
 
-void CarlaRecorderVisualTime::Write(std::ofstream &OutFile)
+void CarlaRecorderVisualTime::Write(std::ostream &OutFile)
 // 定义一个名为Write的成员函数，属于CarlaRecorderVisualTime类。
 // 此函数用于将类中与视觉时间相关的数据写入到输出文件流OutFile中
 {
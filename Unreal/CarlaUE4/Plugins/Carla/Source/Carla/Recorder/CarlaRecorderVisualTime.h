@@ -18,7 +18,7 @@ struct CarlaRecorderVisualTime
 
   void Read(std::ifstream &InFile);
 
-  void Write(std::ofstream &OutFile);
+  void Write(std::ostream &OutFile);
 
 };
 #pragma pack(pop)
@@ -27,7 +27,7 @@ struct CarlaRecorderWalkerBones
   
   void Read(std::ifstream &InFile);
 
-  void Write(std::ofstream &OutFile);
+  void Write(std::ostream &OutFile);
 
   void Clear();
 
@@ -42,7 +42,7 @@ public:
 
   void Clear(void);
 
-  void Write(std::ofstream &OutFile);
+  void Write(std::ostream &OutFile);
 
 private:
 
@@ -0,0 +1,329 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "CarlaRecorderWriter.h"
+
+#include <compiler/disable-ue4-macros.h>
+#include "carla/recorder/BlockCodec.h"
+#include <compiler/enable-ue4-macros.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+// ---------------------------------------------
+// CarlaRecorderMemoryBuffer
+// ---------------------------------------------
+
+static constexpr size_t INITIAL_BUFFER_CAPACITY = 64u << 10u;
+
+// 保留的空闲缓冲区个数，避免背压解除后长期占用内存
+static constexpr size_t MAX_FREE_BUFFERS = 4u;
+
+CarlaRecorderMemoryBuffer::CarlaRecorderMemoryBuffer()
+{
+  Buffer.resize(INITIAL_BUFFER_CAPACITY);
+  Reset();
+}
+
+void CarlaRecorderMemoryBuffer::Reset()
+{
+  HighWater = 0u;
+  setp(Buffer.data(), Buffer.data() + Buffer.size());
+}
+
+size_t CarlaRecorderMemoryBuffer::Size() const
+{
+  return std::max(HighWater, static_cast<size_t>(pptr() - pbase()));
+}
+
+void CarlaRecorderMemoryBuffer::Exchange(std::vector<char> &Other)
+{
+  Buffer.resize(Size());
+  std::swap(Buffer, Other);
+  Buffer.resize(std::max(Buffer.capacity(), INITIAL_BUFFER_CAPACITY));
+  Reset();
+}
+
+void CarlaRecorderMemoryBuffer::UpdateHighWater()
+{
+  HighWater = Size();
+}
+
+void CarlaRecorderMemoryBuffer::SetPutOffset(size_t Offset)
+{
+  setp(Buffer.data(), Buffer.data() + Buffer.size());
+  pbump(static_cast<int>(Offset));
+}
+
+void CarlaRecorderMemoryBuffer::Grow(size_t MinCapacity)
+{
+  const size_t Offset = static_cast<size_t>(pptr() - pbase());
+  UpdateHighWater();
+  Buffer.resize(std::max(2u * Buffer.size(), MinCapacity));
+  SetPutOffset(Offset);
+}
+
+CarlaRecorderMemoryBuffer::int_type CarlaRecorderMemoryBuffer::overflow(int_type Ch)
+{
+  if (traits_type::eq_int_type(Ch, traits_type::eof()))
+  {
+    return traits_type::not_eof(Ch);
+  }
+  Grow(Buffer.size() + 1u);
+  *pptr() = traits_type::to_char_type(Ch);
+  pbump(1);
+  return Ch;
+}
+
+std::streamsize CarlaRecorderMemoryBuffer::xsputn(const char *Data, std::streamsize Count)
+{
+  const size_t Offset = static_cast<size_t>(pptr() - pbase());
+  const size_t Required = Offset + static_cast<size_t>(Count);
+  if (Required > Buffer.size())
+  {
+    Grow(Required);
+  }
+  std::memcpy(pptr(), Data, static_cast<size_t>(Count));
+  pbump(static_cast<int>(Count));
+  return Count;
+}
+
+CarlaRecorderMemoryBuffer::pos_type CarlaRecorderMemoryBuffer::seekoff(
+    off_type Offset,
+    std::ios_base::seekdir Dir,
+    std::ios_base::openmode Which)
+{
+  if ((Which & std::ios_base::out) == 0)
+  {
+    return pos_type(off_type(-1));
+  }
+  UpdateHighWater();
+  off_type Base = 0;
+  if (Dir == std::ios_base::cur)
+  {
+    Base = static_cast<off_type>(pptr() - pbase());
+  }
+  else if (Dir == std::ios_base::end)
+  {
+    Base = static_cast<off_type>(HighWater);
+  }
+  const off_type NewOffset = Base + Offset;
+  if (NewOffset < 0 || NewOffset > static_cast<off_type>(HighWater))
+  {
+    return pos_type(off_type(-1));
+  }
+  SetPutOffset(static_cast<size_t>(NewOffset));
+  return pos_type(NewOffset);
+}
+
+CarlaRecorderMemoryBuffer::pos_type CarlaRecorderMemoryBuffer::seekpos(
+    pos_type Pos,
+    std::ios_base::openmode Which)
+{
+  return seekoff(off_type(Pos), std::ios_base::beg, Which);
+}
+
+// ---------------------------------------------
+// CarlaRecorderWriter
+// ---------------------------------------------
+
+CarlaRecorderWriter::~CarlaRecorderWriter()
+{
+  Close();
+}
+
+bool CarlaRecorderWriter::Open(const std::string &Filename, const CarlaRecorderWriterSettings &InSettings)
+{
+  Close();
+
+  File.open(Filename, std::ios::binary);
+  if (!File.is_open())
+  {
+    return false;
+  }
+
+  Settings = InSettings;
+  Stats = CarlaRecorderWriterStats();
+  bStopping = false;
+  bHasHeldFrame = false;
+  Block.clear();
+  FrontBuffer.Reset();
+  Stream.clear();
+
+  WriterThread = std::thread(&CarlaRecorderWriter::Run, this);
+  return true;
+}
+
+void CarlaRecorderWriter::Close()
+{
+  if (!WriterThread.joinable())
+  {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    bStopping = true;
+  }
+  PendingReady.notify_all();
+  WriterThread.join();
+  File.close();
+}
+
+void CarlaRecorderWriter::CommitHeader()
+{
+  Commit(true, 0u, 0.0);
+}
+
+void CarlaRecorderWriter::CommitFrame(size_t DurationOffset, double DurationThis)
+{
+  Commit(false, DurationOffset, DurationThis);
+}
+
+CarlaRecorderWriterStats CarlaRecorderWriter::GetStats() const
+{
+  std::lock_guard<std::mutex> Lock(Mutex);
+  return Stats;
+}
+
+void CarlaRecorderWriter::Commit(bool bIsHeader, size_t DurationOffset, double DurationThis)
+{
+  std::unique_lock<std::mutex> Lock(Mutex);
+
+  // 背压：写入线程跟不上时阻塞游戏线程，而不是无限制地占用内存
+  if (PendingBytes > Settings.MaxPendingBytes && !Pending.empty())
+  {
+    const auto Start = std::chrono::steady_clock::now();
+    PendingDrained.wait(Lock, [this]()
+    {
+      return PendingBytes <= Settings.MaxPendingBytes || Pending.empty();
+    });
+    const std::chrono::duration<double> Elapsed = std::chrono::steady_clock::now() - Start;
+    ++Stats.Stalls;
+    Stats.StallSeconds += Elapsed.count();
+  }
+
+  FPendingBuffer Buffer;
+  if (!FreeBuffers.empty())
+  {
+    Buffer.Data = std::move(FreeBuffers.back());
+    FreeBuffers.pop_back();
+  }
+  FrontBuffer.Exchange(Buffer.Data);
+  Stream.clear();
+  Buffer.bIsHeader = bIsHeader;
+  Buffer.DurationOffset = DurationOffset;
+  Buffer.DurationThis = DurationThis;
+
+  const size_t Size = Buffer.Data.size();
+  PendingBytes += Size;
+  Stats.RawBytes += Size;
+  Stats.PeakPendingBytes = std::max<uint64_t>(Stats.PeakPendingBytes, PendingBytes);
+  if (!bIsHeader)
+  {
+    ++Stats.Frames;
+  }
+  Pending.emplace_back(std::move(Buffer));
+  Lock.unlock();
+  PendingReady.notify_one();
+}
+
+void CarlaRecorderWriter::Run()
+{
+  std::unique_lock<std::mutex> Lock(Mutex);
+  while (true)
+  {
+    PendingReady.wait(Lock, [this]() { return !Pending.empty() || bStopping; });
+    if (Pending.empty())
+    {
+      break;
+    }
+    FPendingBuffer Buffer = std::move(Pending.front());
+    Pending.pop_front();
+    const size_t Size = Buffer.Data.size();
+    Lock.unlock();
+
+    if (Buffer.bIsHeader)
+    {
+      // 文件头总是在所有帧之前提交，直接写出
+      WriteToFile(Buffer.Data.data(), Buffer.Data.size());
+    }
+    else
+    {
+      WriteFrame(Buffer);
+    }
+
+    Lock.lock();
+    PendingBytes -= Size;
+    if (FreeBuffers.size() < MAX_FREE_BUFFERS)
+    {
+      Buffer.Data.clear();
+      FreeBuffers.emplace_back(std::move(Buffer.Data));
+    }
+    PendingDrained.notify_all();
+  }
+  Lock.unlock();
+
+  // 最后一帧没有下一帧回填时长
+  if (bHasHeldFrame)
+  {
+    EmitFrame(HeldFrame);
+    bHasHeldFrame = false;
+  }
+  FlushBlock();
+  File.flush();
+}
+
+void CarlaRecorderWriter::WriteFrame(FPendingBuffer &Buffer)
+{
+  if (bHasHeldFrame)
+  {
+    // 本帧的时长即上一帧的 DurationThis
+    if (HeldDurationOffset + sizeof(double) <= HeldFrame.size())
+    {
+      std::memcpy(HeldFrame.data() + HeldDurationOffset, &Buffer.DurationThis, sizeof(double));
+    }
+    EmitFrame(HeldFrame);
+  }
+  // 交换后 Buffer.Data 持有旧的缓冲区，由调用者回收
+  std::swap(HeldFrame, Buffer.Data);
+  HeldDurationOffset = Buffer.DurationOffset;
+  bHasHeldFrame = true;
+}
+
+void CarlaRecorderWriter::EmitFrame(const std::vector<char> &Frame)
+{
+  if (!Settings.bCompress)
+  {
+    WriteToFile(Frame.data(), Frame.size());
+    return;
+  }
+  // 块中只包含完整的帧
+  Block.insert(Block.end(), Frame.begin(), Frame.end());
+  if (Block.size() >= Settings.BlockSize)
+  {
+    FlushBlock();
+  }
+}
+
+void CarlaRecorderWriter::FlushBlock()
+{
+  if (Block.empty())
+  {
+    return;
+  }
+  CompressedBlock.clear();
+  carla::recorder::BlockCodec::EncodeBlock(Block.data(), Block.size(), CompressedBlock);
+  WriteToFile(CompressedBlock.data(), CompressedBlock.size());
+  Block.clear();
+}
+
+void CarlaRecorderWriter::WriteToFile(const char *Data, size_t Size)
+{
+  File.write(Data, static_cast<std::streamsize>(Size));
+  std::lock_guard<std::mutex> Lock(Mutex);
+  Stats.WrittenBytes += Size;
+}
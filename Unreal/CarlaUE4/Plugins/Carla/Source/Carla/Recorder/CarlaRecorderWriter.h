@@ -0,0 +1,196 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// 可随机写入（seekp）的内存输出缓冲区，各数据包序列化时会回到开头补写大小
+class CarlaRecorderMemoryBuffer : public std::streambuf
+{
+public:
+
+  CarlaRecorderMemoryBuffer();
+
+  void Reset();
+
+  size_t Size() const;
+
+  /// 取出已写入的数据并换用 @a Other 的存储（保留其容量）继续写入
+  void Exchange(std::vector<char> &Other);
+
+protected:
+
+  int_type overflow(int_type Ch) override;
+
+  std::streamsize xsputn(const char *Data, std::streamsize Count) override;
+
+  pos_type seekoff(off_type Offset, std::ios_base::seekdir Dir, std::ios_base::openmode Which) override;
+
+  pos_type seekpos(pos_type Pos, std::ios_base::openmode Which) override;
+
+private:
+
+  void Grow(size_t MinCapacity);
+
+  void UpdateHighWater();
+
+  void SetPutOffset(size_t Offset);
+
+  std::vector<char> Buffer;
+
+  /// 已写入的最大偏移（seekp 回退后 pptr 可能小于它）
+  size_t HighWater = 0u;
+};
+
+struct CarlaRecorderWriterSettings
+{
+  /// 把帧数据按块压缩（位置差分 + LZ），写出的文件版本为 2
+  bool bCompress = false;
+
+  /// 压缩时每块的目标大小（原始字节数）
+  size_t BlockSize = 1u << 20u;
+
+  /// 等待写入的数据上限，超过时游戏线程阻塞等待（背压）
+  size_t MaxPendingBytes = 64u << 20u;
+};
+
+struct CarlaRecorderWriterStats
+{
+  uint64_t Frames = 0u;
+  /// 序列化后的原始字节数
+  uint64_t RawBytes = 0u;
+  /// 实际写入文件的字节数
+  uint64_t WrittenBytes = 0u;
+  /// 游戏线程因背压而阻塞的次数与总时长
+  uint64_t Stalls = 0u;
+  double StallSeconds = 0.0;
+  /// 等待写入数据的峰值
+  uint64_t PeakPendingBytes = 0u;
+};
+
+/// 录制文件的后台写入器
+///
+/// 游戏线程把每一帧序列化到内存缓冲区（GetStream），CommitFrame 后缓冲区
+/// 交给后台线程写入文件（可选压缩），游戏线程换用另一个空闲缓冲区继续下一帧，
+/// 不再在每帧中同步进行文件 IO。
+///
+/// 帧开始数据包中的 DurationThis 要等下一帧才知道，写入线程会保留最近一帧，
+/// 收到下一帧时回填后再写出，最后一帧保持 -1，与同步写入的文件一致。
+class CarlaRecorderWriter
+{
+public:
+
+  CarlaRecorderWriter() = default;
+
+  ~CarlaRecorderWriter();
+
+  CarlaRecorderWriter(const CarlaRecorderWriter &) = delete;
+  CarlaRecorderWriter &operator=(const CarlaRecorderWriter &) = delete;
+
+  bool Open(const std::string &Filename, const CarlaRecorderWriterSettings &InSettings);
+
+  bool IsOpen() const
+  {
+    return WriterThread.joinable();
+  }
+
+  /// 写入所有剩余数据并关闭文件
+  void Close();
+
+  /// 当前帧的序列化目标
+  std::ostream &GetStream()
+  {
+    return Stream;
+  }
+
+  /// 把当前缓冲区的内容作为文件头提交，不压缩
+  void CommitHeader();
+
+  /// 把当前缓冲区的内容作为一帧提交
+  ///
+  /// @param DurationOffset 帧开始数据包中 DurationThis 字段在本帧中的偏移
+  /// @param DurationThis 本帧的时长，回填到上一帧中
+  void CommitFrame(size_t DurationOffset, double DurationThis);
+
+  CarlaRecorderWriterStats GetStats() const;
+
+private:
+
+  struct FPendingBuffer
+  {
+    std::vector<char> Data;
+    bool bIsHeader = false;
+    size_t DurationOffset = 0u;
+    double DurationThis = 0.0;
+  };
+
+  void Commit(bool bIsHeader, size_t DurationOffset, double DurationThis);
+
+  void Run();
+
+  void WriteFrame(FPendingBuffer &Buffer);
+
+  void EmitFrame(const std::vector<char> &Frame);
+
+  void FlushBlock();
+
+  void WriteToFile(const char *Data, size_t Size);
+
+  CarlaRecorderWriterSettings Settings;
+
+  // -- 游戏线程 --------------------------------------------------------------
+
+  CarlaRecorderMemoryBuffer FrontBuffer;
+
+  std::ostream Stream{&FrontBuffer};
+
+  // -- 共享状态（由 Mutex 保护） ----------------------------------------------
+
+  mutable std::mutex Mutex;
+
+  std::condition_variable PendingReady;
+
+  std::condition_variable PendingDrained;
+
+  std::deque<FPendingBuffer> Pending;
+
+  /// 可重复使用的空缓冲区
+  std::vector<std::vector<char>> FreeBuffers;
+
+  size_t PendingBytes = 0u;
+
+  bool bStopping = false;
+
+  CarlaRecorderWriterStats Stats;
+
+  // -- 写入线程 ---------------------------------------------------------------
+
+  std::ofstream File;
+
+  /// 等待下一帧回填时长的帧
+  std::vector<char> HeldFrame;
+
+  bool bHasHeldFrame = false;
+
+  size_t HeldDurationOffset = 0u;
+
+  /// 压缩时正在累积的块
+  std::vector<char> Block;
+
+  std::vector<char> CompressedBlock;
+
+  std::thread WriterThread;
+};
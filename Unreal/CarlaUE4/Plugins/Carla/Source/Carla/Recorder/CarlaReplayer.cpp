@@ -32,6 +32,7 @@ void CarlaReplayer::Stop(bool bKeepActors)
 
   if (File.is_open())
     File.close();
+  DecodedFile.Close();
 }
 
 bool CarlaReplayer::ReadHeader()
@@ -121,8 +122,7 @@ std::string CarlaReplayer::ReplayFile(std::string Filename, double TimeStart, do
   Info << "Replaying File: " << Filename2 << std::endl;
 
   // try to open
-  File.open(Filename2, std::ios::binary);
-  if (!File.is_open())
+  if (!OpenRecorderFile(File, DecodedFile, Filename2))
   {
     Info << "File " << Filename2 << " not found on server\n";
     Stop();
@@ -216,8 +216,7 @@ void CarlaReplayer::CheckPlayAfterMapLoaded(void)
   }
 
   // try to open
-  File.open(Autoplay.Filename, std::ios::binary);
-  if (!File.is_open())
+  if (!OpenRecorderFile(File, DecodedFile, Autoplay.Filename))
   {
     return;
   }
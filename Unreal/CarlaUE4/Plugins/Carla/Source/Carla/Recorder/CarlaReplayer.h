@@ -105,6 +105,8 @@ private:
   UCarlaEpisode *Episode = nullptr;
   // binary file reader
   std::ifstream File;
+  // decoded data of compressed files
+  carla::recorder::DecodingStreamBuf DecodedFile;
   Header Header;
   CarlaRecorderInfo RecInfo;
   CarlaRecorderFrame Frame;
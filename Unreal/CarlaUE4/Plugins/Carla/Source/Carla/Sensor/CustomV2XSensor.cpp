@@ -16,6 +16,7 @@
 
 std::list<AActor *> ACustomV2XSensor::mV2XActorContainer;
 ACustomV2XSensor::ActorV2XDataMap ACustomV2XSensor::mActorV2XDataMap;
+V2XChannel ACustomV2XSensor::mV2XChannel;
 
 ACustomV2XSensor::ACustomV2XSensor(const FObjectInitializer &ObjectInitializer)
     : Super(ObjectInitializer)
@@ -84,6 +85,7 @@ void ACustomV2XSensor::SetPropagationParams(const float TransmitPower,
 {
     // forward parameters to PathLossModel Obj
     PathLossModelObj->SetParams(TransmitPower, ReceiverSensitivity, Frequency, combined_antenna_gain, path_loss_exponent, reference_distance_fspl, filter_distance, use_etsi_fading, custom_fading_stddev);
+    ACustomV2XSensor::mV2XChannel.RequireDistance(filter_distance);
 }
 
 void ACustomV2XSensor::SetPathLossModel(const EPathLossModel path_loss_model){
@@ -170,7 +172,13 @@ void ACustomV2XSensor::PostPhysTick(UWorld *World, ELevelTick TickType, float De
     if (!ActorPowerList.empty())
     {
         UCarlaEpisode *carla_episode = UCarlaStatics::GetCurrentEpisode(GetWorld());
-        PathLossModelObj->Simulate(ActorPowerList, carla_episode, GetWorld());
+        std::vector<AActor *> Senders;
+        for (const auto &pair : ACustomV2XSensor::mActorV2XDataMap)
+        {
+            Senders.push_back(pair.first);
+        }
+        ACustomV2XSensor::mV2XChannel.Update(GetWorld(), carla_episode, ACustomV2XSensor::mV2XActorContainer, Senders);
+        PathLossModelObj->Simulate(ActorPowerList, carla_episode, GetWorld(), ACustomV2XSensor::mV2XChannel);
         // Step 3: Get the list of actors who can send message to current actor, and the receive power of their messages.
         ActorPowerMap actor_receivepower_map = PathLossModelObj->GetReceiveActorPowerList();
         // Step 4: Retrieve the messages of the actors that are received
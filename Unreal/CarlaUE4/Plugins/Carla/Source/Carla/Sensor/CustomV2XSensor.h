@@ -11,6 +11,7 @@
 #include "Carla/Actor/ActorDescription.h"
 #include <carla/sensor/data/V2XData.h>
 #include "V2X/PathLossModel.h"
+#include "V2X/V2XChannel.h"
 #include <list>
 #include <map>
 #include "CustomV2XSensor.generated.h"
@@ -51,6 +52,8 @@ public:
 
 private:
     static std::list<AActor *> mV2XActorContainer;
+    // LOS/NLOS state shared by all sensors of this type, computed once per tick
+    static V2XChannel mV2XChannel;
     PathLossModel *PathLossModelObj;
 
     //store data
@@ -54,15 +54,11 @@ void AObstacleDetectionSensor::Set(const FActorDescription &Description)
 #endif
 }
 
-void AObstacleDetectionSensor::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTime)
+void AObstacleDetectionSensor::EnqueueTraces(FSensorTraceQueue &Queue, float DeltaSeconds)
 {
-  TRACE_CPUPROFILER_EVENT_SCOPE(AObstacleDetectionSensor::PostPhysTick);
+  TRACE_CPUPROFILER_EVENT_SCOPE(AObstacleDetectionSensor::EnqueueTraces);
   const FVector &Start = GetActorLocation();
   const FVector &End = Start + (GetActorForwardVector() * Distance);
-  UWorld* CurrentWorld = GetWorld();
-
-  // Struct in which the result of the scan will be saved
-  FHitResult HitOut = FHitResult();
 
   // Initialization of Query Parameters
   FCollisionQueryParams TraceParams(FName(TEXT("ObstacleDetection Trace")), true, this);
@@ -73,7 +69,7 @@ void AObstacleDetectionSensor::PostPhysTick(UWorld *World, ELevelTick TickType,
   if (bDebugLineTrace)
   {
     const FName TraceTag("ObstacleDebugTrace");
-    CurrentWorld->DebugDrawTraceTag = TraceTag;
+    GetWorld()->DebugDrawTraceTag = TraceTag;
     TraceParams.TraceTag = TraceTag;
   }
 #endif
@@ -92,7 +88,6 @@ void AObstacleDetectionSensor::PostPhysTick(UWorld *World, ELevelTick TickType,
   if(Super::GetOwner()!=nullptr)
     TraceParams.AddIgnoredActor(Super::GetOwner());
 
-  bool isHitReturned;
   // Choosing a type of sweep is a workaround until everything get properly
   // organized under correct collision channels and object types.
   if (bOnlyDynamics)
@@ -100,13 +95,11 @@ void AObstacleDetectionSensor::PostPhysTick(UWorld *World, ELevelTick TickType,
     // If we go only for dynamics, we check the object type AllDynamicObjects
     FCollisionObjectQueryParams TraceChannel = FCollisionObjectQueryParams(
         FCollisionObjectQueryParams::AllDynamicObjects);
-    isHitReturned = CurrentWorld->SweepSingleByObjectType(
-        HitOut,
+    TraceHandle = Queue.AddSweepByObjectType(
         Start,
         End,
-        FQuat(),
-        TraceChannel,
         FCollisionShape::MakeSphere(HitRadius),
+        TraceChannel,
         TraceParams);
   }
   else
@@ -114,18 +107,22 @@ void AObstacleDetectionSensor::PostPhysTick(UWorld *World, ELevelTick TickType,
     // Else, if we go for everything, we get everything that interacts with a
     // Pawn
     ECollisionChannel TraceChannel = ECC_WorldStatic;
-    isHitReturned = CurrentWorld->SweepSingleByChannel(
-        HitOut,
+    TraceHandle = Queue.AddSweep(
         Start,
         End,
-        FQuat(),
-        TraceChannel,
         FCollisionShape::MakeSphere(HitRadius),
+        TraceChannel,
         TraceParams);
   }
+}
 
-  if (isHitReturned)
+void AObstacleDetectionSensor::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTime)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(AObstacleDetectionSensor::PostPhysTick);
+  const FSensorTraceQueue &Queue = GetTraceQueue();
+  if (Queue.IsHit(TraceHandle, 0))
   {
+    const FHitResult &HitOut = Queue.GetHit(TraceHandle, 0);
     OnObstacleDetectionEvent(this, HitOut.Actor.Get(), HitOut.Distance, HitOut);
   }
 }
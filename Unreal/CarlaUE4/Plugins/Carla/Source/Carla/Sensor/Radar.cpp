@@ -4,13 +4,10 @@
 // This work is licensed under the terms of the MIT license.
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
-#include <PxScene.h>
-
 #include "Carla.h"
 #include "Carla/Sensor/Radar.h"
 #include "Carla/Actor/ActorBlueprintFunctionLibrary.h"
 #include "Kismet/KismetMathLibrary.h"
-#include "Runtime/Core/Public/Async/ParallelFor.h"
 
 #include <compiler/disable-ue4-macros.h>
 #include "carla/geom/Math.h"
@@ -69,13 +66,36 @@ void ARadar::BeginPlay()
   PrevLocation = GetActorLocation();
 }
 
+void ARadar::EnqueueTraces(FSensorTraceQueue &Queue, float DeltaTime)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(ARadar::EnqueueTraces);
+  const FRotator TransformRotator = GetActorTransform().Rotator();
+  const FVector RadarLocation = GetActorLocation();
+
+  // Maximum radar radius in horizontal and vertical direction
+  const float MaxRx = FMath::Tan(FMath::DegreesToRadians(HorizontalFOV * 0.5f)) * Range;
+  const float MaxRy = FMath::Tan(FMath::DegreesToRadians(VerticalFOV * 0.5f)) * Range;
+  const int NumPoints = (int)(PointsPerSecond * DeltaTime);
+
+  // Generate the parameters of the rays in a deterministic way
+  RayEnds.resize(NumPoints);
+  TraceHandle = Queue.AddLineTraces(NumPoints, ECC_GameTraceChannel2, TraceParams);
+  for (int i = 0; i < NumPoints; i++) {
+    const float Radius = RandomEngine->GetUniformFloat();
+    const float Angle = RandomEngine->GetUniformFloatInRange(0.0f, carla::geom::Math::Pi2<float>());
+    const auto End = carla::sensor::RadarKernel::GetRayEnd(Range, MaxRx, MaxRy, Radius, Angle);
+    RayEnds[i] = FVector(End.x, End.y, End.z);
+    Queue.SetTrace(TraceHandle, i, RadarLocation, RadarLocation + TransformRotator.RotateVector(RayEnds[i]));
+  }
+}
+
 void ARadar::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTime)
 {
   TRACE_CPUPROFILER_EVENT_SCOPE(ARadar::PostPhysTick);
   CalculateCurrentVelocity(DeltaTime);
 
   RadarData.Reset();
-  SendLineTraces(DeltaTime);
+  ProcessTraces();
 
   auto DataStream = GetDataStream(*this);
 
@@ -112,103 +132,37 @@ void ARadar::CalculateCurrentVelocity(const float DeltaTime)
   PrevLocation = RadarLocation;
 }
 
-void ARadar::SendLineTraces(float DeltaTime)
+void ARadar::ProcessTraces()
 {
-  TRACE_CPUPROFILER_EVENT_SCOPE(ARadar::SendLineTraces);
+  TRACE_CPUPROFILER_EVENT_SCOPE(ARadar::ProcessTraces);
   constexpr float TO_METERS = 1e-2;
-  const FTransform& ActorTransform = GetActorTransform();
-  const FRotator& TransformRotator = ActorTransform.Rotator();
-  const FVector& RadarLocation = GetActorLocation();
-  const FVector& ForwardVector = GetActorForwardVector();
-  const FVector TransformXAxis = ActorTransform.GetUnitAxis(EAxis::X);
-  const FVector TransformYAxis = ActorTransform.GetUnitAxis(EAxis::Y);
-  const FVector TransformZAxis = ActorTransform.GetUnitAxis(EAxis::Z);
-
-  // Maximum radar radius in horizontal and vertical direction
-  const float MaxRx = FMath::Tan(FMath::DegreesToRadians(HorizontalFOV * 0.5f)) * Range;
-  const float MaxRy = FMath::Tan(FMath::DegreesToRadians(VerticalFOV * 0.5f)) * Range;
-  const int NumPoints = (int)(PointsPerSecond * DeltaTime);
-
-  // Generate the parameters of the rays in a deterministic way
-  Rays.clear();
-  Rays.resize(NumPoints);
-  for (int i = 0; i < Rays.size(); i++) {
-    Rays[i].Radius = RandomEngine->GetUniformFloat();
-    Rays[i].Angle = RandomEngine->GetUniformFloatInRange(0.0f, carla::geom::Math::Pi2<float>());
-    Rays[i].Hitted = false;
-  }
-
-  FCriticalSection Mutex;
-  GetWorld()->GetPhysicsScene()->GetPxScene()->lockRead();
-  {
-    TRACE_CPUPROFILER_EVENT_SCOPE(ParallelFor);
-    ParallelFor(NumPoints, [&](int32 idx) {
-      TRACE_CPUPROFILER_EVENT_SCOPE(ParallelForTask);
-      FHitResult OutHit(ForceInit);
-      const float Radius = Rays[idx].Radius;
-      const float Angle  = Rays[idx].Angle;
-
-      float Sin, Cos;
-      FMath::SinCos(&Sin, &Cos, Angle);
-
-      const FVector EndLocation = RadarLocation + TransformRotator.RotateVector({
-        Range,
-        MaxRx * Radius * Cos,
-        MaxRy * Radius * Sin
-      });
-
-      const bool Hitted = GetWorld()->ParallelLineTraceSingleByChannel(
-        OutHit,
-        RadarLocation,
-        EndLocation,
-        ECC_GameTraceChannel2,
-        TraceParams,
-        FCollisionResponseParams::DefaultResponseParam
-      );
-
-      const TWeakObjectPtr<AActor> HittedActor = OutHit.Actor;
-      if (Hitted && HittedActor.Get()) {
-        Rays[idx].Hitted = true;
-
-        Rays[idx].RelativeVelocity = CalculateRelativeVelocity(OutHit, RadarLocation);
-
-        Rays[idx].AzimuthAndElevation = FMath::GetAzimuthAndElevation (
-          (EndLocation - RadarLocation).GetSafeNormal() * Range,
-          TransformXAxis,
-          TransformYAxis,
-          TransformZAxis
-        );
-
-        Rays[idx].Distance = OutHit.Distance * TO_METERS;
-      }
-    });
-  }
-  GetWorld()->GetPhysicsScene()->GetPxScene()->unlockRead();
-
-  // Write the detections in the output structure
-  for (auto& ray : Rays) {
-    if (ray.Hitted) {
-      RadarData.WriteDetection({
-        ray.RelativeVelocity,
-        ray.AzimuthAndElevation.X,
-        ray.AzimuthAndElevation.Y,
-        ray.Distance
-      });
+  const FSensorTraceQueue &Queue = GetTraceQueue();
+
+  // Gather the hits in ray order; the velocity of the targets has to be read
+  // on the game thread.
+  Hits.Clear();
+  Hits.Reserve(RayEnds.size());
+  for (int32 i = 0; i < Queue.GetNum(TraceHandle); i++) {
+    if (!Queue.IsHit(TraceHandle, i)) {
+      continue;
     }
+    const FHitResult &OutHit = Queue.GetHit(TraceHandle, i);
+    const AActor *HittedActor = OutHit.Actor.Get();
+    if (HittedActor == nullptr) {
+      continue;
+    }
+    const FVector TargetVelocity = HittedActor->GetVelocity() * TO_METERS;
+    Hits.AddHit(
+        {RayEnds[i].X, RayEnds[i].Y, RayEnds[i].Z},
+        carla::geom::Location(OutHit.ImpactPoint),
+        {TargetVelocity.X, TargetVelocity.Y, TargetVelocity.Z},
+        OutHit.Distance * TO_METERS);
   }
 
-}
-
-float ARadar::CalculateRelativeVelocity(const FHitResult& OutHit, const FVector& RadarLocation)
-{
-  constexpr float TO_METERS = 1e-2;
-
-  const TWeakObjectPtr<AActor> HittedActor = OutHit.Actor;
-  const FVector TargetVelocity = HittedActor->GetVelocity();
-  const FVector TargetLocation = OutHit.ImpactPoint;
-  const FVector Direction = (TargetLocation - RadarLocation).GetSafeNormal();
-  const FVector DeltaVelocity = (TargetVelocity - CurrentVelocity);
-  const float V = TO_METERS * FVector::DotProduct(DeltaVelocity, Direction);
-
-  return V;
+  const FVector RadarVelocity = CurrentVelocity * TO_METERS;
+  carla::sensor::RadarKernel::Process(
+      Hits,
+      carla::geom::Location(GetActorLocation()),
+      {RadarVelocity.X, RadarVelocity.Y, RadarVelocity.Z},
+      RadarData);
 }
@@ -7,13 +7,17 @@
 #pragma once
 
 #include "Carla/Sensor/Sensor.h"
+#include "Carla/Sensor/SensorTraceQueue.h"
 
 #include "Carla/Actor/ActorDefinition.h"
 
 #include <compiler/disable-ue4-macros.h>
+#include <carla/sensor/RadarKernel.h>
 #include <carla/sensor/data/RadarData.h>
 #include <compiler/enable-ue4-macros.h>
 
+#include <vector>
+
 #include "Radar.generated.h"
 
 /// A ray-cast based Radar sensor.
@@ -49,6 +53,7 @@ protected:
   void BeginPlay() override;
 
   // virtual void PrePhysTick(float DeltaTime) override;
+  virtual void EnqueueTraces(FSensorTraceQueue &Queue, float DeltaTime) override;
   virtual void PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTime) override;
 
   UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Detection")
@@ -67,9 +72,9 @@ private:
 
   void CalculateCurrentVelocity(const float DeltaTime);
 
-  void SendLineTraces(float DeltaTime);
-
-  float CalculateRelativeVelocity(const FHitResult& OutHit, const FVector& RadarLocation);
+  /// Compute the detections from the results of the traces enqueued in
+  /// EnqueueTraces.
+  void ProcessTraces();
 
   FRadarData RadarData;
 
@@ -80,14 +85,10 @@ private:
   /// Used to compute the velocity of the radar
   FVector PrevLocation;
 
-  struct RayData {
-    float Radius;
-    float Angle;
-    bool Hitted;
-    float RelativeVelocity;
-    FVector2D AzimuthAndElevation;
-    float Distance;
-  };
+  FSensorTraceQueue::FHandle TraceHandle = FSensorTraceQueue::InvalidHandle;
+
+  /// End of each ray relative to the radar, not rotated.
+  std::vector<FVector> RayEnds;
 
-  std::vector<RayData> Rays;
+  carla::sensor::RadarHits Hits;
 };
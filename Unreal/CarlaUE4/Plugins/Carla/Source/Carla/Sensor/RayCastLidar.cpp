@@ -9,12 +9,14 @@
 #include "Carla.h"
 #include "Carla/Sensor/RayCastLidar.h"
 #include "Carla/Actor/ActorBlueprintFunctionLibrary.h"
+#include "Carla/Game/CarlaEngine.h"
 #include "carla/geom/Math.h"
 
 #include <compiler/disable-ue4-macros.h>
 #include "carla/geom/Math.h"
 #include "carla/ros2/ROS2.h"
 #include "carla/geom/Location.h"
+#include "carla/geom/Transform.h"
 #include <compiler/enable-ue4-macros.h>
 
 #include "DrawDebugHelpers.h"
@@ -49,9 +51,11 @@ void ARayCastLidar::Set(const FLidarDescription &LidarDescription)
   CreateLasers();
   PointsPerChannel.resize(Description.Channels);
 
-  // Compute drop off model parameters
-  DropOffBeta = 1.0f - Description.DropOffAtZeroIntensity;
-  DropOffAlpha = Description.DropOffAtZeroIntensity / Description.DropOffIntensityLimit;
+  PostprocessParams.atmosp_atten_rate = Description.AtmospAttenRate;
+  PostprocessParams.noise_stddev = Description.NoiseStdDev;
+  PostprocessParams.dropoff_gen_rate = Description.DropOffGenRate;
+  PostprocessParams.dropoff_intensity_limit = Description.DropOffIntensityLimit;
+  PostprocessParams.dropoff_at_zero_intensity = Description.DropOffAtZeroIntensity;
   DropOffGenActive = Description.DropOffGenRate > std::numeric_limits<float>::epsilon();
 }
 
@@ -90,77 +94,41 @@ void ARayCastLidar::PostPhysTick(UWorld *World, ELevelTick TickType, float Delta
 
 }
 
-float ARayCastLidar::ComputeIntensity(const FSemanticDetection& RawDetection) const
-{
-  const carla::geom::Location HitPoint = RawDetection.point;
-  const float Distance = HitPoint.Length();
-
-  const float AttenAtm = Description.AtmospAttenRate;
-  const float AbsAtm = exp(-AttenAtm * Distance);
-
-  const float IntRec = AbsAtm;
-
-  return IntRec;
-}
-
-ARayCastLidar::FDetection ARayCastLidar::ComputeDetection(const FHitResult& HitInfo, const FTransform& SensorTransf) const
-{
-  FDetection Detection;
-  const FVector HitPoint = HitInfo.ImpactPoint;
-  Detection.point = SensorTransf.Inverse().TransformPosition(HitPoint);
-
-  const float Distance = Detection.point.Length();
-
-  const float AttenAtm = Description.AtmospAttenRate;
-  const float AbsAtm = exp(-AttenAtm * Distance);
-
-  const float IntRec = AbsAtm;
-
-  Detection.intensity = IntRec;
-
-  return Detection;
-}
+void ARayCastLidar::PreprocessRays(uint32_t Channels, uint32_t MaxPointsPerChannel) {
+  Super::PreprocessRays(Channels, MaxPointsPerChannel);
 
-  void ARayCastLidar::PreprocessRays(uint32_t Channels, uint32_t MaxPointsPerChannel) {
-    Super::PreprocessRays(Channels, MaxPointsPerChannel);
-
-    for (auto ch = 0u; ch < Channels; ch++) {
-      for (auto p = 0u; p < MaxPointsPerChannel; p++) {
-        RayPreprocessCondition[ch][p] = !(DropOffGenActive && RandomEngine->GetUniformFloat() < Description.DropOffGenRate);
-      }
-    }
+  // Ray dropoff, noise and intensity dropoff of this frame only depend on the
+  // seed and the frame number
+  using carla::sensor::LidarPostprocess;
+  RandomKey = LidarPostprocess::MakeKey(Description.RandomSeed, FCarlaEngine::GetFrameCounter());
+  if (!DropOffGenActive) {
+    return;
   }
-
-  bool ARayCastLidar::PostprocessDetection(FDetection& Detection) const
-  {
-    if (Description.NoiseStdDev > std::numeric_limits<float>::epsilon()) {
-      const auto ForwardVector = Detection.point.MakeUnitVector();
-      const auto Noise = ForwardVector * RandomEngine->GetNormalDistribution(0.0f, Description.NoiseStdDev);
-      Detection.point += Noise;
+  for (auto ch = 0u; ch < Channels; ch++) {
+    for (auto p = 0u; p < MaxPointsPerChannel; p++) {
+      const uint32_t Ray = ch * MaxPointsPerChannel + p;
+      RayPreprocessCondition[ch][p] = LidarPostprocess::KeepRay(RandomKey, Ray, Description.DropOffGenRate);
     }
-
-    const float Intensity = Detection.intensity;
-    if(Intensity > Description.DropOffIntensityLimit)
-      return true;
-    else
-      return RandomEngine->GetUniformFloat() < DropOffAlpha * Intensity + DropOffBeta;
   }
+}
 
-  void ARayCastLidar::ComputeAndSaveDetections(const FTransform& SensorTransform) {
-    for (auto idxChannel = 0u; idxChannel < Description.Channels; ++idxChannel)
-      PointsPerChannel[idxChannel] = RecordedHits[idxChannel].size();
-
-    LidarData.ResetMemory(PointsPerChannel);
-
-    for (auto idxChannel = 0u; idxChannel < Description.Channels; ++idxChannel) {
-      for (auto& hit : RecordedHits[idxChannel]) {
-        FDetection Detection = ComputeDetection(hit, SensorTransform);
-        if (PostprocessDetection(Detection))
-          LidarData.WritePointSync(Detection);
-        else
-          PointsPerChannel[idxChannel]--;
-      }
+void ARayCastLidar::ComputeAndSaveDetections(const FTransform& SensorTransform) {
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+  Hits.Clear();
+  size_t PointCount = 0u;
+  for (const auto &ChannelHits : RecordedHits)
+    PointCount += ChannelHits.size();
+  Hits.Reserve(PointCount);
+
+  // Hits in meters, the same units as the sensor transform below
+  for (auto idxChannel = 0u; idxChannel < Description.Channels; ++idxChannel) {
+    for (const auto& Hit : RecordedHits[idxChannel]) {
+      const carla::geom::Location HitPoint(Hit.ImpactPoint);
+      Hits.AddPoint(HitPoint.x, HitPoint.y, HitPoint.z);
     }
-
-    LidarData.WriteChannelCount(PointsPerChannel);
+    Hits.CloseChannel();
   }
+
+  const auto WorldToSensor = carla::geom::Transform(SensorTransform).GetInverseMatrix();
+  carla::sensor::LidarPostprocess::Process(PostprocessParams, WorldToSensor, RandomKey, Hits, LidarData);
+}
@@ -14,6 +14,7 @@
 #include "Carla/Actor/ActorBlueprintFunctionLibrary.h"
 
 #include <compiler/disable-ue4-macros.h>
+#include <carla/sensor/LidarPostprocess.h>
 #include <carla/sensor/data/LidarData.h>
 #include <compiler/enable-ue4-macros.h>
 
@@ -26,7 +27,6 @@ class CARLA_API ARayCastLidar : public ARayCastSemanticLidar
   GENERATED_BODY()
 
   using FLidarData = carla::sensor::data::LidarData;
-  using FDetection = carla::sensor::data::LidarDetection;
 
 public:
   static FActorDefinition GetSensorDefinition();
@@ -38,12 +38,7 @@ public:
   virtual void PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTime);
 
 private:
-  /// Compute the received intensity of the point
-  float ComputeIntensity(const FSemanticDetection& RawDetection) const;
-  FDetection ComputeDetection(const FHitResult& HitInfo, const FTransform& SensorTransf) const;
-
   void PreprocessRays(uint32_t Channels, uint32_t MaxPointsPerChannel) override;
-  bool PostprocessDetection(FDetection& Detection) const;
 
   void ComputeAndSaveDetections(const FTransform& SensorTransform) override;
 
@@ -52,11 +47,13 @@ private:
   /// Enable/Disable general dropoff of lidar points
   bool DropOffGenActive;
 
-  /// Slope for the intensity dropoff of lidar points, it is calculated
-  /// throught the dropoff limit and the dropoff at zero intensity
-  /// The points is kept with a probality alpha*Intensity + beta where
-  /// alpha = (1 - dropoff_zero_intensity) / droppoff_limit
-  /// beta = (1 - dropoff_zero_intensity)
-  float DropOffAlpha;
-  float DropOffBeta;
+  /// Attenuation, noise and intensity dropoff, see carla::sensor::LidarPostprocess
+  carla::sensor::LidarPostprocessParams PostprocessParams;
+
+  /// Key of the counter-based random numbers of the current frame, derived
+  /// from the seed and the frame number so the point cloud is reproducible
+  uint32_t RandomKey = 0u;
+
+  /// Recorded hits of all channels in meters, reused between frames
+  carla::sensor::LidarHits Hits;
 };
@@ -128,6 +128,15 @@ void ASensor::EndPlay(EEndPlayReason::Type EndPlayReason)
   }
 }
 
+void ASensor::EnqueueTracesInternal(FSensorTraceQueue &Queue, float DeltaSeconds)
+{
+  if(ReadyToTick)
+  {
+    TraceQueue = &Queue;
+    EnqueueTraces(Queue, DeltaSeconds);
+  }
+}
+
 void ASensor::PostPhysTickInternal(UWorld *World, ELevelTick TickType, float DeltaSeconds)
 {
   TRACE_CPUPROFILER_EVENT_SCOPE(ASensor::PostPhysTickInternal);
@@ -17,6 +17,7 @@
 #include "Sensor.generated.h"
 
 struct FActorDescription;
+class FSensorTraceQueue;
 
 /// Base class for sensors.
 UCLASS(Abstract, hidecategories = (Collision, Attachment, Actor))
@@ -66,6 +67,10 @@ public:
   void Tick(const float DeltaTime) final;
 
   virtual void PrePhysTick(float DeltaSeconds) {}
+  /// Add the scene queries of this tick to @a Queue. They are executed
+  /// together with the queries of the other sensors, and the results can be
+  /// read with GetTraceQueue() in PostPhysTick.
+  virtual void EnqueueTraces(FSensorTraceQueue &Queue, float DeltaSeconds) {}
   virtual void PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaSeconds) {}
   // Small interface to notify sensors when clients are listening
   virtual void OnFirstClientConnected() {};
@@ -73,6 +78,8 @@ public:
   virtual void OnLastClientDisconnected() {};
 
 
+  void EnqueueTracesInternal(FSensorTraceQueue &Queue, float DeltaSeconds);
+
   void PostPhysTickInternal(UWorld *World, ELevelTick TickType, float DeltaSeconds);
 
   UFUNCTION(BlueprintCallable)
@@ -112,6 +119,13 @@ protected:
     return Stream.MakeAsyncDataStream(Self, GetEpisode().GetElapsedGameTime());
   }
 
+  /// Queries submitted in EnqueueTraces, valid during PostPhysTick.
+  const FSensorTraceQueue &GetTraceQueue() const
+  {
+    check(TraceQueue != nullptr);
+    return *TraceQueue;
+  }
+
   /// Seed of the pseudo-random engine.
   UPROPERTY(Category = "Random Engine", EditAnywhere)
   int32 Seed = 123456789;
@@ -133,6 +147,8 @@ private:
 
   const UCarlaEpisode *Episode = nullptr;
 
+  const FSensorTraceQueue *TraceQueue = nullptr;
+
   /// Allows the sensor to tick with the tick rate from UE4.
   bool ReadyToTick = false;
 
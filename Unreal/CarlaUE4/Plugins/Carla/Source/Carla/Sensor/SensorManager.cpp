@@ -19,6 +19,18 @@ void FSensorManager::DeRegisterSensor(ASensor* Sensor)
 
 void FSensorManager::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaSeconds)
 {
+  // Collect the scene queries of every sensor and run them in one batch
+  // before the sensors process their results.
+  TraceQueue.Reset();
+  for(ASensor* Sensor : SensorList)
+  {
+    Sensor->EnqueueTracesInternal(TraceQueue, DeltaSeconds);
+  }
+  if(TraceQueue.GetTraceCount() > 0)
+  {
+    TraceQueue.Execute(World);
+  }
+
   for(ASensor* Sensor : SensorList)
   {
     Sensor->PostPhysTickInternal(World, TickType, DeltaSeconds);
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include "Carla/Sensor/SensorTraceQueue.h"
+
 class ASensor;
 
 class FSensorManager
@@ -23,4 +25,7 @@ private:
 
   TArray<ASensor*> SensorList;
 
+  /// Scene queries of all the sensors, reused every tick.
+  FSensorTraceQueue TraceQueue;
+
 };
@@ -0,0 +1,170 @@
+// Copyright (c) 2022 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <PxScene.h>
+
+#include "Carla.h"
+#include "Carla/Sensor/SensorTraceQueue.h"
+
+#include "Runtime/Core/Public/Async/ParallelFor.h"
+
+FSensorTraceQueue::FHandle FSensorTraceQueue::AddBatch(FBatch &&Batch)
+{
+  Batch.First = Starts.Num();
+  Starts.AddZeroed(Batch.Num);
+  Ends.AddZeroed(Batch.Num);
+  const FHandle Handle = Batches.Add(MoveTemp(Batch));
+  for (int32 i = 0; i < Batches[Handle].Num; ++i)
+  {
+    TraceBatches.Add(Handle);
+  }
+  return Handle;
+}
+
+FSensorTraceQueue::FHandle FSensorTraceQueue::AddLineTraces(
+    const int32 NumTraces,
+    const ECollisionChannel Channel,
+    const FCollisionQueryParams &Params,
+    const FCollisionResponseParams &ResponseParams)
+{
+  check(NumTraces >= 0);
+  const FHandle Handle = AddBatch({
+      EQueryType::LineTrace,
+      0,
+      NumTraces,
+      Channel,
+      Params,
+      ResponseParams,
+      FCollisionObjectQueryParams::DefaultObjectQueryParam,
+      FCollisionShape::LineShape});
+  const int32 First = Batches[Handle].First;
+  for (int32 i = 0; i < NumTraces; ++i)
+  {
+    LineTraces.Add(First + i);
+  }
+  return Handle;
+}
+
+FSensorTraceQueue::FHandle FSensorTraceQueue::AddSweep(
+    const FVector &Start,
+    const FVector &End,
+    const FCollisionShape &Shape,
+    const ECollisionChannel Channel,
+    const FCollisionQueryParams &Params)
+{
+  const FHandle Handle = AddBatch({
+      EQueryType::Sweep,
+      0,
+      1,
+      Channel,
+      Params,
+      FCollisionResponseParams::DefaultResponseParam,
+      FCollisionObjectQueryParams::DefaultObjectQueryParam,
+      Shape});
+  SetTrace(Handle, 0, Start, End);
+  return Handle;
+}
+
+FSensorTraceQueue::FHandle FSensorTraceQueue::AddSweepByObjectType(
+    const FVector &Start,
+    const FVector &End,
+    const FCollisionShape &Shape,
+    const FCollisionObjectQueryParams &ObjectParams,
+    const FCollisionQueryParams &Params)
+{
+  const FHandle Handle = AddBatch({
+      EQueryType::SweepByObjectType,
+      0,
+      1,
+      ECC_WorldStatic,
+      Params,
+      FCollisionResponseParams::DefaultResponseParam,
+      ObjectParams,
+      Shape});
+  SetTrace(Handle, 0, Start, End);
+  return Handle;
+}
+
+void FSensorTraceQueue::SetTrace(FHandle Handle, int32 Index, const FVector &Start, const FVector &End)
+{
+  const FBatch &Batch = Batches[Handle];
+  check(Index >= 0 && Index < Batch.Num);
+  Starts[Batch.First + Index] = Start;
+  Ends[Batch.First + Index] = End;
+}
+
+void FSensorTraceQueue::Execute(UWorld *World)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE(FSensorTraceQueue::Execute);
+  const int32 NumTraces = Starts.Num();
+  Hits.Reset(NumTraces);
+  Hits.SetNum(NumTraces);
+  bHits.Reset(NumTraces);
+  bHits.SetNumZeroed(NumTraces);
+
+  if (LineTraces.Num() > 0)
+  {
+    TRACE_CPUPROFILER_EVENT_SCOPE(ParallelFor);
+    World->GetPhysicsScene()->GetPxScene()->lockRead();
+    ParallelFor(LineTraces.Num(), [&](int32 idx) {
+      const int32 Trace = LineTraces[idx];
+      const FBatch &Batch = Batches[TraceBatches[Trace]];
+      bHits[Trace] = World->ParallelLineTraceSingleByChannel(
+          Hits[Trace],
+          Starts[Trace],
+          Ends[Trace],
+          Batch.Channel,
+          Batch.Params,
+          Batch.ResponseParams) ? 1u : 0u;
+    });
+    World->GetPhysicsScene()->GetPxScene()->unlockRead();
+  }
+
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR("Sweeps");
+  for (const FBatch &Batch : Batches)
+  {
+    if (Batch.Type == EQueryType::LineTrace)
+    {
+      continue;
+    }
+    for (int32 Trace = Batch.First; Trace < Batch.First + Batch.Num; ++Trace)
+    {
+      bool bHit = false;
+      if (Batch.Type == EQueryType::Sweep)
+      {
+        bHit = World->SweepSingleByChannel(
+            Hits[Trace],
+            Starts[Trace],
+            Ends[Trace],
+            FQuat::Identity,
+            Batch.Channel,
+            Batch.Shape,
+            Batch.Params);
+      }
+      else
+      {
+        bHit = World->SweepSingleByObjectType(
+            Hits[Trace],
+            Starts[Trace],
+            Ends[Trace],
+            FQuat::Identity,
+            Batch.ObjectParams,
+            Batch.Shape,
+            Batch.Params);
+      }
+      bHits[Trace] = bHit ? 1u : 0u;
+    }
+  }
+}
+
+void FSensorTraceQueue::Reset()
+{
+  Batches.Reset();
+  Starts.Reset();
+  Ends.Reset();
+  TraceBatches.Reset();
+  LineTraces.Reset();
+}
@@ -0,0 +1,123 @@
+// Copyright (c) 2022 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "CollisionQueryParams.h"
+#include "CollisionShape.h"
+#include "Engine/EngineTypes.h"
+
+class UWorld;
+
+/// Scene queries submitted by all the sensors during a tick, executed
+/// together and scattered back to each sensor.
+///
+/// Sensors add their queries in ASensor::EnqueueTraces and read the results
+/// in PostPhysTick through the handle returned when the queries were added.
+/// Line traces of every sensor run in a single ParallelFor under one read
+/// lock of the physics scene. Sphere sweeps run afterwards on the game
+/// thread, since the engine only provides a thread-safe line trace.
+class FSensorTraceQueue
+{
+public:
+
+  using FHandle = int32;
+
+  static constexpr FHandle InvalidHandle = INDEX_NONE;
+
+  /// Add @a NumTraces single-hit line traces on @a Channel. The start and end
+  /// of each trace must be set with SetTrace before Execute.
+  FHandle AddLineTraces(
+      int32 NumTraces,
+      ECollisionChannel Channel,
+      const FCollisionQueryParams &Params,
+      const FCollisionResponseParams &ResponseParams = FCollisionResponseParams::DefaultResponseParam);
+
+  /// Add a single-hit sweep of @a Shape on @a Channel.
+  FHandle AddSweep(
+      const FVector &Start,
+      const FVector &End,
+      const FCollisionShape &Shape,
+      ECollisionChannel Channel,
+      const FCollisionQueryParams &Params);
+
+  /// Add a single-hit sweep of @a Shape against the given object types.
+  FHandle AddSweepByObjectType(
+      const FVector &Start,
+      const FVector &End,
+      const FCollisionShape &Shape,
+      const FCollisionObjectQueryParams &ObjectParams,
+      const FCollisionQueryParams &Params);
+
+  void SetTrace(FHandle Handle, int32 Index, const FVector &Start, const FVector &End);
+
+  int32 GetNum(FHandle Handle) const
+  {
+    return Batches[Handle].Num;
+  }
+
+  /// Whether the trace @a Index of @a Handle hit something.
+  bool IsHit(FHandle Handle, int32 Index) const
+  {
+    return bHits[Batches[Handle].First + Index] != 0u;
+  }
+
+  const FHitResult &GetHit(FHandle Handle, int32 Index) const
+  {
+    return Hits[Batches[Handle].First + Index];
+  }
+
+  /// Run every query added since the last Reset.
+  void Execute(UWorld *World);
+
+  /// Remove all the queries, keeping the allocated memory.
+  void Reset();
+
+  int32 GetTraceCount() const
+  {
+    return Starts.Num();
+  }
+
+private:
+
+  enum class EQueryType : uint8
+  {
+    LineTrace,
+    Sweep,
+    SweepByObjectType
+  };
+
+  struct FBatch
+  {
+    EQueryType Type;
+    int32 First;
+    int32 Num;
+    ECollisionChannel Channel;
+    FCollisionQueryParams Params;
+    FCollisionResponseParams ResponseParams;
+    FCollisionObjectQueryParams ObjectParams;
+    FCollisionShape Shape;
+  };
+
+  FHandle AddBatch(FBatch &&Batch);
+
+  TArray<FBatch> Batches;
+
+  TArray<FVector> Starts;
+
+  TArray<FVector> Ends;
+
+  TArray<FHitResult> Hits;
+
+  TArray<uint8> bHits;
+
+  /// Batch of each trace.
+  TArray<int32> TraceBatches;
+
+  /// Index of every line trace, so the line traces of all the sensors run
+  /// in the same ParallelFor.
+  TArray<int32> LineTraces;
+};
@@ -0,0 +1,155 @@
+// Copyright (c) 2024 Institut fuer Technik der Informationsverarbeitung (ITIV) at the
+// Karlsruhe Institute of Technology
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "V2XChannel.h"
+#include "Carla/Game/CarlaEngine.h"
+#include "Carla/Game/CarlaEpisode.h"
+
+#include <algorithm>
+#include <set>
+
+double V2XChannel::GetAntennaHeight(const AActor *Actor)
+{
+    // TODO: use the actual attachment and transform of the sensor
+    return (Actor->GetSimpleCollisionHalfHeight() * 2.0) + 2.0;
+}
+
+void V2XChannel::RequireDistance(float Distance)
+{
+    mMaxDistance = std::max(mMaxDistance, Distance);
+}
+
+void V2XChannel::StartFrame()
+{
+    const uint64_t Frame = FCarlaEngine::GetFrameCounter();
+    if (Frame != mFrame)
+    {
+        mFrame = Frame;
+        mUpdated = false;
+        mPaths.clear();
+    }
+}
+
+void V2XChannel::Update(UWorld *World,
+                        UCarlaEpisode *CarlaEpisode,
+                        const std::list<AActor *> &Receivers,
+                        const std::vector<AActor *> &Senders)
+{
+    TRACE_CPUPROFILER_EVENT_SCOPE(V2XChannel::Update);
+    StartFrame();
+    if (mUpdated)
+    {
+        return;
+    }
+    mUpdated = true;
+
+    // Only actors still registered in the episode, senders first
+    const FActorRegistry &Registry = CarlaEpisode->GetActorRegistry();
+    const std::set<AActor *> SenderSet(Senders.begin(), Senders.end());
+    mNodes.clear();
+    for (AActor *Actor : Senders)
+    {
+        if (Registry.FindCarlaActor(Actor) != nullptr)
+        {
+            mNodes.push_back(Actor);
+        }
+    }
+    const size_t NumSenders = mNodes.size();
+    for (AActor *Actor : Receivers)
+    {
+        if (SenderSet.count(Actor) == 0u && Registry.FindCarlaActor(Actor) != nullptr)
+        {
+            mNodes.push_back(Actor);
+        }
+    }
+
+    // Antenna positions in meters
+    mPositions.clear();
+    for (AActor *Actor : mNodes)
+    {
+        FVector Location = Actor->GetTransform().GetLocation();
+        Location.Z += GetAntennaHeight(Actor);
+        mPositions.emplace_back(Location.X / 100.0f, Location.Y / 100.0f, Location.Z / 100.0f);
+    }
+
+    // Candidate pairs within range, at least one of them must have sent a message
+    mPairIndex.FindPairs(mPositions.data(), mPositions.size(), mMaxDistance, mPairs);
+    for (const auto &Pair : mPairs)
+    {
+        if (Pair.first < NumSenders || Pair.second < NumSenders)
+        {
+            Trace(World, CarlaEpisode, mNodes[Pair.first], mNodes[Pair.second]);
+        }
+    }
+}
+
+const FV2XPathInfo &V2XChannel::FindOrTrace(UWorld *World, UCarlaEpisode *CarlaEpisode, AActor *A, AActor *B)
+{
+    StartFrame();
+    auto It = mPaths.find(MakeKey(A, B));
+    if (It != mPaths.end())
+    {
+        return It->second;
+    }
+    return Trace(World, CarlaEpisode, A, B);
+}
+
+FV2XPathInfo &V2XChannel::Trace(UWorld *World, UCarlaEpisode *CarlaEpisode, AActor *A, AActor *B)
+{
+    FV2XPathInfo &Info = mPaths[MakeKey(A, B)];
+
+    const FVector LocationA = A->GetTransform().GetLocation();
+    const FVector LocationB = B->GetTransform().GetLocation();
+    // if objects are on a slope, minimum Z height of both is the reference (cm)
+    const double ReferenceZ = std::min(LocationA.Z, LocationB.Z);
+
+    FCollisionObjectQueryParams ObjectParams;
+    // Channels to check for collision with different object types
+    ObjectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_WorldStatic);
+    ObjectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_PhysicsBody);
+    ObjectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_Vehicle);
+    ObjectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_WorldDynamic);
+    mHitResult.Reset();
+
+    FVector Tx = LocationA;
+    Tx.Z += GetAntennaHeight(A);
+    FVector Rx = LocationB;
+    Rx.Z += GetAntennaHeight(B);
+    World->LineTraceMultiByObjectType(mHitResult, Tx, Rx, ObjectParams);
+
+    // init with LOS
+    Info.State = carla::sensor::V2XPathState::LOS;
+    Info.VehicleObstacles.clear();
+    const FActorRegistry &Registry = CarlaEpisode->GetActorRegistry();
+    for (const FHitResult &HitInfo : mHitResult)
+    {
+        const AActor *Actor = HitInfo.Actor.Get();
+        if (Actor == A || Actor == B)
+        {
+            // the current hit is either Tx or Rx, so we can skip it, no obstacle
+            continue;
+        }
+        const FCarlaActor *View = Actor != nullptr ? Registry.FindCarlaActor(Actor) : nullptr;
+        if (View != nullptr && View->GetActorType() == FCarlaActor::ActorType::Vehicle)
+        {
+            // we found a vehicle, its height is relative to the reference in m
+            const FVector Location = Actor->GetTransform().GetLocation();
+            Info.State = carla::sensor::V2XPathState::NLOSv;
+            Info.VehicleObstacles.push_back({
+                Location.X / 100.0,
+                Location.Y / 100.0,
+                (Location.Z - ReferenceZ + GetAntennaHeight(Actor)) / 100.0});
+        }
+        else
+        {
+            // but if we hit a building, we stop and switch to NLOSb
+            Info.State = carla::sensor::V2XPathState::NLOSb;
+            break;
+        }
+    }
+    return Info;
+}
@@ -0,0 +1,75 @@
+// Copyright (c) 2024 Institut fuer Technik der Informationsverarbeitung (ITIV) at the
+// Karlsruhe Institute of Technology
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <carla/geom/Location.h>
+#include <carla/sensor/V2XPairIndex.h>
+#include <carla/sensor/V2XPathLoss.h>
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <utility>
+#include <vector>
+
+class UCarlaEpisode;
+
+/// 一对 V2X 节点之间的传播状态，与方向无关。
+struct FV2XPathInfo
+{
+    carla::sensor::V2XPathState State = carla::sensor::V2XPathState::LOS;
+    /// 遮挡的车辆，单位为米，高度相对于两端中较低的地面
+    std::vector<carla::sensor::V2XObstacle> VehicleObstacles;
+};
+
+/// 同一类 V2X 传感器共享的每帧信道状态。
+///
+/// 每帧第一个调用 Update 的传感器用空间哈希找出距离内的节点对，
+/// 对每个无序节点对只做一次射线检测，结果由两端的传感器共同使用。
+/// 之后出现的节点对由 FindOrTrace 按需补充。
+class V2XChannel
+{
+public:
+    /// 每帧只执行一次，@a Senders 为本帧发送了消息的参与者。
+    void Update(UWorld *World,
+                UCarlaEpisode *CarlaEpisode,
+                const std::list<AActor *> &Receivers,
+                const std::vector<AActor *> &Senders);
+
+    /// 返回两个参与者之间的传播状态，本帧还没有时立即计算。
+    const FV2XPathInfo &FindOrTrace(UWorld *World, UCarlaEpisode *CarlaEpisode, AActor *A, AActor *B);
+
+    /// 批量检测覆盖的最大距离（米），取所有传感器 filter_distance 的最大值。
+    void RequireDistance(float Distance);
+
+    /// 参与者天线相对于其位置的高度（厘米）
+    static double GetAntennaHeight(const AActor *Actor);
+
+private:
+    using PairKey = std::pair<const AActor *, const AActor *>;
+
+    static PairKey MakeKey(const AActor *A, const AActor *B)
+    {
+        return A < B ? PairKey{A, B} : PairKey{B, A};
+    }
+
+    void StartFrame();
+
+    FV2XPathInfo &Trace(UWorld *World, UCarlaEpisode *CarlaEpisode, AActor *A, AActor *B);
+
+    uint64_t mFrame = 0u;
+    bool mUpdated = false;
+    float mMaxDistance = 0.0f;
+    std::map<PairKey, FV2XPathInfo> mPaths;
+
+    // 每帧复用的缓冲区
+    carla::sensor::V2XPairIndex mPairIndex;
+    std::vector<AActor *> mNodes;
+    std::vector<carla::geom::Location> mPositions;
+    std::vector<carla::sensor::V2XPairIndex::Pair> mPairs;
+    TArray<FHitResult> mHitResult;
+};
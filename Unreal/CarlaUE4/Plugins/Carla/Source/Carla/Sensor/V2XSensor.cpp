@@ -16,6 +16,7 @@
 #include "V2X/PathLossModel.h"
 std::list<AActor *> AV2XSensor::mV2XActorContainer;
 AV2XSensor::ActorV2XDataMap AV2XSensor::mActorV2XDataMap;
+V2XChannel AV2XSensor::mV2XChannel;
 
 AV2XSensor::AV2XSensor(const FObjectInitializer &ObjectInitializer)
     : Super(ObjectInitializer)
@@ -84,6 +85,7 @@ void AV2XSensor::SetPropagationParams(const float TransmitPower,
 {
     // forward parameters to PathLossModel Obj
     PathLossModelObj->SetParams(TransmitPower, ReceiverSensitivity, Frequency, combined_antenna_gain, path_loss_exponent, reference_distance_fspl, filter_distance, use_etsi_fading, custom_fading_stddev);
+    AV2XSensor::mV2XChannel.RequireDistance(filter_distance);
 }
 
 void AV2XSensor::SetPathLossModel(const EPathLossModel path_loss_model)
@@ -187,7 +189,13 @@ void AV2XSensor::PostPhysTick(UWorld *World, ELevelTick TickType, float DeltaTim
         if (!ActorPowerList.empty())
         {
             UCarlaEpisode *carla_episode = UCarlaStatics::GetCurrentEpisode(GetWorld());
-            PathLossModelObj->Simulate(ActorPowerList, carla_episode, GetWorld());
+            std::vector<AActor *> Senders;
+            for (const auto &pair : AV2XSensor::mActorV2XDataMap)
+            {
+                Senders.push_back(pair.first);
+            }
+            AV2XSensor::mV2XChannel.Update(GetWorld(), carla_episode, AV2XSensor::mV2XActorContainer, Senders);
+            PathLossModelObj->Simulate(ActorPowerList, carla_episode, GetWorld(), AV2XSensor::mV2XChannel);
             // Step 3: Get the list of actors who can send message to current actor, and the receive power of their messages.
             ActorPowerMap actor_receivepower_map = PathLossModelObj->GetReceiveActorPowerList();
             // Step 4: Retrieve the messages of the actors that are received
@@ -13,6 +13,7 @@
 #include <carla/sensor/data/V2XData.h>
 #include "V2X/CaService.h"
 #include "V2X/PathLossModel.h"
+#include "V2X/V2XChannel.h"
 #include <list>
 #include <map>
 #include "V2XSensor.generated.h"
@@ -65,6 +66,8 @@ public:
 
 private:
     static std::list<AActor *> mV2XActorContainer;
+    // LOS/NLOS state shared by all sensors of this type, computed once per tick
+    static V2XChannel mV2XChannel;
     CaService *CaServiceObj;
     PathLossModel *PathLossModelObj;
 
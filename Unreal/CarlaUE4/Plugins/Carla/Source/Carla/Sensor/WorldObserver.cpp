@@ -25,8 +25,11 @@
 #include <carla/rpc/String.h>
 #include <carla/sensor/SensorRegistry.h>
 #include <carla/sensor/data/ActorDynamicState.h>
+#include <carla/streaming/detail/Token.h>
 #include <compiler/enable-ue4-macros.h>
 
+#include <algorithm>
+
 static auto FWorldObserver_GetActorState(const FCarlaActor &View, const FActorRegistry &Registry)
 {
   using AType = FCarlaActor::ActorType;
@@ -364,6 +367,83 @@ static carla::Buffer FWorldObserver_Serialize(
   return std::move(buffer);
 }
 
+void FWorldObserver::AddFilteredStream(FDataStream InStream, carla::rpc::EpisodeStateFilter Filter)
+{
+  const auto StreamId = carla::streaming::detail::token_type(InStream.GetToken()).get_stream_id();
+  FilteredStreams.push_back(FFilteredStream{StreamId, std::move(InStream), std::move(Filter), false, FPlatformTime::Seconds()});
+}
+
+bool FWorldObserver::RemoveFilteredStream(carla::streaming::detail::stream_id_type StreamId)
+{
+  const auto It = std::find_if(FilteredStreams.begin(), FilteredStreams.end(), [&](auto &Filtered) {
+    return Filtered.StreamId == StreamId;
+  });
+  if (It == FilteredStreams.end())
+  {
+    return false;
+  }
+  FilteredStreams.erase(It);
+  return true;
+}
+
+std::vector<carla::streaming::detail::stream_id_type> FWorldObserver::RemoveIdleFilteredStreams()
+{
+  std::vector<carla::streaming::detail::stream_id_type> Removed;
+  const double Now = FPlatformTime::Seconds();
+  for (auto It = FilteredStreams.begin(); It != FilteredStreams.end();)
+  {
+    const bool bAbandoned = !It->bHadClients && (Now - It->CreationTime) > FilteredStreamConnectTimeout;
+    if ((It->bHadClients || bAbandoned) && !It->Stream.AreClientsListening())
+    {
+      Removed.push_back(It->StreamId);
+      It = FilteredStreams.erase(It);
+    }
+    else
+    {
+      ++It;
+    }
+  }
+  return Removed;
+}
+
+void FWorldObserver::BroadcastFilteredTick(const UCarlaEpisode &Episode, const carla::Buffer &Buffer)
+{
+  TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+  using Serializer = carla::sensor::s11n::EpisodeStateSerializer;
+  using ActorDynamicState = carla::sensor::data::ActorDynamicState;
+
+  const bool bAnyListening = std::any_of(FilteredStreams.begin(), FilteredStreams.end(), [](auto &Filtered) {
+    return Filtered.Stream.AreClientsListening();
+  });
+  if (!bAnyListening)
+  {
+    return;
+  }
+
+  // Index the actors already serialized for the broadcast stream, so the
+  // state of each actor is computed once regardless of the number of streams.
+  check(Buffer.size() >= sizeof(Serializer::Header));
+  Serializer::Header Header;
+  std::memcpy(&Header, Buffer.data(), sizeof(Header));
+  const auto *States = reinterpret_cast<const ActorDynamicState *>(Buffer.data() + sizeof(Header));
+  Index.Reset(States, (Buffer.size() - sizeof(Header)) / sizeof(ActorDynamicState));
+
+  for (auto &Filtered : FilteredStreams)
+  {
+    if (!Filtered.Stream.AreClientsListening())
+    {
+      continue;
+    }
+    Filtered.bHadClients = true;
+    Index.Select(Filtered.Filter, SelectedActors);
+    auto AsyncStream = Filtered.Stream.MakeAsyncDataStream(*this, Episode.GetElapsedGameTime());
+    AsyncStream.SerializeAndSend(
+        *this,
+        Index.Serialize(Header, SelectedActors, AsyncStream.PopBufferFromPool()));
+  }
+  Index.Reset(nullptr, 0u);
+}
+
 void FWorldObserver::BroadcastTick(
     const UCarlaEpisode &Episode,
     float DeltaSecond,
@@ -384,5 +464,10 @@ void FWorldObserver::BroadcastTick(
       MapChange,
       PendingLightUpdates);
 
+  if (!FilteredStreams.empty())
+  {
+    BroadcastFilteredTick(Episode, buffer);
+  }
+
   AsyncStream.SerializeAndSend(*this, std::move(buffer));
 }
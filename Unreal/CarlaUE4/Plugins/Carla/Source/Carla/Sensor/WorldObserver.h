@@ -8,6 +8,14 @@
 
 #include "Carla/Sensor/DataStream.h"
 
+#include <compiler/disable-ue4-macros.h>
+#include <carla/rpc/EpisodeStateFilter.h>
+#include <carla/sensor/s11n/EpisodeStateIndex.h>
+#include <carla/streaming/detail/Types.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include <vector>
+
 class UCarlaEpisode;
 
 /// Serializes and sends all the actors in the current UCarlaEpisode.
@@ -30,6 +38,19 @@ public:
     return Stream.GetToken();
   }
 
+  /// Add a stream that only receives the actors matching @a Filter. The actors
+  /// are selected from the same data sent to the broadcast stream.
+  void AddFilteredStream(FDataStream InStream, carla::rpc::EpisodeStateFilter Filter);
+
+  /// Remove the filtered stream with the given id. Return false if there is no
+  /// such stream.
+  bool RemoveFilteredStream(carla::streaming::detail::stream_id_type StreamId);
+
+  /// Remove the filtered streams whose clients have all disconnected, or that
+  /// no client connected to within FilteredStreamConnectTimeout seconds, and
+  /// return their ids so the caller can close them in the streaming server.
+  std::vector<carla::streaming::detail::stream_id_type> RemoveIdleFilteredStreams();
+
   /// Send a message to every connected client with the info about the given @a
   /// Episode.
   void BroadcastTick(
@@ -46,5 +67,33 @@ public:
 
 private:
 
+  struct FFilteredStream
+  {
+    carla::streaming::detail::stream_id_type StreamId;
+
+    FDataStream Stream;
+
+    carla::rpc::EpisodeStateFilter Filter;
+
+    bool bHadClients = false;
+
+    /// FPlatformTime::Seconds() when the stream was added.
+    double CreationTime = 0.0;
+  };
+
+  /// Seconds a filtered stream waits for its first client before it is
+  /// considered abandoned.
+  static constexpr double FilteredStreamConnectTimeout = 30.0;
+
+  void BroadcastFilteredTick(const UCarlaEpisode &Episode, const carla::Buffer &Buffer);
+
   FDataMultiStream Stream;
+
+  std::vector<FFilteredStream> FilteredStreams;
+
+  /// Spatial index over the actors of the current tick, shared by every
+  /// filtered stream.
+  carla::sensor::s11n::EpisodeStateIndex Index;
+
+  std::vector<uint32_t> SelectedActors;
 };
@@ -49,6 +49,7 @@
 #include <carla/rpc/EnvironmentObject.h>
 #include <carla/rpc/EpisodeInfo.h>
 #include <carla/rpc/EpisodeSettings.h>
+#include <carla/rpc/EpisodeStateFilter.h>
 #include <carla/rpc/LabelledPoint.h>
 #include <carla/rpc/LightState.h>
 #include <carla/rpc/MapInfo.h>
@@ -970,6 +971,50 @@ BIND_SYNC(is_sensor_enabled_for_ros) << [this](carla::streaming::detail::stream_
   };
 
 
+  // ~~ Filtered episode state streams ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+  BIND_SYNC(subscribe_to_episode_state) << [this](
+      const cr::EpisodeStateFilter &Filter) -> R<carla::streaming::Token>
+  {
+    REQUIRE_CARLA_EPISODE();
+    if (!Filter.IsValid())
+    {
+      RESPOND_ERROR("invalid episode state filter: radius and region must be finite and non-negative");
+    }
+    UCarlaGameInstance* GameInstance = UCarlaStatics::GetGameInstance(Episode->GetWorld());
+    if (!GameInstance)
+    {
+      RESPOND_ERROR("unable to find CARLA game instance");
+    }
+    FWorldObserver &WorldObserver = GameInstance->GetCarlaEngine()->GetWorldObserver();
+    // 顺便关闭客户端已经断开或一直没有连接的流
+    for (const auto StreamId : WorldObserver.RemoveIdleFilteredStreams())
+    {
+      StreamingServer.CloseStream(StreamId);
+    }
+    auto Stream = StreamingServer.MakeStream();
+    const auto Token = Stream.token();
+    WorldObserver.AddFilteredStream(FDataStream(std::move(Stream)), Filter);
+    return Token;
+  };
+
+  BIND_SYNC(unsubscribe_from_episode_state) << [this](
+      carla::streaming::detail::stream_id_type StreamId) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    UCarlaGameInstance* GameInstance = UCarlaStatics::GetGameInstance(Episode->GetWorld());
+    if (!GameInstance)
+    {
+      RESPOND_ERROR("unable to find CARLA game instance");
+    }
+    if (!GameInstance->GetCarlaEngine()->GetWorldObserver().RemoveFilteredStream(StreamId))
+    {
+      RESPOND_ERROR("unable to unsubscribe: episode state stream not found");
+    }
+    StreamingServer.CloseStream(StreamId);
+    return R<void>::Success();
+  };
+
   BIND_SYNC(send) << [this](
       cr::ActorId ActorId,
       std::string message) -> R<void>
@@ -2875,6 +2920,13 @@ BIND_SYNC(is_sensor_enabled_for_ros) << [this](carla::streaming::detail::stream_
     return R<void>::Success();
   };
 
+  BIND_SYNC(set_recorder_compression) << [this](bool enabled) -> R<void>
+  {
+    REQUIRE_CARLA_EPISODE();
+    Episode->GetRecorder()->SetCompression(enabled);
+    return R<void>::Success();
+  };
+
   BIND_SYNC(stop_replayer) << [this](bool keep_actors) -> R<void>
   {
     REQUIRE_CARLA_EPISODE();